@@ -13,6 +13,9 @@
 #include "device_config.h"
 #include "hurricane.h"
 #include "core/usb_interface_manager.h"
+#include "usb/usb_hid_pipeline.h"
+#include "usb/usb_hid_inject_sched.h"
+#include "usb/usb_hid_inject_queue.h"
 
 // Sample HID report descriptor for a mouse
 static const uint8_t hid_mouse_report_descriptor[] = {
@@ -123,6 +126,36 @@ static hid_config_t hid_configs[] = {
 // State tracking
 static bool device_connected = false;
 static bool interfaces_configured = false;
+
+// Input pipes, one per hid_configs entry: relayed and injected input merged,
+// packed, sent when it changed and restated at the SET_IDLE rate
+static const hurricane_hid_pipe_config_t hid_pipes[] = {
+    { .sink_interface = 0, .sink_endpoint = 0x81, .flags = HURRICANE_HID_PIPE_DELTA,
+      .sink_descriptor = hid_mouse_report_descriptor, .sink_descriptor_length = sizeof(hid_mouse_report_descriptor) },
+    { .sink_interface = 1, .sink_endpoint = 0x82, .flags = HURRICANE_HID_PIPE_DELTA,
+      .sink_descriptor = hid_keyboard_report_descriptor, .sink_descriptor_length = sizeof(hid_keyboard_report_descriptor) }
+};
+
+static const hurricane_hid_pipeline_config_t hid_pipeline_config = {
+    .pipes = hid_pipes,
+    .num_pipes = sizeof(hid_pipes)/sizeof(hid_pipes[0])
+};
+
+static hurricane_hid_pipeline_t hid_pipeline;
+
+// Protocol selected by the PC per hid_configs entry; both personas send boot-format reports
+static uint8_t hid_protocols[2] = { HURRICANE_HID_PROTOCOL_REPORT, HURRICANE_HID_PROTOCOL_REPORT };
+
+// Timed injected input, applied to hid_pipeline.merges (pipe = hid_configs index)
+static hurricane_inject_sched_t inject_sched;
+
+// Injected input from any context (interrupts included), drained into inject_sched by the task
+static hurricane_inject_queue_t inject_queue;
+
+// Keyboard demo timing
+#define DEMO_KEY_HOLD_US    50000u
+#define DEMO_KEY_SPACING_US 150000u
+
 static uint8_t current_keyboard_led_state = 0; // For tracking keyboard LED status
 
 // Callback function for HID control requests
@@ -134,6 +167,12 @@ static uint8_t* build_configuration_descriptor(size_t* total_length);
 // Add a HID interface at runtime
 static int add_hid_interface(uint8_t interface_num, const uint8_t* report_descriptor, uint16_t descriptor_length, uint8_t protocol);
 
+// Find the hid_configs entry of an interface
+static int hid_config_index(uint8_t interface_num);
+
+// Time base of the injection scheduler
+static uint32_t now_us(void);
+
 /**
  * Initialize the device-mode configuration
  */
@@ -173,6 +212,13 @@ void device_config_init(void)
     // Free the dynamically allocated descriptor
     free(config_desc);
     
+    // Compile the report descriptors once so reports can be packed from field values
+    if (hurricane_hid_pipeline_init(&hid_pipeline, &hid_pipeline_config) != 0) {
+        printf("[LPC55S69-Device Config] Failed to compile the report descriptors\n");
+    }
+    hurricane_inject_sched_init(&inject_sched);
+    hurricane_inject_queue_init(&inject_queue);
+
     // Register configuration/interface change callbacks in main.c
     
     printf("[LPC55S69-Device Config] Device configuration initialized\n");
@@ -242,6 +288,14 @@ void device_config_task(void)
             printf("[LPC55S69-Device Config] Host disconnected from device\n");
         }
         device_connected = current_connection;
+        
+        // A new host session starts without a reference report or held input
+        hurricane_hid_pipeline_init(&hid_pipeline, &hid_pipeline_config);
+        for (int i = 0; i < sizeof(hid_configs)/sizeof(hid_configs[0]); i++) {
+            hid_protocols[i] = HURRICANE_HID_PROTOCOL_REPORT;
+        }
+        hurricane_inject_queue_drain(&inject_queue, &inject_sched);
+        hurricane_inject_sched_clear(&inject_sched);
     }
     
     // Only send reports if connected and configured
@@ -256,34 +310,34 @@ void device_config_task(void)
             int8_t dy = (int8_t)(10 * sin(angle * 3.14159 / 180));
             angle = (angle + 15) % 360;
             
-            device_config_send_mouse_report(dx, dy, 0);
+            device_config_inject(0, HURRICANE_INJECT_MOVE, 0x01, 0x30, dx);
+            device_config_inject(0, HURRICANE_INJECT_MOVE, 0x01, 0x31, dy);
             last_mouse_time = current_time;
         }
         
         // Generate periodic keyboard key presses if keyboard interface is configured
         if (hid_configs[1].configured && (current_time - last_keyboard_time > 3000)) {
-            // Type "HELLO" one character at a time
-            static int char_index = 0;
+            // Type "HELLO": queue the whole word, the scheduler releases each edge on time
             static const uint8_t keycodes[] = {0x0B, 0x08, 0x0F, 0x0F, 0x12}; // H-E-L-L-O
-            static const char *chars = "HELLO";
-            
-            printf("[LPC55S69-Device Config] Sending keyboard report for '%c'\n", chars[char_index]);
+            uint32_t start = now_us();
             
-            // Send key press
-            uint8_t report_keycodes[6] = {0};
-            report_keycodes[0] = keycodes[char_index];
-            device_config_send_keyboard_report(0, report_keycodes);
+            printf("[LPC55S69-Device Config] Typing HELLO\n");
             
-            // Short delay
-            hurricane_delay_ms(50);
-            
-            // Send key release
-            memset(report_keycodes, 0, sizeof(report_keycodes));
-            device_config_send_keyboard_report(0, report_keycodes);
-            
-            char_index = (char_index + 1) % 5;
+            for (int i = 0; i < sizeof(keycodes); i++) {
+                hurricane_inject_sched_tap(&inject_sched, 1, start + i * DEMO_KEY_SPACING_US,
+                                           0x07, keycodes[i], DEMO_KEY_HOLD_US);
+            }
             last_keyboard_time = current_time;
         }
+        
+        // Take over what other producers queued since the last poll
+        hurricane_inject_queue_drain(&inject_queue, &inject_sched);
+        
+        // Apply scheduled input that is due; it goes out with this poll's report
+        hurricane_inject_sched_run(&inject_sched, now_us(), hid_pipeline.merges, hid_pipeline_config.num_pipes);
+        
+        // One report per pipe and poll, plus the repeats SET_IDLE asks for
+        hurricane_hid_pipeline_run(&hid_pipeline, current_time);
     }
 }
 
@@ -312,7 +366,18 @@ bool device_config_is_connected(void)
 }
 
 /**
- * Generate and send a mouse movement report
+ * Time base of the injection scheduler
+ *
+ * The millisecond tick scaled to microseconds; a board with a free-running
+ * microsecond timer can return it here for sub-millisecond release times.
+ */
+static uint32_t now_us(void)
+{
+    return hurricane_get_time_ms() * 1000u;
+}
+
+/**
+ * Feed a relayed mouse report into the merge
  */
 int device_config_send_mouse_report(int8_t dx, int8_t dy, uint8_t buttons)
 {
@@ -320,27 +385,22 @@ int device_config_send_mouse_report(int8_t dx, int8_t dy, uint8_t buttons)
         return -1;
     }
     
-    uint8_t mouse_report[] = {
-        buttons,    // Button state
-        dx,         // X movement
-        dy          // Y movement
-    };
-    
-    int result = hurricane_hw_device_interrupt_in_transfer(
-        hid_configs[0].in_endpoint,
-        mouse_report,
-        sizeof(mouse_report)
-    );
+    const hurricane_hid_pipe_t* pipe = &hid_pipeline.pipes[0];
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES] = {0};
     
-    if (result != 0) {
-        printf("[LPC55S69-Device Config] Failed to send mouse report, error %d\n", result);
+    for (int i = 0; i < 3; i++) {
+        hurricane_hid_pack_set_usage(&pipe->pack, &pipe->sink_layout, values, 0x09, i + 1, buttons & (1 << i));
     }
+    hurricane_hid_pack_set_usage(&pipe->pack, &pipe->sink_layout, values, 0x01, 0x30, dx);
+    hurricane_hid_pack_set_usage(&pipe->pack, &pipe->sink_layout, values, 0x01, 0x31, dy);
     
-    return result;
+    // Motion accumulates until the next poll; buttons are merged with injected ones
+    hurricane_hid_merge_live(&hid_pipeline.merges[0], values);
+    return 0;
 }
 
 /**
- * Generate and send a keyboard report
+ * Feed a relayed keyboard report into the merge
  */
 int device_config_send_keyboard_report(uint8_t modifier, const uint8_t keycodes[6])
 {
@@ -348,22 +408,37 @@ int device_config_send_keyboard_report(uint8_t modifier, const uint8_t keycodes[
         return -1;
     }
     
-    uint8_t keyboard_report[8];
-    keyboard_report[0] = modifier;
-    keyboard_report[1] = 0; // Reserved byte
-    memcpy(keyboard_report + 2, keycodes, 6);
+    const hurricane_hid_pipe_t* pipe = &hid_pipeline.pipes[1];
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES] = {0};
     
-    int result = hurricane_hw_device_interrupt_in_transfer(
-        hid_configs[1].in_endpoint,
-        keyboard_report,
-        sizeof(keyboard_report)
-    );
-    
-    if (result != 0) {
-        printf("[LPC55S69-Device Config] Failed to send keyboard report, error %d\n", result);
+    for (int i = 0; i < 8; i++) {
+        hurricane_hid_pack_set_usage(&pipe->pack, &pipe->sink_layout, values, 0x07, 0xE0 + i, modifier & (1 << i));
+    }
+    for (int i = 0; i < 6; i++) {
+        if (keycodes[i]) {
+            hurricane_hid_pack_set_usage(&pipe->pack, &pipe->sink_layout, values, 0x07, keycodes[i], 1);
+        }
     }
     
-    return result;
+    hurricane_hid_merge_live(&hid_pipeline.merges[1], values);
+    return 0;
+}
+
+/**
+ * Queue injected input from any context
+ */
+int device_config_inject(uint8_t pipe, uint8_t action, uint16_t usage_page, uint16_t usage, int32_t value)
+{
+    hurricane_inject_event_t event = {
+        .due_us = now_us(),
+        .usage_page = usage_page,
+        .usage = usage,
+        .value = value,
+        .pipe = pipe,
+        .action = action
+    };
+    
+    return hurricane_inject_queue_push(&inject_queue, &event);
 }
 
 /**
@@ -471,15 +546,45 @@ static bool hid_control_callback(hurricane_usb_setup_packet_t* setup, void* buff
                     return true;
         }
         
+        // Handle GET_IDLE request
+        if (setup->bRequest == 0x02) { // GET_IDLE
+            int index = hid_config_index(interface_num);
+            if (index >= 0) {
+                *(uint8_t*)buffer = hurricane_hid_delta_filter_get_idle(&hid_pipeline.pipes[index].filter, setup->wValue & 0xFF);
+                *length = 1;
+                return true;
+            }
+        }
+        
         // Handle SET_IDLE request
         if (setup->bRequest == 0x0A) { // SET_IDLE
+            // Duration (4 ms units) in the high byte, report ID in the low byte
+            int index = hid_config_index(interface_num);
+            if (index >= 0) {
+                hurricane_hid_delta_filter_set_idle(&hid_pipeline.pipes[index].filter, setup->wValue & 0xFF, setup->wValue >> 8);
+            }
             return true; // Accept the request
         }
         
+        // Handle GET_PROTOCOL request
+        if (setup->bRequest == 0x03) { // GET_PROTOCOL
+            int index = hid_config_index(interface_num);
+            if (index >= 0) {
+                *(uint8_t*)buffer = hid_protocols[index];
+                *length = 1;
+                return true;
+            }
+        }
+        
         // Handle SET_PROTOCOL request
         if (setup->bRequest == 0x0B) { // SET_PROTOCOL
             uint8_t protocol = setup->wValue & 0xFF; // 0 = Boot Protocol, 1 = Report Protocol
             printf("[LPC55S69-Device Config] SET_PROTOCOL: interface %d to protocol %d\n", interface_num, protocol);
+            // The reports already have the boot layout, so nothing else changes
+            int index = hid_config_index(interface_num);
+            if (index >= 0) {
+                hid_protocols[index] = protocol;
+            }
             return true;
         }
     }
@@ -488,6 +593,19 @@ static bool hid_control_callback(hurricane_usb_setup_packet_t* setup, void* buff
     return false;
 }
 
+/**
+ * Find the hid_configs entry of an interface
+ */
+static int hid_config_index(uint8_t interface_num)
+{
+    for (int i = 0; i < sizeof(hid_configs)/sizeof(hid_configs[0]); i++) {
+        if (hid_configs[i].interface_num == interface_num) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 /**
  * Add a HID interface at runtime
  */
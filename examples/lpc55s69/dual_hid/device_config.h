@@ -68,7 +68,10 @@ void device_config_set_interface_callback(uint8_t interface, uint8_t alt_setting
 bool device_config_is_connected(void);
 
 /**
- * @brief Generate and send a mouse movement report
+ * @brief Relay a mouse report
+ * 
+ * The report is merged with injected input and goes out with the next
+ * device_config_task() poll; motion of several reports in between is summed.
  * 
  * @param dx X movement (-127 to 127)
  * @param dy Y movement (-127 to 127)
@@ -78,7 +81,10 @@ bool device_config_is_connected(void);
 int device_config_send_mouse_report(int8_t dx, int8_t dy, uint8_t buttons);
 
 /**
- * @brief Generate and send a keyboard report
+ * @brief Relay a keyboard report
+ * 
+ * The report is merged with injected input and goes out with the next
+ * device_config_task() poll.
  * 
  * @param modifier Modifier keys (CTRL, SHIFT, ALT, etc)
  * @param keycodes Array of up to 6 keycodes (0 = no key)
@@ -86,6 +92,22 @@ int device_config_send_mouse_report(int8_t dx, int8_t dy, uint8_t buttons);
  */
 int device_config_send_keyboard_report(uint8_t modifier, const uint8_t keycodes[6]);
 
+/**
+ * @brief Inject input into a HID interface
+ * 
+ * Lock-free and safe to call from interrupts and other tasks. The action
+ * is merged with the relayed input and goes out with the first
+ * device_config_task() poll after it.
+ * 
+ * @param pipe 0 = mouse, 1 = keyboard
+ * @param action hurricane_inject_action_t (press, release, relative move, absolute set)
+ * @param usage_page Usage page (0x01 axes, 0x07 keys, 0x09 buttons)
+ * @param usage Usage
+ * @param value Delta or position for moves and sets
+ * @return int 0 if queued, negative error code if the queue is full
+ */
+int device_config_inject(uint8_t pipe, uint8_t action, uint16_t usage_page, uint16_t usage, int32_t value);
+
 /**
  * @brief Get the current mouse HID configuration
  * 
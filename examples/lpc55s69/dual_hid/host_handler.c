@@ -12,6 +12,8 @@
 #include "host_handler.h"
 #include "hurricane.h"
 #include "core/usb_interface_manager.h"
+#include "usb/usb_hid_boot.h"
+#include "usb/usb_hid_events.h"
 
 // Maximum number of devices that can be tracked
 #define MAX_USB_DEVICES 4
@@ -32,23 +34,31 @@ static usb_device_info_t devices[MAX_USB_DEVICES] = {0};
 static int active_device_idx = -1;
 static int num_devices = 0;
 
-// Report buffer and tracking
-static hid_report_data_t last_report = {0};
+// Latest report, held in the stack's receive buffer until read
+static hurricane_report_view_t last_report = {0};
 static bool new_report_available = false;
 
 // Report callback
-static void (*report_callback)(const hid_report_data_t* report) = NULL;
+static void (*report_callback)(const hurricane_report_view_t* report) = NULL;
+
+// Key down/up events decoded from keyboard reports
+static hurricane_hid_decode_plan_t keyboard_plan;
+static hurricane_hid_event_decoder_t keyboard_events;
+static hurricane_hid_event_ring_t keyboard_event_ring;
+static bool keyboard_events_ready = false;
 
 // Host mode callbacks
 static void host_device_attached_callback(void* device_handle);
 static void host_device_detached_callback(void* device_handle);
 static bool host_control_callback(hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t* length);
-static void host_data_callback(uint8_t endpoint, void* buffer, uint16_t length);
+static void host_data_callback(const hurricane_report_view_t* view);
 
 // Helper functions
 static bool enumerate_device(void* device_handle, usb_device_info_t* device_info);
 static bool configure_hid_device(usb_device_info_t* device_info);
-static void process_hid_report(const uint8_t* report_data, uint16_t length, uint8_t endpoint);
+static void process_hid_report(const hurricane_report_view_t* view);
+static bool init_keyboard_events(void);
+static void print_keyboard_events(void);
 static void print_device_info(const usb_device_info_t* device_info);
 
 /**
@@ -96,7 +106,10 @@ void host_handler_deinit(void)
     active_device_idx = -1;
     num_devices = 0;
     
-    // Clear report buffer
+    // Hand an unread report back to the stack
+    if (new_report_available) {
+        hurricane_report_view_release(&last_report);
+    }
     memset(&last_report, 0, sizeof(last_report));
     new_report_available = false;
     
@@ -157,14 +170,14 @@ bool host_handler_get_device_info(usb_device_info_t* device_info)
 /**
  * Read a HID report from the connected device
  */
-bool host_handler_read_hid_report(hid_report_data_t* report)
+bool host_handler_read_hid_report(hurricane_report_view_t* report)
 {
     if (!report || !new_report_available) {
         return false;
     }
     
-    // Copy report data to provided structure
-    memcpy(report, &last_report, sizeof(hid_report_data_t));
+    // Our hold on the buffer passes to the caller
+    *report = last_report;
     
     // Clear the new report flag
     new_report_available = false;
@@ -266,7 +279,7 @@ bool host_handler_set_keyboard_leds(uint8_t leds)
 /**
  * Register callback function for HID report reception
  */
-void host_handler_register_report_callback(void (*callback)(const hid_report_data_t* report))
+void host_handler_register_report_callback(void (*callback)(const hurricane_report_view_t* report))
 {
     report_callback = callback;
 }
@@ -373,6 +386,13 @@ static void host_device_detached_callback(void* device_handle)
                 active_device_idx = -1; // Clear active device
             }
             
+            if (devices[i].is_hid && devices[i].device_protocol == 1 && keyboard_events_ready) {
+                // Keys held when the keyboard went away are released
+                hurricane_hid_event_decoder_release_all(&keyboard_events, hurricane_get_time_ms(),
+                                                        &keyboard_event_ring);
+                print_keyboard_events();
+            }
+            
             num_devices--;
             break;
         }
@@ -407,16 +427,14 @@ static bool host_control_callback(hurricane_usb_setup_packet_t* setup, void* buf
 /**
  * Host mode callback for data reception
  */
-static void host_data_callback(uint8_t endpoint, void* buffer, uint16_t length)
+static void host_data_callback(const hurricane_report_view_t* view)
 {
-    printf("[LPC55S69-Host Handler] Received %d bytes on endpoint 0x%02X\n", length, endpoint);
+    printf("[LPC55S69-Host Handler] Received %d bytes from device %d\n", view->length, view->pipe);
     
     // Check if this is data from our active device
     if (active_device_idx >= 0 && devices[active_device_idx].connected) {
-        if (devices[active_device_idx].endpoint_in == endpoint) {
-            // Process HID report data
-            process_hid_report((const uint8_t*)buffer, length, endpoint);
-        }
+        // Process HID report data
+        process_hid_report(view);
     }
 }
 
@@ -637,22 +655,56 @@ static bool configure_hid_device(usb_device_info_t* device_info)
     return true;
 }
 
+/**
+ * Set up the event decoder for boot keyboard reports
+ */
+static bool init_keyboard_events(void)
+{
+    const hurricane_hid_layout_t* layout = hurricane_hid_boot_layout(HURRICANE_HID_BOOT_KEYBOARD);
+    
+    if (!layout ||
+        hurricane_hid_decode_plan_build(layout, HURRICANE_HID_REPORT_INPUT, 0, &keyboard_plan) != 0 ||
+        hurricane_hid_event_decoder_init(&keyboard_events, layout, &keyboard_plan, 0) != 0) {
+        return false;
+    }
+    hurricane_hid_event_ring_init(&keyboard_event_ring);
+    keyboard_events_ready = true;
+    return true;
+}
+
+/**
+ * Print and consume the pending keyboard events
+ */
+static void print_keyboard_events(void)
+{
+    hurricane_hid_event_t event;
+    
+    while (hurricane_hid_event_ring_pop(&keyboard_event_ring, &event)) {
+        printf("[LPC55S69-Host Handler] Key %02X %s\n", event.usage,
+               event.type == HURRICANE_HID_EVENT_KEY_DOWN ? "down" : "up");
+    }
+}
+
 /**
  * Process a HID report received from a device
  */
-static void process_hid_report(const uint8_t* report_data, uint16_t length, uint8_t endpoint)
+static void process_hid_report(const hurricane_report_view_t* view)
 {
-    if (!report_data || length == 0) {
+    const uint8_t* report_data = view->data;
+    uint16_t length = view->length;
+    
+    if (length == 0) {
         return;
     }
     
     printf("[LPC55S69-Host Handler] Processing HID report (%d bytes)\n", length);
     
-    // Store the report in our buffer
-    last_report.report_id = (length > 0) ? 0 : 0; // No report ID in current implementation
-    memcpy(last_report.data, report_data, (length > sizeof(last_report.data)) ? sizeof(last_report.data) : length);
-    last_report.length = (length > sizeof(last_report.data)) ? sizeof(last_report.data) : length;
-    last_report.timestamp = hurricane_get_time_ms();
+    // Keep the report in the receive buffer until it is read, replacing an unread one
+    if (new_report_available) {
+        hurricane_report_view_release(&last_report);
+    }
+    hurricane_report_view_hold(view);
+    last_report = *view;
     new_report_available = true;
     
     // If this is from a mouse, interpret the data
@@ -675,19 +727,20 @@ static void process_hid_report(const uint8_t* report_data, uint16_t length, uint
              devices[active_device_idx].is_hid && 
              devices[active_device_idx].device_protocol == 1) { // Keyboard protocol
         
-        // Typical keyboard report format: [modifier, reserved, keycode1, keycode2, ...]
-        if (length >= 3) {
-            uint8_t modifier = report_data[0];
-            uint8_t keycode1 = report_data[2];
+        // Boot keyboard report format: [modifier, reserved, keycode1..keycode6]
+        if (length >= 3 && (keyboard_events_ready || init_keyboard_events())) {
+            int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];
             
-            printf("[LPC55S69-Host Handler] Keyboard report: modifier=%02X, key1=%02X\n", 
-                   modifier, keycode1);
+            hurricane_hid_decode(&keyboard_plan, report_data, length, values);
+            hurricane_hid_event_decoder_feed(&keyboard_events, values, hurricane_get_time_ms(),
+                                             &keyboard_event_ring);
+            print_keyboard_events();
         }
     }
     
     // Call the registered callback if there is one
     if (report_callback) {
-        report_callback(&last_report);
+        report_callback(view);
     }
 }
 
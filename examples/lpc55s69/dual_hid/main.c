@@ -19,6 +19,8 @@
 #include <stdbool.h>
 #include "hurricane.h"
 #include "core/usb_interface_manager.h"
+#include "usb/usb_hid_output_relay.h"
+#include "usb/usb_hid_demux.h"
 #include "device_config.h"
 #include "host_handler.h"
 
@@ -33,7 +35,7 @@ typedef enum {
 static app_state_t app_state = APP_STATE_INIT;
 
 // Callback function for HID reports from host mode
-static void hid_report_callback(const hid_report_data_t* report);
+static void hid_report_callback(const hurricane_report_view_t* report);
 
 // Callback function for keyboard LED state changes from device mode
 static void keyboard_led_callback(uint8_t led_state);
@@ -44,6 +46,19 @@ typedef void (*keyboard_led_callback_t)(uint8_t);
 // Global callback variable - used by device_config.c
 keyboard_led_callback_t g_keyboard_led_callback = NULL;
 
+// Output reports (keyboard LEDs) heading for the physical keyboard
+static hurricane_hid_output_relay_t led_relay;
+
+// Device-side pipes host-side reports are routed to
+#define PIPE_MOUSE      0
+#define PIPE_KEYBOARD   1
+
+// Report-ID demultiplexer of the attached device, built on its first report
+static hurricane_hid_layout_t host_layout;
+static hurricane_hid_decode_plan_t host_plans[HURRICANE_HID_DEMUX_MAX_ROUTES];
+static hurricane_hid_demux_t host_demux;
+static bool host_demux_ready = false;
+
 // Configuration callbacks
 static void set_configuration_callback(uint8_t configuration);
 static void set_interface_callback(uint8_t interface, uint8_t alt_setting);
@@ -85,6 +100,7 @@ static bool app_init(void)
     host_handler_register_report_callback(hid_report_callback);
     
     // Register callback for keyboard LED state changes
+    hurricane_hid_output_relay_init(&led_relay, 0, 0, HURRICANE_HID_OUTPUT_RELAY_DEFAULT_WINDOW_MS);
     g_keyboard_led_callback = keyboard_led_callback;
     
     printf("\n[Main] Dual USB initialization complete\n");
@@ -115,6 +131,14 @@ static void app_run_iteration(void)
     static uint32_t last_status_time = 0;
     uint32_t current_time = hurricane_get_time_ms();
     
+    // Flush LED reports held back by the coalescing window
+    if (host_handler_is_device_connected()) {
+        hurricane_hid_output_relay_task(&led_relay, current_time);
+    } else {
+        hurricane_hid_output_relay_reset(&led_relay);
+        host_demux_ready = false;
+    }
+    
     if (current_time - last_status_time > 5000) {
         printf("\n[Main] Status Update - Time: %lu ms\n", current_time);
         
@@ -212,33 +236,162 @@ static void set_interface_callback(uint8_t interface, uint8_t alt_setting)
  */
 static void keyboard_led_callback(uint8_t led_state)
 {
-    printf("[Main] Forwarding keyboard LED state: 0x%02X to physical keyboard\n", led_state);
-    
     // Only forward if we have a device connected to the host controller
     if (host_handler_is_device_connected()) {
         // Get device info to make sure it's a keyboard
         usb_device_info_t device_info;
         if (host_handler_get_device_info(&device_info)) {
             if (device_info.device_protocol == 1 || device_info.is_hid) { // Keyboard or HID device
-                // Send LED state to the physical keyboard
-                if (!host_handler_set_keyboard_leds(led_state)) {
+                // The relay drops repeated LED states (some hosts resend them on
+                // every focus change) and uses the interrupt OUT endpoint when
+                // the keyboard has one, so EP0 stays free for the input path
+                hurricane_hid_output_relay_set_target(&led_relay,
+                                                      device_info.current_interface,
+                                                      device_info.endpoint_out);
+                int result = hurricane_hid_output_relay_submit(&led_relay, 0, &led_state, 1,
+                                                               hurricane_get_time_ms());
+                if (result < 0) {
                     printf("[Main] Failed to forward LED state to physical keyboard\n");
+                } else if (result != HURRICANE_HID_OUTPUT_DUPLICATE) {
+                    printf("[Main] Forwarding keyboard LED state: 0x%02X to physical keyboard\n", led_state);
                 }
             }
         }
     }
 }
 
+/**
+ * Build the report demultiplexer from the attached device's report descriptor
+ *
+ * Mouse and keyboard application collections are routed to the matching
+ * device-side interface; everything else (consumer keys, vendor reports)
+ * has no device-side counterpart and is dropped.
+ */
+static bool build_host_demux(void)
+{
+    uint8_t descriptor[256];
+    uint16_t length = host_handler_get_report_descriptor(descriptor, sizeof(descriptor));
+    
+    if (length == 0 ||
+        hurricane_hid_parse_report_descriptor(descriptor, length, &host_layout) != HURRICANE_HID_PARSE_OK) {
+        printf("[Main] Cannot compile the report descriptor, not relaying reports\n");
+        return false;
+    }
+    
+    hurricane_hid_demux_init(&host_demux, &host_layout);
+    
+    uint8_t num_plans = 0;
+    for (uint8_t i = 0; i < host_layout.num_reports && num_plans < HURRICANE_HID_DEMUX_MAX_ROUTES; i++) {
+        const hurricane_hid_report_info_t* info = &host_layout.reports[i];
+        hurricane_hid_demux_route_t route = {0};
+        
+        if (info->type != HURRICANE_HID_REPORT_INPUT || info->application_page != 0x01) {
+            continue;
+        }
+        if (info->application_usage == 0x02) {
+            route.pipe = PIPE_MOUSE;
+        } else if (info->application_usage == 0x06) {
+            route.pipe = PIPE_KEYBOARD;
+        } else {
+            continue;
+        }
+        
+        if (hurricane_hid_decode_plan_build(&host_layout, HURRICANE_HID_REPORT_INPUT, info->report_id,
+                                            &host_plans[num_plans]) != 0) {
+            continue;
+        }
+        route.decode = &host_plans[num_plans];
+        if (hurricane_hid_demux_add_route(&host_demux, info->report_id, &route) >= 0) {
+            printf("[Main] Report ID %d -> %s\n", info->report_id, route.pipe == PIPE_MOUSE ? "mouse" : "keyboard");
+            num_plans++;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * Decoded value of a usage in a routed report, 0 if the report lacks it
+ */
+static int32_t routed_usage(const hurricane_hid_demux_output_t* out, uint16_t usage_page, uint16_t usage)
+{
+    int32_t value = 0;
+    hurricane_hid_decode_get_usage(out->route->decode, &host_layout, out->values, usage_page, usage, &value);
+    return value;
+}
+
+/**
+ * Relay a routed mouse report to the device-side mouse
+ */
+static void relay_mouse_report(const hurricane_hid_demux_output_t* out)
+{
+    uint8_t buttons = 0;
+    for (int i = 0; i < 3; i++) {
+        buttons |= routed_usage(out, 0x09, i + 1) ? (1 << i) : 0;
+    }
+    
+    // The device-side mouse has 8-bit axes
+    int32_t x = routed_usage(out, 0x01, 0x30);
+    int32_t y = routed_usage(out, 0x01, 0x31);
+    int8_t dx = (int8_t)(x < -127 ? -127 : (x > 127 ? 127 : x));
+    int8_t dy = (int8_t)(y < -127 ? -127 : (y > 127 ? 127 : y));
+    
+    printf("[Main] Relaying mouse report: buttons=0x%02X, dx=%d, dy=%d\n", buttons, dx, dy);
+    
+    int result = device_config_send_mouse_report(dx, dy, buttons);
+    if (result != 0) {
+        printf("[Main] Failed to relay mouse report, error %d\n", result);
+    }
+}
+
+/**
+ * Relay a routed keyboard report to the device-side keyboard
+ */
+static void relay_keyboard_report(const hurricane_hid_demux_output_t* out)
+{
+    const hurricane_hid_decode_plan_t* plan = out->route->decode;
+    uint8_t modifier = 0;
+    uint8_t keycodes[6] = {0};
+    int num_keys = 0;
+    
+    for (int i = 0; i < 8; i++) {
+        modifier |= routed_usage(out, 0x07, 0xE0 + i) ? (1 << i) : 0;
+    }
+    
+    // Collect pressed keys from the key array(s), up to the boot keyboard's six
+    for (uint8_t f = 0; f < plan->num_fields; f++) {
+        const hurricane_hid_field_t* field = &host_layout.fields[plan->first_field + f];
+        if (field->usage_page != 0x07 || (field->flags & HURRICANE_HID_FIELD_VARIABLE)) {
+            continue;
+        }
+        for (uint16_t e = 0; e < field->count && num_keys < 6; e++) {
+            int32_t raw = out->values[plan->field_value[f] + e];
+            int32_t usage = field->usage + (raw - field->logical_min);
+            if (raw >= field->logical_min && raw <= field->logical_max && usage > 0 && usage < 0xE0) {
+                keycodes[num_keys++] = (uint8_t)usage;
+            }
+        }
+    }
+    
+    printf("[Main] Relaying keyboard report: modifier=0x%02X, keys=[0x%02X,0x%02X,0x%02X,0x%02X,0x%02X,0x%02X]\n",
+           modifier, keycodes[0], keycodes[1], keycodes[2], keycodes[3], keycodes[4], keycodes[5]);
+    
+    int result = device_config_send_keyboard_report(modifier, keycodes);
+    if (result != 0) {
+        printf("[Main] Failed to relay keyboard report, error %d\n", result);
+    }
+}
+
 /**
  * Callback for HID reports received in host mode
  */
-static void hid_report_callback(const hid_report_data_t* report)
+static void hid_report_callback(const hurricane_report_view_t* report)
 {
     if (!report) return;
     
     // Display basic report information
-    printf("[Main] Received HID report: ID: %d, Length: %d\n",
-           report->report_id, report->length);
+    printf("[Main] Received HID report: Device: %d, Length: %d\n",
+           report->pipe, report->length);
     
     // Check if we're connected to the device controller
     if (!device_config_is_connected()) {
@@ -246,65 +399,19 @@ static void hid_report_callback(const hid_report_data_t* report)
         return;
     }
     
-    // We need device information to determine report type
-    usb_device_info_t device_info;
-    if (!host_handler_get_device_info(&device_info)) {
-        printf("[Main] Failed to get device info, cannot relay HID report\n");
-        return;
-    }
-    
-    // Process based on device protocol or report size/format
-    if (device_info.device_protocol == 2 || // Mouse protocol
-        (report->length >= 3 && report->length <= 4)) { // Typical mouse report length
-        
-        // Parse mouse report data - typically [buttons, x, y, wheel(optional)]
-        uint8_t buttons = report->data[0];
-        int8_t dx = (int8_t)report->data[1];
-        int8_t dy = (int8_t)report->data[2];
-        
-        printf("[Main] Relaying mouse report: buttons=0x%02X, dx=%d, dy=%d\n",
-               buttons, dx, dy);
-        
-        // Send report to device controller (USB0)
-        int result = device_config_send_mouse_report(dx, dy, buttons);
-        if (result != 0) {
-            printf("[Main] Failed to relay mouse report, error %d\n", result);
-        }
-    }
-    else if (device_info.device_protocol == 1 || // Keyboard protocol
-             (report->length >= 8)) { // Typical keyboard report length
-        
-        // Parse keyboard report data - typically [modifier, reserved, key1, key2, key3, key4, key5, key6]
-        uint8_t modifier = report->data[0];
-        uint8_t keycodes[6]; // Maximum 6 keys in standard HID keyboard report
-        
-        // Copy key codes, starting from byte 2 (skipping modifier and reserved bytes)
-        // Ensure we don't exceed report length or the 6-key limit
-        size_t key_bytes = report->length - 2 > 6 ? 6 : report->length - 2;
-        if (key_bytes > 0) {
-            memcpy(keycodes, &report->data[2], key_bytes);
-        }
-        
-        // Zero out any remaining key slots
-        for (size_t i = key_bytes; i < 6; i++) {
-            keycodes[i] = 0;
+    if (!host_demux_ready) {
+        host_demux_ready = build_host_demux();
+        if (!host_demux_ready) {
+            return;
         }
-        
-        printf("[Main] Relaying keyboard report: modifier=0x%02X, keys=[0x%02X,0x%02X,0x%02X,0x%02X,0x%02X,0x%02X]\n",
-               modifier, keycodes[0], keycodes[1], keycodes[2], keycodes[3], keycodes[4], keycodes[5]);
-        
-        // Send report to device controller (USB0)
-        int result = device_config_send_keyboard_report(modifier, keycodes);
-        if (result != 0) {
-            printf("[Main] Failed to relay keyboard report, error %d\n", result);
-        }
-        
-        // For bidirectional communication, monitor changes in LED state
-        // This would be handled by the device controller callbacks
-        // The host_handler_set_keyboard_leds() function would be called
-        // when the host (connected to USB0) changes the LED state
     }
-    else {
-        printf("[Main] Unknown HID report format, cannot relay\n");
+    
+    // One table lookup on the report ID picks the device-side interface
+    hurricane_hid_demux_output_t out;
+    int pipe = hurricane_hid_demux_dispatch(&host_demux, report->data, report->length, &out);
+    if (pipe == PIPE_MOUSE) {
+        relay_mouse_report(&out);
+    } else if (pipe == PIPE_KEYBOARD) {
+        relay_keyboard_report(&out);
     }
-}
\ No newline at end of file
+}
@@ -32,16 +32,6 @@ typedef struct {
     char product_name[32];
 } usb_device_info_t;
 
-/**
- * @brief HID report data structure
- */
-typedef struct {
-    uint8_t report_id;
-    uint8_t data[64];
-    uint16_t length;
-    uint32_t timestamp;
-} hid_report_data_t;
-
 /**
  * @brief Initialize the host-mode handler
  */
@@ -77,12 +67,14 @@ bool host_handler_get_device_info(usb_device_info_t* device_info);
 /**
  * @brief Read a HID report from the connected device
  * 
- * Reads the latest HID report from the connected device if available
+ * Hands out a view of the latest HID report from the connected device if
+ * available. The view points into the stack's receive buffer; release it
+ * with hurricane_report_view_release() when done.
  * 
- * @param report Pointer to structure to fill with report data
+ * @param report View to fill in
  * @return true if a report was read, false if no report is available
  */
-bool host_handler_read_hid_report(hid_report_data_t* report);
+bool host_handler_read_hid_report(hurricane_report_view_t* report);
 
 /**
  * @brief Send a HID report to the connected device
@@ -105,9 +97,12 @@ bool host_handler_set_keyboard_leds(uint8_t leds);
 /**
  * @brief Register callback function for HID report reception
  * 
+ * The view is only valid during the call; hold it with
+ * hurricane_report_view_hold() to keep it longer.
+ * 
  * @param callback Function pointer to call when a HID report is received
  */
-void host_handler_register_report_callback(void (*callback)(const hid_report_data_t* report));
+void host_handler_register_report_callback(void (*callback)(const hurricane_report_view_t* report));
 
 /**
  * @brief Get the HID report descriptor from the connected device
@@ -15,6 +15,7 @@
 #include <stdbool.h>
 #include "hurricane.h"
 #include "core/usb_interface_manager.h"
+#include "core/usb_ep0_proxy.h"
 #include "device_config.h"
 #include "host_handler.h"
 
@@ -29,7 +30,7 @@ typedef enum {
 static app_state_t app_state = APP_STATE_INIT;
 
 // Callback function for HID reports from host mode
-static void hid_report_callback(const hid_report_data_t* report);
+static void hid_report_callback(const hurricane_report_view_t* report);
 
 // Configuration callbacks
 static void set_configuration_callback(uint8_t configuration);
@@ -72,6 +73,10 @@ static bool app_init(void)
     // Register callback for host HID report reception
     host_handler_register_report_callback(hid_report_callback);
     
+    // Answer class/vendor requests from the PC with the physical device's replies
+    hurricane_ep0_proxy_init();
+    hurricane_ep0_proxy_enable(true);
+    
     printf("\n[Main] Dual USB initialization complete\n");
     printf("* Device mode: Composite HID (Mouse + Keyboard)\n");
     printf("* Host mode: HID device detection and handling\n\n");
@@ -191,13 +196,13 @@ static void set_interface_callback(uint8_t interface, uint8_t alt_setting)
 /**
  * Callback for HID reports received in host mode
  */
-static void hid_report_callback(const hid_report_data_t* report)
+static void hid_report_callback(const hurricane_report_view_t* report)
 {
     if (!report) return;
     
     // Display basic report information
-    printf("[Main] Received HID report: ID: %d, Length: %d\n", 
-           report->report_id, report->length);
+    printf("[Main] Received HID report: Device: %d, Length: %d\n",
+           report->pipe, report->length);
     
     // For keyboard reports, we might want to change keyboard LEDs based on state
     // This demonstrates bidirectional communication with a HID device
@@ -0,0 +1,45 @@
+/*
+ * @file hurricane_context.c
+ * @brief Stack context initialization and the default context
+ */
+
+#include "hurricane_context.h"
+#include <string.h>
+
+// All module state is valid when zeroed, so the default context needs no
+// explicit initialization apart from its lock.
+static hurricane_context_t default_context = {
+#ifdef HURRICANE_USE_THREADING
+    .interfaces.mutex = PTHREAD_MUTEX_INITIALIZER,
+#endif
+    .host_controller = HURRICANE_HW_PRIMARY_CONTROLLER,
+    .device_controller = HURRICANE_HW_PRIMARY_CONTROLLER,
+};
+
+hurricane_context_t* hurricane_default_context(void)
+{
+    return &default_context;
+}
+
+void hurricane_context_init(hurricane_context_t* ctx, uint8_t host_controller, uint8_t device_controller)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->host_controller = host_controller;
+    ctx->device_controller = device_controller;
+    for (uint8_t i = 0; i < MAX_USB_DEVICES; i++) {
+        ctx->devices[i].ctx = ctx;
+    }
+    ctx->ep0_proxy.request.user_data = ctx;
+#ifdef HURRICANE_USE_THREADING
+    pthread_mutex_init(&ctx->interfaces.mutex, NULL);
+#endif
+}
+
+void hurricane_context_deinit(hurricane_context_t* ctx)
+{
+#ifdef HURRICANE_USE_THREADING
+    pthread_mutex_destroy(&ctx->interfaces.mutex);
+#else
+    (void)ctx;
+#endif
+}
@@ -0,0 +1,93 @@
+/**
+ * @file hurricane_context.h
+ * @brief Stack context: all state of one host/device port pair
+ *
+ * Everything the stack used to keep in file-scope statics (device table,
+ * enumeration state, control queue, interface registry, EP0 proxy, HID
+ * callbacks) lives in a hurricane_context_t, so several independent proxy
+ * instances can run side by side, e.g. one per port pair, or one per thread
+ * in a host-side simulation.
+ *
+ * Every public API has a *_ctx() variant taking the context explicitly. The
+ * original functions operate on the default context, so single-instance
+ * code does not change.
+ *
+ * A context is only ever touched by one thread at a time (the EP0 proxy
+ * setup hook excepted, which is written for ISR use). Contexts share nothing
+ * but the HAL, so different threads may each drive their own context.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "hurricane_context_fwd.h"
+#include "hurricane_usb.h"
+#include "usb_host_controller.h"
+#include "usb_host_control_queue.h"
+#include "usb_interface_manager.h"
+#include "usb_ep0_proxy.h"
+#include "usb_report_pool.h"
+#include "usb/usb_hid.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct hurricane_context {
+    uint8_t host_controller;                        /**< Host controller instance (see hw/hurricane_hw_ops.h) */
+    uint8_t device_controller;                      /**< Device controller instance */
+
+    hurricane_device_t devices[MAX_USB_DEVICES];    /**< Attached devices */
+    uint8_t device_count;
+
+    hurricane_control_queue_t control_queue;        /**< Host-side EP0 requests */
+    usb_host_state_t host;                          /**< Enumeration state */
+    hurricane_interface_manager_t interfaces;       /**< Device-side interface registry */
+    hurricane_ep0_proxy_t ep0_proxy;                /**< Device-to-host EP0 forwarding */
+    hurricane_hid_callbacks_t hid;                  /**< Device-side HID report callbacks */
+    hurricane_report_pool_t reports;                /**< Host-side receive buffers */
+
+    void* user_data;                                /**< Free for the application */
+};
+
+/**
+ * @brief Initialize a context
+ *
+ * The modules still have to be started as before (usb_host_init_ctx(),
+ * hurricane_interface_manager_init_ctx(), ...).
+ *
+ * @param ctx Context to initialize
+ * @param host_controller Host controller instance the context enumerates on
+ * @param device_controller Device controller instance facing the PC
+ */
+void hurricane_context_init(hurricane_context_t* ctx, uint8_t host_controller, uint8_t device_controller);
+
+/**
+ * @brief Release resources held by a context (mutexes)
+ *
+ * @param ctx Context
+ */
+void hurricane_context_deinit(hurricane_context_t* ctx);
+
+/**
+ * @brief Context used by the functions without a context parameter
+ *
+ * @return Default context (bound to the primary controllers)
+ */
+hurricane_context_t* hurricane_default_context(void);
+
+/**
+ * @brief Context a device belongs to
+ *
+ * @param dev Device (may be NULL)
+ * @return The device's context, or the default context for devices created
+ *         outside a context's device table
+ */
+static inline hurricane_context_t* hurricane_device_context(const hurricane_device_t* dev)
+{
+    return (dev && dev->ctx) ? dev->ctx : hurricane_default_context();
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+/**
+ * @file hurricane_context_fwd.h
+ * @brief Forward declaration of the stack context
+ *
+ * Module headers only need the handle type for their *_ctx() prototypes; the
+ * full definition lives in core/hurricane_context.h, which includes them all.
+ */
+
+#pragma once
+
+/**
+ * @brief One independent stack instance (see core/hurricane_context.h)
+ */
+typedef struct hurricane_context hurricane_context_t;
@@ -0,0 +1,68 @@
+/**
+ * @file hurricane_cycles.h
+ * @brief Cheap timestamp counter for profiling hot paths
+ *
+ * On Cortex-M3/M4/M7/M33 this reads the DWT cycle counter (call
+ * hurricane_cycles_init() once at startup). Elsewhere, e.g. in the Linux
+ * simulation, it falls back to a nanosecond clock; HURRICANE_CYCLES_UNIT
+ * names the unit so benchmark output stays honest about which one it is.
+ *
+ * The counter wraps; always subtract two readings as uint32_t.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+
+#define HURRICANE_CYCLES_UNIT "cycles"
+
+#define HURRICANE_DEMCR         (*(volatile uint32_t*)0xE000EDFCu)
+#define HURRICANE_DWT_CTRL      (*(volatile uint32_t*)0xE0001000u)
+#define HURRICANE_DWT_CYCCNT    (*(volatile uint32_t*)0xE0001004u)
+
+/**
+ * @brief Enable the cycle counter
+ */
+static inline void hurricane_cycles_init(void)
+{
+    HURRICANE_DEMCR |= (1u << 24);      // TRCENA
+    HURRICANE_DWT_CYCCNT = 0;
+    HURRICANE_DWT_CTRL |= 1u;           // CYCCNTENA
+}
+
+/**
+ * @brief Current counter value
+ */
+static inline uint32_t hurricane_cycles_now(void)
+{
+    return HURRICANE_DWT_CYCCNT;
+}
+
+#else
+
+#include <time.h>
+
+#define HURRICANE_CYCLES_UNIT "ns"
+
+static inline void hurricane_cycles_init(void)
+{
+}
+
+static inline uint32_t hurricane_cycles_now(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
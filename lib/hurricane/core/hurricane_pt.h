@@ -0,0 +1,116 @@
+/**
+ * @file hurricane_pt.h
+ * @brief Stackless cooperative threads (protothreads) for bare-metal flows
+ *
+ * A Hurricane protothread is an ordinary function that stores its resume
+ * point in a hurricane_pt_t and returns to its caller whenever it has to
+ * wait, e.g. for a queued control transfer to complete. Long sequences such
+ * as enumeration keep their linear form, but every wait point costs one
+ * return to the main loop instead of a blocked CPU or a per-flow stack.
+ *
+ * Rules for thread bodies:
+ *  - Local variables are not preserved across a wait; keep state in the
+ *    structure that owns the hurricane_pt_t.
+ *  - Do not use switch statements inside HURRICANE_PT_BEGIN/END, the macros
+ *    are built on a switch of their own.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Protothread control block (resume point only)
+ */
+typedef struct {
+    uint16_t lc;    /**< Line of the last wait point, 0 = start */
+} hurricane_pt_t;
+
+/**
+ * @brief Values returned by a protothread function
+ */
+typedef enum {
+    HURRICANE_PT_WAITING = 0,   /**< Blocked on a condition */
+    HURRICANE_PT_YIELDED,       /**< Gave up the CPU voluntarily */
+    HURRICANE_PT_EXITED,        /**< Aborted with HURRICANE_PT_EXIT */
+    HURRICANE_PT_ENDED          /**< Ran to HURRICANE_PT_END */
+} hurricane_pt_state_t;
+
+/** Declare a protothread function: HURRICANE_PT_THREAD(my_thread(my_state_t* s)) */
+#define HURRICANE_PT_THREAD(name_args) hurricane_pt_state_t name_args
+
+/** (Re)start a protothread from the top */
+#define HURRICANE_PT_INIT(pt) ((pt)->lc = 0)
+
+/** Run a protothread once; true while it has not ended or exited */
+#define HURRICANE_PT_SCHEDULE(call) ((call) < HURRICANE_PT_EXITED)
+
+#define HURRICANE_PT_BEGIN(pt)                      \
+    {                                               \
+        char pt_yield_flag = 1;                     \
+        (void)pt_yield_flag;                        \
+        switch ((pt)->lc) {                         \
+        case 0:
+
+#define HURRICANE_PT_END(pt)                        \
+        }                                           \
+        HURRICANE_PT_INIT(pt);                      \
+        return HURRICANE_PT_ENDED;                  \
+    }
+
+/* Internal: record a resume point */
+#define HURRICANE_PT_SET_LC(pt)                     \
+    (pt)->lc = (uint16_t)__LINE__;                  \
+    /* fallthrough */                               \
+    case __LINE__:
+
+/** Wait until cond is true, returning to the caller while it is false */
+#define HURRICANE_PT_WAIT_UNTIL(pt, cond)           \
+    do {                                            \
+        HURRICANE_PT_SET_LC(pt)                     \
+        if (!(cond)) {                              \
+            return HURRICANE_PT_WAITING;            \
+        }                                           \
+    } while (0)
+
+/** Wait while cond is true */
+#define HURRICANE_PT_WAIT_WHILE(pt, cond) HURRICANE_PT_WAIT_UNTIL(pt, !(cond))
+
+/** Give up the CPU for exactly one scheduling round */
+#define HURRICANE_PT_YIELD(pt)                      \
+    do {                                            \
+        pt_yield_flag = 0;                          \
+        HURRICANE_PT_SET_LC(pt)                     \
+        if (pt_yield_flag == 0) {                   \
+            return HURRICANE_PT_YIELDED;            \
+        }                                           \
+    } while (0)
+
+/** Run a child protothread to completion, yielding while it waits */
+#define HURRICANE_PT_SPAWN(pt, child_pt, thread_call)                   \
+    do {                                                                \
+        HURRICANE_PT_INIT(child_pt);                                    \
+        HURRICANE_PT_WAIT_WHILE(pt, HURRICANE_PT_SCHEDULE(thread_call)); \
+    } while (0)
+
+/** Abort the protothread; the next call starts from the top */
+#define HURRICANE_PT_EXIT(pt)                       \
+    do {                                            \
+        HURRICANE_PT_INIT(pt);                      \
+        return HURRICANE_PT_EXITED;                 \
+    } while (0)
+
+/** Restart the protothread from the top on the next call */
+#define HURRICANE_PT_RESTART(pt)                    \
+    do {                                            \
+        HURRICANE_PT_INIT(pt);                      \
+        return HURRICANE_PT_WAITING;                \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
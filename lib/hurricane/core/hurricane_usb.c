@@ -1,38 +1,54 @@
 #include "hurricane_usb.h"
+#include "hurricane_context.h"
 #include "hw/hurricane_hw_hal.h"
+#include "hw/hurricane_hw_ops.h"
 #include "usb/usb_control.h"
+#include "usb_ep0_proxy.h"
+#include "usb_host_control_queue.h"
 #include <stdint.h>
 #include <stdio.h>
 
-hurricane_device_t hurricane_devices[MAX_USB_DEVICES] = {0};
-uint8_t hurricane_device_count = 0;
-
 #if defined(CPU_LPC55S69JBD100_cm33_core0) && !defined(__APPLE__)
 #include "fsl_clock.h"
 #include "fsl_power.h"
 #endif
 
 void hurricane_task(void) {
-    hurricane_hw_poll();
+    hurricane_hw_controllers_poll(); // Each instance once, the link-time HAL as the primary one
+    hurricane_task_ctx(hurricane_default_context());
+}
+
+void hurricane_task_ctx(hurricane_context_t* ctx) {
     for (uint8_t i = 0; i < MAX_USB_DEVICES; i++) {
-        if (!hurricane_devices[i].is_active && hurricane_hw_device_connected()) {
-            hurricane_devices[i].addr = i + 1; // Assign unique address
-            hurricane_devices[i].speed = 2; // Placeholder for speed
-            hurricane_devices[i].is_active = 1;
-            hurricane_device_count++;
+        hurricane_device_t* dev = &ctx->devices[i];
+        if (!dev->is_active && hurricane_hw_host_device_connected_on(ctx->host_controller)) {
+            dev->addr = i + 1; // Assign unique address
+            dev->speed = 2; // Placeholder for speed
+            dev->is_active = 1;
+            dev->controller = ctx->host_controller;
+            dev->ctx = ctx;
+            ctx->device_count++;
             break;
         }
     }
+
+    // Replay device-side EP0 requests on the physical device
+    hurricane_ep0_proxy_task_ctx(ctx);
+    hurricane_host_control_task_ctx(ctx);
 }
 
 hurricane_device_t* hurricane_get_device(uint8_t index) {
-    if (index < hurricane_device_count && hurricane_devices[index].is_active) {
-        return &hurricane_devices[index];
+    return hurricane_get_device_ctx(hurricane_default_context(), index);
+}
+
+hurricane_device_t* hurricane_get_device_ctx(hurricane_context_t* ctx, uint8_t index) {
+    if (index < ctx->device_count && ctx->devices[index].is_active) {
+        return &ctx->devices[index];
     }
     return NULL;
 }
 
 int hurricane_control_transfer(hurricane_device_t* dev, hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t length) {
     if (!dev) return -1;
-    return hurricane_hw_control_transfer(setup, buffer, length);
+    return hurricane_hw_host_control_transfer_on(dev->controller, setup, buffer, length);
 }
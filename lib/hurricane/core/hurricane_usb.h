@@ -4,6 +4,9 @@
 #include "hurricane_hw_hal.h"
 #include "usb_host_config.h"
 #include "device_config.h"
+#include "hurricane_context_fwd.h"
+#include "usb/usb_hid_parser.h"
+#include "usb/usb_hid_transform.h"
 
 // Define the HID device structure
 typedef struct hurricane_hid_device_t {
@@ -14,22 +17,31 @@ typedef struct hurricane_hid_device_t {
     uint16_t report_descriptor_length;
     uint8_t* report_descriptor; // Pointer to report descriptor data
     uint8_t interface_number; // Interface number for this HID device   
+    const hurricane_hid_layout_t* layout; // Compiled report descriptor (NULL until parsed)
+    uint8_t boot_interface; // Boot subclass bInterfaceProtocol (1 keyboard, 2 mouse), 0 if none
+    const hurricane_hid_transform_rule_t* rules; // Transform rules run on this device's reports, NULL if none
+    uint8_t num_rules;
+    uint8_t protocol_policy; // hurricane_hid_protocol_policy_t, chosen by the class setup from rules
 } hurricane_hid_device_t;
 
 typedef struct {
     uint8_t addr;
     uint8_t speed;
     uint8_t is_active;
+    uint8_t controller; // Host controller instance the device is attached to
+    hurricane_context_t *ctx; // Stack context owning the device (NULL = default)
     hurricane_hid_device_t *hid_device;
 } hurricane_device_t;
 
-extern hurricane_device_t hurricane_devices[MAX_USB_DEVICES];
-extern uint8_t hurricane_device_count;
-
 // Initialization and polling
 void hurricane_usb_host_init(void);
 void hurricane_task(void);
 hurricane_device_t* hurricane_get_device(uint8_t index);
 
+// Same on a specific stack context. hurricane_task_ctx() does not poll the
+// HAL; call hurricane_hw_poll()/hurricane_hw_controllers_poll() once per loop.
+void hurricane_task_ctx(hurricane_context_t* ctx);
+hurricane_device_t* hurricane_get_device_ctx(hurricane_context_t* ctx, uint8_t index);
+
 // Control transfer API
 int hurricane_control_transfer(hurricane_device_t* dev, hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t length);
@@ -0,0 +1,336 @@
+/*
+ * @file usb_descriptor_clone.c
+ * @brief Transparent clone of a captured device's descriptors for the device side
+ */
+
+#include "usb_descriptor_clone.h"
+#include "hurricane_context.h"
+#include "hurricane_usb.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define EP_DIR_IN       0x80
+#define EP_NUM_MASK     0x0F
+#define EP_TYPE_MASK    0x03
+#define EP_TYPE_ISO     0x01
+#define EP_TYPE_BULK    0x02
+#define EP_TYPE_INTR    0x03
+
+static hurricane_clone_endpoint_t* find_host_endpoint(hurricane_descriptor_clone_t* clone, uint8_t host_address)
+{
+    for (uint8_t i = 0; i < clone->num_endpoints; i++) {
+        if (clone->endpoints[i].host_address == host_address) {
+            return &clone->endpoints[i];
+        }
+    }
+    return NULL;
+}
+
+// Endpoint number usage per direction, bit n = number n taken
+static bool number_free(const uint32_t used[2], uint8_t number, bool in, bool shared)
+{
+    if (shared) {
+        return !(used[in ? 1 : 0] & (1u << number));
+    }
+    return !((used[0] | used[1]) & (1u << number));
+}
+
+static int assign_endpoints(hurricane_descriptor_clone_t* clone, const hurricane_clone_caps_t* caps)
+{
+    uint32_t used[2] = {0, 0};
+
+    // Keep the original numbers where possible, then fill the gaps
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint8_t i = 0; i < clone->num_endpoints; i++) {
+            hurricane_clone_endpoint_t* ep = &clone->endpoints[i];
+            bool in = (ep->host_address & EP_DIR_IN) != 0;
+            uint8_t number = 0;
+
+            if (ep->device_address) {
+                continue;
+            }
+            if (pass == 0) {
+                uint8_t wanted = ep->host_address & EP_NUM_MASK;
+                if (wanted <= caps->num_endpoints && number_free(used, wanted, in, caps->shared_numbers)) {
+                    number = wanted;
+                }
+            } else {
+                for (uint8_t n = 1; n <= caps->num_endpoints && !number; n++) {
+                    if (number_free(used, n, in, caps->shared_numbers)) {
+                        number = n;
+                    }
+                }
+                if (!number) {
+                    printf("[clone] No device endpoint left for 0x%02X\n", ep->host_address);
+                    return HURRICANE_CLONE_ERR_NO_ENDPOINTS;
+                }
+            }
+
+            if (number) {
+                used[in ? 1 : 0] |= 1u << number;
+                ep->device_address = number | (in ? EP_DIR_IN : 0);
+            }
+        }
+    }
+    return 0;
+}
+
+// bInterval on a full speed bus for a high speed endpoint
+static uint8_t full_speed_interval(uint8_t attributes, uint8_t interval)
+{
+    switch (attributes & EP_TYPE_MASK) {
+        case EP_TYPE_INTR: {
+            // 2^(b-1) microframes -> milliseconds
+            if (interval < 4) {
+                return 1;
+            }
+            uint32_t ms = (1u << (interval - 1)) / 8;
+            return ms > 255 ? 255 : (uint8_t)ms;
+        }
+        case EP_TYPE_ISO:
+            // Both are exponents; a frame is eight microframes
+            return interval > 3 ? interval - 3 : 1;
+        case EP_TYPE_BULK:
+            return 0;
+        default:
+            return interval;
+    }
+}
+
+int hurricane_descriptor_clone_build(hurricane_descriptor_clone_t* clone,
+                                     const uint8_t* device_desc,
+                                     const uint8_t* config_desc, uint16_t config_length,
+                                     const hurricane_clone_caps_t* caps,
+                                     bool source_high_speed)
+{
+    usb_device_descriptor_t device;
+    usb_config_descriptor_t config;
+
+    if (!clone || !device_desc || !config_desc || !caps) {
+        return HURRICANE_CLONE_ERR_INVALID_ARG;
+    }
+
+    memset(clone, 0, sizeof(*clone));
+
+    if (usb_parse_device_descriptor(device_desc, &device) != 0 ||
+        config_length < 9 || usb_parse_config_descriptor(config_desc, &config) != 0 ||
+        config.wTotalLength > config_length) {
+        return HURRICANE_CLONE_ERR_MALFORMED;
+    }
+    if (config.wTotalLength > sizeof(clone->config_descriptor)) {
+        printf("[clone] Configuration descriptor too large (%u bytes)\n", config.wTotalLength);
+        return HURRICANE_CLONE_ERR_NO_SPACE;
+    }
+
+    memcpy(clone->device_descriptor, device_desc, USB_DEVICE_DESCRIPTOR_SIZE);
+    memcpy(clone->config_descriptor, config_desc, config.wTotalLength);
+    clone->config_length = config.wTotalLength;
+
+    // Device descriptor: bcdUSB and EP0 packet size
+    if (device.bcdUSB > 0x0200) {
+        clone->device_descriptor[2] = 0x00;
+        clone->device_descriptor[3] = 0x02;
+    }
+    if (caps->max_packet_size0 && device.bMaxPacketSize0 > caps->max_packet_size0) {
+        clone->device_descriptor[7] = caps->max_packet_size0;
+    }
+
+    // Collect endpoints; alternate settings reuse addresses and share a mapping
+    uint8_t* buf = clone->config_descriptor;
+    for (uint16_t pos = 0; pos + 2 <= clone->config_length; pos += buf[pos]) {
+        if (buf[pos] < 2 || pos + buf[pos] > clone->config_length) {
+            return HURRICANE_CLONE_ERR_MALFORMED;
+        }
+        if (buf[pos + 1] != USB_DESC_TYPE_ENDPOINT || buf[pos] < 7) {
+            continue;
+        }
+        if (find_host_endpoint(clone, buf[pos + 2])) {
+            continue;
+        }
+        if (clone->num_endpoints >= HURRICANE_CLONE_MAX_ENDPOINTS) {
+            return HURRICANE_CLONE_ERR_NO_SPACE;
+        }
+
+        hurricane_clone_endpoint_t* ep = &clone->endpoints[clone->num_endpoints++];
+        uint16_t mps = (uint16_t)(buf[pos + 4] | (buf[pos + 5] << 8));
+        ep->host_address = buf[pos + 2];
+        ep->attributes = buf[pos + 3];
+        // High-bandwidth transactions only exist on high speed
+        ep->max_packet_size = caps->high_speed ? mps : (mps & 0x07FF);
+        if (caps->max_packet_size && (ep->max_packet_size & 0x07FF) > caps->max_packet_size) {
+            ep->max_packet_size = caps->max_packet_size;
+        }
+    }
+
+    int ret = assign_endpoints(clone, caps);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // Rewrite the endpoint descriptors
+    for (uint16_t pos = 0; pos + 2 <= clone->config_length; pos += buf[pos]) {
+        if (buf[pos + 1] != USB_DESC_TYPE_ENDPOINT || buf[pos] < 7) {
+            continue;
+        }
+        const hurricane_clone_endpoint_t* ep = find_host_endpoint(clone, buf[pos + 2]);
+        buf[pos + 2] = ep->device_address;
+        buf[pos + 4] = (uint8_t)ep->max_packet_size;
+        buf[pos + 5] = (uint8_t)(ep->max_packet_size >> 8);
+        if (source_high_speed && !caps->high_speed) {
+            buf[pos + 6] = full_speed_interval(ep->attributes, buf[pos + 6]);
+        }
+    }
+
+    clone->descriptors.device_descriptor = clone->device_descriptor;
+    clone->descriptors.device_descriptor_length = USB_DEVICE_DESCRIPTOR_SIZE;
+    clone->descriptors.config_descriptor = clone->config_descriptor;
+    clone->descriptors.config_descriptor_length = clone->config_length;
+
+    printf("[clone] Cloned %04X:%04X, %u interfaces, %u endpoints\n",
+           device.idVendor, device.idProduct, config.bNumInterfaces, clone->num_endpoints);
+    return 0;
+}
+
+// The HID class descriptors of the interface (every alternate setting) announce the new report length
+static void patch_report_length(hurricane_descriptor_clone_t* clone, uint8_t interface_num, uint16_t length)
+{
+    uint8_t* buf = clone->config_descriptor;
+    bool in_interface = false;
+
+    for (uint16_t pos = 0; pos + 2 <= clone->config_length && buf[pos] >= 2; pos += buf[pos]) {
+        if (buf[pos + 1] == USB_DESC_TYPE_INTERFACE && buf[pos] >= 9) {
+            in_interface = buf[pos + 2] == interface_num;
+        } else if (in_interface && buf[pos + 1] == USB_DESC_TYPE_HID && buf[pos] >= 9) {
+            // bNumDescriptors entries of bDescriptorType, wDescriptorLength
+            for (uint16_t d = 6; d + 3 <= buf[pos] && d < 6 + 3u * buf[pos + 5]; d += 3) {
+                if (buf[pos + d] == USB_DESC_TYPE_REPORT) {
+                    buf[pos + d + 1] = (uint8_t)length;
+                    buf[pos + d + 2] = (uint8_t)(length >> 8);
+                }
+            }
+        }
+    }
+}
+
+int hurricane_descriptor_clone_add_report(hurricane_descriptor_clone_t* clone, uint8_t interface_num,
+                                          const uint8_t* report_desc, uint16_t length)
+{
+    if (!clone || !report_desc || length == 0) {
+        return HURRICANE_CLONE_ERR_INVALID_ARG;
+    }
+    if (clone->num_reports >= HURRICANE_CLONE_MAX_HID ||
+        length > sizeof(clone->report_pool) - clone->report_pool_used) {
+        return HURRICANE_CLONE_ERR_NO_SPACE;
+    }
+
+    hurricane_clone_report_t* report = &clone->reports[clone->num_reports++];
+    report->interface_num = interface_num;
+    report->offset = clone->report_pool_used;
+    report->length = length;
+    memcpy(&clone->report_pool[report->offset], report_desc, length);
+    clone->report_pool_used += length;
+    patch_report_length(clone, interface_num, length);
+
+    if (!clone->descriptors.hid_report_descriptor) {
+        clone->descriptors.hid_report_descriptor = &clone->report_pool[report->offset];
+        clone->descriptors.hid_report_descriptor_length = length;
+    }
+    return 0;
+}
+
+int hurricane_descriptor_clone_add_string(hurricane_descriptor_clone_t* clone, uint8_t index,
+                                          const uint8_t* string_desc, uint16_t length)
+{
+    if (!clone || !string_desc || length < 2 || string_desc[1] != USB_DESC_TYPE_STRING ||
+        index >= MAX_STRING_DESCRIPTORS) {
+        return HURRICANE_CLONE_ERR_INVALID_ARG;
+    }
+    if (length > sizeof(clone->string_pool) - clone->string_pool_used) {
+        return HURRICANE_CLONE_ERR_NO_SPACE;
+    }
+
+    uint8_t* copy = &clone->string_pool[clone->string_pool_used];
+    memcpy(copy, string_desc, length);
+    clone->string_pool_used += length;
+    clone->descriptors.string_descriptors[index] = copy;
+    clone->descriptors.string_descriptor_lengths[index] = length;
+    return 0;
+}
+
+int hurricane_descriptor_clone_from_host_ctx(hurricane_context_t* ctx, hurricane_descriptor_clone_t* clone,
+                                             const hurricane_clone_caps_t* caps, bool source_high_speed)
+{
+    if (!ctx || !clone) {
+        return HURRICANE_CLONE_ERR_INVALID_ARG;
+    }
+
+    usb_host_state_t* host = &ctx->host;
+    if (host->device.state != kHurricane_Host_DeviceStateConfigured) {
+        return HURRICANE_CLONE_ERR_INVALID_ARG;
+    }
+
+    int ret = hurricane_descriptor_clone_build(clone, host->enumeration.device_desc_raw,
+                                               host->config_buffer, host->enumeration.config_length,
+                                               caps, source_high_speed);
+    if (ret < 0) {
+        return ret;
+    }
+
+    hurricane_device_t* dev = hurricane_get_device_ctx(ctx, 0);
+    if (host->device.hid_configured && dev && dev->hid_device &&
+        dev->hid_device->protocol == HURRICANE_HID_PROTOCOL_BOOT) {
+        // The captured device sends boot reports, so the persona describes those
+        uint16_t length = 0;
+        const uint8_t* boot = hurricane_hid_boot_descriptor(dev->hid_device->boot_interface, &length);
+        if (boot) {
+            ret = hurricane_descriptor_clone_add_report(clone, host->device.hid_interface, boot, length);
+        }
+    } else if (host->device.hid_configured && dev && dev->hid_device &&
+               dev->hid_device->report_descriptor && dev->hid_device->report_descriptor_length) {
+        ret = hurricane_descriptor_clone_add_report(clone, host->device.hid_interface,
+                                                    dev->hid_device->report_descriptor,
+                                                    dev->hid_device->report_descriptor_length);
+    }
+    return ret;
+}
+
+const uint8_t* hurricane_descriptor_clone_report(const hurricane_descriptor_clone_t* clone,
+                                                 uint8_t interface_num, uint16_t* length)
+{
+    if (!clone) {
+        return NULL;
+    }
+
+    for (uint8_t i = 0; i < clone->num_reports; i++) {
+        if (clone->reports[i].interface_num == interface_num) {
+            if (length) {
+                *length = clone->reports[i].length;
+            }
+            return &clone->report_pool[clone->reports[i].offset];
+        }
+    }
+    return NULL;
+}
+
+uint8_t hurricane_descriptor_clone_device_endpoint(const hurricane_descriptor_clone_t* clone,
+                                                   uint8_t host_address)
+{
+    for (uint8_t i = 0; clone && i < clone->num_endpoints; i++) {
+        if (clone->endpoints[i].host_address == host_address) {
+            return clone->endpoints[i].device_address;
+        }
+    }
+    return 0;
+}
+
+uint8_t hurricane_descriptor_clone_host_endpoint(const hurricane_descriptor_clone_t* clone,
+                                                 uint8_t device_address)
+{
+    for (uint8_t i = 0; clone && i < clone->num_endpoints; i++) {
+        if (clone->endpoints[i].device_address == device_address) {
+            return clone->endpoints[i].host_address;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file usb_descriptor_clone.h
+ * @brief Transparent clone of a captured device's descriptors for the device side
+ *
+ * Clone mode presents the PC exactly what the captured device presents:
+ * its device descriptor, configuration descriptor, HID report descriptors
+ * and (optionally) string descriptors. Since the PC then sees the same
+ * report format, reports can be forwarded without any translation.
+ *
+ * The configuration is copied byte for byte except for what the device
+ * controller cannot provide:
+ *  - endpoint numbers are remapped onto the controller's endpoints, keeping
+ *    the original number whenever it is available,
+ *  - wMaxPacketSize is clamped to the controller's limit (and loses the
+ *    high-bandwidth bits on a full speed controller),
+ *  - bInterval is converted from microframes to frames when a high speed
+ *    device is cloned onto a full speed controller,
+ *  - bMaxPacketSize0 is clamped, and bcdUSB is capped at 2.00.
+ * Interface numbers are kept, so class requests proxied through
+ * usb_ep0_proxy.h reach the right interface; endpoint-recipient requests
+ * need hurricane_descriptor_clone_host_endpoint().
+ *
+ * Everything lives inside the clone object, no heap is used, and the
+ * descriptor set handed to hurricane_device_update_descriptors() points into
+ * it, so the clone must outlive the device-side configuration.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/usb_descriptor.h"
+#include "core/usb_interface_manager.h"
+#include "core/hurricane_context_fwd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Largest configuration descriptor that can be cloned
+ */
+#ifndef HURRICANE_CLONE_MAX_CONFIG
+#define HURRICANE_CLONE_MAX_CONFIG 256
+#endif
+
+/**
+ * @brief Distinct endpoints of a cloned configuration
+ */
+#ifndef HURRICANE_CLONE_MAX_ENDPOINTS
+#define HURRICANE_CLONE_MAX_ENDPOINTS 16
+#endif
+
+/**
+ * @brief HID interfaces whose report descriptors can be cloned
+ */
+#ifndef HURRICANE_CLONE_MAX_HID
+#define HURRICANE_CLONE_MAX_HID 4
+#endif
+
+/**
+ * @brief Storage shared by all cloned report descriptors
+ */
+#ifndef HURRICANE_CLONE_REPORT_POOL
+#define HURRICANE_CLONE_REPORT_POOL 1024
+#endif
+
+/**
+ * @brief Storage shared by all cloned string descriptors
+ */
+#ifndef HURRICANE_CLONE_STRING_POOL
+#define HURRICANE_CLONE_STRING_POOL 256
+#endif
+
+// Errors
+#define HURRICANE_CLONE_ERR_INVALID_ARG     -1  /**< NULL argument or nothing to clone */
+#define HURRICANE_CLONE_ERR_MALFORMED       -2  /**< Descriptor does not parse */
+#define HURRICANE_CLONE_ERR_NO_ENDPOINTS    -3  /**< Controller has too few endpoints */
+#define HURRICANE_CLONE_ERR_NO_SPACE        -4  /**< A HURRICANE_CLONE_* limit was exceeded */
+
+/**
+ * @brief What the device controller can present
+ */
+typedef struct {
+    uint8_t num_endpoints;          /**< Endpoint numbers 1..num_endpoints exist in each direction */
+    bool shared_numbers;            /**< IN and OUT endpoints may use the same number */
+    bool high_speed;                /**< Controller runs at high speed */
+    uint16_t max_packet_size;       /**< Largest wMaxPacketSize of a non-control endpoint */
+    uint8_t max_packet_size0;       /**< Largest EP0 packet size */
+} hurricane_clone_caps_t;
+
+/**
+ * @brief One remapped endpoint
+ */
+typedef struct {
+    uint8_t host_address;           /**< Address on the captured device */
+    uint8_t device_address;         /**< Address presented to the PC */
+    uint8_t attributes;             /**< bmAttributes */
+    uint16_t max_packet_size;       /**< wMaxPacketSize presented to the PC */
+} hurricane_clone_endpoint_t;
+
+/**
+ * @brief Cloned report descriptor of one interface
+ */
+typedef struct {
+    uint8_t interface_num;
+    uint16_t offset;                /**< Into report_pool */
+    uint16_t length;
+} hurricane_clone_report_t;
+
+/**
+ * @brief A cloned descriptor set
+ */
+typedef struct {
+    uint8_t device_descriptor[USB_DEVICE_DESCRIPTOR_SIZE];
+    uint8_t config_descriptor[HURRICANE_CLONE_MAX_CONFIG];
+    uint16_t config_length;
+    hurricane_clone_endpoint_t endpoints[HURRICANE_CLONE_MAX_ENDPOINTS];
+    uint8_t num_endpoints;
+    hurricane_clone_report_t reports[HURRICANE_CLONE_MAX_HID];
+    uint8_t num_reports;
+    uint8_t report_pool[HURRICANE_CLONE_REPORT_POOL];
+    uint16_t report_pool_used;
+    uint8_t string_pool[HURRICANE_CLONE_STRING_POOL];
+    uint16_t string_pool_used;
+    hurricane_device_descriptors_t descriptors;     /**< Set for hurricane_device_update_descriptors() */
+} hurricane_descriptor_clone_t;
+
+/**
+ * @brief Clone a device and configuration descriptor
+ *
+ * Resets the clone, so report and string descriptors have to be added again.
+ *
+ * @param clone Clone
+ * @param device_desc Device descriptor of the captured device (18 bytes)
+ * @param config_desc Its full configuration descriptor
+ * @param config_length Length of config_desc
+ * @param caps Device controller capabilities
+ * @param source_high_speed The captured device runs at high speed
+ * @return 0 on success, negative HURRICANE_CLONE_ERR_* code on failure
+ */
+int hurricane_descriptor_clone_build(hurricane_descriptor_clone_t* clone,
+                                     const uint8_t* device_desc,
+                                     const uint8_t* config_desc, uint16_t config_length,
+                                     const hurricane_clone_caps_t* caps,
+                                     bool source_high_speed);
+
+/**
+ * @brief Add the HID report descriptor of one interface
+ *
+ * The first report descriptor added is also the one the descriptor set
+ * reports through hid_report_descriptor. The interface's HID class
+ * descriptors in the cloned configuration are updated to its length, so
+ * a persona that differs from the physical device (boot protocol) is
+ * fetched whole.
+ *
+ * @return 0 on success, negative HURRICANE_CLONE_ERR_* code on failure
+ */
+int hurricane_descriptor_clone_add_report(hurricane_descriptor_clone_t* clone, uint8_t interface_num,
+                                          const uint8_t* report_desc, uint16_t length);
+
+/**
+ * @brief Add a string descriptor
+ *
+ * Strings that are not added keep their index and can be served by the EP0
+ * proxy instead.
+ *
+ * @param clone Clone
+ * @param index String index, < MAX_STRING_DESCRIPTORS
+ * @param string_desc Complete string descriptor (bLength, type, UTF-16LE)
+ * @param length Length of string_desc
+ * @return 0 on success, negative HURRICANE_CLONE_ERR_* code on failure
+ */
+int hurricane_descriptor_clone_add_string(hurricane_descriptor_clone_t* clone, uint8_t index,
+                                          const uint8_t* string_desc, uint16_t length);
+
+/**
+ * @brief Clone what the host side of a context enumerated
+ *
+ * Takes the device, configuration and HID report descriptor captured by
+ * the context's enumeration.
+ *
+ * @return 0 on success, negative HURRICANE_CLONE_ERR_* code on failure
+ */
+int hurricane_descriptor_clone_from_host_ctx(hurricane_context_t* ctx, hurricane_descriptor_clone_t* clone,
+                                             const hurricane_clone_caps_t* caps, bool source_high_speed);
+
+/**
+ * @brief Descriptor set for hurricane_device_update_descriptors()
+ */
+static inline hurricane_device_descriptors_t* hurricane_descriptor_clone_descriptors(hurricane_descriptor_clone_t* clone)
+{
+    return &clone->descriptors;
+}
+
+/**
+ * @brief Cloned report descriptor of an interface, for GET_DESCRIPTOR(Report)
+ *
+ * @param clone Clone
+ * @param interface_num Interface number
+ * @param length Output: descriptor length
+ * @return Descriptor, or NULL if none was added for the interface
+ */
+const uint8_t* hurricane_descriptor_clone_report(const hurricane_descriptor_clone_t* clone,
+                                                 uint8_t interface_num, uint16_t* length);
+
+/**
+ * @brief Device-side address of a captured device's endpoint
+ *
+ * @return Endpoint address presented to the PC, 0 if the endpoint is unknown
+ */
+uint8_t hurricane_descriptor_clone_device_endpoint(const hurricane_descriptor_clone_t* clone,
+                                                   uint8_t host_address);
+
+/**
+ * @brief Captured device's address of a device-side endpoint
+ *
+ * @return Endpoint address on the captured device, 0 if the endpoint is unknown
+ */
+uint8_t hurricane_descriptor_clone_host_endpoint(const hurricane_descriptor_clone_t* clone,
+                                                 uint8_t device_address);
+
+#ifdef __cplusplus
+}
+#endif
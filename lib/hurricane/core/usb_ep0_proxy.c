@@ -0,0 +1,326 @@
+/*
+ * @file usb_ep0_proxy.c
+ * @brief Transparent EP0 proxy from the emulated device to the physical device
+ *
+ * The setup handler runs in the device controller's interrupt, the control
+ * queue only in the main loop. The two meet in a single latch: the ISR copies
+ * the newest SETUP (and OUT data) into it and bumps a generation counter, the
+ * task moves it onto the queue. EP0 carries one control transfer at a time and
+ * a new SETUP aborts the previous one, so a reply whose generation is stale is
+ * dropped instead of being sent to the PC.
+ *
+ * Cached replies go the other way: the task writes them, the ISR serves them.
+ * Each entry carries a sequence counter that is odd while the task rewrites
+ * it; the ISR copies a hit into its own buffer and checks the counter again,
+ * so it never sends a half-written reply.
+ */
+
+#include "usb_ep0_proxy.h"
+#include "usb_host_control_queue.h"
+#include "hurricane_context.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define EP0_REQ_DIR_IN          0x80
+#define EP0_REQ_TYPE_MASK       0x60
+#define EP0_REQ_TYPE_STANDARD   0x00
+#define EP0_REQ_TYPE_CLASS      0x20
+
+#define EP0_REQ_GET_DESCRIPTOR  0x06
+#define HID_REQ_GET_REPORT      0x01
+#define HID_REQ_SET_REPORT      0x09
+#define HID_REPORT_TYPE_FEATURE 0x03
+
+static bool is_cacheable(const hurricane_usb_setup_packet_t* setup)
+{
+    if (!(setup->bmRequestType & EP0_REQ_DIR_IN)) {
+        return false;
+    }
+    switch (setup->bmRequestType & EP0_REQ_TYPE_MASK) {
+        case EP0_REQ_TYPE_STANDARD:
+            return setup->bRequest == EP0_REQ_GET_DESCRIPTOR;
+        case EP0_REQ_TYPE_CLASS:
+            return setup->bRequest == HID_REQ_GET_REPORT &&
+                   (setup->wValue >> 8) == HID_REPORT_TYPE_FEATURE;
+        default:
+            return false;
+    }
+}
+
+static bool same_request(const hurricane_usb_setup_packet_t* a, const hurricane_usb_setup_packet_t* b)
+{
+    return a->bmRequestType == b->bmRequestType &&
+           a->bRequest == b->bRequest &&
+           a->wValue == b->wValue &&
+           a->wIndex == b->wIndex;
+}
+
+// A cached reply answers a request if it is at least as long as the new
+// wLength, or if it was already shorter than what was asked for back then
+// (i.e. it holds the complete object). A hit is copied to out, which the
+// ISR owns; the main loop may rewrite the entry as soon as the copy is done.
+static int cache_lookup(const hurricane_ep0_proxy_t* proxy, const hurricane_usb_setup_packet_t* setup, uint8_t* out)
+{
+    for (int i = 0; i < HURRICANE_EP0_PROXY_CACHE_ENTRIES; i++) {
+        const hurricane_ep0_proxy_cache_entry_t* entry = &proxy->cache[i];
+        unsigned int sequence = atomic_load_explicit(&entry->sequence, memory_order_acquire);
+        if ((sequence & 1u) || !entry->valid || !same_request(&entry->setup, setup) ||
+            (setup->wLength > entry->setup.wLength && entry->length >= entry->setup.wLength)) {
+            continue;
+        }
+        uint16_t length = entry->length;
+        memcpy(out, entry->data, length);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&entry->sequence, memory_order_relaxed) == sequence) {
+            return length;
+        }
+    }
+    return -1;
+}
+
+// Odd sequence first, so the ISR skips the entry until it is whole again
+static void cache_write_begin(hurricane_ep0_proxy_cache_entry_t* entry)
+{
+    atomic_fetch_add_explicit(&entry->sequence, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static void cache_write_end(hurricane_ep0_proxy_cache_entry_t* entry)
+{
+    atomic_fetch_add_explicit(&entry->sequence, 1, memory_order_release);
+}
+
+static void cache_store(hurricane_ep0_proxy_t* proxy, const hurricane_usb_setup_packet_t* setup,
+                        const uint8_t* data, uint16_t length)
+{
+    hurricane_ep0_proxy_cache_entry_t* entry = NULL;
+
+    for (int i = 0; i < HURRICANE_EP0_PROXY_CACHE_ENTRIES; i++) {
+        if (proxy->cache[i].valid && same_request(&proxy->cache[i].setup, setup)) {
+            entry = &proxy->cache[i];
+            break;
+        }
+    }
+    if (!entry) {
+        entry = &proxy->cache[proxy->cache_next];
+        proxy->cache_next = (uint8_t)((proxy->cache_next + 1) % HURRICANE_EP0_PROXY_CACHE_ENTRIES);
+    }
+
+    cache_write_begin(entry);
+    entry->setup = *setup;
+    entry->length = length;
+    memcpy(entry->data, data, length);
+    entry->valid = true;
+    cache_write_end(entry);
+}
+
+// SET_REPORT(Feature) changes what GET_REPORT(Feature) returns
+static void cache_invalidate_feature(hurricane_ep0_proxy_t* proxy, const hurricane_usb_setup_packet_t* setup)
+{
+    for (int i = 0; i < HURRICANE_EP0_PROXY_CACHE_ENTRIES; i++) {
+        hurricane_ep0_proxy_cache_entry_t* entry = &proxy->cache[i];
+        if (entry->valid &&
+            entry->setup.bRequest == HID_REQ_GET_REPORT &&
+            entry->setup.wValue == setup->wValue &&
+            entry->setup.wIndex == setup->wIndex) {
+            cache_write_begin(entry);
+            entry->valid = false;
+            cache_write_end(entry);
+        }
+    }
+}
+
+void hurricane_ep0_proxy_init(void)
+{
+    hurricane_ep0_proxy_init_ctx(hurricane_default_context());
+}
+
+void hurricane_ep0_proxy_init_ctx(hurricane_context_t* ctx)
+{
+    hurricane_ep0_proxy_t* proxy = &ctx->ep0_proxy;
+
+    memset(proxy, 0, sizeof(*proxy));
+    proxy->request.user_data = ctx;
+}
+
+void hurricane_ep0_proxy_enable(bool enable)
+{
+    hurricane_ep0_proxy_enable_ctx(hurricane_default_context(), enable);
+}
+
+void hurricane_ep0_proxy_enable_ctx(hurricane_context_t* ctx, bool enable)
+{
+    hurricane_ep0_proxy_t* proxy = &ctx->ep0_proxy;
+
+    proxy->enabled = enable;
+    if (!enable) {
+        proxy->latched = false;
+        proxy->generation++;
+    }
+    printf("[EP0 proxy] %s\n", enable ? "Enabled" : "Disabled");
+}
+
+void hurricane_ep0_proxy_bind(uint8_t device, uint8_t host)
+{
+    hurricane_context_t* ctx = hurricane_default_context();
+    ctx->device_controller = device;
+    ctx->host_controller = host;
+}
+
+bool hurricane_ep0_proxy_enabled(void)
+{
+    return hurricane_default_context()->ep0_proxy.enabled;
+}
+
+void hurricane_ep0_proxy_invalidate(void)
+{
+    hurricane_ep0_proxy_invalidate_ctx(hurricane_default_context());
+}
+
+void hurricane_ep0_proxy_invalidate_ctx(hurricane_context_t* ctx)
+{
+    for (int i = 0; i < HURRICANE_EP0_PROXY_CACHE_ENTRIES; i++) {
+        hurricane_ep0_proxy_cache_entry_t* entry = &ctx->ep0_proxy.cache[i];
+        cache_write_begin(entry);
+        entry->valid = false;
+        cache_write_end(entry);
+    }
+    ctx->ep0_proxy.cache_next = 0;
+}
+
+void hurricane_ep0_proxy_get_stats(hurricane_ep0_proxy_stats_t* out)
+{
+    if (out) {
+        *out = hurricane_default_context()->ep0_proxy.stats;
+    }
+}
+
+hurricane_ep0_proxy_result_t hurricane_ep0_proxy_setup(const hurricane_usb_setup_packet_t* setup,
+                                                       const void* data,
+                                                       uint16_t length)
+{
+    return hurricane_ep0_proxy_setup_ctx(hurricane_default_context(), setup, data, length);
+}
+
+hurricane_ep0_proxy_result_t hurricane_ep0_proxy_setup_ctx(hurricane_context_t* ctx,
+                                                           const hurricane_usb_setup_packet_t* setup,
+                                                           const void* data,
+                                                           uint16_t length)
+{
+    hurricane_ep0_proxy_t* proxy = &ctx->ep0_proxy;
+
+    if (!proxy->enabled || !setup || setup->wLength > HURRICANE_EP0_PROXY_BUFFER_SIZE) {
+        return HURRICANE_EP0_PROXY_NOT_HANDLED;
+    }
+
+    bool is_in = (setup->bmRequestType & EP0_REQ_DIR_IN) != 0;
+    if (!is_in && setup->wLength > 0 && (!data || length < setup->wLength)) {
+        // OUT data stage has not been received yet
+        return HURRICANE_EP0_PROXY_NOT_HANDLED;
+    }
+
+    // Any new SETUP supersedes whatever is still latched or in flight
+    proxy->latched = false;
+    proxy->generation++;
+
+    if (is_cacheable(setup)) {
+        // IN request: the latch buffer is free for the reply, and the task rechecks the generation
+        int cached = cache_lookup(proxy, setup, proxy->latched_data);
+        if (cached >= 0) {
+            uint16_t reply = (uint16_t)cached < setup->wLength ? (uint16_t)cached : setup->wLength;
+            proxy->stats.cache_hits++;
+            hurricane_hw_device_control_response_on(ctx->device_controller, setup, proxy->latched_data, reply);
+            return HURRICANE_EP0_PROXY_COMPLETED;
+        }
+    }
+
+    proxy->latched_setup = *setup;
+    if (!is_in && setup->wLength > 0) {
+        memcpy(proxy->latched_data, data, setup->wLength);
+    }
+    proxy->latched = true;
+    return HURRICANE_EP0_PROXY_PENDING;
+}
+
+static void ep0_proxy_complete(hurricane_control_request_t* req)
+{
+    hurricane_context_t* ctx = (hurricane_context_t*)req->user_data;
+    hurricane_ep0_proxy_t* proxy = &ctx->ep0_proxy;
+    const hurricane_usb_setup_packet_t* setup = &req->setup;
+    bool is_in = (setup->bmRequestType & EP0_REQ_DIR_IN) != 0;
+
+    if (proxy->request_generation != proxy->generation) {
+        // The PC gave up on this request and sent a new SETUP
+        proxy->stats.superseded++;
+        return;
+    }
+
+    if (req->status != HURRICANE_CONTROL_DONE) {
+        printf("[EP0 proxy] Request 0x%02X/0x%02X failed on the physical device (%d)\n",
+               setup->bmRequestType, setup->bRequest, req->result);
+        proxy->stats.failed++;
+        hurricane_hw_device_endpoint_stall_on(ctx->device_controller, is_in ? 0x80 : 0x00, true);
+        return;
+    }
+
+    if (is_in) {
+        uint16_t reply = (uint16_t)req->result;
+        if (reply > setup->wLength) {
+            reply = setup->wLength;
+        }
+        if (is_cacheable(setup)) {
+            cache_store(proxy, setup, proxy->request_buffer, reply);
+        }
+        hurricane_hw_device_control_response_on(ctx->device_controller, setup, proxy->request_buffer, reply);
+    } else {
+        if ((setup->bmRequestType & EP0_REQ_TYPE_MASK) == EP0_REQ_TYPE_CLASS &&
+            setup->bRequest == HID_REQ_SET_REPORT &&
+            (setup->wValue >> 8) == HID_REPORT_TYPE_FEATURE) {
+            cache_invalidate_feature(proxy, setup);
+        }
+        // Status stage of an OUT request is a zero-length IN packet
+        hurricane_usb_setup_packet_t status = *setup;
+        status.bmRequestType |= EP0_REQ_DIR_IN;
+        hurricane_hw_device_control_response_on(ctx->device_controller, &status, NULL, 0);
+    }
+}
+
+void hurricane_ep0_proxy_task(void)
+{
+    hurricane_ep0_proxy_task_ctx(hurricane_default_context());
+}
+
+void hurricane_ep0_proxy_task_ctx(hurricane_context_t* ctx)
+{
+    hurricane_ep0_proxy_t* proxy = &ctx->ep0_proxy;
+
+    if (!proxy->enabled || !proxy->latched || hurricane_host_control_pending(&proxy->request)) {
+        return;
+    }
+
+    uint8_t gen = proxy->generation;
+    hurricane_usb_setup_packet_t setup = proxy->latched_setup;
+    bool is_in = (setup.bmRequestType & EP0_REQ_DIR_IN) != 0;
+    if (!is_in && setup.wLength > 0) {
+        memcpy(proxy->request_buffer, proxy->latched_data, setup.wLength);
+    }
+    proxy->latched = false;
+    if (gen != proxy->generation) {
+        // Interrupted by a newer SETUP while copying; pick that one up next time
+        proxy->latched = true;
+        return;
+    }
+
+    hurricane_host_control_prepare(&proxy->request, setup.bmRequestType, setup.bRequest,
+                                   setup.wValue, setup.wIndex,
+                                   setup.wLength ? proxy->request_buffer : NULL, setup.wLength);
+    proxy->request.complete = ep0_proxy_complete;
+    proxy->request.user_data = ctx;
+    proxy->request.controller = ctx->host_controller;
+    proxy->request_generation = gen;
+
+    if (hurricane_host_control_submit_ctx(ctx, &proxy->request) == 0) {
+        proxy->stats.forwarded++;
+    }
+}
@@ -0,0 +1,182 @@
+/**
+ * @file usb_ep0_proxy.h
+ * @brief Transparent EP0 proxy from the emulated device to the physical device
+ *
+ * Control requests the device-side stack cannot answer itself (class and
+ * vendor requests, string descriptors, ...) are handed to the proxy from the
+ * device controller's setup handler. The proxy latches the request, replays it
+ * on the host side through the asynchronous control queue and completes the
+ * device-side data/status stage once the physical device has answered. Until
+ * then EP0 is simply left unprimed, so the controller NAKs the PC instead of
+ * the ISR blocking on the host transfer.
+ *
+ * Replies to GET_DESCRIPTOR and GET_REPORT(Feature) are cached per request
+ * and served straight from the setup handler the next time they are asked for.
+ *
+ * Interface numbers and endpoints are forwarded unchanged, so the emulated
+ * configuration must mirror the physical device for proxied requests.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "hw/hurricane_hw_hal.h"
+#include "hw/hurricane_hw_ops.h"
+#include "core/usb_host_control_queue.h"
+#include "core/hurricane_context_fwd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Largest data stage the proxy can forward
+ */
+#ifndef HURRICANE_EP0_PROXY_BUFFER_SIZE
+#define HURRICANE_EP0_PROXY_BUFFER_SIZE 256
+#endif
+
+/**
+ * @brief Number of cached replies
+ */
+#ifndef HURRICANE_EP0_PROXY_CACHE_ENTRIES
+#define HURRICANE_EP0_PROXY_CACHE_ENTRIES 6
+#endif
+
+/**
+ * @brief Result of handing a setup packet to the proxy
+ */
+typedef enum {
+    HURRICANE_EP0_PROXY_NOT_HANDLED = 0,    /**< Proxy disabled or request not forwardable */
+    HURRICANE_EP0_PROXY_COMPLETED,          /**< Answered from the cache */
+    HURRICANE_EP0_PROXY_PENDING             /**< Forwarded, EP0 must NAK until completion */
+} hurricane_ep0_proxy_result_t;
+
+/**
+ * @brief Proxy statistics
+ */
+typedef struct {
+    uint32_t forwarded;     /**< Requests replayed on the host side */
+    uint32_t cache_hits;    /**< Requests served from the cache */
+    uint32_t superseded;    /**< Replies dropped because a newer SETUP arrived */
+    uint32_t failed;        /**< Requests the physical device rejected (EP0 stalled) */
+} hurricane_ep0_proxy_stats_t;
+
+/**
+ * @brief Cached reply
+ *
+ * Written by the main loop, read by the setup ISR; the sequence is odd
+ * while the entry is being rewritten, so a reader can tell a torn copy.
+ */
+typedef struct {
+    atomic_uint sequence;
+    bool valid;
+    hurricane_usb_setup_packet_t setup;     /**< Request that produced the reply */
+    uint16_t length;                        /**< Reply length */
+    uint8_t data[HURRICANE_EP0_PROXY_BUFFER_SIZE];
+} hurricane_ep0_proxy_cache_entry_t;
+
+/**
+ * @brief Proxy state of one stack context
+ */
+typedef struct {
+    bool enabled;
+
+    // Written by the setup ISR
+    volatile bool latched;
+    volatile uint8_t generation;
+    hurricane_usb_setup_packet_t latched_setup;
+    uint8_t latched_data[HURRICANE_EP0_PROXY_BUFFER_SIZE];    /**< OUT data, or the cached reply being sent */
+
+    // Owned by the main loop
+    hurricane_control_request_t request;
+    uint8_t request_generation;
+    uint8_t request_buffer[HURRICANE_EP0_PROXY_BUFFER_SIZE];
+
+    hurricane_ep0_proxy_cache_entry_t cache[HURRICANE_EP0_PROXY_CACHE_ENTRIES];
+    uint8_t cache_next;
+
+    hurricane_ep0_proxy_stats_t stats;
+} hurricane_ep0_proxy_t;
+
+/**
+ * @brief Reset the proxy (disabled, empty cache, nothing in flight)
+ */
+void hurricane_ep0_proxy_init(void);
+
+/**
+ * @brief Enable or disable forwarding
+ *
+ * @param enable true to forward unhandled requests to the physical device
+ */
+void hurricane_ep0_proxy_enable(bool enable);
+
+/**
+ * @brief Check whether forwarding is enabled
+ *
+ * @return true if enabled
+ */
+bool hurricane_ep0_proxy_enabled(void);
+
+/**
+ * @brief Select the controllers the default context bridges
+ *
+ * Both default to the primary controller. This sets the controllers of the
+ * whole default context, i.e. enumeration and the interface manager follow.
+ *
+ * @param device_controller Device controller instance facing the PC
+ * @param host_controller Host controller instance the physical device is on
+ */
+void hurricane_ep0_proxy_bind(uint8_t device_controller, uint8_t host_controller);
+
+/**
+ * @brief Hand a device-side setup packet to the proxy (ISR safe)
+ *
+ * @param setup Setup packet received from the PC
+ * @param data OUT data stage, already received (NULL for IN/no-data requests)
+ * @param length Length of the OUT data stage
+ * @return hurricane_ep0_proxy_result_t value
+ */
+hurricane_ep0_proxy_result_t hurricane_ep0_proxy_setup(
+    const hurricane_usb_setup_packet_t* setup,
+    const void* data,
+    uint16_t length
+);
+
+/**
+ * @brief Move latched requests onto the host control queue (main loop)
+ *
+ * Completed replies are delivered to the device side from the control
+ * queue's completion callback, i.e. from hurricane_host_control_task().
+ */
+void hurricane_ep0_proxy_task(void);
+
+/**
+ * @brief Drop all cached replies (e.g. after the physical device changed)
+ */
+void hurricane_ep0_proxy_invalidate(void);
+
+/**
+ * @brief Read proxy statistics
+ *
+ * @param stats Output structure
+ */
+void hurricane_ep0_proxy_get_stats(hurricane_ep0_proxy_stats_t* stats);
+
+// The same operations on a specific stack context
+void hurricane_ep0_proxy_init_ctx(hurricane_context_t* ctx);
+void hurricane_ep0_proxy_enable_ctx(hurricane_context_t* ctx, bool enable);
+hurricane_ep0_proxy_result_t hurricane_ep0_proxy_setup_ctx(
+    hurricane_context_t* ctx,
+    const hurricane_usb_setup_packet_t* setup,
+    const void* data,
+    uint16_t length
+);
+void hurricane_ep0_proxy_task_ctx(hurricane_context_t* ctx);
+void hurricane_ep0_proxy_invalidate_ctx(hurricane_context_t* ctx);
+
+#ifdef __cplusplus
+}
+#endif
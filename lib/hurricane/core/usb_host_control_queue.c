@@ -0,0 +1,117 @@
+/*
+ * @file usb_host_control_queue.c
+ * @brief Asynchronous host-side control transfer queue
+ *
+ * The HAL control transfer entry point is still synchronous on current
+ * boards, so the queue issues one request per task call. Because callers only
+ * ever observe completion through the request status, a HAL that completes
+ * transfers from its interrupt can replace the call in
+ * hurricane_host_control_task() without touching any caller.
+ */
+
+#include "usb_host_control_queue.h"
+#include "hurricane_context.h"
+#include <stddef.h>
+#include <stdio.h>
+
+void hurricane_host_control_prepare(hurricane_control_request_t* request,
+                                    uint8_t bmRequestType,
+                                    uint8_t bRequest,
+                                    uint16_t wValue,
+                                    uint16_t wIndex,
+                                    void* buffer,
+                                    uint16_t length)
+{
+    request->setup.bmRequestType = bmRequestType;
+    request->setup.bRequest = bRequest;
+    request->setup.wValue = wValue;
+    request->setup.wIndex = wIndex;
+    request->setup.wLength = length;
+    request->buffer = buffer;
+    request->length = length;
+}
+
+int hurricane_host_control_submit(hurricane_control_request_t* request)
+{
+    return hurricane_host_control_submit_ctx(hurricane_default_context(), request);
+}
+
+int hurricane_host_control_submit_ctx(hurricane_context_t* ctx, hurricane_control_request_t* request)
+{
+    hurricane_control_queue_t* queue = &ctx->control_queue;
+
+    if (!request) {
+        return -1;
+    }
+    if (request->status == HURRICANE_CONTROL_QUEUED) {
+        printf("[control queue] Error: request already queued\n");
+        return -1;
+    }
+
+    request->result = 0;
+    request->next = NULL;
+    request->status = HURRICANE_CONTROL_QUEUED;
+
+    if (queue->tail) {
+        queue->tail->next = request;
+    } else {
+        queue->head = request;
+    }
+    queue->tail = request;
+    return 0;
+}
+
+bool hurricane_host_control_pending(const hurricane_control_request_t* request)
+{
+    return request && request->status == HURRICANE_CONTROL_QUEUED;
+}
+
+void hurricane_host_control_task(void)
+{
+    hurricane_host_control_task_ctx(hurricane_default_context());
+}
+
+void hurricane_host_control_task_ctx(hurricane_context_t* ctx)
+{
+    hurricane_control_queue_t* queue = &ctx->control_queue;
+    hurricane_control_request_t* request = queue->head;
+    if (!request) {
+        return;
+    }
+
+    queue->head = request->next;
+    if (!queue->head) {
+        queue->tail = NULL;
+    }
+    request->next = NULL;
+
+    request->result = hurricane_hw_host_control_transfer_on(request->controller, &request->setup,
+                                                           request->buffer, request->length);
+    request->status = (request->result >= 0) ? HURRICANE_CONTROL_DONE : HURRICANE_CONTROL_FAILED;
+
+    if (request->complete) {
+        request->complete(request);
+    }
+}
+
+void hurricane_host_control_cancel_all(void)
+{
+    hurricane_host_control_cancel_all_ctx(hurricane_default_context());
+}
+
+void hurricane_host_control_cancel_all_ctx(hurricane_context_t* ctx)
+{
+    hurricane_control_queue_t* queue = &ctx->control_queue;
+
+    while (queue->head) {
+        hurricane_control_request_t* request = queue->head;
+        queue->head = request->next;
+        request->next = NULL;
+        request->result = -1;
+        request->status = HURRICANE_CONTROL_FAILED;
+        if (request->complete) {
+            request->complete(request);
+        }
+    }
+    queue->tail = NULL;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file usb_host_control_queue.h
+ * @brief Asynchronous host-side control transfer queue
+ *
+ * Control transfers are described by caller-owned request blocks that are
+ * linked into a FIFO, so queuing never allocates. hurricane_host_control_task()
+ * issues at most one request per call, which bounds the time any single
+ * main-loop iteration spends on EP0. Protothreads wait for completion with
+ * HURRICANE_PT_CONTROL_TRANSFER().
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hw/hurricane_hw_hal.h"
+#include "hw/hurricane_hw_ops.h"
+#include "core/hurricane_pt.h"
+#include "core/hurricane_context_fwd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Lifecycle of a control request block
+ */
+typedef enum {
+    HURRICANE_CONTROL_IDLE = 0,    /**< Never submitted */
+    HURRICANE_CONTROL_QUEUED,      /**< Waiting in the queue */
+    HURRICANE_CONTROL_DONE,        /**< Completed, result holds the byte count */
+    HURRICANE_CONTROL_FAILED       /**< Completed, result holds the error code */
+} hurricane_control_status_t;
+
+/**
+ * @brief Host control transfer request
+ */
+typedef struct hurricane_control_request {
+    hurricane_usb_setup_packet_t setup;   /**< Setup packet to send */
+    void* buffer;                          /**< Data stage buffer (may be NULL) */
+    uint16_t length;                       /**< Data stage buffer size */
+    uint8_t controller;                    /**< Host controller instance (0 = primary) */
+    int result;                            /**< Bytes transferred or negative error */
+    volatile hurricane_control_status_t status;  /**< Current request status */
+    void (*complete)(struct hurricane_control_request* request);  /**< Optional completion callback */
+    void* user_data;                       /**< Caller context for the callback */
+    struct hurricane_control_request* next;  /**< Queue link (owned by the queue) */
+} hurricane_control_request_t;
+
+/**
+ * @brief Control request FIFO of one stack context
+ */
+typedef struct {
+    hurricane_control_request_t* head;
+    hurricane_control_request_t* tail;
+} hurricane_control_queue_t;
+
+/**
+ * @brief Fill a request block with a setup packet and data buffer
+ *
+ * @param request Request block to fill
+ * @param bmRequestType Request type
+ * @param bRequest Request code
+ * @param wValue Request value
+ * @param wIndex Request index
+ * @param buffer Data stage buffer (may be NULL)
+ * @param length Data stage length, also used as wLength
+ */
+void hurricane_host_control_prepare(
+    hurricane_control_request_t* request,
+    uint8_t bmRequestType,
+    uint8_t bRequest,
+    uint16_t wValue,
+    uint16_t wIndex,
+    void* buffer,
+    uint16_t length
+);
+
+/**
+ * @brief Queue a control request on the default context
+ *
+ * @param request Request block; must stay valid until it completes
+ * @return 0 on success, negative error code if the request is already queued
+ */
+int hurricane_host_control_submit(hurricane_control_request_t* request);
+
+/**
+ * @brief Queue a control request on a specific context
+ *
+ * @param ctx Stack context
+ * @param request Request block; must stay valid until it completes
+ * @return 0 on success, negative error code if the request is already queued
+ */
+int hurricane_host_control_submit_ctx(hurricane_context_t* ctx, hurricane_control_request_t* request);
+
+/**
+ * @brief Check whether a request is still waiting for completion
+ *
+ * @param request Request block
+ * @return true while the request is queued
+ */
+bool hurricane_host_control_pending(const hurricane_control_request_t* request);
+
+/**
+ * @brief Issue the next queued control request of the default context, if any
+ *
+ * Completes at most one request per call and runs its completion callback.
+ */
+void hurricane_host_control_task(void);
+
+/**
+ * @brief Issue the next queued control request of a context, if any
+ *
+ * @param ctx Stack context
+ */
+void hurricane_host_control_task_ctx(hurricane_context_t* ctx);
+
+/**
+ * @brief Fail every queued request of the default context (e.g. on device detach)
+ */
+void hurricane_host_control_cancel_all(void);
+
+/**
+ * @brief Fail every queued request of a context
+ *
+ * @param ctx Stack context
+ */
+void hurricane_host_control_cancel_all_ctx(hurricane_context_t* ctx);
+
+/**
+ * @brief Queue a request from a protothread and wait for it to complete
+ *
+ * The request status is DONE or FAILED when the thread resumes.
+ */
+#define HURRICANE_PT_CONTROL_TRANSFER(pt, request)                              \
+    do {                                                                        \
+        hurricane_host_control_submit(request);                                 \
+        HURRICANE_PT_WAIT_WHILE(pt, hurricane_host_control_pending(request));   \
+    } while (0)
+
+/**
+ * @brief HURRICANE_PT_CONTROL_TRANSFER() on a specific context
+ */
+#define HURRICANE_PT_CONTROL_TRANSFER_CTX(pt, ctx, request)                     \
+    do {                                                                        \
+        hurricane_host_control_submit_ctx(ctx, request);                        \
+        HURRICANE_PT_WAIT_WHILE(pt, hurricane_host_control_pending(request));   \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
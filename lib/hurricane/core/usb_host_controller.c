@@ -2,6 +2,10 @@
 #include "hw/hurricane_hw_hal.h"
 #include "usb/usb_control.h"
 #include "usb/usb_hid.h"
+#include "core/usb_host_control_queue.h"
+#include "core/usb_ep0_proxy.h"
+#include "core/hurricane_pt.h"
+#include "core/hurricane_context.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,147 +14,252 @@
 // C99 boolean support
 #include <stdbool.h>
 
-static usb_device_t device;
-
-// Buffer for configuration descriptor
-static uint8_t config_buffer[256];
-
 // Forward declaration of helper functions
-static int usb_get_config_descriptor(uint8_t config_index);
-static int usb_parse_configuration(uint8_t* buffer, uint16_t len);
-static int usb_set_configuration(uint8_t config_value);
-static int usb_find_hid_interface(uint8_t* buffer, uint16_t len, uint8_t* interface_num, uint8_t* endpoint_addr);
+static HURRICANE_PT_THREAD(usb_host_enumerate_thread(hurricane_context_t* ctx, usb_host_enumeration_t* e));
+static int usb_parse_configuration(hurricane_context_t* ctx, uint8_t* buffer, uint16_t len);
+static int usb_find_hid_interface(uint8_t* buffer, uint16_t len, uint8_t* interface_num, uint8_t* endpoint_addr,
+                                  uint8_t* boot_protocol);
 
 void usb_host_init(void)
 {
-    device.state = kUSB_DeviceStateConfigured;
-    device.device_address = 0;
+    usb_host_init_ctx(hurricane_default_context());
+}
+
+void usb_host_init_ctx(hurricane_context_t* ctx)
+{
+    usb_host_state_t* host = &ctx->host;
+
+    host->device.state = kHurricane_Host_DeviceStateDefault;
+    host->device.device_address = 0;
+    HURRICANE_PT_INIT(&host->enumeration.pt);
+    hurricane_host_control_cancel_all_ctx(ctx);
     
-    hurricane_hw_reset_bus(); // Reset the USB bus
+    hurricane_hw_host_reset_bus_on(ctx->host_controller); // Reset the USB bus
     printf("[host] Bus reset initiated\n");
 }
 
+void usb_host_set_controller(uint8_t instance)
+{
+    hurricane_default_context()->host_controller = instance;
+}
+
 void usb_host_poll(void)
 {
-    switch (device.state)
-    {
-        case kUSB_DeviceStateDefault:
-            printf("[host] Setting device address...\n");
-            if (usb_control_set_address(1) != 0) {
-                printf("[host] Error setting device address.\n");
-                break;
-            }
-            device.device_address = 1;
-            device.state = kUSB_DeviceStateAddress;
-            break;
+    usb_host_poll_ctx(hurricane_default_context());
+}
 
-        case kUSB_DeviceStateAddress:
-            printf("[host] Fetching device descriptor...\n");
-            if (usb_control_get_device_descriptor(device.device_address, &device.device_desc) != 0) {
-                printf("[host] Error fetching device descriptor.\n");
-                break;
-            }
-            
-            // Get first configuration descriptor (index 0)
-            printf("[host] Fetching configuration descriptor...\n");
-            if (usb_get_config_descriptor(0) != 0) {
-                printf("[host] Error fetching configuration descriptor.\n");
-                break;
-            }
-            
-            // Set configuration (usually 1 is the default)
-            printf("[host] Setting configuration...\n");
-            if (usb_set_configuration(1) != 0) {
-                printf("[host] Error setting configuration.\n");
-                break;
+void usb_host_poll_ctx(hurricane_context_t* ctx)
+{
+    usb_host_state_t* host = &ctx->host;
+
+    switch (host->device.state)
+    {
+        case kHurricane_Host_DeviceStateDefault:
+        case kHurricane_Host_DeviceStateAddress:
+            // Advance enumeration by at most one control transfer per poll
+            if (!HURRICANE_PT_SCHEDULE(usb_host_enumerate_thread(ctx, &host->enumeration)) &&
+                host->device.state != kHurricane_Host_DeviceStateConfigured) {
+                printf("[host] Enumeration failed, retrying\n");
+                host->device.state = kHurricane_Host_DeviceStateDefault;
             }
-            
-            device.state = kUSB_DeviceStateConfigured;
+            hurricane_host_control_task_ctx(ctx);
             break;
 
-        case kUSB_DeviceStateConfigured:
+        case kHurricane_Host_DeviceStateConfigured:
             // Device is configured, handle class-specific tasks
             // If HID interface was found, poll it
-            if (device.hid_configured) {
+            if (host->device.hid_configured) {
                 // Get HID device handle from our device table
-                hurricane_device_t* dev = hurricane_get_device(0);
+                hurricane_device_t* dev = hurricane_get_device_ctx(ctx, 0);
                 if (dev && dev->is_active && dev->hid_device) {
                     hurricane_hid_task(dev);
                 }
             }
+            // Class requests queued after enumeration (e.g. SET_REPORT)
+            hurricane_host_control_task_ctx(ctx);
             break;
 
         default:
             printf("[host] Device in error state. Resetting...\n");
-            hurricane_hw_reset_bus();
-            device.state = kUSB_DeviceStateDefault;
+            hurricane_hw_host_reset_bus_on(ctx->host_controller);
+            HURRICANE_PT_INIT(&host->enumeration.pt);
+            hurricane_host_control_cancel_all_ctx(ctx);
+            host->device.state = kHurricane_Host_DeviceStateDefault;
             break;
     }
 }
 
-// Helper to fetch and process configuration descriptor
-static int usb_get_config_descriptor(uint8_t config_index)
+// Enumerate the attached device. Reads top to bottom like the blocking
+// sequence it replaces, but returns to usb_host_poll() at every transfer.
+static HURRICANE_PT_THREAD(usb_host_enumerate_thread(hurricane_context_t* ctx, usb_host_enumeration_t* e))
 {
-    hurricane_usb_setup_packet_t setup = {
-        .bmRequestType = 0x80,  // Device to Host, Standard, Device
-        .bRequest = USB_REQ_GET_DESCRIPTOR,
-        .wValue = (USB_DESC_TYPE_CONFIGURATION << 8) | config_index,
-        .wIndex = 0,
-        .wLength = 9  // Initially just get the header to determine total size
-    };
-    
-    memset(config_buffer, 0, sizeof(config_buffer));
-    
-    // First, get just the configuration descriptor header (9 bytes)
-    if (hurricane_hw_control_transfer(&setup, config_buffer, 9) < 9) {
+    usb_host_state_t* host = &ctx->host;
+
+    HURRICANE_PT_BEGIN(&e->pt);
+
+    // Replies cached from a previous device must not be served for this one
+    hurricane_ep0_proxy_invalidate_ctx(ctx);
+    e->request.controller = ctx->host_controller;
+
+    printf("[host] Setting device address...\n");
+    hurricane_host_control_prepare(&e->request,
+                                   USB_REQ_TYPE_STANDARD | USB_REQ_RECIPIENT_DEVICE,
+                                   USB_REQ_SET_ADDRESS, 1, 0, NULL, 0);
+    HURRICANE_PT_CONTROL_TRANSFER_CTX(&e->pt, ctx, &e->request);
+    if (e->request.status != HURRICANE_CONTROL_DONE) {
+        printf("[host] Error setting device address.\n");
+        HURRICANE_PT_EXIT(&e->pt);
+    }
+    host->device.device_address = 1;
+    host->device.state = kHurricane_Host_DeviceStateAddress;
+
+    printf("[host] Fetching device descriptor...\n");
+    hurricane_host_control_prepare(&e->request,
+                                   0x80,  // Device to Host, Standard, Device
+                                   USB_REQ_GET_DESCRIPTOR,
+                                   (USB_DESC_TYPE_DEVICE << 8), 0,
+                                   e->device_desc_raw, sizeof(e->device_desc_raw));
+    HURRICANE_PT_CONTROL_TRANSFER_CTX(&e->pt, ctx, &e->request);
+    if (e->request.result <= 0 ||
+        usb_parse_device_descriptor(e->device_desc_raw, &host->device.device_desc) != 0) {
+        printf("[host] Error fetching device descriptor.\n");
+        HURRICANE_PT_EXIT(&e->pt);
+    }
+
+    // Get first configuration descriptor (index 0), header first to learn the total size
+    printf("[host] Fetching configuration descriptor...\n");
+    memset(host->config_buffer, 0, sizeof(host->config_buffer));
+    hurricane_host_control_prepare(&e->request,
+                                   0x80,  // Device to Host, Standard, Device
+                                   USB_REQ_GET_DESCRIPTOR,
+                                   (USB_DESC_TYPE_CONFIGURATION << 8), 0,
+                                   host->config_buffer, 9);
+    HURRICANE_PT_CONTROL_TRANSFER_CTX(&e->pt, ctx, &e->request);
+    if (e->request.result < 9) {
         printf("[host] Failed to get configuration descriptor header\n");
-        return -1;
+        HURRICANE_PT_EXIT(&e->pt);
     }
-    
-    // Parse the configuration descriptor to get the total length
-    usb_config_descriptor_t config_desc;
-    if (usb_parse_config_descriptor(config_buffer, &config_desc) != 0) {
-        printf("[host] Failed to parse configuration descriptor\n");
-        return -1;
+
+    {
+        usb_config_descriptor_t config_desc;
+        if (usb_parse_config_descriptor(host->config_buffer, &config_desc) != 0) {
+            printf("[host] Failed to parse configuration descriptor\n");
+            HURRICANE_PT_EXIT(&e->pt);
+        }
+        e->config_length = config_desc.wTotalLength;
     }
-    
-    uint16_t total_length = config_desc.wTotalLength;
-    printf("[host] Configuration descriptor total length: %u bytes\n", total_length);
-    
-    if (total_length > sizeof(config_buffer)) {
+    printf("[host] Configuration descriptor total length: %u bytes\n", e->config_length);
+
+    if (e->config_length > sizeof(host->config_buffer)) {
         printf("[host] Configuration descriptor too large for buffer\n");
-        total_length = sizeof(config_buffer);
+        e->config_length = sizeof(host->config_buffer);
     }
-    
+
     // Now get the complete configuration descriptor with all interfaces and endpoints
-    setup.wLength = total_length;
-    if (hurricane_hw_control_transfer(&setup, config_buffer, total_length) < total_length) {
+    hurricane_host_control_prepare(&e->request,
+                                   0x80,  // Device to Host, Standard, Device
+                                   USB_REQ_GET_DESCRIPTOR,
+                                   (USB_DESC_TYPE_CONFIGURATION << 8), 0,
+                                   host->config_buffer, e->config_length);
+    HURRICANE_PT_CONTROL_TRANSFER_CTX(&e->pt, ctx, &e->request);
+    if (e->request.result < e->config_length) {
         printf("[host] Failed to get complete configuration descriptor\n");
-        return -1;
+        HURRICANE_PT_EXIT(&e->pt);
     }
-    
+
     // Process the configuration to find interfaces and endpoints
-    return usb_parse_configuration(config_buffer, total_length);
+    if (usb_parse_configuration(ctx, host->config_buffer, e->config_length) != 0) {
+        HURRICANE_PT_EXIT(&e->pt);
+    }
+
+    e->hid_setup.dev = NULL;
+    if (host->device.hid_configured) {
+        hurricane_device_t* dev = hurricane_get_device_ctx(ctx, 0);
+        if (dev && dev->is_active && dev->hid_device) {
+            dev->controller = ctx->host_controller;
+            hurricane_hid_setup_begin(&e->hid_setup, dev);
+        }
+    }
+
+    if (e->hid_setup.dev) {
+        // Initialize the HID device
+        HURRICANE_PT_SPAWN(&e->pt, &e->hid_setup.pt, hurricane_hid_setup_thread(&e->hid_setup));
+
+        // Attempt to fetch HID report descriptor
+        e->hid_setup.dev->hid_device->layout = NULL;
+        hurricane_host_control_prepare(&e->request,
+                                       USB_REQ_TYPE_STANDARD | USB_REQ_RECIPIENT_INTERFACE | 0x80, // IN transfer
+                                       USB_REQ_GET_DESCRIPTOR,
+                                       (USB_DESC_TYPE_REPORT << 8),
+                                       host->device.hid_interface,
+                                       host->report_descriptor_buffer, sizeof(host->report_descriptor_buffer));
+        HURRICANE_PT_CONTROL_TRANSFER_CTX(&e->pt, ctx, &e->request);
+        if (e->request.status == HURRICANE_CONTROL_DONE) {
+            e->hid_setup.dev->hid_device->report_descriptor = host->report_descriptor_buffer;
+            e->hid_setup.dev->hid_device->report_descriptor_length = (uint16_t)e->request.result;
+            printf("[HID] Fetched %d bytes of HID report descriptor\n", e->request.result);
+            if (hurricane_hid_parse_report_descriptor(host->report_descriptor_buffer,
+                                                      (uint16_t)e->request.result,
+                                                      &host->report_layout) == HURRICANE_HID_PARSE_OK) {
+                e->hid_setup.dev->hid_device->layout = &host->report_layout;
+                printf("[HID] Report descriptor compiled: %u fields in %u reports\n",
+                       host->report_layout.num_fields, host->report_layout.num_reports);
+            }
+        } else {
+            printf("[HID] Failed to fetch HID report descriptor\n");
+        }
+
+        // In boot protocol the device sends boot reports whatever its descriptor says
+        if (e->hid_setup.dev->hid_device->protocol == HURRICANE_HID_PROTOCOL_BOOT) {
+            const hurricane_hid_layout_t* boot = hurricane_hid_boot_layout(e->hid_setup.dev->hid_device->boot_interface);
+            if (boot) {
+                e->hid_setup.dev->hid_device->layout = boot;
+                printf("[HID] Using the boot report layout\n");
+            }
+        }
+
+        printf("[host] HID device configured successfully\n");
+    }
+
+    // Set configuration (usually 1 is the default)
+    printf("[host] Setting configuration...\n");
+    hurricane_host_control_prepare(&e->request,
+                                   0x00,  // Host to Device, Standard, Device
+                                   0x09,  // SET_CONFIGURATION
+                                   1, 0, NULL, 0);
+    HURRICANE_PT_CONTROL_TRANSFER_CTX(&e->pt, ctx, &e->request);
+    if (e->request.status != HURRICANE_CONTROL_DONE) {
+        printf("[host] Error setting configuration.\n");
+        HURRICANE_PT_EXIT(&e->pt);
+    }
+    printf("[host] Device configured with configuration %d\n", 1);
+
+    host->device.state = kHurricane_Host_DeviceStateConfigured;
+
+    HURRICANE_PT_END(&e->pt);
 }
 
 // Parse the configuration descriptor and its embedded interface/endpoint descriptors
-static int usb_parse_configuration(uint8_t* buffer, uint16_t len)
+static int usb_parse_configuration(hurricane_context_t* ctx, uint8_t* buffer, uint16_t len)
 {
+    usb_device_t* device = &ctx->host.device;
     uint8_t hid_interface = 0;
     uint8_t hid_endpoint = 0;
-    device.hid_configured = 0;
+    uint8_t boot_protocol = 0;
+    device->hid_configured = 0;
     
-    if (usb_find_hid_interface(buffer, len, &hid_interface, &hid_endpoint)) {
+    if (usb_find_hid_interface(buffer, len, &hid_interface, &hid_endpoint, &boot_protocol)) {
         printf("[host] Found HID interface %d with interrupt endpoint 0x%02X\n", 
                 hid_interface, hid_endpoint);
         
         // Store the HID interface info
-        device.hid_interface = hid_interface;
-        device.hid_endpoint = hid_endpoint;
-        device.hid_configured = 1;
+        device->hid_interface = hid_interface;
+        device->hid_endpoint = hid_endpoint;
+        device->hid_boot_protocol = boot_protocol;
+        device->hid_configured = 1;
         
         // Create and configure HID device
-        hurricane_device_t* dev = hurricane_get_device(0);
+        hurricane_device_t* dev = hurricane_get_device_ctx(ctx, 0);
         if (dev && dev->is_active) {
             // Allocate HID device structure if not already allocated
             if (!dev->hid_device) {
@@ -162,14 +271,11 @@ static int usb_parse_configuration(uint8_t* buffer, uint16_t len)
                 memset(dev->hid_device, 0, sizeof(hurricane_hid_device_t));
             }
             
-            // Initialize the HID device
+            // Class setup runs from the enumeration thread
             dev->hid_device->interface_number = hid_interface;
-            hurricane_hid_init(dev);
-            
-            // Attempt to fetch HID report descriptor
-            hurricane_hid_fetch_report_descriptor(dev);
-            
-            printf("[host] HID device configured successfully\n");
+            dev->hid_device->boot_interface = boot_protocol;
+            dev->hid_device->rules = device->hid_rules;
+            dev->hid_device->num_rules = device->hid_num_rules;
         }
     } else {
         printf("[host] No HID interface found in configuration\n");
@@ -178,28 +284,9 @@ static int usb_parse_configuration(uint8_t* buffer, uint16_t len)
     return 0;
 }
 
-// Helper to set the device configuration
-static int usb_set_configuration(uint8_t config_value)
-{
-    hurricane_usb_setup_packet_t setup = {
-        .bmRequestType = 0x00,  // Host to Device, Standard, Device
-        .bRequest = 0x09,       // SET_CONFIGURATION
-        .wValue = config_value,
-        .wIndex = 0,
-        .wLength = 0
-    };
-    
-    if (hurricane_hw_control_transfer(&setup, NULL, 0) != 0) {
-        printf("[host] Failed to set configuration %d\n", config_value);
-        return -1;
-    }
-    
-    printf("[host] Device configured with configuration %d\n", config_value);
-    return 0;
-}
-
 // Helper function to find HID interface and endpoint in configuration descriptor
-static int usb_find_hid_interface(uint8_t* buffer, uint16_t len, uint8_t* interface_num, uint8_t* endpoint_addr)
+static int usb_find_hid_interface(uint8_t* buffer, uint16_t len, uint8_t* interface_num, uint8_t* endpoint_addr,
+                                  uint8_t* boot_protocol)
 {
     uint16_t pos = 0;
     bool found_hid = false;
@@ -225,6 +312,8 @@ static int usb_find_hid_interface(uint8_t* buffer, uint16_t len, uint8_t* interf
                 printf("[host] Found HID interface %d (subclass: %d, protocol: %d)\n", 
                        current_interface, interface_subclass, interface_protocol);
                 *interface_num = current_interface;
+                // Only the boot subclass promises the boot report format
+                *boot_protocol = (interface_subclass == 1) ? interface_protocol : 0;
                 found_hid = true;
                 
                 // HID protocol values:
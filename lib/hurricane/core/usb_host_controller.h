@@ -3,6 +3,10 @@
 #include <stdint.h>
 #include "usb_descriptor.h"
 #include "hurricane_hw_hal.h"
+#include "usb/usb_hid.h"
+#include "core/hurricane_pt.h"
+#include "core/usb_host_control_queue.h"
+#include "core/hurricane_context_fwd.h"
 
 /**
  * @brief Represents the state of a USB device connected to the host.
@@ -39,7 +43,44 @@ typedef struct {
     uint8_t hid_configured;    // Flag to indicate HID device is configured
     uint8_t hid_interface;     // Interface number for HID device
     uint8_t hid_endpoint;      // Endpoint address for HID interrupt IN
+    uint8_t hid_boot_protocol; // Boot subclass bInterfaceProtocol of that interface, 0 if none
+    const hurricane_hid_transform_rule_t* hid_rules; // Attached to the HID device, kept across reconnects
+    uint8_t hid_num_rules;
 } usb_device_t;
 
+/**
+ * @brief Cooperative enumeration state; each wait point is one queued control transfer
+ */
+typedef struct {
+    hurricane_pt_t pt;
+    hurricane_control_request_t request;
+    hurricane_hid_setup_t hid_setup;
+    uint8_t device_desc_raw[USB_DEVICE_DESCRIPTOR_SIZE];
+    uint16_t config_length;
+} usb_host_enumeration_t;
+
+/**
+ * @brief Host-side state of one stack context
+ */
+typedef struct {
+    usb_device_t device;
+    uint8_t config_buffer[256];                             /*!< Configuration descriptor */
+    uint8_t report_descriptor_buffer[MAX_USB_DESCRIPTOR_SIZE]; /*!< HID report descriptor of the attached device */
+    hurricane_hid_layout_t report_layout;                   /*!< report_descriptor_buffer, compiled */
+    usb_host_enumeration_t enumeration;
+} usb_host_state_t;
+
 void usb_host_init(void);
 void usb_host_poll(void);
+
+/**
+ * @brief Select the host controller instance used for enumeration
+ *
+ * Defaults to the primary controller; see hw/hurricane_hw_ops.h. Sets the
+ * host controller of the default context.
+ */
+void usb_host_set_controller(uint8_t instance);
+
+// The same operations on a specific stack context
+void usb_host_init_ctx(hurricane_context_t* ctx);
+void usb_host_poll_ctx(hurricane_context_t* ctx);
@@ -5,6 +5,11 @@
  * pthread has been removed. Thread‑safety is now optional at compile time.
  * Define HURRICANE_USE_THREADING if you actually have an RTOS or POSIX layer
  * that provides pthreads (or if you map these macros to your own mutex API).
+ *
+ * The mutex only serializes writers. Lookups and event dispatch read the
+ * published registry snapshot without locking (left-right scheme, see
+ * hurricane_interface_manager_t), so the device HAL may call them from the
+ * USB interrupt and reader threads never wait on each other or on writers.
  */
 
 #include "usb_interface_manager.h"
@@ -12,25 +17,30 @@
 #include <string.h>
 #include <stdio.h>
 #include "hw/hurricane_hw_hal.h"
+#include "hw/hurricane_hw_ops.h"
+#include "hurricane_context.h"
+#ifdef HURRICANE_USE_THREADING
+#include <sched.h>
+#endif
 
 /* -------------------------------------------------------------------------- */
 /*                          Optional mutex abstraction                        */
 /* -------------------------------------------------------------------------- */
 #ifdef HURRICANE_USE_THREADING
-#include <pthread.h>
-static pthread_mutex_t interface_manager_mutex = PTHREAD_MUTEX_INITIALIZER;
-#define INTERFACE_MANAGER_LOCK()   pthread_mutex_lock(&interface_manager_mutex)
-#define INTERFACE_MANAGER_UNLOCK() pthread_mutex_unlock(&interface_manager_mutex)
+#define INTERFACE_MANAGER_LOCK(im)   pthread_mutex_lock(&(im)->mutex)
+#define INTERFACE_MANAGER_UNLOCK(im) pthread_mutex_unlock(&(im)->mutex)
+#define REGISTRY_RELAX()             sched_yield()
 #else
-#define INTERFACE_MANAGER_LOCK()   ((void)0)
-#define INTERFACE_MANAGER_UNLOCK() ((void)0)
+#define INTERFACE_MANAGER_LOCK(im)   ((void)(im))
+#define INTERFACE_MANAGER_UNLOCK(im) ((void)(im))
+#define REGISTRY_RELAX()             ((void)0)
 #endif
 
 /* -------------------------------------------------------------------------- */
 /*                              Private definitions                           */
 /* -------------------------------------------------------------------------- */
-#define MAX_HOST_CLASS_HANDLERS      8
-#define MAX_INTERFACE_REGISTRY_ENTRIES 16
+_Static_assert(MAX_DEVICE_INTERFACES >= 1 && MAX_DEVICE_INTERFACES < 32,
+               "MAX_DEVICE_INTERFACES must fit the slot bitmap");
 
 /* Error codes */
 #define HURRICANE_ERROR_NONE            0
@@ -39,47 +49,178 @@ static pthread_mutex_t interface_manager_mutex = PTHREAD_MUTEX_INITIALIZER;
 #define HURRICANE_ERROR_NOT_FOUND      -3
 #define HURRICANE_ERROR_ALREADY_EXISTS -4
 
-/* Registry for device‑mode interfaces */
-static hurricane_interface_registry_entry_t *device_interface_registry = NULL;
-
-/* Registry for host‑mode class handlers */
-typedef struct {
-    uint8_t device_class;
-    uint8_t device_subclass;
-    uint8_t device_protocol;
-    hurricane_host_class_handler_t handler;
-    bool active;
-} host_class_handler_entry_t;
-
-static host_class_handler_entry_t host_class_handlers[MAX_HOST_CLASS_HANDLERS];
-static uint8_t num_host_class_handlers = 0;
+/*
+ * EP0 request state, one word so the setup ISR and a completion in the main
+ * loop hand the request over with a single compare-and-swap. BUSY marks the
+ * buffer a completion claimed; the ISR keeps BUSY across SETUPs and answers
+ * new requests from the other buffer until the completion hands it back.
+ */
+#define CONTROL_PENDING     0x01u   /* Current request deferred, no reply yet */
+#define CONTROL_BUSY        0x02u   /* A completion owns buffers[BUSY_BUFFER] */
+#define CONTROL_BUSY_BUFFER 0x04u
+#define CONTROL_BUFFER      0x08u   /* Current request uses buffers[1] */
+#define CONTROL_GENERATION  0x10u   /* Lowest generation bit, bumped by every SETUP */
 
-/* Current device descriptors */
-static hurricane_device_descriptors_t current_device_descriptors = {0};
+#define CONTROL_BUFFER_INDEX(state)  (((state) & CONTROL_BUFFER) ? 1 : 0)
+#define CONTROL_SAME_REQUEST(a, b)   (((a) & ~(CONTROL_GENERATION - 1u)) == ((b) & ~(CONTROL_GENERATION - 1u)))
 
 /* Forward declarations of helper functions */
-static hurricane_interface_registry_entry_t *find_device_interface(uint8_t interface_num);
-static hurricane_endpoint_descriptor_t *find_device_endpoint(hurricane_interface_registry_entry_t *interface, uint8_t ep_address);
-static host_class_handler_entry_t *find_host_class_handler(uint8_t device_class, uint8_t device_subclass, uint8_t device_protocol);
+static hurricane_interface_registry_t *registry_read_begin(hurricane_interface_manager_t *im, unsigned int *parity);
+static void registry_read_end(hurricane_interface_manager_t *im, unsigned int parity);
+static hurricane_interface_registry_t *registry_write_begin(hurricane_interface_manager_t *im);
+static void registry_publish(hurricane_interface_manager_t *im, hurricane_interface_registry_t *next);
+static hurricane_interface_descriptor_t *find_device_interface(hurricane_interface_registry_t *reg, uint8_t interface_num);
+static hurricane_endpoint_descriptor_t *find_device_endpoint(hurricane_interface_registry_t *reg, uint8_t interface_num,
+                                                             uint8_t ep_address);
+static hurricane_host_class_handler_entry_t *find_host_class_handler(hurricane_interface_registry_t *reg, uint8_t device_class,
+                                                                     uint8_t device_subclass, uint8_t device_protocol);
+static bool dispatch_event(hurricane_interface_manager_t *im, hurricane_usb_event_t event, void *event_data);
+static uint8_t *control_claim(hurricane_interface_control_t *control, const hurricane_usb_setup_packet_t *setup,
+                              unsigned int *claimed);
+static void control_reply(hurricane_context_t *ctx, const hurricane_usb_setup_packet_t *setup,
+                          void (*rsp)(uint8_t, bool, void *, uint16_t), uint8_t interface_num,
+                          bool handled, uint8_t *buffer, uint16_t length);
 
 /* -------------------------------------------------------------------------- */
-/*                                API implementation                          */
+/*                     Default context (existing API)                         */
 /* -------------------------------------------------------------------------- */
 void hurricane_interface_manager_init(void)
 {
-    INTERFACE_MANAGER_LOCK();
+    hurricane_interface_manager_init_ctx(hurricane_default_context());
+}
+
+void hurricane_interface_manager_deinit(void)
+{
+    hurricane_interface_manager_deinit_ctx(hurricane_default_context());
+}
+
+void hurricane_interface_manager_set_controller(uint8_t instance)
+{
+    hurricane_default_context()->device_controller = instance;
+}
+
+int hurricane_add_device_interface(uint8_t interface_num, uint8_t interface_class, uint8_t interface_subclass,
+                                   uint8_t interface_protocol, const hurricane_interface_descriptor_t *descriptor)
+{
+    return hurricane_add_device_interface_ctx(hurricane_default_context(), interface_num, interface_class,
+                                              interface_subclass, interface_protocol, descriptor);
+}
+
+int hurricane_remove_device_interface(uint8_t interface_num)
+{
+    return hurricane_remove_device_interface_ctx(hurricane_default_context(), interface_num);
+}
+
+int hurricane_device_configure_endpoint(uint8_t interface_num, uint8_t ep_address, uint8_t ep_attributes,
+                                        uint16_t ep_max_packet_size, uint8_t ep_interval)
+{
+    return hurricane_device_configure_endpoint_ctx(hurricane_default_context(), interface_num, ep_address,
+                                                   ep_attributes, ep_max_packet_size, ep_interval);
+}
+
+void hurricane_device_interface_register_control_handler(uint8_t interface_num,
+        bool (*handler)(hurricane_usb_setup_packet_t *, void *, uint16_t *))
+{
+    hurricane_device_interface_register_control_handler_ctx(hurricane_default_context(), interface_num, handler);
+}
+
+int hurricane_register_host_class_handler(uint8_t device_class, uint8_t device_subclass, uint8_t device_protocol,
+                                          const hurricane_host_class_handler_t *handler)
+{
+    return hurricane_register_host_class_handler_ctx(hurricane_default_context(), device_class, device_subclass,
+                                                     device_protocol, handler);
+}
+
+int hurricane_unregister_host_class_handler(uint8_t device_class, uint8_t device_subclass, uint8_t device_protocol)
+{
+    return hurricane_unregister_host_class_handler_ctx(hurricane_default_context(), device_class, device_subclass,
+                                                       device_protocol);
+}
+
+void hurricane_interface_notify_event(hurricane_usb_event_t event, uint8_t interface_num, void *event_data)
+{
+    hurricane_interface_notify_event_ctx(hurricane_default_context(), event, interface_num, event_data);
+}
+
+bool hurricane_interface_notify_event_with_response(hurricane_usb_event_t event, uint8_t interface_num,
+                                                    void *event_data,
+                                                    void (*rsp)(uint8_t, bool, void *, uint16_t))
+{
+    return hurricane_interface_notify_event_with_response_ctx(hurricane_default_context(), event, interface_num,
+                                                              event_data, rsp);
+}
+
+hurricane_interface_control_result_t hurricane_interface_control_setup(uint8_t interface_num,
+                                                                      const hurricane_usb_setup_packet_t *setup,
+                                                                      void (*rsp)(uint8_t, bool, void *, uint16_t))
+{
+    return hurricane_interface_control_setup_ctx(hurricane_default_context(), interface_num, setup, rsp);
+}
+
+void *hurricane_interface_control_claim(const hurricane_usb_setup_packet_t *setup)
+{
+    return hurricane_interface_control_claim_ctx(hurricane_default_context(), setup);
+}
+
+int hurricane_interface_control_complete(const hurricane_usb_setup_packet_t *setup, bool handled,
+                                         const void *data, uint16_t length)
+{
+    return hurricane_interface_control_complete_ctx(hurricane_default_context(), setup, handled, data, length);
+}
+
+int hurricane_device_update_descriptors(hurricane_device_descriptors_t *desc)
+{
+    return hurricane_device_update_descriptors_ctx(hurricane_default_context(), desc);
+}
+
+int hurricane_device_update_report_descriptor(uint8_t *report_desc, uint16_t len)
+{
+    return hurricane_device_update_report_descriptor_ctx(hurricane_default_context(), report_desc, len);
+}
+
+int hurricane_device_trigger_reset(void)
+{
+    return hurricane_device_trigger_reset_ctx(hurricane_default_context());
+}
+
+bool hurricane_get_device_interface(uint8_t interface_num, hurricane_interface_descriptor_t *descriptor)
+{
+    return hurricane_get_device_interface_ctx(hurricane_default_context(), interface_num, descriptor);
+}
+
+bool hurricane_get_device_endpoint(uint8_t interface_num, uint8_t ep_address, hurricane_endpoint_descriptor_t *endpoint)
+{
+    return hurricane_get_device_endpoint_ctx(hurricane_default_context(), interface_num, ep_address, endpoint);
+}
 
-    /* Initialise device interface registry */
-    device_interface_registry = NULL;
+bool hurricane_get_device_endpoint_by_address(uint8_t ep_address, hurricane_endpoint_descriptor_t *endpoint)
+{
+    return hurricane_get_device_endpoint_by_address_ctx(hurricane_default_context(), ep_address, endpoint);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                API implementation                          */
+/* -------------------------------------------------------------------------- */
+void hurricane_interface_manager_init_ctx(hurricane_context_t *ctx)
+{
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    INTERFACE_MANAGER_LOCK(im);
 
-    /* Initialise host class handlers */
-    memset(host_class_handlers, 0, sizeof(host_class_handlers));
-    num_host_class_handlers = 0;
+    /* Initialise the registry: no interfaces, no host class handlers, no readers */
+    memset(im->snapshots, 0, sizeof(im->snapshots));
+    atomic_store(&im->registry, &im->snapshots[0]);
+    atomic_store(&im->version, 0);
+    atomic_store(&im->readers[0], 0);
+    atomic_store(&im->readers[1], 0);
 
     /* Clear current descriptors */
-    memset(&current_device_descriptors, 0, sizeof(current_device_descriptors));
+    memset(&im->current_device_descriptors, 0, sizeof(im->current_device_descriptors));
+
+    /* Nothing in flight on EP0 */
+    memset(&im->control, 0, sizeof(im->control));
+    atomic_store(&im->control.state, 0);
 
-    INTERFACE_MANAGER_UNLOCK();
+    INTERFACE_MANAGER_UNLOCK(im);
     printf("[Interface Manager] Initialised (threading %s)\n",
            #ifdef HURRICANE_USE_THREADING
            "enabled"
@@ -92,349 +233,555 @@ void hurricane_interface_manager_init(void)
 /**
  * @brief De‑initialise the interface manager and free all resources.
  */
-void hurricane_interface_manager_deinit(void)
+void hurricane_interface_manager_deinit_ctx(hurricane_context_t *ctx)
 {
-    INTERFACE_MANAGER_LOCK();
-
-    hurricane_interface_registry_entry_t *current = device_interface_registry;
-    while (current) {
-        hurricane_interface_registry_entry_t *next = current->next;
-        free(current);
-        current = next;
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    INTERFACE_MANAGER_LOCK(im);
+
+    hurricane_interface_registry_t *reg = registry_write_begin(im);
+    memset(reg->interfaces, 0, sizeof(reg->interfaces));
+    memset(reg->endpoints, 0, sizeof(reg->endpoints));
+    memset(reg->slot, 0, sizeof(reg->slot));
+    reg->used = 0;
+    registry_publish(im, reg);
+
+    hurricane_device_descriptors_t *descs = &im->current_device_descriptors;
+    if (descs->device_descriptor) {
+        free(descs->device_descriptor);
     }
-    device_interface_registry = NULL;
-
-    if (current_device_descriptors.device_descriptor) {
-        free(current_device_descriptors.device_descriptor);
-    }
-    if (current_device_descriptors.config_descriptor) {
-        free(current_device_descriptors.config_descriptor);
+    if (descs->config_descriptor) {
+        free(descs->config_descriptor);
     }
-    if (current_device_descriptors.hid_report_descriptor) {
-        free(current_device_descriptors.hid_report_descriptor);
+    if (descs->hid_report_descriptor) {
+        free(descs->hid_report_descriptor);
     }
     for (int i = 0; i < MAX_STRING_DESCRIPTORS; i++) {
-        if (current_device_descriptors.string_descriptors[i]) {
-            free(current_device_descriptors.string_descriptors[i]);
-            current_device_descriptors.string_descriptors[i] = NULL;
+        if (descs->string_descriptors[i]) {
+            free(descs->string_descriptors[i]);
+            descs->string_descriptors[i] = NULL;
         }
     }
-    memset(&current_device_descriptors, 0, sizeof(current_device_descriptors));
+    memset(descs, 0, sizeof(*descs));
 
-    INTERFACE_MANAGER_UNLOCK();
+    INTERFACE_MANAGER_UNLOCK(im);
     printf("[Interface Manager] De‑initialised and resources freed\n");
 }
 
 /* --------------------------- Device‑side helpers -------------------------- */
-int hurricane_add_device_interface(uint8_t interface_num,
-                                   uint8_t interface_class,
-                                   uint8_t interface_subclass,
-                                   uint8_t interface_protocol,
-                                   const hurricane_interface_descriptor_t *descriptor)
+int hurricane_add_device_interface_ctx(hurricane_context_t *ctx,
+                                       uint8_t interface_num,
+                                       uint8_t interface_class,
+                                       uint8_t interface_subclass,
+                                       uint8_t interface_protocol,
+                                       const hurricane_interface_descriptor_t *descriptor)
 {
-    INTERFACE_MANAGER_LOCK();
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    INTERFACE_MANAGER_LOCK(im);
     if (!descriptor) {
         printf("[Interface Manager] Error: Null descriptor\n");
-        INTERFACE_MANAGER_UNLOCK();
+        INTERFACE_MANAGER_UNLOCK(im);
         return HURRICANE_ERROR_INVALID_PARAM;
     }
 
-    if (find_device_interface(interface_num)) {
+    hurricane_interface_registry_t *reg = registry_write_begin(im);
+    if (find_device_interface(reg, interface_num)) {
         printf("[Interface Manager] Error: Interface %d already exists\n", interface_num);
-        INTERFACE_MANAGER_UNLOCK();
+        INTERFACE_MANAGER_UNLOCK(im);
         return HURRICANE_ERROR_ALREADY_EXISTS;
     }
 
-    hurricane_interface_registry_entry_t *new_entry = malloc(sizeof(*new_entry));
-    if (!new_entry) {
-        printf("[Interface Manager] Error: Out of memory for interface %d\n", interface_num);
-        INTERFACE_MANAGER_UNLOCK();
+    if (interface_num >= MAX_INTERFACE_NUMBERS) {
+        printf("[Interface Manager] Error: Interface number %d out of range\n", interface_num);
+        INTERFACE_MANAGER_UNLOCK(im);
+        return HURRICANE_ERROR_INVALID_PARAM;
+    }
+    uint32_t free_slots = ~reg->used & ((1u << MAX_DEVICE_INTERFACES) - 1u);
+    if (!free_slots) {
+        printf("[Interface Manager] Error: No slot for interface %d\n", interface_num);
+        INTERFACE_MANAGER_UNLOCK(im);
         return HURRICANE_ERROR_NO_MEMORY;
     }
 
-    memcpy(&new_entry->descriptor, descriptor, sizeof(hurricane_interface_descriptor_t));
-    memset(new_entry->endpoints, 0, sizeof(new_entry->endpoints));
-
-    new_entry->active = true;
-    new_entry->next = device_interface_registry;
-    device_interface_registry = new_entry;
+    unsigned int slot = (unsigned int)__builtin_ctz(free_slots);
+    memcpy(&reg->interfaces[slot], descriptor, sizeof(hurricane_interface_descriptor_t));
+    reg->used |= 1u << slot;
+    reg->slot[interface_num] = (uint8_t)(slot + 1);
+    registry_publish(im, reg);
 
-    int hw = hurricane_hw_device_configure_interface(interface_num, interface_class,
-                                                     interface_subclass, interface_protocol);
+    int hw = hurricane_hw_device_configure_interface_on(ctx->device_controller, interface_num, interface_class,
+                                                        interface_subclass, interface_protocol);
     if (hw) {
         printf("[Interface Manager] Warning: HW interface cfg returned %d\n", hw);
     }
 
     printf("[Interface Manager] Added interface %d (class %d/%d/%d)\n",
            interface_num, interface_class, interface_subclass, interface_protocol);
-    hurricane_interface_notify_event(USB_EVENT_INTERFACE_ENABLED, interface_num, NULL);
-    INTERFACE_MANAGER_UNLOCK();
+    dispatch_event(im, USB_EVENT_INTERFACE_ENABLED, NULL);
+    INTERFACE_MANAGER_UNLOCK(im);
     return HURRICANE_ERROR_NONE;
 }
 
-int hurricane_remove_device_interface(uint8_t interface_num)
+int hurricane_remove_device_interface_ctx(hurricane_context_t *ctx, uint8_t interface_num)
 {
-    INTERFACE_MANAGER_LOCK();
-    hurricane_interface_registry_entry_t *cur = device_interface_registry, *prev = NULL;
-    while (cur) {
-        if (cur->descriptor.interface_num == interface_num) {
-            if (prev) prev->next = cur->next; else device_interface_registry = cur->next;
-            hurricane_interface_notify_event(USB_EVENT_INTERFACE_DISABLED, interface_num, NULL);
-            free(cur);
-            printf("[Interface Manager] Removed interface %d\n", interface_num);
-            INTERFACE_MANAGER_UNLOCK();
-            return HURRICANE_ERROR_NONE;
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    INTERFACE_MANAGER_LOCK(im);
+    hurricane_interface_registry_t *reg = registry_write_begin(im);
+    if (!find_device_interface(reg, interface_num)) {
+        printf("[Interface Manager] Error: Interface %d not found\n", interface_num);
+        INTERFACE_MANAGER_UNLOCK(im);
+        return HURRICANE_ERROR_NOT_FOUND;
+    }
+
+    dispatch_event(im, USB_EVENT_INTERFACE_DISABLED, NULL);
+    for (int i = 0; i < MAX_DEVICE_ENDPOINTS; i++) {
+        if (reg->endpoints[i].configured && reg->endpoints[i].interface_num == interface_num) {
+            memset(&reg->endpoints[i], 0, sizeof(reg->endpoints[i]));
         }
-        prev = cur;
-        cur = cur->next;
     }
-    printf("[Interface Manager] Error: Interface %d not found\n", interface_num);
-    INTERFACE_MANAGER_UNLOCK();
-    return HURRICANE_ERROR_NOT_FOUND;
+    reg->used &= ~(1u << (reg->slot[interface_num] - 1));
+    reg->slot[interface_num] = 0;
+    registry_publish(im, reg);
+    printf("[Interface Manager] Removed interface %d\n", interface_num);
+    INTERFACE_MANAGER_UNLOCK(im);
+    return HURRICANE_ERROR_NONE;
 }
 
-int hurricane_device_configure_endpoint(uint8_t interface_num, uint8_t ep_address,
-                                        uint8_t ep_attributes, uint16_t ep_max_packet_size,
-                                        uint8_t ep_interval)
+int hurricane_device_configure_endpoint_ctx(hurricane_context_t *ctx, uint8_t interface_num, uint8_t ep_address,
+                                            uint8_t ep_attributes, uint16_t ep_max_packet_size,
+                                            uint8_t ep_interval)
 {
-    INTERFACE_MANAGER_LOCK();
-    hurricane_interface_registry_entry_t *iface = find_device_interface(interface_num);
-    if (!iface) {
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    INTERFACE_MANAGER_LOCK(im);
+    hurricane_interface_registry_t *reg = registry_write_begin(im);
+    if (!find_device_interface(reg, interface_num)) {
         printf("[Interface Manager] Error: Interface %d not found\n", interface_num);
-        INTERFACE_MANAGER_UNLOCK();
+        INTERFACE_MANAGER_UNLOCK(im);
         return HURRICANE_ERROR_NOT_FOUND;
     }
 
-    hurricane_endpoint_descriptor_t *ep = find_device_endpoint(iface, ep_address);
-    if (!ep) {
-        for (int i = 0; i < MAX_ENDPOINTS_PER_INTERFACE; i++) {
-            if (!iface->endpoints[i].configured) {
-                ep = &iface->endpoints[i];
-                break;
-            }
-        }
-        if (!ep) {
-            printf("[Interface Manager] Error: No EP slots for iface %d\n", interface_num);
-            INTERFACE_MANAGER_UNLOCK();
-            return HURRICANE_ERROR_NO_MEMORY;
-        }
+    /* An endpoint address belongs to one interface of the configuration */
+    hurricane_endpoint_descriptor_t *ep = &reg->endpoints[HURRICANE_ENDPOINT_INDEX(ep_address)];
+    if (ep->configured && ep->interface_num != interface_num) {
+        printf("[Interface Manager] Error: EP 0x%02X already used by iface %d\n", ep_address, ep->interface_num);
+        INTERFACE_MANAGER_UNLOCK(im);
+        return HURRICANE_ERROR_ALREADY_EXISTS;
     }
     ep->ep_address = ep_address;
+    ep->interface_num = interface_num;
     ep->ep_attributes = ep_attributes;
     ep->ep_max_packet_size = ep_max_packet_size;
     ep->ep_interval = ep_interval;
     ep->configured = true;
+    registry_publish(im, reg);
 
-    int hw = hurricane_hw_device_configure_endpoint(interface_num, ep_address, ep_attributes,
-                                                    ep_max_packet_size, ep_interval);
+    int hw = hurricane_hw_device_configure_endpoint_on(ctx->device_controller, interface_num, ep_address,
+                                                       ep_attributes, ep_max_packet_size, ep_interval);
     if (hw) {
         printf("[Interface Manager] Warning: HW EP cfg returned %d\n", hw);
     }
 
     printf("[Interface Manager] Configured EP 0x%02X on iface %d\n", ep_address, interface_num);
-    INTERFACE_MANAGER_UNLOCK();
+    INTERFACE_MANAGER_UNLOCK(im);
     return HURRICANE_ERROR_NONE;
 }
 
-void hurricane_device_interface_register_control_handler(uint8_t interface_num,
+void hurricane_device_interface_register_control_handler_ctx(hurricane_context_t *ctx, uint8_t interface_num,
         bool (*handler)(hurricane_usb_setup_packet_t *, void *, uint16_t *))
 {
-    INTERFACE_MANAGER_LOCK();
-    hurricane_interface_registry_entry_t *iface = find_device_interface(interface_num);
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    INTERFACE_MANAGER_LOCK(im);
+    hurricane_interface_registry_t *reg = registry_write_begin(im);
+    hurricane_interface_descriptor_t *iface = find_device_interface(reg, interface_num);
     if (!iface) {
         printf("[Interface Manager] Error: Interface %d not found for ctl handler\n", interface_num);
-        INTERFACE_MANAGER_UNLOCK();
+        INTERFACE_MANAGER_UNLOCK(im);
         return;
     }
-    iface->descriptor.control_handler = handler;
+    iface->control_handler = handler;
+    registry_publish(im, reg);
     printf("[Interface Manager] Registered control handler for iface %d\n", interface_num);
-    INTERFACE_MANAGER_UNLOCK();
+    INTERFACE_MANAGER_UNLOCK(im);
 }
 
 /* --------------------------- Host‑side helpers --------------------------- */
-int hurricane_register_host_class_handler(uint8_t device_class, uint8_t device_subclass,
-                                          uint8_t device_protocol,
-                                          const hurricane_host_class_handler_t *handler)
+int hurricane_register_host_class_handler_ctx(hurricane_context_t *ctx, uint8_t device_class,
+                                              uint8_t device_subclass, uint8_t device_protocol,
+                                              const hurricane_host_class_handler_t *handler)
 {
-    INTERFACE_MANAGER_LOCK();
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    INTERFACE_MANAGER_LOCK(im);
     if (!handler) {
-        INTERFACE_MANAGER_UNLOCK();
+        INTERFACE_MANAGER_UNLOCK(im);
         return HURRICANE_ERROR_INVALID_PARAM;
     }
-    if (find_host_class_handler(device_class, device_subclass, device_protocol)) {
-        INTERFACE_MANAGER_UNLOCK();
+    hurricane_interface_registry_t *reg = registry_write_begin(im);
+    if (find_host_class_handler(reg, device_class, device_subclass, device_protocol)) {
+        INTERFACE_MANAGER_UNLOCK(im);
         return HURRICANE_ERROR_ALREADY_EXISTS;
     }
-    if (num_host_class_handlers >= MAX_HOST_CLASS_HANDLERS) {
-        INTERFACE_MANAGER_UNLOCK();
+    if (reg->num_host_class_handlers >= MAX_HOST_CLASS_HANDLERS) {
+        INTERFACE_MANAGER_UNLOCK(im);
         return HURRICANE_ERROR_NO_MEMORY;
     }
-    host_class_handler_entry_t *slot = &host_class_handlers[num_host_class_handlers++];
+    hurricane_host_class_handler_entry_t *slot = &reg->host_class_handlers[reg->num_host_class_handlers++];
     slot->device_class = device_class;
     slot->device_subclass = device_subclass;
     slot->device_protocol = device_protocol;
     memcpy(&slot->handler, handler, sizeof(hurricane_host_class_handler_t));
     slot->active = true;
-    INTERFACE_MANAGER_UNLOCK();
+    registry_publish(im, reg);
+    INTERFACE_MANAGER_UNLOCK(im);
     return HURRICANE_ERROR_NONE;
 }
 
-int hurricane_unregister_host_class_handler(uint8_t device_class, uint8_t device_subclass,
-                                            uint8_t device_protocol)
+int hurricane_unregister_host_class_handler_ctx(hurricane_context_t *ctx, uint8_t device_class,
+                                                uint8_t device_subclass, uint8_t device_protocol)
 {
-    INTERFACE_MANAGER_LOCK();
-    host_class_handler_entry_t *h = find_host_class_handler(device_class, device_subclass, device_protocol);
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    INTERFACE_MANAGER_LOCK(im);
+    hurricane_interface_registry_t *reg = registry_write_begin(im);
+    hurricane_host_class_handler_entry_t *h = find_host_class_handler(reg, device_class, device_subclass, device_protocol);
     if (!h) {
-        INTERFACE_MANAGER_UNLOCK();
+        INTERFACE_MANAGER_UNLOCK(im);
         return HURRICANE_ERROR_NOT_FOUND;
     }
     h->active = false;
-    INTERFACE_MANAGER_UNLOCK();
+    registry_publish(im, reg);
+    INTERFACE_MANAGER_UNLOCK(im);
     return HURRICANE_ERROR_NONE;
 }
 
 /* ---------------------------- Event dispatch ----------------------------- */
-void hurricane_interface_notify_event(hurricane_usb_event_t event, uint8_t interface_num, void *event_data)
+void hurricane_interface_notify_event_ctx(hurricane_context_t *ctx, hurricane_usb_event_t event,
+                                          uint8_t interface_num, void *event_data)
 {
-    hurricane_interface_notify_event_with_response(event, interface_num, event_data, NULL);
+    hurricane_interface_notify_event_with_response_ctx(ctx, event, interface_num, event_data, NULL);
 }
 
-bool hurricane_interface_notify_event_with_response(hurricane_usb_event_t event, uint8_t interface_num,
-                                                    void *event_data,
-                                                    void (*rsp)(uint8_t, bool, void *, uint16_t))
+bool hurricane_interface_notify_event_with_response_ctx(hurricane_context_t *ctx, hurricane_usb_event_t event,
+                                                        uint8_t interface_num, void *event_data,
+                                                        void (*rsp)(uint8_t, bool, void *, uint16_t))
+{
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    if (event == USB_EVENT_CONTROL_REQUEST) {
+        /* Handlers run unlocked and may defer, see hurricane_interface_control_setup_ctx() */
+        return event_data && hurricane_interface_control_setup_ctx(ctx, interface_num, event_data, rsp) ==
+                             INTERFACE_CONTROL_COMPLETED;
+    }
+    return dispatch_event(im, event, event_data);
+}
+
+/* ----------------------- Device‑side control requests ----------------------- */
+hurricane_interface_control_result_t hurricane_interface_control_setup_ctx(hurricane_context_t *ctx, uint8_t interface_num,
+                                                                          const hurricane_usb_setup_packet_t *setup,
+                                                                          void (*rsp)(uint8_t, bool, void *, uint16_t))
 {
-    INTERFACE_MANAGER_LOCK();
-    /* Device‑side control requests */
-    if (event == USB_EVENT_CONTROL_REQUEST && event_data) {
-        hurricane_interface_registry_entry_t *iface = find_device_interface(interface_num);
-        if (iface && iface->descriptor.control_handler) {
-            hurricane_usb_setup_packet_t *setup = event_data;
-            uint16_t len = setup->wLength;
-            uint8_t *buf = NULL;
-            if ((setup->bmRequestType & 0x80) && len) {
-                buf = malloc(len);
-                if (!buf) { INTERFACE_MANAGER_UNLOCK(); return false; }
-            }
-            bool handled = iface->descriptor.control_handler(setup, buf, &len);
-            if (rsp && handled) rsp(interface_num, handled, buf, len);
-            if (buf) free(buf);
-            INTERFACE_MANAGER_UNLOCK();
-            return handled;
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    hurricane_interface_control_t *control = &im->control;
+    if (!setup) return INTERFACE_CONTROL_NOT_HANDLED;
+
+    /* Any new SETUP supersedes a request still pending, and avoids the buffer a completion is writing */
+    unsigned int state = atomic_load(&control->state), next;
+    do {
+        next = ((state | (CONTROL_GENERATION - 1u)) + 1u) | (state & (CONTROL_BUSY | CONTROL_BUSY_BUFFER));
+        if (state & CONTROL_BUSY) {
+            next |= (state & CONTROL_BUSY_BUFFER) ? 0 : CONTROL_BUFFER;
+        } else {
+            next |= state & CONTROL_BUFFER;
         }
+    } while (!atomic_compare_exchange_weak(&control->state, &state, next));
+
+    unsigned int parity;
+    hurricane_interface_descriptor_t *iface = find_device_interface(registry_read_begin(im, &parity), interface_num);
+    bool (*handler)(hurricane_usb_setup_packet_t *, void *, uint16_t *) = iface ? iface->control_handler : NULL;
+    registry_read_end(im, parity);
+    if (!handler) return INTERFACE_CONTROL_NOT_HANDLED;
+
+    control->setup = *setup;
+    control->response_cb = rsp;
+    control->interface_num = interface_num;
+
+    uint8_t *buffer = control->buffers[CONTROL_BUFFER_INDEX(next)];
+    hurricane_usb_setup_packet_t request = *setup;
+    uint16_t len = setup->wLength < HURRICANE_CONTROL_BUFFER_SIZE ? setup->wLength : HURRICANE_CONTROL_BUFFER_SIZE;
+    bool is_in = (setup->bmRequestType & 0x80) != 0;
+    if (!handler(&request, is_in && len ? buffer : NULL, &len)) {
+        return INTERFACE_CONTROL_NOT_HANDLED;
+    }
+    if (len == HURRICANE_CONTROL_DEFER) {
+        /* Only a newer SETUP changes the state meanwhile, and then this request is gone */
+        atomic_compare_exchange_strong(&control->state, &next, next | CONTROL_PENDING);
+        return INTERFACE_CONTROL_PENDING;
+    }
+    control_reply(ctx, setup, rsp, interface_num, true, buffer, len);
+    return INTERFACE_CONTROL_COMPLETED;
+}
+
+void *hurricane_interface_control_claim_ctx(hurricane_context_t *ctx, const hurricane_usb_setup_packet_t *setup)
+{
+    unsigned int claimed;
+    return setup ? control_claim(&ctx->interfaces.control, setup, &claimed) : NULL;
+}
+
+int hurricane_interface_control_complete_ctx(hurricane_context_t *ctx, const hurricane_usb_setup_packet_t *setup,
+                                             bool handled, const void *data, uint16_t length)
+{
+    hurricane_interface_control_t *control = &ctx->interfaces.control;
+    if (!setup || (!data && length)) return HURRICANE_ERROR_INVALID_PARAM;
+
+    unsigned int claimed;
+    uint8_t *buffer = control_claim(control, setup, &claimed);
+    if (!buffer) {
+        /* The PC gave up on it and sent a new SETUP */
+        printf("[Interface Manager] Dropped reply to request 0x%02X, no longer pending\n", setup->bRequest);
+        return HURRICANE_ERROR_NOT_FOUND;
+    }
+    if (length > HURRICANE_CONTROL_BUFFER_SIZE) length = HURRICANE_CONTROL_BUFFER_SIZE;
+    if (handled && data && data != buffer) memcpy(buffer, data, length);
+
+    /* Taken before the buffer is handed back: the ISR rewrites them only after bumping the generation */
+    hurricane_usb_setup_packet_t request = control->setup;
+    void (*rsp)(uint8_t, bool, void *, uint16_t) = control->response_cb;
+    uint8_t interface_num = control->interface_num;
+    if (!CONTROL_SAME_REQUEST(atomic_fetch_and(&control->state, ~CONTROL_BUSY), claimed)) {
+        printf("[Interface Manager] Dropped reply to request 0x%02X, superseded\n", setup->bRequest);
+        return HURRICANE_ERROR_NOT_FOUND;
+    }
+
+    control_reply(ctx, &request, rsp, interface_num, handled, buffer, length);
+    return HURRICANE_ERROR_NONE;
+}
+
+/* Main loop side: take a pending request over, or find the one claimed before; NULL if superseded */
+static uint8_t *control_claim(hurricane_interface_control_t *control, const hurricane_usb_setup_packet_t *setup,
+                              unsigned int *claimed)
+{
+    unsigned int state = atomic_load(&control->state);
+    const hurricane_usb_setup_packet_t *cur = &control->setup;
+    if (cur->bmRequestType != setup->bmRequestType || cur->bRequest != setup->bRequest ||
+        cur->wValue != setup->wValue || cur->wIndex != setup->wIndex || cur->wLength != setup->wLength) {
+        return NULL;
+    }
+
+    unsigned int index = CONTROL_BUFFER_INDEX(state);
+    bool busy_here = (state & CONTROL_BUSY) && ((state & CONTROL_BUSY_BUFFER) ? 1 : 0) == index;
+    if (!(state & CONTROL_PENDING)) {
+        /* Claimed already: the ISR never gives the current request the busy buffer otherwise */
+        *claimed = state;
+        return busy_here ? control->buffers[index] : NULL;
+    }
+
+    /* Fails if a SETUP came in since the load; that request may be using the buffer already */
+    unsigned int next = (state & ~(CONTROL_PENDING | CONTROL_BUSY_BUFFER)) | CONTROL_BUSY |
+                        (index ? CONTROL_BUSY_BUFFER : 0);
+    if (!atomic_compare_exchange_strong(&control->state, &state, next)) return NULL;
+    *claimed = next;
+    return control->buffers[index];
+}
+
+/* Data stage (IN) or status stage (OUT) of a request */
+static void control_reply(hurricane_context_t *ctx, const hurricane_usb_setup_packet_t *setup,
+                          void (*rsp)(uint8_t, bool, void *, uint16_t), uint8_t interface_num,
+                          bool handled, uint8_t *buffer, uint16_t length)
+{
+    bool is_in = (setup->bmRequestType & 0x80) != 0;
+    if (length > setup->wLength) length = setup->wLength;
+
+    if (rsp) {
+        rsp(interface_num, handled, is_in ? buffer : NULL, is_in ? length : 0);
+    } else if (!handled) {
+        hurricane_hw_device_endpoint_stall_on(ctx->device_controller, is_in ? 0x80 : 0x00, true);
+    } else if (is_in) {
+        hurricane_hw_device_control_response_on(ctx->device_controller, setup, buffer, length);
+    } else {
+        /* Status stage of an OUT request is a zero-length IN packet */
+        hurricane_usb_setup_packet_t status = *setup;
+        status.bmRequestType |= 0x80;
+        hurricane_hw_device_control_response_on(ctx->device_controller, &status, NULL, 0);
     }
+}
 
-    /* Host‑side attach/detach (placeholder HID example) */
-    if ((event == USB_EVENT_DEVICE_ATTACHED || event == USB_EVENT_DEVICE_DETACHED) && event_data) {
+/* Wait-free; callbacks run outside the read section, so they may change the registry */
+static bool dispatch_event(hurricane_interface_manager_t *im, hurricane_usb_event_t event, void *event_data)
+{
+    /* Host‑side attach/detach and received reports (placeholder HID example) */
+    if ((event == USB_EVENT_DEVICE_ATTACHED || event == USB_EVENT_DEVICE_DETACHED ||
+         event == USB_EVENT_ENDPOINT_DATA) && event_data) {
         uint8_t cls = 3, sub = 0, proto = 0; /* TODO: real parse */
-        host_class_handler_entry_t *h = find_host_class_handler(cls, sub, proto);
-        if (h && ((event == USB_EVENT_DEVICE_ATTACHED && h->handler.attach_callback) ||
-                  (event == USB_EVENT_DEVICE_DETACHED && h->handler.detach_callback))) {
-            if (event == USB_EVENT_DEVICE_ATTACHED) h->handler.attach_callback(event_data);
-            else h->handler.detach_callback(event_data);
+        unsigned int parity;
+        hurricane_host_class_handler_t handler;
+        hurricane_host_class_handler_entry_t *h = find_host_class_handler(registry_read_begin(im, &parity), cls, sub, proto);
+        if (h) handler = h->handler;
+        registry_read_end(im, parity);
+
+        if (h && event == USB_EVENT_ENDPOINT_DATA && handler.data_callback) {
+            /* The view stays valid for the call; the handler holds it to keep it longer */
+            handler.data_callback((const hurricane_report_view_t *)event_data);
+            return true;
+        }
+        if (h && ((event == USB_EVENT_DEVICE_ATTACHED && handler.attach_callback) ||
+                  (event == USB_EVENT_DEVICE_DETACHED && handler.detach_callback))) {
+            if (event == USB_EVENT_DEVICE_ATTACHED) handler.attach_callback(event_data);
+            else handler.detach_callback(event_data);
         }
     }
 
-    INTERFACE_MANAGER_UNLOCK();
     return false;
 }
 
 /* -------------------------- Descriptor updates --------------------------- */
-int hurricane_device_update_descriptors(hurricane_device_descriptors_t *desc)
+int hurricane_device_update_descriptors_ctx(hurricane_context_t *ctx, hurricane_device_descriptors_t *desc)
 {
-    INTERFACE_MANAGER_LOCK();
-    if (!desc) { INTERFACE_MANAGER_UNLOCK(); return HURRICANE_ERROR_INVALID_PARAM; }
-    memcpy(&current_device_descriptors, desc, sizeof(*desc));
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    INTERFACE_MANAGER_LOCK(im);
+    if (!desc) { INTERFACE_MANAGER_UNLOCK(im); return HURRICANE_ERROR_INVALID_PARAM; }
+    memcpy(&im->current_device_descriptors, desc, sizeof(*desc));
 
     if (desc->device_descriptor && desc->config_descriptor) {
-        hurricane_hw_device_set_descriptors(desc->device_descriptor, desc->device_descriptor_length,
-                                            desc->config_descriptor, desc->config_descriptor_length);
+        hurricane_hw_device_set_descriptors_on(ctx->device_controller,
+                                               desc->device_descriptor, desc->device_descriptor_length,
+                                               desc->config_descriptor, desc->config_descriptor_length);
     }
     if (desc->hid_report_descriptor) {
-        hurricane_hw_device_set_hid_report_descriptor(desc->hid_report_descriptor,
-                                                      desc->hid_report_descriptor_length);
+        hurricane_hw_device_set_hid_report_descriptor_on(ctx->device_controller, desc->hid_report_descriptor,
+                                                         desc->hid_report_descriptor_length);
     }
-    INTERFACE_MANAGER_UNLOCK();
+    INTERFACE_MANAGER_UNLOCK(im);
     return HURRICANE_ERROR_NONE;
 }
 
-int hurricane_device_update_report_descriptor(uint8_t *report_desc, uint16_t len)
+int hurricane_device_update_report_descriptor_ctx(hurricane_context_t *ctx, uint8_t *report_desc, uint16_t len)
 {
-    INTERFACE_MANAGER_LOCK();
-    if (!report_desc || !len) { INTERFACE_MANAGER_UNLOCK(); return HURRICANE_ERROR_INVALID_PARAM; }
-    if (current_device_descriptors.hid_report_descriptor) {
-        free(current_device_descriptors.hid_report_descriptor);
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    INTERFACE_MANAGER_LOCK(im);
+    if (!report_desc || !len) { INTERFACE_MANAGER_UNLOCK(im); return HURRICANE_ERROR_INVALID_PARAM; }
+    if (im->current_device_descriptors.hid_report_descriptor) {
+        free(im->current_device_descriptors.hid_report_descriptor);
     }
-    current_device_descriptors.hid_report_descriptor = malloc(len);
-    if (!current_device_descriptors.hid_report_descriptor) {
-        INTERFACE_MANAGER_UNLOCK();
+    im->current_device_descriptors.hid_report_descriptor = malloc(len);
+    if (!im->current_device_descriptors.hid_report_descriptor) {
+        INTERFACE_MANAGER_UNLOCK(im);
         return HURRICANE_ERROR_NO_MEMORY;
     }
-    memcpy(current_device_descriptors.hid_report_descriptor, report_desc, len);
-    current_device_descriptors.hid_report_descriptor_length = len;
-    hurricane_hw_device_set_hid_report_descriptor(report_desc, len);
-    INTERFACE_MANAGER_UNLOCK();
+    memcpy(im->current_device_descriptors.hid_report_descriptor, report_desc, len);
+    im->current_device_descriptors.hid_report_descriptor_length = len;
+    hurricane_hw_device_set_hid_report_descriptor_on(ctx->device_controller, report_desc, len);
+    INTERFACE_MANAGER_UNLOCK(im);
     return HURRICANE_ERROR_NONE;
 }
 
-int hurricane_device_trigger_reset(void)
+int hurricane_device_trigger_reset_ctx(hurricane_context_t *ctx)
 {
     printf("[Interface Manager] Triggering USB device reset\n");
-    hurricane_hw_device_reset();
+    hurricane_hw_device_reset_on(ctx->device_controller);
     return HURRICANE_ERROR_NONE;
 }
 
-const hurricane_interface_descriptor_t *hurricane_get_device_interface(uint8_t interface_num)
+/* Copied inside the read section: once it ends, a writer may reuse the snapshot */
+bool hurricane_get_device_interface_ctx(hurricane_context_t *ctx, uint8_t interface_num,
+                                        hurricane_interface_descriptor_t *descriptor)
 {
-    INTERFACE_MANAGER_LOCK();
-    hurricane_interface_registry_entry_t *iface = find_device_interface(interface_num);
-    const hurricane_interface_descriptor_t *ret = iface ? &iface->descriptor : NULL;
-    INTERFACE_MANAGER_UNLOCK();
-    return ret;
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    unsigned int parity;
+    const hurricane_interface_descriptor_t *iface = find_device_interface(registry_read_begin(im, &parity), interface_num);
+    if (iface && descriptor) *descriptor = *iface;
+    registry_read_end(im, parity);
+    return iface != NULL;
 }
 
-const hurricane_endpoint_descriptor_t *hurricane_get_device_endpoint(uint8_t interface_num, uint8_t ep_address)
+bool hurricane_get_device_endpoint_ctx(hurricane_context_t *ctx, uint8_t interface_num, uint8_t ep_address,
+                                       hurricane_endpoint_descriptor_t *endpoint)
 {
-    INTERFACE_MANAGER_LOCK();
-    hurricane_interface_registry_entry_t *iface = find_device_interface(interface_num);
-    const hurricane_endpoint_descriptor_t *ret = iface ? find_device_endpoint(iface, ep_address) : NULL;
-    INTERFACE_MANAGER_UNLOCK();
-    return ret;
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    unsigned int parity;
+    const hurricane_endpoint_descriptor_t *ep = find_device_endpoint(registry_read_begin(im, &parity), interface_num,
+                                                                     ep_address);
+    if (ep && endpoint) *endpoint = *ep;
+    registry_read_end(im, parity);
+    return ep != NULL;
+}
+
+bool hurricane_get_device_endpoint_by_address_ctx(hurricane_context_t *ctx, uint8_t ep_address,
+                                                  hurricane_endpoint_descriptor_t *endpoint)
+{
+    hurricane_interface_manager_t *im = &ctx->interfaces;
+    unsigned int parity;
+    const hurricane_endpoint_descriptor_t *ep =
+        &registry_read_begin(im, &parity)->endpoints[HURRICANE_ENDPOINT_INDEX(ep_address)];
+    bool found = ep->configured && ep->ep_address == ep_address;
+    if (found && endpoint) *endpoint = *ep;
+    registry_read_end(im, parity);
+    return found;
 }
 
 /* -------------------------------------------------------------------------- */
 /*                              Internal helpers                              */
 /* -------------------------------------------------------------------------- */
-static hurricane_interface_registry_entry_t *find_device_interface(uint8_t interface_num)
+/* Announce the reader on the current version's counter, then take the published snapshot */
+static hurricane_interface_registry_t *registry_read_begin(hurricane_interface_manager_t *im, unsigned int *parity)
 {
-    for (hurricane_interface_registry_entry_t *cur = device_interface_registry; cur; cur = cur->next) {
-        if (cur->active && cur->descriptor.interface_num == interface_num) return cur;
-    }
-    return NULL;
+    *parity = atomic_load(&im->version) & 1u;
+    atomic_fetch_add(&im->readers[*parity], 1);
+    hurricane_interface_registry_t *reg = atomic_load(&im->registry);
+    return reg ? reg : &im->snapshots[0];   /* Zeroed manager: nothing published yet */
 }
 
-static hurricane_endpoint_descriptor_t *find_device_endpoint(hurricane_interface_registry_entry_t *iface, uint8_t ep_address)
+static void registry_read_end(hurricane_interface_manager_t *im, unsigned int parity)
 {
-    if (!iface) return NULL;
-    for (int i = 0; i < MAX_ENDPOINTS_PER_INTERFACE; i++) {
-        if (iface->endpoints[i].configured && iface->endpoints[i].ep_address == ep_address) return &iface->endpoints[i];
-    }
-    return NULL;
+    atomic_fetch_sub_explicit(&im->readers[parity], 1, memory_order_release);
+}
+
+/* Writer holds the lock: a private copy of the published snapshot, nobody reads it */
+static hurricane_interface_registry_t *registry_write_begin(hurricane_interface_manager_t *im)
+{
+    hurricane_interface_registry_t *cur = atomic_load(&im->registry);
+    hurricane_interface_registry_t *next = cur == &im->snapshots[1] ? &im->snapshots[0] : &im->snapshots[1];
+    if (!cur) cur = &im->snapshots[0];
+    memcpy(next, cur, sizeof(*next));
+    return next;
+}
+
+/* Publish the copy, then wait out every reader that may still be in the old snapshot */
+static void registry_publish(hurricane_interface_manager_t *im, hurricane_interface_registry_t *next)
+{
+    atomic_store(&im->registry, next);
+
+    /* Readers that took the version before the last toggle, then those of the current one */
+    unsigned int version = atomic_load(&im->version);
+    while (atomic_load(&im->readers[(version + 1) & 1u])) REGISTRY_RELAX();
+    atomic_store(&im->version, version + 1);
+    while (atomic_load(&im->readers[version & 1u])) REGISTRY_RELAX();
+}
+
+static hurricane_interface_descriptor_t *find_device_interface(hurricane_interface_registry_t *reg, uint8_t interface_num)
+{
+    if (interface_num >= MAX_INTERFACE_NUMBERS || !reg->slot[interface_num]) return NULL;
+    return &reg->interfaces[reg->slot[interface_num] - 1];
+}
+
+static hurricane_endpoint_descriptor_t *find_device_endpoint(hurricane_interface_registry_t *reg, uint8_t interface_num,
+                                                             uint8_t ep_address)
+{
+    hurricane_endpoint_descriptor_t *ep = &reg->endpoints[HURRICANE_ENDPOINT_INDEX(ep_address)];
+    if (!ep->configured || ep->ep_address != ep_address || ep->interface_num != interface_num) return NULL;
+    return ep;
 }
 
-static host_class_handler_entry_t *find_host_class_handler(uint8_t cls, uint8_t sub, uint8_t proto)
+static hurricane_host_class_handler_entry_t *find_host_class_handler(hurricane_interface_registry_t *reg,
+                                                                     uint8_t cls, uint8_t sub, uint8_t proto)
 {
     /* Pass 1: exact */
-    for (int i = 0; i < num_host_class_handlers; i++) {
-        if (host_class_handlers[i].active && host_class_handlers[i].device_class == cls &&
-            host_class_handlers[i].device_subclass == sub && host_class_handlers[i].device_protocol == proto)
-            return &host_class_handlers[i];
+    for (int i = 0; i < reg->num_host_class_handlers; i++) {
+        if (reg->host_class_handlers[i].active && reg->host_class_handlers[i].device_class == cls &&
+            reg->host_class_handlers[i].device_subclass == sub && reg->host_class_handlers[i].device_protocol == proto)
+            return &reg->host_class_handlers[i];
     }
     /* Pass 2: class + wildcards */
-    for (int i = 0; i < num_host_class_handlers; i++) {
-        if (host_class_handlers[i].active && host_class_handlers[i].device_class == cls &&
-            (!host_class_handlers[i].device_subclass || host_class_handlers[i].device_subclass == sub) &&
-            (!host_class_handlers[i].device_protocol || host_class_handlers[i].device_protocol == proto))
-            return &host_class_handlers[i];
+    for (int i = 0; i < reg->num_host_class_handlers; i++) {
+        if (reg->host_class_handlers[i].active && reg->host_class_handlers[i].device_class == cls &&
+            (!reg->host_class_handlers[i].device_subclass || reg->host_class_handlers[i].device_subclass == sub) &&
+            (!reg->host_class_handlers[i].device_protocol || reg->host_class_handlers[i].device_protocol == proto))
+            return &reg->host_class_handlers[i];
     }
     return NULL;
 }
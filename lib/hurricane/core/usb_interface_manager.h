@@ -11,17 +11,57 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include "hw/hurricane_hw_hal.h"
 #include "hurricane.h"
+#include "core/hurricane_context_fwd.h"
+
+#ifdef HURRICANE_USE_THREADING
+#include <pthread.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * @brief Maximum number of endpoints per interface
+ * @brief Maximum number of device-mode interfaces per context
+ */
+#ifndef MAX_DEVICE_INTERFACES
+#define MAX_DEVICE_INTERFACES 8
+#endif
+
+/**
+ * @brief Interface numbers the registry can hold (0 to MAX_INTERFACE_NUMBERS - 1)
+ */
+#define MAX_INTERFACE_NUMBERS 32
+
+/**
+ * @brief Device endpoint addresses: 16 endpoint numbers, IN and OUT
  */
-#define MAX_ENDPOINTS_PER_INTERFACE 16
+#define MAX_DEVICE_ENDPOINTS 32
+
+/**
+ * @brief Registry index of an endpoint address, number in bits 0-3 and IN in bit 4
+ */
+#define HURRICANE_ENDPOINT_INDEX(ep_address) (((ep_address) & 0x0F) | (((ep_address) & 0x80) >> 3))
+
+/**
+ * @brief Size of the EP0 data buffer handed to control handlers
+ *
+ * Sized for the largest descriptor a handler answers with (see
+ * MAX_USB_DESCRIPTOR_SIZE); longer IN requests are offered this much.
+ */
+#ifndef HURRICANE_CONTROL_BUFFER_SIZE
+#define HURRICANE_CONTROL_BUFFER_SIZE 512
+#endif
+
+/**
+ * @brief Reply length a control handler sets, returning true, to answer later
+ *
+ * EP0 NAKs the PC until hurricane_interface_control_complete() is called.
+ */
+#define HURRICANE_CONTROL_DEFER 0xFFFF
 
 /**
  * @brief Maximum number of string descriptors
@@ -53,6 +93,15 @@ typedef enum {
     USB_EVENT_CONTROL_REQUEST      /**< Control request received */
 } hurricane_usb_event_t;
 
+/**
+ * @brief Result of handing a setup packet to the interface control handlers
+ */
+typedef enum {
+    INTERFACE_CONTROL_NOT_HANDLED = 0,  /**< No handler, or the handler declined */
+    INTERFACE_CONTROL_COMPLETED,        /**< Answered */
+    INTERFACE_CONTROL_PENDING           /**< Deferred, EP0 must NAK until completion */
+} hurricane_interface_control_result_t;
+
 /**
  * @brief USB endpoint descriptor
  */
@@ -61,6 +110,7 @@ typedef struct {
     uint8_t ep_attributes;         /**< Endpoint attributes (type, etc.) */
     uint16_t ep_max_packet_size;   /**< Maximum packet size */
     uint8_t ep_interval;           /**< Polling interval */
+    uint8_t interface_num;         /**< Interface the endpoint belongs to */
     bool configured;               /**< Whether endpoint is configured */
 } hurricane_endpoint_descriptor_t;
 
@@ -68,26 +118,16 @@ typedef struct {
  * @brief USB interface descriptor
  */
 typedef struct {
+    bool (*control_handler)(hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t* length);  /**< Control request handler */
+    void* handler_data;            /**< Handler-specific data */
     uint8_t interface_num;         /**< Interface number */
     uint8_t interface_class;       /**< USB class code */
     uint8_t interface_subclass;    /**< USB subclass code */
     uint8_t interface_protocol;    /**< Protocol code */
     uint8_t num_endpoints;         /**< Number of endpoints */
-    hurricane_interface_handler_type_t handler_type;  /**< Handler type */
-    void* handler_data;            /**< Handler-specific data */
-    bool (*control_handler)(hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t* length);  /**< Control request handler */
+    uint8_t handler_type;          /**< hurricane_interface_handler_type_t */
 } hurricane_interface_descriptor_t;
 
-/**
- * @brief Interface registry entry
- */
-typedef struct interface_registry_entry {
-    hurricane_interface_descriptor_t descriptor;   /**< Interface descriptor */
-    hurricane_endpoint_descriptor_t endpoints[MAX_ENDPOINTS_PER_INTERFACE];  /**< Endpoints */
-    bool active;                   /**< Whether interface is active */
-    struct interface_registry_entry* next;  /**< Next interface in list */
-} hurricane_interface_registry_entry_t;
-
 /**
  * @brief Device descriptors structure
  */
@@ -102,6 +142,80 @@ typedef struct {
     uint16_t hid_report_descriptor_length; /**< HID report descriptor length */
 } hurricane_device_descriptors_t;
 
+/**
+ * @brief Maximum number of host-mode class handlers per context
+ */
+#define MAX_HOST_CLASS_HANDLERS 8
+
+/**
+ * @brief Host-mode class handler registration
+ */
+typedef struct {
+    uint8_t device_class;
+    uint8_t device_subclass;
+    uint8_t device_protocol;
+    hurricane_host_class_handler_t handler;
+    bool active;
+} hurricane_host_class_handler_entry_t;
+
+/**
+ * @brief Snapshot of the interface and class handler registry
+ *
+ * Fixed tables, no heap. Interfaces sit in slots found through a table
+ * indexed by interface number; endpoints are indexed by address, so the
+ * interface owning an endpoint is a single load away.
+ */
+typedef struct {
+    hurricane_interface_descriptor_t interfaces[MAX_DEVICE_INTERFACES];  /**< Slots, see used */
+    hurricane_endpoint_descriptor_t endpoints[MAX_DEVICE_ENDPOINTS];     /**< By HURRICANE_ENDPOINT_INDEX() */
+    uint8_t slot[MAX_INTERFACE_NUMBERS];   /**< Interface number -> slot + 1, 0 = not registered */
+    uint32_t used;                         /**< Bit per occupied slot */
+    hurricane_host_class_handler_entry_t host_class_handlers[MAX_HOST_CLASS_HANDLERS];
+    uint8_t num_host_class_handlers;
+} hurricane_interface_registry_t;
+
+/**
+ * @brief Control request in progress on EP0
+ *
+ * EP0 carries one control transfer at a time and a new SETUP aborts the
+ * previous one; a completion for a superseded request is dropped. The
+ * setup ISR owns everything here except a buffer claimed by a completion:
+ * the main loop takes a deferred request over with one compare-and-swap on
+ * state, and a SETUP arriving while it writes the reply is answered from
+ * the other buffer.
+ */
+typedef struct {
+    _Alignas(4) uint8_t buffers[2][HURRICANE_CONTROL_BUFFER_SIZE];  /**< Data stage, see state */
+    hurricane_usb_setup_packet_t setup;     /**< Request being answered */
+    void (*response_cb)(uint8_t interface_num, bool handled, void* buffer, uint16_t length);  /**< NULL = reply through the HAL */
+    uint8_t interface_num;
+    atomic_uint state;                      /**< Generation bumped by every SETUP, pending and buffer ownership */
+} hurricane_interface_control_t;
+
+/**
+ * @brief Interface manager state of one stack context
+ *
+ * Lookups and event dispatch never block, so they are safe from the USB
+ * interrupt: a reader announces itself on the counter of the current
+ * version, copies what it needs out of the published snapshot and leaves;
+ * no pointer into a snapshot outlives the read. A writer copies the snapshot,
+ * changes the copy and publishes it with one pointer store, then waits for
+ * the readers still in the old one before that can be written again.
+ * Writers are serialized by the mutex (HURRICANE_USE_THREADING) and must
+ * not run in interrupt context.
+ */
+typedef struct {
+    hurricane_interface_registry_t snapshots[2];
+    hurricane_interface_registry_t* _Atomic registry;  /**< Published snapshot */
+    atomic_uint version;                    /**< Bumped by every publication */
+    atomic_uint readers[2];                 /**< Readers by version parity */
+    hurricane_device_descriptors_t current_device_descriptors;  /**< Descriptors presented to the PC */
+    hurricane_interface_control_t control;  /**< EP0 request in progress */
+#ifdef HURRICANE_USE_THREADING
+    pthread_mutex_t mutex;
+#endif
+} hurricane_interface_manager_t;
+
 /**
  * @brief Initialize the interface manager
  *
@@ -118,6 +232,16 @@ void hurricane_interface_manager_init(void);
  */
 void hurricane_interface_manager_deinit(void);
 
+/**
+ * @brief Select the device controller instance interfaces are configured on
+ *
+ * Defaults to the primary controller (see hw/hurricane_hw_ops.h). Sets the
+ * device controller of the default context.
+ *
+ * @param instance Device controller instance
+ */
+void hurricane_interface_manager_set_controller(uint8_t instance);
+
 /**
  * @brief Add a device-mode interface at runtime
  *
@@ -236,6 +360,63 @@ bool hurricane_interface_notify_event_with_response(
     void (*response_cb)(uint8_t interface_num, bool handled, void* buffer, uint16_t length)
 );
 
+/**
+ * @brief Hand a device-side setup packet to the interface's control handler
+ *
+ * The handler runs without the manager lock, on the context's control
+ * buffer. If it answers right away the reply goes to response_cb, or to
+ * the device HAL when response_cb is NULL. If it sets the reply length to
+ * HURRICANE_CONTROL_DEFER the request stays pending: the HAL leaves EP0
+ * unprimed, so the PC is NAKed, until the reply is passed to
+ * hurricane_interface_control_complete(), e.g. from the main loop. The
+ * buffer a deferring handler got is not its to keep; the reply is built in
+ * the one hurricane_interface_control_claim() returns.
+ *
+ * @param interface_num Interface addressed by the request
+ * @param setup Setup packet received from the PC
+ * @param response_cb Reply callback, NULL to reply through the device HAL
+ * @return hurricane_interface_control_result_t value
+ */
+hurricane_interface_control_result_t hurricane_interface_control_setup(
+    uint8_t interface_num,
+    const hurricane_usb_setup_packet_t* setup,
+    void (*response_cb)(uint8_t interface_num, bool handled, void* buffer, uint16_t length)
+);
+
+/**
+ * @brief Take a deferred control request over to build its reply in place
+ *
+ * Once claimed, the request's buffer is left alone by the setup ISR (a new
+ * SETUP gets the other one), so the reply can be written there and passed
+ * to hurricane_interface_control_complete() without a copy. Optional:
+ * completing with any other data claims the request itself.
+ *
+ * @param setup The deferred request, to tell it from a newer one
+ * @return Buffer of HURRICANE_CONTROL_BUFFER_SIZE bytes, NULL if the request is no longer pending
+ */
+void* hurricane_interface_control_claim(const hurricane_usb_setup_packet_t* setup);
+
+/**
+ * @brief Complete a control request its handler deferred
+ *
+ * Runs in the main loop, concurrently with the setup ISR. If a SETUP comes
+ * in after the request was claimed, the reply is dropped and the new
+ * request is not disturbed.
+ *
+ * @param setup The deferred request, to tell it from a newer one
+ * @param handled false to stall the request
+ * @param data IN data stage (copied to the request's buffer unless it is the
+ *             buffer returned by hurricane_interface_control_claim()), NULL for none
+ * @param length Length of the IN data stage
+ * @return 0 on success, negative error code if the request is no longer pending
+ */
+int hurricane_interface_control_complete(
+    const hurricane_usb_setup_packet_t* setup,
+    bool handled,
+    const void* data,
+    uint16_t length
+);
+
 /**
  * @brief Update device descriptors at runtime
  * 
@@ -266,22 +447,124 @@ int hurricane_device_trigger_reset(void);
 /**
  * @brief Get interface descriptor for a given interface number
  * 
+ * Wait-free. The descriptor is copied out of the registry snapshot current
+ * at the call, so it stays consistent while writers publish new ones; look
+ * it up again after changing the registry.
+ *
  * @param interface_num Interface number
- * @return Pointer to interface descriptor or NULL if not found
+ * @param descriptor Receives the interface descriptor, NULL to only test for it
+ * @return true if the interface is registered
  */
-const hurricane_interface_descriptor_t* hurricane_get_device_interface(uint8_t interface_num);
+bool hurricane_get_device_interface(uint8_t interface_num, hurricane_interface_descriptor_t* descriptor);
 
 /**
  * @brief Get endpoint descriptor for a given endpoint address
  * 
  * @param interface_num Interface number
  * @param ep_address Endpoint address
- * @return Pointer to endpoint descriptor or NULL if not found
+ * @param endpoint Receives a copy of the endpoint descriptor, NULL to only test for it
+ * @return true if the endpoint is configured on the interface
  */
-const hurricane_endpoint_descriptor_t* hurricane_get_device_endpoint(
+bool hurricane_get_device_endpoint(
     uint8_t interface_num, 
-    uint8_t ep_address
+    uint8_t ep_address,
+    hurricane_endpoint_descriptor_t* endpoint
+);
+
+/**
+ * @brief Get the configured endpoint at an address, whichever interface owns it
+ *
+ * Meant for routing endpoint data: the owning interface is the copied
+ * descriptor's interface_num.
+ *
+ * @param ep_address Endpoint address including direction bit
+ * @param endpoint Receives a copy of the endpoint descriptor, NULL to only test for it
+ * @return true if the endpoint is configured
+ */
+bool hurricane_get_device_endpoint_by_address(uint8_t ep_address, hurricane_endpoint_descriptor_t* endpoint);
+
+/*
+ * The same operations on a specific stack context. The functions above work
+ * on the default context.
+ */
+void hurricane_interface_manager_init_ctx(hurricane_context_t* ctx);
+void hurricane_interface_manager_deinit_ctx(hurricane_context_t* ctx);
+int hurricane_add_device_interface_ctx(
+    hurricane_context_t* ctx,
+    uint8_t interface_num,
+    uint8_t interface_class,
+    uint8_t interface_subclass,
+    uint8_t interface_protocol,
+    const hurricane_interface_descriptor_t* descriptor
+);
+int hurricane_remove_device_interface_ctx(hurricane_context_t* ctx, uint8_t interface_num);
+int hurricane_device_configure_endpoint_ctx(
+    hurricane_context_t* ctx,
+    uint8_t interface_num,
+    uint8_t ep_address,
+    uint8_t ep_attributes,
+    uint16_t ep_max_packet_size,
+    uint8_t ep_interval
+);
+void hurricane_device_interface_register_control_handler_ctx(
+    hurricane_context_t* ctx,
+    uint8_t interface_num,
+    bool (*handler)(hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t* length)
+);
+int hurricane_register_host_class_handler_ctx(
+    hurricane_context_t* ctx,
+    uint8_t device_class,
+    uint8_t device_subclass,
+    uint8_t device_protocol,
+    const hurricane_host_class_handler_t* handler
+);
+int hurricane_unregister_host_class_handler_ctx(
+    hurricane_context_t* ctx,
+    uint8_t device_class,
+    uint8_t device_subclass,
+    uint8_t device_protocol
+);
+void hurricane_interface_notify_event_ctx(
+    hurricane_context_t* ctx,
+    hurricane_usb_event_t event,
+    uint8_t interface_num,
+    void* event_data
+);
+bool hurricane_interface_notify_event_with_response_ctx(
+    hurricane_context_t* ctx,
+    hurricane_usb_event_t event,
+    uint8_t interface_num,
+    void* event_data,
+    void (*response_cb)(uint8_t interface_num, bool handled, void* buffer, uint16_t length)
+);
+hurricane_interface_control_result_t hurricane_interface_control_setup_ctx(
+    hurricane_context_t* ctx,
+    uint8_t interface_num,
+    const hurricane_usb_setup_packet_t* setup,
+    void (*response_cb)(uint8_t interface_num, bool handled, void* buffer, uint16_t length)
+);
+void* hurricane_interface_control_claim_ctx(hurricane_context_t* ctx, const hurricane_usb_setup_packet_t* setup);
+int hurricane_interface_control_complete_ctx(
+    hurricane_context_t* ctx,
+    const hurricane_usb_setup_packet_t* setup,
+    bool handled,
+    const void* data,
+    uint16_t length
+);
+int hurricane_device_update_descriptors_ctx(hurricane_context_t* ctx, hurricane_device_descriptors_t* descriptors);
+int hurricane_device_update_report_descriptor_ctx(hurricane_context_t* ctx, uint8_t* report_descriptor,
+                                                  uint16_t length);
+int hurricane_device_trigger_reset_ctx(hurricane_context_t* ctx);
+bool hurricane_get_device_interface_ctx(hurricane_context_t* ctx, uint8_t interface_num,
+                                        hurricane_interface_descriptor_t* descriptor);
+bool hurricane_get_device_endpoint_ctx(
+    hurricane_context_t* ctx,
+    uint8_t interface_num,
+    uint8_t ep_address,
+    hurricane_endpoint_descriptor_t* endpoint
 );
+bool hurricane_get_device_endpoint_by_address_ctx(hurricane_context_t* ctx, uint8_t ep_address,
+                                                  hurricane_endpoint_descriptor_t* endpoint);
 
 #ifdef __cplusplus
 }
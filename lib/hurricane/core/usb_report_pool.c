@@ -0,0 +1,64 @@
+/*
+ * @file usb_report_pool.c
+ * @brief Pool of host-side receive buffers handed to consumers as views
+ */
+
+#include "usb_report_pool.h"
+#include <stddef.h>
+
+_Static_assert(HURRICANE_REPORT_POOL_BUFFERS >= 1 && HURRICANE_REPORT_POOL_BUFFERS <= 32,
+               "HURRICANE_REPORT_POOL_BUFFERS must be 1..32");
+
+#define ALL_BUFFERS ((unsigned int)(0xFFFFFFFFu >> (32 - HURRICANE_REPORT_POOL_BUFFERS)))
+
+uint8_t* hurricane_report_pool_acquire(hurricane_report_pool_t* pool, hurricane_report_view_t* view)
+{
+    if (!pool || !view) {
+        return NULL;
+    }
+
+    unsigned int in_use = atomic_load_explicit(&pool->in_use, memory_order_relaxed);
+    unsigned int index;
+    do {
+        unsigned int free = ~in_use & ALL_BUFFERS;
+        if (!free) {
+            pool->exhausted++;
+            return NULL;
+        }
+        index = (unsigned int)__builtin_ctz(free);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->in_use, &in_use, in_use | (1u << index),
+                                                    memory_order_acquire, memory_order_relaxed));
+
+    atomic_store_explicit(&pool->refs[index], 1, memory_order_relaxed);
+    view->data = pool->buffers[index];
+    view->length = 0;
+    view->pipe = 0;
+    view->buffer = (uint8_t)index;
+    view->timestamp = 0;
+    view->pool = pool;
+    return pool->buffers[index];
+}
+
+uint8_t hurricane_report_pool_held(hurricane_report_pool_t* pool)
+{
+    return pool ? (uint8_t)__builtin_popcount(atomic_load(&pool->in_use)) : 0;
+}
+
+void hurricane_report_view_hold(const hurricane_report_view_t* view)
+{
+    if (view && view->pool) {
+        atomic_fetch_add_explicit(&view->pool->refs[view->buffer], 1, memory_order_relaxed);
+    }
+}
+
+void hurricane_report_view_release(const hurricane_report_view_t* view)
+{
+    if (!view || !view->pool) {
+        return;
+    }
+
+    // Whoever drops the last hold hands the buffer back; reads of it happen before
+    if (atomic_fetch_sub_explicit(&view->pool->refs[view->buffer], 1, memory_order_acq_rel) == 1) {
+        atomic_fetch_and_explicit(&view->pool->in_use, ~(1u << view->buffer), memory_order_release);
+    }
+}
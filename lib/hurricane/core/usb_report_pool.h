@@ -0,0 +1,104 @@
+/**
+ * @file usb_report_pool.h
+ * @brief Pool of host-side receive buffers handed to consumers as views
+ *
+ * Interrupt IN reports are received straight into a buffer of the pool and
+ * handed to the consumer as a read-only view (pointer, length, timestamp,
+ * pipe) instead of being copied into a report structure. The buffer stays
+ * valid for as long as someone holds it:
+ *  - the dispatcher holds it for the duration of the callback, so a
+ *    consumer that is done when the callback returns pays no copy,
+ *  - a consumer that defers work calls hurricane_report_view_hold() in the
+ *    callback and hurricane_report_view_release() when it is done.
+ *
+ * While every buffer is held the receiver stops reading, which leaves the
+ * reports in the device and NAKs further IN tokens rather than dropping
+ * anything. Holding and releasing is lock-free, so a buffer can be released
+ * from any context.
+ *
+ * The pool is valid when zeroed.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Buffers per pool, at most 32
+ */
+#ifndef HURRICANE_REPORT_POOL_BUFFERS
+#define HURRICANE_REPORT_POOL_BUFFERS 4
+#endif
+
+/**
+ * @brief Size of one buffer; the largest high-speed interrupt packet by default
+ */
+#ifndef HURRICANE_REPORT_BUFFER_SIZE
+#define HURRICANE_REPORT_BUFFER_SIZE 1024
+#endif
+
+struct hurricane_report_pool;
+
+/**
+ * @brief Read-only view of one received report
+ */
+typedef struct {
+    const uint8_t* data;                /**< Report as received */
+    uint16_t length;                    /**< Length of data */
+    uint8_t pipe;                       /**< Host pipe the report arrived on (device address) */
+    uint8_t buffer;                     /**< Buffer index in the pool */
+    uint32_t timestamp;                 /**< hurricane_cycles_now() at reception */
+    struct hurricane_report_pool* pool; /**< Pool the buffer belongs to */
+} hurricane_report_view_t;
+
+/**
+ * @brief Receive buffers of one host-side stack
+ */
+typedef struct hurricane_report_pool {
+    _Alignas(4) uint8_t buffers[HURRICANE_REPORT_POOL_BUFFERS][HURRICANE_REPORT_BUFFER_SIZE];
+    atomic_uint in_use;                 /**< Bit per held buffer */
+    atomic_uchar refs[HURRICANE_REPORT_POOL_BUFFERS];   /**< Holders per buffer */
+    uint32_t exhausted;                 /**< Receives skipped because every buffer was held */
+} hurricane_report_pool_t;
+
+/**
+ * @brief Take a free buffer to receive into
+ *
+ * The caller holds the buffer; view->data points to it and view->pool and
+ * view->buffer are set. Fill in length, pipe and timestamp once the report
+ * has arrived, and release the view when done.
+ *
+ * @param pool Pool
+ * @param view Output view
+ * @return Writable buffer of HURRICANE_REPORT_BUFFER_SIZE bytes, NULL if every buffer is held
+ */
+uint8_t* hurricane_report_pool_acquire(hurricane_report_pool_t* pool, hurricane_report_view_t* view);
+
+/**
+ * @brief Number of buffers currently held
+ */
+uint8_t hurricane_report_pool_held(hurricane_report_pool_t* pool);
+
+/**
+ * @brief Keep the buffer of a view beyond the callback it was handed to
+ *
+ * @param view View received in a callback
+ */
+void hurricane_report_view_hold(const hurricane_report_view_t* view);
+
+/**
+ * @brief Drop one hold; the last one returns the buffer to its pool
+ *
+ * @param view View previously acquired or held
+ */
+void hurricane_report_view_release(const hurricane_report_view_t* view);
+
+#ifdef __cplusplus
+}
+#endif
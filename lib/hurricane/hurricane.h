@@ -6,6 +6,7 @@
 #include "usb/usb_control.h"
 #include "core/usb_descriptor.h"
 #include "hw/hurricane_hw_hal.h"
+#include "core/usb_report_pool.h"
 
 
 /**
@@ -16,5 +17,5 @@ typedef struct {
     void (*attach_callback)(void* device);  /**< Device attached callback */
     void (*detach_callback)(void* device);  /**< Device detached callback */
     bool (*control_callback)(hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t* length);  /**< Control transfer callback */
-    void (*data_callback)(uint8_t endpoint, void* buffer, uint16_t length);  /**< Data transfer callback */
+    void (*data_callback)(const hurricane_report_view_t* view);  /**< Report received; hold the view to keep it past the call */
 } hurricane_host_class_handler_t;
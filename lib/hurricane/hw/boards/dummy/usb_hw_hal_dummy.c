@@ -8,17 +8,24 @@
 hurricane_usb_setup_packet_t last_setup_sent;
 uint8_t last_control_data_sent[64];
 size_t last_control_data_length = 0;
+uint8_t last_interrupt_out_endpoint = 0;
+uint8_t last_interrupt_out_data[64];
+size_t last_interrupt_out_length = 0;
+int interrupt_out_count = 0;
+int control_transfer_failures = 0; // Next control transfers to fail
+int interrupt_out_failures = 0;    // Next interrupt OUT transfers to fail
 
 // These variables will be accessed by the test file
 uint8_t test_address_set = 0;
 uint8_t test_descriptor_requested = 0;
+int hw_poll_count = 0;
 
 void hurricane_hw_init(void) {
     printf("[stub-hal] hurricane_hw_init()\n");
 }
 
 void hurricane_hw_poll(void) {
-    // no-op
+    hw_poll_count++;
 }
 
 int hurricane_hw_device_connected(void) {
@@ -30,6 +37,10 @@ int hurricane_hw_control_transfer(const hurricane_usb_setup_packet_t* setup, voi
     
     // Save the setup packet for tests to verify
     memcpy(&last_setup_sent, setup, sizeof(hurricane_usb_setup_packet_t));
+    if (control_transfer_failures > 0) {
+        control_transfer_failures--;
+        return -1;
+    }
     
     // Track the operations for our tests
     if (setup->bRequest == USB_REQ_SET_ADDRESS) {
@@ -81,6 +92,21 @@ int hurricane_hw_interrupt_in_transfer(uint8_t endpoint, void* buffer, uint16_t
     return 0;
 }
 
+int hurricane_hw_interrupt_out_transfer(uint8_t endpoint, void* buffer, uint16_t length) {
+    printf("[stub-hal] hurricane_hw_interrupt_out_transfer(): Endpoint=%u, Length=%u\n", endpoint, length);
+    if (interrupt_out_failures > 0) {
+        interrupt_out_failures--;
+        return -1;
+    }
+    last_interrupt_out_endpoint = endpoint;
+    last_interrupt_out_length = length < sizeof(last_interrupt_out_data) ? length : sizeof(last_interrupt_out_data);
+    if (buffer) {
+        memcpy(last_interrupt_out_data, buffer, last_interrupt_out_length);
+    }
+    interrupt_out_count++;
+    return length;
+}
+
 void hurricane_hw_reset_bus(void) {
     printf("[dummy hal] Bus reset\n");
 }
\ No newline at end of file
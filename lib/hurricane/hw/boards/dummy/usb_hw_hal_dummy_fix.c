@@ -1,5 +1,6 @@
 #include "hw/hurricane_hw_hal.h"
 #include <stdio.h>
+#include <string.h>
 
 /**
  * @brief Configure a USB endpoint in device mode (dummy implementation)
@@ -61,4 +62,68 @@ int hurricane_hw_device_set_hid_report_descriptor(
     printf("[stub-hal-fix] hurricane_hw_device_set_hid_report_descriptor(): len=%d\n", 
            report_desc_length);
     return 0; // Return success
-}
\ No newline at end of file
+}
+// Device-side EP0 activity, inspected by the tests
+hurricane_usb_setup_packet_t last_device_response_setup;
+uint8_t last_device_response_data[64];
+uint16_t last_device_response_length = 0;
+int device_response_count = 0;
+uint8_t last_stalled_endpoint = 0xFF;
+
+// Device-side interrupt IN reports, inspected by the tests
+uint8_t last_interrupt_in_endpoint = 0;
+uint8_t last_interrupt_in_data[65];
+uint16_t last_interrupt_in_length = 0;
+int interrupt_in_count = 0;
+
+/**
+ * @brief Respond to a device-side control request (dummy implementation)
+ */
+int hurricane_hw_device_control_response(
+    const hurricane_usb_setup_packet_t* setup,
+    void* buffer,
+    uint16_t length
+) {
+    printf("[stub-hal-fix] hurricane_hw_device_control_response(): request=0x%02X, len=%d\n",
+           setup->bRequest, length);
+    last_device_response_setup = *setup;
+    last_device_response_length = length;
+    if (buffer) {
+        memcpy(last_device_response_data, buffer,
+               length < sizeof(last_device_response_data) ? length : sizeof(last_device_response_data));
+    }
+    device_response_count++;
+    return length;
+}
+
+/**
+ * @brief Stall or unstall an endpoint (dummy implementation)
+ */
+int hurricane_hw_device_endpoint_stall(
+    uint8_t ep_address,
+    bool stall
+) {
+    printf("[stub-hal-fix] hurricane_hw_device_endpoint_stall(): ep=%02x, stall=%d\n",
+           ep_address, stall);
+    last_stalled_endpoint = stall ? ep_address : 0xFF;
+    return 0;
+}
+
+/**
+ * @brief Send a report to the PC on an interrupt IN endpoint (dummy implementation)
+ */
+int hurricane_hw_device_interrupt_in_transfer(
+    uint8_t endpoint,
+    void* buffer,
+    uint16_t length
+) {
+    printf("[stub-hal-fix] hurricane_hw_device_interrupt_in_transfer(): ep=%02x, len=%d\n",
+           endpoint, length);
+    last_interrupt_in_endpoint = endpoint;
+    last_interrupt_in_length = length < sizeof(last_interrupt_in_data) ? length : sizeof(last_interrupt_in_data);
+    if (buffer) {
+        memcpy(last_interrupt_in_data, buffer, last_interrupt_in_length);
+    }
+    interrupt_in_count++;
+    return length;
+}
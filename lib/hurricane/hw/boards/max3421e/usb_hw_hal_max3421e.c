@@ -1,6 +1,7 @@
 #ifdef MAX3421E_ENABLED
 
 #include "hw/hurricane_hw_hal.h"
+#include "usb_hw_hal_max3421e.h"
 #include "max3421e_registers.h"
 #include <stdio.h>
 #include <string.h>
@@ -11,34 +12,25 @@
 #include "driver/gpio.h"
 #include "esp_log.h"
 
-// Configuration for ESP32 SPI and GPIO pins
-#define MAX3421E_SPI_HOST       SPI2_HOST
-#define MAX3421E_SPI_MOSI       GPIO_NUM_23
-#define MAX3421E_SPI_MISO       GPIO_NUM_19
-#define MAX3421E_SPI_CLK        GPIO_NUM_18
-#define MAX3421E_SPI_CS         GPIO_NUM_5
-#define MAX3421E_INT_PIN        GPIO_NUM_4
-#define MAX3421E_RST_PIN        GPIO_NUM_22
-
 static const char* TAG = "max3421e";
-static spi_device_handle_t spi_handle;
-static uint8_t current_device_address = 0;
-static bool device_connected = false;
+
+// SPI buses already brought up (several chips may share one bus)
+static uint32_t spi_bus_ready = 0;
 
 // Forward declarations for internal functions
-static uint8_t max3421e_read_register(uint8_t reg);
-static void max3421e_write_register(uint8_t reg, uint8_t data);
-static void max3421e_write_bytes(uint8_t reg, const uint8_t* data, uint8_t length);
-static void max3421e_read_bytes(uint8_t reg, uint8_t* data, uint8_t length);
-static int max3421e_wait_for_interrupt(uint8_t irq_mask, uint16_t timeout_ms);
-static void max3421e_reset(void);
-static uint8_t max3421e_get_connection_speed(void);
-static uint8_t max3421e_get_status(void);
-static uint8_t max3421e_get_result(void);
-static void max3421e_handle_irqs(void);
+static uint8_t max3421e_read_register(max3421e_port_t* port, uint8_t reg);
+static void max3421e_write_register(max3421e_port_t* port, uint8_t reg, uint8_t data);
+static void max3421e_write_bytes(max3421e_port_t* port, uint8_t reg, const uint8_t* data, uint8_t length);
+static void max3421e_read_bytes(max3421e_port_t* port, uint8_t reg, uint8_t* data, uint8_t length);
+static int max3421e_wait_for_interrupt(max3421e_port_t* port, uint8_t irq_mask, uint16_t timeout_ms);
+static void max3421e_reset(max3421e_port_t* port);
+static uint8_t max3421e_get_connection_speed(max3421e_port_t* port);
+static uint8_t max3421e_get_status(max3421e_port_t* port);
+static uint8_t max3421e_get_result(max3421e_port_t* port);
+static void max3421e_handle_irqs(max3421e_port_t* port);
 
 // SPI communication functions
-static uint8_t max3421e_read_register(uint8_t reg) {
+static uint8_t max3421e_read_register(max3421e_port_t* port, uint8_t reg) {
     uint8_t cmd = reg | MAX3421E_DIR_IN;
     uint8_t result = 0;
     
@@ -50,7 +42,7 @@ static uint8_t max3421e_read_register(uint8_t reg) {
         .flags = SPI_TRANS_USE_RXDATA
     };
     
-    if (spi_device_polling_transmit(spi_handle, &t) != ESP_OK) {
+    if (spi_device_polling_transmit((spi_device_handle_t)port->spi_handle, &t) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read register 0x%02X", reg);
         return 0;
     }
@@ -58,7 +50,7 @@ static uint8_t max3421e_read_register(uint8_t reg) {
     return result;
 }
 
-static void max3421e_write_register(uint8_t reg, uint8_t data) {
+static void max3421e_write_register(max3421e_port_t* port, uint8_t reg, uint8_t data) {
     uint8_t cmd[2] = { reg | MAX3421E_DIR_OUT, data };
     
     spi_transaction_t t = {
@@ -67,12 +59,12 @@ static void max3421e_write_register(uint8_t reg, uint8_t data) {
         .flags = 0
     };
     
-    if (spi_device_polling_transmit(spi_handle, &t) != ESP_OK) {
+    if (spi_device_polling_transmit((spi_device_handle_t)port->spi_handle, &t) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write register 0x%02X", reg);
     }
 }
 
-static void max3421e_write_bytes(uint8_t reg, const uint8_t* data, uint8_t length) {
+static void max3421e_write_bytes(max3421e_port_t* port, uint8_t reg, const uint8_t* data, uint8_t length) {
     uint8_t* buffer = malloc(length + 1);
     if (!buffer) {
         ESP_LOGE(TAG, "Failed to allocate buffer for SPI write");
@@ -88,14 +80,14 @@ static void max3421e_write_bytes(uint8_t reg, const uint8_t* data, uint8_t lengt
         .flags = 0
     };
     
-    if (spi_device_polling_transmit(spi_handle, &t) != ESP_OK) {
+    if (spi_device_polling_transmit((spi_device_handle_t)port->spi_handle, &t) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to write multiple bytes to register 0x%02X", reg);
     }
     
     free(buffer);
 }
 
-static void max3421e_read_bytes(uint8_t reg, uint8_t* data, uint8_t length) {
+static void max3421e_read_bytes(max3421e_port_t* port, uint8_t reg, uint8_t* data, uint8_t length) {
     uint8_t cmd = reg | MAX3421E_DIR_IN;
     
     spi_transaction_t t_cmd = {
@@ -104,7 +96,7 @@ static void max3421e_read_bytes(uint8_t reg, uint8_t* data, uint8_t length) {
         .flags = 0
     };
     
-    if (spi_device_polling_transmit(spi_handle, &t_cmd) != ESP_OK) {
+    if (spi_device_polling_transmit((spi_device_handle_t)port->spi_handle, &t_cmd) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to send read command to register 0x%02X", reg);
         return;
     }
@@ -115,18 +107,18 @@ static void max3421e_read_bytes(uint8_t reg, uint8_t* data, uint8_t length) {
         .flags = 0
     };
     
-    if (spi_device_polling_transmit(spi_handle, &t_data) != ESP_OK) {
+    if (spi_device_polling_transmit((spi_device_handle_t)port->spi_handle, &t_data) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to read multiple bytes from register 0x%02X", reg);
     }
 }
 
-// Initialize the MAX3421E host controller
-void hurricane_hw_init(void) {
-    ESP_LOGI(TAG, "Initializing MAX3421E USB host controller");
+// Initialize a MAX3421E host controller
+static void max3421e_port_init(max3421e_port_t* port) {
+    ESP_LOGI(TAG, "Initializing MAX3421E USB host controller (CS %d)", port->cs_pin);
 
     // Configure GPIO pins
     gpio_config_t gpio_conf = {
-        .pin_bit_mask = (1ULL << MAX3421E_INT_PIN) | (1ULL << MAX3421E_RST_PIN),
+        .pin_bit_mask = (1ULL << port->int_pin) | (1ULL << port->rst_pin),
         .mode = GPIO_MODE_OUTPUT,
         .pull_up_en = GPIO_PULLUP_DISABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
@@ -135,133 +127,141 @@ void hurricane_hw_init(void) {
     gpio_config(&gpio_conf);
     
     // Reset MAX3421E using reset pin
-    gpio_set_level(MAX3421E_RST_PIN, 0);
+    gpio_set_level(port->rst_pin, 0);
     vTaskDelay(pdMS_TO_TICKS(10));
-    gpio_set_level(MAX3421E_RST_PIN, 1);
+    gpio_set_level(port->rst_pin, 1);
     vTaskDelay(pdMS_TO_TICKS(10));
     
-    // Configure SPI bus
-    spi_bus_config_t bus_config = {
-        .mosi_io_num = MAX3421E_SPI_MOSI,
-        .miso_io_num = MAX3421E_SPI_MISO,
-        .sclk_io_num = MAX3421E_SPI_CLK,
-        .quadwp_io_num = -1,
-        .quadhd_io_num = -1,
-        .max_transfer_sz = 32,
-    };
-    
-    ESP_ERROR_CHECK(spi_bus_initialize(MAX3421E_SPI_HOST, &bus_config, SPI_DMA_CH_AUTO));
+    // Configure SPI bus (once per bus, chips on the same bus only differ in CS)
+    if (!(spi_bus_ready & (1u << port->spi_host))) {
+        spi_bus_config_t bus_config = {
+            .mosi_io_num = port->mosi_pin,
+            .miso_io_num = port->miso_pin,
+            .sclk_io_num = port->clk_pin,
+            .quadwp_io_num = -1,
+            .quadhd_io_num = -1,
+            .max_transfer_sz = 32,
+        };
+        
+        ESP_ERROR_CHECK(spi_bus_initialize((spi_host_device_t)port->spi_host, &bus_config, SPI_DMA_CH_AUTO));
+        spi_bus_ready |= 1u << port->spi_host;
+    }
     
     // Attach the MAX3421E to the SPI bus
     spi_device_interface_config_t dev_config = {
         .mode = 0,
         .clock_speed_hz = 10*1000*1000,  // 10 MHz
-        .spics_io_num = MAX3421E_SPI_CS,
+        .spics_io_num = port->cs_pin,
         .queue_size = 3,
         .flags = 0,
     };
     
-    ESP_ERROR_CHECK(spi_bus_add_device(MAX3421E_SPI_HOST, &dev_config, &spi_handle));
+    spi_device_handle_t handle;
+    ESP_ERROR_CHECK(spi_bus_add_device((spi_host_device_t)port->spi_host, &dev_config, &handle));
+    port->spi_handle = handle;
     
     // Reset the MAX3421E
-    max3421e_reset();
+    max3421e_reset(port);
     
     // Configure the MAX3421E for host mode
-    uint8_t mode_reg = max3421e_read_register(MAX3421E_REG_MODE);
+    uint8_t mode_reg = max3421e_read_register(port, MAX3421E_REG_MODE);
     mode_reg |= MAX3421E_MODE_HOST;      // Host mode
     mode_reg |= MAX3421E_MODE_SOFKAENAB; // Enable SOF generation
-    max3421e_write_register(MAX3421E_REG_MODE, mode_reg);
+    max3421e_write_register(port, MAX3421E_REG_MODE, mode_reg);
     
     // Configure pin control
-    max3421e_write_register(MAX3421E_REG_PINCTL, MAX3421E_PINCTL_FDUPSPI | MAX3421E_PINCTL_INTLEVEL);
+    max3421e_write_register(port, MAX3421E_REG_PINCTL, MAX3421E_PINCTL_FDUPSPI | MAX3421E_PINCTL_INTLEVEL);
     
     // Enable interrupts
-    max3421e_write_register(MAX3421E_REG_HIEN, 
+    max3421e_write_register(port, MAX3421E_REG_HIEN, 
                            MAX3421E_HIEN_CONDETIE |  // Connect detect
                            MAX3421E_HIEN_RCVDAVIE |  // Receive data available
                            MAX3421E_HIEN_HXFRDNIE);  // Transfer done
     
     // Enable USB interrupts
-    max3421e_write_register(MAX3421E_REG_USBIEN, 
+    max3421e_write_register(port, MAX3421E_REG_USBIEN, 
                            MAX3421E_USBIEN_OSCOKIE |  // Oscillator OK
                            MAX3421E_USBIEN_VBUSIE);   // VBUS change
     
     ESP_LOGI(TAG, "MAX3421E initialized successfully");
     
     // Start with a clean interrupt state
-    max3421e_write_register(MAX3421E_REG_HIRQ, 0xFF);
-    max3421e_write_register(MAX3421E_REG_USBIRQ, 0xFF);
+    max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);
+    max3421e_write_register(port, MAX3421E_REG_USBIRQ, 0xFF);
     
-    device_connected = false;
-    current_device_address = 0;
+    port->device_connected = false;
+    port->device_address = 0;
+    port->in_toggle = false;
+    port->out_toggle = false;
 }
 
-// Poll the MAX3421E for events
-void hurricane_hw_poll(void) {
+// Poll a MAX3421E for events
+static void max3421e_port_poll(max3421e_port_t* port) {
     // Check for and handle interrupts
-    max3421e_handle_irqs();
+    max3421e_handle_irqs(port);
     
     // Check for device connection if none connected
-    if (!device_connected) {
-        uint8_t jk_state = max3421e_get_status();
+    if (!port->device_connected) {
+        uint8_t jk_state = max3421e_get_status(port);
         if (jk_state & MAX3421E_HRSL_JSTATUS) {
             ESP_LOGI(TAG, "J state detected: Full-speed device connected");
-            device_connected = true;
+            port->device_connected = true;
             
             // Issue bus reset
-            max3421e_write_register(MAX3421E_REG_HCTL, MAX3421E_HCTL_BUSRST);
+            max3421e_write_register(port, MAX3421E_REG_HCTL, MAX3421E_HCTL_BUSRST);
             vTaskDelay(pdMS_TO_TICKS(50));  // Wait for bus reset to complete
-            max3421e_write_register(MAX3421E_REG_HCTL, 0);
+            max3421e_write_register(port, MAX3421E_REG_HCTL, 0);
             vTaskDelay(pdMS_TO_TICKS(20));  // Recovery time
             
             // Set default address 0 for enumeration
-            current_device_address = 0;
-            max3421e_write_register(MAX3421E_REG_PERADDR, current_device_address);
+            port->device_address = 0;
+            max3421e_write_register(port, MAX3421E_REG_PERADDR, port->device_address);
         } else if (jk_state & MAX3421E_HRSL_KSTATUS) {
             ESP_LOGI(TAG, "K state detected: Low-speed device connected");
-            device_connected = true;
+            port->device_connected = true;
             
             // Configure for low-speed
-            uint8_t mode = max3421e_read_register(MAX3421E_REG_MODE);
+            uint8_t mode = max3421e_read_register(port, MAX3421E_REG_MODE);
             mode |= MAX3421E_MODE_SPEED;  // Enable low-speed mode
-            max3421e_write_register(MAX3421E_REG_MODE, mode);
+            max3421e_write_register(port, MAX3421E_REG_MODE, mode);
             
             // Issue bus reset
-            max3421e_write_register(MAX3421E_REG_HCTL, MAX3421E_HCTL_BUSRST);
+            max3421e_write_register(port, MAX3421E_REG_HCTL, MAX3421E_HCTL_BUSRST);
             vTaskDelay(pdMS_TO_TICKS(50));  // Wait for bus reset to complete
-            max3421e_write_register(MAX3421E_REG_HCTL, 0);
+            max3421e_write_register(port, MAX3421E_REG_HCTL, 0);
             vTaskDelay(pdMS_TO_TICKS(20));  // Recovery time
             
             // Set default address 0 for enumeration
-            current_device_address = 0;
-            max3421e_write_register(MAX3421E_REG_PERADDR, current_device_address);
+            port->device_address = 0;
+            max3421e_write_register(port, MAX3421E_REG_PERADDR, port->device_address);
         }
     }
 }
 
 // Check if a device is connected
-int hurricane_hw_device_connected(void) {
-    return device_connected ? 1 : 0;
+static int max3421e_port_device_connected(max3421e_port_t* port) {
+    return port->device_connected ? 1 : 0;
 }
 
 // Reset the USB bus
-void hurricane_hw_reset_bus(void) {
+static void max3421e_port_reset_bus(max3421e_port_t* port) {
     ESP_LOGI(TAG, "Resetting USB bus");
     
     // Issue bus reset
-    max3421e_write_register(MAX3421E_REG_HCTL, MAX3421E_HCTL_BUSRST);
+    max3421e_write_register(port, MAX3421E_REG_HCTL, MAX3421E_HCTL_BUSRST);
     vTaskDelay(pdMS_TO_TICKS(50));  // Wait for bus reset to complete
-    max3421e_write_register(MAX3421E_REG_HCTL, 0);
+    max3421e_write_register(port, MAX3421E_REG_HCTL, 0);
     vTaskDelay(pdMS_TO_TICKS(20));  // Recovery time
     
     // Reset device tracking
-    device_connected = false;
-    current_device_address = 0;
+    port->device_connected = false;
+    port->device_address = 0;
 }
 
 // Perform a USB control transfer
-int hurricane_hw_control_transfer(const hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t length) {
-    if (!device_connected) {
+static int max3421e_port_control_transfer(max3421e_port_t* port, const hurricane_usb_setup_packet_t* setup,
+                                          void* buffer, uint16_t length) {
+    if (!port->device_connected) {
         ESP_LOGE(TAG, "No device connected for control transfer");
         return -1;
     }
@@ -270,7 +270,7 @@ int hurricane_hw_control_transfer(const hurricane_usb_setup_packet_t* setup, voi
              setup->bRequest, setup->wValue, setup->wIndex, setup->wLength);
     
     // Set device address for the transaction
-    max3421e_write_register(MAX3421E_REG_PERADDR, current_device_address);
+    max3421e_write_register(port, MAX3421E_REG_PERADDR, port->device_address);
     
     // Load setup data into SUDFIFO
     uint8_t setup_data[8];
@@ -283,22 +283,22 @@ int hurricane_hw_control_transfer(const hurricane_usb_setup_packet_t* setup, voi
     setup_data[6] = setup->wLength & 0xFF;
     setup_data[7] = (setup->wLength >> 8) & 0xFF;
     
-    max3421e_write_bytes(MAX3421E_REG_SUDFIFO, setup_data, 8);
+    max3421e_write_bytes(port, MAX3421E_REG_SUDFIFO, setup_data, 8);
     
     // Clear any pending interrupts
-    max3421e_write_register(MAX3421E_REG_HIRQ, 0xFF);
+    max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);
     
     // Trigger SETUP transfer
-    max3421e_write_register(MAX3421E_REG_HXFR, MAX3421E_HXFR_SETUP);
+    max3421e_write_register(port, MAX3421E_REG_HXFR, MAX3421E_HXFR_SETUP);
     
     // Wait for transfer completion
-    if (max3421e_wait_for_interrupt(MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
+    if (max3421e_wait_for_interrupt(port, MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
         ESP_LOGE(TAG, "Timeout waiting for SETUP stage completion");
         return -1;
     }
     
     // Check result
-    uint8_t result = max3421e_get_result();
+    uint8_t result = max3421e_get_result(port);
     if (result != MAX3421E_RESULT_SUCCESS) {
         ESP_LOGE(TAG, "SETUP transfer failed: 0x%02X", result);
         return -1;
@@ -311,36 +311,36 @@ int hurricane_hw_control_transfer(const hurricane_usb_setup_packet_t* setup, voi
         
         if (is_device_to_host) {
             // IN transfer (device to host)
-            max3421e_write_register(MAX3421E_REG_HCTL, MAX3421E_HCTL_RCVTOG1);  // Set toggle for IN data stage
-            max3421e_write_register(MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
-            max3421e_write_register(MAX3421E_REG_HXFR, MAX3421E_HXFR_IN);  // Start IN transfer
+            max3421e_write_register(port, MAX3421E_REG_HCTL, MAX3421E_HCTL_RCVTOG1);  // Set toggle for IN data stage
+            max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
+            max3421e_write_register(port, MAX3421E_REG_HXFR, MAX3421E_HXFR_IN);  // Start IN transfer
             
-            if (max3421e_wait_for_interrupt(MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
+            if (max3421e_wait_for_interrupt(port, MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
                 ESP_LOGE(TAG, "Timeout waiting for IN data stage");
                 return -1;
             }
             
-            result = max3421e_get_result();
+            result = max3421e_get_result(port);
             if (result != MAX3421E_RESULT_SUCCESS) {
                 ESP_LOGE(TAG, "IN data stage failed: 0x%02X", result);
                 return -1;
             }
             
             // Read the received data
-            uint8_t recv_bytes = max3421e_read_register(MAX3421E_REG_RCVBC);
+            uint8_t recv_bytes = max3421e_read_register(port, MAX3421E_REG_RCVBC);
             if (recv_bytes > 0) {
                 if (recv_bytes > length) {
                     recv_bytes = length;
                 }
                 
-                max3421e_read_bytes(MAX3421E_REG_RCVFIFO, buffer, recv_bytes);
+                max3421e_read_bytes(port, MAX3421E_REG_RCVFIFO, buffer, recv_bytes);
                 
                 // Send zero-length OUT status stage
-                max3421e_write_register(MAX3421E_REG_HCTL, MAX3421E_HCTL_SNDTOG1);  // Set toggle for OUT status
-                max3421e_write_register(MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
-                max3421e_write_register(MAX3421E_REG_HXFR, MAX3421E_HXFR_OUT);  // Start OUT transfer
+                max3421e_write_register(port, MAX3421E_REG_HCTL, MAX3421E_HCTL_SNDTOG1);  // Set toggle for OUT status
+                max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
+                max3421e_write_register(port, MAX3421E_REG_HXFR, MAX3421E_HXFR_OUT);  // Start OUT transfer
                 
-                if (max3421e_wait_for_interrupt(MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
+                if (max3421e_wait_for_interrupt(port, MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
                     ESP_LOGE(TAG, "Timeout waiting for OUT status stage");
                     return -1;
                 }
@@ -352,31 +352,31 @@ int hurricane_hw_control_transfer(const hurricane_usb_setup_packet_t* setup, voi
             // Load data to send
             if (length > 0 && buffer != NULL) {
                 // Write data to SNDFIFO
-                max3421e_write_bytes(MAX3421E_REG_SNDFIFO, buffer, length);
-                max3421e_write_register(MAX3421E_REG_SNDBC, length);
+                max3421e_write_bytes(port, MAX3421E_REG_SNDFIFO, buffer, length);
+                max3421e_write_register(port, MAX3421E_REG_SNDBC, length);
                 
                 // Start OUT data transfer
-                max3421e_write_register(MAX3421E_REG_HCTL, MAX3421E_HCTL_SNDTOG1);  // Set toggle for OUT data
-                max3421e_write_register(MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
-                max3421e_write_register(MAX3421E_REG_HXFR, MAX3421E_HXFR_OUT);  // Start OUT transfer
+                max3421e_write_register(port, MAX3421E_REG_HCTL, MAX3421E_HCTL_SNDTOG1);  // Set toggle for OUT data
+                max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
+                max3421e_write_register(port, MAX3421E_REG_HXFR, MAX3421E_HXFR_OUT);  // Start OUT transfer
                 
-                if (max3421e_wait_for_interrupt(MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
+                if (max3421e_wait_for_interrupt(port, MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
                     ESP_LOGE(TAG, "Timeout waiting for OUT data stage");
                     return -1;
                 }
                 
-                result = max3421e_get_result();
+                result = max3421e_get_result(port);
                 if (result != MAX3421E_RESULT_SUCCESS) {
                     ESP_LOGE(TAG, "OUT data stage failed: 0x%02X", result);
                     return -1;
                 }
                 
                 // IN status stage
-                max3421e_write_register(MAX3421E_REG_HCTL, MAX3421E_HCTL_RCVTOG1);  // Set toggle for IN status
-                max3421e_write_register(MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
-                max3421e_write_register(MAX3421E_REG_HXFR, MAX3421E_HXFR_IN);  // Start IN transfer
+                max3421e_write_register(port, MAX3421E_REG_HCTL, MAX3421E_HCTL_RCVTOG1);  // Set toggle for IN status
+                max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
+                max3421e_write_register(port, MAX3421E_REG_HXFR, MAX3421E_HXFR_IN);  // Start IN transfer
                 
-                if (max3421e_wait_for_interrupt(MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
+                if (max3421e_wait_for_interrupt(port, MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
                     ESP_LOGE(TAG, "Timeout waiting for IN status stage");
                     return -1;
                 }
@@ -392,17 +392,17 @@ int hurricane_hw_control_transfer(const hurricane_usb_setup_packet_t* setup, voi
         
         if (is_device_to_host) {
             // Status stage is OUT
-            max3421e_write_register(MAX3421E_REG_HCTL, MAX3421E_HCTL_SNDTOG1);  // Set toggle for OUT status
-            max3421e_write_register(MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
-            max3421e_write_register(MAX3421E_REG_HXFR, MAX3421E_HXFR_OUT);  // Start OUT transfer
+            max3421e_write_register(port, MAX3421E_REG_HCTL, MAX3421E_HCTL_SNDTOG1);  // Set toggle for OUT status
+            max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
+            max3421e_write_register(port, MAX3421E_REG_HXFR, MAX3421E_HXFR_OUT);  // Start OUT transfer
         } else {
             // Status stage is IN
-            max3421e_write_register(MAX3421E_REG_HCTL, MAX3421E_HCTL_RCVTOG1);  // Set toggle for IN status
-            max3421e_write_register(MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
-            max3421e_write_register(MAX3421E_REG_HXFR, MAX3421E_HXFR_IN);  // Start IN transfer
+            max3421e_write_register(port, MAX3421E_REG_HCTL, MAX3421E_HCTL_RCVTOG1);  // Set toggle for IN status
+            max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
+            max3421e_write_register(port, MAX3421E_REG_HXFR, MAX3421E_HXFR_IN);  // Start IN transfer
         }
         
-        if (max3421e_wait_for_interrupt(MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
+        if (max3421e_wait_for_interrupt(port, MAX3421E_HIRQ_HXFRDNIRQ, 500) != 0) {
             ESP_LOGE(TAG, "Timeout waiting for status stage");
             return -1;
         }
@@ -412,51 +412,51 @@ int hurricane_hw_control_transfer(const hurricane_usb_setup_packet_t* setup, voi
 }
 
 // Set the device address after enumeration
-int hurricane_hw_set_address(uint8_t address) {
+int max3421e_port_set_address(max3421e_port_t* port, uint8_t address) {
     ESP_LOGI(TAG, "Setting device address to %d", address);
-    current_device_address = address;
-    max3421e_write_register(MAX3421E_REG_PERADDR, current_device_address);
+    port->device_address = address;
+    max3421e_write_register(port, MAX3421E_REG_PERADDR, port->device_address);
     return 0;
 }
 
 // Perform an interrupt IN transfer (for HID devices)
-int hurricane_hw_interrupt_in_transfer(uint8_t endpoint, void* buffer, uint16_t length) {
-    if (!device_connected) {
+static int max3421e_port_interrupt_in_transfer(max3421e_port_t* port, uint8_t endpoint,
+                                               void* buffer, uint16_t length) {
+    if (!port->device_connected) {
         ESP_LOGE(TAG, "No device connected for interrupt transfer");
         return -1;
     }
     
     // Set device address
-    max3421e_write_register(MAX3421E_REG_PERADDR, current_device_address);
+    max3421e_write_register(port, MAX3421E_REG_PERADDR, port->device_address);
     
     // Clear any pending interrupts
-    max3421e_write_register(MAX3421E_REG_HIRQ, 0xFF);
+    max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);
     
     // Toggle receive data 
     uint8_t hctl = 0;
-    static bool toggle = false;
-    if (toggle) {
+    if (port->in_toggle) {
         hctl |= MAX3421E_HCTL_RCVTOG1;
     } else {
         hctl |= MAX3421E_HCTL_RCVTOG0;
     }
     
-    max3421e_write_register(MAX3421E_REG_HCTL, hctl);
+    max3421e_write_register(port, MAX3421E_REG_HCTL, hctl);
     
     // Start the IN transfer - endpoint goes in the lower 4 bits
-    max3421e_write_register(MAX3421E_REG_HXFR, MAX3421E_HXFR_IN | (endpoint & MAX3421E_HXFR_EP_MASK));
+    max3421e_write_register(port, MAX3421E_REG_HXFR, MAX3421E_HXFR_IN | (endpoint & MAX3421E_HXFR_EP_MASK));
     
     // Wait for transfer completion with short timeout (non-blocking behavior)
-    if (max3421e_wait_for_interrupt(MAX3421E_HIRQ_HXFRDNIRQ, 5) != 0) {
+    if (max3421e_wait_for_interrupt(port, MAX3421E_HIRQ_HXFRDNIRQ, 5) != 0) {
         // No data available, which is fine for polling interrupt endpoints
         return 0;
     }
     
     // Check result
-    uint8_t result = max3421e_get_result();
+    uint8_t result = max3421e_get_result(port);
     if (result == MAX3421E_RESULT_SUCCESS) {
         // Get received data
-        uint8_t recv_bytes = max3421e_read_register(MAX3421E_REG_RCVBC);
+        uint8_t recv_bytes = max3421e_read_register(port, MAX3421E_REG_RCVBC);
         if (recv_bytes > 0) {
             // Limit to buffer size
             if (recv_bytes > length) {
@@ -464,10 +464,10 @@ int hurricane_hw_interrupt_in_transfer(uint8_t endpoint, void* buffer, uint16_t
             }
             
             // Read data from RCVFIFO
-            max3421e_read_bytes(MAX3421E_REG_RCVFIFO, buffer, recv_bytes);
+            max3421e_read_bytes(port, MAX3421E_REG_RCVFIFO, buffer, recv_bytes);
             
             // Toggle for next transfer
-            toggle = !toggle;
+            port->in_toggle = !port->in_toggle;
             
             return recv_bytes;
         }
@@ -482,19 +482,59 @@ int hurricane_hw_interrupt_in_transfer(uint8_t endpoint, void* buffer, uint16_t
     return 0;
 }
 
+// Perform an interrupt OUT transfer (e.g. HID output reports)
+static int max3421e_port_interrupt_out_transfer(max3421e_port_t* port, uint8_t endpoint,
+                                                void* buffer, uint16_t length) {
+    if (!port->device_connected) {
+        ESP_LOGE(TAG, "No device connected for interrupt transfer");
+        return -1;
+    }
+    if (length > 64) {
+        ESP_LOGE(TAG, "Interrupt OUT transfer too long (%u bytes)", length);
+        return -1;
+    }
+    
+    // Set device address
+    max3421e_write_register(port, MAX3421E_REG_PERADDR, port->device_address);
+    
+    // Load data into SNDFIFO
+    max3421e_write_bytes(port, MAX3421E_REG_SNDFIFO, buffer, (uint8_t)length);
+    max3421e_write_register(port, MAX3421E_REG_SNDBC, (uint8_t)length);
+    
+    max3421e_write_register(port, MAX3421E_REG_HCTL,
+                            port->out_toggle ? MAX3421E_HCTL_SNDTOG1 : MAX3421E_HCTL_SNDTOG0);
+    max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);  // Clear interrupts
+    max3421e_write_register(port, MAX3421E_REG_HXFR, MAX3421E_HXFR_OUT | (endpoint & MAX3421E_HXFR_EP_MASK));
+    
+    if (max3421e_wait_for_interrupt(port, MAX3421E_HIRQ_HXFRDNIRQ, 50) != 0) {
+        ESP_LOGW(TAG, "Timeout waiting for interrupt OUT transfer");
+        return -1;
+    }
+    
+    uint8_t result = max3421e_get_result(port);
+    if (result != MAX3421E_RESULT_SUCCESS) {
+        ESP_LOGW(TAG, "Interrupt OUT transfer failed: 0x%02X", result);
+        return -1;
+    }
+    
+    // Toggle for next transfer
+    port->out_toggle = !port->out_toggle;
+    return length;
+}
+
 // Internal helper functions
 
-static void max3421e_reset(void) {
+static void max3421e_reset(max3421e_port_t* port) {
     // Software reset
-    max3421e_write_register(MAX3421E_REG_USBCTL, MAX3421E_USBCTL_CHIPRES);
+    max3421e_write_register(port, MAX3421E_REG_USBCTL, MAX3421E_USBCTL_CHIPRES);
     vTaskDelay(pdMS_TO_TICKS(10));
-    max3421e_write_register(MAX3421E_REG_USBCTL, 0);
+    max3421e_write_register(port, MAX3421E_REG_USBCTL, 0);
     
     // Wait for oscillator to stabilize
     ESP_LOGI(TAG, "Waiting for MAX3421E oscillator...");
     uint16_t timeout = 500;  // 500ms timeout
     while (timeout > 0) {
-        uint8_t usbirq = max3421e_read_register(MAX3421E_REG_USBIRQ);
+        uint8_t usbirq = max3421e_read_register(port, MAX3421E_REG_USBIRQ);
         if (usbirq & MAX3421E_USBIRQ_OSCOKIRQ) {
             ESP_LOGI(TAG, "MAX3421E oscillator stabilized");
             break;
@@ -508,27 +548,27 @@ static void max3421e_reset(void) {
     }
     
     // Clear interrupt flags
-    max3421e_write_register(MAX3421E_REG_USBIRQ, 0xFF);
-    max3421e_write_register(MAX3421E_REG_HIRQ, 0xFF);
+    max3421e_write_register(port, MAX3421E_REG_USBIRQ, 0xFF);
+    max3421e_write_register(port, MAX3421E_REG_HIRQ, 0xFF);
 }
 
-static uint8_t max3421e_get_status(void) {
-    return max3421e_read_register(MAX3421E_REG_HRSL);
+static uint8_t max3421e_get_status(max3421e_port_t* port) {
+    return max3421e_read_register(port, MAX3421E_REG_HRSL);
 }
 
-static uint8_t max3421e_get_result(void) {
-    uint8_t hrsl = max3421e_read_register(MAX3421E_REG_HRSL);
+static uint8_t max3421e_get_result(max3421e_port_t* port) {
+    uint8_t hrsl = max3421e_read_register(port, MAX3421E_REG_HRSL);
     return hrsl & MAX3421E_HRSL_RESULT_MASK;
 }
 
-static uint8_t max3421e_get_connection_speed(void) {
-    uint8_t mode = max3421e_read_register(MAX3421E_REG_MODE);
+static uint8_t max3421e_get_connection_speed(max3421e_port_t* port) {
+    uint8_t mode = max3421e_read_register(port, MAX3421E_REG_MODE);
     return (mode & MAX3421E_MODE_SPEED) ? 0 : 1;  // 0 = Low-speed, 1 = Full-speed
 }
 
-static int max3421e_wait_for_interrupt(uint8_t irq_mask, uint16_t timeout_ms) {
+static int max3421e_wait_for_interrupt(max3421e_port_t* port, uint8_t irq_mask, uint16_t timeout_ms) {
     while (timeout_ms > 0) {
-        uint8_t irq = max3421e_read_register(MAX3421E_REG_HIRQ);
+        uint8_t irq = max3421e_read_register(port, MAX3421E_REG_HIRQ);
         if (irq & irq_mask) {
             return 0;  // Success
         }
@@ -538,14 +578,14 @@ static int max3421e_wait_for_interrupt(uint8_t irq_mask, uint16_t timeout_ms) {
     return -1;  // Timeout
 }
 
-static void max3421e_handle_irqs(void) {
+static void max3421e_handle_irqs(max3421e_port_t* port) {
     // Read interrupt flags
-    uint8_t usbirq = max3421e_read_register(MAX3421E_REG_USBIRQ);
-    uint8_t hirq = max3421e_read_register(MAX3421E_REG_HIRQ);
+    uint8_t usbirq = max3421e_read_register(port, MAX3421E_REG_USBIRQ);
+    uint8_t hirq = max3421e_read_register(port, MAX3421E_REG_HIRQ);
     
     // Clear the flags we're handling
-    max3421e_write_register(MAX3421E_REG_USBIRQ, usbirq);
-    max3421e_write_register(MAX3421E_REG_HIRQ, hirq);
+    max3421e_write_register(port, MAX3421E_REG_USBIRQ, usbirq);
+    max3421e_write_register(port, MAX3421E_REG_HIRQ, hirq);
     
     // Handle USB interrupts
     if (usbirq & MAX3421E_USBIRQ_VBUSIRQ) {
@@ -554,7 +594,7 @@ static void max3421e_handle_irqs(void) {
     
     if (usbirq & MAX3421E_USBIRQ_NOVBUSIRQ) {
         ESP_LOGI(TAG, "VBUS removed");
-        device_connected = false;
+        port->device_connected = false;
     }
     
     // Handle host interrupts
@@ -562,42 +602,156 @@ static void max3421e_handle_irqs(void) {
         ESP_LOGI(TAG, "Device connection/disconnection event");
         
         // Check connection status
-        uint8_t jk_state = max3421e_get_status();
+        uint8_t jk_state = max3421e_get_status(port);
         
         if ((jk_state & (MAX3421E_HRSL_JSTATUS | MAX3421E_HRSL_KSTATUS)) == 0) {
             ESP_LOGI(TAG, "Device disconnected");
-            device_connected = false;
+            port->device_connected = false;
         }
     }
 }
 
 #else
 // Stub implementation for non-ESP32 platforms
-void hurricane_hw_init(void) {
+static void max3421e_port_init(max3421e_port_t* port) {
+    (void)port;
     printf("[MAX3421E] Hardware initialization stub\n");
 }
 
-void hurricane_hw_poll(void) {
-    // No-op
+static void max3421e_port_poll(max3421e_port_t* port) {
+    (void)port;
 }
 
-int hurricane_hw_device_connected(void) {
+static int max3421e_port_device_connected(max3421e_port_t* port) {
+    (void)port;
     return 0;
 }
 
-void hurricane_hw_reset_bus(void) {
+static void max3421e_port_reset_bus(max3421e_port_t* port) {
+    (void)port;
     printf("[MAX3421E] Bus reset stub\n");
 }
 
-int hurricane_hw_control_transfer(const hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t length) {
+static int max3421e_port_control_transfer(max3421e_port_t* port, const hurricane_usb_setup_packet_t* setup,
+                                          void* buffer, uint16_t length) {
+    (void)port; (void)setup; (void)buffer; (void)length;
     printf("[MAX3421E] Control transfer stub\n");
     return -1;
 }
 
-int hurricane_hw_interrupt_in_transfer(uint8_t endpoint, void* buffer, uint16_t length) {
+int max3421e_port_set_address(max3421e_port_t* port, uint8_t address) {
+    port->device_address = address;
+    return 0;
+}
+
+static int max3421e_port_interrupt_in_transfer(max3421e_port_t* port, uint8_t endpoint,
+                                               void* buffer, uint16_t length) {
+    (void)port; (void)endpoint; (void)buffer; (void)length;
+    printf("[MAX3421E] Interrupt transfer stub\n");
+    return -1;
+}
+
+static int max3421e_port_interrupt_out_transfer(max3421e_port_t* port, uint8_t endpoint,
+                                                void* buffer, uint16_t length) {
+    (void)port; (void)endpoint; (void)buffer; (void)length;
     printf("[MAX3421E] Interrupt transfer stub\n");
     return -1;
 }
 #endif // PLATFORM_ESP32
 
-#endif // MAX3421E_ENABLED
\ No newline at end of file
+//==============================================================================
+// Per-instance operations
+//==============================================================================
+
+#ifndef HURRICANE_HW_SINGLE_CONTROLLER
+
+static void max3421e_ops_init(void* priv) {
+    max3421e_port_init((max3421e_port_t*)priv);
+}
+
+static void max3421e_ops_poll(void* priv) {
+    max3421e_port_poll((max3421e_port_t*)priv);
+}
+
+static int max3421e_ops_device_connected(void* priv) {
+    return max3421e_port_device_connected((max3421e_port_t*)priv);
+}
+
+static void max3421e_ops_reset_bus(void* priv) {
+    max3421e_port_reset_bus((max3421e_port_t*)priv);
+}
+
+static int max3421e_ops_control_transfer(void* priv, const hurricane_usb_setup_packet_t* setup,
+                                         void* buffer, uint16_t length) {
+    return max3421e_port_control_transfer((max3421e_port_t*)priv, setup, buffer, length);
+}
+
+static int max3421e_ops_interrupt_in_transfer(void* priv, uint8_t endpoint, void* buffer, uint16_t length) {
+    return max3421e_port_interrupt_in_transfer((max3421e_port_t*)priv, endpoint, buffer, length);
+}
+
+static int max3421e_ops_interrupt_out_transfer(void* priv, uint8_t endpoint, void* buffer, uint16_t length) {
+    return max3421e_port_interrupt_out_transfer((max3421e_port_t*)priv, endpoint, buffer, length);
+}
+
+// Host only: the device role entries stay NULL
+const hurricane_hw_ops_t hurricane_hw_max3421e_ops = {
+    .init = max3421e_ops_init,
+    .poll = max3421e_ops_poll,
+    .host_device_connected = max3421e_ops_device_connected,
+    .host_reset_bus = max3421e_ops_reset_bus,
+    .host_control_transfer = max3421e_ops_control_transfer,
+    .host_interrupt_in_transfer = max3421e_ops_interrupt_in_transfer,
+    .host_interrupt_out_transfer = max3421e_ops_interrupt_out_transfer,
+};
+
+#endif // HURRICANE_HW_SINGLE_CONTROLLER
+
+//==============================================================================
+// Link-time HAL on the default port
+//==============================================================================
+
+#ifndef MAX3421E_OPS_ONLY
+
+#ifdef PLATFORM_ESP32
+static max3421e_port_t default_port = MAX3421E_PORT_INIT(SPI2_HOST, GPIO_NUM_23, GPIO_NUM_19, GPIO_NUM_18,
+                                                         GPIO_NUM_5, GPIO_NUM_4, GPIO_NUM_22);
+#else
+static max3421e_port_t default_port;
+#endif
+
+void hurricane_hw_init(void) {
+    max3421e_port_init(&default_port);
+}
+
+void hurricane_hw_poll(void) {
+    max3421e_port_poll(&default_port);
+}
+
+int hurricane_hw_device_connected(void) {
+    return max3421e_port_device_connected(&default_port);
+}
+
+void hurricane_hw_reset_bus(void) {
+    max3421e_port_reset_bus(&default_port);
+}
+
+int hurricane_hw_control_transfer(const hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t length) {
+    return max3421e_port_control_transfer(&default_port, setup, buffer, length);
+}
+
+int hurricane_hw_set_address(uint8_t address) {
+    return max3421e_port_set_address(&default_port, address);
+}
+
+int hurricane_hw_interrupt_in_transfer(uint8_t endpoint, void* buffer, uint16_t length) {
+    return max3421e_port_interrupt_in_transfer(&default_port, endpoint, buffer, length);
+}
+
+int hurricane_hw_interrupt_out_transfer(uint8_t endpoint, void* buffer, uint16_t length) {
+    return max3421e_port_interrupt_out_transfer(&default_port, endpoint, buffer, length);
+}
+
+#endif // MAX3421E_OPS_ONLY
+
+#endif // MAX3421E_ENABLED
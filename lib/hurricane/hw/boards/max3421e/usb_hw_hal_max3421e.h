@@ -0,0 +1,70 @@
+/**
+ * @file usb_hw_hal_max3421e.h
+ * @brief MAX3421E host controller ports
+ *
+ * Each MAX3421E chip is described by a max3421e_port_t holding its pin
+ * assignment and runtime state, so several chips can be driven side by side
+ * (and next to an on-chip controller) through the per-instance HAL registry:
+ *
+ *   static max3421e_port_t port_b = MAX3421E_PORT_INIT(SPI2_HOST, 23, 19, 18, 15, 16, 17);
+ *   hurricane_hw_register_controller(1, "MAX3421E-B", &hurricane_hw_max3421e_ops, &port_b);
+ *
+ * Unless MAX3421E_OPS_ONLY is defined, the link-time host HAL functions are
+ * also provided and drive a default port on the legacy pin assignment.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hw/hurricane_hw_ops.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One MAX3421E chip
+ */
+typedef struct {
+    // Configuration
+    int spi_host;               /**< SPI peripheral the chip is attached to */
+    int mosi_pin;
+    int miso_pin;
+    int clk_pin;
+    int cs_pin;
+    int int_pin;
+    int rst_pin;
+
+    // Runtime state
+    void* spi_handle;           /**< Platform SPI device handle */
+    bool device_connected;
+    uint8_t device_address;
+    bool in_toggle;             /**< Data toggle for interrupt IN */
+    bool out_toggle;            /**< Data toggle for interrupt OUT */
+} max3421e_port_t;
+
+/**
+ * @brief Static initializer for a port
+ */
+#define MAX3421E_PORT_INIT(host, mosi, miso, clk, cs, irq, rst) \
+    { .spi_host = (host), .mosi_pin = (mosi), .miso_pin = (miso), .clk_pin = (clk), \
+      .cs_pin = (cs), .int_pin = (irq), .rst_pin = (rst) }
+
+/**
+ * @brief Set the address used for transfers after SET_ADDRESS
+ *
+ * @param port Port
+ * @param address Device address
+ * @return 0 on success
+ */
+int max3421e_port_set_address(max3421e_port_t* port, uint8_t address);
+
+/**
+ * @brief Host-only operations; priv is a max3421e_port_t*
+ */
+extern const hurricane_hw_ops_t hurricane_hw_max3421e_ops;
+
+#ifdef __cplusplus
+}
+#endif
@@ -24,6 +24,7 @@
 
 // Include our dynamic interface manager
 #include "core/usb_interface_manager.h"
+#include "core/usb_ep0_proxy.h"
 
 //==============================================================================
 // Private definitions and variables
@@ -652,14 +653,6 @@ static usb_status_t USB_DeviceSetupPacketHandler(usb_device_handle handle,
     hurricane_setup.wIndex = setup->wIndex;
     hurricane_setup.wLength = setup->wLength;
     
-    // For class-specific requests, determine the interface and forward to the interface manager
-    if ((setup->bmRequestType & USB_REQUEST_TYPE_TYPE_MASK) == USB_REQUEST_TYPE_CLASS) {
-        uint8_t interface_num = setup->wIndex & 0xFF;
-        
-        // Notify the interface manager of the control request
-        hurricane_interface_notify_event(USB_EVENT_CONTROL_REQUEST, interface_num, &hurricane_setup);
-    }
-    
     // We'll need to handle standard requests internally
     // but for class and vendor requests, we can forward to the interface manager
     
@@ -671,7 +664,19 @@ static usb_status_t USB_DeviceSetupPacketHandler(usb_device_handle handle,
         
         switch (setup->bRequest) {
             case USB_REQUEST_STANDARD_GET_DESCRIPTOR:
-                // Most descriptor requests are handled by the callbacks above
+                // Device, configuration and report descriptors are handled by the
+                // callbacks above; strings come from the physical device
+                if ((setup->wValue >> 8) == USB_DESCRIPTOR_TYPE_STRING) {
+                    if (hurricane_ep0_proxy_setup(&hurricane_setup,
+                                                  buffer ? *buffer : NULL,
+                                                  length ? (uint16_t)*length : 0) == HURRICANE_EP0_PROXY_NOT_HANDLED) {
+                        // Nobody answers: stall instead of leaving the PC to time out
+                        return kStatus_USB_InvalidRequest;
+                    }
+                    // Answered from the cache or EP0 left unprimed (NAK) until
+                    // the proxy completes the data stage
+                    return kStatus_USB_Success;
+                }
                 break;
                 
             case USB_REQUEST_STANDARD_SET_ADDRESS:
@@ -695,9 +700,20 @@ static usb_status_t USB_DeviceSetupPacketHandler(usb_device_handle handle,
         interface_num = setup->wIndex & 0xFF;
     }
     
-    // Create a notification event
-    // In a complete implementation, this would wait for a response
-    hurricane_interface_notify_event(USB_EVENT_CONTROL_REQUEST, interface_num, &hurricane_setup);
+    // The interface's handler answers, or defers and leaves EP0 unprimed
+    // (NAK) until it completes the request from the main loop
+    if (hurricane_interface_control_setup(interface_num, &hurricane_setup, NULL) != INTERFACE_CONTROL_NOT_HANDLED) {
+        return kStatus_USB_Success;
+    }
+    
+    // Let the physical device answer. EP0 is not primed here, so the controller
+    // NAKs the PC until the proxy completes the request from the main loop.
+    if (hurricane_ep0_proxy_setup(&hurricane_setup,
+                                  buffer ? *buffer : NULL,
+                                  length ? (uint16_t)*length : 0) == HURRICANE_EP0_PROXY_NOT_HANDLED) {
+        // Proxy disabled or request not forwardable: the stack stalls EP0
+        return kStatus_USB_InvalidRequest;
+    }
     
     return kStatus_USB_Success;
 }
\ No newline at end of file
@@ -285,6 +285,61 @@ int hurricane_hw_host_interrupt_in_transfer(
     return transfer->transferSofar;
 }
 
+int hurricane_hw_host_interrupt_out_transfer(
+    uint8_t endpoint,
+    void* buffer,
+    uint16_t length)
+{
+    if (!host_initialized || !device_connected || !device_enumerated) {
+        printf("[RT1060-Host] Host not initialized or device not connected\n");
+        return -1;
+    }
+    
+    // Make sure this is an OUT endpoint
+    if (endpoint & 0x80) {
+        printf("[RT1060-Host] Invalid OUT endpoint 0x%02x\n", endpoint);
+        return -1;
+    }
+    
+    if (length > TRANSFER_BUFFER_SIZE) {
+        printf("[RT1060-Host] Interrupt OUT transfer too long (%u bytes)\n", length);
+        return -1;
+    }
+    
+    usb_host_transfer_t* transfer;
+    
+    // Allocate transfer
+    if (USB_HostMallocTransfer(host_handle, &transfer) != kStatus_USB_Success) {
+        printf("[RT1060-Host] Failed to allocate transfer\n");
+        return -1;
+    }
+    
+    // The controller reads from the buffer after we return, so send a copy
+    memcpy(transfer_buffer, buffer, length);
+    transfer->transferBuffer = transfer_buffer;
+    transfer->transferLength = length;
+    transfer->callbackFn = USB_HostHidCallback;
+    transfer->callbackParam = NULL;
+    
+    usb_status_t status = USB_HostSendSetup(
+        host_handle,
+        device_address,
+        endpoint & 0x0F,  // Endpoint number
+        USB_ENDPOINT_INTERRUPT,
+        USB_OUT,
+        length,
+        transfer
+    );
+    
+    if (status != kStatus_USB_Success) {
+        USB_HostFreeTransfer(host_handle, transfer);
+        printf("[RT1060-Host] Failed to send interrupt OUT request: %d\n", status);
+        return -1;
+    }
+    
+    return length;
+}
+
 //==============================================================================
 // Backward compatibility functions
 //==============================================================================
@@ -0,0 +1,131 @@
+/**
+ * @file usb_hw_ops_rt1060.c
+ * @brief RT1060 controller operations for the per-instance HAL registry
+ *
+ * Thin adapters from the ops table signatures to the link-time HAL functions
+ * in usb_hw_hal_host_rt1060.c and usb_hw_hal_device_rt1060.c.
+ */
+
+#include "usb_hw_ops_rt1060.h"
+
+#ifndef HURRICANE_HW_SINGLE_CONTROLLER
+
+static void rt1060_init(void* priv)
+{
+    (void)priv;
+    hurricane_hw_init();
+}
+
+static void rt1060_poll(void* priv)
+{
+    (void)priv;
+    hurricane_hw_poll();
+}
+
+static int rt1060_host_device_connected(void* priv)
+{
+    (void)priv;
+    return hurricane_hw_host_device_connected();
+}
+
+static void rt1060_host_reset_bus(void* priv)
+{
+    (void)priv;
+    hurricane_hw_host_reset_bus();
+}
+
+static int rt1060_host_control_transfer(void* priv, const hurricane_usb_setup_packet_t* setup,
+                                        void* buffer, uint16_t length)
+{
+    (void)priv;
+    return hurricane_hw_host_control_transfer(setup, buffer, length);
+}
+
+static int rt1060_host_interrupt_in_transfer(void* priv, uint8_t endpoint, void* buffer, uint16_t length)
+{
+    (void)priv;
+    return hurricane_hw_host_interrupt_in_transfer(endpoint, buffer, length);
+}
+
+static int rt1060_host_interrupt_out_transfer(void* priv, uint8_t endpoint, void* buffer, uint16_t length)
+{
+    (void)priv;
+    return hurricane_hw_host_interrupt_out_transfer(endpoint, buffer, length);
+}
+
+static void rt1060_device_reset(void* priv)
+{
+    (void)priv;
+    hurricane_hw_device_reset();
+}
+
+static int rt1060_device_control_response(void* priv, const hurricane_usb_setup_packet_t* setup,
+                                          void* buffer, uint16_t length)
+{
+    (void)priv;
+    return hurricane_hw_device_control_response(setup, buffer, length);
+}
+
+static int rt1060_device_interrupt_in_transfer(void* priv, uint8_t endpoint, void* buffer, uint16_t length)
+{
+    (void)priv;
+    return hurricane_hw_device_interrupt_in_transfer(endpoint, buffer, length);
+}
+
+static int rt1060_device_configure_interface(void* priv, uint8_t interface_num, uint8_t interface_class,
+                                             uint8_t interface_subclass, uint8_t interface_protocol)
+{
+    (void)priv;
+    return hurricane_hw_device_configure_interface(interface_num, interface_class,
+                                                   interface_subclass, interface_protocol);
+}
+
+static int rt1060_device_configure_endpoint(void* priv, uint8_t interface_num, uint8_t ep_address,
+                                            uint8_t ep_attributes, uint16_t ep_max_packet_size,
+                                            uint8_t ep_interval)
+{
+    (void)priv;
+    return hurricane_hw_device_configure_endpoint(interface_num, ep_address, ep_attributes,
+                                                  ep_max_packet_size, ep_interval);
+}
+
+static int rt1060_device_set_descriptors(void* priv, const uint8_t* device_desc, uint16_t device_desc_length,
+                                         const uint8_t* config_desc, uint16_t config_desc_length)
+{
+    (void)priv;
+    return hurricane_hw_device_set_descriptors(device_desc, device_desc_length,
+                                               config_desc, config_desc_length);
+}
+
+static int rt1060_device_set_hid_report_descriptor(void* priv, const uint8_t* report_desc,
+                                                   uint16_t report_desc_length)
+{
+    (void)priv;
+    return hurricane_hw_device_set_hid_report_descriptor(report_desc, report_desc_length);
+}
+
+static int rt1060_device_endpoint_stall(void* priv, uint8_t ep_address, bool stall)
+{
+    (void)priv;
+    return hurricane_hw_device_endpoint_stall(ep_address, stall);
+}
+
+const hurricane_hw_ops_t hurricane_hw_rt1060_ops = {
+    .init = rt1060_init,
+    .poll = rt1060_poll,
+    .host_device_connected = rt1060_host_device_connected,
+    .host_reset_bus = rt1060_host_reset_bus,
+    .host_control_transfer = rt1060_host_control_transfer,
+    .host_interrupt_in_transfer = rt1060_host_interrupt_in_transfer,
+    .host_interrupt_out_transfer = rt1060_host_interrupt_out_transfer,
+    .device_reset = rt1060_device_reset,
+    .device_control_response = rt1060_device_control_response,
+    .device_interrupt_in_transfer = rt1060_device_interrupt_in_transfer,
+    .device_configure_interface = rt1060_device_configure_interface,
+    .device_configure_endpoint = rt1060_device_configure_endpoint,
+    .device_set_descriptors = rt1060_device_set_descriptors,
+    .device_set_hid_report_descriptor = rt1060_device_set_hid_report_descriptor,
+    .device_endpoint_stall = rt1060_device_endpoint_stall,
+};
+
+#endif // HURRICANE_HW_SINGLE_CONTROLLER
@@ -0,0 +1,27 @@
+/**
+ * @file usb_hw_ops_rt1060.h
+ * @brief RT1060 controller operations for the per-instance HAL registry
+ */
+
+#pragma once
+
+#include "hw/hurricane_hw_ops.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Operations for the on-chip USB1 (host) / USB2 (device) pair
+ *
+ * The RT1060 HAL keeps its state in file-scope variables, so priv is unused
+ * and there is exactly one instance of this table. Register it when another
+ * controller (e.g. a MAX3421E) has to live next to it:
+ *
+ *   hurricane_hw_register_controller(0, "RT1060", &hurricane_hw_rt1060_ops, NULL);
+ */
+extern const hurricane_hw_ops_t hurricane_hw_rt1060_ops;
+
+#ifdef __cplusplus
+}
+#endif
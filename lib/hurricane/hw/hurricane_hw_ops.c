@@ -0,0 +1,219 @@
+// File: lib/hurricane/hw/hurricane_hw_ops.c
+/*
+ * @brief Controller instance registry and per-instance HAL dispatch
+ */
+
+#include "hurricane_hw_ops.h"
+#include <stddef.h>
+#include <stdio.h>
+
+#ifndef HURRICANE_HW_SINGLE_CONTROLLER
+
+#define HW_ERROR_NO_CONTROLLER  -1
+#define HW_ERROR_UNSUPPORTED    -2
+
+static hurricane_hw_controller_t controllers[HURRICANE_HW_MAX_CONTROLLERS];
+
+static const hurricane_hw_controller_t* lookup(uint8_t instance)
+{
+    if (instance < HURRICANE_HW_MAX_CONTROLLERS && controllers[instance].ops) {
+        return &controllers[instance];
+    }
+    return NULL;
+}
+
+/*
+ * Dispatch to a registered controller, or to the link-time HAL for an
+ * unregistered primary instance.
+ */
+#define HW_DISPATCH(instance, op, link_call, ...)                           \
+    do {                                                                    \
+        const hurricane_hw_controller_t* c = lookup(instance);              \
+        if (c) {                                                            \
+            if (!c->ops->op) {                                              \
+                return HW_ERROR_UNSUPPORTED;                                \
+            }                                                               \
+            return c->ops->op(c->priv, __VA_ARGS__);                        \
+        }                                                                   \
+        if ((instance) == HURRICANE_HW_PRIMARY_CONTROLLER) {                \
+            return link_call;                                               \
+        }                                                                   \
+        return HW_ERROR_NO_CONTROLLER;                                      \
+    } while (0)
+
+#define HW_DISPATCH_VOID(instance, op, link_call)                           \
+    do {                                                                    \
+        const hurricane_hw_controller_t* c = lookup(instance);              \
+        if (c) {                                                            \
+            if (c->ops->op) {                                               \
+                c->ops->op(c->priv);                                        \
+            }                                                               \
+        } else if ((instance) == HURRICANE_HW_PRIMARY_CONTROLLER) {         \
+            link_call;                                                      \
+        }                                                                   \
+    } while (0)
+
+int hurricane_hw_register_controller(uint8_t instance, const char* name,
+                                     const hurricane_hw_ops_t* ops, void* priv)
+{
+    if (instance >= HURRICANE_HW_MAX_CONTROLLERS || !ops) {
+        printf("[HW] Error: invalid controller registration (instance %u)\n", instance);
+        return -1;
+    }
+    if (controllers[instance].ops) {
+        printf("[HW] Error: controller instance %u already registered\n", instance);
+        return -2;
+    }
+
+    controllers[instance].name = name ? name : "controller";
+    controllers[instance].ops = ops;
+    controllers[instance].priv = priv;
+    printf("[HW] Registered %s as controller %u\n", controllers[instance].name, instance);
+    return 0;
+}
+
+int hurricane_hw_unregister_controller(uint8_t instance)
+{
+    if (!lookup(instance)) {
+        return -1;
+    }
+    controllers[instance].name = NULL;
+    controllers[instance].ops = NULL;
+    controllers[instance].priv = NULL;
+    return 0;
+}
+
+const hurricane_hw_controller_t* hurricane_hw_get_controller(uint8_t instance)
+{
+    return lookup(instance);
+}
+
+void hurricane_hw_controllers_init(void)
+{
+    for (uint8_t i = 0; i < HURRICANE_HW_MAX_CONTROLLERS; i++) {
+        if (controllers[i].ops && controllers[i].ops->init) {
+            controllers[i].ops->init(controllers[i].priv);
+        }
+    }
+}
+
+void hurricane_hw_controllers_poll(void)
+{
+    for (uint8_t i = 0; i < HURRICANE_HW_MAX_CONTROLLERS; i++) {
+        HW_DISPATCH_VOID(i, poll, hurricane_hw_poll());
+    }
+}
+
+//=============================================================================
+// Host role
+//=============================================================================
+
+int hurricane_hw_host_device_connected_on(uint8_t instance)
+{
+    const hurricane_hw_controller_t* c = lookup(instance);
+    if (c) {
+        return c->ops->host_device_connected ? c->ops->host_device_connected(c->priv) : 0;
+    }
+    return instance == HURRICANE_HW_PRIMARY_CONTROLLER ? hurricane_hw_host_device_connected() : 0;
+}
+
+void hurricane_hw_host_reset_bus_on(uint8_t instance)
+{
+    HW_DISPATCH_VOID(instance, host_reset_bus, hurricane_hw_host_reset_bus());
+}
+
+int hurricane_hw_host_control_transfer_on(uint8_t instance, const hurricane_usb_setup_packet_t* setup,
+                                          void* buffer, uint16_t length)
+{
+    HW_DISPATCH(instance, host_control_transfer,
+                hurricane_hw_host_control_transfer(setup, buffer, length),
+                setup, buffer, length);
+}
+
+int hurricane_hw_host_interrupt_in_transfer_on(uint8_t instance, uint8_t endpoint,
+                                               void* buffer, uint16_t length)
+{
+    HW_DISPATCH(instance, host_interrupt_in_transfer,
+                hurricane_hw_host_interrupt_in_transfer(endpoint, buffer, length),
+                endpoint, buffer, length);
+}
+
+int hurricane_hw_host_interrupt_out_transfer_on(uint8_t instance, uint8_t endpoint,
+                                                void* buffer, uint16_t length)
+{
+    HW_DISPATCH(instance, host_interrupt_out_transfer,
+                hurricane_hw_host_interrupt_out_transfer(endpoint, buffer, length),
+                endpoint, buffer, length);
+}
+
+//=============================================================================
+// Device role
+//=============================================================================
+
+void hurricane_hw_device_reset_on(uint8_t instance)
+{
+    HW_DISPATCH_VOID(instance, device_reset, hurricane_hw_device_reset());
+}
+
+int hurricane_hw_device_control_response_on(uint8_t instance, const hurricane_usb_setup_packet_t* setup,
+                                            void* buffer, uint16_t length)
+{
+    HW_DISPATCH(instance, device_control_response,
+                hurricane_hw_device_control_response(setup, buffer, length),
+                setup, buffer, length);
+}
+
+int hurricane_hw_device_interrupt_in_transfer_on(uint8_t instance, uint8_t endpoint,
+                                                 void* buffer, uint16_t length)
+{
+    HW_DISPATCH(instance, device_interrupt_in_transfer,
+                hurricane_hw_device_interrupt_in_transfer(endpoint, buffer, length),
+                endpoint, buffer, length);
+}
+
+int hurricane_hw_device_configure_interface_on(uint8_t instance, uint8_t interface_num,
+                                               uint8_t interface_class, uint8_t interface_subclass,
+                                               uint8_t interface_protocol)
+{
+    HW_DISPATCH(instance, device_configure_interface,
+                hurricane_hw_device_configure_interface(interface_num, interface_class,
+                                                        interface_subclass, interface_protocol),
+                interface_num, interface_class, interface_subclass, interface_protocol);
+}
+
+int hurricane_hw_device_configure_endpoint_on(uint8_t instance, uint8_t interface_num,
+                                              uint8_t ep_address, uint8_t ep_attributes,
+                                              uint16_t ep_max_packet_size, uint8_t ep_interval)
+{
+    HW_DISPATCH(instance, device_configure_endpoint,
+                hurricane_hw_device_configure_endpoint(interface_num, ep_address, ep_attributes,
+                                                       ep_max_packet_size, ep_interval),
+                interface_num, ep_address, ep_attributes, ep_max_packet_size, ep_interval);
+}
+
+int hurricane_hw_device_set_descriptors_on(uint8_t instance, const uint8_t* device_desc,
+                                           uint16_t device_desc_length, const uint8_t* config_desc,
+                                           uint16_t config_desc_length)
+{
+    HW_DISPATCH(instance, device_set_descriptors,
+                hurricane_hw_device_set_descriptors(device_desc, device_desc_length,
+                                                    config_desc, config_desc_length),
+                device_desc, device_desc_length, config_desc, config_desc_length);
+}
+
+int hurricane_hw_device_set_hid_report_descriptor_on(uint8_t instance, const uint8_t* report_desc,
+                                                     uint16_t report_desc_length)
+{
+    HW_DISPATCH(instance, device_set_hid_report_descriptor,
+                hurricane_hw_device_set_hid_report_descriptor(report_desc, report_desc_length),
+                report_desc, report_desc_length);
+}
+
+int hurricane_hw_device_endpoint_stall_on(uint8_t instance, uint8_t ep_address, bool stall)
+{
+    HW_DISPATCH(instance, device_endpoint_stall,
+                hurricane_hw_device_endpoint_stall(ep_address, stall),
+                ep_address, stall);
+}
+
+#endif // HURRICANE_HW_SINGLE_CONTROLLER
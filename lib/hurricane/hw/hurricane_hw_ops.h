@@ -0,0 +1,218 @@
+// File: lib/hurricane/hw/hurricane_hw_ops.h
+#pragma once
+
+/**
+ * @file hurricane_hw_ops.h
+ * @brief Per-instance controller operations (multiple host/device controllers)
+ *
+ * The functions in hurricane_hw_hal.h are resolved at link time, so they can
+ * only describe one host and one device controller. A board that drives more
+ * (e.g. the RT1060 EHCI ports plus one or more MAX3421E chips) registers a
+ * hurricane_hw_ops_t per controller instance, each with its own private state
+ * pointer, and the core addresses controllers through the *_on(instance, ...)
+ * calls below.
+ *
+ * Instance 0 is the primary controller. While nothing is registered there,
+ * it maps to the link-time HAL, so existing single-board builds keep working
+ * unchanged.
+ *
+ * Define HURRICANE_HW_SINGLE_CONTROLLER for builds with exactly one host and
+ * one device controller: the *_on() calls then compile straight to the
+ * link-time HAL functions and the registry is not used at all.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hurricane_hw_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of registered controller instances
+ */
+#ifndef HURRICANE_HW_MAX_CONTROLLERS
+#define HURRICANE_HW_MAX_CONTROLLERS 4
+#endif
+
+/**
+ * @brief Primary controller instance (the link-time HAL)
+ */
+#define HURRICANE_HW_PRIMARY_CONTROLLER 0
+
+/**
+ * @brief Controller operations
+ *
+ * Every entry receives the priv pointer given at registration. Entries may be
+ * NULL when the controller does not support the role (e.g. device operations
+ * on a host-only MAX3421E); calls then fail with a negative error code.
+ */
+typedef struct {
+    // Common
+    void (*init)(void* priv);
+    void (*poll)(void* priv);
+
+    // Host role
+    int (*host_device_connected)(void* priv);
+    void (*host_reset_bus)(void* priv);
+    int (*host_control_transfer)(void* priv, const hurricane_usb_setup_packet_t* setup,
+                                 void* buffer, uint16_t length);
+    int (*host_interrupt_in_transfer)(void* priv, uint8_t endpoint, void* buffer, uint16_t length);
+    int (*host_interrupt_out_transfer)(void* priv, uint8_t endpoint, void* buffer, uint16_t length);
+
+    // Device role
+    void (*device_reset)(void* priv);
+    int (*device_control_response)(void* priv, const hurricane_usb_setup_packet_t* setup,
+                                   void* buffer, uint16_t length);
+    int (*device_interrupt_in_transfer)(void* priv, uint8_t endpoint, void* buffer, uint16_t length);
+    int (*device_configure_interface)(void* priv, uint8_t interface_num, uint8_t interface_class,
+                                      uint8_t interface_subclass, uint8_t interface_protocol);
+    int (*device_configure_endpoint)(void* priv, uint8_t interface_num, uint8_t ep_address,
+                                     uint8_t ep_attributes, uint16_t ep_max_packet_size,
+                                     uint8_t ep_interval);
+    int (*device_set_descriptors)(void* priv, const uint8_t* device_desc, uint16_t device_desc_length,
+                                  const uint8_t* config_desc, uint16_t config_desc_length);
+    int (*device_set_hid_report_descriptor)(void* priv, const uint8_t* report_desc,
+                                            uint16_t report_desc_length);
+    int (*device_endpoint_stall)(void* priv, uint8_t ep_address, bool stall);
+} hurricane_hw_ops_t;
+
+/**
+ * @brief A registered controller instance
+ */
+typedef struct {
+    const char* name;               /**< For logging */
+    const hurricane_hw_ops_t* ops;  /**< Operations, NULL if the slot is free */
+    void* priv;                     /**< Controller state passed to every op */
+} hurricane_hw_controller_t;
+
+#ifdef HURRICANE_HW_SINGLE_CONTROLLER
+
+// No registry: registering always fails, lookups never find anything
+static inline int hurricane_hw_register_controller(uint8_t instance, const char* name,
+                                                   const hurricane_hw_ops_t* ops, void* priv)
+{
+    (void)instance;
+    (void)name;
+    (void)ops;
+    (void)priv;
+    return -1;
+}
+
+static inline int hurricane_hw_unregister_controller(uint8_t instance)
+{
+    (void)instance;
+    return 0;
+}
+
+static inline const hurricane_hw_controller_t* hurricane_hw_get_controller(uint8_t instance)
+{
+    (void)instance;
+    return (const hurricane_hw_controller_t*)0;
+}
+
+#define hurricane_hw_controllers_init() ((void)0)
+#define hurricane_hw_controllers_poll() hurricane_hw_poll()
+
+#define hurricane_hw_host_device_connected_on(i) \
+    ((void)(i), hurricane_hw_host_device_connected())
+#define hurricane_hw_host_reset_bus_on(i) \
+    ((void)(i), hurricane_hw_host_reset_bus())
+#define hurricane_hw_host_control_transfer_on(i, setup, buffer, length) \
+    ((void)(i), hurricane_hw_host_control_transfer(setup, buffer, length))
+#define hurricane_hw_host_interrupt_in_transfer_on(i, endpoint, buffer, length) \
+    ((void)(i), hurricane_hw_host_interrupt_in_transfer(endpoint, buffer, length))
+#define hurricane_hw_host_interrupt_out_transfer_on(i, endpoint, buffer, length) \
+    ((void)(i), hurricane_hw_host_interrupt_out_transfer(endpoint, buffer, length))
+#define hurricane_hw_device_reset_on(i) \
+    ((void)(i), hurricane_hw_device_reset())
+#define hurricane_hw_device_control_response_on(i, setup, buffer, length) \
+    ((void)(i), hurricane_hw_device_control_response(setup, buffer, length))
+#define hurricane_hw_device_interrupt_in_transfer_on(i, endpoint, buffer, length) \
+    ((void)(i), hurricane_hw_device_interrupt_in_transfer(endpoint, buffer, length))
+#define hurricane_hw_device_configure_interface_on(i, num, cls, sub, proto) \
+    ((void)(i), hurricane_hw_device_configure_interface(num, cls, sub, proto))
+#define hurricane_hw_device_configure_endpoint_on(i, num, ep, attr, mps, interval) \
+    ((void)(i), hurricane_hw_device_configure_endpoint(num, ep, attr, mps, interval))
+#define hurricane_hw_device_set_descriptors_on(i, dev, dev_len, cfg, cfg_len) \
+    ((void)(i), hurricane_hw_device_set_descriptors(dev, dev_len, cfg, cfg_len))
+#define hurricane_hw_device_set_hid_report_descriptor_on(i, desc, len) \
+    ((void)(i), hurricane_hw_device_set_hid_report_descriptor(desc, len))
+#define hurricane_hw_device_endpoint_stall_on(i, ep, stall) \
+    ((void)(i), hurricane_hw_device_endpoint_stall(ep, stall))
+
+#else
+
+/**
+ * @brief Register a controller instance
+ *
+ * @param instance Instance number (0 replaces the link-time primary HAL)
+ * @param name Name used in log output
+ * @param ops Operations table (must stay valid while registered)
+ * @param priv Controller state passed to every operation
+ * @return 0 on success, negative error code on failure
+ */
+int hurricane_hw_register_controller(uint8_t instance, const char* name,
+                                     const hurricane_hw_ops_t* ops, void* priv);
+
+/**
+ * @brief Remove a controller instance
+ *
+ * @param instance Instance number
+ * @return 0 on success, negative error code if the instance is not registered
+ */
+int hurricane_hw_unregister_controller(uint8_t instance);
+
+/**
+ * @brief Look up a registered controller
+ *
+ * @param instance Instance number
+ * @return Controller, or NULL if the instance is not registered
+ */
+const hurricane_hw_controller_t* hurricane_hw_get_controller(uint8_t instance);
+
+/**
+ * @brief Run init on every registered controller
+ */
+void hurricane_hw_controllers_init(void);
+
+/**
+ * @brief Run poll once on every controller instance
+ *
+ * Registered instances run their poll operation; an unregistered primary
+ * instance polls the link-time HAL (hurricane_hw_poll()).
+ */
+void hurricane_hw_controllers_poll(void);
+
+int hurricane_hw_host_device_connected_on(uint8_t instance);
+void hurricane_hw_host_reset_bus_on(uint8_t instance);
+int hurricane_hw_host_control_transfer_on(uint8_t instance, const hurricane_usb_setup_packet_t* setup,
+                                          void* buffer, uint16_t length);
+int hurricane_hw_host_interrupt_in_transfer_on(uint8_t instance, uint8_t endpoint,
+                                               void* buffer, uint16_t length);
+int hurricane_hw_host_interrupt_out_transfer_on(uint8_t instance, uint8_t endpoint,
+                                                void* buffer, uint16_t length);
+void hurricane_hw_device_reset_on(uint8_t instance);
+int hurricane_hw_device_control_response_on(uint8_t instance, const hurricane_usb_setup_packet_t* setup,
+                                            void* buffer, uint16_t length);
+int hurricane_hw_device_interrupt_in_transfer_on(uint8_t instance, uint8_t endpoint,
+                                                 void* buffer, uint16_t length);
+int hurricane_hw_device_configure_interface_on(uint8_t instance, uint8_t interface_num,
+                                               uint8_t interface_class, uint8_t interface_subclass,
+                                               uint8_t interface_protocol);
+int hurricane_hw_device_configure_endpoint_on(uint8_t instance, uint8_t interface_num,
+                                              uint8_t ep_address, uint8_t ep_attributes,
+                                              uint16_t ep_max_packet_size, uint8_t ep_interval);
+int hurricane_hw_device_set_descriptors_on(uint8_t instance, const uint8_t* device_desc,
+                                           uint16_t device_desc_length, const uint8_t* config_desc,
+                                           uint16_t config_desc_length);
+int hurricane_hw_device_set_hid_report_descriptor_on(uint8_t instance, const uint8_t* report_desc,
+                                                     uint16_t report_desc_length);
+int hurricane_hw_device_endpoint_stall_on(uint8_t instance, uint8_t ep_address, bool stall);
+
+#endif // HURRICANE_HW_SINGLE_CONTROLLER
+
+#ifdef __cplusplus
+}
+#endif
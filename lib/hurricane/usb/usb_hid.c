@@ -1,75 +1,218 @@
 #include "usb_hid.h"
+#include "core/hurricane_context.h"
+#include "core/hurricane_cycles.h"
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
-// HID mouse report format (based on standard boot protocol)
+#define HID_USAGE_PAGE_GENERIC_DESKTOP  0x01
+#define HID_USAGE_PAGE_BUTTON           0x09
+#define HID_USAGE_MOUSE                 0x02
+#define HID_USAGE_X                     0x30
+#define HID_USAGE_Y                     0x31
+#define HID_USAGE_WHEEL                 0x38
+
+// Decoded mouse state; wide enough for high resolution (16-bit) mice
 typedef struct {
     uint8_t buttons;  // Bit 0: Left, Bit 1: Right, Bit 2: Middle
-    int8_t x;         // Relative X movement
-    int8_t y;         // Relative Y movement
-    int8_t wheel;     // Vertical wheel
+    int32_t x;        // Relative X movement
+    int32_t y;        // Relative Y movement
+    int32_t wheel;    // Vertical wheel
 } mouse_report_t;
 
-void hurricane_hid_init(hurricane_device_t* dev) {
-    dev->hid_device->report_id = 0;
-    dev->hid_device->protocol = 1; // Default to boot protocol
-    dev->hid_device->idle_rate = 0;
-    dev->hid_device->report_descriptor_length = 0;
+void hurricane_hid_setup_begin(hurricane_hid_setup_t* setup, hurricane_device_t* dev) {
+    memset(setup, 0, sizeof(*setup));
+    HURRICANE_PT_INIT(&setup->pt);
+    setup->dev = dev;
+    setup->request.controller = dev->controller;
+}
+
+HURRICANE_PT_THREAD(hurricane_hid_setup_thread(hurricane_hid_setup_t* setup)) {
+    hurricane_hid_device_t* hid = setup->dev->hid_device;
+    hurricane_context_t* ctx = hurricane_device_context(setup->dev);
+
+    HURRICANE_PT_BEGIN(&setup->pt);
+
+    hid->report_id = 0;
+    hid->protocol = HURRICANE_HID_PROTOCOL_REPORT; // Devices start in report protocol
+    hid->idle_rate = 0;
+    hid->report_descriptor_length = 0;
 
     // Set the HID idle rate
-    hurricane_usb_setup_packet_t setup = {
-        .bmRequestType = USB_REQ_TYPE_CLASS | USB_REQ_RECIPIENT_INTERFACE,
-        .bRequest = 0x0A, // SET_IDLE
-        .wValue = (dev->hid_device->idle_rate << 8),
-        .wIndex = dev->hid_device->interface_number, // should track correct iface
-        .wLength = 0,
-    };
-    hurricane_hw_control_transfer(&setup, NULL, 0);
+    hurricane_host_control_prepare(&setup->request,
+                                   USB_REQ_TYPE_CLASS | USB_REQ_RECIPIENT_INTERFACE,
+                                   0x0A, // SET_IDLE
+                                   (hid->idle_rate << 8),
+                                   hid->interface_number, // should track correct iface
+                                   NULL, 0);
+    HURRICANE_PT_CONTROL_TRANSFER_CTX(&setup->pt, ctx, &setup->request);
+    if (setup->request.status != HURRICANE_CONTROL_DONE) {
+        printf("[HID] SET_IDLE failed on interface %u (not fatal)\n", hid->interface_number);
+    }
+
+    // Boot protocol when every attached rule fits the boot report of the interface
+    hid->protocol_policy = hurricane_hid_boot_policy(hid->boot_interface, hid->rules, hid->num_rules);
+    if (hid->boot_interface && hid->rules && hid->protocol_policy == HURRICANE_HID_POLICY_REPORT) {
+        printf("[HID] Interface %u stays in report protocol: a rule needs fields boot reports lack\n",
+               hid->interface_number);
+    }
+    if (hid->protocol_policy == HURRICANE_HID_POLICY_BOOT) {
+        hurricane_host_control_prepare(&setup->request,
+                                       USB_REQ_TYPE_CLASS | USB_REQ_RECIPIENT_INTERFACE,
+                                       0x0B, // SET_PROTOCOL
+                                       HURRICANE_HID_PROTOCOL_BOOT,
+                                       hid->interface_number,
+                                       NULL, 0);
+        HURRICANE_PT_CONTROL_TRANSFER_CTX(&setup->pt, ctx, &setup->request);
+        if (setup->request.status == HURRICANE_CONTROL_DONE) {
+            hid->protocol = HURRICANE_HID_PROTOCOL_BOOT;
+            printf("[HID] Interface %u switched to boot protocol\n", hid->interface_number);
+        } else {
+            printf("[HID] SET_PROTOCOL failed on interface %u, staying in report protocol\n", hid->interface_number);
+        }
+    }
 
-    // TODO: Optionally set protocol to boot/report
+    HURRICANE_PT_END(&setup->pt);
 }
 
-static void parse_mouse_report(uint8_t* buffer, int length) {
-    if (length < 3) {
-        // Not enough data for a mouse report
-        return;
+void hurricane_hid_init(hurricane_device_t* dev) {
+    hurricane_hid_setup_t setup;
+    hurricane_hid_setup_begin(&setup, dev);
+    while (HURRICANE_PT_SCHEDULE(hurricane_hid_setup_thread(&setup))) {
+        hurricane_host_control_task_ctx(hurricane_device_context(dev));
     }
-    
+}
+
+void hurricane_hid_attach_rules(const hurricane_hid_transform_rule_t* rules, uint8_t num_rules) {
+    hurricane_hid_attach_rules_ctx(hurricane_default_context(), rules, num_rules);
+}
+
+void hurricane_hid_attach_rules_ctx(hurricane_context_t* ctx, const hurricane_hid_transform_rule_t* rules,
+                                    uint8_t num_rules) {
+    ctx->host.device.hid_rules = rules;
+    ctx->host.device.hid_num_rules = num_rules;
+
+    // A device already attached picks them up at its next class setup
+    hurricane_device_t* dev = hurricane_get_device_ctx(ctx, 0);
+    if (dev && dev->hid_device) {
+        dev->hid_device->rules = rules;
+        dev->hid_device->num_rules = num_rules;
+    }
+}
+
+// Fill report from a mouse input report described by layout. Returns false
+// if the report is not a mouse report.
+static bool decode_mouse_report(const hurricane_hid_layout_t* layout, const uint8_t* buffer, int length,
+                                mouse_report_t* report) {
+    uint8_t report_id = 0;
+    if (layout->uses_report_ids) {
+        report_id = buffer[0];
+        buffer++;
+        length--;
+    }
+
+    const hurricane_hid_report_info_t* info =
+        hurricane_hid_layout_find_report(layout, HURRICANE_HID_REPORT_INPUT, report_id);
+    if (!info || info->application_page != HID_USAGE_PAGE_GENERIC_DESKTOP ||
+        info->application_usage != HID_USAGE_MOUSE) {
+        return false;
+    }
+
+    const hurricane_hid_field_t* fields = &layout->fields[info->first_field];
+    for (uint8_t i = 0; i < info->num_fields; i++) {
+        const hurricane_hid_field_t* field = &fields[i];
+        if (!(field->flags & HURRICANE_HID_FIELD_VARIABLE)) {
+            continue;
+        }
+        if (field->usage_page == HID_USAGE_PAGE_BUTTON) {
+            for (uint16_t b = 0; b < field->count && field->usage + b <= 8; b++) {
+                if (hurricane_hid_field_read(field, buffer, (uint16_t)length, b)) {
+                    report->buttons |= (uint8_t)(1u << (field->usage + b - 1));
+                }
+            }
+        } else if (field->usage_page == HID_USAGE_PAGE_GENERIC_DESKTOP) {
+            for (uint16_t k = 0; k < field->count; k++) {
+                uint16_t usage = field->usage + k > field->usage_max ? field->usage_max : field->usage + k;
+                int32_t value = hurricane_hid_field_read(field, buffer, (uint16_t)length, k);
+                if (usage == HID_USAGE_X) {
+                    report->x = value;
+                } else if (usage == HID_USAGE_Y) {
+                    report->y = value;
+                } else if (usage == HID_USAGE_WHEEL) {
+                    report->wheel = value;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static void parse_mouse_report(const hurricane_hid_device_t* hid, uint8_t* buffer, int length) {
     mouse_report_t report;
     memset(&report, 0, sizeof(report));
-    
-    // Basic boot protocol mouse has 3 bytes minimum
-    report.buttons = buffer[0];
-    report.x = buffer[1];
-    report.y = buffer[2];
-    
-    // Optional wheel data if available
-    if (length > 3) {
-        report.wheel = buffer[3];
+
+    if (hid && hid->layout) {
+        if (!decode_mouse_report(hid->layout, buffer, length, &report)) {
+            return;
+        }
+    } else {
+        if (length < 3) {
+            // Not enough data for a boot protocol mouse report
+            return;
+        }
+
+        // Basic boot protocol mouse has 3 bytes minimum
+        report.buttons = buffer[0];
+        report.x = (int8_t)buffer[1];
+        report.y = (int8_t)buffer[2];
+
+        // Optional wheel data if available
+        if (length > 3) {
+            report.wheel = (int8_t)buffer[3];
+        }
     }
-    
+
     // Print a human-readable description of the mouse state
-    printf("[MOUSE] Buttons: %s%s%s | X: %d, Y: %d, Wheel: %d\n",
+    printf("[MOUSE] Buttons: %s%s%s | X: %ld, Y: %ld, Wheel: %ld\n",
            (report.buttons & 0x01) ? "LEFT " : "",
            (report.buttons & 0x02) ? "RIGHT " : "",
            (report.buttons & 0x04) ? "MIDDLE " : "",
-           report.x, report.y, report.wheel);
+           (long)report.x, (long)report.y, (long)report.wheel);
 }
 
 void hurricane_hid_task(hurricane_device_t* dev) {
-    uint8_t buffer[64];
-    int res = hurricane_hw_interrupt_in_transfer(dev->addr, buffer, sizeof(buffer));
+    hurricane_context_t* ctx = hurricane_device_context(dev);
+    hurricane_report_view_t view;
+
+    // Receive straight into a pool buffer; with all of them held by consumers
+    // the report stays in the device until one is released
+    uint8_t* buffer = hurricane_report_pool_acquire(&ctx->reports, &view);
+    if (!buffer) {
+        return;
+    }
+
+    int res = hurricane_hw_host_interrupt_in_transfer_on(dev->controller, dev->addr, buffer,
+                                                        HURRICANE_REPORT_BUFFER_SIZE);
     if (res > 0) {
-        printf("[HID] Received %d bytes:\n", res);
-        for (int i = 0; i < res; i++) {
-            printf(" 0x%02X", buffer[i]);
+        view.length = (uint16_t)res;
+        view.pipe = dev->addr;
+        view.timestamp = hurricane_cycles_now();
+
+        // A registered HID class handler gets the view; otherwise print and decode it here
+        if (!hurricane_interface_notify_event_with_response_ctx(ctx, USB_EVENT_ENDPOINT_DATA,
+                                                                dev->hid_device->interface_number, &view, NULL)) {
+            printf("[HID] Received %d bytes:\n", res);
+            for (int i = 0; i < res; i++) {
+                printf(" 0x%02X", buffer[i]);
+            }
+            printf("\n");
+
+            // Attempt to parse it as a mouse report
+            parse_mouse_report(dev->hid_device, buffer, res);
         }
-        printf("\n");
-        
-        // Attempt to parse it as a mouse report
-        parse_mouse_report(buffer, res);
     }
+
+    hurricane_report_view_release(&view);
 }
 
 int hurricane_hid_class_request(hurricane_device_t* dev, hurricane_usb_setup_packet_t* setup) {
@@ -79,7 +222,8 @@ int hurricane_hid_class_request(hurricane_device_t* dev, hurricane_usb_setup_pac
         printf("[HID] Host requested HID report descriptor\n");
 
         if (dev->hid_device->report_descriptor_length > 0) {
-            hurricane_hw_control_transfer(
+            hurricane_hw_host_control_transfer_on(
+                dev->controller,
                 setup,
                 dev->hid_device->report_descriptor,
                 dev->hid_device->report_descriptor_length
@@ -103,7 +247,8 @@ int hurricane_hid_fetch_report_descriptor(hurricane_device_t* dev) {
         .wLength = sizeof(dev->hid_device->report_descriptor),
     };
 
-    int ret = hurricane_hw_control_transfer(&setup, dev->hid_device->report_descriptor, sizeof(dev->hid_device->report_descriptor));
+    int ret = hurricane_hw_host_control_transfer_on(dev->controller, &setup, dev->hid_device->report_descriptor,
+                                                    sizeof(dev->hid_device->report_descriptor));
     if (ret >= 0) {
         dev->hid_device->report_descriptor_length = ret;
         printf("[HID] Fetched %d bytes of HID report descriptor\n", ret);
@@ -114,10 +259,6 @@ int hurricane_hid_fetch_report_descriptor(hurricane_device_t* dev) {
     }
 }
 
-// Callback function pointers
-static void (*hid_send_callback)(uint8_t* buffer, uint16_t length) = NULL;
-static void (*hid_receive_callback)(uint8_t* buffer, uint16_t length) = NULL;
-
 /**
  * @brief Register HID device callbacks for sending and receiving reports
  *
@@ -128,8 +269,16 @@ void hurricane_device_hid_register_callbacks(
     void (*send_callback)(uint8_t* buffer, uint16_t length),
     void (*receive_callback)(uint8_t* buffer, uint16_t length)
 ) {
-    hid_send_callback = send_callback;
-    hid_receive_callback = receive_callback;
+    hurricane_device_hid_register_callbacks_ctx(hurricane_default_context(), send_callback, receive_callback);
+}
+
+void hurricane_device_hid_register_callbacks_ctx(
+    hurricane_context_t* ctx,
+    void (*send_callback)(uint8_t* buffer, uint16_t length),
+    void (*receive_callback)(uint8_t* buffer, uint16_t length)
+) {
+    ctx->hid.send_callback = send_callback;
+    ctx->hid.receive_callback = receive_callback;
 }
 
 /**
@@ -140,15 +289,19 @@ void hurricane_device_hid_register_callbacks(
  * @return Number of bytes sent, or negative error code
  */
 int hurricane_device_hid_send_report(uint8_t* buffer, uint16_t length) {
+    return hurricane_device_hid_send_report_ctx(hurricane_default_context(), buffer, length);
+}
+
+int hurricane_device_hid_send_report_ctx(hurricane_context_t* ctx, uint8_t* buffer, uint16_t length) {
     // Use IN endpoint 1 for HID reports (standard for HID devices)
     const uint8_t hid_endpoint = 0x81; // 0x80 is IN direction, 0x01 is endpoint number
     
     // Send the report via interrupt IN transfer
-    int result = hurricane_hw_device_interrupt_in_transfer(hid_endpoint, buffer, length);
+    int result = hurricane_hw_device_interrupt_in_transfer_on(ctx->device_controller, hid_endpoint, buffer, length);
     
     // Call the send callback if registered and transfer was successful
-    if (result > 0 && hid_send_callback != NULL) {
-        hid_send_callback(buffer, result);
+    if (result > 0 && ctx->hid.send_callback != NULL) {
+        ctx->hid.send_callback(buffer, result);
     }
     
     return result;
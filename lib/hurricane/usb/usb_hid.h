@@ -3,14 +3,44 @@
 #include "hurricane_usb.h"
 #include "core/usb_descriptor.h"
 #include "usb/usb_control.h"
+#include "usb/usb_hid_boot.h"
 #include "hw/hurricane_hw_hal.h"
+#include "core/hurricane_pt.h"
+#include "core/usb_host_control_queue.h"
 
-// Initialize the HID device
+// Device-side HID report callbacks of one stack context
+typedef struct {
+    void (*send_callback)(uint8_t* buffer, uint16_t length);
+    void (*receive_callback)(uint8_t* buffer, uint16_t length);
+} hurricane_hid_callbacks_t;
+
+// Cooperative HID class setup state (one control transfer per step)
+typedef struct {
+    hurricane_pt_t pt;
+    hurricane_control_request_t request;
+    hurricane_device_t* dev;
+} hurricane_hid_setup_t;
+
+// Initialize the HID device (blocks until class setup has completed)
 void hurricane_hid_init(hurricane_device_t* dev);
 
+// Prepare a cooperative HID class setup for dev
+void hurricane_hid_setup_begin(hurricane_hid_setup_t* setup, hurricane_device_t* dev);
+
+// Run the HID class setup; yields while a control transfer is queued
+HURRICANE_PT_THREAD(hurricane_hid_setup_thread(hurricane_hid_setup_t* setup));
+
 // Process HID reports
 void hurricane_hid_task(hurricane_device_t* dev);
 
+// Transform rules the application runs on reports of the HID device (NULL:
+// none). Attached to the device at enumeration and kept across reconnects;
+// its class setup selects boot protocol when every rule fits the device's
+// boot report (see usb_hid_boot.h). rules must stay valid while attached.
+void hurricane_hid_attach_rules(const hurricane_hid_transform_rule_t* rules, uint8_t num_rules);
+void hurricane_hid_attach_rules_ctx(hurricane_context_t* ctx, const hurricane_hid_transform_rule_t* rules,
+                                    uint8_t num_rules);
+
 // Handle HID class-specific requests
 int hurricane_hid_class_request(hurricane_device_t* dev, hurricane_usb_setup_packet_t* setup);
 
@@ -25,3 +55,11 @@ void hurricane_device_hid_register_callbacks(
 
 // Send HID report to host
 int hurricane_device_hid_send_report(uint8_t* buffer, uint16_t length);
+
+// The same on a specific stack context
+void hurricane_device_hid_register_callbacks_ctx(
+    hurricane_context_t* ctx,
+    void (*send_callback)(uint8_t* buffer, uint16_t length),
+    void (*receive_callback)(uint8_t* buffer, uint16_t length)
+);
+int hurricane_device_hid_send_report_ctx(hurricane_context_t* ctx, uint8_t* buffer, uint16_t length);
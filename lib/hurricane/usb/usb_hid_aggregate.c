@@ -0,0 +1,191 @@
+/*
+ * @file usb_hid_aggregate.c
+ * @brief Several host-side devices behind one device-side composite
+ */
+
+#include "usb_hid_aggregate.h"
+#include <stddef.h>
+#include <string.h>
+
+static int32_t add_saturated(int32_t a, int32_t b)
+{
+    int64_t sum = (int64_t)a + b;
+    if (sum > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (sum < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)sum;
+}
+
+// Put a key into the first free slot of an array; a full array drops it like any rollover
+static void array_add(int32_t* slots, uint16_t count, int32_t raw)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        if (slots[i] == raw) {
+            return;
+        }
+        if (slots[i] == 0) {
+            slots[i] = raw;
+            return;
+        }
+    }
+}
+
+// Whether an interface needs a new combination this frame
+static bool needs_combine(const hurricane_hid_aggregate_t* aggregate, uint8_t index)
+{
+    if (aggregate->dirty[index]) {
+        return true;
+    }
+    for (uint8_t s = 0; s < HURRICANE_HID_AGGREGATE_MAX_SOURCES; s++) {
+        const hurricane_hid_aggregate_source_t* source = &aggregate->sources[s];
+        if (source->route.pipes[index].active && hurricane_hid_merge_pending(&source->merges[index])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Combine the merged input of every source feeding an interface into the persona
+static void combine(hurricane_hid_aggregate_t* aggregate, uint8_t index)
+{
+    const hurricane_hid_merge_t* shape = &aggregate->persona.merges[index];
+    int32_t* out = aggregate->combined;
+    const int32_t* in = aggregate->source_values;
+    bool absolute_set = false;
+
+    memset(out, 0, aggregate->persona.pipes[index].pack.num_values * sizeof(int32_t));
+
+    for (uint8_t s = 0; s < HURRICANE_HID_AGGREGATE_MAX_SOURCES; s++) {
+        hurricane_hid_aggregate_source_t* source = &aggregate->sources[s];
+        if (!source->route.pipes[index].active) {
+            continue;
+        }
+
+        // Every source maps into the persona's layout, so the persona's fields describe its values
+        hurricane_hid_merge_build(&source->merges[index], aggregate->source_values);
+        bool take_absolute = !absolute_set || s == aggregate->latest[index];
+
+        for (uint8_t i = 0; i < shape->num_fields; i++) {
+            const hurricane_hid_merge_field_t* f = &shape->fields[i];
+
+            switch (f->kind) {
+                case HURRICANE_HID_MERGE_OR:
+                    for (uint16_t e = f->index; e < f->index + f->count; e++) {
+                        out[e] = (int32_t)((uint32_t)out[e] | (uint32_t)in[e]);
+                    }
+                    break;
+                case HURRICANE_HID_MERGE_UNION:
+                    for (uint16_t e = f->index; e < f->index + f->count; e++) {
+                        if (in[e] != 0) {
+                            array_add(&out[f->index], f->count, in[e]);
+                        }
+                    }
+                    break;
+                case HURRICANE_HID_MERGE_SUM:
+                    for (uint16_t e = f->index; e < f->index + f->count; e++) {
+                        out[e] = add_saturated(out[e], in[e]);
+                    }
+                    break;
+                default:
+                    if (take_absolute) {
+                        memcpy(&out[f->index], &in[f->index], f->count * sizeof(int32_t));
+                    }
+                    break;
+            }
+        }
+        absolute_set = true;
+    }
+
+    hurricane_hid_merge_live(&aggregate->persona.merges[index], out);
+    aggregate->dirty[index] = false;
+}
+
+// Forget a source's device and whatever input it left
+static void reset_source(hurricane_hid_aggregate_t* aggregate, hurricane_hid_aggregate_source_t* source)
+{
+    hurricane_hid_pipeline_source_detach(&source->route);
+    for (uint8_t i = 0; i < aggregate->config->num_pipes; i++) {
+        const hurricane_hid_pipe_t* sink = &aggregate->persona.pipes[i];
+        hurricane_hid_merge_init(&source->merges[i], &sink->sink_layout, &sink->pack);
+    }
+}
+
+int hurricane_hid_aggregate_init(hurricane_hid_aggregate_t* aggregate, const hurricane_hid_pipeline_config_t* config)
+{
+    if (!aggregate || !config) {
+        return HURRICANE_HID_PIPELINE_ERR_INVALID_ARG;
+    }
+
+    memset(aggregate, 0, sizeof(*aggregate));
+    int result = hurricane_hid_pipeline_init(&aggregate->persona, config);
+    if (result != 0) {
+        return result;
+    }
+
+    aggregate->config = config;
+    for (uint8_t s = 0; s < HURRICANE_HID_AGGREGATE_MAX_SOURCES; s++) {
+        reset_source(aggregate, &aggregate->sources[s]);
+    }
+    return 0;
+}
+
+int hurricane_hid_aggregate_attach(hurricane_hid_aggregate_t* aggregate, uint8_t source,
+                                   const uint8_t* descriptor, uint16_t length)
+{
+    if (!aggregate || !aggregate->config || source >= HURRICANE_HID_AGGREGATE_MAX_SOURCES) {
+        return HURRICANE_HID_PIPELINE_ERR_INVALID_ARG;
+    }
+
+    hurricane_hid_aggregate_source_t* s = &aggregate->sources[source];
+    reset_source(aggregate, s);
+    return hurricane_hid_pipeline_source_attach(&aggregate->persona, &s->route, descriptor, length);
+}
+
+void hurricane_hid_aggregate_detach(hurricane_hid_aggregate_t* aggregate, uint8_t source)
+{
+    if (!aggregate || !aggregate->config || source >= HURRICANE_HID_AGGREGATE_MAX_SOURCES ||
+        !aggregate->sources[source].route.attached) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < aggregate->config->num_pipes; i++) {
+        if (aggregate->sources[source].route.pipes[i].active) {
+            aggregate->dirty[i] = true;
+        }
+    }
+    reset_source(aggregate, &aggregate->sources[source]);
+}
+
+int hurricane_hid_aggregate_submit(hurricane_hid_aggregate_t* aggregate, uint8_t source,
+                                   const uint8_t* report, uint16_t length)
+{
+    if (!aggregate || source >= HURRICANE_HID_AGGREGATE_MAX_SOURCES) {
+        return HURRICANE_HID_PIPELINE_ERR_INVALID_ARG;
+    }
+
+    hurricane_hid_aggregate_source_t* s = &aggregate->sources[source];
+    int index = hurricane_hid_pipeline_source_relay(&aggregate->persona, &s->route, s->merges, report, length);
+    if (index >= 0) {
+        aggregate->latest[index] = source;
+    }
+    return index;
+}
+
+int hurricane_hid_aggregate_run(hurricane_hid_aggregate_t* aggregate, uint32_t now_ms)
+{
+    if (!aggregate || !aggregate->config) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < aggregate->config->num_pipes; i++) {
+        if (needs_combine(aggregate, i)) {
+            combine(aggregate, i);
+        }
+    }
+
+    // One merged report per interface at most, plus the repeats SET_IDLE asks for
+    return hurricane_hid_pipeline_run(&aggregate->persona, now_ms);
+}
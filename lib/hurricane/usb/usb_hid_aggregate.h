@@ -0,0 +1,128 @@
+/**
+ * @file usb_hid_aggregate.h
+ * @brief Several host-side devices behind one device-side composite
+ *
+ * The PC sees one persona, e.g. a keyboard and a mouse, described by a
+ * pipeline table (usb_hid_pipeline.h). Each captured device is a source:
+ * the source side of a pipeline (decode plans, transforms, map moves) and
+ * one merge per interface, compiled against the persona's sinks. Its
+ * reports are decoded, transformed and mapped into the persona's layout but
+ * never sent; the sink layouts and pack plans exist once, in the persona.
+ * Once per device-side frame the sources are combined per interface:
+ *  - buttons and key bitmaps: OR,
+ *  - key arrays: union (extra keys are dropped, like any rollover),
+ *  - relative axes: sum; what exceeds the logical range is carried over,
+ *  - absolute axes: the source that reported last.
+ *
+ * The combination goes through the persona's merges, so injected input
+ * (hurricane_inject_sched_run() on persona.merges) joins it, and through
+ * the persona's filters and sinks, so each interface sends at most one
+ * report per frame however many sources reported in between.
+ *
+ * Held state is recomputed from every attached source each frame, so a
+ * detached source's buttons are released without disturbing the others.
+ * The cost per frame is one merge build per source and interface that has
+ * news; nothing is allocated.
+ *
+ *   static hurricane_hid_aggregate_t desk;
+ *
+ *   hurricane_hid_aggregate_init(&desk, &persona);
+ *   hurricane_hid_aggregate_attach(&desk, 0, mouse_a_desc, mouse_a_desc_length);
+ *   hurricane_hid_aggregate_attach(&desk, 1, mouse_b_desc, mouse_b_desc_length);
+ *   ...
+ *   hurricane_hid_aggregate_submit(&desk, source, view->data, view->length);  // Per host-side report
+ *   hurricane_hid_aggregate_run(&desk, now_ms);                               // Per device-side frame
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_hid_pipeline.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Host-side devices per aggregate
+ */
+#ifndef HURRICANE_HID_AGGREGATE_MAX_SOURCES
+#define HURRICANE_HID_AGGREGATE_MAX_SOURCES 3
+#endif
+
+/**
+ * @brief One captured device
+ */
+typedef struct {
+    hurricane_hid_pipeline_source_t route;  /**< Compiled against the persona's sinks */
+    hurricane_hid_merge_t merges[HURRICANE_HID_PIPELINE_MAX_PIPES]; /**< Input waiting for the next frame */
+} hurricane_hid_aggregate_source_t;
+
+/**
+ * @brief An aggregate; must not move after hurricane_hid_aggregate_init()
+ */
+typedef struct {
+    const hurricane_hid_pipeline_config_t* config;
+    hurricane_hid_pipeline_t persona;       /**< Device-side composite; never attached */
+    hurricane_hid_aggregate_source_t sources[HURRICANE_HID_AGGREGATE_MAX_SOURCES];  /**< One per captured device */
+    uint8_t latest[HURRICANE_HID_PIPELINE_MAX_PIPES];   /**< Source that reported last, per interface */
+    bool dirty[HURRICANE_HID_PIPELINE_MAX_PIPES];       /**< A source went away since the last frame */
+    int32_t source_values[HURRICANE_HID_MAX_DECODE_VALUES];
+    int32_t combined[HURRICANE_HID_MAX_DECODE_VALUES];
+} hurricane_hid_aggregate_t;
+
+/**
+ * @brief Set up the persona and the sources from one pipeline table
+ *
+ * The table's source_endpoint is not used; reports are submitted per source.
+ *
+ * @param aggregate Aggregate storage
+ * @param config Persona table, referenced, not copied
+ * @return 0 on success, negative HURRICANE_HID_PIPELINE_ERR_* code on failure
+ */
+int hurricane_hid_aggregate_init(hurricane_hid_aggregate_t* aggregate, const hurricane_hid_pipeline_config_t* config);
+
+/**
+ * @brief Attach a captured device as a source
+ *
+ * @param aggregate Aggregate
+ * @param source Source index
+ * @param descriptor Report descriptor of the host-side interface
+ * @param length Descriptor length
+ * @return Number of persona interfaces the device feeds, or negative HURRICANE_HID_PIPELINE_ERR_* code
+ */
+int hurricane_hid_aggregate_attach(hurricane_hid_aggregate_t* aggregate, uint8_t source,
+                                   const uint8_t* descriptor, uint16_t length);
+
+/**
+ * @brief Detach a source; its input is released at the next frame
+ */
+void hurricane_hid_aggregate_detach(hurricane_hid_aggregate_t* aggregate, uint8_t source);
+
+/**
+ * @brief Feed one report of a source; nothing is sent until the next frame
+ *
+ * @param aggregate Aggregate
+ * @param source Source index
+ * @param report Report as received, including the ID byte if the device uses IDs
+ * @param length Report length
+ * @return Persona interface (pipe index), or negative HURRICANE_HID_PIPELINE_ERR_* code
+ */
+int hurricane_hid_aggregate_submit(hurricane_hid_aggregate_t* aggregate, uint8_t source,
+                                   const uint8_t* report, uint16_t length);
+
+/**
+ * @brief Device-side frame: combine the sources and send
+ *
+ * Call once per frame (SOF or poll interval).
+ *
+ * @param aggregate Aggregate
+ * @param now_ms Current time in milliseconds
+ * @return Number of reports sent
+ */
+int hurricane_hid_aggregate_run(hurricane_hid_aggregate_t* aggregate, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
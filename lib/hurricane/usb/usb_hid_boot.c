@@ -0,0 +1,87 @@
+/*
+ * @file usb_hid_boot.c
+ * @brief Boot protocol fast path for keyboards and mice
+ */
+
+#include "usb_hid_boot.h"
+#include "usb_hid_boot_reports.h"
+#include <stddef.h>
+
+// HID 1.11 appendices B.1 and B.2, from usb_hid_boot_reports.h (tools/descriptors/hid_boot.c)
+static const uint8_t boot_keyboard_descriptor[] = { HURRICANE_BOOT_KEYBOARD_DESCRIPTOR_BYTES };
+static const uint8_t boot_mouse_descriptor[] = { HURRICANE_BOOT_MOUSE_DESCRIPTOR_BYTES };
+
+// Compiled at build time, so every context reads the same constant tables
+static const hurricane_hid_layout_t boot_keyboard_layout = HURRICANE_BOOT_KEYBOARD_LAYOUT;
+static const hurricane_hid_layout_t boot_mouse_layout = HURRICANE_BOOT_MOUSE_LAYOUT;
+
+const uint8_t* hurricane_hid_boot_descriptor(uint8_t boot_protocol, uint16_t* length)
+{
+    const uint8_t* desc = NULL;
+    uint16_t size = 0;
+
+    if (boot_protocol == HURRICANE_HID_BOOT_KEYBOARD) {
+        desc = boot_keyboard_descriptor;
+        size = sizeof(boot_keyboard_descriptor);
+    } else if (boot_protocol == HURRICANE_HID_BOOT_MOUSE) {
+        desc = boot_mouse_descriptor;
+        size = sizeof(boot_mouse_descriptor);
+    }
+    if (length) {
+        *length = size;
+    }
+    return desc;
+}
+
+const hurricane_hid_layout_t* hurricane_hid_boot_layout(uint8_t boot_protocol)
+{
+    if (boot_protocol == HURRICANE_HID_BOOT_KEYBOARD) {
+        return &boot_keyboard_layout;
+    }
+    if (boot_protocol == HURRICANE_HID_BOOT_MOUSE) {
+        return &boot_mouse_layout;
+    }
+    return NULL;
+}
+
+bool hurricane_hid_boot_covers(uint8_t boot_protocol, uint16_t usage_page, uint16_t usage)
+{
+    switch (boot_protocol) {
+        case HURRICANE_HID_BOOT_KEYBOARD:
+            return (usage_page == 0x07 && (usage <= 0x65 || (usage >= 0xE0 && usage <= 0xE7))) ||
+                   (usage_page == 0x08 && usage >= 1 && usage <= 5);
+        case HURRICANE_HID_BOOT_MOUSE:
+            return (usage_page == 0x09 && usage >= 1 && usage <= 3) ||
+                   (usage_page == 0x01 && (usage == 0x30 || usage == 0x31));
+        default:
+            return false;
+    }
+}
+
+bool hurricane_hid_boot_rules_fit(uint8_t boot_protocol, const hurricane_hid_transform_rule_t* rules,
+                                  uint8_t num_rules)
+{
+    if (!hurricane_hid_boot_layout(boot_protocol)) {
+        return false;
+    }
+    for (uint8_t i = 0; rules && i < num_rules; i++) {
+        const hurricane_hid_transform_rule_t* rule = &rules[i];
+        if (!hurricane_hid_boot_covers(boot_protocol, rule->usage_page, rule->usage)) {
+            return false;
+        }
+        if ((rule->op == HURRICANE_HID_XFORM_SWAP || rule->op == HURRICANE_HID_XFORM_REMAP) &&
+            !hurricane_hid_boot_covers(boot_protocol, rule->target_page, rule->target_usage)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint8_t hurricane_hid_boot_policy(uint8_t boot_protocol, const hurricane_hid_transform_rule_t* rules,
+                                  uint8_t num_rules)
+{
+    if (rules && hurricane_hid_boot_rules_fit(boot_protocol, rules, num_rules)) {
+        return HURRICANE_HID_POLICY_BOOT;
+    }
+    return HURRICANE_HID_POLICY_REPORT;
+}
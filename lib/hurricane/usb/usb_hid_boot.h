@@ -0,0 +1,107 @@
+/**
+ * @file usb_hid_boot.h
+ * @brief Boot protocol fast path for keyboards and mice
+ *
+ * A keyboard or mouse that is only forwarded or lightly remapped does not
+ * need its report protocol layout: variable report sizes, report IDs and
+ * long descriptors cost decode and pack time for fields nobody looks at.
+ * Interfaces of the boot subclass can be switched to the fixed boot
+ * reports instead (8 bytes keyboard, 3 bytes mouse), whose layouts compile
+ * to byte-aligned decode and pack steps at fixed offsets.
+ *
+ * The switch is a per-device policy chosen by the HID class setup from the
+ * transform rules attached to the device (hurricane_hid_attach_rules_ctx()):
+ * when every rule fits the device's boot report, the setup sends
+ * SET_PROTOCOL(Boot) to the boot interface and the device's layout becomes
+ * the boot layout. A rule that needs a field boot reports do not carry
+ * (wheel, extra buttons, consumer keys, ...) keeps the device in report
+ * protocol, as does a device without attached rules.
+ *
+ * The device-side persona uses the same layouts:
+ * hurricane_hid_boot_descriptor() returns the matching report descriptor.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_hid_parser.h"
+#include "usb_hid_transform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// bInterfaceProtocol of a boot subclass interface
+#define HURRICANE_HID_BOOT_NONE         0
+#define HURRICANE_HID_BOOT_KEYBOARD     1
+#define HURRICANE_HID_BOOT_MOUSE        2
+
+// SET_PROTOCOL / GET_PROTOCOL values (hurricane_hid_device_t::protocol)
+#define HURRICANE_HID_PROTOCOL_BOOT     0
+#define HURRICANE_HID_PROTOCOL_REPORT   1
+
+/**
+ * @brief Which protocol the HID class setup selects (hurricane_hid_device_t::protocol_policy)
+ */
+typedef enum {
+    HURRICANE_HID_POLICY_REPORT = 0,    /**< Leave the device in report protocol (default) */
+    HURRICANE_HID_POLICY_BOOT           /**< Switch the boot interface to boot protocol */
+} hurricane_hid_protocol_policy_t;
+
+/**
+ * @brief Report descriptor describing boot reports
+ *
+ * @param boot_protocol HURRICANE_HID_BOOT_KEYBOARD or HURRICANE_HID_BOOT_MOUSE
+ * @param length Output: descriptor length
+ * @return Descriptor, or NULL for other values
+ */
+const uint8_t* hurricane_hid_boot_descriptor(uint8_t boot_protocol, uint16_t* length);
+
+/**
+ * @brief Compiled layout of boot reports
+ *
+ * Generated at build time (usb_hid_boot_reports.h); read-only, so all
+ * contexts share it.
+ *
+ * @param boot_protocol HURRICANE_HID_BOOT_KEYBOARD or HURRICANE_HID_BOOT_MOUSE
+ * @return Layout, or NULL for other values
+ */
+const hurricane_hid_layout_t* hurricane_hid_boot_layout(uint8_t boot_protocol);
+
+/**
+ * @brief Check whether boot reports carry a usage
+ *
+ * Keyboard: modifiers and keys 0x00-0x65 (page 0x07), LEDs 1-5 (page
+ * 0x08). Mouse: buttons 1-3 (page 0x09), X and Y (page 0x01).
+ */
+bool hurricane_hid_boot_covers(uint8_t boot_protocol, uint16_t usage_page, uint16_t usage);
+
+/**
+ * @brief Check whether a transform can run on boot reports
+ *
+ * True if every usage the rules read or write (target usages included) is
+ * carried by the boot report of boot_protocol. Always false for interfaces
+ * outside the boot subclass.
+ */
+bool hurricane_hid_boot_rules_fit(uint8_t boot_protocol, const hurricane_hid_transform_rule_t* rules,
+                                  uint8_t num_rules);
+
+/**
+ * @brief Protocol policy of a device
+ *
+ * HURRICANE_HID_POLICY_BOOT when rules are attached (an empty table means
+ * plain forwarding) and all of them fit the boot report of boot_protocol,
+ * HURRICANE_HID_POLICY_REPORT otherwise.
+ *
+ * @param boot_protocol Boot subclass bInterfaceProtocol of the device
+ * @param rules Attached transform rules, NULL if none
+ * @param num_rules Number of rules
+ * @return hurricane_hid_protocol_policy_t
+ */
+uint8_t hurricane_hid_boot_policy(uint8_t boot_protocol, const hurricane_hid_transform_rule_t* rules,
+                                  uint8_t num_rules);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,376 @@
+/**
+ * @file usb_hid_boot_reports.h
+ * @brief Report accessors generated from hid_boot.c
+ *
+ * Generated by tools/hid_codegen, do not edit; regenerate with `make codegen`.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef HID_CODEGEN_HELPERS
+#define HID_CODEGEN_HELPERS
+// Element access at a bit position; constant arguments fold after inlining
+static inline int32_t hid_codegen_read(const uint8_t* report, uint32_t bit, uint8_t size, bool is_signed)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < size; i++, bit++) {
+        value |= (uint32_t)((report[bit / 8] >> (bit % 8)) & 1u) << i;
+    }
+    if (is_signed && size < 32 && (value & (1u << (size - 1)))) {
+        value |= ~0u << size;
+    }
+    return (int32_t)value;
+}
+
+static inline void hid_codegen_write(uint8_t* report, uint32_t bit, uint8_t size, int32_t value)
+{
+    for (uint8_t i = 0; i < size; i++, bit++) {
+        uint8_t mask = (uint8_t)(1u << (bit % 8));
+        if (((uint32_t)value >> i) & 1u) {
+            report[bit / 8] |= mask;
+        } else {
+            report[bit / 8] &= (uint8_t)~mask;
+        }
+    }
+}
+#endif
+
+// boot_keyboard_descriptor
+#define HURRICANE_BOOT_KEYBOARD_DESCRIPTOR_LENGTH 63
+#define HURRICANE_BOOT_KEYBOARD_DESCRIPTOR_HASH 0xC67BAD2Cu    // FNV-1a
+#define HURRICANE_BOOT_KEYBOARD_DESCRIPTOR_BYTES \
+    0x05, 0x01, \
+    0x09, 0x06, \
+    0xA1, 0x01, \
+    0x05, 0x07, \
+    0x19, 0xE0, \
+    0x29, 0xE7, \
+    0x15, 0x00, \
+    0x25, 0x01, \
+    0x75, 0x01, \
+    0x95, 0x08, \
+    0x81, 0x02, \
+    0x95, 0x01, \
+    0x75, 0x08, \
+    0x81, 0x01, \
+    0x95, 0x05, \
+    0x75, 0x01, \
+    0x05, 0x08, \
+    0x19, 0x01, \
+    0x29, 0x05, \
+    0x91, 0x02, \
+    0x95, 0x01, \
+    0x75, 0x03, \
+    0x91, 0x01, \
+    0x95, 0x06, \
+    0x75, 0x08, \
+    0x15, 0x00, \
+    0x25, 0x65, \
+    0x05, 0x07, \
+    0x19, 0x00, \
+    0x29, 0x65, \
+    0x81, 0x00, \
+    0xC0
+
+#define HURRICANE_BOOT_KEYBOARD_LAYOUT { \
+    .fields = { \
+        { .usage_page = 0x07, .usage = 0xE0, .usage_max = 0xE7, .bit_offset = 0, .count = 8, .flags = 0x02, .report_id = 0, .report_index = 0, .bit_size = 1, .type = 1, .logical_min = 0, .logical_max = 1 }, \
+        { .usage_page = 0x07, .usage = 0x00, .usage_max = 0x65, .bit_offset = 16, .count = 6, .flags = 0x00, .report_id = 0, .report_index = 0, .bit_size = 8, .type = 1, .logical_min = 0, .logical_max = 101 }, \
+        { .usage_page = 0x08, .usage = 0x01, .usage_max = 0x05, .bit_offset = 0, .count = 5, .flags = 0x02, .report_id = 0, .report_index = 1, .bit_size = 1, .type = 2, .logical_min = 0, .logical_max = 1 }, \
+    }, \
+    .reports = { \
+        { .report_id = 0, .type = 1, .bit_length = 64, .first_field = 0, .num_fields = 2, .application_page = 0x01, .application_usage = 0x06 }, \
+        { .report_id = 0, .type = 2, .bit_length = 8, .first_field = 2, .num_fields = 1, .application_page = 0x01, .application_usage = 0x06 }, \
+    }, \
+    .num_fields = 3, \
+    .num_reports = 2, \
+    .uses_report_ids = false \
+}
+
+// input report
+#define HURRICANE_BOOT_KEYBOARD_INPUT_SIZE 8
+
+static inline int32_t hurricane_boot_keyboard_input_left_ctrl(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)(raw & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_input_set_left_ctrl(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0x1u;
+    report[0] = (uint8_t)((report[0] & 0xFEu) | (raw & 0x01u));
+}
+
+static inline int32_t hurricane_boot_keyboard_input_left_shift(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 1) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_input_set_left_shift(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 1;
+    report[0] = (uint8_t)((report[0] & 0xFDu) | (raw & 0x02u));
+}
+
+static inline int32_t hurricane_boot_keyboard_input_left_alt(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 2) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_input_set_left_alt(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 2;
+    report[0] = (uint8_t)((report[0] & 0xFBu) | (raw & 0x04u));
+}
+
+static inline int32_t hurricane_boot_keyboard_input_left_gui(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 3) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_input_set_left_gui(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 3;
+    report[0] = (uint8_t)((report[0] & 0xF7u) | (raw & 0x08u));
+}
+
+static inline int32_t hurricane_boot_keyboard_input_right_ctrl(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 4) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_input_set_right_ctrl(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 4;
+    report[0] = (uint8_t)((report[0] & 0xEFu) | (raw & 0x10u));
+}
+
+static inline int32_t hurricane_boot_keyboard_input_right_shift(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 5) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_input_set_right_shift(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 5;
+    report[0] = (uint8_t)((report[0] & 0xDFu) | (raw & 0x20u));
+}
+
+static inline int32_t hurricane_boot_keyboard_input_right_alt(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 6) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_input_set_right_alt(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 6;
+    report[0] = (uint8_t)((report[0] & 0xBFu) | (raw & 0x40u));
+}
+
+static inline int32_t hurricane_boot_keyboard_input_right_gui(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 7) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_input_set_right_gui(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 7;
+    report[0] = (uint8_t)((report[0] & 0x7Fu) | (raw & 0x80u));
+}
+
+static inline int32_t hurricane_boot_keyboard_input_keys(const uint8_t* report, uint16_t index)
+{
+    return index < 6 ? (int32_t)report[2 + index] : 0;
+}
+
+static inline void hurricane_boot_keyboard_input_set_keys(uint8_t* report, uint16_t index, int32_t value)
+{
+    if (index < 6) {
+        report[2 + index] = (uint8_t)value;
+    }
+}
+
+// output report
+#define HURRICANE_BOOT_KEYBOARD_OUTPUT_SIZE 1
+
+static inline int32_t hurricane_boot_keyboard_output_num_lock(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)(raw & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_output_set_num_lock(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0x1u;
+    report[0] = (uint8_t)((report[0] & 0xFEu) | (raw & 0x01u));
+}
+
+static inline int32_t hurricane_boot_keyboard_output_caps_lock(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 1) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_output_set_caps_lock(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 1;
+    report[0] = (uint8_t)((report[0] & 0xFDu) | (raw & 0x02u));
+}
+
+static inline int32_t hurricane_boot_keyboard_output_scroll_lock(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 2) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_output_set_scroll_lock(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 2;
+    report[0] = (uint8_t)((report[0] & 0xFBu) | (raw & 0x04u));
+}
+
+static inline int32_t hurricane_boot_keyboard_output_compose(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 3) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_output_set_compose(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 3;
+    report[0] = (uint8_t)((report[0] & 0xF7u) | (raw & 0x08u));
+}
+
+static inline int32_t hurricane_boot_keyboard_output_kana(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 4) & 0x1u);
+}
+
+static inline void hurricane_boot_keyboard_output_set_kana(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 4;
+    report[0] = (uint8_t)((report[0] & 0xEFu) | (raw & 0x10u));
+}
+
+// boot_mouse_descriptor
+#define HURRICANE_BOOT_MOUSE_DESCRIPTOR_LENGTH 50
+#define HURRICANE_BOOT_MOUSE_DESCRIPTOR_HASH 0x9473F2F7u    // FNV-1a
+#define HURRICANE_BOOT_MOUSE_DESCRIPTOR_BYTES \
+    0x05, 0x01, \
+    0x09, 0x02, \
+    0xA1, 0x01, \
+    0x09, 0x01, \
+    0xA1, 0x00, \
+    0x05, 0x09, \
+    0x19, 0x01, \
+    0x29, 0x03, \
+    0x15, 0x00, \
+    0x25, 0x01, \
+    0x95, 0x03, \
+    0x75, 0x01, \
+    0x81, 0x02, \
+    0x95, 0x01, \
+    0x75, 0x05, \
+    0x81, 0x01, \
+    0x05, 0x01, \
+    0x09, 0x30, \
+    0x09, 0x31, \
+    0x15, 0x81, \
+    0x25, 0x7F, \
+    0x75, 0x08, \
+    0x95, 0x02, \
+    0x81, 0x06, \
+    0xC0, \
+    0xC0
+
+#define HURRICANE_BOOT_MOUSE_LAYOUT { \
+    .fields = { \
+        { .usage_page = 0x09, .usage = 0x01, .usage_max = 0x03, .bit_offset = 0, .count = 3, .flags = 0x02, .report_id = 0, .report_index = 0, .bit_size = 1, .type = 1, .logical_min = 0, .logical_max = 1 }, \
+        { .usage_page = 0x01, .usage = 0x30, .usage_max = 0x30, .bit_offset = 8, .count = 1, .flags = 0x8006, .report_id = 0, .report_index = 0, .bit_size = 8, .type = 1, .logical_min = -127, .logical_max = 127 }, \
+        { .usage_page = 0x01, .usage = 0x31, .usage_max = 0x31, .bit_offset = 16, .count = 1, .flags = 0x8006, .report_id = 0, .report_index = 0, .bit_size = 8, .type = 1, .logical_min = -127, .logical_max = 127 }, \
+    }, \
+    .reports = { \
+        { .report_id = 0, .type = 1, .bit_length = 24, .first_field = 0, .num_fields = 3, .application_page = 0x01, .application_usage = 0x02 }, \
+    }, \
+    .num_fields = 3, \
+    .num_reports = 1, \
+    .uses_report_ids = false \
+}
+
+// input report
+#define HURRICANE_BOOT_MOUSE_INPUT_SIZE 3
+
+static inline int32_t hurricane_boot_mouse_input_button1(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)(raw & 0x1u);
+}
+
+static inline void hurricane_boot_mouse_input_set_button1(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0x1u;
+    report[0] = (uint8_t)((report[0] & 0xFEu) | (raw & 0x01u));
+}
+
+static inline int32_t hurricane_boot_mouse_input_button2(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 1) & 0x1u);
+}
+
+static inline void hurricane_boot_mouse_input_set_button2(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 1;
+    report[0] = (uint8_t)((report[0] & 0xFDu) | (raw & 0x02u));
+}
+
+static inline int32_t hurricane_boot_mouse_input_button3(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[0];
+    return (int32_t)((raw >> 2) & 0x1u);
+}
+
+static inline void hurricane_boot_mouse_input_set_button3(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 2;
+    report[0] = (uint8_t)((report[0] & 0xFBu) | (raw & 0x04u));
+}
+
+static inline int32_t hurricane_boot_mouse_input_x(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[1];
+    uint32_t value = raw & 0xFFu;
+    return (int32_t)(value ^ 0x80u) - 0x80;
+}
+
+static inline void hurricane_boot_mouse_input_set_x(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0xFFu;
+    report[1] = (uint8_t)raw;
+}
+
+static inline int32_t hurricane_boot_mouse_input_y(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[2];
+    uint32_t value = raw & 0xFFu;
+    return (int32_t)(value ^ 0x80u) - 0x80;
+}
+
+static inline void hurricane_boot_mouse_input_set_y(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0xFFu;
+    report[2] = (uint8_t)raw;
+}
+
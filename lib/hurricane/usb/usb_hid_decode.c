@@ -0,0 +1,253 @@
+/*
+ * @file usb_hid_decode.c
+ * @brief Specialized decode plans for HID reports
+ */
+
+#include "usb_hid_decode.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// Word loads may read up to 3 bytes past the last field. Reports up to this
+// size are copied into a zero padded scratch buffer when the caller's data
+// is shorter than that; longer ones take the bounds checked path instead.
+#define DECODE_SCRATCH_SIZE 64
+
+static inline uint32_t load32le(const uint8_t* p)
+{
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap32(w);
+#endif
+    return w;
+}
+
+static inline uint32_t load16le(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+// (v ^ s) - s sign extends v at sign bit s; with s == 0 it is a no-op
+static inline int32_t extend(uint32_t v, uint32_t sign)
+{
+    return (int32_t)((v ^ sign) - sign);
+}
+
+static uint32_t read_bits(const uint8_t* payload, uint16_t length, uint32_t bit, uint32_t mask)
+{
+    uint32_t byte = bit >> 3;
+    uint64_t raw = 0;
+
+    for (uint8_t i = 0; i < 5 && byte + i < length; i++) {
+        raw |= (uint64_t)payload[byte + i] << (8 * i);
+    }
+    return (uint32_t)(raw >> (bit & 7)) & mask;
+}
+
+static int add_op(hurricane_hid_decode_plan_t* plan, uint32_t bit_offset, uint8_t size,
+                  uint16_t count, bool is_signed)
+{
+    if (plan->num_values + count > HURRICANE_HID_MAX_DECODE_VALUES) {
+        return HURRICANE_HID_DECODE_ERR_TOO_COMPLEX;
+    }
+
+    uint32_t last_bit = bit_offset + (uint32_t)(count - 1) * size;
+    uint32_t sign = is_signed ? (1u << (size - 1)) : 0;
+
+    // Adjacent fields of the same shape (X next to Y, wheel next to pan)
+    // extend the previous op instead of adding one
+    if (plan->num_ops > 0) {
+        hurricane_hid_decode_op_t* prev = &plan->ops[plan->num_ops - 1];
+        uint8_t prev_bits = prev->kind < HURRICANE_HID_DECODE_WORD ? prev->stride * 8 : prev->stride;
+        if (prev->kind != HURRICANE_HID_DECODE_BITS && prev_bits == size && prev->sign == sign &&
+            prev->bit_offset + (uint32_t)prev->count * size == bit_offset &&
+            (prev->kind != HURRICANE_HID_DECODE_WORD || (last_bit >> 3) + 4 <= plan->read_size ||
+             plan->payload_size <= DECODE_SCRATCH_SIZE)) {
+            prev->count += count;
+            if (prev->kind == HURRICANE_HID_DECODE_WORD && (last_bit >> 3) + 4 > plan->read_size) {
+                plan->read_size = (uint16_t)((last_bit >> 3) + 4);
+            }
+            plan->num_values += count;
+            return 0;
+        }
+    }
+
+    if (plan->num_ops >= HURRICANE_HID_MAX_DECODE_OPS) {
+        return HURRICANE_HID_DECODE_ERR_TOO_COMPLEX;
+    }
+
+    hurricane_hid_decode_op_t* op = &plan->ops[plan->num_ops++];
+
+    op->count = count;
+    op->bit_offset = (uint16_t)bit_offset;
+    op->value_index = plan->num_values;
+    op->mask = size == 32 ? 0xFFFFFFFFu : ((1u << size) - 1);
+    op->sign = sign;
+    op->stride = size;
+
+    if ((bit_offset & 7) == 0 && (size == 8 || size == 16 || size == 32)) {
+        op->kind = size == 8 ? HURRICANE_HID_DECODE_U8 :
+                   size == 16 ? HURRICANE_HID_DECODE_U16 : HURRICANE_HID_DECODE_U32;
+        op->stride = size / 8;
+    } else if (size <= 25 && ((last_bit >> 3) + 4 <= plan->payload_size ||
+                              plan->payload_size <= DECODE_SCRATCH_SIZE)) {
+        op->kind = HURRICANE_HID_DECODE_WORD;
+        if ((last_bit >> 3) + 4 > plan->read_size) {
+            plan->read_size = (uint16_t)((last_bit >> 3) + 4);
+        }
+    } else {
+        op->kind = HURRICANE_HID_DECODE_BITS;
+    }
+
+    plan->num_values += count;
+    return 0;
+}
+
+int hurricane_hid_decode_plan_build(const hurricane_hid_layout_t* layout, uint8_t type,
+                                    uint8_t report_id, hurricane_hid_decode_plan_t* plan)
+{
+    if (!layout || !plan) {
+        return HURRICANE_HID_DECODE_ERR_INVALID_ARG;
+    }
+
+    memset(plan, 0, sizeof(*plan));
+
+    const hurricane_hid_report_info_t* report = hurricane_hid_layout_find_report(layout, type, report_id);
+    if (!report) {
+        return HURRICANE_HID_DECODE_ERR_NO_REPORT;
+    }
+
+    plan->report_id = report_id;
+    plan->type = type;
+    plan->first_field = report->first_field;
+    plan->num_fields = report->num_fields;
+    plan->payload_size = hurricane_hid_report_payload_size(report);
+    plan->read_size = plan->payload_size;
+
+    for (uint8_t i = 0; i < report->num_fields; i++) {
+        const hurricane_hid_field_t* field = &layout->fields[report->first_field + i];
+        int ret;
+
+        plan->field_value[i] = plan->num_values;
+
+        if (field->bit_size == 1 && (field->flags & HURRICANE_HID_FIELD_VARIABLE)) {
+            // Button run: up to 32 buttons per masked word
+            for (uint16_t done = 0; done < field->count; done += 32) {
+                uint16_t n = field->count - done > 32 ? 32 : field->count - done;
+                ret = add_op(plan, field->bit_offset + done, (uint8_t)n, 1, false);
+                if (ret < 0) {
+                    return ret;
+                }
+            }
+            continue;
+        }
+
+        ret = add_op(plan, field->bit_offset, field->bit_size, field->count,
+                     (field->flags & HURRICANE_HID_FIELD_SIGNED) != 0);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+int hurricane_hid_decode(const hurricane_hid_decode_plan_t* plan, const uint8_t* payload,
+                         uint16_t length, int32_t* values)
+{
+    uint8_t scratch[DECODE_SCRATCH_SIZE + 4];
+    bool checked = false;
+
+    if (length < plan->read_size) {
+        if (plan->read_size <= sizeof(scratch)) {
+            memcpy(scratch, payload, length);
+            memset(scratch + length, 0, plan->read_size - length);
+            payload = scratch;
+        } else {
+            checked = true;
+        }
+    }
+
+    for (uint8_t i = 0; i < plan->num_ops; i++) {
+        const hurricane_hid_decode_op_t* op = &plan->ops[i];
+        int32_t* out = &values[op->value_index];
+        uint8_t kind = checked ? HURRICANE_HID_DECODE_BITS : op->kind;
+
+        switch (kind) {
+            case HURRICANE_HID_DECODE_U8: {
+                const uint8_t* p = payload + (op->bit_offset >> 3);
+                for (uint16_t e = 0; e < op->count; e++) {
+                    out[e] = extend(p[e], op->sign);
+                }
+                break;
+            }
+            case HURRICANE_HID_DECODE_U16: {
+                const uint8_t* p = payload + (op->bit_offset >> 3);
+                for (uint16_t e = 0; e < op->count; e++, p += 2) {
+                    out[e] = extend(load16le(p), op->sign);
+                }
+                break;
+            }
+            case HURRICANE_HID_DECODE_U32: {
+                const uint8_t* p = payload + (op->bit_offset >> 3);
+                for (uint16_t e = 0; e < op->count; e++, p += 4) {
+                    out[e] = (int32_t)load32le(p);
+                }
+                break;
+            }
+            case HURRICANE_HID_DECODE_WORD: {
+                uint32_t bit = op->bit_offset;
+                for (uint16_t e = 0; e < op->count; e++, bit += op->stride) {
+                    uint32_t v = (load32le(payload + (bit >> 3)) >> (bit & 7)) & op->mask;
+                    out[e] = extend(v, op->sign);
+                }
+                break;
+            }
+            default: {
+                // Aligned kinds store their stride in bytes
+                uint8_t stride = op->kind < HURRICANE_HID_DECODE_WORD ? op->stride * 8 : op->stride;
+                uint32_t bit = op->bit_offset;
+                for (uint16_t e = 0; e < op->count; e++, bit += stride) {
+                    out[e] = extend(read_bits(payload, length, bit, op->mask), op->sign);
+                }
+                break;
+            }
+        }
+    }
+    return plan->num_values;
+}
+
+int hurricane_hid_decode_get_usage(const hurricane_hid_decode_plan_t* plan, const hurricane_hid_layout_t* layout,
+                                   const int32_t* values, uint16_t usage_page, uint16_t usage, int32_t* value)
+{
+    for (uint8_t i = 0; i < plan->num_fields; i++) {
+        const hurricane_hid_field_t* field = &layout->fields[plan->first_field + i];
+        if (field->usage_page != usage_page || usage < field->usage || usage > field->usage_max) {
+            continue;
+        }
+
+        const int32_t* v = &values[plan->field_value[i]];
+        uint16_t index = usage - field->usage;
+        bool variable = (field->flags & HURRICANE_HID_FIELD_VARIABLE) != 0;
+
+        if (variable && index >= field->count) {
+            continue;
+        }
+        if (!variable) {
+            int32_t raw = (int32_t)index + field->logical_min;
+            *value = 0;
+            for (uint16_t e = 0; e < field->count; e++) {
+                if (v[e] == raw) {
+                    *value = 1;
+                    break;
+                }
+            }
+        } else if (field->bit_size == 1) {
+            *value = (int32_t)(((uint32_t)v[index / 32] >> (index % 32)) & 1);
+        } else {
+            *value = v[index];
+        }
+        return 0;
+    }
+    return HURRICANE_HID_DECODE_ERR_NO_USAGE;
+}
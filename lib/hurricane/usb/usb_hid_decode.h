@@ -0,0 +1,157 @@
+/**
+ * @file usb_hid_decode.h
+ * @brief Specialized decode plans for HID reports
+ *
+ * A decode plan is built once per report from a compiled layout (see
+ * usb_hid_parser.h) and turns every field into the cheapest extraction that
+ * fits it:
+ *  - byte aligned 8/16/32-bit fields become direct little-endian loads,
+ *  - any other field of up to 25 bits is one unaligned 32-bit word load,
+ *    a shift and a mask,
+ *  - a run of 1-bit variable fields (buttons, modifiers) is extracted as a
+ *    single masked word instead of bit by bit,
+ *  - signed fields are sign extended without branches, (v ^ s) - s.
+ * Word loads may run up to 3 bytes past the payload; when the caller's data
+ * is shorter than that, it is copied into a zero padded scratch buffer first.
+ * Only fields wider than 25 bits (or past the end of reports too large for
+ * the scratch buffer) need the byte-by-byte fallback.
+ *
+ * Decoding writes one int32_t per element into a flat value array, except
+ * for 1-bit variable fields, which produce one bitmask per 32 elements
+ * (bit i = element i).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "usb_hid_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Extraction steps per plan
+ */
+#ifndef HURRICANE_HID_MAX_DECODE_OPS
+#define HURRICANE_HID_MAX_DECODE_OPS 32
+#endif
+
+/**
+ * @brief Values a single report decodes into
+ */
+#ifndef HURRICANE_HID_MAX_DECODE_VALUES
+#define HURRICANE_HID_MAX_DECODE_VALUES 64
+#endif
+
+// Plan build results
+#define HURRICANE_HID_DECODE_ERR_INVALID_ARG    -1  /**< NULL argument */
+#define HURRICANE_HID_DECODE_ERR_NO_REPORT      -2  /**< Layout has no such report */
+#define HURRICANE_HID_DECODE_ERR_TOO_COMPLEX    -3  /**< Ops or values limit exceeded */
+#define HURRICANE_HID_DECODE_ERR_NO_USAGE       -4  /**< Report does not carry the usage */
+
+/**
+ * @brief Extraction kernels
+ */
+typedef enum {
+    HURRICANE_HID_DECODE_U8 = 0,    /**< Byte aligned, 8 bits */
+    HURRICANE_HID_DECODE_U16,       /**< Byte aligned, 16 bits */
+    HURRICANE_HID_DECODE_U32,       /**< Byte aligned, 32 bits */
+    HURRICANE_HID_DECODE_WORD,      /**< Unaligned, <= 25 bits, 32-bit load + shift + mask */
+    HURRICANE_HID_DECODE_BITS       /**< Anything else, byte by byte */
+} hurricane_hid_decode_kind_t;
+
+/**
+ * @brief One extraction step producing count consecutive values
+ */
+typedef struct {
+    uint8_t kind;           /**< hurricane_hid_decode_kind_t */
+    uint8_t stride;         /**< Bits between elements (bytes for U8/U16/U32) */
+    uint16_t count;         /**< Values produced */
+    uint16_t bit_offset;    /**< Offset of the first element in the payload */
+    uint16_t value_index;   /**< Where the first value goes */
+    uint32_t mask;          /**< Value mask after shifting */
+    uint32_t sign;          /**< Sign bit of a signed value, 0 if unsigned */
+} hurricane_hid_decode_op_t;
+
+/**
+ * @brief Decode plan of one report
+ */
+typedef struct {
+    hurricane_hid_decode_op_t ops[HURRICANE_HID_MAX_DECODE_OPS];
+    uint8_t num_ops;
+    uint8_t report_id;
+    uint8_t type;
+    uint8_t first_field;                    /**< Layout index of the report's first field */
+    uint8_t num_fields;
+    uint16_t num_values;                    /**< Values written by hurricane_hid_decode() */
+    uint16_t payload_size;                  /**< Payload bytes (without report ID) */
+    uint16_t read_size;                     /**< Bytes the kernels load; shorter input is copied and zero padded */
+    uint16_t field_value[HURRICANE_HID_MAX_FIELDS]; /**< Value index of each field of the report */
+} hurricane_hid_decode_plan_t;
+
+/**
+ * @brief Build the decode plan of one report
+ *
+ * @param layout Compiled report descriptor
+ * @param type hurricane_hid_report_type_t
+ * @param report_id Report ID (0 if the device does not use IDs)
+ * @param plan Output plan
+ * @return 0 on success, negative HURRICANE_HID_DECODE_ERR_* code on failure
+ */
+int hurricane_hid_decode_plan_build(const hurricane_hid_layout_t* layout, uint8_t type,
+                                    uint8_t report_id, hurricane_hid_decode_plan_t* plan);
+
+/**
+ * @brief Decode a report payload
+ *
+ * Payloads shorter than plan->payload_size decode as if zero padded. Passing
+ * at least plan->read_size bytes avoids the internal padding copy.
+ *
+ * @param plan Plan built for the report
+ * @param payload Report payload (after the report ID byte, if any)
+ * @param length Payload length in bytes
+ * @param values Output, plan->num_values entries
+ * @return Number of values written
+ */
+int hurricane_hid_decode(const hurricane_hid_decode_plan_t* plan, const uint8_t* payload,
+                         uint16_t length, int32_t* values);
+
+/**
+ * @brief Read the value of one usage from decoded values
+ *
+ * The inverse of hurricane_hid_pack_set_usage(). Variable fields: the
+ * element carrying the usage (0 or 1 for 1-bit fields). Array fields: 1 if
+ * any slot selects the usage, 0 otherwise.
+ *
+ * @param plan Plan
+ * @param layout Layout the plan was built from
+ * @param values Values decoded with the plan
+ * @param usage_page Usage page
+ * @param usage Usage
+ * @param value Output value
+ * @return 0 on success, HURRICANE_HID_DECODE_ERR_NO_USAGE if the report has no such usage
+ */
+int hurricane_hid_decode_get_usage(const hurricane_hid_decode_plan_t* plan, const hurricane_hid_layout_t* layout,
+                                   const int32_t* values, uint16_t usage_page, uint16_t usage, int32_t* value);
+
+/**
+ * @brief Value index of a layout field in the plan's output
+ *
+ * @param plan Plan
+ * @param layout_field_index Index into hurricane_hid_layout_t::fields
+ * @return Value index, or -1 if the field belongs to another report
+ */
+static inline int hurricane_hid_decode_value_index(const hurricane_hid_decode_plan_t* plan,
+                                                   uint8_t layout_field_index)
+{
+    if (layout_field_index < plan->first_field ||
+        layout_field_index >= plan->first_field + plan->num_fields) {
+        return -1;
+    }
+    return plan->field_value[layout_field_index - plan->first_field];
+}
+
+#ifdef __cplusplus
+}
+#endif
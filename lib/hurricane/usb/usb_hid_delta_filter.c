@@ -0,0 +1,250 @@
+/*
+ * @file usb_hid_delta_filter.c
+ * @brief Change-only forwarding of input reports
+ */
+
+#include "usb_hid_delta_filter.h"
+#include <stddef.h>
+#include <string.h>
+
+static inline uint32_t load32le(const uint8_t* p)
+{
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap32(w);
+#endif
+    return w;
+}
+
+static inline void store32le(uint8_t* p, uint32_t w)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap32(w);
+#endif
+    memcpy(p, &w, sizeof(w));
+}
+
+static hurricane_hid_delta_slot_t* find_slot(hurricane_hid_delta_filter_t* filter, uint8_t report_id)
+{
+    hurricane_hid_delta_slot_t* free_slot = NULL;
+
+    for (int i = 0; i < HURRICANE_HID_DELTA_MAX_REPORTS; i++) {
+        hurricane_hid_delta_slot_t* slot = &filter->slots[i];
+        if (slot->in_use) {
+            if (slot->report_id == report_id) {
+                return slot;
+            }
+        } else if (!free_slot) {
+            free_slot = slot;
+        }
+    }
+
+    if (free_slot) {
+        memset(free_slot, 0, sizeof(*free_slot));
+        free_slot->in_use = true;
+        free_slot->report_id = report_id;
+        free_slot->idle = filter->default_idle;
+    }
+    return free_slot;
+}
+
+// Load a payload as little-endian words, zero padding the last one.
+// Returns the number of words.
+static uint16_t load_words(const uint8_t* payload, uint16_t length, uint32_t* words)
+{
+    uint16_t full = length / 4;
+    uint16_t i;
+
+    for (i = 0; i < full; i++) {
+        words[i] = load32le(payload + 4 * i);
+    }
+    if (length & 3) {
+        uint32_t w = 0;
+        for (uint16_t b = 0; b < (length & 3); b++) {
+            w |= (uint32_t)payload[4 * full + b] << (8 * b);
+        }
+        words[i++] = w;
+    }
+    return i;
+}
+
+void hurricane_hid_delta_filter_init(hurricane_hid_delta_filter_t* filter, bool enabled)
+{
+    if (!filter) {
+        return;
+    }
+
+    memset(filter, 0, sizeof(*filter));
+    filter->enabled = enabled;
+}
+
+int hurricane_hid_delta_filter_use_layout(hurricane_hid_delta_filter_t* filter,
+                                          const hurricane_hid_layout_t* layout)
+{
+    if (!filter || !layout) {
+        return HURRICANE_HID_DELTA_ERR_INVALID_ARG;
+    }
+
+    for (uint8_t r = 0; r < layout->num_reports; r++) {
+        const hurricane_hid_report_info_t* report = &layout->reports[r];
+        if (report->type != HURRICANE_HID_REPORT_INPUT) {
+            continue;
+        }
+
+        hurricane_hid_delta_slot_t* slot = find_slot(filter, report->report_id);
+        if (!slot) {
+            return HURRICANE_HID_DELTA_ERR_NO_SLOT;
+        }
+        memset(slot->relative, 0, sizeof(slot->relative));
+
+        for (uint8_t f = 0; f < report->num_fields; f++) {
+            const hurricane_hid_field_t* field = &layout->fields[report->first_field + f];
+            if (!(field->flags & HURRICANE_HID_FIELD_RELATIVE)) {
+                continue;
+            }
+
+            uint32_t end = field->bit_offset + (uint32_t)field->count * field->bit_size;
+            if (end > HURRICANE_HID_DELTA_MAX_PAYLOAD * 8) {
+                end = HURRICANE_HID_DELTA_MAX_PAYLOAD * 8;
+            }
+            for (uint32_t bit = field->bit_offset; bit < end; bit++) {
+                slot->relative[bit / 32] |= 1u << (bit % 32);
+            }
+        }
+    }
+    return 0;
+}
+
+void hurricane_hid_delta_filter_reset(hurricane_hid_delta_filter_t* filter)
+{
+    if (!filter) {
+        return;
+    }
+
+    for (int i = 0; i < HURRICANE_HID_DELTA_MAX_REPORTS; i++) {
+        filter->slots[i].has_last = false;
+    }
+}
+
+void hurricane_hid_delta_filter_set_idle(hurricane_hid_delta_filter_t* filter,
+                                         uint8_t report_id, uint8_t duration)
+{
+    if (!filter) {
+        return;
+    }
+
+    if (report_id == 0) {
+        filter->default_idle = duration;
+        for (int i = 0; i < HURRICANE_HID_DELTA_MAX_REPORTS; i++) {
+            filter->slots[i].idle = duration;
+        }
+        return;
+    }
+
+    hurricane_hid_delta_slot_t* slot = find_slot(filter, report_id);
+    if (slot) {
+        slot->idle = duration;
+    }
+}
+
+uint8_t hurricane_hid_delta_filter_get_idle(const hurricane_hid_delta_filter_t* filter, uint8_t report_id)
+{
+    if (!filter) {
+        return 0;
+    }
+
+    for (int i = 0; i < HURRICANE_HID_DELTA_MAX_REPORTS; i++) {
+        const hurricane_hid_delta_slot_t* slot = &filter->slots[i];
+        if (slot->in_use && slot->report_id == report_id) {
+            return slot->idle;
+        }
+    }
+    return filter->default_idle;
+}
+
+static bool idle_elapsed(const hurricane_hid_delta_slot_t* slot, uint32_t now_ms)
+{
+    return slot->idle && (uint32_t)(now_ms - slot->last_forward_ms) >= (uint32_t)slot->idle * 4;
+}
+
+int hurricane_hid_delta_filter_submit(hurricane_hid_delta_filter_t* filter,
+                                      uint8_t report_id,
+                                      const uint8_t* payload,
+                                      uint16_t length,
+                                      uint32_t now_ms)
+{
+    if (!filter || (!payload && length > 0)) {
+        return HURRICANE_HID_DELTA_ERR_INVALID_ARG;
+    }
+
+    hurricane_hid_delta_slot_t* slot = NULL;
+    if (length <= HURRICANE_HID_DELTA_MAX_PAYLOAD) {
+        slot = find_slot(filter, report_id);
+    }
+    if (!slot) {
+        // Untracked reports pass through unfiltered
+        filter->forwarded++;
+        return HURRICANE_HID_DELTA_FORWARD;
+    }
+
+    uint32_t words[HURRICANE_HID_DELTA_WORDS];
+    uint16_t num_words = load_words(payload, length, words);
+
+    // Accumulate differences and relative motion without early exits
+    uint32_t diff = (!slot->has_last || slot->length != length) ? 1 : 0;
+    uint32_t motion = 0;
+    for (uint16_t i = 0; i < num_words; i++) {
+        diff |= words[i] ^ slot->last[i];
+        motion |= words[i] & slot->relative[i];
+    }
+
+    if (filter->enabled && !diff && !motion) {
+        if (!idle_elapsed(slot, now_ms)) {
+            filter->suppressed++;
+            return HURRICANE_HID_DELTA_SUPPRESSED;
+        }
+        filter->idle_repeats++;
+    }
+
+    memcpy(slot->last, words, num_words * sizeof(uint32_t));
+    slot->length = length;
+    slot->has_last = true;
+    slot->last_forward_ms = now_ms;
+    filter->forwarded++;
+    return HURRICANE_HID_DELTA_FORWARD;
+}
+
+int hurricane_hid_delta_filter_poll(hurricane_hid_delta_filter_t* filter,
+                                    uint32_t now_ms,
+                                    uint8_t* report_id,
+                                    uint8_t* payload,
+                                    uint16_t size)
+{
+    if (!filter || !report_id || !payload) {
+        return HURRICANE_HID_DELTA_ERR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < HURRICANE_HID_DELTA_MAX_REPORTS; i++) {
+        hurricane_hid_delta_slot_t* slot = &filter->slots[i];
+        if (!slot->in_use || !slot->has_last || slot->length == 0 || slot->length > size ||
+            !idle_elapsed(slot, now_ms)) {
+            continue;
+        }
+
+        // The PC already has the motion; the repeat only restates absolute state
+        uint8_t bytes[HURRICANE_HID_DELTA_WORDS * 4];
+        uint16_t num_words = (slot->length + 3) / 4;
+        for (uint16_t w = 0; w < num_words; w++) {
+            slot->last[w] &= ~slot->relative[w];
+            store32le(&bytes[4 * w], slot->last[w]);
+        }
+        memcpy(payload, bytes, slot->length);
+
+        *report_id = slot->report_id;
+        slot->last_forward_ms = now_ms;
+        filter->idle_repeats++;
+        return slot->length;
+    }
+    return 0;
+}
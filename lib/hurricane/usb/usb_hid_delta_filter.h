@@ -0,0 +1,177 @@
+/**
+ * @file usb_hid_delta_filter.h
+ * @brief Change-only forwarding of input reports
+ *
+ * Many keyboards and some mice resend identical input reports at their own
+ * idle rate. Forwarding each of them costs a device-side IN transaction and
+ * can push useful reports out of the queue. A delta filter sits in front of
+ * one device-side pipe and remembers the last report forwarded per report
+ * ID; a report is suppressed when its payload is unchanged (compared a
+ * 32-bit word at a time) and it carries no relative motion.
+ *
+ * The filter also keeps the device-side SET_IDLE contract with the PC, which
+ * is independent of whatever idle rate the physical device runs at:
+ *  - duration 0 (indefinite): only changes are reported,
+ *  - duration N: an unchanged report is forwarded once N * 4 ms have passed
+ *    since the last one, and hurricane_hid_delta_filter_poll() produces the
+ *    repeat itself when the physical device stays silent.
+ * Repeats never replay relative motion: relative fields (learned from the
+ * compiled report descriptor) are zeroed in reports produced by the poll.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_hid_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Report IDs tracked per filter
+ */
+#ifndef HURRICANE_HID_DELTA_MAX_REPORTS
+#define HURRICANE_HID_DELTA_MAX_REPORTS 8
+#endif
+
+/**
+ * @brief Largest tracked payload (excluding the report ID byte)
+ *
+ * Longer reports are always forwarded.
+ */
+#ifndef HURRICANE_HID_DELTA_MAX_PAYLOAD
+#define HURRICANE_HID_DELTA_MAX_PAYLOAD 64
+#endif
+
+#define HURRICANE_HID_DELTA_WORDS ((HURRICANE_HID_DELTA_MAX_PAYLOAD + 3) / 4)
+
+// Errors
+#define HURRICANE_HID_DELTA_ERR_INVALID_ARG -1  /**< NULL argument */
+#define HURRICANE_HID_DELTA_ERR_NO_SLOT     -2  /**< More report IDs than HURRICANE_HID_DELTA_MAX_REPORTS */
+
+/**
+ * @brief Result of hurricane_hid_delta_filter_submit()
+ */
+typedef enum {
+    HURRICANE_HID_DELTA_FORWARD = 0,    /**< Changed (or idle period over): send it */
+    HURRICANE_HID_DELTA_SUPPRESSED      /**< Same as the last report forwarded: drop it */
+} hurricane_hid_delta_result_t;
+
+/**
+ * @brief Per report ID filter state
+ */
+typedef struct {
+    uint32_t last[HURRICANE_HID_DELTA_WORDS];       /**< Last forwarded payload, zero padded */
+    uint32_t relative[HURRICANE_HID_DELTA_WORDS];   /**< Bits of relative fields */
+    uint32_t last_forward_ms;                       /**< Time of the last forward */
+    uint16_t length;                                /**< Length of last */
+    uint8_t report_id;                              /**< Report ID (0 = no ID) */
+    uint8_t idle;                                   /**< SET_IDLE duration, 4 ms units, 0 = indefinite */
+    bool in_use;
+    bool has_last;                                  /**< last is valid */
+} hurricane_hid_delta_slot_t;
+
+/**
+ * @brief Delta filter of one device-side pipe
+ */
+typedef struct {
+    hurricane_hid_delta_slot_t slots[HURRICANE_HID_DELTA_MAX_REPORTS];
+    uint8_t default_idle;       /**< Idle duration for report IDs not seen yet */
+    bool enabled;               /**< false: forward everything (idle repeats still apply) */
+    uint32_t forwarded;         /**< Reports let through */
+    uint32_t suppressed;        /**< Reports dropped as unchanged */
+    uint32_t idle_repeats;      /**< Unchanged reports sent because the idle period ran out */
+} hurricane_hid_delta_filter_t;
+
+/**
+ * @brief Initialize a filter
+ *
+ * @param filter Filter instance
+ * @param enabled Suppress unchanged reports
+ */
+void hurricane_hid_delta_filter_init(hurricane_hid_delta_filter_t* filter, bool enabled);
+
+/**
+ * @brief Learn which bits carry relative values from a compiled descriptor
+ *
+ * Reports whose relative fields are non-zero are never suppressed, so mouse
+ * motion survives even when two consecutive reports are byte-identical.
+ * Without a layout every report is treated as absolute.
+ *
+ * @param filter Filter instance
+ * @param layout Descriptor of the reports sent through the filter
+ * @return 0 on success, negative HURRICANE_HID_DELTA_ERR_* code on failure
+ */
+int hurricane_hid_delta_filter_use_layout(hurricane_hid_delta_filter_t* filter,
+                                          const hurricane_hid_layout_t* layout);
+
+/**
+ * @brief Forget the last forwarded reports (e.g. after a bus reset)
+ *
+ * Idle durations and relative masks are kept.
+ *
+ * @param filter Filter instance
+ */
+void hurricane_hid_delta_filter_reset(hurricane_hid_delta_filter_t* filter);
+
+/**
+ * @brief Apply a SET_IDLE request from the PC
+ *
+ * @param filter Filter instance
+ * @param report_id Report ID from wValue; 0 applies to all reports
+ * @param duration Duration from wValue in 4 ms units, 0 = indefinite
+ */
+void hurricane_hid_delta_filter_set_idle(hurricane_hid_delta_filter_t* filter,
+                                         uint8_t report_id, uint8_t duration);
+
+/**
+ * @brief Current idle duration, for answering GET_IDLE
+ *
+ * @param filter Filter instance
+ * @param report_id Report ID from wValue
+ * @return Duration in 4 ms units
+ */
+uint8_t hurricane_hid_delta_filter_get_idle(const hurricane_hid_delta_filter_t* filter, uint8_t report_id);
+
+/**
+ * @brief Decide whether an input report has to be forwarded
+ *
+ * A forwarded report becomes the new reference for its report ID.
+ *
+ * @param filter Filter instance
+ * @param report_id Report ID (0 if the descriptor declares none)
+ * @param payload Report payload without the report ID byte
+ * @param length Payload length
+ * @param now_ms Current time in milliseconds
+ * @return hurricane_hid_delta_result_t value, or negative error code
+ */
+int hurricane_hid_delta_filter_submit(hurricane_hid_delta_filter_t* filter,
+                                      uint8_t report_id,
+                                      const uint8_t* payload,
+                                      uint16_t length,
+                                      uint32_t now_ms);
+
+/**
+ * @brief Produce a repeat for a report whose idle period ran out
+ *
+ * Call from the main loop; returns at most one report per call. Relative
+ * fields of the repeat are zero.
+ *
+ * @param filter Filter instance
+ * @param now_ms Current time in milliseconds
+ * @param report_id Output: report ID of the repeat
+ * @param payload Output: payload without the report ID byte
+ * @param size Size of payload
+ * @return Payload length, 0 if nothing is due
+ */
+int hurricane_hid_delta_filter_poll(hurricane_hid_delta_filter_t* filter,
+                                    uint32_t now_ms,
+                                    uint8_t* report_id,
+                                    uint8_t* payload,
+                                    uint16_t size);
+
+#ifdef __cplusplus
+}
+#endif
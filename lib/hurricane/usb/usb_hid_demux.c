@@ -0,0 +1,102 @@
+/*
+ * @file usb_hid_demux.c
+ * @brief Report-ID demultiplexer for multi-report devices
+ */
+
+#include "usb_hid_demux.h"
+#include <stddef.h>
+#include <string.h>
+
+void hurricane_hid_demux_init(hurricane_hid_demux_t* demux, const hurricane_hid_layout_t* layout)
+{
+    if (!demux) {
+        return;
+    }
+
+    memset(demux, 0, sizeof(*demux));
+    memset(demux->index, HURRICANE_HID_DEMUX_NO_ROUTE, sizeof(demux->index));
+    demux->uses_report_ids = layout && layout->uses_report_ids;
+}
+
+int hurricane_hid_demux_add_route(hurricane_hid_demux_t* demux, uint8_t report_id,
+                                  const hurricane_hid_demux_route_t* route)
+{
+    if (!demux || !route || (!route->decode && (route->transform || route->pack)) ||
+        (!demux->uses_report_ids && report_id != 0)) {
+        return HURRICANE_HID_DEMUX_ERR_INVALID_ARG;
+    }
+
+    uint8_t n = demux->index[report_id];
+    if (n == HURRICANE_HID_DEMUX_NO_ROUTE) {
+        if (demux->num_routes >= HURRICANE_HID_DEMUX_MAX_ROUTES) {
+            return HURRICANE_HID_DEMUX_ERR_FULL;
+        }
+        n = demux->num_routes++;
+        demux->index[report_id] = n;
+    }
+
+    demux->routes[n] = *route;
+    return n;
+}
+
+int hurricane_hid_demux_dispatch(hurricane_hid_demux_t* demux, const uint8_t* report, uint16_t length,
+                                 hurricane_hid_demux_output_t* out)
+{
+    if (!demux || !report || !out || (demux->uses_report_ids && length == 0)) {
+        return HURRICANE_HID_DEMUX_ERR_INVALID_ARG;
+    }
+
+    uint8_t header = demux->uses_report_ids ? 1 : 0;
+    uint8_t report_id = header ? report[0] : 0;
+    uint8_t n = demux->index[report_id];
+    if (n == HURRICANE_HID_DEMUX_NO_ROUTE) {
+        demux->unrouted++;
+        return HURRICANE_HID_DEMUX_ERR_NO_ROUTE;
+    }
+
+    const hurricane_hid_demux_route_t* route = &demux->routes[n];
+    const uint8_t* payload = report + header;
+    uint16_t payload_length = length - header;
+
+    out->pipe = route->pipe;
+    out->report_id = report_id;
+    out->route = route;
+    out->values = NULL;
+
+    if (route->decode) {
+        hurricane_hid_decode(route->decode, payload, payload_length, demux->values);
+        if (route->transform && hurricane_hid_transform_active(route->transform)) {
+            hurricane_hid_transform_run(route->transform, demux->values);
+        }
+        out->values = demux->values;
+    }
+
+    if (route->pack) {
+        int packed = hurricane_hid_pack(route->pack, demux->values, demux->buffer, sizeof(demux->buffer));
+        if (packed < 0) {
+            return HURRICANE_HID_DEMUX_ERR_TOO_LONG;
+        }
+        out->data = demux->buffer;
+        out->length = (uint16_t)packed;
+    } else if (!header) {
+        out->data = report;
+        out->length = length;
+    } else if (route->flags & HURRICANE_HID_DEMUX_REWRITE_ID) {
+        if (length > sizeof(demux->buffer)) {
+            return HURRICANE_HID_DEMUX_ERR_TOO_LONG;
+        }
+        demux->buffer[0] = route->out_id;
+        memcpy(&demux->buffer[1], payload, payload_length);
+        out->data = demux->buffer;
+        out->length = length;
+    } else if (route->flags & HURRICANE_HID_DEMUX_STRIP_ID) {
+        out->data = payload;
+        out->length = payload_length;
+    } else {
+        out->data = report;
+        out->length = length;
+    }
+
+    demux->dispatched++;
+    return route->pipe;
+}
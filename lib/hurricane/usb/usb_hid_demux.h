@@ -0,0 +1,142 @@
+/**
+ * @file usb_hid_demux.h
+ * @brief Report-ID demultiplexer for multi-report devices
+ *
+ * Devices that combine several functions on one interface (mouse, consumer
+ * keys, vendor reports, ...) deliver all of them on a single endpoint and
+ * tell them apart by the leading report ID byte. The demultiplexer routes
+ * each report to a device-side pipe with one table lookup:
+ *
+ *   index[report_id] -> route -> { pipe, ID handling, decode/transform/pack }
+ *
+ * The index is a 256-byte array of route numbers rather than 256 routes, so
+ * a demux with the default 16 routes stays well under 1 KB. When the parsed
+ * descriptor declares no report IDs, every report uses the route of ID 0
+ * and the first byte is payload.
+ *
+ * Raw routes hand out the report (optionally without, or with a rewritten,
+ * ID byte) without copying when possible. Routes with a decode plan also
+ * produce the decoded values, run an optional transform on them and, with a
+ * pack plan, repack them for the device-side descriptor.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_hid_parser.h"
+#include "usb_hid_decode.h"
+#include "usb_hid_pack.h"
+#include "usb_hid_transform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Routes per demultiplexer
+ */
+#ifndef HURRICANE_HID_DEMUX_MAX_ROUTES
+#define HURRICANE_HID_DEMUX_MAX_ROUTES 16
+#endif
+
+/**
+ * @brief Largest report handed out after rewriting or repacking, including the ID byte
+ */
+#ifndef HURRICANE_HID_DEMUX_MAX_REPORT
+#define HURRICANE_HID_DEMUX_MAX_REPORT 65
+#endif
+
+/**
+ * @brief Index entry of report IDs without a route
+ */
+#define HURRICANE_HID_DEMUX_NO_ROUTE 0xFF
+
+// Errors
+#define HURRICANE_HID_DEMUX_ERR_INVALID_ARG -1  /**< NULL argument or inconsistent route */
+#define HURRICANE_HID_DEMUX_ERR_FULL        -2  /**< HURRICANE_HID_DEMUX_MAX_ROUTES reached */
+#define HURRICANE_HID_DEMUX_ERR_NO_ROUTE    -3  /**< Report ID is not routed; drop the report */
+#define HURRICANE_HID_DEMUX_ERR_TOO_LONG    -4  /**< Rewritten or repacked report does not fit */
+
+// Route flags (raw routes; repacked reports carry the pack plan's ID)
+#define HURRICANE_HID_DEMUX_STRIP_ID    0x01    /**< Hand out the payload without the ID byte */
+#define HURRICANE_HID_DEMUX_REWRITE_ID  0x02    /**< Replace the ID byte with out_id */
+
+/**
+ * @brief Where the reports of one report ID go
+ */
+typedef struct {
+    uint8_t pipe;                               /**< Device-side target; meaning is up to the caller */
+    uint8_t flags;                              /**< HURRICANE_HID_DEMUX_* */
+    uint8_t out_id;                             /**< Report ID for HURRICANE_HID_DEMUX_REWRITE_ID */
+    const hurricane_hid_decode_plan_t* decode;  /**< Optional: decode into values */
+    hurricane_hid_transform_t* transform;       /**< Optional, requires decode */
+    const hurricane_hid_pack_plan_t* pack;      /**< Optional, requires decode: repack the values */
+} hurricane_hid_demux_route_t;
+
+/**
+ * @brief One routed report
+ */
+typedef struct {
+    uint8_t pipe;                               /**< Route target */
+    uint8_t report_id;                          /**< Report ID as received (0 = none) */
+    const uint8_t* data;                        /**< Report for the device side */
+    uint16_t length;                            /**< Length of data */
+    const int32_t* values;                      /**< Decoded values, NULL for raw routes */
+    const hurricane_hid_demux_route_t* route;
+} hurricane_hid_demux_output_t;
+
+/**
+ * @brief Demultiplexer of one host-side interface
+ */
+typedef struct {
+    uint8_t index[256];                         /**< Report ID -> route, HURRICANE_HID_DEMUX_NO_ROUTE if none */
+    hurricane_hid_demux_route_t routes[HURRICANE_HID_DEMUX_MAX_ROUTES];
+    uint8_t num_routes;
+    bool uses_report_ids;                       /**< First byte of every report is its ID */
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];    /**< Decoded values of the last report */
+    uint8_t buffer[HURRICANE_HID_DEMUX_MAX_REPORT];     /**< Rewritten or repacked report */
+    uint32_t dispatched;                        /**< Reports routed */
+    uint32_t unrouted;                          /**< Reports dropped for lack of a route */
+} hurricane_hid_demux_t;
+
+/**
+ * @brief Initialize a demultiplexer with no routes
+ *
+ * @param demux Demultiplexer
+ * @param layout Compiled descriptor of the host-side interface; decides
+ *               whether reports start with an ID (NULL = no IDs)
+ */
+void hurricane_hid_demux_init(hurricane_hid_demux_t* demux, const hurricane_hid_layout_t* layout);
+
+/**
+ * @brief Route the reports of one report ID
+ *
+ * Adding a route for an ID that already has one replaces it.
+ *
+ * @param demux Demultiplexer
+ * @param report_id Report ID (0 if the descriptor declares none)
+ * @param route Route, copied
+ * @return Route number on success, negative HURRICANE_HID_DEMUX_ERR_* code on failure
+ */
+int hurricane_hid_demux_add_route(hurricane_hid_demux_t* demux, uint8_t report_id,
+                                  const hurricane_hid_demux_route_t* route);
+
+/**
+ * @brief Route one report received on the host side
+ *
+ * out->data points into report (raw routes without rewrite) or into the
+ * demultiplexer's buffer, and stays valid until the next dispatch.
+ *
+ * @param demux Demultiplexer
+ * @param report Report as received, including the ID byte if the descriptor uses IDs
+ * @param length Report length
+ * @param out Routed report
+ * @return Pipe of the route, or negative HURRICANE_HID_DEMUX_ERR_* code
+ */
+int hurricane_hid_demux_dispatch(hurricane_hid_demux_t* demux, const uint8_t* report, uint16_t length,
+                                 hurricane_hid_demux_output_t* out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,241 @@
+/*
+ * @file usb_hid_events.c
+ * @brief Input event stream from decoded keyboard and mouse reports
+ */
+
+#include "usb_hid_events.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PAGE_KEYBOARD   0x07
+#define PAGE_BUTTON     0x09
+#define KEY_ROLLOVER    0x01
+#define KEY_FIRST       0x04    // 0x01-0x03 are error codes
+
+// Decoder field kinds
+enum {
+    EVENT_FIELD_KEY_BITS = 0,   // 1-bit keyboard usages, one mask per 32 elements
+    EVENT_FIELD_KEY_ARRAY,      // keyboard usage array
+    EVENT_FIELD_BUTTONS,        // 1-bit buttons
+    EVENT_FIELD_RELATIVE,       // relative axes
+    EVENT_FIELD_ABSOLUTE        // absolute axes
+};
+
+void hurricane_hid_event_ring_init(hurricane_hid_event_ring_t* ring)
+{
+    memset(ring, 0, sizeof(*ring));
+}
+
+bool hurricane_hid_event_ring_pop(hurricane_hid_event_ring_t* ring, hurricane_hid_event_t* event)
+{
+    uint16_t tail = ring->tail;
+
+    // Acquire pairs with the producer's release: the slot is read only after it was written
+    if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    *event = ring->events[tail & (HURRICANE_HID_EVENT_RING_SIZE - 1)];
+    __atomic_store_n(&ring->tail, (uint16_t)(tail + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+static void push(hurricane_hid_event_decoder_t* decoder, hurricane_hid_event_ring_t* ring, uint8_t type,
+                 uint16_t usage_page, uint16_t usage, int32_t value, uint32_t time)
+{
+    uint16_t head = ring->head;
+
+    if ((uint16_t)(head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) >= HURRICANE_HID_EVENT_RING_SIZE) {
+        ring->dropped++;
+        return;
+    }
+
+    hurricane_hid_event_t* event = &ring->events[head & (HURRICANE_HID_EVENT_RING_SIZE - 1)];
+    event->time = time;
+    event->value = value;
+    event->usage_page = usage_page;
+    event->usage = usage;
+    event->type = type;
+    event->source = decoder->source;
+    __atomic_store_n(&ring->head, (uint16_t)(head + 1), __ATOMIC_RELEASE);
+}
+
+int hurricane_hid_event_decoder_init(hurricane_hid_event_decoder_t* decoder, const hurricane_hid_layout_t* layout,
+                                     const hurricane_hid_decode_plan_t* plan, uint8_t source)
+{
+    if (!decoder || !layout || !plan) {
+        return HURRICANE_HID_EVENT_ERR_INVALID_ARG;
+    }
+
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->layout = layout;
+    decoder->source = source;
+
+    for (uint8_t i = 0; i < plan->num_fields; i++) {
+        const hurricane_hid_field_t* field = &layout->fields[plan->first_field + i];
+        hurricane_hid_event_field_t f = {
+            .layout_field = plan->first_field + i,
+            .index = plan->field_value[i],
+            .count = field->count,
+            .usage = field->usage,
+            .min = field->logical_min
+        };
+
+        if (!(field->flags & HURRICANE_HID_FIELD_VARIABLE)) {
+            if (field->usage_page != PAGE_KEYBOARD) {
+                continue;
+            }
+            f.kind = EVENT_FIELD_KEY_ARRAY;
+        } else if (field->bit_size == 1) {
+            if (field->usage_page == PAGE_KEYBOARD && field->usage < 256) {
+                f.kind = EVENT_FIELD_KEY_BITS;
+            } else if (field->usage_page == PAGE_BUTTON && field->usage >= 1 && field->usage <= 32) {
+                f.kind = EVENT_FIELD_BUTTONS;
+            } else {
+                continue;
+            }
+            f.count = (field->count + 31) / 32;
+        } else {
+            f.kind = (field->flags & HURRICANE_HID_FIELD_RELATIVE) ? EVENT_FIELD_RELATIVE : EVENT_FIELD_ABSOLUTE;
+        }
+
+        if (decoder->num_fields == HURRICANE_HID_EVENT_MAX_FIELDS) {
+            printf("[hid_events] Report has more than %u fields\n", HURRICANE_HID_EVENT_MAX_FIELDS);
+            return HURRICANE_HID_EVENT_ERR_TOO_COMPLEX;
+        }
+        decoder->has_keys |= (f.kind == EVENT_FIELD_KEY_BITS || f.kind == EVENT_FIELD_KEY_ARRAY);
+        decoder->fields[decoder->num_fields++] = f;
+    }
+    return 0;
+}
+
+// OR a mask of 32 consecutive usages starting at base into a bitmap
+static void or_bits(uint32_t* bitmap, uint16_t words, uint32_t base, uint32_t mask)
+{
+    uint32_t word = base / 32;
+    uint32_t shift = base % 32;
+
+    if (word < words) {
+        bitmap[word] |= mask << shift;
+    }
+    if (shift && word + 1 < words) {
+        bitmap[word + 1] |= mask >> (32 - shift);
+    }
+}
+
+// Emit one event per bit that differs, lowest usage first
+static int emit_changes(hurricane_hid_event_decoder_t* decoder, hurricane_hid_event_ring_t* ring,
+                        uint32_t changed, uint32_t now, uint32_t base, uint16_t usage_page,
+                        uint8_t down_type, uint32_t time)
+{
+    int events = 0;
+
+    while (changed) {
+        uint32_t bit = (uint32_t)__builtin_ctz(changed);
+        bool down = (now >> bit) & 1u;
+        push(decoder, ring, down ? down_type : (uint8_t)(down_type + 1), usage_page,
+             (uint16_t)(base + bit), 0, time);
+        changed &= changed - 1;
+        events++;
+    }
+    return events;
+}
+
+int hurricane_hid_event_decoder_feed(hurricane_hid_event_decoder_t* decoder, const int32_t* values,
+                                     uint32_t time, hurricane_hid_event_ring_t* ring)
+{
+    uint32_t keys[HURRICANE_HID_EVENT_KEY_WORDS] = { 0 };
+    uint32_t buttons = 0;
+    bool rollover = false;
+    int events = 0;
+
+    if (!decoder || !values || !ring) {
+        return HURRICANE_HID_EVENT_ERR_INVALID_ARG;
+    }
+
+    for (uint8_t i = 0; i < decoder->num_fields; i++) {
+        const hurricane_hid_event_field_t* f = &decoder->fields[i];
+        const int32_t* v = &values[f->index];
+
+        switch (f->kind) {
+            case EVENT_FIELD_KEY_BITS:
+                for (uint16_t w = 0; w < f->count; w++) {
+                    or_bits(keys, HURRICANE_HID_EVENT_KEY_WORDS, f->usage + 32u * w, (uint32_t)v[w]);
+                }
+                break;
+            case EVENT_FIELD_KEY_ARRAY: {
+                uint16_t usage_max = decoder->layout->fields[f->layout_field].usage_max;
+                for (uint16_t e = 0; e < f->count; e++) {
+                    int32_t usage = v[e] - f->min + f->usage;
+                    if (usage == KEY_ROLLOVER) {
+                        rollover = true;
+                    } else if (usage >= KEY_FIRST && usage <= usage_max && usage < 256) {
+                        keys[usage / 32] |= 1u << (usage % 32);
+                    }
+                }
+                break;
+            }
+            case EVENT_FIELD_BUTTONS:
+                or_bits(&buttons, 1, f->usage - 1u, (uint32_t)v[0]);
+                break;
+            case EVENT_FIELD_RELATIVE:
+            case EVENT_FIELD_ABSOLUTE: {
+                const hurricane_hid_field_t* field = &decoder->layout->fields[f->layout_field];
+                for (uint16_t e = 0; e < f->count; e++) {
+                    if (f->kind == EVENT_FIELD_RELATIVE ? v[e] == 0 : v[e] == decoder->last[f->index + e]) {
+                        continue;
+                    }
+                    decoder->last[f->index + e] = v[e];
+                    push(decoder, ring, HURRICANE_HID_EVENT_AXIS, field->usage_page,
+                         (uint16_t)(field->usage + e), v[e], time);
+                    events++;
+                }
+                break;
+            }
+        }
+    }
+
+    // Keys (phantom state during rollover: keep what was held)
+    if (decoder->has_keys && !rollover) {
+        for (uint8_t w = 0; w < HURRICANE_HID_EVENT_KEY_WORDS; w++) {
+            uint32_t changed = keys[w] ^ decoder->keys[w];
+            if (changed) {
+                events += emit_changes(decoder, ring, changed, keys[w], 32u * w, PAGE_KEYBOARD,
+                                       HURRICANE_HID_EVENT_KEY_DOWN, time);
+                decoder->keys[w] = keys[w];
+            }
+        }
+    }
+
+    if (buttons != decoder->buttons) {
+        events += emit_changes(decoder, ring, buttons ^ decoder->buttons, buttons, 1, PAGE_BUTTON,
+                               HURRICANE_HID_EVENT_BUTTON_DOWN, time);
+        decoder->buttons = buttons;
+    }
+    return events;
+}
+
+int hurricane_hid_event_decoder_release_all(hurricane_hid_event_decoder_t* decoder, uint32_t time,
+                                            hurricane_hid_event_ring_t* ring)
+{
+    int events = 0;
+
+    if (!decoder || !ring) {
+        return HURRICANE_HID_EVENT_ERR_INVALID_ARG;
+    }
+
+    for (uint8_t w = 0; w < HURRICANE_HID_EVENT_KEY_WORDS; w++) {
+        if (decoder->keys[w]) {
+            events += emit_changes(decoder, ring, decoder->keys[w], 0, 32u * w, PAGE_KEYBOARD,
+                                   HURRICANE_HID_EVENT_KEY_DOWN, time);
+            decoder->keys[w] = 0;
+        }
+    }
+    if (decoder->buttons) {
+        events += emit_changes(decoder, ring, decoder->buttons, 0, 1, PAGE_BUTTON,
+                               HURRICANE_HID_EVENT_BUTTON_DOWN, time);
+        decoder->buttons = 0;
+    }
+    memset(decoder->last, 0, sizeof(decoder->last));
+    return events;
+}
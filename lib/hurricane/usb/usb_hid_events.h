@@ -0,0 +1,183 @@
+/**
+ * @file usb_hid_events.h
+ * @brief Input event stream from decoded keyboard and mouse reports
+ *
+ * Reports carry state, applications usually want changes: "A pressed",
+ * "button 2 released", "wheel -1". The event decoder keeps the state of one
+ * report as bitmaps (256 keyboard usages, 32 buttons), builds the new
+ * bitmaps from each decoded report a word at a time, and XORs them against
+ * the old ones. Only the bits that differ are visited, so a report costs
+ * O(changed keys) events no matter whether the keyboard reports a 6KRO
+ * array, an NKRO bitfield, or both.
+ *
+ * Events go into a fixed-size ring with a timestamp from the caller's
+ * clock. The ring has one producer and one consumer (e.g. the host task
+ * and the application loop); when it is full new events are dropped and
+ * counted.
+ *
+ * Usages handled:
+ *  - keys: Keyboard/Keypad page (0x07), array or 1-bit variable fields;
+ *    a report in ErrorRollOver (usage 0x01 in an array) keeps the previous
+ *    key state,
+ *  - buttons 1-32: Button page (0x09), 1-bit variable fields,
+ *  - axes: every other multi-bit variable field; relative axes produce an
+ *    event for each non-zero delta, absolute axes when the value changes.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_hid_parser.h"
+#include "usb_hid_decode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Events per ring, a power of two
+ */
+#ifndef HURRICANE_HID_EVENT_RING_SIZE
+#define HURRICANE_HID_EVENT_RING_SIZE 64
+#endif
+
+/**
+ * @brief Fields per decoded report
+ */
+#ifndef HURRICANE_HID_EVENT_MAX_FIELDS
+#define HURRICANE_HID_EVENT_MAX_FIELDS 16
+#endif
+
+#define HURRICANE_HID_EVENT_KEY_WORDS 8     /**< 256 key usages */
+
+// Errors
+#define HURRICANE_HID_EVENT_ERR_INVALID_ARG -1  /**< NULL argument */
+#define HURRICANE_HID_EVENT_ERR_TOO_COMPLEX -2  /**< More than HURRICANE_HID_EVENT_MAX_FIELDS fields */
+
+/**
+ * @brief Event types
+ */
+typedef enum {
+    HURRICANE_HID_EVENT_KEY_DOWN = 0,   /**< usage: key code */
+    HURRICANE_HID_EVENT_KEY_UP,
+    HURRICANE_HID_EVENT_BUTTON_DOWN,    /**< usage: button number */
+    HURRICANE_HID_EVENT_BUTTON_UP,
+    HURRICANE_HID_EVENT_AXIS            /**< usage_page/usage: axis, value: delta or position */
+} hurricane_hid_event_type_t;
+
+/**
+ * @brief One input event
+ */
+typedef struct {
+    uint32_t time;                  /**< Caller's timestamp of the report */
+    int32_t value;                  /**< Axis delta (relative) or position (absolute) */
+    uint16_t usage_page;
+    uint16_t usage;
+    uint8_t type;                   /**< hurricane_hid_event_type_t */
+    uint8_t source;                 /**< Decoder that produced it */
+} hurricane_hid_event_t;
+
+/**
+ * @brief Single-producer, single-consumer event ring
+ */
+typedef struct {
+    hurricane_hid_event_t events[HURRICANE_HID_EVENT_RING_SIZE];
+    volatile uint16_t head;         /**< Next slot written */
+    volatile uint16_t tail;         /**< Next slot read */
+    uint32_t dropped;               /**< Events lost to a full ring */
+} hurricane_hid_event_ring_t;
+
+/**
+ * @brief How the decoder reads one field
+ */
+typedef struct {
+    uint8_t kind;                   /**< Internal field kind */
+    uint8_t layout_field;
+    uint16_t index;                 /**< First value index */
+    uint16_t count;                 /**< Elements */
+    uint16_t usage;                 /**< Usage of the first element (bitfields), usage minimum (arrays) */
+    int32_t min;                    /**< Arrays: logical minimum */
+} hurricane_hid_event_field_t;
+
+/**
+ * @brief Event decoder of one report
+ */
+typedef struct {
+    const hurricane_hid_layout_t* layout;
+    hurricane_hid_event_field_t fields[HURRICANE_HID_EVENT_MAX_FIELDS];
+    uint8_t num_fields;
+    uint8_t source;
+    bool has_keys;
+    uint32_t keys[HURRICANE_HID_EVENT_KEY_WORDS];   /**< Key state, bit n = usage n */
+    uint32_t buttons;                               /**< Button state, bit n = button n + 1 */
+    int32_t last[HURRICANE_HID_MAX_DECODE_VALUES];  /**< Absolute axes: last value */
+} hurricane_hid_event_decoder_t;
+
+/**
+ * @brief Initialize an empty ring
+ */
+void hurricane_hid_event_ring_init(hurricane_hid_event_ring_t* ring);
+
+/**
+ * @brief Take the oldest event
+ *
+ * @return false if the ring is empty
+ */
+bool hurricane_hid_event_ring_pop(hurricane_hid_event_ring_t* ring, hurricane_hid_event_t* event);
+
+/**
+ * @brief Number of events waiting
+ */
+static inline uint16_t hurricane_hid_event_ring_count(const hurricane_hid_event_ring_t* ring)
+{
+    uint16_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint16_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    return (uint16_t)(head - tail);
+}
+
+/**
+ * @brief Prepare a decoder for one report
+ *
+ * @param decoder Decoder
+ * @param layout Layout of the device
+ * @param plan Decode plan of the report
+ * @param source Tag copied into every event (e.g. the device index)
+ * @return 0 on success, negative HURRICANE_HID_EVENT_ERR_* code on failure
+ */
+int hurricane_hid_event_decoder_init(hurricane_hid_event_decoder_t* decoder, const hurricane_hid_layout_t* layout,
+                                     const hurricane_hid_decode_plan_t* plan, uint8_t source);
+
+/**
+ * @brief Turn a decoded report into events
+ *
+ * @param decoder Decoder
+ * @param values Values decoded with the plan the decoder was built for
+ * @param time Timestamp for the events
+ * @param ring Ring receiving the events
+ * @return Number of events produced (including dropped ones)
+ */
+int hurricane_hid_event_decoder_feed(hurricane_hid_event_decoder_t* decoder, const int32_t* values,
+                                     uint32_t time, hurricane_hid_event_ring_t* ring);
+
+/**
+ * @brief Release everything held, e.g. when the device goes away
+ *
+ * Produces the up events a report with nothing pressed would produce.
+ *
+ * @return Number of events produced
+ */
+int hurricane_hid_event_decoder_release_all(hurricane_hid_event_decoder_t* decoder, uint32_t time,
+                                            hurricane_hid_event_ring_t* ring);
+
+/**
+ * @brief Current state of a key (Keyboard/Keypad usage)
+ */
+static inline bool hurricane_hid_event_key_down(const hurricane_hid_event_decoder_t* decoder, uint8_t usage)
+{
+    return (decoder->keys[usage / 32] >> (usage % 32)) & 1u;
+}
+
+#ifdef __cplusplus
+}
+#endif
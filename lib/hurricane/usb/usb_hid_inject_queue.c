@@ -0,0 +1,95 @@
+/*
+ * @file usb_hid_inject_queue.c
+ * @brief Multi-producer, lock-free injection queue
+ */
+
+#include "usb_hid_inject_queue.h"
+#include <stddef.h>
+
+#define QUEUE_MASK (HURRICANE_INJECT_QUEUE_SIZE - 1u)
+
+_Static_assert((HURRICANE_INJECT_QUEUE_SIZE & QUEUE_MASK) == 0, "HURRICANE_INJECT_QUEUE_SIZE must be a power of two");
+
+// Slot sequence numbers, for the slot at position pos (mod size):
+//   seq == pos           free, the producer claiming pos may write it
+//   seq == pos + 1       published, the consumer at pos may read it
+//   seq == pos + size    read, free again for the producer of the next lap
+
+void hurricane_inject_queue_init(hurricane_inject_queue_t* queue)
+{
+    if (!queue) {
+        return;
+    }
+    for (unsigned int i = 0; i < HURRICANE_INJECT_QUEUE_SIZE; i++) {
+        atomic_init(&queue->slots[i].seq, i);
+    }
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dropped, 0);
+    queue->dequeue_pos = 0;
+}
+
+int hurricane_inject_queue_push(hurricane_inject_queue_t* queue, const hurricane_inject_event_t* event)
+{
+    hurricane_inject_queue_slot_t* slot;
+
+    if (!queue || !event) {
+        return HURRICANE_INJECT_QUEUE_ERR_INVALID_ARG;
+    }
+
+    unsigned int pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        slot = &queue->slots[pos & QUEUE_MASK];
+        unsigned int seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int diff = (int)(seq - pos);
+
+        if (diff == 0) {
+            // Free: claim it; on failure pos holds the current position
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Still holds the action of the previous lap
+            atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+            return HURRICANE_INJECT_QUEUE_ERR_FULL;
+        } else {
+            // Another producer claimed it first
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    slot->event = *event;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return 0;
+}
+
+bool hurricane_inject_queue_pop(hurricane_inject_queue_t* queue, hurricane_inject_event_t* event)
+{
+    unsigned int pos = queue->dequeue_pos;
+    hurricane_inject_queue_slot_t* slot = &queue->slots[pos & QUEUE_MASK];
+
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1) {
+        return false;
+    }
+    *event = slot->event;
+    atomic_store_explicit(&slot->seq, pos + HURRICANE_INJECT_QUEUE_SIZE, memory_order_release);
+    queue->dequeue_pos = pos + 1;
+    return true;
+}
+
+int hurricane_inject_queue_drain(hurricane_inject_queue_t* queue, hurricane_inject_sched_t* sched)
+{
+    hurricane_inject_event_t event;
+    int moved = 0;
+
+    if (!queue || !sched) {
+        return 0;
+    }
+    while (sched->count < sched->capacity && hurricane_inject_queue_pop(queue, &event)) {
+        if (hurricane_inject_sched_add(sched, &event) < 0) {
+            sched->rejected++;
+        }
+        moved++;
+    }
+    return moved;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file usb_hid_inject_queue.h
+ * @brief Multi-producer, lock-free injection queue
+ *
+ * Injected input comes from several places at once: a command channel, the
+ * application, timer and GPIO interrupts. None of them may call into the
+ * scheduler, the merge or the HAL directly, those belong to the device
+ * task. Producers push actions into this queue instead; the device task
+ * drains it into the injection scheduler (usb_hid_inject_sched.h) once per
+ * iteration, before it runs the scheduler and sends the reports.
+ *
+ * The queue is a bounded ring of slots, each with a sequence number
+ * (Vyukov's bounded queue). A producer claims a slot with one
+ * compare-and-swap on the enqueue position, copies the action and publishes
+ * it by storing the slot's sequence number. No locks are taken and no
+ * interrupts are masked, so producers can run in interrupt and task context
+ * alike; a full queue rejects the push and counts it. A producer preempted
+ * between claim and publish only holds back the slots after its own until
+ * it resumes; nothing spins on it.
+ *
+ * There is exactly one consumer.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "usb_hid_inject_sched.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Slots in the queue, a power of two
+ */
+#ifndef HURRICANE_INJECT_QUEUE_SIZE
+#define HURRICANE_INJECT_QUEUE_SIZE 64
+#endif
+
+// Errors
+#define HURRICANE_INJECT_QUEUE_ERR_INVALID_ARG  -1  /**< NULL argument */
+#define HURRICANE_INJECT_QUEUE_ERR_FULL         -2  /**< All slots in use */
+
+/**
+ * @brief One slot
+ */
+typedef struct {
+    atomic_uint seq;                    /**< Slot state, see usb_hid_inject_queue.c */
+    hurricane_inject_event_t event;
+} hurricane_inject_queue_slot_t;
+
+/**
+ * @brief Queue
+ */
+typedef struct {
+    hurricane_inject_queue_slot_t slots[HURRICANE_INJECT_QUEUE_SIZE];
+    atomic_uint enqueue_pos;            /**< Shared by the producers */
+    unsigned int dequeue_pos;           /**< Owned by the consumer */
+    atomic_uint dropped;                /**< Pushes rejected because the queue was full */
+} hurricane_inject_queue_t;
+
+/**
+ * @brief Initialize an empty queue
+ *
+ * Not thread safe; call before any producer runs.
+ */
+void hurricane_inject_queue_init(hurricane_inject_queue_t* queue);
+
+/**
+ * @brief Queue an action (any context, any number of producers)
+ *
+ * @param queue Queue
+ * @param event Action; due_us says when the scheduler applies it
+ * @return 0 on success, negative HURRICANE_INJECT_QUEUE_ERR_* code on failure
+ */
+int hurricane_inject_queue_push(hurricane_inject_queue_t* queue, const hurricane_inject_event_t* event);
+
+/**
+ * @brief Take the oldest published action (consumer only)
+ *
+ * @return false if the queue is empty or its oldest slot is not published yet
+ */
+bool hurricane_inject_queue_pop(hurricane_inject_queue_t* queue, hurricane_inject_event_t* event);
+
+/**
+ * @brief Move the queued actions into the scheduler (consumer only)
+ *
+ * Stops early, leaving the rest queued, if the scheduler is full.
+ *
+ * @return Number of actions moved
+ */
+int hurricane_inject_queue_drain(hurricane_inject_queue_t* queue, hurricane_inject_sched_t* sched);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,193 @@
+/*
+ * @file usb_hid_inject_sched.c
+ * @brief Timestamped injection scheduler feeding the HID merge stage
+ */
+
+#include "usb_hid_inject_sched.h"
+#include <stddef.h>
+#include <string.h>
+
+// a is due before b; wrapping times compare by their difference
+static bool before(const hurricane_inject_event_t* a, const hurricane_inject_event_t* b)
+{
+    int32_t diff = (int32_t)(a->due_us - b->due_us);
+    if (diff != 0) {
+        return diff < 0;
+    }
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+static void sift_up(hurricane_inject_event_t* heap, uint16_t pos)
+{
+    hurricane_inject_event_t event = heap[pos];
+
+    while (pos > 0) {
+        uint16_t parent = (pos - 1) / 2;
+        if (!before(&event, &heap[parent])) {
+            break;
+        }
+        heap[pos] = heap[parent];
+        pos = parent;
+    }
+    heap[pos] = event;
+}
+
+static void sift_down(hurricane_inject_event_t* heap, uint16_t count, uint16_t pos)
+{
+    hurricane_inject_event_t event = heap[pos];
+
+    for (;;) {
+        uint16_t child = 2 * pos + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && before(&heap[child + 1], &heap[child])) {
+            child++;
+        }
+        if (!before(&heap[child], &event)) {
+            break;
+        }
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    heap[pos] = event;
+}
+
+void hurricane_inject_sched_init(hurricane_inject_sched_t* sched)
+{
+    if (sched) {
+        memset(sched, 0, sizeof(*sched));
+        sched->heap = sched->events;
+        sched->capacity = HURRICANE_INJECT_MAX_EVENTS;
+    }
+}
+
+int hurricane_inject_sched_init_storage(hurricane_inject_sched_t* sched, hurricane_inject_event_t* storage,
+                                        uint16_t capacity)
+{
+    if (!sched || !storage || capacity == 0) {
+        return HURRICANE_INJECT_ERR_INVALID_ARG;
+    }
+
+    hurricane_inject_sched_init(sched);
+    sched->heap = storage;
+    sched->capacity = capacity;
+    return 0;
+}
+
+void hurricane_inject_sched_clear(hurricane_inject_sched_t* sched)
+{
+    if (sched) {
+        sched->count = 0;
+    }
+}
+
+int hurricane_inject_sched_add(hurricane_inject_sched_t* sched, const hurricane_inject_event_t* event)
+{
+    if (!sched || !event || event->pipe >= HURRICANE_INJECT_MAX_PIPES) {
+        return HURRICANE_INJECT_ERR_INVALID_ARG;
+    }
+    if (sched->count >= sched->capacity) {
+        return HURRICANE_INJECT_ERR_FULL;
+    }
+
+    uint16_t pos = sched->count++;
+    sched->heap[pos] = *event;
+    sched->heap[pos].seq = sched->next_seq++;
+    sift_up(sched->heap, pos);
+    return 0;
+}
+
+int hurricane_inject_sched_tap(hurricane_inject_sched_t* sched, uint8_t pipe, uint32_t at_us,
+                               uint16_t usage_page, uint16_t usage, uint32_t hold_us)
+{
+    hurricane_inject_event_t event = {
+        .due_us = at_us,
+        .usage_page = usage_page,
+        .usage = usage,
+        .pipe = pipe,
+        .action = HURRICANE_INJECT_PRESS
+    };
+
+    if (!sched) {
+        return HURRICANE_INJECT_ERR_INVALID_ARG;
+    }
+    // Both or neither
+    if (sched->count + 2 > sched->capacity) {
+        return HURRICANE_INJECT_ERR_FULL;
+    }
+
+    int ret = hurricane_inject_sched_add(sched, &event);
+    if (ret < 0) {
+        return ret;
+    }
+    event.due_us = at_us + hold_us;
+    event.action = HURRICANE_INJECT_RELEASE;
+    return hurricane_inject_sched_add(sched, &event);
+}
+
+static int apply(hurricane_hid_merge_t* merge, const hurricane_inject_event_t* event)
+{
+    switch (event->action) {
+        case HURRICANE_INJECT_PRESS:
+            return hurricane_hid_merge_inject(merge, event->usage_page, event->usage, 1);
+        case HURRICANE_INJECT_RELEASE:
+            return hurricane_hid_merge_release(merge, event->usage_page, event->usage);
+        default:
+            return hurricane_hid_merge_inject(merge, event->usage_page, event->usage, event->value);
+    }
+}
+
+int hurricane_inject_sched_run(hurricane_inject_sched_t* sched, uint32_t now_us,
+                               hurricane_hid_merge_t* merges, uint8_t num_merges)
+{
+    uint32_t edges = 0;     // Pipes that already got a key edge in this run
+    int applied = 0;
+
+    if (!sched || !merges) {
+        return 0;
+    }
+
+    while (sched->count > 0) {
+        const hurricane_inject_event_t* event = &sched->heap[0];
+        bool key = (event->action == HURRICANE_INJECT_PRESS || event->action == HURRICANE_INJECT_RELEASE);
+
+        if ((int32_t)(event->due_us - now_us) > 0) {
+            break;
+        }
+        if (key && (edges & (1u << event->pipe))) {
+            break;      // Let the PC see the previous edge first
+        }
+
+        if (event->pipe < num_merges) {
+            if (apply(&merges[event->pipe], event) == 0) {
+                sched->applied++;
+                applied++;
+                if (key) {
+                    edges |= 1u << event->pipe;
+                }
+            } else {
+                sched->rejected++;
+            }
+        } else {
+            sched->rejected++;
+        }
+
+        sched->heap[0] = sched->heap[--sched->count];
+        if (sched->count > 0) {
+            sift_down(sched->heap, sched->count, 0);
+        }
+    }
+    return applied;
+}
+
+bool hurricane_inject_sched_next(const hurricane_inject_sched_t* sched, uint32_t* due_us)
+{
+    if (!sched || sched->count == 0) {
+        return false;
+    }
+    if (due_us) {
+        *due_us = sched->heap[0].due_us;
+    }
+    return true;
+}
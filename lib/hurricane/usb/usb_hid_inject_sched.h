@@ -0,0 +1,175 @@
+/**
+ * @file usb_hid_inject_sched.h
+ * @brief Timestamped injection scheduler feeding the HID merge stage
+ *
+ * Injected input is queued as timestamped actions (press, release, relative
+ * move, absolute set) instead of being sent with blocking delays in between.
+ * The main loop or a timer interrupt calls hurricane_inject_sched_run() with
+ * the current time; every action that is due is applied to the merge of its
+ * pipe (usb_hid_merge.h) and goes out with that pipe's next report.
+ *
+ * Actions are kept in a binary min-heap ordered by due time, with the
+ * insertion order breaking ties, so adding and releasing an action costs
+ * O(log n) however long the script is. No heap memory is used. The
+ * built-in storage holds HURRICANE_INJECT_MAX_EVENTS actions, enough for
+ * typed text and short macros; a whole script of thousands of actions
+ * (each key is two, a drawn path one per report) is queued in storage the
+ * application provides:
+ *
+ *   static hurricane_inject_event_t script_storage[8192];     // 20 bytes per action
+ *   hurricane_inject_sched_init_storage(&sched, script_storage, 8192);
+ *
+ * One scheduler holds at most 65535 actions.
+ *
+ * A key edge has to be seen by the PC: once a press or release was applied
+ * to a pipe, a run stops at the next press or release of the same pipe and
+ * leaves it, and everything due after it, for the next run, i.e. the next
+ * report. A tap shorter than one poll interval is therefore still reported
+ * as a press followed by a release, and actions are always applied in
+ * order. Relative moves due together are simply summed by the merge.
+ *
+ * Times are microseconds in a wrapping uint32_t; queued actions must lie
+ * within 35 minutes of each other.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_hid_merge.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Actions the built-in storage holds
+ *
+ * Used by hurricane_inject_sched_init(); can be set to 1 when every
+ * scheduler brings its own storage.
+ */
+#ifndef HURRICANE_INJECT_MAX_EVENTS
+#define HURRICANE_INJECT_MAX_EVENTS 256
+#endif
+
+/**
+ * @brief Pipes (merges) one scheduler can address
+ */
+#define HURRICANE_INJECT_MAX_PIPES 32
+
+// Errors
+#define HURRICANE_INJECT_ERR_INVALID_ARG    -1  /**< NULL argument or pipe out of range */
+#define HURRICANE_INJECT_ERR_FULL           -2  /**< The storage is full */
+
+/**
+ * @brief What an action does to its usage
+ */
+typedef enum {
+    HURRICANE_INJECT_PRESS = 0,     /**< Press a button or key */
+    HURRICANE_INJECT_RELEASE,       /**< Release it again, or drop an absolute override */
+    HURRICANE_INJECT_MOVE,          /**< Add value to a relative axis */
+    HURRICANE_INJECT_SET            /**< Override an absolute axis with value */
+} hurricane_inject_action_t;
+
+/**
+ * @brief One timestamped action
+ */
+typedef struct {
+    uint32_t due_us;                /**< When to apply it */
+    uint32_t seq;                   /**< Insertion order, set by the scheduler */
+    uint16_t usage_page;
+    uint16_t usage;
+    int32_t value;                  /**< Delta (MOVE) or position (SET) */
+    uint8_t pipe;                   /**< Index into the merges passed to run */
+    uint8_t action;                 /**< hurricane_inject_action_t */
+} hurricane_inject_event_t;
+
+/**
+ * @brief Scheduler; must not move after hurricane_inject_sched_init()
+ */
+typedef struct {
+    hurricane_inject_event_t* heap;         /**< Queue storage: events, or the application's */
+    uint16_t capacity;
+    uint16_t count;
+    uint32_t next_seq;
+    uint32_t applied;               /**< Actions applied */
+    uint32_t rejected;              /**< Actions the merge did not accept (usage not in the report) */
+    hurricane_inject_event_t events[HURRICANE_INJECT_MAX_EVENTS];  /**< Built-in storage */
+} hurricane_inject_sched_t;
+
+/**
+ * @brief Initialize an empty scheduler on its built-in storage
+ */
+void hurricane_inject_sched_init(hurricane_inject_sched_t* sched);
+
+/**
+ * @brief Initialize an empty scheduler on storage provided by the application
+ *
+ * For scripts longer than HURRICANE_INJECT_MAX_EVENTS actions.
+ *
+ * @param sched Scheduler
+ * @param storage Queue storage, owned by the application for as long as the scheduler is used
+ * @param capacity Actions storage holds, 1 to 65535
+ * @return 0 on success, negative HURRICANE_INJECT_ERR_* code on failure
+ */
+int hurricane_inject_sched_init_storage(hurricane_inject_sched_t* sched, hurricane_inject_event_t* storage,
+                                        uint16_t capacity);
+
+/**
+ * @brief Drop all queued actions
+ */
+void hurricane_inject_sched_clear(hurricane_inject_sched_t* sched);
+
+/**
+ * @brief Queue an action
+ *
+ * @param sched Scheduler
+ * @param event Action; seq is assigned here
+ * @return 0 on success, negative HURRICANE_INJECT_ERR_* code on failure
+ */
+int hurricane_inject_sched_add(hurricane_inject_sched_t* sched, const hurricane_inject_event_t* event);
+
+/**
+ * @brief Queue a press and the matching release
+ *
+ * @param sched Scheduler
+ * @param pipe Pipe of the key
+ * @param at_us Time of the press
+ * @param usage_page Usage page (0x07 for keyboard keys, 0x09 for buttons)
+ * @param usage Usage
+ * @param hold_us Time between press and release
+ * @return 0 on success, negative HURRICANE_INJECT_ERR_* code on failure
+ */
+int hurricane_inject_sched_tap(hurricane_inject_sched_t* sched, uint8_t pipe, uint32_t at_us,
+                               uint16_t usage_page, uint16_t usage, uint32_t hold_us);
+
+/**
+ * @brief Apply every action that is due
+ *
+ * @param sched Scheduler
+ * @param now_us Current time
+ * @param merges Merge of each pipe, indexed by hurricane_inject_event_t::pipe
+ * @param num_merges Entries in merges; actions for other pipes are dropped
+ * @return Number of actions applied
+ */
+int hurricane_inject_sched_run(hurricane_inject_sched_t* sched, uint32_t now_us,
+                               hurricane_hid_merge_t* merges, uint8_t num_merges);
+
+/**
+ * @brief Due time of the next action, e.g. to arm a timer
+ *
+ * @return false if nothing is queued
+ */
+bool hurricane_inject_sched_next(const hurricane_inject_sched_t* sched, uint32_t* due_us);
+
+/**
+ * @brief Number of queued actions
+ */
+static inline uint16_t hurricane_inject_sched_pending(const hurricane_inject_sched_t* sched)
+{
+    return sched->count;
+}
+
+#ifdef __cplusplus
+}
+#endif
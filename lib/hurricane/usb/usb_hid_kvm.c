@@ -0,0 +1,217 @@
+/*
+ * @file usb_hid_kvm.c
+ * @brief Focus switching of captured devices between several PCs
+ */
+
+#include "usb_hid_kvm.h"
+#include "core/hurricane_context.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HID_USAGE_PAGE_KEYBOARD 0x07
+#define HID_USAGE_LEFT_CTRL     0xE0
+
+// Whether the pipe's last mapped report holds a keyboard usage
+static bool usage_pressed(const hurricane_hid_pipe_t* pipe, uint16_t usage)
+{
+    const hurricane_hid_pack_plan_t* pack = &pipe->pack;
+
+    for (uint8_t i = 0; i < pack->num_fields; i++) {
+        const hurricane_hid_field_t* field = &pipe->sink_layout.fields[pack->first_field + i];
+        const int32_t* v = &pipe->sink_values[pack->field_value[i]];
+
+        if (field->usage_page != HID_USAGE_PAGE_KEYBOARD || usage < field->usage || usage > field->usage_max) {
+            continue;
+        }
+
+        uint16_t element = usage - field->usage;
+        if (!(field->flags & HURRICANE_HID_FIELD_VARIABLE)) {
+            int32_t raw = (int32_t)element + field->logical_min;
+            for (uint16_t e = 0; e < field->count; e++) {
+                if (v[e] == raw) {
+                    return true;
+                }
+            }
+        } else if (element < field->count) {
+            if (field->bit_size == 1 ? ((uint32_t)v[element / 32] >> (element % 32)) & 1u : v[element] != 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool carries_keys(const hurricane_hid_pipe_t* pipe)
+{
+    for (uint8_t i = 0; i < pipe->pack.num_fields; i++) {
+        if (pipe->sink_layout.fields[pipe->pack.first_field + i].usage_page == HID_USAGE_PAGE_KEYBOARD) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool modifiers_held(const hurricane_hid_kvm_t* kvm, const hurricane_hid_pipe_t* pipe)
+{
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        if ((kvm->hotkey_modifiers & (1u << bit)) && !usage_pressed(pipe, HID_USAGE_LEFT_CTRL + bit)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void hurricane_hid_kvm_init(hurricane_hid_kvm_t* kvm, uint8_t hotkey_modifiers, hurricane_hid_output_relay_t* leds)
+{
+    if (!kvm) {
+        return;
+    }
+
+    memset(kvm, 0, sizeof(*kvm));
+    kvm->hotkey_modifiers = hotkey_modifiers;
+    kvm->leds = leds;
+}
+
+int hurricane_hid_kvm_add_target(hurricane_hid_kvm_t* kvm, hurricane_context_t* ctx, uint16_t hotkey)
+{
+    if (!kvm || !ctx) {
+        return HURRICANE_HID_KVM_ERR_INVALID_ARG;
+    }
+    if (kvm->num_targets >= HURRICANE_HID_KVM_MAX_TARGETS) {
+        return HURRICANE_HID_KVM_ERR_FULL;
+    }
+
+    hurricane_hid_kvm_target_t* target = &kvm->targets[kvm->num_targets];
+    memset(target, 0, sizeof(*target));
+    target->ctx = ctx;
+    target->hotkey = hotkey;
+
+    // The first PC gets the focus, and the pipelines added before it
+    if (kvm->num_targets == 0) {
+        for (uint8_t p = 0; p < kvm->num_pipelines; p++) {
+            hurricane_hid_pipeline_retarget(kvm->pipelines[p], ctx->device_controller);
+        }
+    }
+    return kvm->num_targets++;
+}
+
+int hurricane_hid_kvm_add_pipeline(hurricane_hid_kvm_t* kvm, hurricane_hid_pipeline_t* pipeline)
+{
+    if (!kvm || !pipeline || !pipeline->config) {
+        return HURRICANE_HID_KVM_ERR_INVALID_ARG;
+    }
+    if (kvm->num_pipelines >= HURRICANE_HID_KVM_MAX_PIPELINES) {
+        return HURRICANE_HID_KVM_ERR_FULL;
+    }
+
+    if (kvm->num_targets) {
+        hurricane_hid_pipeline_retarget(pipeline, kvm->targets[kvm->focus].ctx->device_controller);
+    }
+    kvm->pipelines[kvm->num_pipelines] = pipeline;
+    return kvm->num_pipelines++;
+}
+
+int hurricane_hid_kvm_switch(hurricane_hid_kvm_t* kvm, uint8_t target, uint32_t now_ms)
+{
+    if (!kvm || target >= kvm->num_targets) {
+        return HURRICANE_HID_KVM_ERR_INVALID_ARG;
+    }
+    if (target == kvm->focus) {
+        return 0;
+    }
+
+    hurricane_hid_kvm_target_t* t = &kvm->targets[target];
+
+    // Only move when the new PC's configuration has every endpoint the pipes send on
+    for (uint8_t p = 0; p < kvm->num_pipelines; p++) {
+        const hurricane_hid_pipeline_config_t* config = kvm->pipelines[p]->config;
+        for (uint8_t i = 0; i < config->num_pipes; i++) {
+            const hurricane_hid_pipe_config_t* pc = &config->pipes[i];
+            if (!hurricane_get_device_endpoint_ctx(t->ctx, pc->sink_interface, pc->sink_endpoint, NULL)) {
+                printf("[hid_kvm] Target %u has no endpoint 0x%02X on interface %u\n",
+                       target, pc->sink_endpoint, pc->sink_interface);
+                return HURRICANE_HID_KVM_ERR_NO_ENDPOINT;
+            }
+        }
+    }
+
+    for (uint8_t p = 0; p < kvm->num_pipelines; p++) {
+        hurricane_hid_pipeline_retarget(kvm->pipelines[p], t->ctx->device_controller);
+    }
+    kvm->focus = target;
+    kvm->switches++;
+
+    // The keyboard shows the lock state of the PC it now types into
+    if (kvm->leds && t->has_leds) {
+        hurricane_hid_output_relay_reset(kvm->leds);
+        hurricane_hid_output_relay_submit(kvm->leds, t->led_report_id, t->leds, t->led_length, now_ms);
+    }
+    return 0;
+}
+
+int hurricane_hid_kvm_submit(hurricane_hid_kvm_t* kvm, uint8_t pipeline, const uint8_t* report, uint16_t length,
+                             uint32_t now_ms)
+{
+    if (!kvm || pipeline >= kvm->num_pipelines) {
+        return HURRICANE_HID_KVM_ERR_INVALID_ARG;
+    }
+
+    hurricane_hid_pipeline_t* pl = kvm->pipelines[pipeline];
+    int index = hurricane_hid_pipeline_relay(pl, report, length);
+    if (index < 0) {
+        return index;
+    }
+
+    hurricane_hid_pipe_t* pipe = &pl->pipes[index];
+    if (kvm->hotkey_modifiers && carries_keys(pipe)) {
+        bool held = modifiers_held(kvm, pipe);
+
+        for (uint8_t t = 0; held && t < kvm->num_targets; t++) {
+            if (kvm->targets[t].hotkey && usage_pressed(pipe, kvm->targets[t].hotkey)) {
+                kvm->latched = true;
+                hurricane_hid_kvm_switch(kvm, t, now_ms);
+                break;
+            }
+        }
+        if (!held) {
+            kvm->latched = false;
+        }
+
+        // Swallowed: the pipe's live input reads as nothing held
+        if (kvm->latched) {
+            memset(pipe->sink_values, 0, pipe->pack.num_values * sizeof(int32_t));
+            hurricane_hid_merge_live(&pl->merges[index], pipe->sink_values);
+            return index;
+        }
+    }
+
+    if (!(pipe->config->flags & HURRICANE_HID_PIPE_DEFER)) {
+        hurricane_hid_pipeline_flush(pl, (uint8_t)index, now_ms);
+    }
+    return index;
+}
+
+int hurricane_hid_kvm_output(hurricane_hid_kvm_t* kvm, uint8_t target, uint8_t report_id,
+                             const uint8_t* data, uint16_t length, uint32_t now_ms)
+{
+    if (!kvm || target >= kvm->num_targets || (!data && length > 0)) {
+        return HURRICANE_HID_KVM_ERR_INVALID_ARG;
+    }
+    if (length > HURRICANE_HID_OUTPUT_REPORT_MAX_SIZE) {
+        length = HURRICANE_HID_OUTPUT_REPORT_MAX_SIZE;
+    }
+
+    hurricane_hid_kvm_target_t* t = &kvm->targets[target];
+    if (length > 0) {
+        memcpy(t->leds, data, length);
+    }
+    t->led_length = (uint8_t)length;
+    t->led_report_id = report_id;
+    t->has_leds = true;
+
+    if (target != kvm->focus || !kvm->leds) {
+        return HURRICANE_HID_OUTPUT_DEFERRED;
+    }
+    return hurricane_hid_output_relay_submit(kvm->leds, report_id, data, length, now_ms);
+}
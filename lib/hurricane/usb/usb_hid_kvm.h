@@ -0,0 +1,173 @@
+/**
+ * @file usb_hid_kvm.h
+ * @brief Focus switching of captured devices between several PCs
+ *
+ * With more than one device-side controller (USB0 and USB1 on the LPC55S69,
+ * the two OTG ports of the RT1060) every controller can face its own PC,
+ * each with its own stack context and interface registry. The KVM routes
+ * the pipelines of the captured devices to one of them, the focus, and
+ * moves them on a hotkey:
+ *  - the old PC gets a report with every key and button released,
+ *  - every pipe is retargeted to the new PC's controller,
+ *  - the physical keyboard's LEDs are set to the new PC's lock state.
+ * A switch is a handful of report builds and one LED report, so it is done
+ * well within a frame; nothing waits on the bus.
+ *
+ * The hotkey is a set of held modifiers plus one key per target, e.g.
+ * Ctrl+Alt+1, Ctrl+Alt+2. Reports are checked after the map stage, in the
+ * layout the PCs see. The report that completes a hotkey and everything up
+ * to the release of its modifiers is swallowed, so neither PC sees the
+ * chord.
+ *
+ *   hurricane_hid_kvm_init(&kvm, HURRICANE_HID_KVM_CTRL_ALT, &led_relay);
+ *   hurricane_hid_kvm_add_target(&kvm, &pc_a, 0x1E);   // Ctrl+Alt+1
+ *   hurricane_hid_kvm_add_target(&kvm, &pc_b, 0x1F);   // Ctrl+Alt+2
+ *   hurricane_hid_kvm_add_pipeline(&kvm, &pipeline);
+ *   ...
+ *   hurricane_hid_kvm_submit(&kvm, 0, view->data, view->length, now_ms);   // Per host-side report
+ *   hurricane_hid_kvm_output(&kvm, target, report_id, data, length, now_ms); // Per SET_REPORT from a PC
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_hid_pipeline.h"
+#include "usb_hid_output_relay.h"
+#include "core/hurricane_context_fwd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief PCs (device-side contexts) per KVM
+ */
+#ifndef HURRICANE_HID_KVM_MAX_TARGETS
+#define HURRICANE_HID_KVM_MAX_TARGETS 4
+#endif
+
+/**
+ * @brief Pipelines moved together
+ */
+#ifndef HURRICANE_HID_KVM_MAX_PIPELINES
+#define HURRICANE_HID_KVM_MAX_PIPELINES 4
+#endif
+
+// Hotkey modifiers, bits of the keyboard modifier byte (usages 0xE0-0xE7)
+#define HURRICANE_HID_KVM_LEFT_CTRL     0x01
+#define HURRICANE_HID_KVM_LEFT_SHIFT    0x02
+#define HURRICANE_HID_KVM_LEFT_ALT      0x04
+#define HURRICANE_HID_KVM_LEFT_GUI      0x08
+#define HURRICANE_HID_KVM_CTRL_ALT      (HURRICANE_HID_KVM_LEFT_CTRL | HURRICANE_HID_KVM_LEFT_ALT)
+
+// Errors
+#define HURRICANE_HID_KVM_ERR_INVALID_ARG   -1  /**< NULL argument or unknown target/pipeline */
+#define HURRICANE_HID_KVM_ERR_FULL          -2  /**< No free target or pipeline slot */
+#define HURRICANE_HID_KVM_ERR_NO_ENDPOINT   -3  /**< The target's registry lacks a sink endpoint */
+
+/**
+ * @brief One PC
+ */
+typedef struct {
+    hurricane_context_t* ctx;               /**< Device-side stack facing the PC */
+    uint16_t hotkey;                        /**< Keyboard page usage selecting the target, 0 = none */
+    bool has_leds;                          /**< The PC sent an LED report */
+    uint8_t led_report_id;
+    uint8_t led_length;
+    uint8_t leds[HURRICANE_HID_OUTPUT_REPORT_MAX_SIZE];     /**< Last LED report of the PC */
+} hurricane_hid_kvm_target_t;
+
+/**
+ * @brief KVM state
+ */
+typedef struct {
+    hurricane_hid_kvm_target_t targets[HURRICANE_HID_KVM_MAX_TARGETS];
+    uint8_t num_targets;
+    uint8_t focus;                          /**< Target the pipelines send to */
+    hurricane_hid_pipeline_t* pipelines[HURRICANE_HID_KVM_MAX_PIPELINES];
+    uint8_t num_pipelines;
+    uint8_t hotkey_modifiers;               /**< HURRICANE_HID_KVM_* modifiers held for a hotkey */
+    bool latched;                           /**< Swallowing keyboard input until the modifiers are released */
+    hurricane_hid_output_relay_t* leds;     /**< Towards the physical keyboard, NULL = no LED resync */
+    uint32_t switches;                      /**< Focus changes so far */
+} hurricane_hid_kvm_t;
+
+/**
+ * @brief Initialize a KVM
+ *
+ * @param kvm KVM state
+ * @param hotkey_modifiers HURRICANE_HID_KVM_* modifiers held for every hotkey (0 = no hotkeys)
+ * @param leds Output relay towards the physical keyboard, NULL if LEDs are not resynced
+ */
+void hurricane_hid_kvm_init(hurricane_hid_kvm_t* kvm, uint8_t hotkey_modifiers, hurricane_hid_output_relay_t* leds);
+
+/**
+ * @brief Add a PC; the first one added has the focus
+ *
+ * @param kvm KVM state
+ * @param ctx Device-side stack facing the PC
+ * @param hotkey Keyboard page usage that selects it, 0 = none
+ * @return Target index, or negative HURRICANE_HID_KVM_ERR_* code
+ */
+int hurricane_hid_kvm_add_target(hurricane_hid_kvm_t* kvm, hurricane_context_t* ctx, uint16_t hotkey);
+
+/**
+ * @brief Put a pipeline under the KVM and route it to the focus
+ *
+ * @param kvm KVM state
+ * @param pipeline Initialized pipeline
+ * @return Pipeline index for hurricane_hid_kvm_submit(), or negative HURRICANE_HID_KVM_ERR_* code
+ */
+int hurricane_hid_kvm_add_pipeline(hurricane_hid_kvm_t* kvm, hurricane_hid_pipeline_t* pipeline);
+
+/**
+ * @brief Move the focus to another PC
+ *
+ * Checks that the target's interface registry has every sink endpoint,
+ * releases everything on the old PC, retargets all pipelines and replays
+ * the new PC's LED report to the physical keyboard.
+ *
+ * @param kvm KVM state
+ * @param target Target index
+ * @param now_ms Current time in milliseconds
+ * @return 0 on success (also when target already has the focus), negative HURRICANE_HID_KVM_ERR_* code
+ */
+int hurricane_hid_kvm_switch(hurricane_hid_kvm_t* kvm, uint8_t target, uint32_t now_ms);
+
+/**
+ * @brief Push one host-side report through a pipeline, watching for hotkeys
+ *
+ * Replaces hurricane_hid_pipeline_submit() for pipelines under the KVM.
+ *
+ * @param kvm KVM state
+ * @param pipeline Pipeline index
+ * @param report Report as received, including the ID byte if the device uses IDs
+ * @param length Report length
+ * @param now_ms Current time in milliseconds
+ * @return Pipe index, or negative HURRICANE_HID_PIPELINE_ERR_* / HURRICANE_HID_KVM_ERR_* code
+ */
+int hurricane_hid_kvm_submit(hurricane_hid_kvm_t* kvm, uint8_t pipeline, const uint8_t* report, uint16_t length,
+                             uint32_t now_ms);
+
+/**
+ * @brief Output report (LED state) received from a PC
+ *
+ * Remembered per PC; forwarded to the physical keyboard when the PC has
+ * the focus.
+ *
+ * @param kvm KVM state
+ * @param target Target the report came from
+ * @param report_id Report ID (0 if the descriptor declares none)
+ * @param data Report payload without the report ID byte
+ * @param length Payload length
+ * @param now_ms Current time in milliseconds
+ * @return hurricane_hid_output_result_t value (HURRICANE_HID_OUTPUT_DEFERRED while the PC
+ *         does not have the focus), negative on error
+ */
+int hurricane_hid_kvm_output(hurricane_hid_kvm_t* kvm, uint8_t target, uint8_t report_id,
+                             const uint8_t* data, uint16_t length, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,256 @@
+/*
+ * @file usb_hid_merge.c
+ * @brief Field-level merge of injected input with a live device stream
+ */
+
+#include "usb_hid_merge.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+static int32_t add_saturated(int32_t a, int32_t b)
+{
+    int64_t sum = (int64_t)a + b;
+    if (sum > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (sum < INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)sum;
+}
+
+int hurricane_hid_merge_init(hurricane_hid_merge_t* merge, const hurricane_hid_layout_t* layout,
+                             const hurricane_hid_pack_plan_t* plan)
+{
+    if (!merge || !layout || !plan) {
+        return HURRICANE_HID_MERGE_ERR_INVALID_ARG;
+    }
+
+    memset(merge, 0, sizeof(*merge));
+    merge->layout = layout;
+    merge->plan = plan;
+
+    if (plan->num_fields > HURRICANE_HID_MERGE_MAX_FIELDS) {
+        printf("[hid_merge] Report has %u fields, limit is %u\n",
+               plan->num_fields, HURRICANE_HID_MERGE_MAX_FIELDS);
+        return HURRICANE_HID_MERGE_ERR_TOO_COMPLEX;
+    }
+
+    for (uint8_t i = 0; i < plan->num_fields; i++) {
+        const hurricane_hid_field_t* field = &layout->fields[plan->first_field + i];
+        hurricane_hid_merge_field_t* f = &merge->fields[merge->num_fields++];
+
+        f->layout_field = plan->first_field + i;
+        f->index = plan->field_value[i];
+        f->min = field->logical_min;
+        f->max = field->logical_max;
+
+        if (!(field->flags & HURRICANE_HID_FIELD_VARIABLE)) {
+            f->kind = HURRICANE_HID_MERGE_UNION;
+            f->count = field->count;
+        } else if (field->bit_size == 1) {
+            f->kind = HURRICANE_HID_MERGE_OR;
+            f->count = (field->count + 31) / 32;
+        } else {
+            f->kind = (field->flags & HURRICANE_HID_FIELD_RELATIVE) ?
+                      HURRICANE_HID_MERGE_SUM : HURRICANE_HID_MERGE_OVERRIDE;
+            f->count = field->count;
+        }
+    }
+    return 0;
+}
+
+void hurricane_hid_merge_live(hurricane_hid_merge_t* merge, const int32_t* values)
+{
+    for (uint8_t i = 0; i < merge->num_fields; i++) {
+        const hurricane_hid_merge_field_t* f = &merge->fields[i];
+        if (f->kind == HURRICANE_HID_MERGE_SUM) {
+            for (uint16_t e = 0; e < f->count; e++) {
+                merge->live[f->index + e] = add_saturated(merge->live[f->index + e], values[f->index + e]);
+            }
+        } else {
+            memcpy(&merge->live[f->index], &values[f->index], f->count * sizeof(int32_t));
+        }
+    }
+    merge->pending = true;
+}
+
+// Field carrying a usage, and the element within it
+static const hurricane_hid_merge_field_t* find_usage(const hurricane_hid_merge_t* merge,
+                                                     uint16_t usage_page, uint16_t usage, uint16_t* element)
+{
+    for (uint8_t i = 0; i < merge->num_fields; i++) {
+        const hurricane_hid_field_t* field = &merge->layout->fields[merge->fields[i].layout_field];
+        if (field->usage_page == usage_page && usage >= field->usage && usage <= field->usage_max) {
+            *element = usage - field->usage;
+            return &merge->fields[i];
+        }
+    }
+    return NULL;
+}
+
+static int set_key(hurricane_hid_merge_t* merge, const hurricane_hid_merge_field_t* f,
+                   uint16_t element, bool pressed)
+{
+    int32_t* v = &merge->injected[f->index];
+
+    if (f->kind == HURRICANE_HID_MERGE_OR) {
+        uint32_t bit = 1u << (element % 32);
+        uint32_t mask = (uint32_t)v[element / 32];
+        v[element / 32] = (int32_t)(pressed ? (mask | bit) : (mask & ~bit));
+        return 0;
+    }
+
+    // Array: injected keys occupy the field's slots like a device would
+    int32_t raw = (int32_t)element + f->min;
+    int32_t* free_slot = NULL;
+    for (uint16_t e = 0; e < f->count; e++) {
+        if (v[e] == raw) {
+            if (pressed) {
+                return 0;
+            }
+            v[e] = 0;
+        } else if (v[e] == 0 && !free_slot) {
+            free_slot = &v[e];
+        }
+    }
+    if (pressed) {
+        if (!free_slot) {
+            return HURRICANE_HID_MERGE_ERR_NO_USAGE;
+        }
+        *free_slot = raw;
+    }
+    return 0;
+}
+
+int hurricane_hid_merge_inject(hurricane_hid_merge_t* merge, uint16_t usage_page, uint16_t usage, int32_t value)
+{
+    uint16_t element = 0;
+    int ret = 0;
+
+    if (!merge) {
+        return HURRICANE_HID_MERGE_ERR_INVALID_ARG;
+    }
+
+    const hurricane_hid_merge_field_t* f = find_usage(merge, usage_page, usage, &element);
+    if (!f) {
+        return HURRICANE_HID_MERGE_ERR_NO_USAGE;
+    }
+
+    switch (f->kind) {
+        case HURRICANE_HID_MERGE_OR:
+        case HURRICANE_HID_MERGE_UNION:
+            ret = set_key(merge, f, element, value != 0);
+            break;
+        case HURRICANE_HID_MERGE_SUM:
+            merge->injected[f->index + element] = add_saturated(merge->injected[f->index + element], value);
+            break;
+        default: {
+            uint16_t index = f->index + element;
+            merge->injected[index] = value;
+            merge->overridden[index / 32] |= 1u << (index % 32);
+            break;
+        }
+    }
+
+    if (ret == 0) {
+        merge->pending = true;
+    }
+    return ret;
+}
+
+int hurricane_hid_merge_release(hurricane_hid_merge_t* merge, uint16_t usage_page, uint16_t usage)
+{
+    uint16_t element = 0;
+
+    if (!merge) {
+        return HURRICANE_HID_MERGE_ERR_INVALID_ARG;
+    }
+
+    const hurricane_hid_merge_field_t* f = find_usage(merge, usage_page, usage, &element);
+    if (!f) {
+        return HURRICANE_HID_MERGE_ERR_NO_USAGE;
+    }
+
+    if (f->kind == HURRICANE_HID_MERGE_OR || f->kind == HURRICANE_HID_MERGE_UNION) {
+        set_key(merge, f, element, false);
+    } else {
+        uint16_t index = f->index + element;
+        merge->injected[index] = 0;
+        merge->overridden[index / 32] &= ~(1u << (index % 32));
+    }
+    merge->pending = true;
+    return 0;
+}
+
+// Add injected keys to the live ones in the free slots of an array
+static void merge_array(const hurricane_hid_merge_field_t* f, const int32_t* injected, int32_t* out)
+{
+    uint16_t next_free = 0;
+
+    for (uint16_t i = 0; i < f->count; i++) {
+        int32_t key = injected[i];
+        bool present = (key == 0);
+
+        for (uint16_t e = 0; e < f->count && !present; e++) {
+            present = (out[e] == key);
+        }
+        if (present) {
+            continue;
+        }
+        while (next_free < f->count && out[next_free] != 0) {
+            next_free++;
+        }
+        if (next_free == f->count) {
+            return;     // Rollover: the live keys win
+        }
+        out[next_free++] = key;
+    }
+}
+
+void hurricane_hid_merge_build(hurricane_hid_merge_t* merge, int32_t* values)
+{
+    bool carry = false;
+
+    for (uint8_t i = 0; i < merge->num_fields; i++) {
+        const hurricane_hid_merge_field_t* f = &merge->fields[i];
+        int32_t* live = &merge->live[f->index];
+        int32_t* injected = &merge->injected[f->index];
+        int32_t* out = &values[f->index];
+
+        switch (f->kind) {
+            case HURRICANE_HID_MERGE_OR:
+                for (uint16_t e = 0; e < f->count; e++) {
+                    out[e] = (int32_t)((uint32_t)live[e] | (uint32_t)injected[e]);
+                }
+                break;
+
+            case HURRICANE_HID_MERGE_UNION:
+                memcpy(out, live, f->count * sizeof(int32_t));
+                merge_array(f, injected, out);
+                break;
+
+            case HURRICANE_HID_MERGE_SUM:
+                for (uint16_t e = 0; e < f->count; e++) {
+                    int32_t total = add_saturated(live[e], injected[e]);
+                    int32_t sent = total < f->min ? f->min : (total > f->max ? f->max : total);
+                    out[e] = sent;
+                    live[e] = 0;
+                    injected[e] = total - sent;
+                    carry |= (injected[e] != 0);
+                }
+                break;
+
+            default:
+                for (uint16_t e = 0; e < f->count; e++) {
+                    uint16_t index = f->index + e;
+                    bool overridden = (merge->overridden[index / 32] >> (index % 32)) & 1u;
+                    out[e] = overridden ? injected[e] : live[e];
+                }
+                break;
+        }
+    }
+
+    merge->pending = carry;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file usb_hid_merge.h
+ * @brief Field-level merge of injected input with a live device stream
+ *
+ * Synthetic input used to be sent as reports of its own, racing the relayed
+ * reports of the physical device: a relayed report would release a button
+ * an injected one had just pressed, and vice versa. The merge stage keeps
+ * both sources as field values of one device-side report instead and
+ * combines them into a single report per device-side poll:
+ *  - buttons and other 1-bit fields: OR of live and injected state,
+ *  - key arrays: union of live and injected keys (extra keys are dropped,
+ *    like any rollover),
+ *  - relative axes: sum of all live reports since the last poll plus the
+ *    injected deltas; whatever exceeds the logical range is carried over
+ *    to the next poll instead of being clipped away,
+ *  - absolute axes: the injected value overrides the live one until released.
+ *
+ * Values use the layout of the pack plan of the device-side report, so the
+ * output of hurricane_hid_merge_build() goes straight into
+ * hurricane_hid_pack().
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_hid_parser.h"
+#include "usb_hid_decode.h"
+#include "usb_hid_pack.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fields per merged report
+ */
+#ifndef HURRICANE_HID_MERGE_MAX_FIELDS
+#define HURRICANE_HID_MERGE_MAX_FIELDS 16
+#endif
+
+#define HURRICANE_HID_MERGE_MASK_WORDS ((HURRICANE_HID_MAX_DECODE_VALUES + 31) / 32)
+
+// Errors
+#define HURRICANE_HID_MERGE_ERR_INVALID_ARG -1  /**< NULL argument */
+#define HURRICANE_HID_MERGE_ERR_TOO_COMPLEX -2  /**< More than HURRICANE_HID_MERGE_MAX_FIELDS fields */
+#define HURRICANE_HID_MERGE_ERR_NO_USAGE    -3  /**< Report does not carry the usage */
+
+/**
+ * @brief How a field is merged
+ */
+typedef enum {
+    HURRICANE_HID_MERGE_OR = 0,     /**< 1-bit variable: bitmask OR */
+    HURRICANE_HID_MERGE_UNION,      /**< Array: union of the selected usages */
+    HURRICANE_HID_MERGE_SUM,        /**< Relative: sum, remainder carried */
+    HURRICANE_HID_MERGE_OVERRIDE    /**< Absolute: injected value wins */
+} hurricane_hid_merge_kind_t;
+
+/**
+ * @brief One field of the merged report
+ */
+typedef struct {
+    uint8_t kind;                   /**< hurricane_hid_merge_kind_t */
+    uint8_t layout_field;           /**< Index into the layout */
+    uint16_t index;                 /**< First value index */
+    uint16_t count;                 /**< Values of the field */
+    int32_t min;                    /**< Logical range */
+    int32_t max;
+} hurricane_hid_merge_field_t;
+
+/**
+ * @brief Merge state of one device-side report
+ */
+typedef struct {
+    const hurricane_hid_layout_t* layout;
+    const hurricane_hid_pack_plan_t* plan;
+    hurricane_hid_merge_field_t fields[HURRICANE_HID_MERGE_MAX_FIELDS];
+    uint8_t num_fields;
+    bool pending;                                   /**< Something changed since the last build */
+    int32_t live[HURRICANE_HID_MAX_DECODE_VALUES];  /**< Live state; relative values accumulate */
+    int32_t injected[HURRICANE_HID_MAX_DECODE_VALUES]; /**< Injected state; relative values accumulate */
+    uint32_t overridden[HURRICANE_HID_MERGE_MASK_WORDS]; /**< Absolute values with an injected override */
+} hurricane_hid_merge_t;
+
+/**
+ * @brief Prepare a merge for one device-side report
+ *
+ * @param merge Merge state
+ * @param layout Device-side report descriptor
+ * @param plan Pack plan of the report
+ * @return 0 on success, negative HURRICANE_HID_MERGE_ERR_* code on failure
+ */
+int hurricane_hid_merge_init(hurricane_hid_merge_t* merge, const hurricane_hid_layout_t* layout,
+                             const hurricane_hid_pack_plan_t* plan);
+
+/**
+ * @brief Feed a live report
+ *
+ * Relative values are added to what is waiting for the next poll; all
+ * other fields replace the live state.
+ *
+ * @param merge Merge state
+ * @param values Values in the pack plan's layout
+ */
+void hurricane_hid_merge_live(hurricane_hid_merge_t* merge, const int32_t* values);
+
+/**
+ * @brief Inject input for one usage
+ *
+ * Buttons and keys: non-zero presses, zero releases. Relative axes: value
+ * is a delta added to the next report. Absolute axes: value overrides the
+ * live value until hurricane_hid_merge_release().
+ *
+ * @return 0 on success, negative HURRICANE_HID_MERGE_ERR_* code on failure
+ */
+int hurricane_hid_merge_inject(hurricane_hid_merge_t* merge, uint16_t usage_page, uint16_t usage, int32_t value);
+
+/**
+ * @brief Withdraw injected input for one usage
+ *
+ * Releases a button or key, drops an absolute override, or discards relative
+ * motion not yet sent.
+ *
+ * @return 0 on success, negative HURRICANE_HID_MERGE_ERR_* code on failure
+ */
+int hurricane_hid_merge_release(hurricane_hid_merge_t* merge, uint16_t usage_page, uint16_t usage);
+
+/**
+ * @brief Check whether a report has to be built for the next poll
+ */
+static inline bool hurricane_hid_merge_pending(const hurricane_hid_merge_t* merge)
+{
+    return merge->pending;
+}
+
+/**
+ * @brief Combine live and injected input into one report
+ *
+ * Consumes the accumulated relative motion (up to the logical range) and
+ * clears the pending flag; motion left over keeps it set.
+ *
+ * @param merge Merge state
+ * @param values Output, plan->num_values values for hurricane_hid_pack()
+ */
+void hurricane_hid_merge_build(hurricane_hid_merge_t* merge, int32_t* values);
+
+#ifdef __cplusplus
+}
+#endif
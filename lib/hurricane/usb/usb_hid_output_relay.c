@@ -0,0 +1,235 @@
+/*
+ * @file usb_hid_output_relay.c
+ * @brief Relay of output reports (e.g. keyboard LEDs) to the physical device
+ */
+
+#include "usb_hid_output_relay.h"
+#include "usb_control.h"
+#include "core/hurricane_context.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HID_REQ_SET_REPORT      0x09
+#define HID_REPORT_TYPE_OUTPUT  0x02
+
+static void relay_forget(hurricane_hid_output_relay_t* relay)
+{
+    memset(relay->slots, 0, sizeof(relay->slots));
+}
+
+void hurricane_hid_output_relay_init(hurricane_hid_output_relay_t* relay,
+                                     uint8_t interface_num,
+                                     uint8_t out_endpoint,
+                                     uint16_t window_ms)
+{
+    if (!relay) {
+        return;
+    }
+
+    memset(relay, 0, sizeof(*relay));
+    relay->interface_num = interface_num;
+    relay->out_endpoint = out_endpoint;
+    relay->window_ms = window_ms;
+}
+
+void hurricane_hid_output_relay_set_target(hurricane_hid_output_relay_t* relay,
+                                           uint8_t interface_num,
+                                           uint8_t out_endpoint)
+{
+    if (!relay) {
+        return;
+    }
+    if (relay->interface_num == interface_num && relay->out_endpoint == out_endpoint) {
+        return;
+    }
+
+    relay->interface_num = interface_num;
+    relay->out_endpoint = out_endpoint;
+    relay_forget(relay);
+}
+
+void hurricane_hid_output_relay_reset(hurricane_hid_output_relay_t* relay)
+{
+    if (relay) {
+        relay_forget(relay);
+    }
+}
+
+static hurricane_hid_output_slot_t* relay_find_slot(hurricane_hid_output_relay_t* relay, uint8_t report_id)
+{
+    hurricane_hid_output_slot_t* free_slot = NULL;
+
+    for (int i = 0; i < HURRICANE_HID_OUTPUT_RELAY_MAX_REPORTS; i++) {
+        hurricane_hid_output_slot_t* slot = &relay->slots[i];
+        if (slot->in_use) {
+            if (slot->report_id == report_id) {
+                return slot;
+            }
+        } else if (!free_slot) {
+            free_slot = slot;
+        }
+    }
+
+    if (free_slot) {
+        memset(free_slot, 0, sizeof(*free_slot));
+        free_slot->in_use = true;
+        free_slot->report_id = report_id;
+    }
+    return free_slot;
+}
+
+static bool same_report(const uint8_t* a, uint8_t a_len, const uint8_t* b, uint16_t b_len)
+{
+    return a_len == b_len && memcmp(a, b, a_len) == 0;
+}
+
+// A failed forward leaves the report pending, so the task retries it one
+// window later instead of the LEDs staying wrong until the next change.
+// has_sent is cleared: what the device shows is no longer known.
+static void relay_retry_later(hurricane_hid_output_slot_t* slot, uint32_t now_ms)
+{
+    if (!slot->pending) {
+        // Nothing newer was submitted meanwhile: the failed report is still the one to send
+        memcpy(slot->pending_data, slot->last_sent, slot->sent_length);
+        slot->pending_length = slot->sent_length;
+        slot->pending = true;
+    }
+    slot->has_sent = false;
+    slot->retry = true;
+    slot->last_send_ms = now_ms;
+}
+
+static void relay_set_report_complete(hurricane_control_request_t* request)
+{
+    hurricane_hid_output_relay_t* relay = (hurricane_hid_output_relay_t*)request->user_data;
+    if (request->status == HURRICANE_CONTROL_DONE) {
+        return;
+    }
+
+    uint8_t report_id = (uint8_t)(request->setup.wValue & 0xFF);
+    printf("[output relay] SET_REPORT for report %u failed (%d)\n", report_id, request->result);
+    for (int i = 0; i < HURRICANE_HID_OUTPUT_RELAY_MAX_REPORTS; i++) {
+        hurricane_hid_output_slot_t* slot = &relay->slots[i];
+        if (slot->in_use && slot->report_id == report_id) {
+            relay_retry_later(slot, slot->last_send_ms);
+        }
+    }
+}
+
+// Forward the pending report of a slot if the window and the transport allow.
+static bool relay_flush_slot(hurricane_hid_output_relay_t* relay,
+                             hurricane_hid_output_slot_t* slot,
+                             uint32_t now_ms)
+{
+    if (!slot->pending) {
+        return false;
+    }
+    if ((slot->has_sent || slot->retry) && (uint32_t)(now_ms - slot->last_send_ms) < relay->window_ms) {
+        return false;
+    }
+    if (relay->out_endpoint == 0 && hurricane_host_control_pending(&relay->request)) {
+        // One SET_REPORT in flight per relay; keep EP0 free for everyone else
+        return false;
+    }
+
+    uint16_t length = 0;
+    if (slot->report_id != 0) {
+        relay->request_buffer[length++] = slot->report_id;
+    }
+    memcpy(&relay->request_buffer[length], slot->pending_data, slot->pending_length);
+    length += slot->pending_length;
+
+    if (relay->out_endpoint != 0) {
+        int result = hurricane_hw_host_interrupt_out_transfer_on(relay->controller, relay->out_endpoint,
+                                                                relay->request_buffer, length);
+        if (result < 0) {
+            printf("[output relay] Interrupt OUT on EP 0x%02X failed (%d)\n", relay->out_endpoint, result);
+            relay_retry_later(slot, now_ms);
+            return false;
+        }
+    } else {
+        hurricane_host_control_prepare(&relay->request,
+                                       USB_REQ_TYPE_CLASS | USB_REQ_RECIPIENT_INTERFACE,
+                                       HID_REQ_SET_REPORT,
+                                       (uint16_t)((HID_REPORT_TYPE_OUTPUT << 8) | slot->report_id),
+                                       relay->interface_num,
+                                       relay->request_buffer,
+                                       length);
+        relay->request.complete = relay_set_report_complete;
+        relay->request.user_data = relay;
+        relay->request.controller = relay->controller;
+        if (hurricane_host_control_submit_ctx(relay->ctx ? relay->ctx : hurricane_default_context(),
+                                              &relay->request) < 0) {
+            return false;
+        }
+    }
+
+    memcpy(slot->last_sent, slot->pending_data, slot->pending_length);
+    slot->sent_length = slot->pending_length;
+    slot->has_sent = true;
+    slot->retry = false;
+    slot->pending = false;
+    slot->last_send_ms = now_ms;
+    relay->forwarded++;
+    return true;
+}
+
+int hurricane_hid_output_relay_submit(hurricane_hid_output_relay_t* relay,
+                                      uint8_t report_id,
+                                      const uint8_t* data,
+                                      uint16_t length,
+                                      uint32_t now_ms)
+{
+    if (!relay || (!data && length > 0)) {
+        return -1;
+    }
+    if (length > HURRICANE_HID_OUTPUT_REPORT_MAX_SIZE) {
+        printf("[output relay] Report %u too long (%u bytes)\n", report_id, length);
+        return -2;
+    }
+
+    hurricane_hid_output_slot_t* slot = relay_find_slot(relay, report_id);
+    if (!slot) {
+        printf("[output relay] No free slot for report %u\n", report_id);
+        return -3;
+    }
+
+    if (slot->pending) {
+        if (same_report(slot->pending_data, slot->pending_length, data, length)) {
+            relay->duplicates++;
+            return HURRICANE_HID_OUTPUT_DUPLICATE;
+        }
+        relay->coalesced++;
+        if (slot->has_sent && same_report(slot->last_sent, slot->sent_length, data, length)) {
+            // The burst settled back on what the device already has
+            slot->pending = false;
+            return HURRICANE_HID_OUTPUT_DUPLICATE;
+        }
+    } else if (slot->has_sent && same_report(slot->last_sent, slot->sent_length, data, length)) {
+        relay->duplicates++;
+        return HURRICANE_HID_OUTPUT_DUPLICATE;
+    }
+
+    if (length > 0) {
+        memcpy(slot->pending_data, data, length);
+    }
+    slot->pending_length = (uint8_t)length;
+    slot->pending = true;
+
+    return relay_flush_slot(relay, slot, now_ms) ? HURRICANE_HID_OUTPUT_SENT : HURRICANE_HID_OUTPUT_DEFERRED;
+}
+
+void hurricane_hid_output_relay_task(hurricane_hid_output_relay_t* relay, uint32_t now_ms)
+{
+    if (!relay) {
+        return;
+    }
+
+    for (int i = 0; i < HURRICANE_HID_OUTPUT_RELAY_MAX_REPORTS; i++) {
+        hurricane_hid_output_slot_t* slot = &relay->slots[i];
+        if (slot->in_use && slot->pending) {
+            relay_flush_slot(relay, slot, now_ms);
+        }
+    }
+}
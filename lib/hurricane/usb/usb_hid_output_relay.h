@@ -0,0 +1,150 @@
+/**
+ * @file usb_hid_output_relay.h
+ * @brief Relay of output reports (e.g. keyboard LEDs) to the physical device
+ *
+ * Output reports arriving on the device side (OUT endpoint or SET_REPORT)
+ * are forwarded to the captured device through a relay that
+ *  - drops reports identical to the last one forwarded for the same report ID,
+ *  - coalesces bursts so at most one report per ID is sent per window,
+ *  - prefers the device's interrupt OUT endpoint and only falls back to an
+ *    asynchronous SET_REPORT on EP0 when there is none,
+ *  - keeps a report whose transfer failed pending and retries it one window
+ *    later.
+ * Nothing in the relay blocks; call hurricane_hid_output_relay_task() from the
+ * main loop to flush reports held back by the coalescing window.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/usb_host_control_queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of distinct output report IDs tracked per relay
+ */
+#define HURRICANE_HID_OUTPUT_RELAY_MAX_REPORTS 4
+
+/**
+ * @brief Largest output report payload (excluding the report ID byte)
+ */
+#define HURRICANE_HID_OUTPUT_REPORT_MAX_SIZE 16
+
+/**
+ * @brief Default coalescing window in milliseconds
+ */
+#define HURRICANE_HID_OUTPUT_RELAY_DEFAULT_WINDOW_MS 8
+
+/**
+ * @brief Result of hurricane_hid_output_relay_submit()
+ */
+typedef enum {
+    HURRICANE_HID_OUTPUT_SENT = 0,      /**< Forwarded immediately */
+    HURRICANE_HID_OUTPUT_DEFERRED,      /**< Held back until the window elapses */
+    HURRICANE_HID_OUTPUT_DUPLICATE      /**< Identical to the last report, dropped */
+} hurricane_hid_output_result_t;
+
+/**
+ * @brief Per report ID relay state
+ */
+typedef struct {
+    uint8_t report_id;                                      /**< Report ID (0 = no ID) */
+    bool in_use;                                            /**< Slot is assigned */
+    bool has_sent;                                          /**< last_sent is valid */
+    bool pending;                                           /**< pending_data waits for the window */
+    bool retry;                                             /**< Last forward failed, retried after the window */
+    uint8_t sent_length;                                    /**< Length of last_sent */
+    uint8_t pending_length;                                 /**< Length of pending_data */
+    uint8_t last_sent[HURRICANE_HID_OUTPUT_REPORT_MAX_SIZE];    /**< Last forwarded payload */
+    uint8_t pending_data[HURRICANE_HID_OUTPUT_REPORT_MAX_SIZE]; /**< Newest unsent payload */
+    uint32_t last_send_ms;                                  /**< Time of the last forward */
+} hurricane_hid_output_slot_t;
+
+/**
+ * @brief Output report relay towards one captured HID interface
+ */
+typedef struct {
+    hurricane_context_t* ctx;           /**< Context the EP0 fallback is queued on (NULL = default) */
+    uint8_t controller;                 /**< Host controller instance (0 = primary) */
+    uint8_t interface_num;              /**< Host-side interface number */
+    uint8_t out_endpoint;               /**< Interrupt OUT endpoint, 0 = use EP0 */
+    uint16_t window_ms;                 /**< Coalescing window */
+    hurricane_hid_output_slot_t slots[HURRICANE_HID_OUTPUT_RELAY_MAX_REPORTS];
+    hurricane_control_request_t request;    /**< SET_REPORT request (EP0 fallback) */
+    uint8_t request_buffer[HURRICANE_HID_OUTPUT_REPORT_MAX_SIZE + 1];
+    uint32_t forwarded;                 /**< Reports sent to the device */
+    uint32_t duplicates;                /**< Reports dropped as unchanged */
+    uint32_t coalesced;                 /**< Reports replaced within a window */
+} hurricane_hid_output_relay_t;
+
+/**
+ * @brief Initialize a relay
+ *
+ * @param relay Relay instance
+ * @param interface_num Host-side HID interface number
+ * @param out_endpoint Interrupt OUT endpoint address, 0 if the device has none
+ * @param window_ms Coalescing window in milliseconds (0 = forward every change)
+ */
+void hurricane_hid_output_relay_init(
+    hurricane_hid_output_relay_t* relay,
+    uint8_t interface_num,
+    uint8_t out_endpoint,
+    uint16_t window_ms
+);
+
+/**
+ * @brief Point the relay at another interface/endpoint
+ *
+ * History is only discarded when the target actually changes, so this can be
+ * called on every report without defeating duplicate suppression.
+ *
+ * @param relay Relay instance
+ * @param interface_num Host-side HID interface number
+ * @param out_endpoint Interrupt OUT endpoint address, 0 if the device has none
+ */
+void hurricane_hid_output_relay_set_target(
+    hurricane_hid_output_relay_t* relay,
+    uint8_t interface_num,
+    uint8_t out_endpoint
+);
+
+/**
+ * @brief Forget everything forwarded so far (e.g. after the device reattached)
+ *
+ * @param relay Relay instance
+ */
+void hurricane_hid_output_relay_reset(hurricane_hid_output_relay_t* relay);
+
+/**
+ * @brief Submit an output report received on the device side
+ *
+ * @param relay Relay instance
+ * @param report_id Report ID (0 if the descriptor declares none)
+ * @param data Report payload without the report ID byte
+ * @param length Payload length
+ * @param now_ms Current time in milliseconds
+ * @return hurricane_hid_output_result_t value, or negative error code
+ */
+int hurricane_hid_output_relay_submit(
+    hurricane_hid_output_relay_t* relay,
+    uint8_t report_id,
+    const uint8_t* data,
+    uint16_t length,
+    uint32_t now_ms
+);
+
+/**
+ * @brief Forward reports whose coalescing window has elapsed
+ *
+ * @param relay Relay instance
+ * @param now_ms Current time in milliseconds
+ */
+void hurricane_hid_output_relay_task(hurricane_hid_output_relay_t* relay, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,270 @@
+/*
+ * @file usb_hid_pack.c
+ * @brief Report packing: synthesize report bytes from field values
+ */
+
+#include "usb_hid_pack.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// Reports up to this size are packed in a scratch buffer with room for
+// whole-word stores past the last field, then copied out.
+#define PACK_SCRATCH_SIZE 64
+
+static inline uint32_t load32le(const uint8_t* p)
+{
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap32(w);
+#endif
+    return w;
+}
+
+static inline void store32le(uint8_t* p, uint32_t w)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap32(w);
+#endif
+    memcpy(p, &w, sizeof(w));
+}
+
+static inline uint32_t fit(const hurricane_hid_pack_op_t* op, int32_t v)
+{
+    if (op->flags & HURRICANE_HID_PACK_CLAMP) {
+        v = v < op->min ? op->min : (v > op->max ? op->max : v);
+    } else if ((op->flags & HURRICANE_HID_PACK_ARRAY) && (v < op->min || v > op->max)) {
+        v = 0;
+    }
+    return (uint32_t)v & op->mask;
+}
+
+static int add_op(hurricane_hid_pack_plan_t* plan, uint32_t bit_offset, uint8_t size, uint16_t count,
+                  uint8_t flags, int32_t min, int32_t max)
+{
+    if (plan->num_values + count > HURRICANE_HID_MAX_DECODE_VALUES) {
+        return HURRICANE_HID_PACK_ERR_TOO_COMPLEX;
+    }
+
+    uint32_t last_bit = bit_offset + (uint32_t)(count - 1) * size;
+    bool word_ok = size <= 25 && ((last_bit >> 3) + 4 <= plan->payload_size ||
+                                  plan->payload_size <= PACK_SCRATCH_SIZE);
+
+    // Neighbours with the same shape and range share one op
+    if (plan->num_ops > 0) {
+        hurricane_hid_pack_op_t* prev = &plan->ops[plan->num_ops - 1];
+        uint8_t prev_bits = prev->kind < HURRICANE_HID_DECODE_WORD ? prev->stride * 8 : prev->stride;
+        if (prev->kind != HURRICANE_HID_DECODE_BITS && prev_bits == size && prev->flags == flags &&
+            prev->min == min && prev->max == max &&
+            prev->bit_offset + (uint32_t)prev->count * size == bit_offset &&
+            (prev->kind != HURRICANE_HID_DECODE_WORD || word_ok)) {
+            prev->count += count;
+            plan->num_values += count;
+            return 0;
+        }
+    }
+
+    if (plan->num_ops >= HURRICANE_HID_MAX_PACK_OPS) {
+        return HURRICANE_HID_PACK_ERR_TOO_COMPLEX;
+    }
+
+    hurricane_hid_pack_op_t* op = &plan->ops[plan->num_ops++];
+    op->flags = flags;
+    op->count = count;
+    op->bit_offset = (uint16_t)bit_offset;
+    op->value_index = plan->num_values;
+    op->mask = size == 32 ? 0xFFFFFFFFu : ((1u << size) - 1);
+    op->min = min;
+    op->max = max;
+    op->stride = size;
+
+    if ((bit_offset & 7) == 0 && (size == 8 || size == 16 || size == 32)) {
+        op->kind = size == 8 ? HURRICANE_HID_DECODE_U8 :
+                   size == 16 ? HURRICANE_HID_DECODE_U16 : HURRICANE_HID_DECODE_U32;
+        op->stride = size / 8;
+    } else if (word_ok) {
+        op->kind = HURRICANE_HID_DECODE_WORD;
+    } else {
+        op->kind = HURRICANE_HID_DECODE_BITS;
+    }
+
+    plan->num_values += count;
+    return 0;
+}
+
+int hurricane_hid_pack_plan_build(const hurricane_hid_layout_t* layout, uint8_t type,
+                                  uint8_t report_id, hurricane_hid_pack_plan_t* plan)
+{
+    if (!layout || !plan) {
+        return HURRICANE_HID_PACK_ERR_INVALID_ARG;
+    }
+
+    memset(plan, 0, sizeof(*plan));
+
+    const hurricane_hid_report_info_t* report = hurricane_hid_layout_find_report(layout, type, report_id);
+    if (!report) {
+        return HURRICANE_HID_PACK_ERR_NO_REPORT;
+    }
+
+    plan->report_id = report_id;
+    plan->type = type;
+    plan->first_field = report->first_field;
+    plan->num_fields = report->num_fields;
+    plan->payload_size = hurricane_hid_report_payload_size(report);
+
+    for (uint8_t i = 0; i < report->num_fields; i++) {
+        const hurricane_hid_field_t* field = &layout->fields[report->first_field + i];
+        bool variable = (field->flags & HURRICANE_HID_FIELD_VARIABLE) != 0;
+        int ret;
+
+        plan->field_value[i] = plan->num_values;
+
+        if (field->bit_size == 1 && variable) {
+            // Button run: one bitmask per 32 buttons, nothing to clamp
+            for (uint16_t done = 0; done < field->count; done += 32) {
+                uint16_t n = field->count - done > 32 ? 32 : field->count - done;
+                ret = add_op(plan, field->bit_offset + done, (uint8_t)n, 1, 0, 0, 0);
+                if (ret < 0) {
+                    return ret;
+                }
+            }
+            continue;
+        }
+
+        ret = add_op(plan, field->bit_offset, field->bit_size, field->count,
+                     variable ? HURRICANE_HID_PACK_CLAMP : HURRICANE_HID_PACK_ARRAY,
+                     field->logical_min, field->logical_max);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+static void pack_ops(const hurricane_hid_pack_plan_t* plan, const int32_t* values, uint8_t* payload)
+{
+    for (uint8_t i = 0; i < plan->num_ops; i++) {
+        const hurricane_hid_pack_op_t* op = &plan->ops[i];
+        const int32_t* in = &values[op->value_index];
+
+        switch (op->kind) {
+            case HURRICANE_HID_DECODE_U8: {
+                uint8_t* p = payload + (op->bit_offset >> 3);
+                for (uint16_t e = 0; e < op->count; e++) {
+                    p[e] = (uint8_t)fit(op, in[e]);
+                }
+                break;
+            }
+            case HURRICANE_HID_DECODE_U16: {
+                uint8_t* p = payload + (op->bit_offset >> 3);
+                for (uint16_t e = 0; e < op->count; e++, p += 2) {
+                    uint32_t v = fit(op, in[e]);
+                    p[0] = (uint8_t)v;
+                    p[1] = (uint8_t)(v >> 8);
+                }
+                break;
+            }
+            case HURRICANE_HID_DECODE_U32: {
+                uint8_t* p = payload + (op->bit_offset >> 3);
+                for (uint16_t e = 0; e < op->count; e++, p += 4) {
+                    store32le(p, fit(op, in[e]));
+                }
+                break;
+            }
+            case HURRICANE_HID_DECODE_WORD: {
+                // The payload starts zeroed, so OR-ing each value in is enough
+                uint32_t bit = op->bit_offset;
+                for (uint16_t e = 0; e < op->count; e++, bit += op->stride) {
+                    uint8_t* p = payload + (bit >> 3);
+                    store32le(p, load32le(p) | (fit(op, in[e]) << (bit & 7)));
+                }
+                break;
+            }
+            default: {
+                uint32_t bit = op->bit_offset;
+                for (uint16_t e = 0; e < op->count; e++, bit += op->stride) {
+                    uint64_t raw = (uint64_t)fit(op, in[e]) << (bit & 7);
+                    uint32_t byte = bit >> 3;
+                    for (uint8_t b = 0; b < 5 && byte + b < plan->payload_size; b++) {
+                        payload[byte + b] |= (uint8_t)(raw >> (8 * b));
+                    }
+                }
+                break;
+            }
+        }
+    }
+}
+
+int hurricane_hid_pack(const hurricane_hid_pack_plan_t* plan, const int32_t* values,
+                       uint8_t* report, uint16_t size)
+{
+    uint16_t header = plan->report_id ? 1 : 0;
+    uint16_t total = header + plan->payload_size;
+
+    if (size < total) {
+        return HURRICANE_HID_PACK_ERR_NO_SPACE;
+    }
+    if (header) {
+        report[0] = plan->report_id;
+    }
+
+    if (plan->payload_size <= PACK_SCRATCH_SIZE) {
+        uint8_t scratch[PACK_SCRATCH_SIZE + 4];
+        memset(scratch, 0, plan->payload_size + 4);
+        pack_ops(plan, values, scratch);
+        memcpy(report + header, scratch, plan->payload_size);
+    } else {
+        // Word ops of large reports never reach past the payload
+        memset(report + header, 0, plan->payload_size);
+        pack_ops(plan, values, report + header);
+    }
+    return total;
+}
+
+int hurricane_hid_pack_set_usage(const hurricane_hid_pack_plan_t* plan, const hurricane_hid_layout_t* layout,
+                                 int32_t* values, uint16_t usage_page, uint16_t usage, int32_t value)
+{
+    for (uint8_t i = 0; i < plan->num_fields; i++) {
+        const hurricane_hid_field_t* field = &layout->fields[plan->first_field + i];
+        if (field->usage_page != usage_page || usage < field->usage || usage > field->usage_max) {
+            continue;
+        }
+
+        int32_t* v = &values[plan->field_value[i]];
+        uint16_t index = usage - field->usage;
+
+        if (!(field->flags & HURRICANE_HID_FIELD_VARIABLE)) {
+            int32_t raw = (int32_t)index + field->logical_min;
+            int32_t* free_slot = NULL;
+            for (uint16_t e = 0; e < field->count; e++) {
+                if (v[e] == raw) {
+                    if (value) {
+                        return 0;
+                    }
+                    v[e] = 0;
+                } else if (v[e] == 0 && !free_slot) {
+                    free_slot = &v[e];
+                }
+            }
+            if (!value) {
+                return 0;
+            }
+            if (!free_slot) {
+                return HURRICANE_HID_PACK_ERR_NO_USAGE;
+            }
+            *free_slot = raw;
+            return 0;
+        }
+
+        if (field->bit_size == 1) {
+            uint32_t bit = 1u << (index % 32);
+            uint32_t mask = (uint32_t)v[index / 32];
+            v[index / 32] = (int32_t)(value ? (mask | bit) : (mask & ~bit));
+        } else {
+            v[index] = value;
+        }
+        return 0;
+    }
+    return HURRICANE_HID_PACK_ERR_NO_USAGE;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file usb_hid_pack.h
+ * @brief Report packing: synthesize report bytes from field values
+ *
+ * The inverse of usb_hid_decode.h. A pack plan is built once per report of
+ * a compiled layout and stores, per field, where its bits go and which
+ * logical range they are clamped to. Packing then writes every value with
+ * a precomputed shift and mask; nothing about the descriptor is looked at
+ * per report.
+ *
+ * Values use the same flat layout as a decode plan of the same report:
+ * one int32_t per element, and one bitmask per 32 elements of a 1-bit
+ * variable field (buttons, modifiers). A report decoded from one device can
+ * therefore be packed for an emulated descriptor of the same shape directly,
+ * and hurricane_hid_pack_set_usage() fills values by usage for everything
+ * else.
+ *
+ * Clamping: variable fields saturate to [logical_min, logical_max]; array
+ * fields write 0 for out of range values, which is how arrays say "no usage".
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "usb_hid_parser.h"
+#include "usb_hid_decode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pack steps per plan
+ */
+#ifndef HURRICANE_HID_MAX_PACK_OPS
+#define HURRICANE_HID_MAX_PACK_OPS 32
+#endif
+
+// Plan build and pack results
+#define HURRICANE_HID_PACK_ERR_INVALID_ARG  -1  /**< NULL argument */
+#define HURRICANE_HID_PACK_ERR_NO_REPORT    -2  /**< Layout has no such report */
+#define HURRICANE_HID_PACK_ERR_TOO_COMPLEX  -3  /**< Ops or values limit exceeded */
+#define HURRICANE_HID_PACK_ERR_NO_SPACE     -4  /**< Output buffer smaller than the report */
+#define HURRICANE_HID_PACK_ERR_NO_USAGE     -5  /**< Report does not carry the usage */
+
+// Pack op flags
+#define HURRICANE_HID_PACK_CLAMP    0x01    /**< Saturate to [min, max] */
+#define HURRICANE_HID_PACK_ARRAY    0x02    /**< Out of range writes 0 */
+
+/**
+ * @brief One pack step consuming count consecutive values
+ */
+typedef struct {
+    uint8_t kind;           /**< hurricane_hid_decode_kind_t; the shapes are the same */
+    uint8_t stride;         /**< Bits between elements (bytes for U8/U16/U32) */
+    uint8_t flags;          /**< HURRICANE_HID_PACK_* */
+    uint16_t count;         /**< Values consumed */
+    uint16_t bit_offset;    /**< Offset of the first element in the payload */
+    uint16_t value_index;   /**< Where the first value comes from */
+    uint32_t mask;          /**< Value mask before shifting */
+    int32_t min;            /**< Logical range */
+    int32_t max;
+} hurricane_hid_pack_op_t;
+
+/**
+ * @brief Pack plan of one report
+ */
+typedef struct {
+    hurricane_hid_pack_op_t ops[HURRICANE_HID_MAX_PACK_OPS];
+    uint8_t num_ops;
+    uint8_t report_id;                      /**< Written in front of the payload when non-zero */
+    uint8_t type;
+    uint8_t first_field;                    /**< Layout index of the report's first field */
+    uint8_t num_fields;
+    uint16_t num_values;                    /**< Values read by hurricane_hid_pack() */
+    uint16_t payload_size;                  /**< Payload bytes (without report ID) */
+    uint16_t field_value[HURRICANE_HID_MAX_FIELDS]; /**< Value index of each field of the report */
+} hurricane_hid_pack_plan_t;
+
+/**
+ * @brief Build the pack plan of one report
+ *
+ * @param layout Compiled report descriptor
+ * @param type hurricane_hid_report_type_t
+ * @param report_id Report ID (0 if the descriptor does not use IDs)
+ * @param plan Output plan
+ * @return 0 on success, negative HURRICANE_HID_PACK_ERR_* code on failure
+ */
+int hurricane_hid_pack_plan_build(const hurricane_hid_layout_t* layout, uint8_t type,
+                                  uint8_t report_id, hurricane_hid_pack_plan_t* plan);
+
+/**
+ * @brief Pack values into a report
+ *
+ * Padding and unused bits are written as zero.
+ *
+ * @param plan Plan built for the report
+ * @param values plan->num_values values
+ * @param report Output: report ID byte (if any) followed by the payload
+ * @param size Size of the output buffer
+ * @return Bytes written, or HURRICANE_HID_PACK_ERR_NO_SPACE
+ */
+int hurricane_hid_pack(const hurricane_hid_pack_plan_t* plan, const int32_t* values,
+                       uint8_t* report, uint16_t size);
+
+/**
+ * @brief Set the value of one usage
+ *
+ * Variable fields: sets the element carrying the usage (for 1-bit fields
+ * the bit in the bitmask, any non-zero value sets it). Array fields: puts
+ * the usage into the first free (zero) slot, or clears it again when value
+ * is 0.
+ *
+ * @param plan Plan
+ * @param layout Layout the plan was built from
+ * @param values Value array of the plan
+ * @param usage_page Usage page
+ * @param usage Usage
+ * @param value Value
+ * @return 0 on success, HURRICANE_HID_PACK_ERR_NO_USAGE if the report has no
+ *         such usage or an array has no free slot
+ */
+int hurricane_hid_pack_set_usage(const hurricane_hid_pack_plan_t* plan, const hurricane_hid_layout_t* layout,
+                                 int32_t* values, uint16_t usage_page, uint16_t usage, int32_t value);
+
+/**
+ * @brief Value index of a layout field in the plan's input
+ *
+ * @return Value index, or -1 if the field belongs to another report
+ */
+static inline int hurricane_hid_pack_value_index(const hurricane_hid_pack_plan_t* plan,
+                                                 uint8_t layout_field_index)
+{
+    if (layout_field_index < plan->first_field ||
+        layout_field_index >= plan->first_field + plan->num_fields) {
+        return -1;
+    }
+    return plan->field_value[layout_field_index - plan->first_field];
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,513 @@
+/*
+ * @file usb_hid_parser.c
+ * @brief HID report descriptor parser producing a compiled field layout
+ */
+
+#include "usb_hid_parser.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// Item types (bits 3..2 of the prefix)
+#define HID_ITEM_TYPE_MAIN      0
+#define HID_ITEM_TYPE_GLOBAL    1
+#define HID_ITEM_TYPE_LOCAL     2
+#define HID_ITEM_LONG_PREFIX    0xFE
+
+// Main item tags
+#define HID_MAIN_INPUT          0x8
+#define HID_MAIN_OUTPUT         0x9
+#define HID_MAIN_COLLECTION     0xA
+#define HID_MAIN_FEATURE        0xB
+#define HID_MAIN_END_COLLECTION 0xC
+
+// Global item tags
+#define HID_GLOBAL_USAGE_PAGE   0x0
+#define HID_GLOBAL_LOGICAL_MIN  0x1
+#define HID_GLOBAL_LOGICAL_MAX  0x2
+#define HID_GLOBAL_REPORT_SIZE  0x7
+#define HID_GLOBAL_REPORT_ID    0x8
+#define HID_GLOBAL_REPORT_COUNT 0x9
+#define HID_GLOBAL_PUSH         0xA
+#define HID_GLOBAL_POP          0xB
+
+// Local item tags
+#define HID_LOCAL_USAGE         0x0
+#define HID_LOCAL_USAGE_MIN     0x1
+#define HID_LOCAL_USAGE_MAX     0x2
+#define HID_LOCAL_DELIMITER     0xA
+
+#define HID_COLLECTION_APPLICATION 0x01
+#define HID_MAIN_DATA_MASK      0x01FF
+
+typedef struct {
+    uint16_t usage_page;
+    int32_t logical_min;
+    int32_t logical_max;
+    uint32_t logical_max_raw;   // Unsigned reading of logical_max
+    uint32_t report_size;
+    uint32_t report_count;
+    uint8_t report_id;
+} hid_globals_t;
+
+typedef struct {
+    uint16_t page;
+    uint16_t min;
+    uint16_t max;
+} hid_usage_range_t;
+
+typedef struct {
+    hurricane_hid_layout_t* layout;
+
+    hid_globals_t globals;
+    hid_globals_t stack[HURRICANE_HID_GLOBAL_STACK_DEPTH];
+    uint8_t stack_depth;
+
+    // Local state, cleared after every main item
+    hid_usage_range_t usages[HURRICANE_HID_MAX_USAGES];
+    uint8_t num_usages;
+    uint32_t usage_min;         // Extended (page << 16 | usage)
+    uint32_t usage_max;
+    bool has_usage_min;
+    bool has_usage_max;
+    uint8_t delimiter_depth;
+    uint8_t delimiter_usages;
+
+    int collection_depth;
+    uint16_t application_page;
+    uint16_t application_usage;
+} hid_parser_t;
+
+static void clear_locals(hid_parser_t* p)
+{
+    p->num_usages = 0;
+    p->has_usage_min = false;
+    p->has_usage_max = false;
+    p->delimiter_usages = 0;
+}
+
+// Usages given with 1 or 2 data bytes take the current usage page
+static uint32_t extend_usage(const hid_parser_t* p, uint32_t value, uint8_t size)
+{
+    if (size < 4) {
+        return ((uint32_t)p->globals.usage_page << 16) | (value & 0xFFFF);
+    }
+    return value;
+}
+
+static void add_usage_range(hid_parser_t* p, uint32_t min, uint32_t max)
+{
+    if (p->num_usages >= HURRICANE_HID_MAX_USAGES) {
+        // Extra usages repeat the last one, exactly like a short usage list
+        return;
+    }
+    hid_usage_range_t* range = &p->usages[p->num_usages++];
+    range->page = (uint16_t)(min >> 16);
+    range->min = (uint16_t)min;
+    range->max = (uint16_t)max < range->min ? range->min : (uint16_t)max;
+}
+
+static int get_report(hid_parser_t* p, uint8_t type, uint8_t* index_out)
+{
+    hurricane_hid_layout_t* layout = p->layout;
+    uint8_t id = p->globals.report_id;
+
+    for (uint8_t i = 0; i < layout->num_reports; i++) {
+        if (layout->reports[i].type == type && layout->reports[i].report_id == id) {
+            *index_out = i;
+            return 0;
+        }
+    }
+    if (layout->num_reports >= HURRICANE_HID_MAX_REPORTS) {
+        return HURRICANE_HID_PARSE_ERR_TOO_MANY_REPORTS;
+    }
+
+    hurricane_hid_report_info_t* report = &layout->reports[layout->num_reports];
+    memset(report, 0, sizeof(*report));
+    report->report_id = id;
+    report->type = type;
+    report->application_page = p->application_page;
+    report->application_usage = p->application_usage;
+    *index_out = layout->num_reports++;
+    return 0;
+}
+
+static int emit_field(hid_parser_t* p, const hurricane_hid_field_t* proto,
+                      uint16_t page, uint16_t usage, uint16_t usage_max,
+                      uint32_t bit_offset, uint32_t count)
+{
+    hurricane_hid_layout_t* layout = p->layout;
+
+    if (layout->num_fields >= HURRICANE_HID_MAX_FIELDS) {
+        return HURRICANE_HID_PARSE_ERR_TOO_MANY_FIELDS;
+    }
+
+    hurricane_hid_field_t* field = &layout->fields[layout->num_fields++];
+    *field = *proto;
+    field->usage_page = page;
+    field->usage = usage;
+    field->usage_max = usage_max;
+    field->bit_offset = (uint16_t)bit_offset;
+    field->count = (uint16_t)count;
+    return 0;
+}
+
+static int handle_main_data(hid_parser_t* p, uint8_t type, uint32_t data)
+{
+    const hid_globals_t* g = &p->globals;
+    uint8_t report_index;
+    int ret = get_report(p, type, &report_index);
+    if (ret < 0) {
+        return ret;
+    }
+
+    hurricane_hid_report_info_t* report = &p->layout->reports[report_index];
+    uint32_t offset = report->bit_length;
+    uint32_t total = g->report_size * g->report_count;
+    uint16_t flags = (uint16_t)(data & HID_MAIN_DATA_MASK);
+
+    if (offset + total > UINT16_MAX) {
+        return HURRICANE_HID_PARSE_ERR_UNSUPPORTED;
+    }
+    report->bit_length = (uint16_t)(offset + total);
+
+    if (total == 0 || (flags & HURRICANE_HID_FIELD_CONSTANT)) {
+        // Padding: only takes up space
+        return 0;
+    }
+    if (g->report_size > 32) {
+        return HURRICANE_HID_PARSE_ERR_UNSUPPORTED;
+    }
+
+    hurricane_hid_field_t proto = {0};
+    proto.flags = flags;
+    proto.report_id = g->report_id;
+    proto.report_index = report_index;
+    proto.bit_size = (uint8_t)g->report_size;
+    proto.type = type;
+    proto.logical_min = g->logical_min;
+    proto.logical_max = g->logical_max;
+    if (g->logical_min >= 0 && g->logical_max < g->logical_min) {
+        // e.g. Logical Max 0xFF encoded in one byte: meant as unsigned
+        proto.logical_max = (int32_t)g->logical_max_raw;
+    }
+    if (proto.logical_min < 0) {
+        proto.flags |= HURRICANE_HID_FIELD_SIGNED;
+    }
+
+    // A lone Usage Minimum/Maximum still names a usage
+    if (p->has_usage_min || p->has_usage_max) {
+        uint32_t min = p->has_usage_min ? p->usage_min : p->usage_max;
+        uint32_t max = p->has_usage_max ? p->usage_max : p->usage_min;
+        add_usage_range(p, min, max);
+    }
+
+    if (!(flags & HURRICANE_HID_FIELD_VARIABLE)) {
+        // Array: one record selecting among all listed usages
+        uint16_t page = p->num_usages ? p->usages[0].page : g->usage_page;
+        uint16_t min = p->num_usages ? p->usages[0].min : 0;
+        uint16_t max = p->num_usages ? p->usages[p->num_usages - 1].max : 0;
+        return emit_field(p, &proto, page, min, max, offset, g->report_count);
+    }
+
+    // Variable: one record per run of consecutive usages
+    uint32_t element = 0;
+    for (uint8_t i = 0; i < p->num_usages && element < g->report_count; i++) {
+        const hid_usage_range_t* range = &p->usages[i];
+        uint32_t span = (uint32_t)range->max - range->min + 1;
+        uint32_t take = g->report_count - element;
+        if (take > span) {
+            take = span;
+        }
+        ret = emit_field(p, &proto, range->page, range->min, (uint16_t)(range->min + take - 1),
+                         offset + element * g->report_size, take);
+        if (ret < 0) {
+            return ret;
+        }
+        element += take;
+    }
+    if (element < g->report_count) {
+        // Fewer usages than elements: the last usage applies to the rest
+        uint16_t page = p->num_usages ? p->usages[p->num_usages - 1].page : g->usage_page;
+        uint16_t usage = p->num_usages ? p->usages[p->num_usages - 1].max : 0;
+        ret = emit_field(p, &proto, page, usage, usage,
+                         offset + element * g->report_size, g->report_count - element);
+    }
+    return ret;
+}
+
+static int handle_main(hid_parser_t* p, uint8_t tag, uint32_t data)
+{
+    int ret = 0;
+
+    switch (tag) {
+        case HID_MAIN_INPUT:
+            ret = handle_main_data(p, HURRICANE_HID_REPORT_INPUT, data);
+            break;
+        case HID_MAIN_OUTPUT:
+            ret = handle_main_data(p, HURRICANE_HID_REPORT_OUTPUT, data);
+            break;
+        case HID_MAIN_FEATURE:
+            ret = handle_main_data(p, HURRICANE_HID_REPORT_FEATURE, data);
+            break;
+        case HID_MAIN_COLLECTION:
+            if (p->collection_depth == 0 && (data & 0xFF) == HID_COLLECTION_APPLICATION) {
+                uint32_t usage = p->num_usages ?
+                    ((uint32_t)p->usages[0].page << 16 | p->usages[0].min) :
+                    (p->has_usage_min ? p->usage_min : 0);
+                p->application_page = (uint16_t)(usage >> 16);
+                p->application_usage = (uint16_t)usage;
+            }
+            p->collection_depth++;
+            break;
+        case HID_MAIN_END_COLLECTION:
+            if (--p->collection_depth < 0) {
+                ret = HURRICANE_HID_PARSE_ERR_COLLECTION;
+            }
+            break;
+        default:
+            break;
+    }
+
+    clear_locals(p);
+    return ret;
+}
+
+static int handle_global(hid_parser_t* p, uint8_t tag, uint32_t value, int32_t svalue)
+{
+    hid_globals_t* g = &p->globals;
+
+    switch (tag) {
+        case HID_GLOBAL_USAGE_PAGE:
+            g->usage_page = (uint16_t)value;
+            break;
+        case HID_GLOBAL_LOGICAL_MIN:
+            g->logical_min = svalue;
+            break;
+        case HID_GLOBAL_LOGICAL_MAX:
+            g->logical_max = svalue;
+            g->logical_max_raw = value;
+            break;
+        case HID_GLOBAL_REPORT_SIZE:
+            g->report_size = value;
+            break;
+        case HID_GLOBAL_REPORT_COUNT:
+            g->report_count = value;
+            break;
+        case HID_GLOBAL_REPORT_ID:
+            if (value == 0 || value > 0xFF) {
+                return HURRICANE_HID_PARSE_ERR_UNSUPPORTED;
+            }
+            g->report_id = (uint8_t)value;
+            p->layout->uses_report_ids = true;
+            break;
+        case HID_GLOBAL_PUSH:
+            if (p->stack_depth >= HURRICANE_HID_GLOBAL_STACK_DEPTH) {
+                return HURRICANE_HID_PARSE_ERR_STACK;
+            }
+            p->stack[p->stack_depth++] = *g;
+            break;
+        case HID_GLOBAL_POP:
+            if (p->stack_depth == 0) {
+                return HURRICANE_HID_PARSE_ERR_STACK;
+            }
+            *g = p->stack[--p->stack_depth];
+            break;
+        default:
+            // Physical range, unit and unit exponent do not affect the layout
+            break;
+    }
+    return 0;
+}
+
+static void handle_local(hid_parser_t* p, uint8_t tag, uint32_t value, uint8_t size)
+{
+    switch (tag) {
+        case HID_LOCAL_USAGE:
+            // Only the first usage of a delimited alias set is kept
+            if (p->delimiter_depth && p->delimiter_usages++) {
+                break;
+            }
+            value = extend_usage(p, value, size);
+            add_usage_range(p, value, value);
+            break;
+        case HID_LOCAL_USAGE_MIN:
+            p->usage_min = extend_usage(p, value, size);
+            p->has_usage_min = true;
+            break;
+        case HID_LOCAL_USAGE_MAX:
+            p->usage_max = extend_usage(p, value, size);
+            p->has_usage_max = true;
+            break;
+        case HID_LOCAL_DELIMITER:
+            p->delimiter_depth = value ? 1 : 0;
+            p->delimiter_usages = 0;
+            break;
+        default:
+            // Designators and strings do not affect the layout
+            return;
+    }
+
+    if (p->has_usage_min && p->has_usage_max) {
+        add_usage_range(p, p->usage_min, p->usage_max);
+        p->has_usage_min = false;
+        p->has_usage_max = false;
+    }
+}
+
+// Group the fields by report, keeping descriptor order within each report,
+// so that a report's fields are contiguous in memory.
+static void group_fields(hurricane_hid_layout_t* layout)
+{
+    for (uint8_t i = 1; i < layout->num_fields; i++) {
+        hurricane_hid_field_t field = layout->fields[i];
+        uint8_t j = i;
+        while (j > 0 && layout->fields[j - 1].report_index > field.report_index) {
+            layout->fields[j] = layout->fields[j - 1];
+            j--;
+        }
+        layout->fields[j] = field;
+    }
+
+    for (uint8_t i = 0; i < layout->num_fields; i++) {
+        hurricane_hid_report_info_t* report = &layout->reports[layout->fields[i].report_index];
+        if (report->num_fields++ == 0) {
+            report->first_field = i;
+        }
+    }
+}
+
+int hurricane_hid_parse_report_descriptor(const uint8_t* desc, uint16_t length,
+                                          hurricane_hid_layout_t* layout)
+{
+    hid_parser_t parser;
+    int ret = HURRICANE_HID_PARSE_OK;
+    uint16_t pos = 0;
+
+    if (!desc || !layout) {
+        return HURRICANE_HID_PARSE_ERR_INVALID_ARG;
+    }
+
+    memset(layout, 0, sizeof(*layout));
+    memset(&parser, 0, sizeof(parser));
+    parser.layout = layout;
+
+    while (pos < length && ret == HURRICANE_HID_PARSE_OK) {
+        uint8_t prefix = desc[pos];
+
+        if (prefix == HID_ITEM_LONG_PREFIX) {
+            // Long items are reserved and carry nothing we use
+            if (pos + 2 >= length) {
+                ret = HURRICANE_HID_PARSE_ERR_TRUNCATED;
+                break;
+            }
+            pos += 3 + desc[pos + 1];
+            continue;
+        }
+
+        uint8_t size = prefix & 0x03;
+        uint8_t type = (prefix >> 2) & 0x03;
+        uint8_t tag = prefix >> 4;
+        if (size == 3) {
+            size = 4;
+        }
+        if (pos + 1 + size > length) {
+            ret = HURRICANE_HID_PARSE_ERR_TRUNCATED;
+            break;
+        }
+
+        uint32_t value = 0;
+        for (uint8_t i = 0; i < size; i++) {
+            value |= (uint32_t)desc[pos + 1 + i] << (8 * i);
+        }
+        int32_t svalue = (int32_t)value;
+        if (size == 1) {
+            svalue = (int8_t)value;
+        } else if (size == 2) {
+            svalue = (int16_t)value;
+        }
+
+        switch (type) {
+            case HID_ITEM_TYPE_MAIN:
+                ret = handle_main(&parser, tag, value);
+                break;
+            case HID_ITEM_TYPE_GLOBAL:
+                ret = handle_global(&parser, tag, value, svalue);
+                break;
+            case HID_ITEM_TYPE_LOCAL:
+                handle_local(&parser, tag, value, size);
+                break;
+            default:
+                break;
+        }
+        pos += 1 + size;
+    }
+
+    if (ret == HURRICANE_HID_PARSE_OK && parser.collection_depth != 0) {
+        ret = HURRICANE_HID_PARSE_ERR_COLLECTION;
+    }
+    if (ret != HURRICANE_HID_PARSE_OK) {
+        printf("[HID parser] Report descriptor rejected at offset %u (%d)\n", pos, ret);
+        memset(layout, 0, sizeof(*layout));
+        return ret;
+    }
+
+    group_fields(layout);
+    return HURRICANE_HID_PARSE_OK;
+}
+
+const hurricane_hid_report_info_t* hurricane_hid_layout_find_report(const hurricane_hid_layout_t* layout,
+                                                                    uint8_t type, uint8_t report_id)
+{
+    if (!layout) {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < layout->num_reports; i++) {
+        const hurricane_hid_report_info_t* report = &layout->reports[i];
+        if (report->type == type && report->report_id == report_id) {
+            return report;
+        }
+    }
+    return NULL;
+}
+
+const hurricane_hid_field_t* hurricane_hid_layout_find_field(const hurricane_hid_layout_t* layout,
+                                                             uint8_t type, uint16_t usage_page,
+                                                             uint16_t usage)
+{
+    if (!layout) {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < layout->num_fields; i++) {
+        const hurricane_hid_field_t* field = &layout->fields[i];
+        if (field->type == type && field->usage_page == usage_page &&
+            usage >= field->usage && usage <= field->usage_max) {
+            return field;
+        }
+    }
+    return NULL;
+}
+
+int32_t hurricane_hid_field_read(const hurricane_hid_field_t* field, const uint8_t* payload,
+                                 uint16_t length, uint16_t index)
+{
+    uint32_t bit = field->bit_offset + (uint32_t)index * field->bit_size;
+    uint32_t byte = bit >> 3;
+    uint8_t shift = bit & 7;
+    uint64_t raw = 0;
+
+    // A 32-bit element starting mid-byte spans at most five bytes
+    for (uint8_t i = 0; i < 5 && byte + i < length; i++) {
+        raw |= (uint64_t)payload[byte + i] << (8 * i);
+    }
+    raw >>= shift;
+
+    uint32_t value = (uint32_t)raw;
+    if (field->bit_size < 32) {
+        value &= (1u << field->bit_size) - 1;
+        if ((field->flags & HURRICANE_HID_FIELD_SIGNED) && (value >> (field->bit_size - 1))) {
+            value |= ~((1u << field->bit_size) - 1);
+        }
+    }
+    return (int32_t)value;
+}
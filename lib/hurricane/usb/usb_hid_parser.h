@@ -0,0 +1,192 @@
+/**
+ * @file usb_hid_parser.h
+ * @brief HID report descriptor parser producing a compiled field layout
+ *
+ * The report descriptor is walked once (global and local item state,
+ * PUSH/POP, usage ranges, extended usages, report IDs) and compiled into a
+ * flat array of field records grouped by report. Everything that handles a
+ * report afterwards only touches that array; nothing is re-parsed per report.
+ *
+ * Layouts are plain structures without pointers, so they can live in static
+ * storage, be copied, or be compared byte for byte.
+ *
+ * Bit offsets are relative to the report payload, i.e. they do not include
+ * the report ID byte that precedes the payload when the device uses report
+ * IDs.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Field records per layout
+ */
+#ifndef HURRICANE_HID_MAX_FIELDS
+#define HURRICANE_HID_MAX_FIELDS 64
+#endif
+
+/**
+ * @brief Distinct (report type, report ID) pairs per layout
+ */
+#ifndef HURRICANE_HID_MAX_REPORTS
+#define HURRICANE_HID_MAX_REPORTS 16
+#endif
+
+/**
+ * @brief Usages and usage ranges collected for a single main item
+ */
+#ifndef HURRICANE_HID_MAX_USAGES
+#define HURRICANE_HID_MAX_USAGES 32
+#endif
+
+/**
+ * @brief Depth of the PUSH/POP global state stack
+ */
+#ifndef HURRICANE_HID_GLOBAL_STACK_DEPTH
+#define HURRICANE_HID_GLOBAL_STACK_DEPTH 4
+#endif
+
+// Parser results
+#define HURRICANE_HID_PARSE_OK                  0
+#define HURRICANE_HID_PARSE_ERR_INVALID_ARG     -1  /**< NULL descriptor or layout */
+#define HURRICANE_HID_PARSE_ERR_TRUNCATED       -2  /**< Item runs past the end of the descriptor */
+#define HURRICANE_HID_PARSE_ERR_TOO_MANY_FIELDS -3  /**< HURRICANE_HID_MAX_FIELDS exceeded */
+#define HURRICANE_HID_PARSE_ERR_TOO_MANY_REPORTS -4 /**< HURRICANE_HID_MAX_REPORTS exceeded */
+#define HURRICANE_HID_PARSE_ERR_STACK           -5  /**< PUSH overflow or POP underflow */
+#define HURRICANE_HID_PARSE_ERR_UNSUPPORTED     -6  /**< Report size above 32 bits, report ID 0 */
+#define HURRICANE_HID_PARSE_ERR_COLLECTION      -7  /**< Unbalanced collections */
+
+/**
+ * @brief Report types, numbered like the wValue high byte of GET/SET_REPORT
+ */
+typedef enum {
+    HURRICANE_HID_REPORT_INPUT = 1,
+    HURRICANE_HID_REPORT_OUTPUT = 2,
+    HURRICANE_HID_REPORT_FEATURE = 3
+} hurricane_hid_report_type_t;
+
+// Field flags: the low bits are the Input/Output/Feature item data bits
+#define HURRICANE_HID_FIELD_CONSTANT    0x0001
+#define HURRICANE_HID_FIELD_VARIABLE    0x0002
+#define HURRICANE_HID_FIELD_RELATIVE    0x0004
+#define HURRICANE_HID_FIELD_WRAP        0x0008
+#define HURRICANE_HID_FIELD_NONLINEAR   0x0010
+#define HURRICANE_HID_FIELD_NO_PREFERRED 0x0020
+#define HURRICANE_HID_FIELD_NULL_STATE  0x0040
+#define HURRICANE_HID_FIELD_VOLATILE    0x0080
+#define HURRICANE_HID_FIELD_BUFFERED    0x0100
+#define HURRICANE_HID_FIELD_SIGNED      0x8000  /**< Set by the parser when logical_min < 0 */
+
+/**
+ * @brief One compiled field: count elements of bit_size bits each
+ *
+ * Variable fields: element i carries usage min(usage + i, usage_max).
+ * Array fields: each element holds an index selecting a usage in
+ * usage..usage_max (offset by logical_min).
+ */
+typedef struct {
+    uint16_t usage_page;
+    uint16_t usage;             /**< Usage of the first element, or usage minimum */
+    uint16_t usage_max;         /**< Last usage (== usage for a single usage) */
+    uint16_t bit_offset;        /**< Offset of the first element within the payload */
+    uint16_t count;             /**< Number of elements */
+    uint16_t flags;             /**< HURRICANE_HID_FIELD_* */
+    uint8_t report_id;          /**< Report ID (0 = device does not use IDs) */
+    uint8_t report_index;       /**< Index into hurricane_hid_layout_t::reports */
+    uint8_t bit_size;           /**< Size of one element, 1..32 */
+    uint8_t type;               /**< hurricane_hid_report_type_t */
+    int32_t logical_min;
+    int32_t logical_max;
+} hurricane_hid_field_t;
+
+/**
+ * @brief One report of the layout and the fields it carries
+ */
+typedef struct {
+    uint8_t report_id;
+    uint8_t type;               /**< hurricane_hid_report_type_t */
+    uint16_t bit_length;        /**< Payload length in bits, padding included */
+    uint8_t first_field;        /**< Index of the first field of this report */
+    uint8_t num_fields;         /**< Fields of this report (constants are not recorded) */
+    uint16_t application_page;  /**< Application collection the report belongs to */
+    uint16_t application_usage;
+} hurricane_hid_report_info_t;
+
+/**
+ * @brief Compiled layout of one report descriptor
+ */
+typedef struct {
+    hurricane_hid_field_t fields[HURRICANE_HID_MAX_FIELDS];
+    hurricane_hid_report_info_t reports[HURRICANE_HID_MAX_REPORTS];
+    uint8_t num_fields;
+    uint8_t num_reports;
+    bool uses_report_ids;       /**< Reports are prefixed with an ID byte */
+} hurricane_hid_layout_t;
+
+/**
+ * @brief Compile a report descriptor into a field layout
+ *
+ * Constant (padding) main items advance the bit offset but do not produce
+ * field records. On failure the layout is left empty.
+ *
+ * @param desc Report descriptor
+ * @param length Descriptor length in bytes
+ * @param layout Output layout
+ * @return HURRICANE_HID_PARSE_OK or a negative HURRICANE_HID_PARSE_ERR_* code
+ */
+int hurricane_hid_parse_report_descriptor(const uint8_t* desc, uint16_t length,
+                                          hurricane_hid_layout_t* layout);
+
+/**
+ * @brief Look up a report by type and ID
+ *
+ * @return Report, or NULL if the descriptor does not define it
+ */
+const hurricane_hid_report_info_t* hurricane_hid_layout_find_report(const hurricane_hid_layout_t* layout,
+                                                                    uint8_t type, uint8_t report_id);
+
+/**
+ * @brief Find the first field of a given type carrying a usage
+ *
+ * @param layout Layout
+ * @param type hurricane_hid_report_type_t
+ * @param usage_page Usage page
+ * @param usage Usage; matches fields whose usage range covers it
+ * @return Field, or NULL if no field carries the usage
+ */
+const hurricane_hid_field_t* hurricane_hid_layout_find_field(const hurricane_hid_layout_t* layout,
+                                                             uint8_t type, uint16_t usage_page,
+                                                             uint16_t usage);
+
+/**
+ * @brief Payload size of a report in bytes, without the report ID byte
+ */
+static inline uint16_t hurricane_hid_report_payload_size(const hurricane_hid_report_info_t* report)
+{
+    return (uint16_t)((report->bit_length + 7) / 8);
+}
+
+/**
+ * @brief Read one element of a field from a report payload
+ *
+ * Signed fields are sign extended. Bits beyond the end of the payload read
+ * as zero, so short reports decode as "no movement / not pressed".
+ *
+ * @param field Field
+ * @param payload Report payload (after the report ID byte, if any)
+ * @param length Payload length in bytes
+ * @param index Element index, < field->count
+ * @return Element value
+ */
+int32_t hurricane_hid_field_read(const hurricane_hid_field_t* field, const uint8_t* payload,
+                                 uint16_t length, uint16_t index);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,552 @@
+/*
+ * @file usb_hid_pipeline.c
+ * @brief Static proxy pipelines from host-side reports to device-side endpoints
+ */
+
+#include "usb_hid_pipeline.h"
+#include "hw/hurricane_hw_ops.h"
+#include "core/hurricane_cycles.h"
+#include <stddef.h>
+#include <string.h>
+
+// Map move kinds
+enum {
+    MOVE_VALUES = 0,        // Multi-bit variables, copied as they are
+    MOVE_BITS,              // 1-bit variables, a bitmask word at a time
+    MOVE_ARRAY,             // Key array into key array
+    MOVE_ARRAY_TO_BITS,     // Key array into a bitmap
+    MOVE_BITS_TO_ARRAY      // Bitmap (e.g. NKRO) into a key array
+};
+
+static bool is_bitmap(const hurricane_hid_field_t* field)
+{
+    return (field->flags & HURRICANE_HID_FIELD_VARIABLE) && field->bit_size == 1;
+}
+
+// Last usage a field can report
+static uint16_t last_usage(const hurricane_hid_field_t* field)
+{
+    if (!(field->flags & HURRICANE_HID_FIELD_VARIABLE)) {
+        return field->usage_max;
+    }
+    uint32_t last = (uint32_t)field->usage + field->count - 1;
+    return last < field->usage_max ? (uint16_t)last : field->usage_max;
+}
+
+static hurricane_hid_pipe_move_t* add_move(hurricane_hid_pipe_source_t* pipe, uint8_t kind)
+{
+    if (pipe->num_moves >= HURRICANE_HID_PIPE_MAX_MOVES) {
+        return NULL;
+    }
+    hurricane_hid_pipe_move_t* move = &pipe->moves[pipe->num_moves++];
+    memset(move, 0, sizeof(*move));
+    move->kind = kind;
+    return move;
+}
+
+// Moves carrying the usages src and dst have in common
+static int compile_field_moves(hurricane_hid_pipe_source_t* pipe, const hurricane_hid_field_t* src, uint16_t src_index,
+                               const hurricane_hid_field_t* dst, uint16_t dst_index)
+{
+    uint16_t lo = src->usage > dst->usage ? src->usage : dst->usage;
+    uint16_t hi = last_usage(src) < last_usage(dst) ? last_usage(src) : last_usage(dst);
+    bool src_array = !(src->flags & HURRICANE_HID_FIELD_VARIABLE);
+    bool dst_array = !(dst->flags & HURRICANE_HID_FIELD_VARIABLE);
+    hurricane_hid_pipe_move_t* move;
+
+    if (src->usage_page != dst->usage_page || lo > hi) {
+        return 0;
+    }
+
+    if (is_bitmap(src) && is_bitmap(dst)) {
+        // One move per run of bits that stays within one word on both sides
+        for (uint32_t u = lo; u <= hi; ) {
+            uint16_t src_bit = (uint16_t)(u - src->usage);
+            uint16_t dst_bit = (uint16_t)(u - dst->usage);
+            uint32_t n = 32 - (src_bit % 32 > dst_bit % 32 ? src_bit % 32 : dst_bit % 32);
+            if (n > hi - u + 1) {
+                n = hi - u + 1;
+            }
+            if (!(move = add_move(pipe, MOVE_BITS))) {
+                return HURRICANE_HID_PIPELINE_ERR_TOO_COMPLEX;
+            }
+            move->src = src_index + src_bit / 32;
+            move->dst = dst_index + dst_bit / 32;
+            move->src_shift = src_bit % 32;
+            move->dst_shift = dst_bit % 32;
+            move->mask = n == 32 ? 0xFFFFFFFFu : (1u << n) - 1;
+            u += n;
+        }
+        return 0;
+    }
+
+    if (!src_array && !dst_array) {
+        if (is_bitmap(src) || is_bitmap(dst)) {
+            return 0;
+        }
+        if (!(move = add_move(pipe, MOVE_VALUES))) {
+            return HURRICANE_HID_PIPELINE_ERR_TOO_COMPLEX;
+        }
+        move->src = src_index + (lo - src->usage);
+        move->dst = dst_index + (lo - dst->usage);
+        move->src_count = hi - lo + 1;
+        return 0;
+    }
+
+    if (src_array && (dst_array || is_bitmap(dst))) {
+        if (!(move = add_move(pipe, dst_array ? MOVE_ARRAY : MOVE_ARRAY_TO_BITS))) {
+            return HURRICANE_HID_PIPELINE_ERR_TOO_COMPLEX;
+        }
+        move->src = src_index;
+        move->src_count = src->count;
+        move->dst = dst_index;
+        move->dst_count = dst->count;
+        move->lo = (int32_t)lo - src->usage + src->logical_min;
+        move->hi = (int32_t)hi - src->usage + src->logical_min;
+        move->offset = (int32_t)src->usage - src->logical_min - dst->usage;
+        if (dst_array) {
+            move->offset += dst->logical_min;
+        }
+        return 0;
+    }
+
+    if (is_bitmap(src) && dst_array) {
+        if (!(move = add_move(pipe, MOVE_BITS_TO_ARRAY))) {
+            return HURRICANE_HID_PIPELINE_ERR_TOO_COMPLEX;
+        }
+        move->src = src_index;
+        move->dst = dst_index;
+        move->dst_count = dst->count;
+        move->lo = lo - src->usage;
+        move->hi = hi - src->usage;
+        move->offset = (int32_t)src->usage - dst->usage + dst->logical_min;
+    }
+    return 0;
+}
+
+static int compile_moves(hurricane_hid_pipe_source_t* pipe, const hurricane_hid_layout_t* source,
+                         const hurricane_hid_pipe_t* sink)
+{
+    const hurricane_hid_decode_plan_t* decode = &pipe->decode;
+    const hurricane_hid_pack_plan_t* pack = &sink->pack;
+
+    pipe->num_moves = 0;
+    for (uint8_t d = 0; d < pack->num_fields; d++) {
+        for (uint8_t s = 0; s < decode->num_fields; s++) {
+            int result = compile_field_moves(pipe, &source->fields[decode->first_field + s], decode->field_value[s],
+                                             &sink->sink_layout.fields[pack->first_field + d], pack->field_value[d]);
+            if (result < 0) {
+                return result;
+            }
+        }
+    }
+    return 0;
+}
+
+// Put a key into the first free slot of an array; a full array drops it like any rollover
+static inline void array_add(int32_t* slots, uint16_t count, int32_t raw)
+{
+    for (uint16_t i = 0; i < count; i++) {
+        if (slots[i] == raw) {
+            return;
+        }
+        if (slots[i] == 0) {
+            slots[i] = raw;
+            return;
+        }
+    }
+}
+
+static void run_moves(const hurricane_hid_pipe_source_t* pipe, const int32_t* src, int32_t* dst)
+{
+    for (uint8_t i = 0; i < pipe->num_moves; i++) {
+        const hurricane_hid_pipe_move_t* move = &pipe->moves[i];
+
+        switch (move->kind) {
+        case MOVE_VALUES:
+            memcpy(&dst[move->dst], &src[move->src], move->src_count * sizeof(int32_t));
+            break;
+        case MOVE_BITS: {
+            uint32_t bits = ((uint32_t)src[move->src] >> move->src_shift) & move->mask;
+            dst[move->dst] = (int32_t)((uint32_t)dst[move->dst] | (bits << move->dst_shift));
+            break;
+        }
+        case MOVE_ARRAY:
+        case MOVE_ARRAY_TO_BITS:
+            for (uint16_t e = 0; e < move->src_count; e++) {
+                int32_t raw = src[move->src + e];
+                if (raw < move->lo || raw > move->hi) {
+                    continue;
+                }
+                int32_t out = raw + move->offset;
+                if (move->kind == MOVE_ARRAY_TO_BITS) {
+                    dst[move->dst + out / 32] = (int32_t)((uint32_t)dst[move->dst + out / 32] | (1u << (out % 32)));
+                } else if (out != 0) {
+                    array_add(&dst[move->dst], move->dst_count, out);
+                }
+            }
+            break;
+        case MOVE_BITS_TO_ARRAY:
+            for (int32_t word = move->lo / 32; word <= move->hi / 32; word++) {
+                uint32_t bits = (uint32_t)src[move->src + word];
+                if (word == move->lo / 32) {
+                    bits &= 0xFFFFFFFFu << (move->lo % 32);
+                }
+                if (word == move->hi / 32 && move->hi % 32 != 31) {
+                    bits &= (1u << (move->hi % 32 + 1)) - 1;
+                }
+                while (bits) {
+                    int32_t bit = word * 32 + __builtin_ctz(bits);
+                    bits &= bits - 1;
+                    array_add(&dst[move->dst], move->dst_count, bit + move->offset);
+                }
+            }
+            break;
+        }
+    }
+}
+
+// Charge the time since *mark to a stage and restart the clock
+static inline void stage_done(const hurricane_hid_pipeline_t* pipeline, hurricane_hid_pipe_t* pipe,
+                              uint8_t stage, uint32_t* mark)
+{
+    if (pipeline->profile) {
+        uint32_t now = hurricane_cycles_now();
+        pipe->cycles[stage] += now - *mark;
+        pipe->runs[stage]++;
+        *mark = now;
+    }
+}
+
+// Build, encode, filter and send the merged report of a pipe
+static int flush_pipe(hurricane_hid_pipeline_t* pipeline, uint8_t index, uint32_t now_ms)
+{
+    hurricane_hid_pipe_t* pipe = &pipeline->pipes[index];
+    uint32_t mark = pipeline->profile ? hurricane_cycles_now() : 0;
+
+    hurricane_hid_merge_build(&pipeline->merges[index], pipe->sink_values);
+    stage_done(pipeline, pipe, HURRICANE_HID_PIPE_STAGE_MERGE, &mark);
+
+    int length = hurricane_hid_pack(&pipe->pack, pipe->sink_values, pipe->report, sizeof(pipe->report));
+    stage_done(pipeline, pipe, HURRICANE_HID_PIPE_STAGE_ENCODE, &mark);
+    if (length < 0) {
+        return 0;
+    }
+
+    uint8_t header = pipe->pack.report_id ? 1 : 0;
+    int verdict = hurricane_hid_delta_filter_submit(&pipe->filter, pipe->pack.report_id, pipe->report + header,
+                                                    (uint16_t)(length - header), now_ms);
+    stage_done(pipeline, pipe, HURRICANE_HID_PIPE_STAGE_FILTER, &mark);
+    if (verdict == HURRICANE_HID_DELTA_SUPPRESSED) {
+        return 0;
+    }
+
+    int result = hurricane_hw_device_interrupt_in_transfer_on(pipe->sink_controller, pipe->config->sink_endpoint,
+                                                              pipe->report, (uint16_t)length);
+    stage_done(pipeline, pipe, HURRICANE_HID_PIPE_STAGE_SINK, &mark);
+    if (result < 0) {
+        pipe->sink_errors++;
+        return 0;
+    }
+    pipe->sent++;
+    return 1;
+}
+
+int hurricane_hid_pipeline_init(hurricane_hid_pipeline_t* pipeline, const hurricane_hid_pipeline_config_t* config)
+{
+    if (!pipeline || !config || (config->num_pipes && !config->pipes) ||
+        config->num_pipes > HURRICANE_HID_PIPELINE_MAX_PIPES) {
+        return HURRICANE_HID_PIPELINE_ERR_INVALID_ARG;
+    }
+
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->config = config;
+    hurricane_hid_demux_init(&pipeline->source.demux, NULL);
+
+    for (uint8_t i = 0; i < config->num_pipes; i++) {
+        hurricane_hid_pipe_t* pipe = &pipeline->pipes[i];
+        const hurricane_hid_pipe_config_t* pc = &config->pipes[i];
+
+        pipe->config = pc;
+        pipe->sink_controller = pc->sink_controller;
+        if (!pc->sink_descriptor ||
+            hurricane_hid_parse_report_descriptor(pc->sink_descriptor, pc->sink_descriptor_length,
+                                                  &pipe->sink_layout) != HURRICANE_HID_PARSE_OK ||
+            hurricane_hid_pack_plan_build(&pipe->sink_layout, HURRICANE_HID_REPORT_INPUT, pc->sink_report_id,
+                                          &pipe->pack) != 0 ||
+            hurricane_hid_merge_init(&pipeline->merges[i], &pipe->sink_layout, &pipe->pack) != 0) {
+            return HURRICANE_HID_PIPELINE_ERR_SINK;
+        }
+        hurricane_hid_delta_filter_init(&pipe->filter, (pc->flags & HURRICANE_HID_PIPE_DELTA) != 0);
+        hurricane_hid_delta_filter_use_layout(&pipe->filter, &pipe->sink_layout);
+    }
+    return 0;
+}
+
+int hurricane_hid_pipeline_source_attach(const hurricane_hid_pipeline_t* pipeline,
+                                         hurricane_hid_pipeline_source_t* source,
+                                         const uint8_t* descriptor, uint16_t length)
+{
+    if (!pipeline || !pipeline->config || !source || !descriptor) {
+        return HURRICANE_HID_PIPELINE_ERR_INVALID_ARG;
+    }
+
+    hurricane_hid_layout_t* layout = &source->layout;
+    int active = 0;
+
+    hurricane_hid_pipeline_source_detach(source);
+    if (hurricane_hid_parse_report_descriptor(descriptor, length, layout) != HURRICANE_HID_PARSE_OK) {
+        return HURRICANE_HID_PIPELINE_ERR_SOURCE;
+    }
+    hurricane_hid_demux_init(&source->demux, layout);
+
+    for (uint8_t i = 0; i < pipeline->config->num_pipes; i++) {
+        hurricane_hid_pipe_source_t* pipe = &source->pipes[i];
+        const hurricane_hid_pipe_config_t* pc = &pipeline->config->pipes[i];
+        const hurricane_hid_report_info_t* info = NULL;
+
+        for (uint8_t r = 0; r < layout->num_reports && !info; r++) {
+            const hurricane_hid_report_info_t* candidate = &layout->reports[r];
+            if (candidate->type == HURRICANE_HID_REPORT_INPUT &&
+                candidate->application_page == pc->source_page &&
+                candidate->application_usage == pc->source_usage &&
+                (!pc->source_report_id || candidate->report_id == pc->source_report_id)) {
+                info = candidate;
+            }
+        }
+        if (!info ||
+            hurricane_hid_decode_plan_build(layout, HURRICANE_HID_REPORT_INPUT, info->report_id, &pipe->decode) != 0) {
+            continue;
+        }
+
+        if (hurricane_hid_transform_compile(&pipe->transform, pc->rules, pc->num_rules, layout, &pipe->decode) != 0) {
+            hurricane_hid_pipeline_source_detach(source);
+            return HURRICANE_HID_PIPELINE_ERR_BAD_RULE;
+        }
+
+        // A report feeds one pipe; a second route would replace the first
+        if (source->demux.index[info->report_id] != HURRICANE_HID_DEMUX_NO_ROUTE) {
+            hurricane_hid_pipeline_source_detach(source);
+            return HURRICANE_HID_PIPELINE_ERR_CONFLICT;
+        }
+
+        int result = compile_moves(pipe, layout, &pipeline->pipes[i]);
+        if (result < 0) {
+            hurricane_hid_pipeline_source_detach(source);
+            return result;
+        }
+
+        hurricane_hid_demux_route_t route = {
+            .pipe = i,
+            .flags = HURRICANE_HID_DEMUX_STRIP_ID
+        };
+        if (hurricane_hid_demux_add_route(&source->demux, info->report_id, &route) < 0) {
+            continue;
+        }
+        pipe->active = true;
+        active++;
+    }
+
+    source->attached = true;
+    return active;
+}
+
+void hurricane_hid_pipeline_source_detach(hurricane_hid_pipeline_source_t* source)
+{
+    if (!source) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < HURRICANE_HID_PIPELINE_MAX_PIPES; i++) {
+        source->pipes[i].active = false;
+    }
+    hurricane_hid_demux_init(&source->demux, NULL);
+    source->attached = false;
+}
+
+int hurricane_hid_pipeline_attach(hurricane_hid_pipeline_t* pipeline, const uint8_t* descriptor, uint16_t length)
+{
+    if (!pipeline) {
+        return HURRICANE_HID_PIPELINE_ERR_INVALID_ARG;
+    }
+    return hurricane_hid_pipeline_source_attach(pipeline, &pipeline->source, descriptor, length);
+}
+
+void hurricane_hid_pipeline_detach(hurricane_hid_pipeline_t* pipeline)
+{
+    if (!pipeline || !pipeline->source.attached) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < pipeline->config->num_pipes; i++) {
+        hurricane_hid_pipe_t* pipe = &pipeline->pipes[i];
+        if (!pipeline->source.pipes[i].active) {
+            continue;
+        }
+        memset(pipe->sink_values, 0, sizeof(pipe->sink_values));
+        hurricane_hid_merge_live(&pipeline->merges[i], pipe->sink_values);
+        flush_pipe(pipeline, i, 0);
+    }
+
+    hurricane_hid_pipeline_source_detach(&pipeline->source);
+}
+
+// Decode, transform and map a host-side report of a source into its pipe's merge
+static int relay(hurricane_hid_pipeline_t* pipeline, hurricane_hid_pipeline_source_t* source,
+                 hurricane_hid_merge_t* merges, const uint8_t* report, uint16_t length)
+{
+    uint32_t mark = pipeline->profile ? hurricane_cycles_now() : 0;
+    hurricane_hid_demux_output_t out;
+    int index = hurricane_hid_demux_dispatch(&source->demux, report, length, &out);
+    if (index < 0) {
+        return HURRICANE_HID_PIPELINE_ERR_NO_ROUTE;
+    }
+
+    hurricane_hid_pipe_source_t* from = &source->pipes[index];
+    hurricane_hid_pipe_t* pipe = &pipeline->pipes[index];
+    hurricane_hid_decode(&from->decode, out.data, out.length, source->values);
+    stage_done(pipeline, pipe, HURRICANE_HID_PIPE_STAGE_DECODE, &mark);
+
+    if (hurricane_hid_transform_active(&from->transform)) {
+        hurricane_hid_transform_run(&from->transform, source->values);
+        stage_done(pipeline, pipe, HURRICANE_HID_PIPE_STAGE_TRANSFORM, &mark);
+    }
+
+    memset(pipe->sink_values, 0, pipe->pack.num_values * sizeof(int32_t));
+    run_moves(from, source->values, pipe->sink_values);
+    hurricane_hid_merge_live(&merges[index], pipe->sink_values);
+    stage_done(pipeline, pipe, HURRICANE_HID_PIPE_STAGE_MAP, &mark);
+    return index;
+}
+
+int hurricane_hid_pipeline_flush(hurricane_hid_pipeline_t* pipeline, uint8_t pipe, uint32_t now_ms)
+{
+    if (!pipeline || !pipeline->config || pipe >= pipeline->config->num_pipes) {
+        return 0;
+    }
+    return flush_pipe(pipeline, pipe, now_ms);
+}
+
+int hurricane_hid_pipeline_retarget(hurricane_hid_pipeline_t* pipeline, uint8_t controller)
+{
+    int sent = 0;
+
+    if (!pipeline || !pipeline->config) {
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < pipeline->config->num_pipes; i++) {
+        hurricane_hid_pipe_t* pipe = &pipeline->pipes[i];
+        if (pipe->sink_controller == controller) {
+            continue;
+        }
+
+        // Everything released on the old PC; the merge starts over empty
+        hurricane_hid_merge_init(&pipeline->merges[i], &pipe->sink_layout, &pipe->pack);
+        memset(pipe->sink_values, 0, sizeof(pipe->sink_values));
+        hurricane_hid_merge_live(&pipeline->merges[i], pipe->sink_values);
+        sent += flush_pipe(pipeline, i, 0);
+
+        hurricane_hid_delta_filter_reset(&pipe->filter);
+        pipe->sink_controller = controller;
+    }
+    return sent;
+}
+
+int hurricane_hid_pipeline_relay(hurricane_hid_pipeline_t* pipeline, const uint8_t* report, uint16_t length)
+{
+    if (!pipeline || !report) {
+        return HURRICANE_HID_PIPELINE_ERR_INVALID_ARG;
+    }
+    return relay(pipeline, &pipeline->source, pipeline->merges, report, length);
+}
+
+int hurricane_hid_pipeline_source_relay(hurricane_hid_pipeline_t* pipeline, hurricane_hid_pipeline_source_t* source,
+                                        hurricane_hid_merge_t* merges, const uint8_t* report, uint16_t length)
+{
+    if (!pipeline || !pipeline->config || !source || !merges || !report) {
+        return HURRICANE_HID_PIPELINE_ERR_INVALID_ARG;
+    }
+    return relay(pipeline, source, merges, report, length);
+}
+
+int hurricane_hid_pipeline_submit(hurricane_hid_pipeline_t* pipeline, const uint8_t* report, uint16_t length,
+                                  uint32_t now_ms)
+{
+    if (!pipeline || !report) {
+        return HURRICANE_HID_PIPELINE_ERR_INVALID_ARG;
+    }
+
+    int index = relay(pipeline, &pipeline->source, pipeline->merges, report, length);
+    if (index >= 0 && !(pipeline->pipes[index].config->flags & HURRICANE_HID_PIPE_DEFER)) {
+        flush_pipe(pipeline, (uint8_t)index, now_ms);
+    }
+    return index;
+}
+
+int hurricane_hid_pipeline_run(hurricane_hid_pipeline_t* pipeline, uint32_t now_ms)
+{
+    if (!pipeline || !pipeline->config) {
+        return 0;
+    }
+
+    const hurricane_hid_pipeline_config_t* config = pipeline->config;
+    int sent = 0;
+
+    if (pipeline->source.attached && config->source_endpoint) {
+        int length = hurricane_hw_host_interrupt_in_transfer_on(config->source_controller, config->source_endpoint,
+                                                                pipeline->source_report,
+                                                                sizeof(pipeline->source_report));
+        if (length > 0) {
+            relay(pipeline, &pipeline->source, pipeline->merges, pipeline->source_report, (uint16_t)length);
+        }
+    }
+
+    for (uint8_t i = 0; i < config->num_pipes; i++) {
+        hurricane_hid_pipe_t* pipe = &pipeline->pipes[i];
+
+        // Live and injected input, motion carried over from the last report
+        if (hurricane_hid_merge_pending(&pipeline->merges[i])) {
+            sent += flush_pipe(pipeline, i, now_ms);
+        }
+
+        // Repeats of unchanged reports whose SET_IDLE period ran out
+        uint8_t header = pipe->pack.report_id ? 1 : 0;
+        uint8_t report_id;
+        int length = hurricane_hid_delta_filter_poll(&pipe->filter, now_ms, &report_id, &pipe->report[1],
+                                                     sizeof(pipe->report) - 1);
+        if (length > 0) {
+            pipe->report[0] = report_id;
+            if (hurricane_hw_device_interrupt_in_transfer_on(pipe->sink_controller, pipe->config->sink_endpoint,
+                                                             &pipe->report[1 - header],
+                                                             (uint16_t)(length + header)) >= 0) {
+                pipe->sent++;
+                sent++;
+            }
+        }
+    }
+    return sent;
+}
+
+void hurricane_hid_pipeline_set_profiling(hurricane_hid_pipeline_t* pipeline, bool enable)
+{
+    if (!pipeline) {
+        return;
+    }
+
+    pipeline->profile = enable;
+    for (uint8_t i = 0; i < HURRICANE_HID_PIPELINE_MAX_PIPES; i++) {
+        memset(pipeline->pipes[i].cycles, 0, sizeof(pipeline->pipes[i].cycles));
+        memset(pipeline->pipes[i].runs, 0, sizeof(pipeline->pipes[i].runs));
+    }
+}
+
+uint32_t hurricane_hid_pipeline_stage_cost(const hurricane_hid_pipeline_t* pipeline, uint8_t pipe, uint8_t stage)
+{
+    if (!pipeline || pipe >= HURRICANE_HID_PIPELINE_MAX_PIPES || stage >= HURRICANE_HID_PIPE_NUM_STAGES) {
+        return 0;
+    }
+
+    const hurricane_hid_pipe_t* p = &pipeline->pipes[pipe];
+    return p->runs[stage] ? p->cycles[stage] / p->runs[stage] : 0;
+}
@@ -0,0 +1,362 @@
+/**
+ * @file usb_hid_pipeline.h
+ * @brief Static proxy pipelines from host-side reports to device-side endpoints
+ *
+ * The building blocks (demux, decode, transform, merge, pack, delta filter)
+ * used to be wired together by every application, with a fresh stack buffer
+ * and a usage lookup per field in each relayed report. A pipeline does that
+ * wiring once from a constant table: each pipe connects one report of the
+ * host-side interface to a device-side interrupt IN endpoint through a
+ * fixed sequence of stages,
+ *
+ *   decode -> transform -> map -> merge -> encode -> filter -> sink
+ *
+ *  - decode:    route by report ID and extract the field values,
+ *  - transform: the pipe's rule table (usb_hid_transform.h),
+ *  - map:       copy values into the sink report's layout, by usage, with
+ *               moves compiled at attach time (buttons a word at a time,
+ *               key arrays and key bitmaps converted into each other),
+ *  - merge:     combine with injected input (usb_hid_merge.h),
+ *  - encode:    pack the sink report,
+ *  - filter:    drop unchanged reports, keep the SET_IDLE contract,
+ *  - sink:      interrupt IN transfer on the device side.
+ *
+ * All storage lives in hurricane_hid_pipeline_t; stages hand each other the
+ * pipe's value arrays and report buffer by reference, nothing is allocated
+ * or copied on the way. The state of the attached device (decode plans,
+ * transforms, map moves) is kept apart from the sinks', so several devices
+ * can feed one set of sinks without a copy of it each. The filter runs on
+ * the encoded report rather than on the host-side one, since the SET_IDLE
+ * contract is with the PC.
+ *
+ * Each stage can be timed with hurricane_cycles.h, per pipe.
+ *
+ * A typical proxy:
+ *
+ *   static const hurricane_hid_pipe_config_t pipes[] = {
+ *       { .source_page = 0x01, .source_usage = 0x02, .sink_endpoint = 0x81,
+ *         .sink_descriptor = mouse_desc, .sink_descriptor_length = sizeof(mouse_desc),
+ *         .flags = HURRICANE_HID_PIPE_DELTA },
+ *   };
+ *   static const hurricane_hid_pipeline_config_t proxy = { .source_endpoint = 0x81, .pipes = pipes, .num_pipes = 1 };
+ *
+ *   hurricane_hid_pipeline_init(&pipeline, &proxy);
+ *   hurricane_hid_pipeline_attach(&pipeline, report_desc, report_desc_length);
+ *   for (;;) hurricane_hid_pipeline_run(&pipeline, hurricane_get_time_ms());
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_hid_parser.h"
+#include "usb_hid_decode.h"
+#include "usb_hid_transform.h"
+#include "usb_hid_merge.h"
+#include "usb_hid_pack.h"
+#include "usb_hid_delta_filter.h"
+#include "usb_hid_demux.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pipes per pipeline
+ */
+#ifndef HURRICANE_HID_PIPELINE_MAX_PIPES
+#define HURRICANE_HID_PIPELINE_MAX_PIPES 4
+#endif
+
+/**
+ * @brief Compiled map moves per pipe
+ */
+#ifndef HURRICANE_HID_PIPE_MAX_MOVES
+#define HURRICANE_HID_PIPE_MAX_MOVES 32
+#endif
+
+// Errors
+#define HURRICANE_HID_PIPELINE_ERR_INVALID_ARG  -1  /**< NULL argument or too many pipes */
+#define HURRICANE_HID_PIPELINE_ERR_SINK         -2  /**< Sink descriptor has no usable input report */
+#define HURRICANE_HID_PIPELINE_ERR_SOURCE       -3  /**< Source descriptor does not compile */
+#define HURRICANE_HID_PIPELINE_ERR_BAD_RULE     -4  /**< Transform rules do not compile */
+#define HURRICANE_HID_PIPELINE_ERR_TOO_COMPLEX  -5  /**< More than HURRICANE_HID_PIPE_MAX_MOVES moves */
+#define HURRICANE_HID_PIPELINE_ERR_NO_ROUTE     -6  /**< Not attached, or the report ID feeds no pipe */
+#define HURRICANE_HID_PIPELINE_ERR_CONFLICT     -7  /**< Two pipes take the same source report */
+
+// Pipe flags
+#define HURRICANE_HID_PIPE_DELTA    0x01    /**< Suppress unchanged reports */
+#define HURRICANE_HID_PIPE_DEFER    0x02    /**< Send from hurricane_hid_pipeline_run() only, one report per call */
+
+/**
+ * @brief Timed stages of a pipe
+ */
+typedef enum {
+    HURRICANE_HID_PIPE_STAGE_DECODE = 0,    /**< Report ID lookup and field extraction */
+    HURRICANE_HID_PIPE_STAGE_TRANSFORM,
+    HURRICANE_HID_PIPE_STAGE_MAP,           /**< Map into the sink layout, feed the merge */
+    HURRICANE_HID_PIPE_STAGE_MERGE,         /**< Build the merged report */
+    HURRICANE_HID_PIPE_STAGE_ENCODE,
+    HURRICANE_HID_PIPE_STAGE_FILTER,
+    HURRICANE_HID_PIPE_STAGE_SINK,
+    HURRICANE_HID_PIPE_NUM_STAGES
+} hurricane_hid_pipe_stage_t;
+
+/**
+ * @brief One pipe as declared by the application
+ */
+typedef struct {
+    uint16_t source_page;                   /**< Application collection of the host-side report */
+    uint16_t source_usage;
+    uint8_t source_report_id;               /**< 0: first input report of the collection */
+    uint8_t sink_controller;                /**< Device-side controller instance */
+    uint8_t sink_interface;                 /**< Device-side interface owning sink_endpoint */
+    uint8_t sink_endpoint;                  /**< Device-side interrupt IN endpoint */
+    uint8_t sink_report_id;                 /**< Input report of the sink descriptor (0 = no IDs) */
+    uint8_t flags;                          /**< HURRICANE_HID_PIPE_* */
+    uint8_t num_rules;
+    const hurricane_hid_transform_rule_t* rules;    /**< Optional transform, applied to host-side values */
+    const uint8_t* sink_descriptor;         /**< Report descriptor the PC sees on the sink interface */
+    uint16_t sink_descriptor_length;
+} hurricane_hid_pipe_config_t;
+
+/**
+ * @brief A pipeline as declared by the application
+ */
+typedef struct {
+    uint8_t source_controller;              /**< Host-side controller instance */
+    uint8_t source_endpoint;                /**< Interrupt IN endpoint read by hurricane_hid_pipeline_run(), 0 = reports are submitted */
+    uint8_t num_pipes;
+    const hurricane_hid_pipe_config_t* pipes;
+} hurricane_hid_pipeline_config_t;
+
+/**
+ * @brief One compiled map step
+ */
+typedef struct {
+    uint8_t kind;                           /**< Internal move kind */
+    uint8_t src_shift;                      /**< Bitmask moves: first bit */
+    uint8_t dst_shift;
+    uint16_t src;                           /**< Value index in the source values */
+    uint16_t dst;                           /**< Value index in the sink values */
+    uint16_t src_count;                     /**< Values read (array elements, copied values) */
+    uint16_t dst_count;                     /**< Array slots written */
+    uint32_t mask;                          /**< Bitmask moves: bits moved */
+    int32_t lo;                             /**< Array and bitmap sources: range that maps to the sink */
+    int32_t hi;
+    int32_t offset;                         /**< Added to a source raw value or bit to get the sink's */
+} hurricane_hid_pipe_move_t;
+
+/**
+ * @brief Source side of one pipe: how the attached device's report maps into the sink
+ */
+typedef struct {
+    bool active;                            /**< The attached device has the source report */
+    uint8_t num_moves;
+    hurricane_hid_decode_plan_t decode;
+    hurricane_hid_transform_t transform;
+    hurricane_hid_pipe_move_t moves[HURRICANE_HID_PIPE_MAX_MOVES];
+} hurricane_hid_pipe_source_t;
+
+/**
+ * @brief Source side of a pipeline: one attached host-side device
+ *
+ * Compiled against the sink side of a pipeline, whose layouts and pack
+ * plans it shares. A pipeline has one; usb_hid_aggregate.h keeps several
+ * per pipeline.
+ */
+typedef struct {
+    bool attached;
+    hurricane_hid_layout_t layout;
+    hurricane_hid_demux_t demux;
+    hurricane_hid_pipe_source_t pipes[HURRICANE_HID_PIPELINE_MAX_PIPES];
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];    /**< Decoded values of the report being relayed */
+} hurricane_hid_pipeline_source_t;
+
+/**
+ * @brief Sink side of one pipe
+ */
+typedef struct {
+    const hurricane_hid_pipe_config_t* config;
+    uint8_t sink_controller;                /**< Controller the pipe sends on (see hurricane_hid_pipeline_retarget()) */
+    hurricane_hid_layout_t sink_layout;
+    hurricane_hid_pack_plan_t pack;
+    hurricane_hid_delta_filter_t filter;
+    int32_t sink_values[HURRICANE_HID_MAX_DECODE_VALUES];
+    uint8_t report[HURRICANE_HID_DEMUX_MAX_REPORT];  /**< Encoded sink report */
+    uint32_t sent;                          /**< Reports handed to the sink */
+    uint32_t sink_errors;                   /**< Transfers the sink refused */
+    uint32_t cycles[HURRICANE_HID_PIPE_NUM_STAGES]; /**< Profiling: total cost per stage */
+    uint32_t runs[HURRICANE_HID_PIPE_NUM_STAGES];   /**< Profiling: passes per stage */
+} hurricane_hid_pipe_t;
+
+/**
+ * @brief A pipeline; must not move after hurricane_hid_pipeline_init()
+ */
+typedef struct {
+    const hurricane_hid_pipeline_config_t* config;
+    bool profile;                           /**< Time each stage */
+    hurricane_hid_pipeline_source_t source;
+    hurricane_hid_pipe_t pipes[HURRICANE_HID_PIPELINE_MAX_PIPES];
+    hurricane_hid_merge_t merges[HURRICANE_HID_PIPELINE_MAX_PIPES]; /**< Per pipe; pass to hurricane_inject_sched_run() */
+    uint8_t source_report[HURRICANE_HID_DEMUX_MAX_REPORT];
+} hurricane_hid_pipeline_t;
+
+/**
+ * @brief Set up the sink side of every pipe of a static table
+ *
+ * Compiles the sink descriptors and prepares merge and filter state. No
+ * report flows until a source is attached.
+ *
+ * @param pipeline Pipeline storage
+ * @param config Pipeline table, referenced, not copied
+ * @return 0 on success, negative HURRICANE_HID_PIPELINE_ERR_* code on failure
+ */
+int hurricane_hid_pipeline_init(hurricane_hid_pipeline_t* pipeline, const hurricane_hid_pipeline_config_t* config);
+
+/**
+ * @brief Attach the host-side device
+ *
+ * Compiles its report descriptor, routes each pipe's source report and
+ * compiles transforms and map moves. Pipes whose source report the device
+ * does not have stay idle. A report feeds one pipe only; if two pipes take
+ * the same report, nothing is attached.
+ *
+ * @param pipeline Pipeline
+ * @param descriptor Report descriptor of the host-side interface
+ * @param length Descriptor length
+ * @return Number of active pipes, or negative HURRICANE_HID_PIPELINE_ERR_* code
+ */
+int hurricane_hid_pipeline_attach(hurricane_hid_pipeline_t* pipeline, const uint8_t* descriptor, uint16_t length);
+
+/**
+ * @brief Detach the host-side device
+ *
+ * Sends a report with the relayed input released on every active pipe, so
+ * no button stays held on the PC. Injected input is kept.
+ *
+ * @param pipeline Pipeline
+ */
+void hurricane_hid_pipeline_detach(hurricane_hid_pipeline_t* pipeline);
+
+/**
+ * @brief Feed one host-side report into its pipe's merge without sending
+ *
+ * Decode, transform and map only; the merge stays pending for whoever
+ * builds it next.
+ *
+ * @param pipeline Pipeline
+ * @param report Report as received, including the ID byte if the device uses IDs
+ * @param length Report length
+ * @return Pipe index, or negative HURRICANE_HID_PIPELINE_ERR_* code
+ */
+int hurricane_hid_pipeline_relay(hurricane_hid_pipeline_t* pipeline, const uint8_t* report, uint16_t length);
+
+/**
+ * @brief Compile a host-side device against the sink side of a pipeline
+ *
+ * Like hurricane_hid_pipeline_attach(), for a source kept apart from the
+ * pipeline (usb_hid_aggregate.h). The source references the pipeline's
+ * sink layouts and pack plans, not copies.
+ *
+ * @param pipeline Initialized pipeline providing the sinks
+ * @param source Source storage
+ * @param descriptor Report descriptor of the host-side interface
+ * @param length Descriptor length
+ * @return Number of active pipes, or negative HURRICANE_HID_PIPELINE_ERR_* code
+ */
+int hurricane_hid_pipeline_source_attach(const hurricane_hid_pipeline_t* pipeline,
+                                         hurricane_hid_pipeline_source_t* source,
+                                         const uint8_t* descriptor, uint16_t length);
+
+/**
+ * @brief Forget the device of a source; nothing is sent
+ *
+ * @param source Source
+ */
+void hurricane_hid_pipeline_source_detach(hurricane_hid_pipeline_source_t* source);
+
+/**
+ * @brief Feed one report of a source into the given merges without sending
+ *
+ * Decode, transform and map only, as hurricane_hid_pipeline_relay() does
+ * for the pipeline's own source.
+ *
+ * @param pipeline Pipeline the source was attached against
+ * @param source Source
+ * @param merges One merge per pipe, set up on the pipeline's sink layouts and pack plans
+ * @param report Report as received, including the ID byte if the device uses IDs
+ * @param length Report length
+ * @return Pipe index, or negative HURRICANE_HID_PIPELINE_ERR_* code
+ */
+int hurricane_hid_pipeline_source_relay(hurricane_hid_pipeline_t* pipeline, hurricane_hid_pipeline_source_t* source,
+                                        hurricane_hid_merge_t* merges, const uint8_t* report, uint16_t length);
+
+/**
+ * @brief Build and send the merged report of one pipe now
+ *
+ * @param pipeline Pipeline
+ * @param pipe Pipe index
+ * @param now_ms Current time in milliseconds
+ * @return 1 if a report was sent, 0 if not (unchanged or refused)
+ */
+int hurricane_hid_pipeline_flush(hurricane_hid_pipeline_t* pipeline, uint8_t pipe, uint32_t now_ms);
+
+/**
+ * @brief Move every pipe to another device-side controller
+ *
+ * The PC on the old controller first gets a report with everything
+ * released, relayed and injected input alike, so nothing stays held there.
+ * The filters forget the last reports so the new PC gets the next one
+ * whatever it contains; idle durations carry over until it sends SET_IDLE.
+ *
+ * @param pipeline Pipeline
+ * @param controller Device-side controller instance
+ * @return Number of release reports sent
+ */
+int hurricane_hid_pipeline_retarget(hurricane_hid_pipeline_t* pipeline, uint8_t controller);
+
+/**
+ * @brief Push one host-side report through its pipe
+ *
+ * Pipes without HURRICANE_HID_PIPE_DEFER send the result right away.
+ *
+ * @param pipeline Pipeline
+ * @param report Report as received, including the ID byte if the device uses IDs
+ * @param length Report length
+ * @param now_ms Current time in milliseconds
+ * @return Pipe index, or negative HURRICANE_HID_PIPELINE_ERR_* code
+ */
+int hurricane_hid_pipeline_submit(hurricane_hid_pipeline_t* pipeline, const uint8_t* report, uint16_t length,
+                                  uint32_t now_ms);
+
+/**
+ * @brief Main loop step
+ *
+ * Reads one report from the source endpoint (if configured), sends every
+ * pipe's pending merged report and the repeats SET_IDLE asks for.
+ *
+ * @param pipeline Pipeline
+ * @param now_ms Current time in milliseconds
+ * @return Number of reports sent
+ */
+int hurricane_hid_pipeline_run(hurricane_hid_pipeline_t* pipeline, uint32_t now_ms);
+
+/**
+ * @brief Enable or disable per-stage cost measurement (resets the counters)
+ */
+void hurricane_hid_pipeline_set_profiling(hurricane_hid_pipeline_t* pipeline, bool enable);
+
+/**
+ * @brief Average cost of one stage of a pipe per pass
+ *
+ * @param pipeline Pipeline
+ * @param pipe Pipe index
+ * @param stage hurricane_hid_pipe_stage_t
+ * @return Average cost in HURRICANE_CYCLES_UNIT, 0 if the stage never ran
+ */
+uint32_t hurricane_hid_pipeline_stage_cost(const hurricane_hid_pipeline_t* pipeline, uint8_t pipe, uint8_t stage);
+
+#ifdef __cplusplus
+}
+#endif
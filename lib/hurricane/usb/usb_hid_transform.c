@@ -0,0 +1,294 @@
+/*
+ * @file usb_hid_transform.c
+ * @brief Declarative transforms over decoded HID reports
+ */
+
+#include "usb_hid_transform.h"
+#include "core/hurricane_cycles.h"
+#include <stddef.h>
+#include <string.h>
+
+// Location kinds
+#define LOC_VALUE   0   // Multi-bit variable: one value per element
+#define LOC_BIT     1   // 1-bit variable: bit in a bitmask value
+#define LOC_ARRAY   2   // Array: usage present if any slot holds raw
+
+typedef enum {
+    RESOLVE_OK = 0,
+    RESOLVE_OTHER_REPORT,
+    RESOLVE_MISSING
+} resolve_result_t;
+
+static bool field_has_usage(const hurricane_hid_field_t* field, uint16_t page, uint16_t usage)
+{
+    return field->usage_page == page && usage >= field->usage && usage <= field->usage_max;
+}
+
+static resolve_result_t resolve(const hurricane_hid_layout_t* layout, const hurricane_hid_decode_plan_t* plan,
+                                uint16_t page, uint16_t usage, hurricane_hid_transform_loc_t* loc,
+                                const hurricane_hid_field_t** field_out)
+{
+    for (uint8_t i = 0; i < plan->num_fields; i++) {
+        const hurricane_hid_field_t* field = &layout->fields[plan->first_field + i];
+        if (!field_has_usage(field, page, usage)) {
+            continue;
+        }
+
+        uint16_t offset = usage - field->usage;
+        memset(loc, 0, sizeof(*loc));
+        loc->index = plan->field_value[i];
+        loc->count = 1;
+        if (!(field->flags & HURRICANE_HID_FIELD_VARIABLE)) {
+            loc->kind = LOC_ARRAY;
+            loc->count = field->count;
+            loc->raw = (int32_t)offset + field->logical_min;
+        } else if (field->bit_size == 1) {
+            loc->kind = LOC_BIT;
+            loc->index += offset / 32;
+            loc->bit = offset % 32;
+        } else {
+            loc->kind = LOC_VALUE;
+            // Elements past usage_max repeat the last usage; the first one wins
+            loc->index += offset;
+        }
+        *field_out = field;
+        return RESOLVE_OK;
+    }
+
+    for (uint8_t i = 0; i < layout->num_fields; i++) {
+        if (field_has_usage(&layout->fields[i], page, usage)) {
+            return RESOLVE_OTHER_REPORT;
+        }
+    }
+    return RESOLVE_MISSING;
+}
+
+static int compile_rule(hurricane_hid_transform_step_t* step, const hurricane_hid_transform_rule_t* rule,
+                        const hurricane_hid_layout_t* layout, const hurricane_hid_decode_plan_t* plan)
+{
+    const hurricane_hid_field_t* field = NULL;
+    const hurricane_hid_field_t* target_field = NULL;
+    bool two_usages = rule->op == HURRICANE_HID_XFORM_SWAP || rule->op == HURRICANE_HID_XFORM_REMAP;
+
+    if (rule->op < HURRICANE_HID_XFORM_SCALE || rule->op > HURRICANE_HID_XFORM_DEADZONE ||
+        (rule->op == HURRICANE_HID_XFORM_DEADZONE && rule->param < 0)) {
+        return HURRICANE_HID_TRANSFORM_ERR_BAD_RULE;
+    }
+
+    resolve_result_t found = resolve(layout, plan, rule->usage_page, rule->usage, &step->loc, &field);
+    resolve_result_t target_found = found;
+    if (two_usages) {
+        target_found = resolve(layout, plan, rule->target_page, rule->target_usage, &step->target, &target_field);
+    }
+
+    if (found == RESOLVE_MISSING || target_found == RESOLVE_MISSING) {
+        return HURRICANE_HID_TRANSFORM_ERR_NO_USAGE;
+    }
+    if (found != RESOLVE_OK || target_found != RESOLVE_OK) {
+        // Both usages must live in the same report; otherwise not ours
+        return found == target_found ? 1 : HURRICANE_HID_TRANSFORM_ERR_FIELD_TYPE;
+    }
+
+    switch (rule->op) {
+        case HURRICANE_HID_XFORM_SWAP:
+            if (step->target.kind != LOC_VALUE) {
+                return HURRICANE_HID_TRANSFORM_ERR_FIELD_TYPE;
+            }
+            // fall through
+        case HURRICANE_HID_XFORM_SCALE:
+        case HURRICANE_HID_XFORM_INVERT:
+        case HURRICANE_HID_XFORM_DEADZONE:
+            if (step->loc.kind != LOC_VALUE) {
+                return HURRICANE_HID_TRANSFORM_ERR_FIELD_TYPE;
+            }
+            break;
+        case HURRICANE_HID_XFORM_REMAP:
+            if (step->loc.kind == LOC_VALUE || step->target.kind == LOC_VALUE) {
+                return HURRICANE_HID_TRANSFORM_ERR_FIELD_TYPE;
+            }
+            break;
+        default:
+            break;
+    }
+
+    step->op = rule->op;
+    step->param = rule->param;
+    step->relative = (field->flags & HURRICANE_HID_FIELD_RELATIVE) != 0;
+    if (rule->op == HURRICANE_HID_XFORM_INVERT) {
+        step->center = field->logical_min + field->logical_max;
+    } else if (rule->op == HURRICANE_HID_XFORM_DEADZONE) {
+        step->center = (field->logical_min + field->logical_max + 1) / 2;
+    }
+    return 0;
+}
+
+int hurricane_hid_transform_compile(hurricane_hid_transform_t* xf,
+                                    const hurricane_hid_transform_rule_t* rules, uint8_t num_rules,
+                                    const hurricane_hid_layout_t* layout,
+                                    const hurricane_hid_decode_plan_t* plan)
+{
+    if (!xf || (!rules && num_rules) || !layout || !plan || num_rules > HURRICANE_HID_MAX_TRANSFORM_RULES) {
+        return HURRICANE_HID_TRANSFORM_ERR_INVALID_ARG;
+    }
+
+    memset(xf, 0, sizeof(*xf));
+
+    for (uint8_t i = 0; i < num_rules; i++) {
+        hurricane_hid_transform_step_t* step = &xf->steps[xf->num_steps];
+        memset(step, 0, sizeof(*step));
+
+        int ret = compile_rule(step, &rules[i], layout, plan);
+        if (ret < 0) {
+            memset(xf, 0, sizeof(*xf));
+            return ret;
+        }
+        if (ret == 0) {
+            step->rule_index = i;
+            xf->num_steps++;
+        }
+    }
+    return 0;
+}
+
+static bool loc_get(const hurricane_hid_transform_loc_t* loc, const int32_t* values)
+{
+    if (loc->kind == LOC_BIT) {
+        return ((uint32_t)values[loc->index] >> loc->bit) & 1;
+    }
+    for (uint16_t e = 0; e < loc->count; e++) {
+        if (values[loc->index + e] == loc->raw) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void loc_clear(const hurricane_hid_transform_loc_t* loc, int32_t* values)
+{
+    if (loc->kind == LOC_BIT) {
+        values[loc->index] = (int32_t)((uint32_t)values[loc->index] & ~(1u << loc->bit));
+        return;
+    }
+    for (uint16_t e = 0; e < loc->count; e++) {
+        if (values[loc->index + e] == loc->raw) {
+            values[loc->index + e] = 0;
+        }
+    }
+}
+
+static void loc_set(const hurricane_hid_transform_loc_t* loc, int32_t* values)
+{
+    if (loc->kind == LOC_BIT) {
+        values[loc->index] = (int32_t)((uint32_t)values[loc->index] | (1u << loc->bit));
+        return;
+    }
+    if (loc_get(loc, values)) {
+        return;
+    }
+    for (uint16_t e = 0; e < loc->count; e++) {
+        if (values[loc->index + e] == 0) {
+            values[loc->index + e] = loc->raw;
+            return;
+        }
+    }
+    // No free slot: the remapped key is dropped, like a rollover overflow
+}
+
+static void run_step(hurricane_hid_transform_step_t* step, int32_t* values, uint32_t* remapped, uint8_t n)
+{
+    int32_t* v = &values[step->loc.index];
+
+    switch (step->op) {
+        case HURRICANE_HID_XFORM_SCALE: {
+            int64_t scaled = (int64_t)*v * step->param + (step->relative ? step->remainder : 0);
+            int32_t out = (int32_t)(scaled / HURRICANE_HID_Q16_ONE);
+            if (step->relative) {
+                step->remainder = (int32_t)(scaled - (int64_t)out * HURRICANE_HID_Q16_ONE);
+            }
+            *v = out;
+            break;
+        }
+        case HURRICANE_HID_XFORM_INVERT:
+            *v = step->relative ? -*v : step->center - *v;
+            break;
+        case HURRICANE_HID_XFORM_SWAP: {
+            int32_t tmp = *v;
+            *v = values[step->target.index];
+            values[step->target.index] = tmp;
+            break;
+        }
+        case HURRICANE_HID_XFORM_DEADZONE: {
+            int32_t delta = *v - step->center;
+            if (delta < step->param && delta > -step->param) {
+                *v = step->center;
+            }
+            break;
+        }
+        case HURRICANE_HID_XFORM_REMAP:
+            // Collect and release every source first, press targets afterwards
+            if (loc_get(&step->loc, values)) {
+                loc_clear(&step->loc, values);
+                *remapped |= 1u << n;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void hurricane_hid_transform_run(hurricane_hid_transform_t* xf, int32_t* values)
+{
+    uint32_t remapped = 0;
+
+    if (!xf->num_steps) {
+        return;
+    }
+
+    if (!xf->profile) {
+        for (uint8_t i = 0; i < xf->num_steps; i++) {
+            run_step(&xf->steps[i], values, &remapped, i);
+        }
+        for (uint8_t i = 0; remapped; i++, remapped >>= 1) {
+            if (remapped & 1) {
+                loc_set(&xf->steps[i].target, values);
+            }
+        }
+        return;
+    }
+
+    // Same two passes, timing each step; a remap is charged for both halves
+    for (uint8_t i = 0; i < xf->num_steps; i++) {
+        hurricane_hid_transform_step_t* step = &xf->steps[i];
+        uint32_t start = hurricane_cycles_now();
+        run_step(step, values, &remapped, i);
+        step->cycles += hurricane_cycles_now() - start;
+        step->runs++;
+    }
+    for (uint8_t i = 0; remapped; i++, remapped >>= 1) {
+        if (remapped & 1) {
+            uint32_t start = hurricane_cycles_now();
+            loc_set(&xf->steps[i].target, values);
+            xf->steps[i].cycles += hurricane_cycles_now() - start;
+        }
+    }
+}
+
+void hurricane_hid_transform_set_profiling(hurricane_hid_transform_t* xf, bool enable)
+{
+    xf->profile = enable;
+    for (uint8_t i = 0; i < xf->num_steps; i++) {
+        xf->steps[i].cycles = 0;
+        xf->steps[i].runs = 0;
+    }
+}
+
+uint32_t hurricane_hid_transform_rule_cost(const hurricane_hid_transform_t* xf, uint8_t rule_index)
+{
+    for (uint8_t i = 0; i < xf->num_steps; i++) {
+        const hurricane_hid_transform_step_t* step = &xf->steps[i];
+        if (step->rule_index == rule_index) {
+            return step->runs ? step->cycles / step->runs : 0;
+        }
+    }
+    return 0;
+}
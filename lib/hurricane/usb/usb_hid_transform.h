@@ -0,0 +1,164 @@
+/**
+ * @file usb_hid_transform.h
+ * @brief Declarative transforms over decoded HID reports
+ *
+ * A transform is a table of rules naming fields by usage (scale X by 1.5,
+ * invert Y, swap X/Y, remap Caps Lock to Left Control, dead zone on a stick
+ * axis, ...). The table is validated and compiled once against the decode
+ * plan of one report: usages are resolved to value indices and bit
+ * positions, rules the report does not carry are dropped, and running the
+ * result is a fixed loop over at most HURRICANE_HID_MAX_TRANSFORM_RULES
+ * steps with no allocation and no lookups. A report no rule touches costs
+ * a single branch.
+ *
+ * The transform sits between the host-side decoder and the device-side
+ * packer and works on the plan's value array in place:
+ *
+ *   hurricane_hid_decode(&decode, payload, len, values);
+ *   hurricane_hid_transform_run(&xf, values);
+ *   hurricane_hid_pack(&pack, values, out, sizeof(out));
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "usb_hid_parser.h"
+#include "usb_hid_decode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Rules per transform
+ */
+#ifndef HURRICANE_HID_MAX_TRANSFORM_RULES
+#define HURRICANE_HID_MAX_TRANSFORM_RULES 16
+#endif
+
+// Compile results
+#define HURRICANE_HID_TRANSFORM_ERR_INVALID_ARG -1  /**< NULL argument or too many rules */
+#define HURRICANE_HID_TRANSFORM_ERR_BAD_RULE    -2  /**< Unknown op or parameter out of range */
+#define HURRICANE_HID_TRANSFORM_ERR_NO_USAGE    -3  /**< The descriptor does not carry a usage */
+#define HURRICANE_HID_TRANSFORM_ERR_FIELD_TYPE  -4  /**< Op does not apply to the field (e.g. scaling a button) */
+
+/**
+ * @brief One-Q16.16 unit, for HURRICANE_HID_XFORM_SCALE factors
+ */
+#define HURRICANE_HID_Q16_ONE 65536
+
+/**
+ * @brief Rule operations
+ */
+typedef enum {
+    HURRICANE_HID_XFORM_SCALE = 1,  /**< value *= param / 65536; relative axes carry the remainder */
+    HURRICANE_HID_XFORM_INVERT,     /**< Relative: -value, absolute: mirrored within the logical range */
+    HURRICANE_HID_XFORM_SWAP,       /**< Exchange the values of usage and target usage */
+    HURRICANE_HID_XFORM_REMAP,      /**< Key or button usage reports as target usage instead */
+    HURRICANE_HID_XFORM_DEADZONE    /**< Absolute axis within param of its center reads as center */
+} hurricane_hid_transform_op_t;
+
+/**
+ * @brief One rule as written by the user
+ */
+typedef struct {
+    uint8_t op;                 /**< hurricane_hid_transform_op_t */
+    uint16_t usage_page;
+    uint16_t usage;
+    uint16_t target_page;       /**< SWAP and REMAP only */
+    uint16_t target_usage;
+    int32_t param;              /**< SCALE: Q16.16 factor, DEADZONE: radius */
+} hurricane_hid_transform_rule_t;
+
+/**
+ * @brief Where a usage lives in a decoded value array
+ */
+typedef struct {
+    uint16_t index;             /**< Value index */
+    uint16_t count;             /**< Array slots (1 for variables) */
+    int32_t raw;                /**< Array: value selecting the usage */
+    uint8_t bit;                /**< 1-bit variables: bit in the bitmask */
+    uint8_t kind;               /**< Internal location kind */
+} hurricane_hid_transform_loc_t;
+
+/**
+ * @brief One compiled rule
+ */
+typedef struct {
+    uint8_t op;
+    uint8_t rule_index;         /**< Position in the source table */
+    bool relative;
+    hurricane_hid_transform_loc_t loc;
+    hurricane_hid_transform_loc_t target;
+    int32_t param;
+    int32_t center;             /**< DEADZONE center, INVERT min + max */
+    int32_t remainder;          /**< SCALE: sub-unit motion carried to the next report */
+    uint32_t cycles;            /**< Profiling: total cost (see hurricane_cycles.h) */
+    uint32_t runs;              /**< Profiling: number of runs */
+} hurricane_hid_transform_step_t;
+
+/**
+ * @brief Transform compiled for one report
+ */
+typedef struct {
+    hurricane_hid_transform_step_t steps[HURRICANE_HID_MAX_TRANSFORM_RULES];
+    uint8_t num_steps;
+    bool profile;               /**< Measure the cost of each step */
+} hurricane_hid_transform_t;
+
+/**
+ * @brief Validate a rule table and compile it for one report
+ *
+ * Every rule is checked against the whole layout: a usage the descriptor
+ * does not carry at all, or an op that does not fit the field, fails the
+ * compile. Rules whose usage only lives in other reports are dropped.
+ *
+ * @param xf Output transform
+ * @param rules Rule table
+ * @param num_rules Number of rules, <= HURRICANE_HID_MAX_TRANSFORM_RULES
+ * @param layout Compiled report descriptor
+ * @param plan Decode plan of the report the transform runs on
+ * @return 0 on success, negative HURRICANE_HID_TRANSFORM_ERR_* code on failure
+ */
+int hurricane_hid_transform_compile(hurricane_hid_transform_t* xf,
+                                    const hurricane_hid_transform_rule_t* rules, uint8_t num_rules,
+                                    const hurricane_hid_layout_t* layout,
+                                    const hurricane_hid_decode_plan_t* plan);
+
+/**
+ * @brief Check whether any rule applies to the report
+ */
+static inline bool hurricane_hid_transform_active(const hurricane_hid_transform_t* xf)
+{
+    return xf->num_steps != 0;
+}
+
+/**
+ * @brief Apply the transform to decoded values in place
+ *
+ * Remaps are applied simultaneously, so A->B together with B->A swaps the
+ * two keys instead of collapsing them.
+ *
+ * @param xf Compiled transform
+ * @param values Value array of the decode plan it was compiled against
+ */
+void hurricane_hid_transform_run(hurricane_hid_transform_t* xf, int32_t* values);
+
+/**
+ * @brief Enable or disable per-rule cost measurement (resets the counters)
+ */
+void hurricane_hid_transform_set_profiling(hurricane_hid_transform_t* xf, bool enable);
+
+/**
+ * @brief Average cost of one rule per report
+ *
+ * @param xf Transform
+ * @param rule_index Index in the source rule table
+ * @return Average cost in HURRICANE_CYCLES_UNIT, 0 if the rule was dropped or never ran
+ */
+uint32_t hurricane_hid_transform_rule_cost(const hurricane_hid_transform_t* xf, uint8_t rule_index);
+
+#ifdef __cplusplus
+}
+#endif
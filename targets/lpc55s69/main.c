@@ -9,46 +9,14 @@
 #include "hurricane.h"
 #include "hurricane_hw_hal.h"
 #include "core/usb_interface_manager.h"
+#include "usb/usb_hid_boot_reports.h"
 #include "usb/usb_hid.h"
 #include <stdio.h>
 #include <string.h>
 
-// HID report descriptor for a simple mouse
-static const uint8_t mouse_report_descriptor[] = {
-    0x05, 0x01,        // Usage Page (Generic Desktop)
-    0x09, 0x02,        // Usage (Mouse)
-    0xA1, 0x01,        // Collection (Application)
-    0x09, 0x01,        //   Usage (Pointer)
-    0xA1, 0x00,        //   Collection (Physical)
-    0x05, 0x09,        //     Usage Page (Button)
-    0x19, 0x01,        //     Usage Minimum (Button 1)
-    0x29, 0x03,        //     Usage Maximum (Button 3)
-    0x15, 0x00,        //     Logical Minimum (0)
-    0x25, 0x01,        //     Logical Maximum (1)
-    0x95, 0x03,        //     Report Count (3)
-    0x75, 0x01,        //     Report Size (1)
-    0x81, 0x02,        //     Input (Data, Variable, Absolute)
-    0x95, 0x01,        //     Report Count (1)
-    0x75, 0x05,        //     Report Size (5)
-    0x81, 0x03,        //     Input (Constant)
-    0x05, 0x01,        //     Usage Page (Generic Desktop)
-    0x09, 0x30,        //     Usage (X)
-    0x09, 0x31,        //     Usage (Y)
-    0x15, 0x81,        //     Logical Minimum (-127)
-    0x25, 0x7F,        //     Logical Maximum (127)
-    0x75, 0x08,        //     Report Size (8)
-    0x95, 0x02,        //     Report Count (2)
-    0x81, 0x06,        //     Input (Data, Variable, Relative)
-    0xC0,              //   End Collection
-    0xC0               // End Collection
-};
-
-// Mouse report structure
-typedef struct {
-    uint8_t buttons;
-    int8_t x;
-    int8_t y;
-} mouse_report_t;
+// HID report descriptor for a simple mouse: the HID boot mouse descriptor,
+// so reports are built with the accessors generated with it (usb_hid_boot_reports.h)
+static const uint8_t mouse_report_descriptor[] = { HURRICANE_BOOT_MOUSE_DESCRIPTOR_BYTES };
 
 // Device descriptors
 static uint8_t device_descriptor[] = {
@@ -116,7 +84,7 @@ static bool hid_match_device(uint8_t device_class, uint8_t device_subclass, uint
 static void hid_attach_device(void* device);
 static void hid_detach_device(void* device);
 static bool hid_control_callback(hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t* length);
-static void hid_data_callback(uint8_t endpoint, void* buffer, uint16_t length);
+static void hid_data_callback(const hurricane_report_view_t* view);
 static void configure_device_mode(void);
 static void configure_host_mode(void);
 static void generate_mouse_movement(void);
@@ -244,16 +212,15 @@ static void generate_mouse_movement(void) {
     
     // Only send reports if a host is connected to our device
     if (hurricane_hw_device_host_connected()) {
-        mouse_report_t report = {0};
+        uint8_t report[HURRICANE_BOOT_MOUSE_INPUT_SIZE] = {0};
         
         // Create a circular motion
-        report.buttons = 0;
-        report.x = directions[count % 4];
-        report.y = directions[(count + 1) % 4];
+        hurricane_boot_mouse_input_set_x(report, directions[count % 4]);
+        hurricane_boot_mouse_input_set_y(report, directions[(count + 1) % 4]);
         count++;
         
         // Send the report
-        hurricane_device_hid_send_report((uint8_t*)&report, sizeof(report));
+        hurricane_device_hid_send_report(report, sizeof(report));
     }
 }
 
@@ -292,13 +259,17 @@ static bool hid_control_callback(hurricane_usb_setup_packet_t* setup, void* buff
     return true;
 }
 
-static void hid_data_callback(uint8_t endpoint, void* buffer, uint16_t length) {
+static void hid_data_callback(const hurricane_report_view_t* view) {
+    uint16_t length = view->length;
     printf("Host received data from HID device: %d bytes\n", length);
     
     // Process the received data if it's a mouse report
     if (length >= 3) {
-        mouse_report_t* report = (mouse_report_t*)buffer;
+        const uint8_t* report = view->data;
+        int buttons = hurricane_boot_mouse_input_button1(report) |
+                      hurricane_boot_mouse_input_button2(report) << 1 |
+                      hurricane_boot_mouse_input_button3(report) << 2;
         printf("  Mouse movement: buttons=0x%02x, x=%d, y=%d\n", 
-               report->buttons, report->x, report->y);
+               buttons, (int)hurricane_boot_mouse_input_x(report), (int)hurricane_boot_mouse_input_y(report));
     }
 }
\ No newline at end of file
@@ -0,0 +1,359 @@
+// tests/bench/bench_contexts.c
+//
+// Several stack contexts, each driven by its own thread as in a host-side
+// simulation with one context per port pair. Every round re-enumerates the
+// context's mouse through its control queue, receives reports that the
+// interface manager dispatches to a HID class handler, decodes them and
+// looks up the device-side endpoint. Each context has its own controller,
+// so contexts share nothing but the HAL registry and the read-only boot
+// layouts; half of the mice run in boot protocol, on those shared layouts.
+//
+// The time per round of one context should stay flat as threads are added;
+// the stack logs through stdio, whose lock is the one thing the threads
+// still contend on. Every context must decode exactly the values its own
+// mouse sent. Build with -fsanitize=thread to check for data races. Run
+// with `make bench`.
+
+#include "../common/hid_descriptors.h"
+#include "../common/hid_gaming_mouse_reports.h"
+#include "core/hurricane_context.h"
+#include "core/hurricane_cycles.h"
+#include "hw/hurricane_hw_ops.h"
+#include "usb/usb_control.h"
+#include "usb/usb_hid_decode.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_CONTEXTS        HURRICANE_HW_MAX_CONTROLLERS
+#define ROUNDS              500
+#define REPORTS_PER_ROUND   16
+#define MAX_POLLS           64
+
+// Simulated mouse behind one controller; boot mice are boot subclass devices
+typedef struct {
+    bool boot;
+    uint8_t id;
+    uint8_t protocol;           // Set by SET_PROTOCOL, reset by SET_ADDRESS
+    int8_t next_x;              // Value of the next report
+    uint32_t configurations;    // SET_CONFIGURATION requests seen
+    uint32_t reports;           // Reports sent
+} fake_mouse_t;
+
+// One context and what its thread has checked
+typedef struct {
+    hurricane_context_t ctx;
+    fake_mouse_t mouse;
+    pthread_t thread;
+    hurricane_hid_decode_plan_t plan;
+    const hurricane_hid_layout_t* plan_layout;
+    int8_t expected_x;
+    uint32_t decoded;
+    uint32_t errors;
+} worker_t;
+
+static worker_t workers[MAX_CONTEXTS];
+static _Thread_local worker_t* self;
+
+static const uint8_t device_descriptor[18] = {
+    18, 1, 0x00, 0x02, 0, 0, 0, 8, 0x6D, 0x04, 0x2B, 0xC5, 0x00, 0x01, 1, 2, 0, 1
+};
+
+static const hurricane_hid_transform_rule_t invert_y = {
+    .op = HURRICANE_HID_XFORM_INVERT, .usage_page = 0x01, .usage = 0x31
+};
+
+static uint16_t config_descriptor(const fake_mouse_t* mouse, uint8_t* out)
+{
+    uint16_t report_length = mouse->boot ? hid_desc_boot_mouse_size : hid_desc_gaming_mouse_size;
+    const uint8_t config[34] = {
+        9, 2, 34, 0, 1, 1, 0, 0xA0, 50,                                 // Configuration
+        9, 4, 0, 0, 1, 3, mouse->boot ? 1 : 0, mouse->boot ? 2 : 0, 0,  // Interface 0, HID
+        9, 0x21, 0x11, 0x01, 0, 1, 0x22, (uint8_t)report_length, (uint8_t)(report_length >> 8),
+        7, 5, 0x81, 0x03, 16, 0, 1                                      // Interrupt IN
+    };
+    memcpy(out, config, sizeof(config));
+    return sizeof(config);
+}
+
+static int reply(void* buffer, uint16_t length, const uint8_t* data, uint16_t size)
+{
+    uint16_t n = size < length ? size : length;
+    memcpy(buffer, data, n);
+    return n;
+}
+
+static int fake_connected(void* priv)
+{
+    (void)priv;
+    return 1;
+}
+
+static void fake_reset_bus(void* priv)
+{
+    (void)priv;
+}
+
+static int fake_control_transfer(void* priv, const hurricane_usb_setup_packet_t* setup, void* buffer,
+                                 uint16_t length)
+{
+    fake_mouse_t* mouse = (fake_mouse_t*)priv;
+    uint8_t config[34];
+
+    switch (setup->bRequest) {
+        case USB_REQ_SET_ADDRESS:
+            mouse->protocol = HURRICANE_HID_PROTOCOL_REPORT;
+            return 0;
+        case 0x09:  // SET_CONFIGURATION
+            mouse->configurations++;
+            return 0;
+        case 0x0A:  // SET_IDLE
+            return 0;
+        case 0x0B:  // SET_PROTOCOL
+            if (!mouse->boot) {
+                return -1;
+            }
+            mouse->protocol = (uint8_t)setup->wValue;
+            return 0;
+        case USB_REQ_GET_DESCRIPTOR:
+            switch (setup->wValue >> 8) {
+                case USB_DESC_TYPE_DEVICE:
+                    return reply(buffer, length, device_descriptor, sizeof(device_descriptor));
+                case USB_DESC_TYPE_CONFIGURATION:
+                    return reply(buffer, length, config, config_descriptor(mouse, config));
+                case USB_DESC_TYPE_REPORT:
+                    return mouse->boot ? reply(buffer, length, hid_desc_boot_mouse, hid_desc_boot_mouse_size)
+                                       : reply(buffer, length, hid_desc_gaming_mouse, hid_desc_gaming_mouse_size);
+                default:
+                    return -1;
+            }
+        default:
+            return -1;
+    }
+}
+
+// Boot protocol: the 3-byte boot report, otherwise report 1 of the gaming mouse
+static int fake_interrupt_in(void* priv, uint8_t endpoint, void* buffer, uint16_t length)
+{
+    fake_mouse_t* mouse = (fake_mouse_t*)priv;
+    uint8_t* report = (uint8_t*)buffer;
+    (void)endpoint;
+
+    mouse->reports++;
+    if (mouse->protocol == HURRICANE_HID_PROTOCOL_BOOT) {
+        if (length < 3) {
+            return -1;
+        }
+        report[0] = 0;
+        report[1] = (uint8_t)mouse->next_x;
+        report[2] = (uint8_t)-mouse->next_x;
+        return 3;
+    }
+    if (length < GAMING_MOUSE_INPUT1_SIZE) {
+        return -1;
+    }
+    memset(report, 0, GAMING_MOUSE_INPUT1_SIZE);
+    report[0] = GAMING_MOUSE_INPUT1_ID;
+    gaming_mouse_input1_set_x(report, mouse->next_x);
+    gaming_mouse_input1_set_y(report, -mouse->next_x);
+    return GAMING_MOUSE_INPUT1_SIZE;
+}
+
+static int fake_configure_interface(void* priv, uint8_t num, uint8_t cls, uint8_t sub, uint8_t proto)
+{
+    (void)priv;
+    (void)num;
+    (void)cls;
+    (void)sub;
+    (void)proto;
+    return 0;
+}
+
+static int fake_configure_endpoint(void* priv, uint8_t num, uint8_t ep, uint8_t attr, uint16_t mps, uint8_t interval)
+{
+    (void)priv;
+    (void)num;
+    (void)ep;
+    (void)attr;
+    (void)mps;
+    (void)interval;
+    return 0;
+}
+
+static const hurricane_hw_ops_t fake_mouse_ops = {
+    .host_device_connected = fake_connected,
+    .host_reset_bus = fake_reset_bus,
+    .host_control_transfer = fake_control_transfer,
+    .host_interrupt_in_transfer = fake_interrupt_in,
+    .device_configure_interface = fake_configure_interface,
+    .device_configure_endpoint = fake_configure_endpoint,
+};
+
+// HID class handler; the report arrives on the thread of the context polling it
+static void on_report(const hurricane_report_view_t* view)
+{
+    worker_t* w = self;
+    hurricane_device_t* dev = hurricane_get_device_ctx(&w->ctx, 0);
+    const hurricane_hid_layout_t* layout = dev ? dev->hid_device->layout : NULL;
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];
+    int32_t x = 0;
+
+    if (!layout) {
+        w->errors++;
+        return;
+    }
+    if (w->plan_layout != layout) {
+        if (hurricane_hid_decode_plan_build(layout, HURRICANE_HID_REPORT_INPUT,
+                                            layout->uses_report_ids ? GAMING_MOUSE_INPUT1_ID : 0, &w->plan) != 0) {
+            w->errors++;
+            return;
+        }
+        w->plan_layout = layout;
+    }
+
+    uint16_t skip = layout->uses_report_ids ? 1 : 0;
+    hurricane_hid_decode(&w->plan, view->data + skip, (uint16_t)(view->length - skip), values);
+    hurricane_hid_decode_get_usage(&w->plan, layout, values, 0x01, 0x30, &x);
+    if (x != w->expected_x) {
+        w->errors++;
+    }
+    w->decoded++;
+}
+
+static const hurricane_host_class_handler_t hid_handler = { .data_callback = on_report };
+
+static bool enumerate(worker_t* w)
+{
+    usb_host_init_ctx(&w->ctx);
+    for (int i = 0; i < MAX_POLLS; i++) {
+        hurricane_task_ctx(&w->ctx);
+        usb_host_poll_ctx(&w->ctx);
+        if (w->ctx.host.device.state == kHurricane_Host_DeviceStateConfigured) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void* run_context(void* arg)
+{
+    worker_t* w = (worker_t*)arg;
+    self = w;
+
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        if (!enumerate(w)) {
+            w->errors++;
+            continue;
+        }
+
+        // Boot mice must end up on the shared boot layout, the others on their own
+        hurricane_device_t* dev = hurricane_get_device_ctx(&w->ctx, 0);
+        const hurricane_hid_layout_t* expected = w->mouse.boot ? hurricane_hid_boot_layout(HURRICANE_HID_BOOT_MOUSE)
+                                                               : &w->ctx.host.report_layout;
+        if (!dev || dev->hid_device->layout != expected) {
+            w->errors++;
+        }
+
+        for (uint32_t r = 0; r < REPORTS_PER_ROUND; r++) {
+            w->mouse.next_x = (int8_t)(w->mouse.id * 16 + r);
+            w->expected_x = w->mouse.next_x;
+            usb_host_poll_ctx(&w->ctx);
+        }
+
+        // Device side: the PC reconfigures the endpoint, the HAL looks it up
+        hurricane_endpoint_descriptor_t ep;
+        hurricane_device_configure_endpoint_ctx(&w->ctx, 0, 0x81, 0x03, (round & 1) ? 16 : 8, 1);
+        if (!hurricane_get_device_endpoint_by_address_ctx(&w->ctx, 0x81, &ep) ||
+            ep.ep_max_packet_size != ((round & 1) ? 16 : 8)) {
+            w->errors++;
+        }
+    }
+    return NULL;
+}
+
+// Run the first n contexts at once; returns the time per round of one context
+static double run(int n)
+{
+    for (int i = 0; i < n; i++) {
+        workers[i].mouse.configurations = 0;
+        workers[i].mouse.reports = 0;
+        workers[i].decoded = 0;
+    }
+
+    uint32_t start = hurricane_cycles_now();
+    for (int i = 0; i < n; i++) {
+        pthread_create(&workers[i].thread, NULL, run_context, &workers[i]);
+    }
+    for (int i = 0; i < n; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    uint32_t total = hurricane_cycles_now() - start;
+
+    for (int i = 0; i < n; i++) {
+        worker_t* w = &workers[i];
+        if (w->mouse.configurations != ROUNDS || w->mouse.reports != ROUNDS * REPORTS_PER_ROUND ||
+            w->decoded != ROUNDS * REPORTS_PER_ROUND) {
+            w->errors++;
+        }
+    }
+    return (double)total / ROUNDS;
+}
+
+int main(void)
+{
+    hurricane_cycles_init();
+    for (uint8_t i = 0; i < MAX_CONTEXTS; i++) {
+        worker_t* w = &workers[i];
+        w->mouse.id = i;
+        w->mouse.boot = (i & 1) == 0;
+        hurricane_hw_register_controller(i, "fake-mouse", &fake_mouse_ops, &w->mouse);
+        hurricane_context_init(&w->ctx, i, i);
+        hurricane_interface_manager_init_ctx(&w->ctx);
+        hurricane_register_host_class_handler_ctx(&w->ctx, 3, 0, 0, &hid_handler);
+
+        hurricane_interface_descriptor_t desc = { .interface_num = 0, .interface_class = 3, .num_endpoints = 1 };
+        hurricane_add_device_interface_ctx(&w->ctx, 0, 3, 1, 2, &desc);
+
+        // A boot mouse whose only rule fits the boot report switches to boot protocol
+        if (w->mouse.boot) {
+            hurricane_hid_attach_rules_ctx(&w->ctx, &invert_y, 1);
+        }
+    }
+
+    // Enumeration logs every step; keep stdout out of the numbers
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    if (!freopen("/dev/null", "w", stdout)) {
+        return 1;
+    }
+
+    double per_round[MAX_CONTEXTS + 1] = { 0 };
+    for (int n = 1; n <= MAX_CONTEXTS; n *= 2) {
+        per_round[n] = run(n);
+    }
+
+    uint32_t errors = 0;
+    for (int i = 0; i < MAX_CONTEXTS; i++) {
+        errors += workers[i].errors;
+        hurricane_interface_manager_deinit_ctx(&workers[i].ctx);
+        hurricane_context_deinit(&workers[i].ctx);
+    }
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    printf("==== Contexts on separate threads (%s, %ld CPUs online) ====\n", HURRICANE_CYCLES_UNIT,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("round = enumeration, %d reports decoded, endpoint reconfigured and looked up\n", REPORTS_PER_ROUND);
+    for (int n = 1; n <= MAX_CONTEXTS; n *= 2) {
+        printf("%d context(s)                %.0f per round of one context\n", n, per_round[n]);
+    }
+    printf("%-28s %s\n", "wrong or foreign values", errors ? "SOME" : "none");
+    return errors ? 1 : 0;
+}
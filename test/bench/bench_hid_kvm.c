@@ -0,0 +1,111 @@
+// tests/bench/bench_hid_kvm.c
+//
+// Latency of a KVM focus switch between two PCs with a keyboard and a
+// mouse pipeline under the KVM and keys held: endpoint checks against the
+// new PC's interface registry, release reports to the old PC, retargeting
+// and the LED resync. The ports are quiet fake controllers so the dummy
+// HAL's logging stays out of the numbers. Run with `make bench`.
+
+#include "../common/hid_descriptors.h"
+#include "core/hurricane_context.h"
+#include "core/hurricane_cycles.h"
+#include "hw/hurricane_hw_ops.h"
+#include "usb/usb_hid_kvm.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define SWITCHES 100000
+
+static int quiet_transfer(void* priv, uint8_t endpoint, void* buffer, uint16_t length)
+{
+    (void)priv;
+    (void)endpoint;
+    (void)buffer;
+    return length;
+}
+
+static const hurricane_hw_ops_t quiet_port = {
+    .device_interrupt_in_transfer = quiet_transfer,
+    .host_interrupt_out_transfer = quiet_transfer,
+};
+
+static hurricane_context_t pcs[2];
+static hurricane_hid_pipeline_t keyboard;
+static hurricane_hid_pipeline_t mouse;
+static hurricane_hid_output_relay_t led_relay;
+static hurricane_hid_kvm_t kvm;
+
+static void add_interface(hurricane_context_t* ctx, uint8_t interface_num, uint8_t endpoint)
+{
+    hurricane_interface_descriptor_t desc = { .interface_num = interface_num, .interface_class = 3, .num_endpoints = 1 };
+
+    hurricane_add_device_interface_ctx(ctx, interface_num, 3, 1, 1, &desc);
+    hurricane_device_configure_endpoint_ctx(ctx, interface_num, endpoint, 0x03, 8, 1);
+}
+
+int main(void)
+{
+    hurricane_hid_pipe_config_t keyboard_pipe = {
+        .source_page = 0x01, .source_usage = 0x06, .sink_controller = 1, .sink_interface = 0, .sink_endpoint = 0x81,
+        .flags = HURRICANE_HID_PIPE_DELTA,
+        .sink_descriptor = hid_desc_boot_keyboard, .sink_descriptor_length = hid_desc_boot_keyboard_size
+    };
+    hurricane_hid_pipe_config_t mouse_pipe = {
+        .source_page = 0x01, .source_usage = 0x02, .sink_controller = 1, .sink_interface = 1, .sink_endpoint = 0x82,
+        .flags = HURRICANE_HID_PIPE_DELTA,
+        .sink_descriptor = hid_desc_boot_mouse, .sink_descriptor_length = hid_desc_boot_mouse_size
+    };
+    hurricane_hid_pipeline_config_t keyboard_config = { .pipes = &keyboard_pipe, .num_pipes = 1 };
+    hurricane_hid_pipeline_config_t mouse_config = { .pipes = &mouse_pipe, .num_pipes = 1 };
+    const uint8_t keys[8] = { 0x02, 0, 0x04, 0x05 };
+    const uint8_t button[3] = { 0x01, 2, 0 };
+    const uint8_t leds[1] = { 0x02 };
+
+    hurricane_cycles_init();
+    for (uint8_t i = 0; i < 3; i++) {
+        hurricane_hw_register_controller(1 + i, "quiet", &quiet_port, NULL);
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        hurricane_context_init(&pcs[i], HURRICANE_HW_PRIMARY_CONTROLLER, 1 + i);
+        hurricane_interface_manager_init_ctx(&pcs[i]);
+        add_interface(&pcs[i], 0, 0x81);
+        add_interface(&pcs[i], 1, 0x82);
+    }
+
+    hurricane_hid_pipeline_init(&keyboard, &keyboard_config);
+    hurricane_hid_pipeline_attach(&keyboard, hid_desc_boot_keyboard, hid_desc_boot_keyboard_size);
+    hurricane_hid_pipeline_init(&mouse, &mouse_config);
+    hurricane_hid_pipeline_attach(&mouse, hid_desc_boot_mouse, hid_desc_boot_mouse_size);
+
+    hurricane_hid_output_relay_init(&led_relay, 0, 0x01, 0);
+    led_relay.controller = 3;
+    hurricane_hid_kvm_init(&kvm, HURRICANE_HID_KVM_CTRL_ALT, &led_relay);
+    hurricane_hid_kvm_add_target(&kvm, &pcs[0], 0x1E);
+    hurricane_hid_kvm_add_target(&kvm, &pcs[1], 0x1F);
+    hurricane_hid_kvm_add_pipeline(&kvm, &keyboard);
+    hurricane_hid_kvm_add_pipeline(&kvm, &mouse);
+    hurricane_hid_kvm_output(&kvm, 0, 0, leds, 1, 0);
+    hurricane_hid_kvm_output(&kvm, 1, 0, (const uint8_t[]){ 0 }, 1, 0);
+
+    uint32_t total = 0;
+    uint32_t worst = 0;
+    for (int i = 0; i < SWITCHES; i++) {
+        // Something held on the old PC, so there is something to release
+        hurricane_hid_kvm_submit(&kvm, 0, keys, sizeof(keys), (uint32_t)i);
+        hurricane_hid_kvm_submit(&kvm, 1, button, sizeof(button), (uint32_t)i);
+
+        uint32_t start = hurricane_cycles_now();
+        hurricane_hid_kvm_switch(&kvm, (uint8_t)((i + 1) & 1), (uint32_t)i);
+        uint32_t cost = hurricane_cycles_now() - start;
+        total += cost;
+        worst = cost > worst ? cost : worst;
+    }
+
+    printf("==== KVM focus switch, keyboard + mouse, keys held (%s) ====\n", HURRICANE_CYCLES_UNIT);
+    printf("%-16s %.2f\n", "average", (double)total / SWITCHES);
+    printf("%-16s %u\n", "worst", worst);
+    printf("%-16s %u\n", "switches", kvm.switches);
+    printf("%-16s 125000 (high-speed microframe), 1000000 (full-speed frame)\n", "budget");
+    return 0;
+}
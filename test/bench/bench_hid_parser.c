@@ -0,0 +1,82 @@
+// tests/bench/bench_hid_parser.c
+//
+// Host-side benchmark of the HID report descriptor parser: time to compile
+// each real descriptor, and time to read every field of one report from the
+// compiled layout. Run with `make bench`.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "../common/hid_descriptors.h"
+#include "usb/usb_hid_parser.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#define PARSE_ITERATIONS  200000
+#define READ_ITERATIONS   2000000
+
+static hurricane_hid_layout_t layout;
+static volatile int32_t sink;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_descriptor(const char* name, const uint8_t* desc, uint16_t length, uint8_t report_id)
+{
+    uint8_t payload[64];
+    for (unsigned i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 37 + 11);
+    }
+
+    uint64_t start = now_ns();
+    for (int i = 0; i < PARSE_ITERATIONS; i++) {
+        if (hurricane_hid_parse_report_descriptor(desc, length, &layout) != HURRICANE_HID_PARSE_OK) {
+            printf("%-14s parse failed\n", name);
+            return;
+        }
+    }
+    uint64_t parse_ns = now_ns() - start;
+
+    const hurricane_hid_report_info_t* report =
+        hurricane_hid_layout_find_report(&layout, HURRICANE_HID_REPORT_INPUT, report_id);
+    if (!report) {
+        printf("%-14s has no input report %u\n", name, report_id);
+        return;
+    }
+    const hurricane_hid_field_t* fields = &layout.fields[report->first_field];
+    uint16_t size = hurricane_hid_report_payload_size(report);
+    unsigned elements = 0;
+
+    start = now_ns();
+    for (int i = 0; i < READ_ITERATIONS; i++) {
+        int32_t acc = 0;
+        for (uint8_t f = 0; f < report->num_fields; f++) {
+            for (uint16_t e = 0; e < fields[f].count; e++) {
+                acc += hurricane_hid_field_read(&fields[f], payload, size, e);
+            }
+        }
+        sink = acc;
+    }
+    uint64_t read_ns = now_ns() - start;
+    for (uint8_t f = 0; f < report->num_fields; f++) {
+        elements += fields[f].count;
+    }
+
+    printf("%-14s %3u bytes -> %2u fields / %u reports: parse %7.1f ns, read report (%2u elements) %6.1f ns\n",
+           name, length, layout.num_fields, layout.num_reports,
+           (double)parse_ns / PARSE_ITERATIONS, elements, (double)read_ns / READ_ITERATIONS);
+}
+
+int main(void)
+{
+    printf("==== HID report descriptor parser ====\n");
+    bench_descriptor("boot keyboard", hid_desc_boot_keyboard, hid_desc_boot_keyboard_size, 0);
+    bench_descriptor("boot mouse", hid_desc_boot_mouse, hid_desc_boot_mouse_size, 0);
+    bench_descriptor("gaming mouse", hid_desc_gaming_mouse, hid_desc_gaming_mouse_size, 1);
+    return 0;
+}
@@ -0,0 +1,62 @@
+// tests/bench/bench_hid_pipeline.c
+//
+// Cost of pushing a gaming mouse report through a pipeline into a boot
+// mouse sink, per stage as reported by the pipeline's own profiling and in
+// total without it. The pipe is deferred so the dummy HAL's sink does not
+// end up in the numbers. Run with `make bench`.
+
+#include "../common/hid_descriptors.h"
+#include "core/hurricane_cycles.h"
+#include "usb/usb_hid_pipeline.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define ITERATIONS 1000000
+
+static hurricane_hid_pipeline_t pipeline;
+
+static const hurricane_hid_transform_rule_t rules[] = {
+    { .op = HURRICANE_HID_XFORM_SCALE, .usage_page = 0x01, .usage = 0x30, .param = 3 * HURRICANE_HID_Q16_ONE / 4 },
+    { .op = HURRICANE_HID_XFORM_SCALE, .usage_page = 0x01, .usage = 0x31, .param = 3 * HURRICANE_HID_Q16_ONE / 4 },
+};
+static const char* const stage_names[] = { "decode", "transform", "map" };
+
+static void push_reports(void)
+{
+    uint8_t report[9] = { 1 };
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        report[1] = (uint8_t)(i & 3);
+        report[3] = (uint8_t)(i & 7);
+        report[5] = (uint8_t)-(i & 3);
+        hurricane_hid_pipeline_submit(&pipeline, report, sizeof(report), 0);
+    }
+}
+
+int main(void)
+{
+    hurricane_hid_pipe_config_t pipe = {
+        .source_page = 0x01, .source_usage = 0x02, .sink_endpoint = 0x81, .flags = HURRICANE_HID_PIPE_DEFER,
+        .rules = rules, .num_rules = 2,
+        .sink_descriptor = hid_desc_boot_mouse, .sink_descriptor_length = hid_desc_boot_mouse_size
+    };
+    hurricane_hid_pipeline_config_t config = { .pipes = &pipe, .num_pipes = 1 };
+
+    hurricane_cycles_init();
+    hurricane_hid_pipeline_init(&pipeline, &config);
+    hurricane_hid_pipeline_attach(&pipeline, hid_desc_gaming_mouse, hid_desc_gaming_mouse_size);
+
+    hurricane_hid_pipeline_set_profiling(&pipeline, true);
+    push_reports();
+    printf("==== HID pipeline, gaming mouse -> boot mouse (per report, %s) ====\n", HURRICANE_CYCLES_UNIT);
+    for (uint8_t s = 0; s < sizeof(stage_names) / sizeof(stage_names[0]); s++) {
+        printf("%-16s %u\n", stage_names[s], hurricane_hid_pipeline_stage_cost(&pipeline, 0, s));
+    }
+
+    hurricane_hid_pipeline_set_profiling(&pipeline, false);
+    uint32_t start = hurricane_cycles_now();
+    push_reports();
+    printf("%-16s %.2f\n", "total, unprofiled", (double)(hurricane_cycles_now() - start) / ITERATIONS);
+    return 0;
+}
@@ -0,0 +1,60 @@
+// tests/bench/bench_hid_transform.c
+//
+// Per-rule cost of a typical mouse transform (DPI scaling, inversion,
+// button remap) as reported by the engine's own profiling, next to the cost
+// of a report no rule touches. Run with `make bench`.
+
+#include "../common/hid_descriptors.h"
+#include "core/hurricane_cycles.h"
+#include "usb/usb_hid_transform.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define ITERATIONS 1000000
+
+static hurricane_hid_layout_t layout;
+static hurricane_hid_decode_plan_t plan;
+static hurricane_hid_transform_t xf;
+static int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];
+
+static const hurricane_hid_transform_rule_t rules[] = {
+    { .op = HURRICANE_HID_XFORM_SCALE, .usage_page = 0x01, .usage = 0x30, .param = 3 * HURRICANE_HID_Q16_ONE / 4 },
+    { .op = HURRICANE_HID_XFORM_SCALE, .usage_page = 0x01, .usage = 0x31, .param = 3 * HURRICANE_HID_Q16_ONE / 4 },
+    { .op = HURRICANE_HID_XFORM_INVERT, .usage_page = 0x01, .usage = 0x38 },
+    { .op = HURRICANE_HID_XFORM_REMAP, .usage_page = 0x09, .usage = 4, .target_page = 0x09, .target_usage = 2 },
+};
+static const char* const rule_names[] = { "scale X 0.75", "scale Y 0.75", "invert wheel", "remap button 4" };
+
+int main(void)
+{
+    hurricane_cycles_init();
+
+    hurricane_hid_parse_report_descriptor(hid_desc_gaming_mouse, hid_desc_gaming_mouse_size, &layout);
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 1, &plan);
+    hurricane_hid_transform_compile(&xf, rules, 4, &layout, &plan);
+    hurricane_hid_transform_set_profiling(&xf, true);
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        values[0] = (i & 1) ? 0x0008 : 0;
+        values[1] = i & 7;
+        values[2] = -(i & 3);
+        values[3] = 1;
+        hurricane_hid_transform_run(&xf, values);
+    }
+
+    printf("==== HID transform (per rule, %s) ====\n", HURRICANE_CYCLES_UNIT);
+    for (uint8_t r = 0; r < 4; r++) {
+        printf("%-16s %u\n", rule_names[r], hurricane_hid_transform_rule_cost(&xf, r));
+    }
+
+    // A report without matching rules only pays for the activity check
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 3, &plan);
+    hurricane_hid_transform_compile(&xf, rules, 4, &layout, &plan);
+    uint32_t start = hurricane_cycles_now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        hurricane_hid_transform_run(&xf, values);
+    }
+    printf("%-16s %.2f\n", "untouched report", (double)(hurricane_cycles_now() - start) / ITERATIONS);
+    return 0;
+}
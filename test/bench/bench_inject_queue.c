@@ -0,0 +1,92 @@
+// tests/bench/bench_inject_queue.c
+//
+// Cost of one push into the injection queue, uncontended, and a stress run
+// with several producer threads against one consumer that checks nothing
+// is lost, duplicated or reordered per producer. Run with `make bench`.
+
+#include "core/hurricane_cycles.h"
+#include "usb/usb_hid_inject_queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#define ROUNDS      20000
+#define PRODUCERS   4
+#define PER_THREAD  100000
+
+static hurricane_inject_queue_t queue;
+
+static double per_push(void)
+{
+    hurricane_inject_event_t event = { .usage_page = 0x01, .usage = 0x30, .value = 1 };
+    uint32_t total = 0;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        uint32_t start = hurricane_cycles_now();
+        for (int i = 0; i < HURRICANE_INJECT_QUEUE_SIZE; i++) {
+            hurricane_inject_queue_push(&queue, &event);
+        }
+        total += hurricane_cycles_now() - start;
+        while (hurricane_inject_queue_pop(&queue, &event)) {
+        }
+    }
+    return (double)total / ROUNDS / HURRICANE_INJECT_QUEUE_SIZE;
+}
+
+static void* producer(void* arg)
+{
+    hurricane_inject_event_t event = { .pipe = (uint8_t)(uintptr_t)arg };
+
+    for (int32_t i = 0; i < PER_THREAD; i++) {
+        event.value = i;
+        while (hurricane_inject_queue_push(&queue, &event) != 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static int stress(void)
+{
+    pthread_t threads[PRODUCERS];
+    int32_t next[PRODUCERS] = { 0 };
+    long received = 0;
+    int errors = 0;
+    hurricane_inject_event_t event;
+
+    hurricane_inject_queue_init(&queue);
+    for (uintptr_t t = 0; t < PRODUCERS; t++) {
+        pthread_create(&threads[t], NULL, producer, (void*)t);
+    }
+    while (received < (long)PRODUCERS * PER_THREAD) {
+        if (!hurricane_inject_queue_pop(&queue, &event)) {
+            sched_yield();
+            continue;
+        }
+        if (event.pipe >= PRODUCERS || event.value != next[event.pipe]) {
+            errors++;
+        } else {
+            next[event.pipe]++;
+        }
+        received++;
+    }
+    for (int t = 0; t < PRODUCERS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    return errors;
+}
+
+int main(void)
+{
+    hurricane_cycles_init();
+    hurricane_inject_queue_init(&queue);
+
+    printf("==== Injection queue (%s) ====\n", HURRICANE_CYCLES_UNIT);
+    printf("push, uncontended   %.2f\n", per_push());
+
+    int errors = stress();
+    printf("%d producers x %d  %s\n", PRODUCERS, PER_THREAD, errors ? "LOST OR REORDERED" : "ok");
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,64 @@
+// tests/bench/bench_inject_sched.c
+//
+// Cost per scheduled action (queue plus release into the merge) for short
+// and long scripts; the heap should make it grow with log n, not n. Run
+// with `make bench`.
+
+#include "../common/hid_descriptors.h"
+#include "core/hurricane_cycles.h"
+#include "usb/usb_hid_inject_sched.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define ROUNDS 2000
+#define LONG_SCRIPT 4096
+
+static hurricane_hid_layout_t layout;
+static hurricane_hid_pack_plan_t plan;
+static hurricane_hid_merge_t merge;
+static hurricane_inject_sched_t sched;
+static hurricane_inject_event_t storage[LONG_SCRIPT];
+
+static double per_action(uint16_t script_length)
+{
+    uint32_t seed = 1;
+    uint32_t now = 0;
+    uint32_t total = 0;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        uint32_t start = hurricane_cycles_now();
+        for (uint16_t i = 0; i < script_length; i++) {
+            seed = seed * 1103515245u + 12345u;
+            hurricane_inject_event_t event = {
+                .due_us = now + (seed >> 20),
+                .usage_page = 0x01, .usage = 0x30, .value = 1,
+                .pipe = 0, .action = HURRICANE_INJECT_MOVE
+            };
+            hurricane_inject_sched_add(&sched, &event);
+        }
+        // One run per simulated 125 us microframe until the script is done
+        while (hurricane_inject_sched_pending(&sched)) {
+            now += 125;
+            hurricane_inject_sched_run(&sched, now, &merge, 1);
+        }
+        total += hurricane_cycles_now() - start;
+    }
+    return (double)total / ROUNDS / script_length;
+}
+
+int main(void)
+{
+    hurricane_cycles_init();
+
+    hurricane_hid_parse_report_descriptor(hid_desc_gaming_mouse, hid_desc_gaming_mouse_size, &layout);
+    hurricane_hid_pack_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 1, &plan);
+    hurricane_hid_merge_init(&merge, &layout, &plan);
+    hurricane_inject_sched_init_storage(&sched, storage, LONG_SCRIPT);
+
+    printf("==== Injection scheduler (per action, %s) ====\n", HURRICANE_CYCLES_UNIT);
+    for (uint16_t n = 16; n <= LONG_SCRIPT; n *= 4) {
+        printf("%4u actions     %.2f\n", n, per_action(n));
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+// tests/bench/bench_interface_lookup.c
+//
+// Cost of interface manager lookups, the path the device HAL takes from the
+// USB interrupt: alone, then with several reader threads while a writer
+// keeps republishing the registry. Readers never wait, so the time per
+// lookup over all threads should stay flat as readers are added. The writer
+// changes max packet size and interval of one endpoint together, so a
+// lookup that mixes two publications shows up as a torn pair. Run with
+// `make bench`.
+
+#include "core/hurricane_context.h"
+#include "core/hurricane_cycles.h"
+#include "hw/hurricane_hw_ops.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#define INTERFACES  4
+#define LOOKUPS     1000000
+#define MAX_READERS 4
+
+static int quiet_configure(void* priv, uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+{
+    (void)priv;
+    (void)a;
+    (void)b;
+    (void)c;
+    (void)d;
+    return 0;
+}
+
+static int quiet_configure_endpoint(void* priv, uint8_t a, uint8_t b, uint8_t c, uint16_t d, uint8_t e)
+{
+    (void)priv;
+    (void)a;
+    (void)b;
+    (void)c;
+    (void)d;
+    (void)e;
+    return 0;
+}
+
+static const hurricane_hw_ops_t quiet_port = {
+    .device_configure_interface = quiet_configure,
+    .device_configure_endpoint = quiet_configure_endpoint,
+};
+
+static hurricane_context_t ctx;
+static atomic_bool stop;
+static atomic_int errors;
+
+static uint8_t endpoint_of(uint32_t i)
+{
+    return (uint8_t)(0x81 + (i % INTERFACES));
+}
+
+static double per_lookup(void)
+{
+    uint32_t found = 0;
+    uint32_t start = hurricane_cycles_now();
+    for (uint32_t i = 0; i < LOOKUPS; i++) {
+        found += hurricane_get_device_endpoint_ctx(&ctx, (uint8_t)(i % INTERFACES), endpoint_of(i), NULL);
+    }
+    uint32_t total = hurricane_cycles_now() - start;
+    if (found != LOOKUPS) {
+        atomic_fetch_add(&errors, 1);
+    }
+    return (double)total / LOOKUPS;
+}
+
+static double per_lookup_by_address(void)
+{
+    uint32_t found = 0;
+    uint32_t start = hurricane_cycles_now();
+    for (uint32_t i = 0; i < LOOKUPS; i++) {
+        found += hurricane_get_device_endpoint_by_address_ctx(&ctx, endpoint_of(i), NULL);
+    }
+    uint32_t total = hurricane_cycles_now() - start;
+    if (found != LOOKUPS) {
+        atomic_fetch_add(&errors, 1);
+    }
+    return (double)total / LOOKUPS;
+}
+
+static void* reader(void* arg)
+{
+    (void)arg;
+    for (uint32_t i = 0; i < LOOKUPS; i++) {
+        hurricane_endpoint_descriptor_t ep;
+        bool found = hurricane_get_device_endpoint_ctx(&ctx, (uint8_t)(i % INTERFACES), endpoint_of(i), &ep);
+        // Either publication, never half of each
+        if (!found || !((ep.ep_max_packet_size == 8 && ep.ep_interval == 1) ||
+                        (ep.ep_max_packet_size == 64 && ep.ep_interval == 10))) {
+            atomic_fetch_add(&errors, 1);
+        }
+        if ((i & 0xFFF) == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Republishes the registry as fast as it gets the CPU; EP 0x81 stays configured
+static void* writer(void* arg)
+{
+    uint32_t* writes = (uint32_t*)arg;
+    while (!atomic_load(&stop)) {
+        bool full_speed = *writes & 1;
+        hurricane_device_configure_endpoint_ctx(&ctx, 0, 0x81, 0x03, full_speed ? 64 : 8, full_speed ? 10 : 1);
+        (*writes)++;
+        sched_yield();
+    }
+    return NULL;
+}
+
+static double contended(int readers, uint32_t* writes)
+{
+    pthread_t threads[MAX_READERS];
+    pthread_t writer_thread;
+
+    *writes = 0;
+    atomic_store(&stop, false);
+    pthread_create(&writer_thread, NULL, writer, writes);
+
+    uint32_t start = hurricane_cycles_now();
+    for (int t = 0; t < readers; t++) {
+        pthread_create(&threads[t], NULL, reader, NULL);
+    }
+    for (int t = 0; t < readers; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    uint32_t total = hurricane_cycles_now() - start;
+
+    atomic_store(&stop, true);
+    pthread_join(writer_thread, NULL);
+    return (double)total / ((double)readers * LOOKUPS);
+}
+
+int main(void)
+{
+    hurricane_cycles_init();
+    hurricane_hw_register_controller(1, "quiet", &quiet_port, NULL);
+    hurricane_context_init(&ctx, HURRICANE_HW_PRIMARY_CONTROLLER, 1);
+    hurricane_interface_manager_init_ctx(&ctx);
+    for (uint8_t i = 0; i < INTERFACES; i++) {
+        hurricane_interface_descriptor_t desc = { .interface_num = i, .interface_class = 3, .num_endpoints = 1 };
+        hurricane_add_device_interface_ctx(&ctx, i, 3, 0, 0, &desc);
+        hurricane_device_configure_endpoint_ctx(&ctx, i, endpoint_of(i), 0x03, 8, 1);
+    }
+
+    // The manager logs every registry change; keep that out of the writer's numbers
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    if (!freopen("/dev/null", "w", stdout)) {
+        return 1;
+    }
+
+    double alone = per_lookup();
+    double by_address = per_lookup_by_address();
+    uint32_t writes[MAX_READERS + 1] = { 0 };
+    double shared[MAX_READERS + 1] = { 0 };
+    for (int readers = 1; readers <= MAX_READERS; readers *= 2) {
+        shared[readers] = contended(readers, &writes[readers]);
+    }
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    printf("==== Interface manager lookups (%s, %ld CPUs online) ====\n", HURRICANE_CYCLES_UNIT,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-28s %.2f\n", "endpoint, one thread", alone);
+    printf("%-28s %.2f\n", "endpoint by address", by_address);
+    for (int readers = 1; readers <= MAX_READERS; readers *= 2) {
+        printf("%d reader(s) + writer        %.2f per lookup over all readers, %u republications\n",
+               readers, shared[readers], writes[readers]);
+    }
+    printf("%-28s %s\n", "missed or torn lookups", atomic_load(&errors) ? "SOME" : "none");
+    return atomic_load(&errors) ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+// tests/common/hid_descriptors.c
+
+#include "hid_descriptors.h"
+
+const uint8_t hid_desc_boot_keyboard[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x06,         // Usage (Keyboard)
+    0xA1, 0x01,         // Collection (Application)
+    0x05, 0x07,         //   Usage Page (Key Codes)
+    0x19, 0xE0,         //   Usage Minimum (224)
+    0x29, 0xE7,         //   Usage Maximum (231)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x01,         //   Logical Maximum (1)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x08,         //   Report Count (8)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute) ; Modifier byte
+    0x95, 0x01,         //   Report Count (1)
+    0x75, 0x08,         //   Report Size (8)
+    0x81, 0x01,         //   Input (Constant) ; Reserved byte
+    0x95, 0x05,         //   Report Count (5)
+    0x75, 0x01,         //   Report Size (1)
+    0x05, 0x08,         //   Usage Page (LEDs)
+    0x19, 0x01,         //   Usage Minimum (1)
+    0x29, 0x05,         //   Usage Maximum (5)
+    0x91, 0x02,         //   Output (Data, Variable, Absolute) ; LED report
+    0x95, 0x01,         //   Report Count (1)
+    0x75, 0x03,         //   Report Size (3)
+    0x91, 0x01,         //   Output (Constant) ; LED report padding
+    0x95, 0x06,         //   Report Count (6)
+    0x75, 0x08,         //   Report Size (8)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x65,         //   Logical Maximum (101)
+    0x05, 0x07,         //   Usage Page (Key Codes)
+    0x19, 0x00,         //   Usage Minimum (0)
+    0x29, 0x65,         //   Usage Maximum (101)
+    0x81, 0x00,         //   Input (Data, Array) ; Key arrays (6 bytes)
+    0xC0                // End Collection
+};
+const uint16_t hid_desc_boot_keyboard_size = sizeof(hid_desc_boot_keyboard);
+
+const uint8_t hid_desc_boot_mouse[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x02,         // Usage (Mouse)
+    0xA1, 0x01,         // Collection (Application)
+    0x09, 0x01,         //   Usage (Pointer)
+    0xA1, 0x00,         //   Collection (Physical)
+    0x05, 0x09,         //     Usage Page (Buttons)
+    0x19, 0x01,         //     Usage Minimum (1)
+    0x29, 0x03,         //     Usage Maximum (3)
+    0x15, 0x00,         //     Logical Minimum (0)
+    0x25, 0x01,         //     Logical Maximum (1)
+    0x95, 0x03,         //     Report Count (3)
+    0x75, 0x01,         //     Report Size (1)
+    0x81, 0x02,         //     Input (Data, Variable, Absolute) ; 3 button bits
+    0x95, 0x01,         //     Report Count (1)
+    0x75, 0x05,         //     Report Size (5)
+    0x81, 0x01,         //     Input (Constant) ; 5 bit padding
+    0x05, 0x01,         //     Usage Page (Generic Desktop)
+    0x09, 0x30,         //     Usage (X)
+    0x09, 0x31,         //     Usage (Y)
+    0x15, 0x81,         //     Logical Minimum (-127)
+    0x25, 0x7F,         //     Logical Maximum (127)
+    0x75, 0x08,         //     Report Size (8)
+    0x95, 0x02,         //     Report Count (2)
+    0x81, 0x06,         //     Input (Data, Variable, Relative) ; 2 position bytes (X & Y)
+    0xC0,               //   End Collection
+    0xC0                // End Collection
+};
+const uint16_t hid_desc_boot_mouse_size = sizeof(hid_desc_boot_mouse);
+
+const uint8_t hid_desc_gaming_mouse[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x02,         // Usage (Mouse)
+    0xA1, 0x01,         // Collection (Application)
+    0x85, 0x01,         //   Report ID (1)
+    0x09, 0x01,         //   Usage (Pointer)
+    0xA1, 0x00,         //   Collection (Physical)
+    0x05, 0x09,         //     Usage Page (Buttons)
+    0x19, 0x01,         //     Usage Minimum (1)
+    0x29, 0x10,         //     Usage Maximum (16)
+    0x15, 0x00,         //     Logical Minimum (0)
+    0x25, 0x01,         //     Logical Maximum (1)
+    0x95, 0x10,         //     Report Count (16)
+    0x75, 0x01,         //     Report Size (1)
+    0x81, 0x02,         //     Input (Data, Variable, Absolute)
+    0x05, 0x01,         //     Usage Page (Generic Desktop)
+    0x16, 0x01, 0x80,   //     Logical Minimum (-32767)
+    0x26, 0xFF, 0x7F,   //     Logical Maximum (32767)
+    0x75, 0x10,         //     Report Size (16)
+    0x95, 0x02,         //     Report Count (2)
+    0x09, 0x30,         //     Usage (X)
+    0x09, 0x31,         //     Usage (Y)
+    0x81, 0x06,         //     Input (Data, Variable, Relative)
+    0x15, 0x81,         //     Logical Minimum (-127)
+    0x25, 0x7F,         //     Logical Maximum (127)
+    0x75, 0x08,         //     Report Size (8)
+    0x95, 0x01,         //     Report Count (1)
+    0x09, 0x38,         //     Usage (Wheel)
+    0x81, 0x06,         //     Input (Data, Variable, Relative)
+    0x05, 0x0C,         //     Usage Page (Consumer)
+    0x0A, 0x38, 0x02,   //     Usage (AC Pan)
+    0x95, 0x01,         //     Report Count (1)
+    0x81, 0x06,         //     Input (Data, Variable, Relative)
+    0xC0,               //   End Collection
+    0xC0,               // End Collection
+    0x05, 0x0C,         // Usage Page (Consumer)
+    0x09, 0x01,         // Usage (Consumer Control)
+    0xA1, 0x01,         // Collection (Application)
+    0x85, 0x03,         //   Report ID (3)
+    0x75, 0x10,         //   Report Size (16)
+    0x95, 0x02,         //   Report Count (2)
+    0x15, 0x01,         //   Logical Minimum (1)
+    0x26, 0xFF, 0x02,   //   Logical Maximum (767)
+    0x19, 0x01,         //   Usage Minimum (1)
+    0x2A, 0xFF, 0x02,   //   Usage Maximum (767)
+    0x81, 0x00,         //   Input (Data, Array, Absolute)
+    0xC0                // End Collection
+};
+const uint16_t hid_desc_gaming_mouse_size = sizeof(hid_desc_gaming_mouse);
@@ -0,0 +1,24 @@
+// tests/common/hid_descriptors.h
+//
+// Report descriptors of real devices, shared by the unit tests and the
+// benchmarks.
+
+#ifndef HID_DESCRIPTORS_H
+#define HID_DESCRIPTORS_H
+
+#include <stdint.h>
+
+// HID 1.11 Appendix B.1: boot keyboard (modifiers, reserved byte, 5 LEDs, 6 keys)
+extern const uint8_t hid_desc_boot_keyboard[];
+extern const uint16_t hid_desc_boot_keyboard_size;
+
+// HID 1.11 Appendix B.2: boot mouse (3 buttons, 8-bit X/Y)
+extern const uint8_t hid_desc_boot_mouse[];
+extern const uint16_t hid_desc_boot_mouse_size;
+
+// Gaming mouse: report ID 1 with 16 buttons, 16-bit X/Y, wheel and AC pan,
+// report ID 3 with a two-slot consumer control array
+extern const uint8_t hid_desc_gaming_mouse[];
+extern const uint16_t hid_desc_gaming_mouse_size;
+
+#endif /* HID_DESCRIPTORS_H */
@@ -0,0 +1,375 @@
+/**
+ * @file hid_gaming_mouse_reports.h
+ * @brief Report accessors generated from hid_descriptors.c
+ *
+ * Generated by tools/hid_codegen, do not edit; regenerate with `make codegen`.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef HID_CODEGEN_HELPERS
+#define HID_CODEGEN_HELPERS
+// Element access at a bit position; constant arguments fold after inlining
+static inline int32_t hid_codegen_read(const uint8_t* report, uint32_t bit, uint8_t size, bool is_signed)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < size; i++, bit++) {
+        value |= (uint32_t)((report[bit / 8] >> (bit % 8)) & 1u) << i;
+    }
+    if (is_signed && size < 32 && (value & (1u << (size - 1)))) {
+        value |= ~0u << size;
+    }
+    return (int32_t)value;
+}
+
+static inline void hid_codegen_write(uint8_t* report, uint32_t bit, uint8_t size, int32_t value)
+{
+    for (uint8_t i = 0; i < size; i++, bit++) {
+        uint8_t mask = (uint8_t)(1u << (bit % 8));
+        if (((uint32_t)value >> i) & 1u) {
+            report[bit / 8] |= mask;
+        } else {
+            report[bit / 8] &= (uint8_t)~mask;
+        }
+    }
+}
+#endif
+
+// hid_desc_gaming_mouse
+#define GAMING_MOUSE_DESCRIPTOR_LENGTH 94
+#define GAMING_MOUSE_DESCRIPTOR_HASH 0xFF04F015u    // FNV-1a
+#define GAMING_MOUSE_DESCRIPTOR_BYTES \
+    0x05, 0x01, \
+    0x09, 0x02, \
+    0xA1, 0x01, \
+    0x85, 0x01, \
+    0x09, 0x01, \
+    0xA1, 0x00, \
+    0x05, 0x09, \
+    0x19, 0x01, \
+    0x29, 0x10, \
+    0x15, 0x00, \
+    0x25, 0x01, \
+    0x95, 0x10, \
+    0x75, 0x01, \
+    0x81, 0x02, \
+    0x05, 0x01, \
+    0x16, 0x01, 0x80, \
+    0x26, 0xFF, 0x7F, \
+    0x75, 0x10, \
+    0x95, 0x02, \
+    0x09, 0x30, \
+    0x09, 0x31, \
+    0x81, 0x06, \
+    0x15, 0x81, \
+    0x25, 0x7F, \
+    0x75, 0x08, \
+    0x95, 0x01, \
+    0x09, 0x38, \
+    0x81, 0x06, \
+    0x05, 0x0C, \
+    0x0A, 0x38, 0x02, \
+    0x95, 0x01, \
+    0x81, 0x06, \
+    0xC0, \
+    0xC0, \
+    0x05, 0x0C, \
+    0x09, 0x01, \
+    0xA1, 0x01, \
+    0x85, 0x03, \
+    0x75, 0x10, \
+    0x95, 0x02, \
+    0x15, 0x01, \
+    0x26, 0xFF, 0x02, \
+    0x19, 0x01, \
+    0x2A, 0xFF, 0x02, \
+    0x81, 0x00, \
+    0xC0
+
+#define GAMING_MOUSE_LAYOUT { \
+    .fields = { \
+        { .usage_page = 0x09, .usage = 0x01, .usage_max = 0x10, .bit_offset = 0, .count = 16, .flags = 0x02, .report_id = 1, .report_index = 0, .bit_size = 1, .type = 1, .logical_min = 0, .logical_max = 1 }, \
+        { .usage_page = 0x01, .usage = 0x30, .usage_max = 0x30, .bit_offset = 16, .count = 1, .flags = 0x8006, .report_id = 1, .report_index = 0, .bit_size = 16, .type = 1, .logical_min = -32767, .logical_max = 32767 }, \
+        { .usage_page = 0x01, .usage = 0x31, .usage_max = 0x31, .bit_offset = 32, .count = 1, .flags = 0x8006, .report_id = 1, .report_index = 0, .bit_size = 16, .type = 1, .logical_min = -32767, .logical_max = 32767 }, \
+        { .usage_page = 0x01, .usage = 0x38, .usage_max = 0x38, .bit_offset = 48, .count = 1, .flags = 0x8006, .report_id = 1, .report_index = 0, .bit_size = 8, .type = 1, .logical_min = -127, .logical_max = 127 }, \
+        { .usage_page = 0x0C, .usage = 0x238, .usage_max = 0x238, .bit_offset = 56, .count = 1, .flags = 0x8006, .report_id = 1, .report_index = 0, .bit_size = 8, .type = 1, .logical_min = -127, .logical_max = 127 }, \
+        { .usage_page = 0x0C, .usage = 0x01, .usage_max = 0x2FF, .bit_offset = 0, .count = 2, .flags = 0x00, .report_id = 3, .report_index = 1, .bit_size = 16, .type = 1, .logical_min = 1, .logical_max = 767 }, \
+    }, \
+    .reports = { \
+        { .report_id = 1, .type = 1, .bit_length = 64, .first_field = 0, .num_fields = 5, .application_page = 0x01, .application_usage = 0x02 }, \
+        { .report_id = 3, .type = 1, .bit_length = 32, .first_field = 5, .num_fields = 1, .application_page = 0x0C, .application_usage = 0x01 }, \
+    }, \
+    .num_fields = 6, \
+    .num_reports = 2, \
+    .uses_report_ids = true \
+}
+
+// input report 1
+#define GAMING_MOUSE_INPUT1_SIZE 9
+#define GAMING_MOUSE_INPUT1_ID 1
+
+static inline int32_t gaming_mouse_input1_button1(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[1];
+    return (int32_t)(raw & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button1(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0x1u;
+    report[1] = (uint8_t)((report[1] & 0xFEu) | (raw & 0x01u));
+}
+
+static inline int32_t gaming_mouse_input1_button2(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[1];
+    return (int32_t)((raw >> 1) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button2(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 1;
+    report[1] = (uint8_t)((report[1] & 0xFDu) | (raw & 0x02u));
+}
+
+static inline int32_t gaming_mouse_input1_button3(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[1];
+    return (int32_t)((raw >> 2) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button3(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 2;
+    report[1] = (uint8_t)((report[1] & 0xFBu) | (raw & 0x04u));
+}
+
+static inline int32_t gaming_mouse_input1_button4(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[1];
+    return (int32_t)((raw >> 3) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button4(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 3;
+    report[1] = (uint8_t)((report[1] & 0xF7u) | (raw & 0x08u));
+}
+
+static inline int32_t gaming_mouse_input1_button5(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[1];
+    return (int32_t)((raw >> 4) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button5(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 4;
+    report[1] = (uint8_t)((report[1] & 0xEFu) | (raw & 0x10u));
+}
+
+static inline int32_t gaming_mouse_input1_button6(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[1];
+    return (int32_t)((raw >> 5) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button6(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 5;
+    report[1] = (uint8_t)((report[1] & 0xDFu) | (raw & 0x20u));
+}
+
+static inline int32_t gaming_mouse_input1_button7(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[1];
+    return (int32_t)((raw >> 6) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button7(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 6;
+    report[1] = (uint8_t)((report[1] & 0xBFu) | (raw & 0x40u));
+}
+
+static inline int32_t gaming_mouse_input1_button8(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[1];
+    return (int32_t)((raw >> 7) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button8(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 7;
+    report[1] = (uint8_t)((report[1] & 0x7Fu) | (raw & 0x80u));
+}
+
+static inline int32_t gaming_mouse_input1_button9(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[2];
+    return (int32_t)(raw & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button9(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0x1u;
+    report[2] = (uint8_t)((report[2] & 0xFEu) | (raw & 0x01u));
+}
+
+static inline int32_t gaming_mouse_input1_button10(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[2];
+    return (int32_t)((raw >> 1) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button10(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 1;
+    report[2] = (uint8_t)((report[2] & 0xFDu) | (raw & 0x02u));
+}
+
+static inline int32_t gaming_mouse_input1_button11(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[2];
+    return (int32_t)((raw >> 2) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button11(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 2;
+    report[2] = (uint8_t)((report[2] & 0xFBu) | (raw & 0x04u));
+}
+
+static inline int32_t gaming_mouse_input1_button12(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[2];
+    return (int32_t)((raw >> 3) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button12(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 3;
+    report[2] = (uint8_t)((report[2] & 0xF7u) | (raw & 0x08u));
+}
+
+static inline int32_t gaming_mouse_input1_button13(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[2];
+    return (int32_t)((raw >> 4) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button13(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 4;
+    report[2] = (uint8_t)((report[2] & 0xEFu) | (raw & 0x10u));
+}
+
+static inline int32_t gaming_mouse_input1_button14(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[2];
+    return (int32_t)((raw >> 5) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button14(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 5;
+    report[2] = (uint8_t)((report[2] & 0xDFu) | (raw & 0x20u));
+}
+
+static inline int32_t gaming_mouse_input1_button15(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[2];
+    return (int32_t)((raw >> 6) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button15(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 6;
+    report[2] = (uint8_t)((report[2] & 0xBFu) | (raw & 0x40u));
+}
+
+static inline int32_t gaming_mouse_input1_button16(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[2];
+    return (int32_t)((raw >> 7) & 0x1u);
+}
+
+static inline void gaming_mouse_input1_set_button16(uint8_t* report, int32_t value)
+{
+    uint32_t raw = ((uint32_t)value & 0x1u) << 7;
+    report[2] = (uint8_t)((report[2] & 0x7Fu) | (raw & 0x80u));
+}
+
+static inline int32_t gaming_mouse_input1_x(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[3] | (uint32_t)report[4] << 8;
+    uint32_t value = raw & 0xFFFFu;
+    return (int32_t)(value ^ 0x8000u) - 0x8000;
+}
+
+static inline void gaming_mouse_input1_set_x(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0xFFFFu;
+    report[3] = (uint8_t)raw;
+    report[4] = (uint8_t)(raw >> 8);
+}
+
+static inline int32_t gaming_mouse_input1_y(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[5] | (uint32_t)report[6] << 8;
+    uint32_t value = raw & 0xFFFFu;
+    return (int32_t)(value ^ 0x8000u) - 0x8000;
+}
+
+static inline void gaming_mouse_input1_set_y(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0xFFFFu;
+    report[5] = (uint8_t)raw;
+    report[6] = (uint8_t)(raw >> 8);
+}
+
+static inline int32_t gaming_mouse_input1_wheel(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[7];
+    uint32_t value = raw & 0xFFu;
+    return (int32_t)(value ^ 0x80u) - 0x80;
+}
+
+static inline void gaming_mouse_input1_set_wheel(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0xFFu;
+    report[7] = (uint8_t)raw;
+}
+
+static inline int32_t gaming_mouse_input1_ac_pan(const uint8_t* report)
+{
+    uint32_t raw = (uint32_t)report[8];
+    uint32_t value = raw & 0xFFu;
+    return (int32_t)(value ^ 0x80u) - 0x80;
+}
+
+static inline void gaming_mouse_input1_set_ac_pan(uint8_t* report, int32_t value)
+{
+    uint32_t raw = (uint32_t)value & 0xFFu;
+    report[8] = (uint8_t)raw;
+}
+
+// input report 3
+#define GAMING_MOUSE_INPUT3_SIZE 5
+#define GAMING_MOUSE_INPUT3_ID 3
+
+static inline int32_t gaming_mouse_input3_consumer(const uint8_t* report, uint16_t index)
+{
+    return index < 2 ? hid_codegen_read(report, 8u + index * 16u, 16, false) : 0;
+}
+
+static inline void gaming_mouse_input3_set_consumer(uint8_t* report, uint16_t index, int32_t value)
+{
+    if (index < 2) {
+        hid_codegen_write(report, 8u + index * 16u, 16, value);
+    }
+}
+
@@ -8,6 +8,28 @@ extern int test_usb_control(void);
 extern int test_usb_host_controller(void);
 extern int test_usb_descriptor(void);
 extern int test_usb_interface_manager(void);
+extern int test_usb_host_control_queue(void);
+extern int test_usb_hid_output_relay(void);
+extern int test_usb_ep0_proxy(void);
+extern int test_hurricane_hw_ops(void);
+extern int test_hurricane_context(void);
+extern int test_usb_hid_parser(void);
+extern int test_usb_hid_decode(void);
+extern int test_usb_hid_pack(void);
+extern int test_usb_hid_transform(void);
+extern int test_usb_hid_delta_filter(void);
+extern int test_usb_hid_demux(void);
+extern int test_usb_descriptor_clone(void);
+extern int test_usb_hid_merge(void);
+extern int test_usb_hid_inject_sched(void);
+extern int test_usb_hid_boot(void);
+extern int test_usb_hid_events(void);
+extern int test_usb_hid_inject_queue(void);
+extern int test_hid_codegen(void);
+extern int test_usb_hid_pipeline(void);
+extern int test_usb_report_pool(void);
+extern int test_usb_hid_aggregate(void);
+extern int test_usb_hid_kvm(void);
 
 int main(void)
 {
@@ -19,6 +41,28 @@ int main(void)
     failures += test_usb_host_controller();
     failures += test_usb_descriptor();
     failures += test_usb_interface_manager();
+    failures += test_usb_host_control_queue();
+    failures += test_usb_hid_output_relay();
+    failures += test_usb_ep0_proxy();
+    failures += test_hurricane_hw_ops();
+    failures += test_hurricane_context();
+    failures += test_usb_hid_parser();
+    failures += test_usb_hid_decode();
+    failures += test_usb_hid_pack();
+    failures += test_usb_hid_transform();
+    failures += test_usb_hid_delta_filter();
+    failures += test_usb_hid_demux();
+    failures += test_usb_descriptor_clone();
+    failures += test_usb_hid_merge();
+    failures += test_usb_hid_inject_sched();
+    failures += test_usb_hid_boot();
+    failures += test_usb_hid_events();
+    failures += test_usb_hid_inject_queue();
+    failures += test_hid_codegen();
+    failures += test_usb_hid_pipeline();
+    failures += test_usb_report_pool();
+    failures += test_usb_hid_aggregate();
+    failures += test_usb_hid_kvm();
 
     printf("\n======================================\n");
 
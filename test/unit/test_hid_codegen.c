@@ -0,0 +1,113 @@
+// tests/unit/test_hid_codegen.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "../common/hid_gaming_mouse_reports.h"
+#include "usb/usb_hid_boot.h"
+#include "usb/usb_hid_boot_reports.h"
+#include "usb/usb_hid_decode.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+_Static_assert(HURRICANE_BOOT_KEYBOARD_INPUT_SIZE == 8, "Boot keyboard report is 8 bytes");
+_Static_assert(HURRICANE_BOOT_MOUSE_INPUT_SIZE == 3, "Boot mouse report is 3 bytes");
+
+static uint32_t fnv1a(const uint8_t* data, uint16_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (uint16_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// --- Unit Tests ---
+
+int test_codegen_current(void)
+{
+    uint16_t length = 0;
+    const uint8_t* desc = hurricane_hid_boot_descriptor(HURRICANE_HID_BOOT_KEYBOARD, &length);
+
+    TEST_ASSERT(fnv1a(desc, length) == HURRICANE_BOOT_KEYBOARD_DESCRIPTOR_HASH, "Boot keyboard header is current");
+    desc = hurricane_hid_boot_descriptor(HURRICANE_HID_BOOT_MOUSE, &length);
+    TEST_ASSERT(fnv1a(desc, length) == HURRICANE_BOOT_MOUSE_DESCRIPTOR_HASH, "Boot mouse header is current");
+    TEST_ASSERT_EQUAL_INT(GAMING_MOUSE_DESCRIPTOR_LENGTH, hid_desc_gaming_mouse_size, "Gaming mouse length");
+    TEST_ASSERT(fnv1a(hid_desc_gaming_mouse, hid_desc_gaming_mouse_size) == GAMING_MOUSE_DESCRIPTOR_HASH,
+                "Gaming mouse header is current");
+
+    // The emitted bytes are the descriptor, so arrays built from them match it exactly
+    static const uint8_t gaming_mouse[] = { GAMING_MOUSE_DESCRIPTOR_BYTES };
+    TEST_ASSERT_EQUAL_INT(GAMING_MOUSE_DESCRIPTOR_LENGTH, (int)sizeof(gaming_mouse), "Gaming mouse bytes length");
+    TEST_ASSERT(memcmp(gaming_mouse, hid_desc_gaming_mouse, sizeof(gaming_mouse)) == 0, "Gaming mouse bytes");
+
+    TEST_PASS();
+}
+
+int test_codegen_matches_decoder(void)
+{
+    hurricane_hid_layout_t layout;
+    hurricane_hid_decode_plan_t plan;
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];
+    int32_t value = 0;
+    uint8_t report[GAMING_MOUSE_INPUT1_SIZE];
+    uint8_t keyboard[HURRICANE_BOOT_KEYBOARD_INPUT_SIZE] = { 0 };
+
+    // Report ID, 16 buttons, 16-bit axes: written with the generated setters...
+    memset(report, 0xA5, sizeof(report));
+    report[0] = GAMING_MOUSE_INPUT1_ID;
+    for (int b = 0; b < 16; b++) {
+        hid_codegen_write(report, 8 + b, 1, 0);
+    }
+    gaming_mouse_input1_set_button2(report, 1);
+    gaming_mouse_input1_set_button16(report, 1);
+    gaming_mouse_input1_set_x(report, -1234);
+    gaming_mouse_input1_set_y(report, 32767);
+    gaming_mouse_input1_set_wheel(report, -3);
+    gaming_mouse_input1_set_ac_pan(report, 2);
+
+    // ...read back by the library decoder
+    hurricane_hid_parse_report_descriptor(hid_desc_gaming_mouse, hid_desc_gaming_mouse_size, &layout);
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, GAMING_MOUSE_INPUT1_ID, &plan);
+    TEST_ASSERT_EQUAL_INT(GAMING_MOUSE_INPUT1_SIZE, plan.payload_size + 1, "Report size");
+    hurricane_hid_decode(&plan, &report[1], sizeof(report) - 1, values);
+    hurricane_hid_decode_get_usage(&plan, &layout, values, 0x01, 0x30, &value);
+    TEST_ASSERT_EQUAL_INT(-1234, value, "X");
+    hurricane_hid_decode_get_usage(&plan, &layout, values, 0x01, 0x31, &value);
+    TEST_ASSERT_EQUAL_INT(32767, value, "Y");
+    hurricane_hid_decode_get_usage(&plan, &layout, values, 0x01, 0x38, &value);
+    TEST_ASSERT_EQUAL_INT(-3, value, "Wheel");
+    hurricane_hid_decode_get_usage(&plan, &layout, values, 0x09, 16, &value);
+    TEST_ASSERT_EQUAL_INT(1, value, "Button 16");
+    hurricane_hid_decode_get_usage(&plan, &layout, values, 0x09, 1, &value);
+    TEST_ASSERT_EQUAL_INT(0, value, "Button 1");
+
+    // Getters read what the setters wrote
+    TEST_ASSERT_EQUAL_INT(-1234, gaming_mouse_input1_x(report), "X getter");
+    TEST_ASSERT_EQUAL_INT(1, gaming_mouse_input1_button2(report), "Button 2 getter");
+    TEST_ASSERT_EQUAL_INT(0, gaming_mouse_input1_button3(report), "Button 3 getter");
+    TEST_ASSERT_EQUAL_INT(2, gaming_mouse_input1_ac_pan(report), "AC Pan getter");
+
+    // Boot keyboard: modifier bits and the key array
+    hurricane_boot_keyboard_input_set_left_shift(keyboard, 1);
+    hurricane_boot_keyboard_input_set_keys(keyboard, 0, 0x04);
+    hurricane_boot_keyboard_input_set_keys(keyboard, 6, 0x05);
+    TEST_ASSERT_EQUAL_INT(0x02, keyboard[0], "Left Shift is bit 1");
+    TEST_ASSERT_EQUAL_INT(0x04, keyboard[2], "First key after the reserved byte");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_boot_keyboard_input_keys(keyboard, 6), "Index past the array ignored");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_hid_codegen(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_codegen_current);
+    RUN_TEST(test_codegen_matches_decoder);
+
+    return failures;
+}
@@ -0,0 +1,96 @@
+// tests/unit/test_hurricane_context.c
+
+#include "../common/test_common.h"
+#include "core/hurricane_context.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_context_t ctx_a;
+static hurricane_context_t ctx_b;
+
+// --- Unit Tests ---
+
+int test_context_control_queues_are_independent(void)
+{
+    hurricane_control_request_t request = {0};
+
+    hurricane_context_init(&ctx_a, HURRICANE_HW_PRIMARY_CONTROLLER, HURRICANE_HW_PRIMARY_CONTROLLER);
+    hurricane_context_init(&ctx_b, HURRICANE_HW_PRIMARY_CONTROLLER, HURRICANE_HW_PRIMARY_CONTROLLER);
+
+    hurricane_host_control_prepare(&request, 0x80, 0x06, 0x0100, 0, NULL, 0);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_host_control_submit_ctx(&ctx_a, &request), "Submit should succeed");
+
+    hurricane_host_control_task_ctx(&ctx_b);
+    hurricane_host_control_task();
+    TEST_ASSERT(hurricane_host_control_pending(&request), "Other contexts must not run the request");
+
+    hurricane_host_control_task_ctx(&ctx_a);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_CONTROL_DONE, request.status, "Owning context should complete the request");
+
+    TEST_PASS();
+}
+
+int test_context_interface_registries_are_independent(void)
+{
+    hurricane_interface_descriptor_t desc = {
+        .interface_num = 1,
+        .interface_class = 3,
+        .num_endpoints = 1,
+    };
+
+    hurricane_context_init(&ctx_a, HURRICANE_HW_PRIMARY_CONTROLLER, HURRICANE_HW_PRIMARY_CONTROLLER);
+    hurricane_context_init(&ctx_b, HURRICANE_HW_PRIMARY_CONTROLLER, HURRICANE_HW_PRIMARY_CONTROLLER);
+    hurricane_interface_manager_init_ctx(&ctx_a);
+    hurricane_interface_manager_init_ctx(&ctx_b);
+
+    TEST_ASSERT_EQUAL_INT(0, hurricane_add_device_interface_ctx(&ctx_a, 1, 3, 0, 0, &desc),
+                          "Interface should be added to context A");
+    TEST_ASSERT(hurricane_get_device_interface_ctx(&ctx_a, 1, NULL), "Context A should see its interface");
+    TEST_ASSERT(!hurricane_get_device_interface_ctx(&ctx_b, 1, NULL), "Context B must not see it");
+
+    // The same interface number is free in the other context
+    TEST_ASSERT_EQUAL_INT(0, hurricane_add_device_interface_ctx(&ctx_b, 1, 3, 0, 0, &desc),
+                          "Context B should accept its own interface 1");
+
+    hurricane_interface_manager_deinit_ctx(&ctx_a);
+    hurricane_interface_manager_deinit_ctx(&ctx_b);
+    hurricane_context_deinit(&ctx_a);
+    hurricane_context_deinit(&ctx_b);
+
+    TEST_PASS();
+}
+
+int test_context_device_tables_are_independent(void)
+{
+    hurricane_context_init(&ctx_a, HURRICANE_HW_PRIMARY_CONTROLLER, HURRICANE_HW_PRIMARY_CONTROLLER);
+    hurricane_context_init(&ctx_b, HURRICANE_HW_PRIMARY_CONTROLLER, HURRICANE_HW_PRIMARY_CONTROLLER);
+
+    // The dummy HAL always reports a connected device
+    hurricane_task_ctx(&ctx_a);
+
+    hurricane_device_t* dev = hurricane_get_device_ctx(&ctx_a, 0);
+    TEST_ASSERT(dev != NULL, "Context A should have picked up the device");
+    TEST_ASSERT(hurricane_device_context(dev) == &ctx_a, "Device should point back at its context");
+    TEST_ASSERT(hurricane_get_device_ctx(&ctx_b, 0) == NULL, "Context B has not polled yet");
+
+    hurricane_device_t loose = {0};
+    TEST_ASSERT(hurricane_device_context(&loose) == hurricane_default_context(),
+                "Devices outside a context table belong to the default context");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_hurricane_context(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_context_control_queues_are_independent);
+    RUN_TEST(test_context_interface_registries_are_independent);
+    RUN_TEST(test_context_device_tables_are_independent);
+
+    return failures;
+}
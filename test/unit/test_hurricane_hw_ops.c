@@ -0,0 +1,198 @@
+// tests/unit/test_hurricane_hw_ops.c
+
+#include "../common/test_common.h"
+#include "hw/hurricane_hw_ops.h"
+#include "core/usb_host_control_queue.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Defined in the dummy HAL
+extern hurricane_usb_setup_packet_t last_setup_sent;
+extern int hw_poll_count;
+
+#ifndef HURRICANE_HW_SINGLE_CONTROLLER
+
+// Minimal controller that only records what it was asked to do
+typedef struct {
+    int control_transfers;
+    uint8_t last_request;
+    int interrupt_in_transfers;
+    int polls;
+} fake_controller_t;
+
+static void fake_poll(void* priv)
+{
+    ((fake_controller_t*)priv)->polls++;
+}
+
+// Primary instance wrapping the link-time HAL, like the board ops tables
+static void link_hal_poll(void* priv)
+{
+    (void)priv;
+    hurricane_hw_poll();
+}
+
+static int fake_control_transfer(void* priv, const hurricane_usb_setup_packet_t* setup,
+                                 void* buffer, uint16_t length)
+{
+    fake_controller_t* fake = (fake_controller_t*)priv;
+    (void)buffer;
+    fake->control_transfers++;
+    fake->last_request = setup->bRequest;
+    return length;
+}
+
+static int fake_interrupt_in_transfer(void* priv, uint8_t endpoint, void* buffer, uint16_t length)
+{
+    fake_controller_t* fake = (fake_controller_t*)priv;
+    (void)endpoint;
+    memset(buffer, 0xA5, length);
+    fake->interrupt_in_transfers++;
+    return length;
+}
+
+// Host-only: every other entry is left NULL
+static const hurricane_hw_ops_t fake_ops = {
+    .host_control_transfer = fake_control_transfer,
+    .host_interrupt_in_transfer = fake_interrupt_in_transfer,
+};
+
+static const hurricane_hw_ops_t polled_ops = { .poll = fake_poll };
+static const hurricane_hw_ops_t link_hal_ops = { .poll = link_hal_poll };
+
+// --- Unit Tests ---
+
+int test_hw_ops_dispatch_per_instance(void)
+{
+    fake_controller_t first = {0};
+    fake_controller_t second = {0};
+    hurricane_usb_setup_packet_t setup = { .bmRequestType = 0x80, .bRequest = 0x06, .wLength = 4 };
+    uint8_t buffer[4];
+
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hw_register_controller(1, "fake-1", &fake_ops, &first),
+                          "Registration should succeed");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hw_register_controller(2, "fake-2", &fake_ops, &second),
+                          "Second instance should register");
+    TEST_ASSERT(hurricane_hw_register_controller(2, "dup", &fake_ops, &second) < 0,
+                "An instance cannot be registered twice");
+
+    hurricane_hw_host_control_transfer_on(2, &setup, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_INT(0, first.control_transfers, "Other instances must not see the transfer");
+    TEST_ASSERT_EQUAL_INT(1, second.control_transfers, "Transfer should reach its own controller");
+
+    TEST_ASSERT_EQUAL_INT(4, hurricane_hw_host_interrupt_in_transfer_on(1, 0x81, buffer, sizeof(buffer)),
+                          "Interrupt IN should be dispatched");
+    TEST_ASSERT_EQUAL_INT(0xA5, buffer[0], "Data should come from the registered controller");
+    TEST_ASSERT_EQUAL_INT(1, first.interrupt_in_transfers, "Interrupt IN should hit instance 1");
+
+    TEST_ASSERT(hurricane_hw_device_endpoint_stall_on(1, 0x80, true) < 0,
+                "Missing operations should fail instead of crashing");
+
+    hurricane_hw_unregister_controller(1);
+    hurricane_hw_unregister_controller(2);
+    TEST_PASS();
+}
+
+int test_hw_ops_primary_falls_back_to_link_hal(void)
+{
+    hurricane_usb_setup_packet_t setup = { .bmRequestType = 0x80, .bRequest = 0x06, .wValue = 0x0100, .wLength = 18 };
+    uint8_t buffer[18];
+
+    memset(&last_setup_sent, 0, sizeof(last_setup_sent));
+    hurricane_hw_host_control_transfer_on(HURRICANE_HW_PRIMARY_CONTROLLER, &setup, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_INT(0x0100, last_setup_sent.wValue, "Unregistered primary should use the link-time HAL");
+
+    TEST_ASSERT(hurricane_hw_host_control_transfer_on(3, &setup, buffer, sizeof(buffer)) < 0,
+                "Unregistered secondary instance should fail");
+    TEST_ASSERT(hurricane_hw_get_controller(3) == NULL, "Unregistered instance has no controller");
+
+    TEST_PASS();
+}
+
+int test_hw_ops_control_queue_uses_request_controller(void)
+{
+    fake_controller_t fake = {0};
+    hurricane_control_request_t request = {0};
+    uint8_t buffer[8];
+
+    hurricane_hw_register_controller(1, "fake", &fake_ops, &fake);
+    hurricane_host_control_cancel_all();
+
+    hurricane_host_control_prepare(&request, 0xA1, 0x01, 0x0100, 0, buffer, sizeof(buffer));
+    request.controller = 1;
+    TEST_ASSERT_EQUAL_INT(0, hurricane_host_control_submit(&request), "Submit should succeed");
+    hurricane_host_control_task();
+
+    TEST_ASSERT_EQUAL_INT(1, fake.control_transfers, "Queued request should run on its controller");
+    TEST_ASSERT_EQUAL_INT(0x01, fake.last_request, "Controller should see the queued request");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_CONTROL_DONE, request.status, "Request should complete");
+
+    hurricane_hw_unregister_controller(1);
+    TEST_PASS();
+}
+
+int test_hw_ops_poll_each_instance_once(void)
+{
+    fake_controller_t second = {0};
+
+    hurricane_hw_register_controller(1, "polled", &polled_ops, &second);
+
+    hw_poll_count = 0;
+    hurricane_hw_controllers_poll();
+    TEST_ASSERT_EQUAL_INT(1, hw_poll_count, "Unregistered primary polls the link-time HAL once");
+    TEST_ASSERT_EQUAL_INT(1, second.polls, "Registered instance polled once");
+
+    // A registered primary replaces the link-time HAL, it does not add to it
+    hurricane_hw_register_controller(HURRICANE_HW_PRIMARY_CONTROLLER, "primary", &link_hal_ops, NULL);
+    hw_poll_count = 0;
+    hurricane_hw_controllers_poll();
+    TEST_ASSERT_EQUAL_INT(1, hw_poll_count, "Registered primary polled once");
+    TEST_ASSERT_EQUAL_INT(2, second.polls, "Registered instance polled once more");
+
+    hurricane_hw_unregister_controller(HURRICANE_HW_PRIMARY_CONTROLLER);
+    hurricane_hw_unregister_controller(1);
+    TEST_PASS();
+}
+
+#else
+
+int test_hw_ops_single_controller(void)
+{
+    hurricane_usb_setup_packet_t setup = { .bmRequestType = 0x80, .bRequest = 0x06, .wValue = 0x0200, .wLength = 9 };
+    uint8_t buffer[9];
+
+    TEST_ASSERT(hurricane_hw_register_controller(1, "fake", NULL, NULL) < 0, "No registry to register into");
+    TEST_ASSERT(hurricane_hw_get_controller(HURRICANE_HW_PRIMARY_CONTROLLER) == NULL, "Nothing registered");
+
+    memset(&last_setup_sent, 0, sizeof(last_setup_sent));
+    hurricane_hw_host_control_transfer_on(HURRICANE_HW_PRIMARY_CONTROLLER, &setup, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_INT(0x0200, last_setup_sent.wValue, "Calls go straight to the link-time HAL");
+
+    hw_poll_count = 0;
+    hurricane_hw_controllers_poll();
+    TEST_ASSERT_EQUAL_INT(1, hw_poll_count, "Link-time HAL polled once");
+
+    TEST_PASS();
+}
+
+#endif // HURRICANE_HW_SINGLE_CONTROLLER
+
+// --- Test suite runner ---
+
+int test_hurricane_hw_ops(void)
+{
+    int failures = 0;
+
+#ifndef HURRICANE_HW_SINGLE_CONTROLLER
+    RUN_TEST(test_hw_ops_dispatch_per_instance);
+    RUN_TEST(test_hw_ops_primary_falls_back_to_link_hal);
+    RUN_TEST(test_hw_ops_control_queue_uses_request_controller);
+    RUN_TEST(test_hw_ops_poll_each_instance_once);
+#else
+    RUN_TEST(test_hw_ops_single_controller);
+#endif
+
+    return failures;
+}
@@ -0,0 +1,142 @@
+// tests/unit/test_usb_descriptor_clone.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "core/usb_descriptor_clone.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_descriptor_clone_t clone;
+
+// High speed USB 2.01 device, VID:PID 1234:5678
+static const uint8_t device_desc[] = {
+    0x12, 0x01, 0x01, 0x02, 0x00, 0x00, 0x00, 0x40,
+    0x34, 0x12, 0x78, 0x56, 0x00, 0x01, 0x01, 0x02, 0x00, 0x01
+};
+
+// Keyboard on interface 0, vendor HID with two alternate settings on interface 1
+static const uint8_t config_desc[] = {
+    0x09, 0x02, 0x52, 0x00, 0x02, 0x01, 0x00, 0xA0, 0x32,
+    0x09, 0x04, 0x00, 0x00, 0x01, 0x03, 0x01, 0x01, 0x00,
+    0x09, 0x21, 0x11, 0x01, 0x00, 0x01, 0x22, 0x3F, 0x00,
+    0x07, 0x05, 0x81, 0x03, 0x08, 0x00, 0x04,   // EP1 IN, 8 bytes, 1 ms
+    0x09, 0x04, 0x01, 0x00, 0x02, 0x03, 0x00, 0x00, 0x00,
+    0x09, 0x21, 0x11, 0x01, 0x00, 0x01, 0x22, 0x20, 0x00,
+    0x07, 0x05, 0x85, 0x03, 0x00, 0x04, 0x07,   // EP5 IN, 1024 bytes, 8 ms
+    0x07, 0x05, 0x05, 0x03, 0x08, 0x08, 0x01,   // EP5 OUT, 2 x 8 bytes per microframe
+    0x09, 0x04, 0x01, 0x01, 0x01, 0x03, 0x00, 0x00, 0x00,
+    0x07, 0x05, 0x85, 0x03, 0x40, 0x00, 0x07    // EP5 IN again in alternate setting 1
+};
+
+static const hurricane_clone_caps_t full_speed = {
+    .num_endpoints = 3,
+    .shared_numbers = true,
+    .high_speed = false,
+    .max_packet_size = 64,
+    .max_packet_size0 = 64
+};
+
+// --- Unit Tests ---
+
+int test_clone_remaps_endpoints(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, hurricane_descriptor_clone_build(&clone, device_desc, config_desc,
+                                                              sizeof(config_desc), &full_speed, true),
+                          "Configuration should clone");
+
+    const uint8_t* cfg = clone.config_descriptor;
+    TEST_ASSERT_EQUAL_INT((int)sizeof(config_desc), clone.config_length, "Whole configuration is cloned");
+    TEST_ASSERT_EQUAL_INT(3, clone.num_endpoints, "Alternate settings share endpoints");
+    TEST_ASSERT_EQUAL_INT(0x00, clone.device_descriptor[2], "bcdUSB capped at 2.00");
+    TEST_ASSERT_EQUAL_INT(0x02, clone.device_descriptor[3], "bcdUSB capped at 2.00");
+    TEST_ASSERT(memcmp(&clone.device_descriptor[8], &device_desc[8], 10) == 0, "IDs and strings are kept");
+
+    // EP1 IN keeps its number and 1 ms interval
+    TEST_ASSERT_EQUAL_INT(0x81, cfg[29], "EP1 IN keeps its address");
+    TEST_ASSERT_EQUAL_INT(1, cfg[33], "125 us x 2^3 = 1 ms");
+
+    // EP5 does not exist on the controller
+    TEST_ASSERT_EQUAL_INT(0x82, cfg[54], "EP5 IN moves to the first free IN number");
+    TEST_ASSERT_EQUAL_INT(64, cfg[56] | (cfg[57] << 8), "1024 byte packets clamp to 64");
+    TEST_ASSERT_EQUAL_INT(8, cfg[58], "125 us x 2^6 = 8 ms");
+    TEST_ASSERT_EQUAL_INT(0x01, cfg[61], "EP5 OUT shares number 1 with EP1 IN");
+    TEST_ASSERT_EQUAL_INT(8, cfg[63] | (cfg[64] << 8), "High-bandwidth bits are dropped");
+    TEST_ASSERT_EQUAL_INT(0x82, cfg[77], "Alternate setting uses the same mapping");
+
+    TEST_ASSERT_EQUAL_INT(0x82, hurricane_descriptor_clone_device_endpoint(&clone, 0x85), "Forward mapping");
+    TEST_ASSERT_EQUAL_INT(0x05, hurricane_descriptor_clone_host_endpoint(&clone, 0x01), "Reverse mapping");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_descriptor_clone_device_endpoint(&clone, 0x83), "Unknown endpoint");
+
+    // Without shared numbers EP5 OUT needs a number of its own
+    hurricane_clone_caps_t caps = full_speed;
+    caps.shared_numbers = false;
+    hurricane_descriptor_clone_build(&clone, device_desc, config_desc, sizeof(config_desc), &caps, true);
+    TEST_ASSERT_EQUAL_INT(0x03, hurricane_descriptor_clone_device_endpoint(&clone, 0x05), "OUT gets number 3");
+
+    caps.num_endpoints = 2;
+    TEST_ASSERT_EQUAL_INT(HURRICANE_CLONE_ERR_NO_ENDPOINTS,
+                          hurricane_descriptor_clone_build(&clone, device_desc, config_desc, sizeof(config_desc),
+                                                           &caps, true),
+                          "Two endpoint numbers are not enough");
+
+    TEST_ASSERT_EQUAL_INT(HURRICANE_CLONE_ERR_MALFORMED,
+                          hurricane_descriptor_clone_build(&clone, device_desc, config_desc, 40, &full_speed, true),
+                          "Truncated configuration is rejected");
+
+    TEST_PASS();
+}
+
+int test_clone_descriptor_set(void)
+{
+    const uint8_t product[] = { 0x0A, 0x03, 'K', 0, 'e', 0, 'y', 0, 's', 0 };
+    uint16_t length = 0;
+
+    hurricane_descriptor_clone_build(&clone, device_desc, config_desc, sizeof(config_desc), &full_speed, true);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_descriptor_clone_add_report(&clone, 0, hid_desc_boot_keyboard,
+                                                                   hid_desc_boot_keyboard_size),
+                          "Keyboard report descriptor");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_descriptor_clone_add_report(&clone, 1, hid_desc_gaming_mouse,
+                                                                   hid_desc_gaming_mouse_size),
+                          "Second report descriptor");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_descriptor_clone_add_string(&clone, 2, product, sizeof(product)),
+                          "Product string");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_CLONE_ERR_INVALID_ARG,
+                          hurricane_descriptor_clone_add_string(&clone, MAX_STRING_DESCRIPTORS, product, sizeof(product)),
+                          "String index out of range");
+
+    hurricane_device_descriptors_t* set = hurricane_descriptor_clone_descriptors(&clone);
+    TEST_ASSERT(set->device_descriptor == clone.device_descriptor, "Device descriptor");
+    TEST_ASSERT_EQUAL_INT((int)sizeof(config_desc), set->config_descriptor_length, "Configuration length");
+    TEST_ASSERT_EQUAL_INT(hid_desc_boot_keyboard_size, set->hid_report_descriptor_length,
+                          "First report descriptor is the default one");
+    TEST_ASSERT_EQUAL_INT((int)sizeof(product), set->string_descriptor_lengths[2], "String is served locally");
+    TEST_ASSERT(set->string_descriptors[1] == NULL, "Strings not added are left to the EP0 proxy");
+
+    const uint8_t* report = hurricane_descriptor_clone_report(&clone, 1, &length);
+    TEST_ASSERT(report != NULL, "Per interface report descriptor");
+    TEST_ASSERT_EQUAL_INT(hid_desc_gaming_mouse_size, length, "Report descriptor length");
+    TEST_ASSERT(memcmp(report, hid_desc_gaming_mouse, length) == 0, "Report descriptor is a verbatim copy");
+
+    // The HID class descriptors announce the descriptors actually served
+    const uint8_t* cfg = clone.config_descriptor;
+    TEST_ASSERT_EQUAL_INT(hid_desc_boot_keyboard_size, cfg[25] | (cfg[26] << 8), "Interface 0 wDescriptorLength");
+    TEST_ASSERT_EQUAL_INT(hid_desc_gaming_mouse_size, cfg[50] | (cfg[51] << 8), "Interface 1 wDescriptorLength");
+    TEST_ASSERT_EQUAL_INT(0x3F, config_desc[25], "Source configuration untouched");
+    TEST_ASSERT(hurricane_descriptor_clone_report(&clone, 2, &length) == NULL, "No such interface");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_descriptor_clone(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_clone_remaps_endpoints);
+    RUN_TEST(test_clone_descriptor_set);
+
+    return failures;
+}
@@ -0,0 +1,185 @@
+// tests/unit/test_usb_ep0_proxy.c
+
+#include "../common/test_common.h"
+#include "core/usb_ep0_proxy.h"
+#include "core/usb_host_control_queue.h"
+#include "core/hurricane_context.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Defined in the dummy HAL
+extern hurricane_usb_setup_packet_t last_setup_sent;
+extern uint8_t last_control_data_sent[64];
+extern hurricane_usb_setup_packet_t last_device_response_setup;
+extern uint8_t last_device_response_data[64];
+extern uint16_t last_device_response_length;
+extern int device_response_count;
+
+static hurricane_usb_setup_packet_t make_setup(uint8_t bmRequestType, uint8_t bRequest,
+                                               uint16_t wValue, uint16_t wIndex, uint16_t wLength)
+{
+    hurricane_usb_setup_packet_t setup = {
+        .bmRequestType = bmRequestType,
+        .bRequest = bRequest,
+        .wValue = wValue,
+        .wIndex = wIndex,
+        .wLength = wLength
+    };
+    return setup;
+}
+
+// --- Unit Tests ---
+
+int test_ep0_proxy_disabled_by_default(void)
+{
+    hurricane_ep0_proxy_init();
+
+    hurricane_usb_setup_packet_t setup = make_setup(0xC0, 0x42, 0, 0, 8);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_EP0_PROXY_NOT_HANDLED,
+                          hurricane_ep0_proxy_setup(&setup, NULL, 0),
+                          "Disabled proxy should not claim requests");
+
+    TEST_PASS();
+}
+
+int test_ep0_proxy_forwards_and_caches_descriptor(void)
+{
+    hurricane_ep0_proxy_init();
+    hurricane_ep0_proxy_enable(true);
+    device_response_count = 0;
+
+    // GET_DESCRIPTOR(Device) - the dummy host HAL answers with 18 bytes
+    hurricane_usb_setup_packet_t setup = make_setup(0x80, 0x06, 0x0100, 0, 18);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_EP0_PROXY_PENDING,
+                          hurricane_ep0_proxy_setup(&setup, NULL, 0),
+                          "Uncached request should be pending");
+    TEST_ASSERT_EQUAL_INT(0, device_response_count, "Device side must NAK until the reply arrives");
+
+    hurricane_ep0_proxy_task();
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(0x0100, last_setup_sent.wValue, "Request should be replayed on the host side");
+    TEST_ASSERT_EQUAL_INT(1, device_response_count, "Reply should complete the device-side data stage");
+    TEST_ASSERT_EQUAL_INT(18, last_device_response_length, "Full descriptor should be returned");
+    TEST_ASSERT_EQUAL_INT(0x12, last_device_response_data[0], "Descriptor bytes should come from the device");
+
+    // A shorter request for the same descriptor is served from the cache at once
+    setup.wLength = 8;
+    TEST_ASSERT_EQUAL_INT(HURRICANE_EP0_PROXY_COMPLETED,
+                          hurricane_ep0_proxy_setup(&setup, NULL, 0),
+                          "Repeated descriptor request should hit the cache");
+    TEST_ASSERT_EQUAL_INT(2, device_response_count, "Cache hit should respond immediately");
+    TEST_ASSERT_EQUAL_INT(8, last_device_response_length, "Cache hit should honour wLength");
+
+    hurricane_ep0_proxy_invalidate();
+    setup.wLength = 18;
+    TEST_ASSERT_EQUAL_INT(HURRICANE_EP0_PROXY_PENDING,
+                          hurricane_ep0_proxy_setup(&setup, NULL, 0),
+                          "Invalidated cache should forward again");
+    hurricane_ep0_proxy_task();
+    hurricane_host_control_task();
+
+    TEST_PASS();
+}
+
+int test_ep0_proxy_skips_entry_being_rewritten(void)
+{
+    hurricane_ep0_proxy_t* proxy = &hurricane_default_context()->ep0_proxy;
+
+    hurricane_ep0_proxy_init();
+    hurricane_ep0_proxy_enable(true);
+    device_response_count = 0;
+
+    hurricane_usb_setup_packet_t setup = make_setup(0x80, 0x06, 0x0100, 0, 18);
+    hurricane_ep0_proxy_setup(&setup, NULL, 0);
+    hurricane_ep0_proxy_task();
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(0, atomic_load(&proxy->cache[0].sequence) & 1, "Entry complete");
+
+    // The ISR lands while the main loop is halfway through rewriting the entry
+    atomic_fetch_add(&proxy->cache[0].sequence, 1);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_EP0_PROXY_PENDING,
+                          hurricane_ep0_proxy_setup(&setup, NULL, 0),
+                          "Torn entry is not served");
+    TEST_ASSERT_EQUAL_INT(1, device_response_count, "Nothing sent from the cache");
+    atomic_fetch_add(&proxy->cache[0].sequence, 1);
+
+    hurricane_ep0_proxy_task();
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(2, device_response_count, "Forwarded instead");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_EP0_PROXY_COMPLETED,
+                          hurricane_ep0_proxy_setup(&setup, NULL, 0),
+                          "Served once whole again");
+    TEST_ASSERT_EQUAL_INT(0x12, last_device_response_data[0], "Cached descriptor");
+
+    TEST_PASS();
+}
+
+int test_ep0_proxy_drops_superseded_reply(void)
+{
+    hurricane_ep0_proxy_init();
+    hurricane_ep0_proxy_enable(true);
+    device_response_count = 0;
+
+    // Vendor IN request is forwarded but not cached
+    hurricane_usb_setup_packet_t first = make_setup(0xC0, 0x42, 1, 0, 4);
+    hurricane_ep0_proxy_setup(&first, NULL, 0);
+    hurricane_ep0_proxy_task();
+
+    // The PC times out and issues another SETUP before the first completed
+    hurricane_usb_setup_packet_t second = make_setup(0xC0, 0x43, 2, 0, 4);
+    hurricane_ep0_proxy_setup(&second, NULL, 0);
+
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(0, device_response_count, "Stale reply must not reach the PC");
+
+    hurricane_ep0_proxy_task();
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(1, device_response_count, "Newest request should be answered");
+    TEST_ASSERT_EQUAL_INT(0x43, last_device_response_setup.bRequest, "Reply should belong to the newest SETUP");
+
+    hurricane_ep0_proxy_stats_t stats;
+    hurricane_ep0_proxy_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, (int)stats.superseded, "Superseded reply should be counted");
+
+    TEST_PASS();
+}
+
+int test_ep0_proxy_out_request_status_stage(void)
+{
+    hurricane_ep0_proxy_init();
+    hurricane_ep0_proxy_enable(true);
+    device_response_count = 0;
+
+    // SET_REPORT(Feature, ID 2) with its data stage already received
+    uint8_t feature[3] = {0x02, 0xAA, 0x55};
+    hurricane_usb_setup_packet_t setup = make_setup(0x21, 0x09, 0x0302, 0, sizeof(feature));
+    TEST_ASSERT_EQUAL_INT(HURRICANE_EP0_PROXY_PENDING,
+                          hurricane_ep0_proxy_setup(&setup, feature, sizeof(feature)),
+                          "OUT request with data should be forwarded");
+
+    hurricane_ep0_proxy_task();
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(0xAA, last_control_data_sent[1], "OUT data should reach the physical device");
+    TEST_ASSERT_EQUAL_INT(1, device_response_count, "Status stage should be completed");
+    TEST_ASSERT_EQUAL_INT(0, last_device_response_length, "Status stage is zero length");
+    TEST_ASSERT(last_device_response_setup.bmRequestType & 0x80, "Status stage of an OUT request is IN");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_ep0_proxy(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_ep0_proxy_disabled_by_default);
+    RUN_TEST(test_ep0_proxy_forwards_and_caches_descriptor);
+    RUN_TEST(test_ep0_proxy_skips_entry_being_rewritten);
+    RUN_TEST(test_ep0_proxy_drops_superseded_reply);
+    RUN_TEST(test_ep0_proxy_out_request_status_stage);
+
+    return failures;
+}
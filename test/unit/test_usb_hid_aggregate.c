@@ -0,0 +1,122 @@
+// tests/unit/test_usb_hid_aggregate.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "../common/hid_gaming_mouse_reports.h"
+#include "usb/usb_hid_aggregate.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Defined in the dummy HAL
+extern uint8_t last_interrupt_in_endpoint;
+extern uint8_t last_interrupt_in_data[65];
+extern uint16_t last_interrupt_in_length;
+extern int interrupt_in_count;
+
+static hurricane_hid_aggregate_t aggregate;
+
+static bool sent(uint8_t endpoint, const uint8_t* expected, uint16_t length)
+{
+    return last_interrupt_in_endpoint == endpoint && last_interrupt_in_length == length &&
+           memcmp(last_interrupt_in_data, expected, length) == 0;
+}
+
+// --- Unit Tests ---
+
+int test_aggregate_two_mice(void)
+{
+    hurricane_hid_pipe_config_t pipe = {
+        .source_page = 0x01, .source_usage = 0x02, .sink_endpoint = 0x81,
+        .sink_descriptor = hid_desc_boot_mouse, .sink_descriptor_length = hid_desc_boot_mouse_size
+    };
+    hurricane_hid_pipeline_config_t persona = { .pipes = &pipe, .num_pipes = 1 };
+    uint8_t a[GAMING_MOUSE_INPUT1_SIZE] = { GAMING_MOUSE_INPUT1_ID };
+    uint8_t b[GAMING_MOUSE_INPUT1_SIZE] = { GAMING_MOUSE_INPUT1_ID };
+
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_aggregate_init(&aggregate, &persona), "Init");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_aggregate_attach(&aggregate, 0, hid_desc_gaming_mouse,
+                                                            hid_desc_gaming_mouse_size), "Mouse A");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_aggregate_attach(&aggregate, 1, hid_desc_gaming_mouse,
+                                                            hid_desc_gaming_mouse_size), "Mouse B");
+    TEST_ASSERT(aggregate.sources[1].merges[0].layout == &aggregate.persona.pipes[0].sink_layout &&
+                aggregate.sources[1].merges[0].plan == &aggregate.persona.pipes[0].pack,
+                "Sources share the persona's sink layout and pack plan");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PIPELINE_ERR_INVALID_ARG,
+                          hurricane_hid_aggregate_submit(&aggregate, HURRICANE_HID_AGGREGATE_MAX_SOURCES, a, sizeof(a)),
+                          "No such source");
+
+    // Several reports from both mice within one frame become one report
+    gaming_mouse_input1_set_button1(a, 1);
+    gaming_mouse_input1_set_x(a, 5);
+    gaming_mouse_input1_set_button2(b, 1);
+    gaming_mouse_input1_set_x(b, 3);
+    gaming_mouse_input1_set_y(b, -2);
+    interrupt_in_count = 0;
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_aggregate_submit(&aggregate, 0, a, sizeof(a)), "Pipe 0");
+    hurricane_hid_aggregate_submit(&aggregate, 0, a, sizeof(a));
+    hurricane_hid_aggregate_submit(&aggregate, 1, b, sizeof(b));
+    TEST_ASSERT_EQUAL_INT(0, interrupt_in_count, "Nothing sent between frames");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_aggregate_run(&aggregate, 1), "One report per frame");
+    TEST_ASSERT(sent(0x81, (const uint8_t[]){ 0x03, 13, 0xFE }, 3), "Buttons combined, motion summed");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_aggregate_run(&aggregate, 2), "Nothing new");
+
+    // Motion beyond the persona's range is carried, not clipped
+    gaming_mouse_input1_set_x(a, 100);
+    gaming_mouse_input1_set_x(b, 100);
+    gaming_mouse_input1_set_y(b, 0);
+    hurricane_hid_aggregate_submit(&aggregate, 0, a, sizeof(a));
+    hurricane_hid_aggregate_submit(&aggregate, 1, b, sizeof(b));
+    hurricane_hid_aggregate_run(&aggregate, 3);
+    TEST_ASSERT(sent(0x81, (const uint8_t[]){ 0x03, 127, 0 }, 3), "First part");
+    hurricane_hid_aggregate_run(&aggregate, 4);
+    TEST_ASSERT(sent(0x81, (const uint8_t[]){ 0x03, 73, 0 }, 3), "Rest");
+
+    // Unplugging A releases its button only
+    hurricane_hid_aggregate_detach(&aggregate, 0);
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_aggregate_run(&aggregate, 5), "Release sent");
+    TEST_ASSERT(sent(0x81, (const uint8_t[]){ 0x02, 0, 0 }, 3), "B still holds its button");
+
+    TEST_PASS();
+}
+
+int test_aggregate_keyboards(void)
+{
+    hurricane_hid_pipe_config_t pipe = {
+        .source_page = 0x01, .source_usage = 0x06, .sink_endpoint = 0x82,
+        .sink_descriptor = hid_desc_boot_keyboard, .sink_descriptor_length = hid_desc_boot_keyboard_size
+    };
+    hurricane_hid_pipeline_config_t persona = { .pipes = &pipe, .num_pipes = 1 };
+    const uint8_t keyboard[8] = { 0x00, 0, 0x04 };
+    const uint8_t pad[8] = { 0x02, 0, 0x05, 0x04 };
+
+    hurricane_hid_aggregate_init(&aggregate, &persona);
+    hurricane_hid_aggregate_attach(&aggregate, 0, hid_desc_boot_keyboard, hid_desc_boot_keyboard_size);
+    hurricane_hid_aggregate_attach(&aggregate, 2, hid_desc_boot_keyboard, hid_desc_boot_keyboard_size);
+
+    // Keys of both devices in one report, each key once
+    hurricane_hid_aggregate_submit(&aggregate, 0, keyboard, sizeof(keyboard));
+    hurricane_hid_aggregate_submit(&aggregate, 2, pad, sizeof(pad));
+    hurricane_hid_aggregate_run(&aggregate, 1);
+    TEST_ASSERT(sent(0x82, (const uint8_t[]){ 0x02, 0, 0x04, 0x05, 0, 0, 0, 0 }, 8), "Key union");
+
+    // Injected keys join through the persona's merge
+    hurricane_hid_merge_inject(&aggregate.persona.merges[0], 0x07, 0x06, 1);
+    hurricane_hid_aggregate_run(&aggregate, 2);
+    TEST_ASSERT(sent(0x82, (const uint8_t[]){ 0x02, 0, 0x04, 0x05, 0x06, 0, 0, 0 }, 8), "Injected C");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_aggregate(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_aggregate_two_mice);
+    RUN_TEST(test_aggregate_keyboards);
+
+    return failures;
+}
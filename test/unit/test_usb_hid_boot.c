@@ -0,0 +1,174 @@
+// tests/unit/test_usb_hid_boot.c
+
+#include "../common/test_common.h"
+#include "usb/usb_hid_boot.h"
+#include "usb/usb_hid.h"
+#include "core/hurricane_context.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Defined in the dummy HAL
+extern hurricane_usb_setup_packet_t last_setup_sent;
+
+static bool plan_is_fixed_offset(const hurricane_hid_decode_plan_t* plan)
+{
+    for (uint8_t i = 0; i < plan->num_ops; i++) {
+        if (plan->ops[i].kind == HURRICANE_HID_DECODE_BITS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- Unit Tests ---
+
+int test_hid_boot_layouts(void)
+{
+    hurricane_hid_decode_plan_t plan;
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];
+    int32_t value = 0;
+    uint16_t length = 0;
+    const uint8_t mouse_report[] = { 0x05, 0x10, 0xF0 };
+
+    TEST_ASSERT(hurricane_hid_boot_descriptor(HURRICANE_HID_BOOT_MOUSE, &length) != NULL, "Boot mouse descriptor");
+    TEST_ASSERT(length > 0, "Descriptor length");
+    TEST_ASSERT(hurricane_hid_boot_descriptor(HURRICANE_HID_BOOT_NONE, &length) == NULL, "No boot descriptor");
+    TEST_ASSERT(hurricane_hid_boot_layout(3) == NULL, "No boot layout");
+
+    const hurricane_hid_layout_t* keyboard = hurricane_hid_boot_layout(HURRICANE_HID_BOOT_KEYBOARD);
+    TEST_ASSERT(keyboard != NULL, "Boot keyboard layout");
+    TEST_ASSERT(keyboard == hurricane_hid_boot_layout(HURRICANE_HID_BOOT_KEYBOARD), "One shared layout");
+    TEST_ASSERT(!keyboard->uses_report_ids, "Boot reports have no ID");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_decode_plan_build(keyboard, HURRICANE_HID_REPORT_INPUT, 0, &plan),
+                          "Keyboard decode plan");
+    TEST_ASSERT_EQUAL_INT(8, plan.payload_size, "8 byte keyboard report");
+    TEST_ASSERT(plan_is_fixed_offset(&plan), "Keyboard decodes at fixed offsets");
+
+    const hurricane_hid_layout_t* mouse = hurricane_hid_boot_layout(HURRICANE_HID_BOOT_MOUSE);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_decode_plan_build(mouse, HURRICANE_HID_REPORT_INPUT, 0, &plan),
+                          "Mouse decode plan");
+    TEST_ASSERT_EQUAL_INT(3, plan.payload_size, "3 byte mouse report");
+    TEST_ASSERT(plan_is_fixed_offset(&plan), "Mouse decodes at fixed offsets");
+
+    hurricane_hid_decode(&plan, mouse_report, sizeof(mouse_report), values);
+    hurricane_hid_decode_get_usage(&plan, mouse, values, 0x09, 3, &value);
+    TEST_ASSERT_EQUAL_INT(1, value, "Button 3");
+    hurricane_hid_decode_get_usage(&plan, mouse, values, 0x01, 0x31, &value);
+    TEST_ASSERT_EQUAL_INT(-16, value, "Y");
+
+    TEST_PASS();
+}
+
+int test_hid_boot_layouts_match_parser(void)
+{
+    static hurricane_hid_layout_t parsed;
+
+    for (uint8_t boot_protocol = HURRICANE_HID_BOOT_KEYBOARD; boot_protocol <= HURRICANE_HID_BOOT_MOUSE; boot_protocol++) {
+        uint16_t length = 0;
+        const uint8_t* desc = hurricane_hid_boot_descriptor(boot_protocol, &length);
+        const hurricane_hid_layout_t* generated = hurricane_hid_boot_layout(boot_protocol);
+
+        TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PARSE_OK, hurricane_hid_parse_report_descriptor(desc, length, &parsed),
+                              "Boot descriptor parses");
+        TEST_ASSERT_EQUAL_INT(parsed.num_fields, generated->num_fields, "Same fields");
+        TEST_ASSERT_EQUAL_INT(parsed.num_reports, generated->num_reports, "Same reports");
+        TEST_ASSERT(parsed.uses_report_ids == generated->uses_report_ids, "Same report ID use");
+        TEST_ASSERT(memcmp(parsed.fields, generated->fields, sizeof(parsed.fields)) == 0,
+                    "Generated field records match the parser");
+        TEST_ASSERT(memcmp(parsed.reports, generated->reports, sizeof(parsed.reports)) == 0,
+                    "Generated report records match the parser");
+    }
+
+    TEST_PASS();
+}
+
+int test_hid_boot_policy(void)
+{
+    const hurricane_hid_transform_rule_t mouse_rules[] = {
+        { .op = HURRICANE_HID_XFORM_INVERT, .usage_page = 0x01, .usage = 0x31 },
+        { .op = HURRICANE_HID_XFORM_REMAP, .usage_page = 0x09, .usage = 1, .target_page = 0x09, .target_usage = 2 },
+    };
+    const hurricane_hid_transform_rule_t caps_to_ctrl = {
+        .op = HURRICANE_HID_XFORM_REMAP, .usage_page = 0x07, .usage = 0x39, .target_page = 0x07, .target_usage = 0xE0
+    };
+    const hurricane_hid_transform_rule_t wheel = { .op = HURRICANE_HID_XFORM_INVERT, .usage_page = 0x01, .usage = 0x38 };
+    const hurricane_hid_transform_rule_t button4 = {
+        .op = HURRICANE_HID_XFORM_REMAP, .usage_page = 0x09, .usage = 1, .target_page = 0x09, .target_usage = 4
+    };
+
+    TEST_ASSERT(hurricane_hid_boot_covers(HURRICANE_HID_BOOT_KEYBOARD, 0x08, 2), "Caps Lock LED");
+    TEST_ASSERT(!hurricane_hid_boot_covers(HURRICANE_HID_BOOT_MOUSE, 0x01, 0x38), "No wheel in boot reports");
+    TEST_ASSERT(hurricane_hid_boot_rules_fit(HURRICANE_HID_BOOT_MOUSE, mouse_rules, 2),
+                "Inversion and button remap run on boot mouse reports");
+    TEST_ASSERT(hurricane_hid_boot_rules_fit(HURRICANE_HID_BOOT_KEYBOARD, &caps_to_ctrl, 1),
+                "Key remap runs on boot keyboard reports");
+    TEST_ASSERT(!hurricane_hid_boot_rules_fit(HURRICANE_HID_BOOT_MOUSE, &caps_to_ctrl, 1),
+                "Keyboard rule does not fit a mouse");
+    TEST_ASSERT(hurricane_hid_boot_rules_fit(HURRICANE_HID_BOOT_MOUSE, NULL, 0), "Plain forwarding fits");
+    TEST_ASSERT(!hurricane_hid_boot_rules_fit(HURRICANE_HID_BOOT_NONE, NULL, 0), "No boot subclass, no fit");
+    TEST_ASSERT(!hurricane_hid_boot_rules_fit(HURRICANE_HID_BOOT_MOUSE, &wheel, 1), "Wheel rule needs report protocol");
+    TEST_ASSERT(!hurricane_hid_boot_rules_fit(HURRICANE_HID_BOOT_MOUSE, &button4, 1),
+                "Remap target must be a boot usage too");
+
+    // Class setup picks the protocol from the rules attached to the device
+    hurricane_hid_device_t hid;
+    hurricane_device_t dev;
+    memset(&hid, 0, sizeof(hid));
+    memset(&dev, 0, sizeof(dev));
+    hid.interface_number = 1;
+    hid.boot_interface = HURRICANE_HID_BOOT_MOUSE;
+    dev.is_active = 1;
+    dev.hid_device = &hid;
+
+    hurricane_hid_init(&dev);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_POLICY_REPORT, hid.protocol_policy, "No rules attached, report policy");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PROTOCOL_REPORT, hid.protocol, "Report protocol by default");
+    TEST_ASSERT_EQUAL_INT(0x0A, last_setup_sent.bRequest, "Only SET_IDLE is sent");
+
+    hid.rules = mouse_rules;
+    hid.num_rules = 2;
+    hurricane_hid_init(&dev);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_POLICY_BOOT, hid.protocol_policy, "Rules fit, boot policy");
+    TEST_ASSERT_EQUAL_INT(0x0B, last_setup_sent.bRequest, "SET_PROTOCOL is sent");
+    TEST_ASSERT_EQUAL_INT(0x21, last_setup_sent.bmRequestType, "Class request to the interface");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PROTOCOL_BOOT, last_setup_sent.wValue, "Boot protocol");
+    TEST_ASSERT_EQUAL_INT(1, last_setup_sent.wIndex, "Interface number");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PROTOCOL_BOOT, hid.protocol, "Device is in boot protocol");
+
+    // A rule on a field boot reports lack falls back to report protocol
+    hid.rules = &wheel;
+    hid.num_rules = 1;
+    hurricane_hid_init(&dev);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_POLICY_REPORT, hid.protocol_policy, "Wheel rule, report policy");
+    TEST_ASSERT_EQUAL_INT(0x0A, last_setup_sent.bRequest, "No SET_PROTOCOL");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PROTOCOL_REPORT, hid.protocol, "Device stays in report protocol");
+
+    // The policy is per device: a keyboard with the same mouse rules stays in report protocol
+    hid.rules = mouse_rules;
+    hid.num_rules = 2;
+    hid.boot_interface = HURRICANE_HID_BOOT_KEYBOARD;
+    hurricane_hid_init(&dev);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PROTOCOL_REPORT, hid.protocol, "Mouse rules keep a keyboard in report protocol");
+
+    // Interfaces outside the boot subclass keep report protocol
+    hid.boot_interface = HURRICANE_HID_BOOT_NONE;
+    hurricane_hid_init(&dev);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PROTOCOL_REPORT, hid.protocol, "No boot subclass, no switch");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_boot(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_hid_boot_layouts);
+    RUN_TEST(test_hid_boot_layouts_match_parser);
+    RUN_TEST(test_hid_boot_policy);
+
+    return failures;
+}
@@ -0,0 +1,143 @@
+// tests/unit/test_usb_hid_delta_filter.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "usb/usb_hid_delta_filter.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_hid_layout_t layout;
+static hurricane_hid_delta_filter_t filter;
+
+// --- Unit Tests ---
+
+int test_hid_delta_suppresses_unchanged(void)
+{
+    uint8_t keys[8] = { 0x02, 0, 0x04, 0, 0, 0, 0, 0 };    // Shift + A
+
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_keyboard, hid_desc_boot_keyboard_size, &layout);
+    hurricane_hid_delta_filter_init(&filter, true);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_delta_filter_use_layout(&filter, &layout), "Layout should be accepted");
+
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_FORWARD,
+                          hurricane_hid_delta_filter_submit(&filter, 0, keys, 8, 0),
+                          "First report is forwarded");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_SUPPRESSED,
+                          hurricane_hid_delta_filter_submit(&filter, 0, keys, 8, 10),
+                          "Identical report is suppressed");
+
+    // A change in the last byte, past the first word, is seen
+    keys[7] = 0x05;
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_FORWARD,
+                          hurricane_hid_delta_filter_submit(&filter, 0, keys, 8, 20),
+                          "Changed report is forwarded");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_FORWARD,
+                          hurricane_hid_delta_filter_submit(&filter, 0, keys, 7, 30),
+                          "A length change counts as a change");
+
+    // Report IDs are tracked independently
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_FORWARD,
+                          hurricane_hid_delta_filter_submit(&filter, 2, keys, 7, 40),
+                          "Same payload on another report ID is forwarded");
+    TEST_ASSERT_EQUAL_INT(1, (int)filter.suppressed, "One report suppressed");
+
+    // Disabled filters forward everything
+    hurricane_hid_delta_filter_init(&filter, false);
+    hurricane_hid_delta_filter_submit(&filter, 0, keys, 8, 0);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_FORWARD,
+                          hurricane_hid_delta_filter_submit(&filter, 0, keys, 8, 1),
+                          "Disabled filter forwards duplicates");
+
+    TEST_PASS();
+}
+
+int test_hid_delta_keeps_relative_motion(void)
+{
+    // Boot mouse: buttons, relative X, relative Y
+    const uint8_t move[3] = { 0x00, 0x01, 0x00 };
+    const uint8_t held[3] = { 0x01, 0x00, 0x00 };
+    uint8_t out[8];
+    uint8_t id = 0xFF;
+
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_mouse, hid_desc_boot_mouse_size, &layout);
+    hurricane_hid_delta_filter_init(&filter, true);
+    hurricane_hid_delta_filter_use_layout(&filter, &layout);
+
+    hurricane_hid_delta_filter_submit(&filter, 0, move, 3, 0);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_FORWARD,
+                          hurricane_hid_delta_filter_submit(&filter, 0, move, 3, 1),
+                          "Repeated motion is real motion");
+
+    hurricane_hid_delta_filter_submit(&filter, 0, held, 3, 2);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_SUPPRESSED,
+                          hurricane_hid_delta_filter_submit(&filter, 0, held, 3, 3),
+                          "A held button without motion is suppressed");
+
+    // Idle repeats of a report with motion restate the buttons only
+    hurricane_hid_delta_filter_set_idle(&filter, 0, 2);
+    hurricane_hid_delta_filter_submit(&filter, 0, move, 3, 10);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_delta_filter_poll(&filter, 17, &id, out, sizeof(out)),
+                          "Nothing due before 8 ms");
+    TEST_ASSERT_EQUAL_INT(3, hurricane_hid_delta_filter_poll(&filter, 18, &id, out, sizeof(out)),
+                          "Repeat due after 8 ms");
+    TEST_ASSERT_EQUAL_INT(0, id, "Repeat carries the report ID");
+    TEST_ASSERT_EQUAL_INT(0, out[1], "Relative X is not replayed");
+
+    TEST_PASS();
+}
+
+int test_hid_delta_honours_set_idle(void)
+{
+    const uint8_t keys[8] = { 0, 0, 0x04, 0, 0, 0, 0, 0 };
+    uint8_t out[8];
+    uint8_t id;
+
+    hurricane_hid_delta_filter_init(&filter, true);
+    hurricane_hid_delta_filter_set_idle(&filter, 0, 125);       // 500 ms, the boot keyboard default
+    hurricane_hid_delta_filter_set_idle(&filter, 4, 0);
+    TEST_ASSERT_EQUAL_INT(125, hurricane_hid_delta_filter_get_idle(&filter, 0), "GET_IDLE reports the rate");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_delta_filter_get_idle(&filter, 4), "Per report override");
+
+    hurricane_hid_delta_filter_submit(&filter, 0, keys, 8, 1000);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_SUPPRESSED,
+                          hurricane_hid_delta_filter_submit(&filter, 0, keys, 8, 1499),
+                          "Unchanged within the idle period");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_FORWARD,
+                          hurricane_hid_delta_filter_submit(&filter, 0, keys, 8, 1500),
+                          "Unchanged report is due once the idle period ran out");
+    TEST_ASSERT_EQUAL_INT(1, (int)filter.idle_repeats, "Counted as an idle repeat");
+
+    // The device went quiet: the filter produces the repeat itself
+    TEST_ASSERT_EQUAL_INT(8, hurricane_hid_delta_filter_poll(&filter, 2000, &id, out, sizeof(out)),
+                          "Repeat produced by the poll");
+    TEST_ASSERT(memcmp(out, keys, 8) == 0, "Repeat restates the last report");
+
+    // Indefinite idle never repeats
+    hurricane_hid_delta_filter_submit(&filter, 4, keys, 8, 2000);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_SUPPRESSED,
+                          hurricane_hid_delta_filter_submit(&filter, 4, keys, 8, 60000),
+                          "Duration 0 reports changes only");
+
+    // After a reset the next report is forwarded again
+    hurricane_hid_delta_filter_reset(&filter);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DELTA_FORWARD,
+                          hurricane_hid_delta_filter_submit(&filter, 4, keys, 8, 60001),
+                          "Reset forgets the reference");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_delta_filter(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_hid_delta_suppresses_unchanged);
+    RUN_TEST(test_hid_delta_keeps_relative_motion);
+    RUN_TEST(test_hid_delta_honours_set_idle);
+
+    return failures;
+}
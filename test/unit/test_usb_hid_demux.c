@@ -0,0 +1,126 @@
+// tests/unit/test_usb_hid_demux.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "usb/usb_hid_demux.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_hid_layout_t layout;
+static hurricane_hid_demux_t demux;
+
+// Gaming mouse: report 1 (buttons, X, Y, wheel, pan) and report 3 (consumer keys)
+static const uint8_t mouse_report[] = { 0x01, 0x05, 0x00, 0x10, 0x00, 0xF0, 0xFF, 0x01, 0x00 };
+static const uint8_t consumer_report[] = { 0x03, 0xE9, 0x00, 0x00, 0x00 };
+
+// --- Unit Tests ---
+
+int test_hid_demux_routes_by_report_id(void)
+{
+    const hurricane_hid_demux_route_t to_mouse = { .pipe = 0, .flags = HURRICANE_HID_DEMUX_STRIP_ID };
+    const hurricane_hid_demux_route_t to_media = { .pipe = 2, .flags = HURRICANE_HID_DEMUX_REWRITE_ID, .out_id = 7 };
+    hurricane_hid_demux_output_t out;
+    const uint8_t vendor_report[] = { 0x42, 0xAA };
+
+    hurricane_hid_parse_report_descriptor(hid_desc_gaming_mouse, hid_desc_gaming_mouse_size, &layout);
+    hurricane_hid_demux_init(&demux, &layout);
+    TEST_ASSERT(demux.uses_report_ids, "Descriptor declares report IDs");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_demux_add_route(&demux, 1, &to_mouse), "First route");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_demux_add_route(&demux, 3, &to_media), "Second route");
+
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_demux_dispatch(&demux, mouse_report, sizeof(mouse_report), &out),
+                          "Report 1 goes to the mouse pipe");
+    TEST_ASSERT(out.data == &mouse_report[1], "Stripped report is not copied");
+    TEST_ASSERT_EQUAL_INT(8, out.length, "ID byte is stripped");
+    TEST_ASSERT(out.values == NULL, "Raw route does not decode");
+
+    TEST_ASSERT_EQUAL_INT(2, hurricane_hid_demux_dispatch(&demux, consumer_report, sizeof(consumer_report), &out),
+                          "Report 3 goes to the media pipe");
+    TEST_ASSERT_EQUAL_INT(3, out.report_id, "Incoming ID is reported");
+    TEST_ASSERT_EQUAL_INT(7, out.data[0], "ID is rewritten");
+    TEST_ASSERT_EQUAL_INT(0xE9, out.data[1], "Payload follows the new ID");
+    TEST_ASSERT_EQUAL_INT(5, out.length, "Length is unchanged");
+
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DEMUX_ERR_NO_ROUTE,
+                          hurricane_hid_demux_dispatch(&demux, vendor_report, sizeof(vendor_report), &out),
+                          "Unrouted report ID is dropped");
+    TEST_ASSERT_EQUAL_INT(2, (int)demux.dispatched, "Two reports routed");
+    TEST_ASSERT_EQUAL_INT(1, (int)demux.unrouted, "One report dropped");
+
+    // Re-adding a route replaces it
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_demux_add_route(&demux, 3, &to_mouse), "Route is replaced in place");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_demux_dispatch(&demux, consumer_report, sizeof(consumer_report), &out),
+                          "Report 3 follows the new route");
+
+    TEST_PASS();
+}
+
+int test_hid_demux_decode_transform_pack(void)
+{
+    static hurricane_hid_decode_plan_t decode;
+    static hurricane_hid_pack_plan_t pack;
+    static hurricane_hid_transform_t xf;
+    const hurricane_hid_transform_rule_t invert_x = { .op = HURRICANE_HID_XFORM_INVERT, .usage_page = 0x01, .usage = 0x30 };
+    hurricane_hid_demux_output_t out;
+    int32_t value;
+
+    hurricane_hid_parse_report_descriptor(hid_desc_gaming_mouse, hid_desc_gaming_mouse_size, &layout);
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 1, &decode);
+    hurricane_hid_pack_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 1, &pack);
+    hurricane_hid_transform_compile(&xf, &invert_x, 1, &layout, &decode);
+
+    const hurricane_hid_demux_route_t bad = { .pipe = 0, .transform = &xf };
+    const hurricane_hid_demux_route_t route = { .pipe = 1, .decode = &decode, .transform = &xf, .pack = &pack };
+
+    hurricane_hid_demux_init(&demux, &layout);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DEMUX_ERR_INVALID_ARG, hurricane_hid_demux_add_route(&demux, 1, &bad),
+                          "A transform needs a decode plan");
+    hurricane_hid_demux_add_route(&demux, 1, &route);
+
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_demux_dispatch(&demux, mouse_report, sizeof(mouse_report), &out),
+                          "Report 1 is routed");
+    TEST_ASSERT(out.values != NULL, "Decoded values are handed out");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_decode_get_usage(&decode, &layout, out.values, 0x01, 0x30, &value),
+                          "X is found by usage");
+    TEST_ASSERT_EQUAL_INT(-16, value, "X is inverted");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_decode_get_usage(&decode, &layout, out.values, 0x09, 3, &value),
+                          "Button 3 is found by usage");
+    TEST_ASSERT_EQUAL_INT(1, value, "Button 3 is pressed");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DECODE_ERR_NO_USAGE,
+                          hurricane_hid_decode_get_usage(&decode, &layout, out.values, 0x0C, 0xE9, &value),
+                          "Consumer keys live in another report");
+
+    TEST_ASSERT_EQUAL_INT(9, out.length, "Repacked with the pack plan's ID");
+    TEST_ASSERT_EQUAL_INT(1, out.data[0], "Report ID");
+    TEST_ASSERT_EQUAL_INT(0xF0, out.data[3], "Inverted X, low byte");
+    TEST_ASSERT_EQUAL_INT(0xFF, out.data[4], "Inverted X, high byte");
+    TEST_ASSERT_EQUAL_INT(0xF0, out.data[5], "Y is untouched");
+
+    // Without report IDs everything takes the route of ID 0 and the first byte is payload
+    const uint8_t boot_report[] = { 0x01, 0x02, 0x03 };
+    const hurricane_hid_demux_route_t raw = { .pipe = 4, .flags = HURRICANE_HID_DEMUX_STRIP_ID };
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_mouse, hid_desc_boot_mouse_size, &layout);
+    hurricane_hid_demux_init(&demux, &layout);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_DEMUX_ERR_INVALID_ARG, hurricane_hid_demux_add_route(&demux, 1, &raw),
+                          "No IDs, only route 0");
+    hurricane_hid_demux_add_route(&demux, 0, &raw);
+    TEST_ASSERT_EQUAL_INT(4, hurricane_hid_demux_dispatch(&demux, boot_report, sizeof(boot_report), &out),
+                          "Boot report is routed");
+    TEST_ASSERT_EQUAL_INT(3, out.length, "Nothing is stripped");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_demux(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_hid_demux_routes_by_report_id);
+    RUN_TEST(test_hid_demux_decode_transform_pack);
+
+    return failures;
+}
@@ -0,0 +1,126 @@
+// tests/unit/test_usb_hid_events.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "usb/usb_hid_events.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// NKRO keyboard: modifiers plus a bitfield for usages 0x04-0x73
+static const uint8_t nkro_keyboard[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01,
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x08, 0x81, 0x02,
+    0x19, 0x04, 0x29, 0x73, 0x95, 0x70, 0x81, 0x02,
+    0xC0
+};
+
+static hurricane_hid_layout_t layout;
+static hurricane_hid_decode_plan_t plan;
+static hurricane_hid_event_decoder_t decoder;
+static hurricane_hid_event_ring_t ring;
+
+static int feed(const uint8_t* report, uint16_t length, uint32_t time)
+{
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];
+    hurricane_hid_decode(&plan, report, length, values);
+    return hurricane_hid_event_decoder_feed(&decoder, values, time, &ring);
+}
+
+static bool next_event(uint8_t type, uint16_t usage, int32_t value)
+{
+    hurricane_hid_event_t event;
+    return hurricane_hid_event_ring_pop(&ring, &event) &&
+           event.type == type && event.usage == usage && event.value == value;
+}
+
+// --- Unit Tests ---
+
+int test_hid_events_keyboards(void)
+{
+    const uint8_t press_a_shift[8] = { 0x02, 0, 0x04 };
+    const uint8_t add_b[8] = { 0x02, 0, 0x05, 0x04 };
+    const uint8_t rollover[8] = { 0, 0, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01 };
+    const uint8_t release_a[8] = { 0, 0, 0x05 };
+    uint8_t nkro[15] = { 0 };
+
+    hurricane_hid_event_ring_init(&ring);
+
+    // 6KRO array: slot order does not matter, only changed keys produce events
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_keyboard, hid_desc_boot_keyboard_size, &layout);
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 0, &plan);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_event_decoder_init(&decoder, &layout, &plan, 3), "Decoder init");
+
+    TEST_ASSERT_EQUAL_INT(2, feed(press_a_shift, 8, 10), "A and Left Shift");
+    TEST_ASSERT(next_event(HURRICANE_HID_EVENT_KEY_DOWN, 0x04, 0), "A down");
+    TEST_ASSERT(next_event(HURRICANE_HID_EVENT_KEY_DOWN, 0xE1, 0), "Left Shift down");
+    TEST_ASSERT_EQUAL_INT(1, feed(add_b, 8, 20), "B added in front of A");
+    TEST_ASSERT(next_event(HURRICANE_HID_EVENT_KEY_DOWN, 0x05, 0), "B down");
+    TEST_ASSERT_EQUAL_INT(0, feed(rollover, 8, 30), "Rollover keeps the held keys");
+    TEST_ASSERT(hurricane_hid_event_key_down(&decoder, 0x04), "A still held");
+    TEST_ASSERT_EQUAL_INT(2, feed(release_a, 8, 40), "A and Shift released");
+    TEST_ASSERT(next_event(HURRICANE_HID_EVENT_KEY_UP, 0x04, 0), "A up");
+    TEST_ASSERT(next_event(HURRICANE_HID_EVENT_KEY_UP, 0xE1, 0), "Shift up");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_event_decoder_release_all(&decoder, 50, &ring), "B released");
+    TEST_ASSERT(next_event(HURRICANE_HID_EVENT_KEY_UP, 0x05, 0), "B up");
+
+    // NKRO bitfield starting at usage 4: masks straddle bitmap words
+    hurricane_hid_parse_report_descriptor(nkro_keyboard, sizeof(nkro_keyboard), &layout);
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 0, &plan);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_event_decoder_init(&decoder, &layout, &plan, 0), "NKRO decoder init");
+    nkro[1 + (0x20 - 4) / 8] |= 1u << ((0x20 - 4) % 8);    // '3'
+    nkro[1 + (0x65 - 4) / 8] |= 1u << ((0x65 - 4) % 8);    // Application
+    TEST_ASSERT_EQUAL_INT(2, feed(nkro, sizeof(nkro), 60), "Two keys down");
+    TEST_ASSERT(next_event(HURRICANE_HID_EVENT_KEY_DOWN, 0x20, 0), "Key 0x20 down");
+    TEST_ASSERT(next_event(HURRICANE_HID_EVENT_KEY_DOWN, 0x65, 0), "Key 0x65 down");
+    TEST_ASSERT_EQUAL_INT(0, feed(nkro, sizeof(nkro), 70), "Repeated report, no events");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_event_ring_count(&ring), "Ring drained");
+
+    TEST_PASS();
+}
+
+int test_hid_events_mouse_and_ring(void)
+{
+    const uint8_t move[] = { 0x01, 0x05, 0x00 };
+    const uint8_t still[] = { 0x00, 0x00, 0x00 };
+    hurricane_hid_event_t event;
+
+    hurricane_hid_event_ring_init(&ring);
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_mouse, hid_desc_boot_mouse_size, &layout);
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 0, &plan);
+    hurricane_hid_event_decoder_init(&decoder, &layout, &plan, 1);
+
+    TEST_ASSERT_EQUAL_INT(2, feed(move, sizeof(move), 100), "Button and X");
+    TEST_ASSERT(hurricane_hid_event_ring_pop(&ring, &event), "Axis event");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_EVENT_AXIS, event.type, "Axis first");
+    TEST_ASSERT_EQUAL_INT(0x30, event.usage, "X");
+    TEST_ASSERT_EQUAL_INT(5, event.value, "Delta");
+    TEST_ASSERT_EQUAL_INT(100, (int)event.time, "Timestamp");
+    TEST_ASSERT_EQUAL_INT(1, event.source, "Source tag");
+    TEST_ASSERT(next_event(HURRICANE_HID_EVENT_BUTTON_DOWN, 1, 0), "Button 1 down");
+    TEST_ASSERT_EQUAL_INT(1, feed(still, sizeof(still), 110), "Zero deltas are not events");
+    TEST_ASSERT(next_event(HURRICANE_HID_EVENT_BUTTON_UP, 1, 0), "Button 1 up");
+
+    // A full ring drops new events and counts them
+    for (int i = 0; i < HURRICANE_HID_EVENT_RING_SIZE + 3; i++) {
+        feed(move, sizeof(move), 200);
+    }
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_EVENT_RING_SIZE, hurricane_hid_event_ring_count(&ring), "Ring full");
+    TEST_ASSERT_EQUAL_INT(4, (int)ring.dropped, "Dropped events counted");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_events(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_hid_events_keyboards);
+    RUN_TEST(test_hid_events_mouse_and_ring);
+
+    return failures;
+}
@@ -0,0 +1,123 @@
+// tests/unit/test_usb_hid_inject_queue.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "usb/usb_hid_inject_queue.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_inject_queue_t queue;
+static hurricane_inject_sched_t sched;
+
+static hurricane_inject_event_t move_event(int32_t value)
+{
+    hurricane_inject_event_t event = {
+        .usage_page = 0x01, .usage = 0x30, .value = value,
+        .pipe = 0, .action = HURRICANE_INJECT_MOVE
+    };
+    return event;
+}
+
+// --- Unit Tests ---
+
+int test_inject_queue_fifo(void)
+{
+    hurricane_inject_event_t event = move_event(0);
+    int32_t expected = 0;
+    bool in_order = true;
+
+    hurricane_inject_queue_init(&queue);
+    TEST_ASSERT(!hurricane_inject_queue_pop(&queue, &event), "Empty queue");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_INJECT_QUEUE_ERR_INVALID_ARG, hurricane_inject_queue_push(&queue, NULL),
+                          "NULL action");
+
+    // Several laps around the ring, half full at a time
+    for (int lap = 0; lap < 8; lap++) {
+        for (int i = 0; i < HURRICANE_INJECT_QUEUE_SIZE / 2; i++) {
+            event = move_event(lap * 1000 + i);
+            hurricane_inject_queue_push(&queue, &event);
+        }
+        for (int i = 0; i < HURRICANE_INJECT_QUEUE_SIZE / 2; i++) {
+            expected = lap * 1000 + i;
+            in_order &= hurricane_inject_queue_pop(&queue, &event) && event.value == expected;
+        }
+    }
+    TEST_ASSERT(in_order, "Actions come out in push order");
+
+    // A full queue rejects pushes until the consumer frees a slot
+    for (int i = 0; i < HURRICANE_INJECT_QUEUE_SIZE; i++) {
+        event = move_event(i);
+        TEST_ASSERT_EQUAL_INT(0, hurricane_inject_queue_push(&queue, &event), "Slot free");
+    }
+    TEST_ASSERT_EQUAL_INT(HURRICANE_INJECT_QUEUE_ERR_FULL, hurricane_inject_queue_push(&queue, &event), "Full");
+    TEST_ASSERT_EQUAL_INT(1, (int)atomic_load(&queue.dropped), "Rejected push counted");
+    TEST_ASSERT(hurricane_inject_queue_pop(&queue, &event), "Pop frees a slot");
+    TEST_ASSERT_EQUAL_INT(0, event.value, "Oldest first");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_inject_queue_push(&queue, &event), "Push fits again");
+
+    TEST_PASS();
+}
+
+int test_inject_queue_drain(void)
+{
+    hurricane_hid_layout_t layout;
+    hurricane_hid_pack_plan_t plan;
+    hurricane_hid_merge_t merge;
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];
+    int32_t x = 0;
+    hurricane_inject_event_t event;
+
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_mouse, hid_desc_boot_mouse_size, &layout);
+    hurricane_hid_pack_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 0, &plan);
+    hurricane_hid_merge_init(&merge, &layout, &plan);
+    hurricane_inject_queue_init(&queue);
+    hurricane_inject_sched_init(&sched);
+
+    // Two producers' moves and a press, all due now
+    event = move_event(3);
+    hurricane_inject_queue_push(&queue, &event);
+    event = move_event(-1);
+    hurricane_inject_queue_push(&queue, &event);
+    event.usage_page = 0x09;
+    event.usage = 1;
+    event.action = HURRICANE_INJECT_PRESS;
+    hurricane_inject_queue_push(&queue, &event);
+    event.pipe = 7;
+    hurricane_inject_queue_push(&queue, &event);
+
+    TEST_ASSERT_EQUAL_INT(4, hurricane_inject_queue_drain(&queue, &sched), "All actions moved");
+    TEST_ASSERT_EQUAL_INT(4, hurricane_inject_sched_pending(&sched), "Queued in the scheduler");
+    TEST_ASSERT_EQUAL_INT(3, hurricane_inject_sched_run(&sched, 0, &merge, 1), "Applied to the merge");
+    TEST_ASSERT_EQUAL_INT(1, (int)sched.rejected, "Pipe without a merge rejected");
+
+    hurricane_hid_merge_build(&merge, values);
+    x = values[plan.field_value[1]];
+    TEST_ASSERT_EQUAL_INT(2, x, "Moves summed");
+    TEST_ASSERT_EQUAL_INT(1, values[plan.field_value[0]] & 1, "Button 1 pressed");
+
+    // A full scheduler leaves the rest in the queue
+    for (int i = 0; i < HURRICANE_INJECT_MAX_EVENTS - 1; i++) {
+        event = move_event(1);
+        hurricane_inject_sched_add(&sched, &event);
+    }
+    hurricane_inject_queue_push(&queue, &event);
+    hurricane_inject_queue_push(&queue, &event);
+    TEST_ASSERT_EQUAL_INT(1, hurricane_inject_queue_drain(&queue, &sched), "One slot in the scheduler");
+    TEST_ASSERT(hurricane_inject_queue_pop(&queue, &event), "Second action still queued");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_inject_queue(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_inject_queue_fifo);
+    RUN_TEST(test_inject_queue_drain);
+
+    return failures;
+}
@@ -0,0 +1,176 @@
+// tests/unit/test_usb_hid_inject_sched.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "usb/usb_hid_inject_sched.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_hid_layout_t layouts[2];
+static hurricane_hid_pack_plan_t plans[2];
+static hurricane_hid_merge_t merges[2];
+static hurricane_inject_sched_t sched;
+
+// Pipe 0: boot keyboard, pipe 1: gaming mouse report 1
+static void setup_pipes(void)
+{
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_keyboard, hid_desc_boot_keyboard_size, &layouts[0]);
+    hurricane_hid_pack_plan_build(&layouts[0], HURRICANE_HID_REPORT_INPUT, 0, &plans[0]);
+    hurricane_hid_merge_init(&merges[0], &layouts[0], &plans[0]);
+    hurricane_hid_parse_report_descriptor(hid_desc_gaming_mouse, hid_desc_gaming_mouse_size, &layouts[1]);
+    hurricane_hid_pack_plan_build(&layouts[1], HURRICANE_HID_REPORT_INPUT, 1, &plans[1]);
+    hurricane_hid_merge_init(&merges[1], &layouts[1], &plans[1]);
+    hurricane_inject_sched_init(&sched);
+}
+
+// First key of the merged keyboard report
+static uint8_t keyboard_key(void)
+{
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];
+    uint8_t report[8];
+    hurricane_hid_merge_build(&merges[0], values);
+    hurricane_hid_pack(&plans[0], values, report, sizeof(report));
+    return report[2];
+}
+
+// --- Unit Tests ---
+
+int test_inject_sched_order(void)
+{
+    uint32_t due = 0;
+    uint32_t last = 0;
+    uint32_t seed = 12345;
+
+    setup_pipes();
+    TEST_ASSERT(!hurricane_inject_sched_next(&sched, &due), "Empty scheduler");
+
+    // A script added out of order, times close to the uint32_t wrap
+    for (int i = 0; i < HURRICANE_INJECT_MAX_EVENTS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        hurricane_inject_event_t event = {
+            .due_us = 0xFFFF0000u + (seed >> 16),
+            .usage_page = 0x01, .usage = 0x38, .value = 1,
+            .pipe = 1, .action = HURRICANE_INJECT_MOVE
+        };
+        TEST_ASSERT_EQUAL_INT(0, hurricane_inject_sched_add(&sched, &event), "Action queued");
+    }
+    hurricane_inject_event_t extra = { .pipe = 1, .action = HURRICANE_INJECT_MOVE };
+    TEST_ASSERT_EQUAL_INT(HURRICANE_INJECT_ERR_FULL, hurricane_inject_sched_add(&sched, &extra), "Queue is full");
+    extra.pipe = HURRICANE_INJECT_MAX_PIPES;
+    TEST_ASSERT_EQUAL_INT(HURRICANE_INJECT_ERR_INVALID_ARG, hurricane_inject_sched_add(&sched, &extra),
+                          "Pipe out of range");
+
+    // Released in due order, each run taking exactly what is due
+    int total = 0;
+    bool ordered = true;
+    hurricane_inject_sched_next(&sched, &last);
+    while (hurricane_inject_sched_next(&sched, &due)) {
+        ordered &= (int32_t)(due - last) >= 0;
+        TEST_ASSERT_EQUAL_INT(0, hurricane_inject_sched_run(&sched, due - 1, merges, 2), "Nothing due yet");
+        total += hurricane_inject_sched_run(&sched, due, merges, 2);
+        last = due;
+    }
+    TEST_ASSERT(ordered, "Due times never go backwards");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_INJECT_MAX_EVENTS, total, "Every action applied");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_INJECT_MAX_EVENTS, (int)sched.applied, "Applied counter");
+
+    // Actions for a pipe without a merge are dropped
+    hurricane_inject_event_t set = { .due_us = 500, .usage_page = 0x07, .usage = 0x04,
+                                     .pipe = 0, .action = HURRICANE_INJECT_PRESS };
+    hurricane_inject_sched_add(&sched, &set);
+    set.pipe = 5;
+    hurricane_inject_sched_add(&sched, &set);
+    TEST_ASSERT_EQUAL_INT(1, hurricane_inject_sched_run(&sched, 500, merges, 2), "One pipe exists");
+    TEST_ASSERT_EQUAL_INT(1, (int)sched.rejected, "Action for a missing pipe is dropped");
+    TEST_ASSERT_EQUAL_INT(0x04, keyboard_key(), "Key pressed");
+
+    TEST_PASS();
+}
+
+int test_inject_sched_edges(void)
+{
+    setup_pipes();
+
+    // A tap shorter than a poll: both due at once
+    TEST_ASSERT_EQUAL_INT(0, hurricane_inject_sched_tap(&sched, 0, 1000, 0x07, 0x0B, 100), "Tap H");
+    hurricane_inject_event_t move = { .due_us = 1050, .usage_page = 0x01, .usage = 0x30, .value = 7,
+                                      .pipe = 1, .action = HURRICANE_INJECT_MOVE };
+    hurricane_inject_sched_add(&sched, &move);
+    TEST_ASSERT_EQUAL_INT(3, hurricane_inject_sched_pending(&sched), "Press, move, release queued");
+
+    TEST_ASSERT_EQUAL_INT(2, hurricane_inject_sched_run(&sched, 2000, merges, 2), "Release waits for the next poll");
+    TEST_ASSERT_EQUAL_INT(0x0B, keyboard_key(), "PC sees the press");
+    TEST_ASSERT(hurricane_hid_merge_pending(&merges[1]), "Mouse motion is due as well");
+
+    TEST_ASSERT_EQUAL_INT(1, hurricane_inject_sched_run(&sched, 2001, merges, 2), "Release on the next poll");
+    TEST_ASSERT_EQUAL_INT(0, keyboard_key(), "PC sees the release");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_inject_sched_pending(&sched), "Script done");
+
+    // Equal times keep insertion order
+    hurricane_inject_sched_tap(&sched, 0, 2500, 0x07, 0x08, 0);
+    hurricane_inject_sched_run(&sched, 2500, merges, 2);
+    TEST_ASSERT_EQUAL_INT(0x08, keyboard_key(), "Press comes before the release");
+    hurricane_inject_sched_run(&sched, 2500, merges, 2);
+    TEST_ASSERT_EQUAL_INT(0, keyboard_key(), "Release follows");
+
+    // Actions the merge does not accept are dropped as well
+    hurricane_inject_event_t bad = { .due_us = 3000, .usage_page = 0x0D, .usage = 0x30,
+                                     .pipe = 1, .action = HURRICANE_INJECT_SET };
+    hurricane_inject_sched_add(&sched, &bad);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_inject_sched_run(&sched, 3000, merges, 2), "Usage is not in the report");
+    TEST_ASSERT_EQUAL_INT(1, (int)sched.rejected, "Rejected action is counted and dropped");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_inject_sched_pending(&sched), "Nothing left");
+
+    TEST_PASS();
+}
+
+int test_inject_sched_long_script(void)
+{
+    static hurricane_inject_event_t storage[5000];
+    static const uint8_t word[] = { 0x0B, 0x08, 0x0F, 0x0F, 0x12 };    // H-E-L-L-O
+    uint32_t due = 0;
+    int taps = 0;
+    int keys_seen = 0;
+
+    setup_pipes();
+    TEST_ASSERT_EQUAL_INT(HURRICANE_INJECT_ERR_INVALID_ARG, hurricane_inject_sched_init_storage(&sched, storage, 0),
+                          "No capacity");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_inject_sched_init_storage(&sched, storage, 5000), "Application storage");
+
+    // 2500 taps, far beyond the built-in storage, queued at once
+    for (int i = 0; i < 2500; i++) {
+        taps += hurricane_inject_sched_tap(&sched, 0, 1000 + i * 2000, 0x07, word[i % 5], 1000) == 0;
+    }
+    TEST_ASSERT_EQUAL_INT(2500, taps, "Whole script queued");
+    TEST_ASSERT_EQUAL_INT(5000, hurricane_inject_sched_pending(&sched), "Press and release each");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_INJECT_ERR_FULL, hurricane_inject_sched_tap(&sched, 0, 0, 0x07, 0x04, 1),
+                          "Storage is full");
+
+    // Played back in order, one press per poll
+    while (hurricane_inject_sched_next(&sched, &due)) {
+        hurricane_inject_sched_run(&sched, due, merges, 2);
+        uint8_t key = keyboard_key();
+        if (key) {
+            keys_seen += key == word[keys_seen % 5];
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(2500, keys_seen, "Every key seen, in order");
+    TEST_ASSERT_EQUAL_INT(5000, (int)sched.applied, "Every action applied");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_inject_sched(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_inject_sched_order);
+    RUN_TEST(test_inject_sched_edges);
+    RUN_TEST(test_inject_sched_long_script);
+
+    return failures;
+}
@@ -0,0 +1,137 @@
+// tests/unit/test_usb_hid_kvm.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "core/hurricane_context.h"
+#include "hw/hurricane_hw_ops.h"
+#include "usb/usb_hid_kvm.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Defined in the dummy HAL
+extern uint8_t last_interrupt_in_endpoint;
+extern uint8_t last_interrupt_in_data[65];
+extern uint16_t last_interrupt_in_length;
+extern int interrupt_in_count;
+extern uint8_t last_interrupt_out_data[64];
+extern int interrupt_out_count;
+
+// PC B sits on a second device controller, which needs the controller registry
+#ifndef HURRICANE_HW_SINGLE_CONTROLLER
+
+// Second device controller, facing PC B
+typedef struct {
+    int reports;
+    uint8_t last[8];
+} fake_port_t;
+
+static int fake_device_interrupt_in(void* priv, uint8_t endpoint, void* buffer, uint16_t length)
+{
+    fake_port_t* port = (fake_port_t*)priv;
+    (void)endpoint;
+    memcpy(port->last, buffer, length < sizeof(port->last) ? length : sizeof(port->last));
+    port->reports++;
+    return length;
+}
+
+static const hurricane_hw_ops_t fake_port_ops = {
+    .device_interrupt_in_transfer = fake_device_interrupt_in,
+};
+
+static hurricane_context_t pc_a;
+static hurricane_context_t pc_b;
+static hurricane_hid_pipeline_t pipeline;
+static hurricane_hid_kvm_t kvm;
+static hurricane_hid_output_relay_t led_relay;
+
+static void add_keyboard_interface(hurricane_context_t* ctx)
+{
+    hurricane_interface_descriptor_t desc = { .interface_num = 0, .interface_class = 3, .num_endpoints = 1 };
+
+    hurricane_interface_manager_init_ctx(ctx);
+    hurricane_add_device_interface_ctx(ctx, 0, 3, 1, 1, &desc);
+    hurricane_device_configure_endpoint_ctx(ctx, 0, 0x81, 0x03, 8, 1);
+}
+
+// --- Unit Tests ---
+
+int test_kvm_hotkey_switch(void)
+{
+    hurricane_hid_pipe_config_t pipe = {
+        .source_page = 0x01, .source_usage = 0x06, .sink_interface = 0, .sink_endpoint = 0x81,
+        .sink_descriptor = hid_desc_boot_keyboard, .sink_descriptor_length = hid_desc_boot_keyboard_size
+    };
+    hurricane_hid_pipeline_config_t config = { .pipes = &pipe, .num_pipes = 1 };
+    fake_port_t port_b = {0};
+    const uint8_t a_key[8] = { 0x00, 0, 0x04 };
+    const uint8_t hotkey_b[8] = { 0x05, 0, 0x04, 0x1F };
+    const uint8_t modifiers[8] = { 0x05 };
+    const uint8_t released[8] = { 0 };
+    const uint8_t b_key[8] = { 0x00, 0, 0x05 };
+    const uint8_t caps[1] = { 0x02 };
+
+    hurricane_hw_register_controller(1, "pc-b", &fake_port_ops, &port_b);
+    hurricane_context_init(&pc_a, HURRICANE_HW_PRIMARY_CONTROLLER, HURRICANE_HW_PRIMARY_CONTROLLER);
+    hurricane_context_init(&pc_b, HURRICANE_HW_PRIMARY_CONTROLLER, 1);
+    add_keyboard_interface(&pc_a);
+
+    hurricane_hid_pipeline_init(&pipeline, &config);
+    hurricane_hid_pipeline_attach(&pipeline, hid_desc_boot_keyboard, hid_desc_boot_keyboard_size);
+    hurricane_hid_output_relay_init(&led_relay, 0, 0x02, 0);
+    hurricane_hid_kvm_init(&kvm, HURRICANE_HID_KVM_CTRL_ALT, &led_relay);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_kvm_add_target(&kvm, &pc_a, 0x1E), "PC A");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_kvm_add_target(&kvm, &pc_b, 0x1F), "PC B");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_kvm_add_pipeline(&kvm, &pipeline), "Pipeline");
+
+    // PC B has not configured its keyboard yet
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_KVM_ERR_NO_ENDPOINT, hurricane_hid_kvm_switch(&kvm, 1, 0), "Not ready");
+    add_keyboard_interface(&pc_b);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_OUTPUT_DEFERRED, hurricane_hid_kvm_output(&kvm, 1, 0, caps, 1, 0),
+                          "B's Caps Lock remembered");
+
+    // Typing goes to PC A
+    interrupt_in_count = 0;
+    hurricane_hid_kvm_submit(&kvm, 0, a_key, sizeof(a_key), 1);
+    TEST_ASSERT(memcmp(last_interrupt_in_data, a_key, 8) == 0, "A gets the key");
+
+    // Ctrl+Alt+2 while A is still held: A sees everything released, never the chord
+    int out_before = interrupt_out_count;
+    hurricane_hid_kvm_submit(&kvm, 0, hotkey_b, sizeof(hotkey_b), 2);
+    TEST_ASSERT_EQUAL_INT(1, kvm.focus, "Focus on B");
+    TEST_ASSERT_EQUAL_INT(2, interrupt_in_count, "Only the release went to A");
+    TEST_ASSERT(memcmp(last_interrupt_in_data, released, 8) == 0, "A released");
+    TEST_ASSERT_EQUAL_INT(out_before + 1, interrupt_out_count, "LEDs resynced");
+    TEST_ASSERT_EQUAL_INT(0x02, last_interrupt_out_data[0], "Keyboard shows B's Caps Lock");
+
+    // Input stays swallowed until the modifiers are let go
+    hurricane_hid_kvm_submit(&kvm, 0, modifiers, sizeof(modifiers), 3);
+    hurricane_hid_pipeline_run(&pipeline, 3);
+    TEST_ASSERT(memcmp(port_b.last, released, 8) == 0, "B never sees the chord");
+    hurricane_hid_kvm_submit(&kvm, 0, b_key, sizeof(b_key), 4);
+    TEST_ASSERT(memcmp(port_b.last, b_key, 8) == 0, "B gets the key");
+    TEST_ASSERT_EQUAL_INT(2, interrupt_in_count, "A gets nothing more");
+
+    hurricane_hw_unregister_controller(1);
+    hurricane_interface_manager_deinit_ctx(&pc_a);
+    hurricane_interface_manager_deinit_ctx(&pc_b);
+    hurricane_context_deinit(&pc_a);
+    hurricane_context_deinit(&pc_b);
+    TEST_PASS();
+}
+
+#endif // HURRICANE_HW_SINGLE_CONTROLLER
+
+// --- Test suite runner ---
+
+int test_usb_hid_kvm(void)
+{
+    int failures = 0;
+
+#ifndef HURRICANE_HW_SINGLE_CONTROLLER
+    RUN_TEST(test_kvm_hotkey_switch);
+#endif
+
+    return failures;
+}
@@ -0,0 +1,167 @@
+// tests/unit/test_usb_hid_merge.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "usb/usb_hid_merge.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_hid_layout_t layout;
+static hurricane_hid_pack_plan_t plan;
+static hurricane_hid_merge_t merge;
+
+// Digitizer-style pointer: 3 buttons, absolute X in 0..4095
+static const uint8_t absolute_pointer_desc[] = {
+    0x05, 0x01, 0x09, 0x02, 0xA1, 0x01,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x03, 0x15, 0x00, 0x25, 0x01,
+    0x95, 0x03, 0x75, 0x01, 0x81, 0x02,
+    0x95, 0x01, 0x75, 0x05, 0x81, 0x03,
+    0x05, 0x01, 0x09, 0x30, 0x15, 0x00, 0x26, 0xFF, 0x0F,
+    0x75, 0x10, 0x95, 0x01, 0x81, 0x02,
+    0xC0
+};
+
+static void set(int32_t* values, uint16_t page, uint16_t usage, int32_t value)
+{
+    hurricane_hid_pack_set_usage(&plan, &layout, values, page, usage, value);
+}
+
+static int32_t get(const int32_t* values, uint16_t page, uint16_t usage)
+{
+    // Decode and pack plans of a report share the value layout
+    hurricane_hid_decode_plan_t decode;
+    int32_t value = 0;
+    hurricane_hid_decode_plan_build(&layout, plan.type, plan.report_id, &decode);
+    hurricane_hid_decode_get_usage(&decode, &layout, values, page, usage, &value);
+    return value;
+}
+
+// --- Unit Tests ---
+
+int test_hid_merge_mouse(void)
+{
+    int32_t live[HURRICANE_HID_MAX_DECODE_VALUES];
+    int32_t out[HURRICANE_HID_MAX_DECODE_VALUES];
+
+    hurricane_hid_parse_report_descriptor(hid_desc_gaming_mouse, hid_desc_gaming_mouse_size, &layout);
+    hurricane_hid_pack_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 1, &plan);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_merge_init(&merge, &layout, &plan), "Merge for report 1");
+    TEST_ASSERT(!hurricane_hid_merge_pending(&merge), "Nothing to send yet");
+
+    // Two live reports between polls, button 1 held
+    memset(live, 0, sizeof(live));
+    set(live, 0x09, 1, 1);
+    set(live, 0x01, 0x30, 10);
+    hurricane_hid_merge_live(&merge, live);
+    hurricane_hid_merge_live(&merge, live);
+
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_merge_inject(&merge, 0x09, 2, 1), "Inject button 2");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_merge_inject(&merge, 0x01, 0x30, 5), "Inject X motion");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_MERGE_ERR_NO_USAGE, hurricane_hid_merge_inject(&merge, 0x0C, 0xE9, 1),
+                          "Consumer keys live in another report");
+    TEST_ASSERT(hurricane_hid_merge_pending(&merge), "Report due");
+
+    hurricane_hid_merge_build(&merge, out);
+    TEST_ASSERT_EQUAL_INT(1, get(out, 0x09, 1), "Live button");
+    TEST_ASSERT_EQUAL_INT(1, get(out, 0x09, 2), "Injected button");
+    TEST_ASSERT_EQUAL_INT(25, get(out, 0x01, 0x30), "Live motion is summed, injected motion added");
+    TEST_ASSERT(!hurricane_hid_merge_pending(&merge), "Everything was sent");
+
+    // A live report releasing button 1 does not release the injected button 2
+    set(live, 0x09, 1, 0);
+    set(live, 0x01, 0x30, 0);
+    hurricane_hid_merge_live(&merge, live);
+    hurricane_hid_merge_build(&merge, out);
+    TEST_ASSERT_EQUAL_INT(0, get(out, 0x09, 1), "Live button released");
+    TEST_ASSERT_EQUAL_INT(1, get(out, 0x09, 2), "Injected button still held");
+    TEST_ASSERT_EQUAL_INT(0, get(out, 0x01, 0x30), "Motion was consumed");
+
+    hurricane_hid_merge_release(&merge, 0x09, 2);
+    hurricane_hid_merge_build(&merge, out);
+    TEST_ASSERT_EQUAL_INT(0, get(out, 0x09, 2), "Injected button released");
+
+    // Motion beyond the logical range is carried over
+    hurricane_hid_merge_inject(&merge, 0x01, 0x38, 200);
+    hurricane_hid_merge_build(&merge, out);
+    TEST_ASSERT_EQUAL_INT(127, get(out, 0x01, 0x38), "Wheel saturates");
+    TEST_ASSERT(hurricane_hid_merge_pending(&merge), "Remainder is due");
+    hurricane_hid_merge_build(&merge, out);
+    TEST_ASSERT_EQUAL_INT(73, get(out, 0x01, 0x38), "Remainder follows");
+    TEST_ASSERT(!hurricane_hid_merge_pending(&merge), "Nothing left");
+
+    TEST_PASS();
+}
+
+int test_hid_merge_keyboard_and_absolute(void)
+{
+    int32_t live[HURRICANE_HID_MAX_DECODE_VALUES];
+    int32_t out[HURRICANE_HID_MAX_DECODE_VALUES];
+    uint8_t report[16];
+
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_keyboard, hid_desc_boot_keyboard_size, &layout);
+    hurricane_hid_pack_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 0, &plan);
+    hurricane_hid_merge_init(&merge, &layout, &plan);
+
+    // Live: Left Shift + 'a'; injected: Left Ctrl + 'a' + 'b'
+    memset(live, 0, sizeof(live));
+    set(live, 0x07, 0xE1, 1);
+    set(live, 0x07, 0x04, 1);
+    hurricane_hid_merge_live(&merge, live);
+    hurricane_hid_merge_inject(&merge, 0x07, 0xE0, 1);
+    hurricane_hid_merge_inject(&merge, 0x07, 0x04, 1);
+    hurricane_hid_merge_inject(&merge, 0x07, 0x05, 1);
+
+    hurricane_hid_merge_build(&merge, out);
+    TEST_ASSERT_EQUAL_INT(8, hurricane_hid_pack(&plan, out, report, sizeof(report)), "Boot keyboard report");
+    TEST_ASSERT_EQUAL_INT(0x03, report[0], "Modifiers are ORed");
+    TEST_ASSERT_EQUAL_INT(0x04, report[2], "Live key first");
+    TEST_ASSERT_EQUAL_INT(0x05, report[3], "Injected key added once");
+    TEST_ASSERT_EQUAL_INT(0x00, report[4], "No duplicate of the shared key");
+
+    // A full live rollover keeps the live keys
+    for (uint16_t key = 0x10; key < 0x16; key++) {
+        set(live, 0x07, key, 1);
+    }
+    hurricane_hid_merge_live(&merge, live);
+    hurricane_hid_merge_build(&merge, out);
+    hurricane_hid_pack(&plan, out, report, sizeof(report));
+    TEST_ASSERT_EQUAL_INT(0x04, report[2], "Live keys are kept");
+
+    // Absolute axes: the injected value overrides until released
+    hurricane_hid_parse_report_descriptor(absolute_pointer_desc, sizeof(absolute_pointer_desc), &layout);
+    hurricane_hid_pack_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 0, &plan);
+    hurricane_hid_merge_init(&merge, &layout, &plan);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_MERGE_OVERRIDE, merge.fields[1].kind, "X is absolute");
+
+    memset(live, 0, sizeof(live));
+    set(live, 0x01, 0x30, 1000);
+    hurricane_hid_merge_live(&merge, live);
+    hurricane_hid_merge_live(&merge, live);
+    hurricane_hid_merge_build(&merge, out);
+    TEST_ASSERT_EQUAL_INT(1000, get(out, 0x01, 0x30), "Absolute values are not summed");
+
+    hurricane_hid_merge_inject(&merge, 0x01, 0x30, 2048);
+    hurricane_hid_merge_live(&merge, live);
+    hurricane_hid_merge_build(&merge, out);
+    TEST_ASSERT_EQUAL_INT(2048, get(out, 0x01, 0x30), "Injected position wins");
+
+    hurricane_hid_merge_release(&merge, 0x01, 0x30);
+    hurricane_hid_merge_build(&merge, out);
+    TEST_ASSERT_EQUAL_INT(1000, get(out, 0x01, 0x30), "Live position is back");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_merge(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_hid_merge_mouse);
+    RUN_TEST(test_hid_merge_keyboard_and_absolute);
+
+    return failures;
+}
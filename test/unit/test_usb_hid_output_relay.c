@@ -0,0 +1,165 @@
+// tests/unit/test_usb_hid_output_relay.c
+
+#include "../common/test_common.h"
+#include "usb/usb_hid_output_relay.h"
+#include "core/usb_host_control_queue.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Defined in the dummy HAL
+extern hurricane_usb_setup_packet_t last_setup_sent;
+extern uint8_t last_control_data_sent[64];
+extern size_t last_control_data_length;
+extern uint8_t last_interrupt_out_endpoint;
+extern uint8_t last_interrupt_out_data[64];
+extern size_t last_interrupt_out_length;
+extern int interrupt_out_count;
+extern int control_transfer_failures;
+extern int interrupt_out_failures;
+
+// --- Unit Tests ---
+
+int test_output_relay_suppresses_duplicates(void)
+{
+    hurricane_hid_output_relay_t relay;
+    hurricane_hid_output_relay_init(&relay, 0, 0x02, 0);
+    interrupt_out_count = 0;
+
+    uint8_t leds = 0x02;
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_OUTPUT_SENT,
+                          hurricane_hid_output_relay_submit(&relay, 0, &leds, 1, 0),
+                          "First report should be forwarded");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_OUTPUT_DUPLICATE,
+                          hurricane_hid_output_relay_submit(&relay, 0, &leds, 1, 100),
+                          "Unchanged report should be dropped");
+    TEST_ASSERT_EQUAL_INT(1, interrupt_out_count, "Only one transfer should reach the device");
+    TEST_ASSERT_EQUAL_INT(0x02, last_interrupt_out_endpoint, "Interrupt OUT endpoint should be used");
+    TEST_ASSERT_EQUAL_INT(1, (int)relay.duplicates, "Duplicate should be counted");
+
+    // Different report IDs are tracked independently and carry their ID byte
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_OUTPUT_SENT,
+                          hurricane_hid_output_relay_submit(&relay, 5, &leds, 1, 200),
+                          "Same payload on another report ID should be forwarded");
+    TEST_ASSERT_EQUAL_INT(2, (int)last_interrupt_out_length, "Report ID byte should be prefixed");
+    TEST_ASSERT_EQUAL_INT(5, last_interrupt_out_data[0], "Report ID should lead the transfer");
+
+    TEST_PASS();
+}
+
+int test_output_relay_coalesces_within_window(void)
+{
+    hurricane_hid_output_relay_t relay;
+    hurricane_hid_output_relay_init(&relay, 0, 0x02, 10);
+    interrupt_out_count = 0;
+
+    uint8_t leds[] = {0x01, 0x03, 0x07};
+    hurricane_hid_output_relay_submit(&relay, 0, &leds[0], 1, 0);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_OUTPUT_DEFERRED,
+                          hurricane_hid_output_relay_submit(&relay, 0, &leds[1], 1, 2),
+                          "Change inside the window should be deferred");
+    hurricane_hid_output_relay_submit(&relay, 0, &leds[2], 1, 4);
+
+    hurricane_hid_output_relay_task(&relay, 8);
+    TEST_ASSERT_EQUAL_INT(1, interrupt_out_count, "Nothing should be sent before the window elapses");
+
+    hurricane_hid_output_relay_task(&relay, 10);
+    TEST_ASSERT_EQUAL_INT(2, interrupt_out_count, "The burst should collapse into one transfer");
+    TEST_ASSERT_EQUAL_INT(0x07, last_interrupt_out_data[0], "Only the newest state should be sent");
+
+    // A burst that ends where it started never reaches the device
+    hurricane_hid_output_relay_submit(&relay, 0, &leds[0], 1, 12);
+    hurricane_hid_output_relay_submit(&relay, 0, &leds[2], 1, 14);
+    hurricane_hid_output_relay_task(&relay, 30);
+    TEST_ASSERT_EQUAL_INT(2, interrupt_out_count, "Toggled-back state should be dropped");
+
+    TEST_PASS();
+}
+
+int test_output_relay_set_report_fallback(void)
+{
+    hurricane_hid_output_relay_t relay;
+    hurricane_hid_output_relay_init(&relay, 1, 0, 0);
+    interrupt_out_count = 0;
+
+    uint8_t leds = 0x04;
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_OUTPUT_SENT,
+                          hurricane_hid_output_relay_submit(&relay, 0, &leds, 1, 0),
+                          "Report should be queued on EP0");
+    TEST_ASSERT(hurricane_host_control_pending(&relay.request), "SET_REPORT should not block the caller");
+
+    uint8_t next = 0x05;
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_OUTPUT_DEFERRED,
+                          hurricane_hid_output_relay_submit(&relay, 0, &next, 1, 1),
+                          "Second report should wait for the in-flight SET_REPORT");
+
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(0x09, last_setup_sent.bRequest, "SET_REPORT should be issued");
+    TEST_ASSERT_EQUAL_INT(0x0200, last_setup_sent.wValue, "Output report type with ID 0");
+    TEST_ASSERT_EQUAL_INT(1, last_setup_sent.wIndex, "Interface number should be the target");
+    TEST_ASSERT_EQUAL_INT(0x04, last_control_data_sent[0], "LED state should be in the data stage");
+
+    hurricane_hid_output_relay_task(&relay, 2);
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(0x05, last_control_data_sent[0], "Deferred report should follow");
+    TEST_ASSERT_EQUAL_INT(0, interrupt_out_count, "No interrupt OUT without an endpoint");
+
+    TEST_PASS();
+}
+
+int test_output_relay_retries_failed_report(void)
+{
+    hurricane_hid_output_relay_t relay;
+    hurricane_hid_output_relay_init(&relay, 0, 0x02, 10);
+    interrupt_out_count = 0;
+
+    // Interrupt OUT fails once: the report stays pending and goes out one window later
+    uint8_t leds = 0x02;
+    interrupt_out_failures = 1;
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_OUTPUT_DEFERRED,
+                          hurricane_hid_output_relay_submit(&relay, 0, &leds, 1, 0),
+                          "Failed transfer leaves the report pending");
+    TEST_ASSERT_EQUAL_INT(0, interrupt_out_count, "Nothing reached the device");
+    hurricane_hid_output_relay_task(&relay, 5);
+    TEST_ASSERT_EQUAL_INT(0, interrupt_out_count, "Retry waits for the window");
+    hurricane_hid_output_relay_task(&relay, 10);
+    TEST_ASSERT_EQUAL_INT(1, interrupt_out_count, "Retry succeeds");
+    TEST_ASSERT_EQUAL_INT(0x02, last_interrupt_out_data[0], "Failed report delivered");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_OUTPUT_DUPLICATE,
+                          hurricane_hid_output_relay_submit(&relay, 0, &leds, 1, 30),
+                          "Delivered report is a duplicate again");
+
+    // SET_REPORT fails once: the completion puts the report back for the task
+    hurricane_hid_output_relay_init(&relay, 1, 0, 10);
+    hurricane_host_control_cancel_all();
+    leds = 0x04;
+    control_transfer_failures = 1;
+    hurricane_hid_output_relay_submit(&relay, 0, &leds, 1, 100);
+    hurricane_host_control_task();
+    TEST_ASSERT(!hurricane_host_control_pending(&relay.request), "SET_REPORT completed");
+    TEST_ASSERT(relay.slots[0].pending, "Failed SET_REPORT is pending again");
+
+    memset(last_control_data_sent, 0, sizeof(last_control_data_sent));
+    hurricane_hid_output_relay_task(&relay, 110);
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(0x09, last_setup_sent.bRequest, "SET_REPORT reissued");
+    TEST_ASSERT_EQUAL_INT(0x04, last_control_data_sent[0], "Failed report delivered");
+    TEST_ASSERT(!relay.slots[0].pending, "Nothing left to send");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_output_relay(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_output_relay_suppresses_duplicates);
+    RUN_TEST(test_output_relay_coalesces_within_window);
+    RUN_TEST(test_output_relay_set_report_fallback);
+    RUN_TEST(test_output_relay_retries_failed_report);
+
+    return failures;
+}
@@ -0,0 +1,104 @@
+// tests/unit/test_usb_hid_pack.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "usb/usb_hid_pack.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_hid_layout_t layout;
+static hurricane_hid_pack_plan_t pack;
+static hurricane_hid_decode_plan_t decode;
+
+// --- Unit Tests ---
+
+int test_hid_pack_boot_keyboard(void)
+{
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES] = {0};
+    uint8_t report[8];
+    const uint8_t expected[8] = { 0x02, 0x00, 0x0B, 0x08, 0x00, 0x00, 0x00, 0x00 };
+
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_keyboard, hid_desc_boot_keyboard_size, &layout);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pack_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 0, &pack),
+                          "Plan should build");
+
+    // Left Shift + 'h' + 'e'
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pack_set_usage(&pack, &layout, values, 0x07, 0xE1, 1), "Shift");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pack_set_usage(&pack, &layout, values, 0x07, 0x0B, 1), "Key h");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pack_set_usage(&pack, &layout, values, 0x07, 0x08, 1), "Key e");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pack_set_usage(&pack, &layout, values, 0x07, 0x0B, 1),
+                          "Pressing a held key again is a no-op");
+
+    TEST_ASSERT_EQUAL_INT(8, hurricane_hid_pack(&pack, values, report, sizeof(report)), "Report is 8 bytes");
+    TEST_ASSERT(memcmp(report, expected, sizeof(expected)) == 0, "Boot keyboard report layout");
+
+    hurricane_hid_pack_set_usage(&pack, &layout, values, 0x07, 0x0B, 0);
+    hurricane_hid_pack(&pack, values, report, sizeof(report));
+    TEST_ASSERT_EQUAL_INT(0x00, report[2], "Released key leaves its slot");
+    TEST_ASSERT_EQUAL_INT(0x08, report[3], "Other key stays pressed");
+
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PACK_ERR_NO_USAGE,
+                          hurricane_hid_pack_set_usage(&pack, &layout, values, 0x01, 0x30, 5),
+                          "Keyboard has no X axis");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PACK_ERR_NO_SPACE, hurricane_hid_pack(&pack, values, report, 4),
+                          "Short buffer should be rejected");
+
+    TEST_PASS();
+}
+
+int test_hid_pack_roundtrip_and_clamp(void)
+{
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES] = {0};
+    int32_t decoded[HURRICANE_HID_MAX_DECODE_VALUES];
+    uint8_t report[16];
+
+    hurricane_hid_parse_report_descriptor(hid_desc_gaming_mouse, hid_desc_gaming_mouse_size, &layout);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pack_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 1, &pack),
+                          "Pack plan should build");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 1, &decode),
+                          "Decode plan should build");
+    TEST_ASSERT_EQUAL_INT(decode.num_values, pack.num_values, "Pack and decode share the value layout");
+
+    hurricane_hid_pack_set_usage(&pack, &layout, values, 0x09, 1, 1);
+    hurricane_hid_pack_set_usage(&pack, &layout, values, 0x09, 12, 1);
+    hurricane_hid_pack_set_usage(&pack, &layout, values, 0x01, 0x30, -1234);
+    hurricane_hid_pack_set_usage(&pack, &layout, values, 0x01, 0x31, 100000);   // Clamped to 32767
+    hurricane_hid_pack_set_usage(&pack, &layout, values, 0x01, 0x38, -500);     // Clamped to -127
+    hurricane_hid_pack_set_usage(&pack, &layout, values, 0x0C, 0x238, 3);
+
+    TEST_ASSERT_EQUAL_INT(9, hurricane_hid_pack(&pack, values, report, sizeof(report)), "ID byte + 8 byte payload");
+    TEST_ASSERT_EQUAL_INT(1, report[0], "Report ID is written first");
+
+    hurricane_hid_decode(&decode, report + 1, 8, decoded);
+    TEST_ASSERT_EQUAL_INT(0x0801, decoded[0], "Buttons 1 and 12");
+    TEST_ASSERT_EQUAL_INT(-1234, decoded[1], "X round trips");
+    TEST_ASSERT_EQUAL_INT(32767, decoded[2], "Y saturates at logical max");
+    TEST_ASSERT_EQUAL_INT(-127, decoded[3], "Wheel saturates at logical min");
+    TEST_ASSERT_EQUAL_INT(3, decoded[4], "AC Pan");
+
+    // Arrays write 0 (no usage) for out of range values instead of clamping
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pack_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 3, &pack),
+                          "Consumer plan should build");
+    memset(values, 0, sizeof(values));
+    values[0] = 0x00E9;     // Volume Up
+    values[1] = 5000;       // Out of range
+    hurricane_hid_pack(&pack, values, report, sizeof(report));
+    TEST_ASSERT_EQUAL_INT(0xE9, report[1], "In range array value");
+    TEST_ASSERT_EQUAL_INT(0, report[3] | report[4], "Out of range array value is null");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_pack(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_hid_pack_boot_keyboard);
+    RUN_TEST(test_hid_pack_roundtrip_and_clamp);
+
+    return failures;
+}
@@ -0,0 +1,163 @@
+// tests/unit/test_usb_hid_parser.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "usb/usb_hid_parser.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_hid_layout_t layout;
+
+// --- Unit Tests ---
+
+int test_hid_parser_boot_keyboard(void)
+{
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PARSE_OK,
+                          hurricane_hid_parse_report_descriptor(hid_desc_boot_keyboard,
+                                                                hid_desc_boot_keyboard_size, &layout),
+                          "Boot keyboard descriptor should parse");
+    TEST_ASSERT(!layout.uses_report_ids, "Boot keyboard has no report IDs");
+    TEST_ASSERT_EQUAL_INT(2, layout.num_reports, "Expected an input and an output report");
+
+    const hurricane_hid_report_info_t* input = hurricane_hid_layout_find_report(&layout, HURRICANE_HID_REPORT_INPUT, 0);
+    TEST_ASSERT(input != NULL, "Input report should exist");
+    TEST_ASSERT_EQUAL_INT(64, input->bit_length, "Input report is 8 bytes");
+    TEST_ASSERT_EQUAL_INT(2, input->num_fields, "Modifiers and key array; the reserved byte is padding");
+    TEST_ASSERT_EQUAL_INT(0x06, input->application_usage, "Application collection is Keyboard");
+
+    const hurricane_hid_field_t* mods = hurricane_hid_layout_find_field(&layout, HURRICANE_HID_REPORT_INPUT, 0x07, 0xE1);
+    TEST_ASSERT(mods != NULL, "Left Shift should be found in the modifier range");
+    TEST_ASSERT_EQUAL_INT(0, mods->bit_offset, "Modifiers start the report");
+    TEST_ASSERT_EQUAL_INT(8, mods->count, "Eight modifier bits");
+
+    const hurricane_hid_field_t* keys = hurricane_hid_layout_find_field(&layout, HURRICANE_HID_REPORT_INPUT, 0x07, 0x04);
+    TEST_ASSERT(keys != NULL, "Key array should cover usage 'a'");
+    TEST_ASSERT(!(keys->flags & HURRICANE_HID_FIELD_VARIABLE), "Keys are an array");
+    TEST_ASSERT_EQUAL_INT(16, keys->bit_offset, "Keys follow the reserved byte");
+    TEST_ASSERT_EQUAL_INT(6, keys->count, "Six key slots");
+    TEST_ASSERT_EQUAL_INT(101, keys->logical_max, "Logical maximum of the key array");
+
+    const hurricane_hid_report_info_t* leds = hurricane_hid_layout_find_report(&layout, HURRICANE_HID_REPORT_OUTPUT, 0);
+    TEST_ASSERT(leds != NULL, "LED output report should exist");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_report_payload_size(leds), "LED report is padded to one byte");
+
+    TEST_PASS();
+}
+
+int test_hid_parser_boot_mouse_read(void)
+{
+    const uint8_t report[] = { 0x05, 0xFE, 0x03 };
+
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PARSE_OK,
+                          hurricane_hid_parse_report_descriptor(hid_desc_boot_mouse,
+                                                                hid_desc_boot_mouse_size, &layout),
+                          "Boot mouse descriptor should parse");
+
+    const hurricane_hid_field_t* buttons = hurricane_hid_layout_find_field(&layout, HURRICANE_HID_REPORT_INPUT, 0x09, 1);
+    const hurricane_hid_field_t* x = hurricane_hid_layout_find_field(&layout, HURRICANE_HID_REPORT_INPUT, 0x01, 0x30);
+    const hurricane_hid_field_t* y = hurricane_hid_layout_find_field(&layout, HURRICANE_HID_REPORT_INPUT, 0x01, 0x31);
+    TEST_ASSERT(buttons && x && y, "Buttons, X and Y should be found");
+    TEST_ASSERT(x != y, "X and Y are separate records");
+    TEST_ASSERT_EQUAL_INT(8, x->bit_offset, "X follows the padded button byte");
+
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_field_read(buttons, report, sizeof(report), 0), "Button 1 pressed");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_field_read(buttons, report, sizeof(report), 1), "Button 2 released");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_field_read(buttons, report, sizeof(report), 2), "Button 3 pressed");
+    TEST_ASSERT_EQUAL_INT(-2, hurricane_hid_field_read(x, report, sizeof(report), 0), "X is sign extended");
+    TEST_ASSERT_EQUAL_INT(3, hurricane_hid_field_read(y, report, sizeof(report), 0), "Y value");
+
+    TEST_PASS();
+}
+
+int test_hid_parser_gaming_mouse_report_ids(void)
+{
+    // Report 1 payload: buttons 0x0201, X = -300, Y = 1000, wheel -1, pan 2
+    const uint8_t payload[] = { 0x01, 0x02, 0xD4, 0xFE, 0xE8, 0x03, 0xFF, 0x02 };
+
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PARSE_OK,
+                          hurricane_hid_parse_report_descriptor(hid_desc_gaming_mouse,
+                                                                hid_desc_gaming_mouse_size, &layout),
+                          "Gaming mouse descriptor should parse");
+    TEST_ASSERT(layout.uses_report_ids, "Descriptor uses report IDs");
+
+    const hurricane_hid_report_info_t* mouse = hurricane_hid_layout_find_report(&layout, HURRICANE_HID_REPORT_INPUT, 1);
+    const hurricane_hid_report_info_t* consumer = hurricane_hid_layout_find_report(&layout, HURRICANE_HID_REPORT_INPUT, 3);
+    TEST_ASSERT(mouse && consumer, "Both reports should exist");
+    TEST_ASSERT_EQUAL_INT(8, hurricane_hid_report_payload_size(mouse), "Mouse payload is 8 bytes");
+    TEST_ASSERT_EQUAL_INT(0x0C, consumer->application_page, "Report 3 belongs to Consumer Control");
+
+    const hurricane_hid_field_t* x = hurricane_hid_layout_find_field(&layout, HURRICANE_HID_REPORT_INPUT, 0x01, 0x30);
+    const hurricane_hid_field_t* wheel = hurricane_hid_layout_find_field(&layout, HURRICANE_HID_REPORT_INPUT, 0x01, 0x38);
+    const hurricane_hid_field_t* pan = hurricane_hid_layout_find_field(&layout, HURRICANE_HID_REPORT_INPUT, 0x0C, 0x238);
+    const hurricane_hid_field_t* buttons = hurricane_hid_layout_find_field(&layout, HURRICANE_HID_REPORT_INPUT, 0x09, 10);
+    TEST_ASSERT(x && wheel && pan && buttons, "All mouse fields should be found");
+    TEST_ASSERT_EQUAL_INT(16, x->bit_size, "X is 16 bits wide");
+    TEST_ASSERT_EQUAL_INT(1, x->report_id, "X belongs to report 1");
+
+    const hurricane_hid_field_t* y = x + 1;
+    TEST_ASSERT_EQUAL_INT(0x31, y->usage, "Fields of a report are contiguous");
+    TEST_ASSERT_EQUAL_INT(-300, hurricane_hid_field_read(x, payload, sizeof(payload), 0), "16-bit X");
+    TEST_ASSERT_EQUAL_INT(1000, hurricane_hid_field_read(y, payload, sizeof(payload), 0), "16-bit Y");
+    TEST_ASSERT_EQUAL_INT(-1, hurricane_hid_field_read(wheel, payload, sizeof(payload), 0), "Wheel");
+    TEST_ASSERT_EQUAL_INT(2, hurricane_hid_field_read(pan, payload, sizeof(payload), 0), "AC Pan");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_field_read(buttons, payload, sizeof(payload), 9), "Button 10 pressed");
+
+    // A short report reads as released / no motion
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_field_read(wheel, payload, 4, 0), "Missing bytes read as zero");
+
+    TEST_PASS();
+}
+
+int test_hid_parser_push_pop_and_errors(void)
+{
+    const uint8_t pushed[] = {
+        0x05, 0x01, 0x09, 0x02, 0xA1, 0x01,
+        0x75, 0x08, 0x95, 0x01, 0x15, 0x81, 0x25, 0x7F,
+        0xA4,                   // Push
+        0x75, 0x10,             //   Report Size (16)
+        0x09, 0x30, 0x81, 0x06, //   X, 16 bits
+        0xB4,                   // Pop
+        0x09, 0x31, 0x81, 0x06, // Y, back to 8 bits
+        0xC0
+    };
+    const uint8_t underflow[] = { 0xB4 };
+    const uint8_t truncated[] = { 0x05, 0x01, 0x26, 0xFF };
+    const uint8_t unbalanced[] = { 0x09, 0x02, 0xA1, 0x01 };
+
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PARSE_OK,
+                          hurricane_hid_parse_report_descriptor(pushed, sizeof(pushed), &layout),
+                          "Push/pop descriptor should parse");
+    const hurricane_hid_field_t* y = hurricane_hid_layout_find_field(&layout, HURRICANE_HID_REPORT_INPUT, 0x01, 0x31);
+    TEST_ASSERT(y != NULL, "Y should be found");
+    TEST_ASSERT_EQUAL_INT(8, y->bit_size, "Pop should restore the report size");
+    TEST_ASSERT_EQUAL_INT(16, y->bit_offset, "Y follows the 16-bit X");
+
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PARSE_ERR_STACK,
+                          hurricane_hid_parse_report_descriptor(underflow, sizeof(underflow), &layout),
+                          "Pop without push should fail");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PARSE_ERR_TRUNCATED,
+                          hurricane_hid_parse_report_descriptor(truncated, sizeof(truncated), &layout),
+                          "Truncated item should fail");
+    TEST_ASSERT_EQUAL_INT(0, layout.num_fields, "Failed parse leaves the layout empty");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PARSE_ERR_COLLECTION,
+                          hurricane_hid_parse_report_descriptor(unbalanced, sizeof(unbalanced), &layout),
+                          "Unbalanced collection should fail");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_parser(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_hid_parser_boot_keyboard);
+    RUN_TEST(test_hid_parser_boot_mouse_read);
+    RUN_TEST(test_hid_parser_gaming_mouse_report_ids);
+    RUN_TEST(test_hid_parser_push_pop_and_errors);
+
+    return failures;
+}
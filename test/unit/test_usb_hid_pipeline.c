@@ -0,0 +1,168 @@
+// tests/unit/test_usb_hid_pipeline.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "../common/hid_gaming_mouse_reports.h"
+#include "usb/usb_hid_pipeline.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Defined in the dummy HAL
+extern uint8_t last_interrupt_in_endpoint;
+extern uint8_t last_interrupt_in_data[65];
+extern uint16_t last_interrupt_in_length;
+extern int interrupt_in_count;
+
+// NKRO keyboard: modifiers plus a bitfield for usages 0x04-0x73
+static const uint8_t nkro_keyboard[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01,
+    0x05, 0x07, 0x19, 0xE0, 0x29, 0xE7, 0x15, 0x00, 0x25, 0x01,
+    0x75, 0x01, 0x95, 0x08, 0x81, 0x02,
+    0x19, 0x04, 0x29, 0x73, 0x95, 0x70, 0x81, 0x02,
+    0xC0
+};
+
+static hurricane_hid_pipeline_t pipeline;
+
+static bool sent(uint8_t endpoint, const uint8_t* expected, uint16_t length)
+{
+    return last_interrupt_in_endpoint == endpoint && last_interrupt_in_length == length &&
+           memcmp(last_interrupt_in_data, expected, length) == 0;
+}
+
+// --- Unit Tests ---
+
+int test_pipeline_mouse(void)
+{
+    static const hurricane_hid_transform_rule_t rules[] = {
+        { .op = HURRICANE_HID_XFORM_INVERT, .usage_page = 0x01, .usage = 0x31 },
+    };
+    hurricane_hid_pipe_config_t pipe = {
+        .source_page = 0x01, .source_usage = 0x02, .sink_endpoint = 0x81, .flags = HURRICANE_HID_PIPE_DELTA,
+        .rules = rules, .num_rules = 1,
+        .sink_descriptor = hid_desc_boot_mouse, .sink_descriptor_length = hid_desc_boot_mouse_size
+    };
+    hurricane_hid_pipeline_config_t config = { .pipes = &pipe, .num_pipes = 1 };
+    uint8_t report[GAMING_MOUSE_INPUT1_SIZE] = { GAMING_MOUSE_INPUT1_ID };
+    uint8_t consumer[GAMING_MOUSE_INPUT3_SIZE] = { GAMING_MOUSE_INPUT3_ID };
+
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pipeline_init(&pipeline, &config), "Init");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PIPELINE_ERR_NO_ROUTE,
+                          hurricane_hid_pipeline_submit(&pipeline, report, sizeof(report), 0), "Nothing attached");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_pipeline_attach(&pipeline, hid_desc_gaming_mouse, hid_desc_gaming_mouse_size),
+                          "Mouse report found");
+
+    // 16 buttons and 16-bit axes into the boot mouse's 3 buttons and 8-bit axes, Y inverted
+    gaming_mouse_input1_set_button1(report, 1);
+    gaming_mouse_input1_set_button2(report, 1);
+    gaming_mouse_input1_set_button16(report, 1);
+    gaming_mouse_input1_set_x(report, 5);
+    gaming_mouse_input1_set_y(report, 3);
+    gaming_mouse_input1_set_wheel(report, 1);
+    interrupt_in_count = 0;
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pipeline_submit(&pipeline, report, sizeof(report), 0), "Pipe 0");
+    TEST_ASSERT(sent(0x81, (const uint8_t[]){ 0x03, 5, 0xFD }, 3), "Boot mouse report sent");
+
+    // Buttons held without motion: the second copy is suppressed
+    gaming_mouse_input1_set_x(report, 0);
+    gaming_mouse_input1_set_y(report, 0);
+    hurricane_hid_pipeline_submit(&pipeline, report, sizeof(report), 10);
+    hurricane_hid_pipeline_submit(&pipeline, report, sizeof(report), 20);
+    TEST_ASSERT_EQUAL_INT(2, interrupt_in_count, "Unchanged report dropped");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PIPELINE_ERR_NO_ROUTE,
+                          hurricane_hid_pipeline_submit(&pipeline, consumer, sizeof(consumer), 30),
+                          "Consumer report has no pipe");
+
+    // Motion beyond the sink's range goes out over the next polls
+    gaming_mouse_input1_set_x(report, 300);
+    hurricane_hid_pipeline_submit(&pipeline, report, sizeof(report), 40);
+    TEST_ASSERT(sent(0x81, (const uint8_t[]){ 0x03, 127, 0 }, 3), "First part");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_pipeline_run(&pipeline, 41), "Carry sent");
+    TEST_ASSERT(sent(0x81, (const uint8_t[]){ 0x03, 127, 0 }, 3), "Second part");
+    hurricane_hid_pipeline_run(&pipeline, 42);
+    TEST_ASSERT(sent(0x81, (const uint8_t[]){ 0x03, 46, 0 }, 3), "Rest");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pipeline_run(&pipeline, 43), "Nothing pending");
+
+    // Unplugging the mouse releases its buttons on the PC
+    hurricane_hid_pipeline_detach(&pipeline);
+    TEST_ASSERT(sent(0x81, (const uint8_t[]){ 0, 0, 0 }, 3), "Release report");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PIPELINE_ERR_NO_ROUTE,
+                          hurricane_hid_pipeline_submit(&pipeline, report, sizeof(report), 50), "Detached");
+
+    TEST_PASS();
+}
+
+int test_pipeline_nkro_keyboard(void)
+{
+    hurricane_hid_pipe_config_t pipe = {
+        .source_page = 0x01, .source_usage = 0x06, .sink_endpoint = 0x82, .flags = HURRICANE_HID_PIPE_DEFER,
+        .sink_descriptor = hid_desc_boot_keyboard, .sink_descriptor_length = hid_desc_boot_keyboard_size
+    };
+    hurricane_hid_pipeline_config_t config = { .pipes = &pipe, .num_pipes = 1 };
+    uint8_t report[15] = { 0 };
+
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pipeline_init(&pipeline, &config), "Init");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_pipeline_attach(&pipeline, nkro_keyboard, sizeof(nkro_keyboard)),
+                          "Keyboard report found");
+    hurricane_hid_pipeline_set_profiling(&pipeline, true);
+
+    // Left Shift, A, B and Enter from the bitmap into the boot keyboard's key array
+    report[0] = 0x02;
+    report[1] = 0x03;
+    report[5] = 0x10;
+    interrupt_in_count = 0;
+    hurricane_hid_pipeline_submit(&pipeline, report, sizeof(report), 0);
+    TEST_ASSERT_EQUAL_INT(0, interrupt_in_count, "Deferred until the next run");
+    TEST_ASSERT_EQUAL_INT(1, hurricane_hid_pipeline_run(&pipeline, 1), "Sent on run");
+    TEST_ASSERT(sent(0x82, (const uint8_t[]){ 0x02, 0, 0x04, 0x05, 0x28, 0, 0, 0 }, 8), "Boot keyboard report");
+
+    const hurricane_hid_pipe_t* p = &pipeline.pipes[0];
+    TEST_ASSERT_EQUAL_INT(1, (int)p->runs[HURRICANE_HID_PIPE_STAGE_DECODE], "Decode timed");
+    TEST_ASSERT_EQUAL_INT(0, (int)p->runs[HURRICANE_HID_PIPE_STAGE_TRANSFORM], "No transform to time");
+    TEST_ASSERT_EQUAL_INT(1, (int)p->runs[HURRICANE_HID_PIPE_STAGE_SINK], "Sink timed");
+
+    // Injected keys join the relayed ones
+    hurricane_hid_merge_inject(&pipeline.merges[0], 0x07, 0x06, 1);
+    hurricane_hid_pipeline_run(&pipeline, 2);
+    TEST_ASSERT(sent(0x82, (const uint8_t[]){ 0x02, 0, 0x04, 0x05, 0x28, 0x06, 0, 0 }, 8), "Injected C");
+
+    TEST_PASS();
+}
+
+int test_pipeline_route_conflict(void)
+{
+    const hurricane_hid_pipe_config_t pipes[] = {
+        { .source_page = 0x01, .source_usage = 0x02, .sink_endpoint = 0x81,
+          .sink_descriptor = hid_desc_boot_mouse, .sink_descriptor_length = hid_desc_boot_mouse_size },
+        { .source_page = 0x01, .source_usage = 0x02, .sink_endpoint = 0x83,
+          .sink_descriptor = hid_desc_boot_mouse, .sink_descriptor_length = hid_desc_boot_mouse_size },
+    };
+    hurricane_hid_pipeline_config_t config = { .pipes = pipes, .num_pipes = 2 };
+    uint8_t report[GAMING_MOUSE_INPUT1_SIZE] = { GAMING_MOUSE_INPUT1_ID };
+
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_pipeline_init(&pipeline, &config), "Init");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PIPELINE_ERR_CONFLICT,
+                          hurricane_hid_pipeline_attach(&pipeline, hid_desc_gaming_mouse, hid_desc_gaming_mouse_size),
+                          "Both pipes take the mouse report");
+    TEST_ASSERT(!pipeline.source.attached && !pipeline.source.pipes[0].active && !pipeline.source.pipes[1].active,
+                "Nothing attached");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_PIPELINE_ERR_NO_ROUTE,
+                          hurricane_hid_pipeline_submit(&pipeline, report, sizeof(report), 0), "Nothing routed");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_pipeline(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_pipeline_mouse);
+    RUN_TEST(test_pipeline_nkro_keyboard);
+    RUN_TEST(test_pipeline_route_conflict);
+
+    return failures;
+}
@@ -0,0 +1,145 @@
+// tests/unit/test_usb_hid_transform.c
+
+#include "../common/test_common.h"
+#include "../common/hid_descriptors.h"
+#include "usb/usb_hid_transform.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_hid_layout_t layout;
+static hurricane_hid_decode_plan_t plan;
+static hurricane_hid_transform_t xf;
+
+// --- Unit Tests ---
+
+int test_hid_transform_mouse_rules(void)
+{
+    const hurricane_hid_transform_rule_t rules[] = {
+        { .op = HURRICANE_HID_XFORM_SCALE, .usage_page = 0x01, .usage = 0x30, .param = 3 * HURRICANE_HID_Q16_ONE / 2 },
+        { .op = HURRICANE_HID_XFORM_INVERT, .usage_page = 0x01, .usage = 0x38 },
+        { .op = HURRICANE_HID_XFORM_REMAP, .usage_page = 0x09, .usage = 4, .target_page = 0x09, .target_usage = 1 },
+        { .op = HURRICANE_HID_XFORM_REMAP, .usage_page = 0x0C, .usage = 0xE9, .target_page = 0x0C, .target_usage = 0xEA },
+    };
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES];
+    const int32_t expected_x[] = { 1, 2, 1, 2 };
+
+    hurricane_hid_parse_report_descriptor(hid_desc_gaming_mouse, hid_desc_gaming_mouse_size, &layout);
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 1, &plan);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_transform_compile(&xf, rules, 4, &layout, &plan),
+                          "Rules should compile");
+    TEST_ASSERT_EQUAL_INT(3, xf.num_steps, "The consumer rule belongs to another report");
+    TEST_ASSERT(hurricane_hid_transform_active(&xf), "Transform should be active");
+
+    // 1.5x on a steady 1 count motion: the half counts accumulate
+    for (int i = 0; i < 4; i++) {
+        memset(values, 0, sizeof(values));
+        values[0] = 0x0008;     // Button 4
+        values[1] = 1;          // X
+        values[3] = 5;          // Wheel
+        hurricane_hid_transform_run(&xf, values);
+        TEST_ASSERT_EQUAL_INT(expected_x[i], values[1], "Scaled X carries the fraction");
+    }
+    TEST_ASSERT_EQUAL_INT(-5, values[3], "Relative wheel is negated");
+    TEST_ASSERT_EQUAL_INT(0x0001, values[0], "Button 4 reports as button 1");
+
+    // Nothing in the consumer report is touched
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 3, &plan);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_transform_compile(&xf, rules, 2, &layout, &plan),
+                          "Mouse rules compile for the consumer report");
+    TEST_ASSERT(!hurricane_hid_transform_active(&xf), "No rule applies, the transform is skipped");
+
+    TEST_PASS();
+}
+
+int test_hid_transform_key_swap_and_deadzone(void)
+{
+    const hurricane_hid_transform_rule_t keys[] = {
+        { .op = HURRICANE_HID_XFORM_REMAP, .usage_page = 0x07, .usage = 0x39, .target_page = 0x07, .target_usage = 0xE0 },
+        { .op = HURRICANE_HID_XFORM_REMAP, .usage_page = 0x07, .usage = 0x04, .target_page = 0x07, .target_usage = 0x05 },
+        { .op = HURRICANE_HID_XFORM_REMAP, .usage_page = 0x07, .usage = 0x05, .target_page = 0x07, .target_usage = 0x04 },
+    };
+    // Gamepad stick: absolute 8-bit X/Y centered at 128
+    const uint8_t gamepad[] = {
+        0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+        0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x02,
+        0x09, 0x30, 0x09, 0x31, 0x81, 0x02,
+        0xC0
+    };
+    const hurricane_hid_transform_rule_t stick[] = {
+        { .op = HURRICANE_HID_XFORM_DEADZONE, .usage_page = 0x01, .usage = 0x30, .param = 10 },
+        { .op = HURRICANE_HID_XFORM_INVERT, .usage_page = 0x01, .usage = 0x31 },
+        { .op = HURRICANE_HID_XFORM_SWAP, .usage_page = 0x01, .usage = 0x30, .target_page = 0x01, .target_usage = 0x31 },
+    };
+    int32_t values[HURRICANE_HID_MAX_DECODE_VALUES] = {0};
+
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_keyboard, hid_desc_boot_keyboard_size, &layout);
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 0, &plan);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_transform_compile(&xf, keys, 3, &layout, &plan), "Key rules compile");
+
+    values[1] = 0x39;   // Caps Lock
+    values[2] = 0x04;   // A
+    values[3] = 0x05;   // B
+    hurricane_hid_transform_run(&xf, values);
+    TEST_ASSERT_EQUAL_INT(0x01, values[0], "Caps Lock reports as Left Control");
+    TEST_ASSERT(values[1] == 0x05 || values[2] == 0x05 || values[3] == 0x05, "A became B");
+    TEST_ASSERT(values[1] == 0x04 || values[2] == 0x04 || values[3] == 0x04, "B became A");
+    TEST_ASSERT(values[1] != 0x39 && values[2] != 0x39 && values[3] != 0x39, "Caps Lock is gone");
+
+    hurricane_hid_parse_report_descriptor(gamepad, sizeof(gamepad), &layout);
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 0, &plan);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_hid_transform_compile(&xf, stick, 3, &layout, &plan), "Stick rules compile");
+    hurricane_hid_transform_set_profiling(&xf, true);
+
+    values[0] = 135;    // Inside the dead zone
+    values[1] = 200;
+    hurricane_hid_transform_run(&xf, values);
+    TEST_ASSERT_EQUAL_INT(55, values[0], "X now carries the mirrored Y");
+    TEST_ASSERT_EQUAL_INT(128, values[1], "Y now carries the centered X");
+    TEST_ASSERT_EQUAL_INT(1, xf.steps[0].runs, "Profiling counts runs");
+
+    TEST_PASS();
+}
+
+int test_hid_transform_validation(void)
+{
+    const hurricane_hid_transform_rule_t scale_button[] = {
+        { .op = HURRICANE_HID_XFORM_SCALE, .usage_page = 0x09, .usage = 1, .param = HURRICANE_HID_Q16_ONE },
+    };
+    const hurricane_hid_transform_rule_t missing[] = {
+        { .op = HURRICANE_HID_XFORM_INVERT, .usage_page = 0x01, .usage = 0x32 },
+    };
+    const hurricane_hid_transform_rule_t bad_op[] = {
+        { .op = 0, .usage_page = 0x01, .usage = 0x30 },
+    };
+
+    hurricane_hid_parse_report_descriptor(hid_desc_boot_mouse, hid_desc_boot_mouse_size, &layout);
+    hurricane_hid_decode_plan_build(&layout, HURRICANE_HID_REPORT_INPUT, 0, &plan);
+
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_TRANSFORM_ERR_FIELD_TYPE,
+                          hurricane_hid_transform_compile(&xf, scale_button, 1, &layout, &plan),
+                          "Buttons cannot be scaled");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_TRANSFORM_ERR_NO_USAGE,
+                          hurricane_hid_transform_compile(&xf, missing, 1, &layout, &plan),
+                          "Boot mouse has no Z axis");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_HID_TRANSFORM_ERR_BAD_RULE,
+                          hurricane_hid_transform_compile(&xf, bad_op, 1, &layout, &plan),
+                          "Unknown op");
+    TEST_ASSERT(!hurricane_hid_transform_active(&xf), "A failed compile leaves nothing to run");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_hid_transform(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_hid_transform_mouse_rules);
+    RUN_TEST(test_hid_transform_key_swap_and_deadzone);
+    RUN_TEST(test_hid_transform_validation);
+
+    return failures;
+}
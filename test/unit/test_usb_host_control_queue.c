@@ -0,0 +1,138 @@
+// tests/unit/test_usb_host_control_queue.c
+
+#include "../common/test_common.h"
+#include "core/usb_host_control_queue.h"
+#include "core/hurricane_pt.h"
+#include "usb/usb_control.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// Defined in the dummy HAL
+extern hurricane_usb_setup_packet_t last_setup_sent;
+
+// --- Helpers ---
+
+typedef struct {
+    hurricane_pt_t pt;
+    hurricane_control_request_t request;
+    uint8_t buffer[18];
+    int steps_done;
+} test_flow_t;
+
+static HURRICANE_PT_THREAD(test_flow_thread(test_flow_t* flow))
+{
+    HURRICANE_PT_BEGIN(&flow->pt);
+
+    hurricane_host_control_prepare(&flow->request, 0x00, USB_REQ_SET_ADDRESS, 7, 0, NULL, 0);
+    HURRICANE_PT_CONTROL_TRANSFER(&flow->pt, &flow->request);
+    flow->steps_done++;
+
+    hurricane_host_control_prepare(&flow->request, 0x80, USB_REQ_GET_DESCRIPTOR,
+                                   (USB_DESC_TYPE_DEVICE << 8), 0,
+                                   flow->buffer, sizeof(flow->buffer));
+    HURRICANE_PT_CONTROL_TRANSFER(&flow->pt, &flow->request);
+    flow->steps_done++;
+
+    HURRICANE_PT_END(&flow->pt);
+}
+
+static int completed_count = 0;
+
+static void count_completion(hurricane_control_request_t* request)
+{
+    (void)request;
+    completed_count++;
+}
+
+// --- Unit Tests ---
+
+int test_control_queue_fifo_one_per_task(void)
+{
+    hurricane_control_request_t first = {0};
+    hurricane_control_request_t second = {0};
+
+    hurricane_host_control_prepare(&first, 0x00, USB_REQ_SET_ADDRESS, 3, 0, NULL, 0);
+    hurricane_host_control_prepare(&second, 0x00, USB_REQ_SET_ADDRESS, 4, 0, NULL, 0);
+    first.complete = count_completion;
+    second.complete = count_completion;
+    completed_count = 0;
+
+    TEST_ASSERT_EQUAL_INT(0, hurricane_host_control_submit(&first), "First submit should succeed");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_host_control_submit(&second), "Second submit should succeed");
+    TEST_ASSERT(hurricane_host_control_submit(&first) != 0, "Double submit should be rejected");
+
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(3, last_setup_sent.wValue, "First request should be issued first");
+    TEST_ASSERT(!hurricane_host_control_pending(&first), "First request should be complete");
+    TEST_ASSERT(hurricane_host_control_pending(&second), "Second request should still be queued");
+    TEST_ASSERT_EQUAL_INT(1, completed_count, "Exactly one completion per task call");
+
+    hurricane_host_control_task();
+    TEST_ASSERT_EQUAL_INT(4, last_setup_sent.wValue, "Second request should be issued next");
+    TEST_ASSERT_EQUAL_INT(HURRICANE_CONTROL_DONE, second.status, "Second request should be done");
+    TEST_ASSERT_EQUAL_INT(2, completed_count, "Both completions should have run");
+
+    TEST_PASS();
+}
+
+int test_control_queue_protothread_flows(void)
+{
+    test_flow_t flows[3];
+    bool finished[3] = {false, false, false};
+    memset(flows, 0, sizeof(flows));
+
+    int rounds = 0;
+    bool running = true;
+    while (running && rounds < 20) {
+        running = false;
+        for (int i = 0; i < 3; i++) {
+            if (finished[i]) {
+                continue;
+            }
+            if (HURRICANE_PT_SCHEDULE(test_flow_thread(&flows[i]))) {
+                running = true;
+            } else {
+                finished[i] = true;
+            }
+        }
+        hurricane_host_control_task();
+        rounds++;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(2, flows[i].steps_done, "Every flow should finish both steps");
+        TEST_ASSERT_EQUAL_INT(0x12, flows[i].buffer[0], "Descriptor should be received");
+    }
+    TEST_ASSERT(rounds > 2, "Flows should interleave instead of completing in one call");
+
+    TEST_PASS();
+}
+
+int test_control_queue_cancel_all(void)
+{
+    hurricane_control_request_t request = {0};
+    hurricane_host_control_prepare(&request, 0x00, USB_REQ_SET_ADDRESS, 9, 0, NULL, 0);
+
+    hurricane_host_control_submit(&request);
+    hurricane_host_control_cancel_all();
+
+    TEST_ASSERT_EQUAL_INT(HURRICANE_CONTROL_FAILED, request.status, "Cancelled request should fail");
+    TEST_ASSERT(request.result < 0, "Cancelled request should carry an error");
+
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_host_control_queue(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_control_queue_fifo_one_per_task);
+    RUN_TEST(test_control_queue_protothread_flows);
+    RUN_TEST(test_control_queue_cancel_all);
+
+    return failures;
+}
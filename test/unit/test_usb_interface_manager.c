@@ -2,7 +2,9 @@
 
 #include "../common/test_common.h"
 #include "core/usb_interface_manager.h"
+#include "core/hurricane_context.h"
 #include "hw/hurricane_hw_hal.h"
+#include "hw/hurricane_hw_ops.h"
 
 #include <stdio.h>
 #include <stdint.h>
@@ -16,6 +18,42 @@ static int endpoint_configured_count = 0;
 static uint8_t last_interface_num = 0xFF;
 static uint8_t last_ep_address = 0xFF;
 
+// Defined in the dummy HAL
+extern hurricane_usb_setup_packet_t last_device_response_setup;
+extern uint8_t last_device_response_data[64];
+extern uint16_t last_device_response_length;
+extern int device_response_count;
+extern uint8_t last_stalled_endpoint;
+
+// Control handler: answers GET_REPORT (0x01) at once, defers GET_IDLE (0x02)
+static void* control_buffer;
+
+static bool control_handler(hurricane_usb_setup_packet_t* setup, void* buffer, uint16_t* length)
+{
+    control_buffer = buffer;
+    if (setup->bRequest == 0x01) {
+        memset(buffer, 0xA5, 4);
+        *length = 4;
+        return true;
+    }
+    if (setup->bRequest == 0x02) {
+        *length = HURRICANE_CONTROL_DEFER;
+        return true;
+    }
+    return false;
+}
+
+// Context of the registry snapshot test; its attach callback changes the registry
+static hurricane_context_t snapshot_ctx;
+
+static void attach_adds_interface(void* device)
+{
+    hurricane_interface_descriptor_t desc = { .interface_num = 7, .interface_class = 3 };
+
+    (void)device;
+    hurricane_add_device_interface_ctx(&snapshot_ctx, 7, 3, 0, 0, &desc);
+}
+
 // Store original HAL functions
 static int (*original_configure_interface)(uint8_t, uint8_t, uint8_t, uint8_t);
 static int (*original_configure_endpoint)(uint8_t, uint8_t, uint8_t, uint16_t, uint8_t);
@@ -79,16 +117,14 @@ int test_interface_manager_init_deinit(void)
     // Test already initialized in setUp()
     
     // The interface should start with no interfaces registered
-    const hurricane_interface_descriptor_t* interface = hurricane_get_device_interface(0);
-    TEST_ASSERT(interface == NULL, "No interfaces should be registered after init");
+    TEST_ASSERT(!hurricane_get_device_interface(0, NULL), "No interfaces should be registered after init");
     
     // Call deinit and then init again to test re-initialization
     hurricane_interface_manager_deinit();
     hurricane_interface_manager_init();
     
     // Verify still no interfaces
-    interface = hurricane_get_device_interface(0);
-    TEST_ASSERT(interface == NULL, "No interfaces should be registered after re-init");
+    TEST_ASSERT(!hurricane_get_device_interface(0, NULL), "No interfaces should be registered after re-init");
     
     TEST_PASS();
 }
@@ -121,10 +157,10 @@ int test_add_device_interface(void)
     TEST_ASSERT_EQUAL_INT(1, last_interface_num, "Interface number should be 1");
     
     // Verify we can retrieve the interface
-    const hurricane_interface_descriptor_t* retrieved = hurricane_get_device_interface(1);
-    TEST_ASSERT(retrieved != NULL, "Should be able to retrieve added interface");
-    TEST_ASSERT_EQUAL_INT(3, retrieved->interface_class, "Interface class should match");
-    TEST_ASSERT_EQUAL_INT(INTERFACE_HANDLER_HID, retrieved->handler_type, "Handler type should match");
+    hurricane_interface_descriptor_t retrieved;
+    TEST_ASSERT(hurricane_get_device_interface(1, &retrieved), "Should be able to retrieve added interface");
+    TEST_ASSERT_EQUAL_INT(3, retrieved.interface_class, "Interface class should match");
+    TEST_ASSERT_EQUAL_INT(INTERFACE_HANDLER_HID, retrieved.handler_type, "Handler type should match");
     
     // Try adding the same interface again (should fail)
     result = hurricane_add_device_interface(1, 3, 0, 0, &test_interface);
@@ -165,11 +201,11 @@ int test_device_configure_endpoint(void)
     TEST_ASSERT_EQUAL_INT(0x81, last_ep_address, "Endpoint address should match");
     
     // Verify we can retrieve the endpoint
-    const hurricane_endpoint_descriptor_t* endpoint = hurricane_get_device_endpoint(2, 0x81);
-    TEST_ASSERT(endpoint != NULL, "Should be able to retrieve added endpoint");
-    TEST_ASSERT_EQUAL_INT(0x03, endpoint->ep_attributes, "Endpoint attributes should match");
-    TEST_ASSERT_EQUAL_INT(64, endpoint->ep_max_packet_size, "Max packet size should match");
-    TEST_ASSERT_EQUAL_INT(10, endpoint->ep_interval, "Interval should match");
+    hurricane_endpoint_descriptor_t endpoint;
+    TEST_ASSERT(hurricane_get_device_endpoint(2, 0x81, &endpoint), "Should be able to retrieve added endpoint");
+    TEST_ASSERT_EQUAL_INT(0x03, endpoint.ep_attributes, "Endpoint attributes should match");
+    TEST_ASSERT_EQUAL_INT(64, endpoint.ep_max_packet_size, "Max packet size should match");
+    TEST_ASSERT_EQUAL_INT(10, endpoint.ep_interval, "Interval should match");
     
     // Try configuring for non-existent interface (should fail)
     result = hurricane_device_configure_endpoint(99, 0x82, 0x03, 64, 10);
@@ -207,19 +243,19 @@ int test_remove_device_interface(void)
     hurricane_device_configure_endpoint(3, 0x83, 0x03, 64, 10);
     
     // Verify both interfaces exist
-    TEST_ASSERT(hurricane_get_device_interface(3) != NULL, "Interface 3 should exist");
-    TEST_ASSERT(hurricane_get_device_interface(4) != NULL, "Interface 4 should exist");
+    TEST_ASSERT(hurricane_get_device_interface(3, NULL), "Interface 3 should exist");
+    TEST_ASSERT(hurricane_get_device_interface(4, NULL), "Interface 4 should exist");
     
     // Remove interface 3
     int result = hurricane_remove_device_interface(3);
     TEST_ASSERT_EQUAL_INT(0, result, "hurricane_remove_device_interface should return 0");
     
     // Verify interface 3 is gone but 4 still exists
-    TEST_ASSERT(hurricane_get_device_interface(3) == NULL, "Interface 3 should be removed");
-    TEST_ASSERT(hurricane_get_device_interface(4) != NULL, "Interface 4 should still exist");
+    TEST_ASSERT(!hurricane_get_device_interface(3, NULL), "Interface 3 should be removed");
+    TEST_ASSERT(hurricane_get_device_interface(4, NULL), "Interface 4 should still exist");
     
     // Endpoint for interface 3 should no longer be accessible
-    TEST_ASSERT(hurricane_get_device_endpoint(3, 0x83) == NULL, "Endpoint for removed interface should be gone");
+    TEST_ASSERT(!hurricane_get_device_endpoint(3, 0x83, NULL), "Endpoint for removed interface should be gone");
     
     // Try to remove non-existent interface
     result = hurricane_remove_device_interface(99);
@@ -228,6 +264,193 @@ int test_remove_device_interface(void)
     TEST_PASS();
 }
 
+int test_endpoint_lookup_by_address(void)
+{
+    hurricane_interface_descriptor_t keyboard = { .interface_num = 0, .interface_class = 3, .num_endpoints = 2 };
+    hurricane_interface_descriptor_t mouse = { .interface_num = 1, .interface_class = 3, .num_endpoints = 1 };
+
+    // Start from an empty registry
+    hurricane_interface_manager_deinit();
+    hurricane_interface_manager_init();
+
+    hurricane_add_device_interface(0, 3, 1, 1, &keyboard);
+    hurricane_add_device_interface(1, 3, 1, 2, &mouse);
+    hurricane_device_configure_endpoint(0, 0x81, 0x03, 8, 1);
+    hurricane_device_configure_endpoint(0, 0x01, 0x03, 8, 1);
+    hurricane_device_configure_endpoint(1, 0x82, 0x03, 4, 1);
+
+    // IN and OUT of the same endpoint number are different endpoints
+    hurricane_endpoint_descriptor_t ep;
+    TEST_ASSERT(hurricane_get_device_endpoint_by_address(0x82, &ep), "EP 0x82 configured");
+    TEST_ASSERT_EQUAL_INT(1, ep.interface_num, "EP 0x82 belongs to the mouse");
+    TEST_ASSERT(hurricane_get_device_endpoint_by_address(0x01, &ep) && ep.interface_num == 0,
+                "EP 0x01 belongs to the keyboard");
+    TEST_ASSERT(!hurricane_get_device_endpoint_by_address(0x02, NULL), "EP 0x02 not configured");
+    TEST_ASSERT(!hurricane_get_device_endpoint(1, 0x81, NULL), "EP 0x81 is not the mouse's");
+
+    // An address has one owner
+    TEST_ASSERT(hurricane_device_configure_endpoint(1, 0x81, 0x03, 8, 1) != 0, "EP 0x81 already used");
+    TEST_ASSERT(hurricane_add_device_interface(MAX_INTERFACE_NUMBERS, 3, 0, 0, &mouse) != 0,
+                "Interface number out of range");
+
+    // Removing an interface frees its endpoints for others
+    hurricane_remove_device_interface(0);
+    TEST_ASSERT(!hurricane_get_device_endpoint_by_address(0x81, NULL), "EP 0x81 released");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_device_configure_endpoint(1, 0x81, 0x03, 8, 1), "EP 0x81 reused");
+
+    // Slots of removed interfaces are reused until the registry is full
+    for (uint8_t i = 2; i < 2 + MAX_DEVICE_INTERFACES - 1; i++) {
+        TEST_ASSERT_EQUAL_INT(0, hurricane_add_device_interface(i, 3, 0, 0, &keyboard), "Interface added");
+    }
+    TEST_ASSERT(hurricane_add_device_interface(20, 3, 0, 0, &keyboard) != 0, "Registry full");
+    TEST_ASSERT(hurricane_get_device_interface(1, NULL), "Mouse still registered");
+
+    TEST_PASS();
+}
+
+int test_control_request_dispatch(void)
+{
+    hurricane_interface_descriptor_t hid = { .interface_num = 0, .interface_class = 3,
+                                             .control_handler = control_handler };
+    hurricane_usb_setup_packet_t get_report = { 0xA1, 0x01, 0x0100, 0, 64 };
+    hurricane_usb_setup_packet_t set_protocol = { 0x21, 0x0B, 0, 0, 0 };
+
+    hurricane_interface_manager_deinit();
+    hurricane_interface_manager_init();
+    hurricane_add_device_interface(0, 3, 1, 1, &hid);
+
+    // Answered on the preallocated, aligned control buffer
+    device_response_count = 0;
+    TEST_ASSERT_EQUAL_INT(INTERFACE_CONTROL_COMPLETED, hurricane_interface_control_setup(0, &get_report, NULL),
+                          "GET_REPORT answered");
+    TEST_ASSERT(control_buffer != NULL && ((uintptr_t)control_buffer & 3) == 0, "Aligned buffer");
+    TEST_ASSERT_EQUAL_INT(1, device_response_count, "Reply sent");
+    TEST_ASSERT_EQUAL_INT(4, last_device_response_length, "Reply length");
+    TEST_ASSERT_EQUAL_INT(0xA5, last_device_response_data[3], "Reply data");
+    hurricane_interface_control_setup(0, &get_report, NULL);
+    TEST_ASSERT(control_buffer == (void*)hurricane_default_context()->interfaces.control.buffers[0], "Same buffer");
+
+    // Declined: left to the HAL (proxy or stall), nothing sent
+    TEST_ASSERT_EQUAL_INT(INTERFACE_CONTROL_NOT_HANDLED, hurricane_interface_control_setup(0, &set_protocol, NULL),
+                          "SET_PROTOCOL declined");
+    TEST_ASSERT_EQUAL_INT(INTERFACE_CONTROL_NOT_HANDLED, hurricane_interface_control_setup(5, &get_report, NULL),
+                          "No such interface");
+    TEST_ASSERT_EQUAL_INT(2, device_response_count, "Nothing more sent");
+
+    TEST_PASS();
+}
+
+int test_control_request_deferred(void)
+{
+    hurricane_interface_descriptor_t hid = { .interface_num = 0, .interface_class = 3,
+                                             .control_handler = control_handler };
+    hurricane_usb_setup_packet_t get_idle = { 0xA1, 0x02, 0, 0, 1 };
+    hurricane_usb_setup_packet_t get_report = { 0xA1, 0x01, 0x0100, 0, 64 };
+    const uint8_t idle = 0x7D;
+
+    hurricane_interface_manager_deinit();
+    hurricane_interface_manager_init();
+    hurricane_add_device_interface(0, 3, 1, 1, &hid);
+
+    // Nothing is sent until the handler completes the request
+    device_response_count = 0;
+    TEST_ASSERT_EQUAL_INT(INTERFACE_CONTROL_PENDING, hurricane_interface_control_setup(0, &get_idle, NULL),
+                          "GET_IDLE deferred");
+    TEST_ASSERT(!hurricane_interface_notify_event_with_response(USB_EVENT_CONTROL_REQUEST, 0, &get_idle, NULL),
+                "Not handled synchronously");
+    TEST_ASSERT_EQUAL_INT(0, device_response_count, "EP0 NAKs");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_interface_control_complete(&get_idle, true, &idle, 1), "Completed");
+    TEST_ASSERT_EQUAL_INT(1, device_response_count, "Reply sent");
+    TEST_ASSERT_EQUAL_INT(0x02, last_device_response_setup.bRequest, "GET_IDLE reply");
+    TEST_ASSERT_EQUAL_INT(0x7D, last_device_response_data[0], "Idle rate");
+    TEST_ASSERT(hurricane_interface_control_complete(&get_idle, true, &idle, 1) != 0, "Completed once only");
+
+    // A new SETUP supersedes the deferred request
+    hurricane_interface_control_setup(0, &get_idle, NULL);
+    hurricane_interface_control_setup(0, &get_report, NULL);
+    TEST_ASSERT(hurricane_interface_control_complete(&get_idle, true, &idle, 1) != 0, "Stale reply dropped");
+    TEST_ASSERT_EQUAL_INT(2, device_response_count, "Only the GET_REPORT reply");
+
+    // A deferred request can still fail
+    hurricane_interface_control_setup(0, &get_idle, NULL);
+    last_stalled_endpoint = 0xFF;
+    TEST_ASSERT_EQUAL_INT(0, hurricane_interface_control_complete(&get_idle, false, NULL, 0), "Failed");
+    TEST_ASSERT_EQUAL_INT(0x80, last_stalled_endpoint, "EP0 IN stalled");
+
+    TEST_PASS();
+}
+
+int test_control_request_setup_during_completion(void)
+{
+    hurricane_interface_descriptor_t hid = { .interface_num = 0, .interface_class = 3,
+                                             .control_handler = control_handler };
+    hurricane_usb_setup_packet_t get_idle = { 0xA1, 0x02, 0, 0, 1 };
+    hurricane_usb_setup_packet_t get_idle_again = { 0xA1, 0x02, 0, 0, 2 };
+    hurricane_usb_setup_packet_t get_report = { 0xA1, 0x01, 0x0100, 0, 64 };
+    const uint8_t idle = 0x7D;
+
+    hurricane_interface_manager_deinit();
+    hurricane_interface_manager_init();
+    hurricane_add_device_interface(0, 3, 1, 1, &hid);
+    device_response_count = 0;
+
+    // Claimed, then a SETUP comes in while the main loop writes the reply
+    hurricane_interface_control_setup(0, &get_idle, NULL);
+    uint8_t* reply = hurricane_interface_control_claim(&get_idle);
+    TEST_ASSERT(reply != NULL, "Claimed");
+    reply[0] = idle;
+    TEST_ASSERT_EQUAL_INT(INTERFACE_CONTROL_COMPLETED, hurricane_interface_control_setup(0, &get_report, NULL),
+                          "GET_REPORT answered meanwhile");
+    TEST_ASSERT(control_buffer != reply, "From the other buffer");
+    TEST_ASSERT_EQUAL_INT(idle, reply[0], "Claimed buffer untouched");
+    TEST_ASSERT(hurricane_interface_control_complete(&get_idle, true, reply, 1) != 0, "Superseded reply dropped");
+    TEST_ASSERT_EQUAL_INT(1, device_response_count, "Only the GET_REPORT reply");
+    TEST_ASSERT_EQUAL_INT(0xA5, last_device_response_data[3], "GET_REPORT data intact");
+
+    // The new request's deferral survives the old completion
+    hurricane_interface_control_setup(0, &get_idle, NULL);
+    TEST_ASSERT(hurricane_interface_control_claim(&get_idle) != NULL, "Claimed");
+    hurricane_interface_control_setup(0, &get_idle_again, NULL);
+    TEST_ASSERT(hurricane_interface_control_complete(&get_idle, true, &idle, 1) != 0, "Old reply dropped");
+    TEST_ASSERT_EQUAL_INT(1, device_response_count, "Still NAKing the new request");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_interface_control_complete(&get_idle_again, true, &idle, 1),
+                          "New request completes");
+    TEST_ASSERT_EQUAL_INT(2, device_response_count, "Reply sent");
+    TEST_ASSERT_EQUAL_INT(2, last_device_response_setup.wLength, "To the new request");
+    TEST_ASSERT_EQUAL_INT(idle, last_device_response_data[0], "Idle rate");
+
+    TEST_PASS();
+}
+
+int test_registry_snapshots(void)
+{
+    hurricane_host_class_handler_t handler = { .attach_callback = attach_adds_interface };
+    hurricane_interface_manager_t* im = &snapshot_ctx.interfaces;
+    int device = 1;
+
+    hurricane_context_init(&snapshot_ctx, HURRICANE_HW_PRIMARY_CONTROLLER, HURRICANE_HW_PRIMARY_CONTROLLER);
+    hurricane_interface_manager_init_ctx(&snapshot_ctx);
+    hurricane_register_host_class_handler_ctx(&snapshot_ctx, 3, 0, 0, &handler);
+    const hurricane_interface_registry_t* before = atomic_load(&im->registry);
+    unsigned int version = atomic_load(&im->version);
+
+    // The callback runs outside the read section, so its write does not wait on itself
+    hurricane_interface_notify_event_ctx(&snapshot_ctx, USB_EVENT_DEVICE_ATTACHED, 0, &device);
+    TEST_ASSERT(hurricane_get_device_interface_ctx(&snapshot_ctx, 7, NULL), "Added from the callback");
+    TEST_ASSERT(atomic_load(&im->registry) != before, "Published in the other snapshot");
+    TEST_ASSERT_EQUAL_INT(version + 1, atomic_load(&im->version), "One publication");
+    TEST_ASSERT_EQUAL_INT(0, atomic_load(&im->readers[0]) + atomic_load(&im->readers[1]), "No reader left");
+
+    // A failed write publishes nothing
+    hurricane_interface_descriptor_t desc = { .interface_num = 7 };
+    TEST_ASSERT(hurricane_add_device_interface_ctx(&snapshot_ctx, 7, 3, 0, 0, &desc) != 0, "Already there");
+    TEST_ASSERT_EQUAL_INT(version + 1, atomic_load(&im->version), "Nothing published");
+
+    hurricane_interface_manager_deinit_ctx(&snapshot_ctx);
+    hurricane_context_deinit(&snapshot_ctx);
+    TEST_PASS();
+}
+
 // --- Test suite runner ---
 
 int test_usb_interface_manager(void)
@@ -238,6 +461,11 @@ int test_usb_interface_manager(void)
     RUN_TEST(test_add_device_interface);
     RUN_TEST(test_device_configure_endpoint);
     RUN_TEST(test_remove_device_interface);
+    RUN_TEST(test_endpoint_lookup_by_address);
+    RUN_TEST(test_control_request_dispatch);
+    RUN_TEST(test_control_request_deferred);
+    RUN_TEST(test_control_request_setup_during_completion);
+    RUN_TEST(test_registry_snapshots);
 
     return failures;
 }
\ No newline at end of file
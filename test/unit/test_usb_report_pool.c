@@ -0,0 +1,103 @@
+// tests/unit/test_usb_report_pool.c
+
+#include "../common/test_common.h"
+#include "core/hurricane_context.h"
+#include "core/usb_report_pool.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static hurricane_context_t ctx;
+static hurricane_report_pool_t pool;
+
+// What the host class handler saw
+static hurricane_report_view_t seen;
+static int seen_count;
+static bool hold_views;
+
+static void data_callback(const hurricane_report_view_t* view)
+{
+    seen = *view;
+    seen_count++;
+    if (hold_views) {
+        hurricane_report_view_hold(view);
+    }
+}
+
+// --- Unit Tests ---
+
+int test_report_pool_hold_release(void)
+{
+    hurricane_report_view_t views[HURRICANE_REPORT_POOL_BUFFERS + 1];
+
+    memset(&pool, 0, sizeof(pool));
+    for (int i = 0; i < HURRICANE_REPORT_POOL_BUFFERS; i++) {
+        TEST_ASSERT(hurricane_report_pool_acquire(&pool, &views[i]) != NULL, "Free buffer");
+    }
+    TEST_ASSERT(hurricane_report_pool_acquire(&pool, &views[HURRICANE_REPORT_POOL_BUFFERS]) == NULL,
+                "Every buffer held");
+    TEST_ASSERT_EQUAL_INT(1, (int)pool.exhausted, "Exhaustion counted");
+
+    // A second holder keeps the buffer past the first release
+    hurricane_report_view_hold(&views[1]);
+    hurricane_report_view_release(&views[1]);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_REPORT_POOL_BUFFERS, hurricane_report_pool_held(&pool), "Still held");
+    hurricane_report_view_release(&views[1]);
+    TEST_ASSERT_EQUAL_INT(HURRICANE_REPORT_POOL_BUFFERS - 1, hurricane_report_pool_held(&pool), "Returned");
+
+    TEST_ASSERT(hurricane_report_pool_acquire(&pool, &views[HURRICANE_REPORT_POOL_BUFFERS]) == pool.buffers[1],
+                "Released buffer reused");
+
+    TEST_PASS();
+}
+
+int test_report_pool_hid_task_views(void)
+{
+    hurricane_host_class_handler_t handler = { .data_callback = data_callback };
+    hurricane_hid_device_t hid = { .interface_number = 0 };
+    hurricane_device_t dev = { .addr = 2, .is_active = 1, .ctx = &ctx, .hid_device = &hid };
+
+    hurricane_context_init(&ctx, HURRICANE_HW_PRIMARY_CONTROLLER, HURRICANE_HW_PRIMARY_CONTROLLER);
+    hurricane_interface_manager_init_ctx(&ctx);
+    TEST_ASSERT_EQUAL_INT(0, hurricane_register_host_class_handler_ctx(&ctx, 3, 0, 0, &handler), "Register");
+
+    // The handler reads the report in place; the buffer is free again afterwards
+    seen_count = 0;
+    hold_views = false;
+    hurricane_hid_task(&dev);
+    TEST_ASSERT_EQUAL_INT(1, seen_count, "Handler called");
+    TEST_ASSERT(seen.data == ctx.reports.buffers[0], "View into the receive buffer");
+    TEST_ASSERT_EQUAL_INT(8, seen.length, "Length");
+    TEST_ASSERT_EQUAL_INT(2, seen.pipe, "Pipe");
+    TEST_ASSERT_EQUAL_INT(0x10, seen.data[0], "Data");
+    TEST_ASSERT_EQUAL_INT(0, hurricane_report_pool_held(&ctx.reports), "Buffer returned");
+
+    // Held views pin their buffers; with all of them held nothing is read
+    hold_views = true;
+    for (int i = 0; i < HURRICANE_REPORT_POOL_BUFFERS + 1; i++) {
+        hurricane_hid_task(&dev);
+    }
+    TEST_ASSERT_EQUAL_INT(1 + HURRICANE_REPORT_POOL_BUFFERS, seen_count, "No read without a buffer");
+    TEST_ASSERT_EQUAL_INT(1, (int)ctx.reports.exhausted, "Exhaustion counted");
+
+    hurricane_report_view_release(&seen);
+    hurricane_hid_task(&dev);
+    TEST_ASSERT_EQUAL_INT(2 + HURRICANE_REPORT_POOL_BUFFERS, seen_count, "Reading resumes after a release");
+
+    hurricane_interface_manager_deinit_ctx(&ctx);
+    hurricane_context_deinit(&ctx);
+    TEST_PASS();
+}
+
+// --- Test suite runner ---
+
+int test_usb_report_pool(void)
+{
+    int failures = 0;
+
+    RUN_TEST(test_report_pool_hold_release);
+    RUN_TEST(test_report_pool_hid_task_views);
+
+    return failures;
+}
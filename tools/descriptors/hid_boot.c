@@ -0,0 +1,76 @@
+/*
+ * @file hid_boot.c
+ * @brief Boot protocol report descriptors, source of usb_hid_boot_reports.h
+ *
+ * Not compiled. `make codegen` reads these arrays and emits their bytes
+ * with the report accessors; the library and the targets build their
+ * descriptors from the generated header.
+ */
+
+#include <stdint.h>
+
+// HID 1.11 appendix B.1
+static const uint8_t boot_keyboard_descriptor[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x06,         // Usage (Keyboard)
+    0xA1, 0x01,         // Collection (Application)
+    0x05, 0x07,         //   Usage Page (Key Codes)
+    0x19, 0xE0,         //   Usage Minimum (224)
+    0x29, 0xE7,         //   Usage Maximum (231)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x01,         //   Logical Maximum (1)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x08,         //   Report Count (8)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute) - modifiers
+    0x95, 0x01,         //   Report Count (1)
+    0x75, 0x08,         //   Report Size (8)
+    0x81, 0x01,         //   Input (Constant) - reserved byte
+    0x95, 0x05,         //   Report Count (5)
+    0x75, 0x01,         //   Report Size (1)
+    0x05, 0x08,         //   Usage Page (LEDs)
+    0x19, 0x01,         //   Usage Minimum (1)
+    0x29, 0x05,         //   Usage Maximum (5)
+    0x91, 0x02,         //   Output (Data, Variable, Absolute) - LEDs
+    0x95, 0x01,         //   Report Count (1)
+    0x75, 0x03,         //   Report Size (3)
+    0x91, 0x01,         //   Output (Constant) - padding
+    0x95, 0x06,         //   Report Count (6)
+    0x75, 0x08,         //   Report Size (8)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x65,         //   Logical Maximum (101)
+    0x05, 0x07,         //   Usage Page (Key Codes)
+    0x19, 0x00,         //   Usage Minimum (0)
+    0x29, 0x65,         //   Usage Maximum (101)
+    0x81, 0x00,         //   Input (Data, Array) - keys
+    0xC0                // End Collection
+};
+
+// HID 1.11 appendix B.2
+static const uint8_t boot_mouse_descriptor[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x02,         // Usage (Mouse)
+    0xA1, 0x01,         // Collection (Application)
+    0x09, 0x01,         //   Usage (Pointer)
+    0xA1, 0x00,         //   Collection (Physical)
+    0x05, 0x09,         //     Usage Page (Buttons)
+    0x19, 0x01,         //     Usage Minimum (1)
+    0x29, 0x03,         //     Usage Maximum (3)
+    0x15, 0x00,         //     Logical Minimum (0)
+    0x25, 0x01,         //     Logical Maximum (1)
+    0x95, 0x03,         //     Report Count (3)
+    0x75, 0x01,         //     Report Size (1)
+    0x81, 0x02,         //     Input (Data, Variable, Absolute) - buttons
+    0x95, 0x01,         //     Report Count (1)
+    0x75, 0x05,         //     Report Size (5)
+    0x81, 0x01,         //     Input (Constant) - padding
+    0x05, 0x01,         //     Usage Page (Generic Desktop)
+    0x09, 0x30,         //     Usage (X)
+    0x09, 0x31,         //     Usage (Y)
+    0x15, 0x81,         //     Logical Minimum (-127)
+    0x25, 0x7F,         //     Logical Maximum (127)
+    0x75, 0x08,         //     Report Size (8)
+    0x95, 0x02,         //     Report Count (2)
+    0x81, 0x06,         //     Input (Data, Variable, Relative) - X, Y
+    0xC0,               //   End Collection
+    0xC0                // End Collection
+};
@@ -0,0 +1,564 @@
+/*
+ * @file hid_codegen.c
+ * @brief Generate typed C accessors from HID report descriptors
+ *
+ * Usage:
+ *   hid_codegen [-o header] input [-a array] -p prefix [[-a array] -p prefix ...]
+ *
+ * input is a binary report descriptor, or a C file (.c/.h) holding it as a
+ * byte array; -a names the array (default: the first initializer in the
+ * file). Every -p closes one descriptor and names its accessors. The
+ * descriptor is compiled with the library parser, so the generated layout
+ * is the one the runtime decoders see.
+ *
+ * For every report the header gets <PREFIX>_<TYPE>[<ID>]_SIZE (bytes,
+ * report ID included), <PREFIX>_<TYPE><ID>_ID, and per element of each
+ * variable field a getter/setter pair with constant byte offsets, shifts
+ * and masks:
+ *
+ *   static inline int32_t prefix_input_x(const uint8_t* report);
+ *   static inline void prefix_input_set_x(uint8_t* report, int32_t value);
+ *
+ * Array fields and variable fields of more than 16 elements get one
+ * indexed pair instead (prefix_input_keys(report, index)). The
+ * descriptor itself is emitted as <PREFIX>_DESCRIPTOR_BYTES, one item per
+ * line, with its length and FNV-1a hash. Arrays built from it,
+ *
+ *   static const uint8_t report_descriptor[] = { PREFIX_DESCRIPTOR_BYTES };
+ *
+ * cannot drift from the accessors, whatever the edit. The compiled layout
+ * is emitted as <PREFIX>_LAYOUT, an initializer for a hurricane_hid_layout_t,
+ *
+ *   static const hurricane_hid_layout_t layout = PREFIX_LAYOUT;
+ *
+ * so built-in descriptors need no parse (and no writable state) at runtime.
+ *
+ * Built and run by `make codegen`.
+ */
+
+#include "usb_hid_parser.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_DESCRIPTOR      4096
+#define MAX_INPUT           (256 * 1024)
+#define MAX_SPECS           8
+#define MAX_NAMES           128
+#define NAME_LENGTH         64
+#define MAX_NAMED_ELEMENTS  16
+
+typedef struct {
+    const char* array;
+    const char* prefix;
+    uint8_t desc[MAX_DESCRIPTOR];
+    uint16_t length;
+    hurricane_hid_layout_t layout;
+} spec_t;
+
+static FILE* out;
+
+static void fail(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "hid_codegen: ");
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+    exit(1);
+}
+
+static char* read_file(const char* path, size_t* size)
+{
+    FILE* f = fopen(path, "rb");
+    char* data = malloc(MAX_INPUT + 1);
+
+    if (!f || !data) {
+        fail("cannot read %s", path);
+    }
+    *size = fread(data, 1, MAX_INPUT, f);
+    data[*size] = '\0';
+    fclose(f);
+    return data;
+}
+
+static bool is_c_source(const char* path)
+{
+    const char* dot = strrchr(path, '.');
+    return dot && (strcmp(dot, ".c") == 0 || strcmp(dot, ".h") == 0);
+}
+
+static const char* skip_space_and_comments(const char* p)
+{
+    for (;;) {
+        while (isspace((unsigned char)*p) || *p == ',') {
+            p++;
+        }
+        if (p[0] == '/' && p[1] == '/') {
+            p = strchr(p, '\n');
+            if (!p) {
+                return "";
+            }
+        } else if (p[0] == '/' && p[1] == '*') {
+            p = strstr(p + 2, "*/");
+            if (!p) {
+                return "";
+            }
+            p += 2;
+        } else {
+            return p;
+        }
+    }
+}
+
+// Find "name [" ... "{" of the array, or the first "{" without a name
+static const char* find_initializer(const char* text, const char* array)
+{
+    const char* p = text;
+
+    if (!array) {
+        return strchr(text, '{');
+    }
+    size_t n = strlen(array);
+    while ((p = strstr(p, array)) != NULL) {
+        bool word_start = (p == text) || !(isalnum((unsigned char)p[-1]) || p[-1] == '_');
+        const char* q = p + n;
+        p = q;
+        if (!word_start) {
+            continue;
+        }
+        while (isspace((unsigned char)*q)) {
+            q++;
+        }
+        if (*q == '[') {
+            const char* eq = strchr(q, '=');
+            const char* brace = eq ? strchr(eq, '{') : NULL;
+            if (brace && !memchr(eq, ';', (size_t)(brace - eq))) {
+                return brace;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void load_from_c(const char* text, spec_t* spec)
+{
+    const char* p = find_initializer(text, spec->array);
+
+    if (!p) {
+        fail("no initializer for %s", spec->array ? spec->array : "a descriptor");
+    }
+    p++;
+    for (;;) {
+        p = skip_space_and_comments(p);
+        if (*p == '}') {
+            return;
+        }
+        char* end;
+        unsigned long value = strtoul(p, &end, 0);
+        if (end == p || value > 0xFF) {
+            fail("unexpected text in %s near \"%.16s\"", spec->array ? spec->array : "array", p);
+        }
+        if (spec->length >= MAX_DESCRIPTOR) {
+            fail("descriptor longer than %d bytes", MAX_DESCRIPTOR);
+        }
+        spec->desc[spec->length++] = (uint8_t)value;
+        p = end;
+        while (*p == 'u' || *p == 'U') {
+            p++;
+        }
+    }
+}
+
+static uint32_t fnv1a(const uint8_t* data, uint16_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (uint16_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void upper(char* dst, const char* src)
+{
+    while (*src) {
+        *dst++ = (char)toupper((unsigned char)*src++);
+    }
+    *dst = '\0';
+}
+
+static const char* type_name(uint8_t type)
+{
+    switch (type) {
+        case HURRICANE_HID_REPORT_INPUT:  return "input";
+        case HURRICANE_HID_REPORT_OUTPUT: return "output";
+        default:                          return "feature";
+    }
+}
+
+// Accessor name of one usage
+static void usage_name(char* name, uint16_t page, uint16_t usage)
+{
+    static const char* const desktop[] = { "x", "y", "z", "rx", "ry", "rz", "slider", "dial", "wheel", "hat_switch" };
+    static const char* const modifiers[] = {
+        "left_ctrl", "left_shift", "left_alt", "left_gui", "right_ctrl", "right_shift", "right_alt", "right_gui"
+    };
+    static const char* const leds[] = { "num_lock", "caps_lock", "scroll_lock", "compose", "kana" };
+
+    if (page == 0x01 && usage >= 0x30 && usage <= 0x39) {
+        strcpy(name, desktop[usage - 0x30]);
+    } else if (page == 0x07 && usage >= 0xE0 && usage <= 0xE7) {
+        strcpy(name, modifiers[usage - 0xE0]);
+    } else if (page == 0x08 && usage >= 1 && usage <= 5) {
+        strcpy(name, leds[usage - 1]);
+    } else if (page == 0x09) {
+        snprintf(name, NAME_LENGTH, "button%u", usage);
+    } else if (page == 0x0C && usage == 0x238) {
+        strcpy(name, "ac_pan");
+    } else {
+        snprintf(name, NAME_LENGTH, "u%02x_%02x", page, usage);
+    }
+}
+
+// Accessor name of an indexed field
+static void field_name(char* name, uint16_t page, uint16_t usage)
+{
+    if (page == 0x07) {
+        strcpy(name, "keys");
+    } else if (page == 0x09) {
+        strcpy(name, "buttons");
+    } else if (page == 0x0C) {
+        strcpy(name, "consumer");
+    } else {
+        snprintf(name, NAME_LENGTH, "u%02x_%02x", page, usage);
+    }
+}
+
+// Names already used in the current report; a repeat gets a suffix
+static char used_names[MAX_NAMES][NAME_LENGTH];
+static int num_used_names;
+
+static void make_unique(char* name)
+{
+    char candidate[NAME_LENGTH];
+    int suffix = 1;
+
+    strcpy(candidate, name);
+    for (;;) {
+        bool taken = false;
+        for (int i = 0; i < num_used_names && !taken; i++) {
+            taken = (strcmp(used_names[i], candidate) == 0);
+        }
+        if (!taken) {
+            break;
+        }
+        snprintf(candidate, NAME_LENGTH, "%.50s_%d", name, ++suffix);
+    }
+    strcpy(name, candidate);
+    if (num_used_names < MAX_NAMES) {
+        strcpy(used_names[num_used_names++], name);
+    }
+}
+
+// Getter and setter of one element at a constant bit position
+static void emit_constant_accessors(const char* getter, const char* setter, uint32_t bit, uint8_t size,
+                                    bool is_signed)
+{
+    uint32_t first = bit / 8;
+    uint32_t shift = bit % 8;
+    uint32_t bytes = (shift + size + 7) / 8;
+    uint64_t mask = (size == 32) ? 0xFFFFFFFFull : ((1ull << size) - 1);
+    const char* word = (bytes > 4) ? "uint64_t" : "uint32_t";
+    char shifted[32] = "raw";
+
+    if (shift) {
+        snprintf(shifted, sizeof(shifted), "(raw >> %u)", shift);
+    }
+
+    fprintf(out, "static inline int32_t %s(const uint8_t* report)\n{\n", getter);
+    fprintf(out, "    %s raw = (%s)report[%u]", word, word, first);
+    for (uint32_t i = 1; i < bytes; i++) {
+        fprintf(out, " | (%s)report[%u] << %u", word, first + i, 8 * i);
+    }
+    fprintf(out, ";\n");
+    if (is_signed && size < 32) {
+        fprintf(out, "    uint32_t value = %s%s & 0x%llXu;\n", bytes > 4 ? "(uint32_t)" : "", shifted,
+                (unsigned long long)mask);
+        fprintf(out, "    return (int32_t)(value ^ 0x%Xu) - 0x%X;\n}\n\n", 1u << (size - 1), 1u << (size - 1));
+    } else if (shift == 0 && bytes * 8 == size) {
+        fprintf(out, "    return (int32_t)raw;\n}\n\n");
+    } else {
+        fprintf(out, "    return (int32_t)(%s & 0x%llXu);\n}\n\n", shifted, (unsigned long long)mask);
+    }
+
+    fprintf(out, "static inline void %s(uint8_t* report, int32_t value)\n{\n", setter);
+    if (shift) {
+        fprintf(out, "    %s raw = (%svalue & 0x%llXu) << %u;\n", word, bytes > 4 ? "(uint64_t)(uint32_t)" : "(uint32_t)",
+                (unsigned long long)mask, shift);
+    } else {
+        fprintf(out, "    %s raw = %svalue & 0x%llXu;\n", word, bytes > 4 ? "(uint64_t)(uint32_t)" : "(uint32_t)",
+                (unsigned long long)mask);
+    }
+    for (uint32_t i = 0; i < bytes; i++) {
+        uint32_t byte_mask = (uint32_t)(((mask << shift) >> (8 * i)) & 0xFF);
+        char part[32] = "raw";
+        if (i) {
+            snprintf(part, sizeof(part), "(raw >> %u)", 8 * i);
+        }
+        if (byte_mask == 0xFF) {
+            fprintf(out, "    report[%u] = (uint8_t)%s;\n", first + i, part);
+        } else {
+            fprintf(out, "    report[%u] = (uint8_t)((report[%u] & 0x%02Xu) | (%s & 0x%02Xu));\n",
+                    first + i, first + i, ~byte_mask & 0xFF, part, byte_mask);
+        }
+    }
+    fprintf(out, "}\n\n");
+}
+
+// Getter and setter of element index of a field
+static void emit_indexed_accessors(const char* getter, const char* setter, uint32_t bit, uint8_t size,
+                                   uint16_t count, bool is_signed)
+{
+    fprintf(out, "static inline int32_t %s(const uint8_t* report, uint16_t index)\n{\n", getter);
+    if (bit % 8 == 0 && size == 8) {
+        // Byte array (6KRO keys): plain loads and stores
+        fprintf(out, "    return index < %u ? (int32_t)%sreport[%u + index] : 0;\n}\n\n",
+                count, is_signed ? "(int8_t)" : "", bit / 8);
+        fprintf(out, "static inline void %s(uint8_t* report, uint16_t index, int32_t value)\n{\n", setter);
+        fprintf(out, "    if (index < %u) {\n        report[%u + index] = (uint8_t)value;\n    }\n}\n\n",
+                count, bit / 8);
+        return;
+    }
+    fprintf(out, "    return index < %u ? hid_codegen_read(report, %uu + index * %uu, %u, %s) : 0;\n}\n\n",
+            count, bit, size, size, is_signed ? "true" : "false");
+    fprintf(out, "static inline void %s(uint8_t* report, uint16_t index, int32_t value)\n{\n", setter);
+    fprintf(out, "    if (index < %u) {\n        hid_codegen_write(report, %uu + index * %uu, %u, value);\n    }\n}\n\n",
+            count, bit, size, size);
+}
+
+static void emit_helpers(void)
+{
+    fprintf(out,
+            "#ifndef HID_CODEGEN_HELPERS\n"
+            "#define HID_CODEGEN_HELPERS\n"
+            "// Element access at a bit position; constant arguments fold after inlining\n"
+            "static inline int32_t hid_codegen_read(const uint8_t* report, uint32_t bit, uint8_t size, bool is_signed)\n"
+            "{\n"
+            "    uint32_t value = 0;\n"
+            "    for (uint8_t i = 0; i < size; i++, bit++) {\n"
+            "        value |= (uint32_t)((report[bit / 8] >> (bit %% 8)) & 1u) << i;\n"
+            "    }\n"
+            "    if (is_signed && size < 32 && (value & (1u << (size - 1)))) {\n"
+            "        value |= ~0u << size;\n"
+            "    }\n"
+            "    return (int32_t)value;\n"
+            "}\n\n"
+            "static inline void hid_codegen_write(uint8_t* report, uint32_t bit, uint8_t size, int32_t value)\n"
+            "{\n"
+            "    for (uint8_t i = 0; i < size; i++, bit++) {\n"
+            "        uint8_t mask = (uint8_t)(1u << (bit %% 8));\n"
+            "        if (((uint32_t)value >> i) & 1u) {\n"
+            "            report[bit / 8] |= mask;\n"
+            "        } else {\n"
+            "            report[bit / 8] &= (uint8_t)~mask;\n"
+            "        }\n"
+            "    }\n"
+            "}\n"
+            "#endif\n\n");
+}
+
+// The descriptor as an initializer list, one item per line
+static void emit_bytes(const char* prefix_upper, const spec_t* spec)
+{
+    fprintf(out, "#define %s_DESCRIPTOR_BYTES", prefix_upper);
+    for (uint16_t i = 0; i < spec->length; ) {
+        uint8_t prefix = spec->desc[i];
+        uint16_t size = 1 + ((prefix & 3) == 3 ? 4 : (prefix & 3));    // Short item: 0, 1, 2 or 4 data bytes
+        if (prefix == 0xFE && i + 1 < spec->length) {
+            size = 3 + spec->desc[i + 1];                               // Long item: size, tag, data
+        }
+        if (size > spec->length - i) {
+            size = spec->length - i;
+        }
+
+        fprintf(out, " \\\n   ");
+        for (uint16_t b = 0; b < size; b++, i++) {
+            fprintf(out, " 0x%02X%s", spec->desc[i], i + 1 < spec->length ? "," : "");
+        }
+    }
+    fprintf(out, "\n\n");
+}
+
+// The compiled layout as a hurricane_hid_layout_t initializer, one record per line
+static void emit_layout(const char* prefix_upper, const hurricane_hid_layout_t* layout)
+{
+    fprintf(out, "#define %s_LAYOUT { \\\n    .fields = { \\\n", prefix_upper);
+    for (uint8_t f = 0; f < layout->num_fields; f++) {
+        const hurricane_hid_field_t* field = &layout->fields[f];
+        fprintf(out, "        { .usage_page = 0x%02X, .usage = 0x%02X, .usage_max = 0x%02X, .bit_offset = %u, "
+                     ".count = %u, .flags = 0x%02X, .report_id = %u, .report_index = %u, .bit_size = %u, "
+                     ".type = %u, .logical_min = %ld, .logical_max = %ld }, \\\n",
+                field->usage_page, field->usage, field->usage_max, field->bit_offset, field->count, field->flags,
+                field->report_id, field->report_index, field->bit_size, field->type,
+                (long)field->logical_min, (long)field->logical_max);
+    }
+    fprintf(out, "    }, \\\n    .reports = { \\\n");
+    for (uint8_t r = 0; r < layout->num_reports; r++) {
+        const hurricane_hid_report_info_t* info = &layout->reports[r];
+        fprintf(out, "        { .report_id = %u, .type = %u, .bit_length = %u, .first_field = %u, .num_fields = %u, "
+                     ".application_page = 0x%02X, .application_usage = 0x%02X }, \\\n",
+                info->report_id, info->type, info->bit_length, info->first_field, info->num_fields,
+                info->application_page, info->application_usage);
+    }
+    fprintf(out, "    }, \\\n    .num_fields = %u, \\\n    .num_reports = %u, \\\n    .uses_report_ids = %s \\\n}\n\n",
+            layout->num_fields, layout->num_reports, layout->uses_report_ids ? "true" : "false");
+}
+
+static void emit_spec(const spec_t* spec)
+{
+    const hurricane_hid_layout_t* layout = &spec->layout;
+    char prefix_upper[NAME_LENGTH];
+    uint32_t id_bits = layout->uses_report_ids ? 8 : 0;
+
+    upper(prefix_upper, spec->prefix);
+    fprintf(out, "// %s\n", spec->array ? spec->array : "Report descriptor");
+    fprintf(out, "#define %s_DESCRIPTOR_LENGTH %u\n", prefix_upper, spec->length);
+    fprintf(out, "#define %s_DESCRIPTOR_HASH 0x%08Xu    // FNV-1a\n", prefix_upper, fnv1a(spec->desc, spec->length));
+    emit_bytes(prefix_upper, spec);
+    emit_layout(prefix_upper, layout);
+
+    for (uint8_t r = 0; r < layout->num_reports; r++) {
+        const hurricane_hid_report_info_t* info = &layout->reports[r];
+        char report[NAME_LENGTH];
+        char report_upper[NAME_LENGTH];
+
+        if (info->report_id) {
+            snprintf(report, sizeof(report), "%.30s_%s%u", spec->prefix, type_name(info->type), info->report_id);
+        } else {
+            snprintf(report, sizeof(report), "%.30s_%s", spec->prefix, type_name(info->type));
+        }
+        upper(report_upper, report);
+
+        if (info->report_id) {
+            fprintf(out, "// %s report %u\n", type_name(info->type), info->report_id);
+        } else {
+            fprintf(out, "// %s report\n", type_name(info->type));
+        }
+        fprintf(out, "#define %s_SIZE %u\n", report_upper, (id_bits + info->bit_length + 7) / 8);
+        if (info->report_id) {
+            fprintf(out, "#define %s_ID %u\n", report_upper, info->report_id);
+        }
+        fprintf(out, "\n");
+
+        num_used_names = 0;
+        for (uint8_t f = 0; f < info->num_fields; f++) {
+            const hurricane_hid_field_t* field = &layout->fields[info->first_field + f];
+            bool is_signed = (field->flags & HURRICANE_HID_FIELD_SIGNED) != 0;
+            uint32_t bit = id_bits + field->bit_offset;
+            char name[NAME_LENGTH];
+            char getter[2 * NAME_LENGTH];
+            char setter[2 * NAME_LENGTH + 8];
+
+            if ((field->flags & HURRICANE_HID_FIELD_VARIABLE) && field->count <= MAX_NAMED_ELEMENTS) {
+                for (uint16_t e = 0; e < field->count; e++) {
+                    uint16_t usage = field->usage + e > field->usage_max ? field->usage_max : field->usage + e;
+                    usage_name(name, field->usage_page, usage);
+                    make_unique(name);
+                    snprintf(getter, sizeof(getter), "%s_%s", report, name);
+                    snprintf(setter, sizeof(setter), "%s_set_%s", report, name);
+                    emit_constant_accessors(getter, setter, bit + e * field->bit_size, field->bit_size, is_signed);
+                }
+            } else {
+                field_name(name, field->usage_page, field->usage);
+                make_unique(name);
+                snprintf(getter, sizeof(getter), "%s_%s", report, name);
+                snprintf(setter, sizeof(setter), "%s_set_%s", report, name);
+                emit_indexed_accessors(getter, setter, bit, field->bit_size, field->count, is_signed);
+            }
+        }
+    }
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: hid_codegen [-o header] input [-a array] -p prefix ...\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    static spec_t specs[MAX_SPECS];
+    const char* output = NULL;
+    const char* input = NULL;
+    const char* array = NULL;
+    int num_specs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            array = argv[++i];
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            if (num_specs == MAX_SPECS) {
+                fail("at most %d descriptors per header", MAX_SPECS);
+            }
+            specs[num_specs].array = array;
+            specs[num_specs].prefix = argv[++i];
+            num_specs++;
+            array = NULL;
+        } else if (argv[i][0] != '-' && !input) {
+            input = argv[i];
+        } else {
+            usage();
+        }
+    }
+    if (!input || num_specs == 0) {
+        usage();
+    }
+
+    size_t size = 0;
+    char* text = read_file(input, &size);
+    for (int s = 0; s < num_specs; s++) {
+        spec_t* spec = &specs[s];
+        if (is_c_source(input)) {
+            load_from_c(text, spec);
+        } else {
+            if (size > MAX_DESCRIPTOR) {
+                fail("descriptor longer than %d bytes", MAX_DESCRIPTOR);
+            }
+            memcpy(spec->desc, text, size);
+            spec->length = (uint16_t)size;
+        }
+        int ret = hurricane_hid_parse_report_descriptor(spec->desc, spec->length, &spec->layout);
+        if (ret != HURRICANE_HID_PARSE_OK) {
+            fail("%s: descriptor does not parse (%d)", spec->prefix, ret);
+        }
+    }
+
+    out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        fail("cannot write %s", output);
+    }
+
+    const char* base = strrchr(input, '/');
+    base = base ? base + 1 : input;
+    fprintf(out, "/**\n * @file %s\n", output ? (strrchr(output, '/') ? strrchr(output, '/') + 1 : output) : "stdout");
+    fprintf(out, " * @brief Report accessors generated from %s\n *\n", base);
+    fprintf(out, " * Generated by tools/hid_codegen, do not edit; regenerate with `make codegen`.\n */\n\n");
+    fprintf(out, "#pragma once\n\n#include <stdbool.h>\n#include <stdint.h>\n\n");
+    emit_helpers();
+    for (int s = 0; s < num_specs; s++) {
+        emit_spec(&specs[s]);
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(text);
+    return 0;
+}